@@ -218,11 +218,10 @@ void ExposureCalculator::build() {
 vector<Real> ExposureCalculator::getMeanExposure(const string& tid, ExposureIndex index) {
     vector<Real> exp(dates_.size() + 1, 0.0);
     exp[0] = exposureCube_->getT0(tid, index);
+    vector<Real> samples;
     for (Size i = 0; i < dates_.size(); i++) {
-        for (Size k = 0; k < exposureCube_->samples(); k++) {
-            exp[i + 1] += exposureCube_->get(tid, dates_[i], k, index);
-        }
-        exp[i + 1] /= exposureCube_->samples();
+        exposureCube_->getSamples(samples, tid, dates_[i], index);
+        exp[i + 1] = std::accumulate(samples.begin(), samples.end(), 0.0) / samples.size();
     }
     return exp;
 }
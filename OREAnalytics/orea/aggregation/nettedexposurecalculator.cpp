@@ -515,12 +515,11 @@ NettedExposureCalculator::collateralPaths(
 vector<Real> NettedExposureCalculator::getMeanExposure(const string& tid, ExposureIndex index) {
     vector<Real> exp(cube_->dates().size() + 1, 0.0);
     exp[0] = exposureCube_->getT0(tid, index);
+    vector<Real> samples;
     for (Size i = 0; i < cube_->dates().size(); i++) {
         if (multiPath_) {
-	        for (Size k = 0; k < exposureCube_->samples(); k++) {
-	            exp[i + 1] += exposureCube_->get(tid, cube_->dates()[i], k, index);
-	        }
-	        exp[i + 1] /= exposureCube_->samples();
+	        exposureCube_->getSamples(samples, tid, cube_->dates()[i], index);
+	        exp[i + 1] = std::accumulate(samples.begin(), samples.end(), 0.0) / samples.size();
 	    }
 	    else {
 	        exp[i + 1] = exposureCube_->get(tid, cube_->dates()[i], 0, index);
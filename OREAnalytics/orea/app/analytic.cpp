@@ -200,7 +200,7 @@ void Analytic::buildMarket(const QuantLib::ext::shared_ptr<ore::data::InMemoryLo
             market_ = QuantLib::ext::make_shared<TodaysMarket>(
                 configurations().asofDate, configurations().todaysMarketParams, loader_, configurations().curveConfig,
                 inputs()->continueOnError(), true, inputs()->lazyMarketBuilding(), inputs()->refDataManager(), false,
-                *inputs()->iborFallbackConfig());
+                *inputs()->iborFallbackConfig(), true, true, inputs()->nThreads());
         } catch (const std::exception& e) {
             if (marketRequired)
                 QL_FAIL("Failed to build market: " << e.what());
@@ -17,6 +17,7 @@
 */
 
 #include <orea/app/analytics/scenarioanalytic.hpp>
+#include <orea/scenario/binaryscenariofile.hpp>
 #include <orea/scenario/scenariowriter.hpp>
 
 using namespace ore::analytics;
@@ -50,6 +51,14 @@ void ScenarioAnalyticImpl::runAnalytic(const QuantLib::ext::shared_ptr<InMemoryL
     auto scenario = ssm->baseScenario();
     setScenario(scenario);
 
+    if (isBinaryScenarioFile(inputs_->scenarioOutputFile())) {
+        // binary scenario files are written directly, they can not be represented as a report
+        ScenarioWriter sw((inputs_->resultsPath() / inputs_->scenarioOutputFile()).string());
+        sw.writeScenario(scenario, true);
+        sw.close();
+        return;
+    }
+
     QuantLib::ext::shared_ptr<InMemoryReport> report = QuantLib::ext::make_shared<InMemoryReport>();
     auto sw = ScenarioWriter(nullptr, report);
     sw.writeScenario(scenario, true);
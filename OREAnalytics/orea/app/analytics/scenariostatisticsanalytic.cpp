@@ -20,6 +20,7 @@
 #include <orea/app/reportwriter.hpp>
 #include <orea/app/structuredanalyticserror.hpp>
 #include <orea/app/structuredanalyticswarning.hpp>
+#include <orea/scenario/binaryscenariofile.hpp>
 #include <orea/scenario/scenariowriter.hpp>
 #include <orea/scenario/simplescenariofactory.hpp>
 #include <orea/scenario/crossassetmodelscenariogenerator.hpp>
@@ -77,7 +78,8 @@ void ScenarioStatisticsAnalyticImpl::buildScenarioGenerator(const bool continueO
     LOG("simulation grid front date " << io::iso_date(grid_->dates().front()));    
     LOG("simulation grid back date " << io::iso_date(grid_->dates().back()));    
 
-    if (inputs_->writeScenarios()) {
+    // binary scenario files are written in a separate pass in runAnalytic()
+    if (inputs_->writeScenarios() && !isBinaryScenarioFile(inputs_->scenarioDumpFile())) {
         auto report = QuantLib::ext::make_shared<InMemoryReport>();
         analytic()->reports()["SCENARIO_STATISTICS"]["scenario"] = report;
         scenarioGenerator_ = QuantLib::ext::make_shared<ScenarioWriter>(scenarioGenerator_, report);
@@ -145,6 +147,16 @@ void ScenarioStatisticsAnalyticImpl::runAnalytic(const QuantLib::ext::shared_ptr
     ReportWriter().writeScenarioDistributions(scenarioGenerator, keys, samples_, grid_->valuationDates(),
                                               inputs_->scenarioDistributionSteps(), *distributionReport);
     analytic()->reports()["SCENARIO_STATISTICS"]["scenario_distribution"] = distributionReport;
+
+    if (inputs_->writeScenarios() && isBinaryScenarioFile(inputs_->scenarioDumpFile())) {
+        ScenarioWriter sw((inputs_->resultsPath() / inputs_->scenarioDumpFile()).string());
+        scenarioGenerator->reset();
+        for (Size i = 0; i < samples_; ++i) {
+            for (Size j = 0; j < grid_->valuationDates().size(); ++j)
+                sw.writeScenario(scenarioGenerator->next(grid_->valuationDates()[j]), i == 0 && j == 0);
+        }
+        sw.close();
+    }
 }
 
 } // namespace analytics
@@ -22,6 +22,7 @@
 #include <orea/app/reportwriter.hpp>
 #include <orea/app/structuredanalyticserror.hpp>
 #include <orea/app/structuredanalyticswarning.hpp>
+#include <orea/cube/contiguouscube.hpp>
 #include <orea/cube/jointnpvcube.hpp>
 #include <orea/engine/amcvaluationengine.hpp>
 #include <orea/engine/cptycalculator.hpp>
@@ -29,7 +30,9 @@
 #include <orea/engine/multistatenpvcalculator.hpp>
 #include <orea/engine/multithreadedvaluationengine.hpp>
 #include <orea/engine/observationmode.hpp>
+#include <orea/engine/valuationprofiler.hpp>
 #include <orea/engine/xvaenginecg.hpp>
+#include <orea/scenario/binaryscenariofile.hpp>
 #include <orea/scenario/scenariowriter.hpp>
 #include <orea/scenario/simplescenariofactory.hpp>
 
@@ -192,9 +195,17 @@ void XvaAnalyticImpl::buildScenarioGenerator(const bool continueOnCalibrationErr
     LOG("simulation grid back date " << io::iso_date(grid_->dates().back()));
 
     if (inputs_->writeScenarios()) {
-        auto report = QuantLib::ext::make_shared<InMemoryReport>();
-        analytic()->reports()["XVA"]["scenario"] = report;
-        scenarioGenerator_ = QuantLib::ext::make_shared<ScenarioWriter>(scenarioGenerator_, report);
+        if (isBinaryScenarioFile(inputs_->scenarioDumpFile())) {
+            // binary scenario files are written directly, runs under an offset scenario write one file per scenario
+            string fileName = offsetScenario_ == nullptr ? inputs_->scenarioDumpFile()
+                                                         : "scenario" + offsetScenario_->label() + ".bin";
+            scenarioGenerator_ = QuantLib::ext::make_shared<ScenarioWriter>(
+                scenarioGenerator_, (inputs_->resultsPath() / fileName).string());
+        } else {
+            auto report = QuantLib::ext::make_shared<InMemoryReport>();
+            analytic()->reports()["XVA"]["scenario"] = report;
+            scenarioGenerator_ = QuantLib::ext::make_shared<ScenarioWriter>(scenarioGenerator_, report);
+        }
     }
 }
 
@@ -229,12 +240,20 @@ void XvaAnalyticImpl::initCube(QuantLib::ext::shared_ptr<NPVCube>& cube, const s
     for (Size i = 0; i < grid_->valuationDates().size(); ++i)
         DLOG("initCube: grid[" << i << "]=" << io::iso_date(grid_->valuationDates()[i]));
 
-    if (cubeDepth == 1)
-        cube = QuantLib::ext::make_shared<SinglePrecisionInMemoryCube>(inputs_->asof(), ids, grid_->valuationDates(),
-                                                                       samples_, 0.0f);
+    cube = createNpvCube(inputs_->asof(), ids, grid_->valuationDates(), samples_, cubeDepth);
+}
+
+QuantLib::ext::shared_ptr<NPVCube> XvaAnalyticImpl::createNpvCube(const QuantLib::Date& asof,
+                                                                  const std::set<std::string>& ids,
+                                                                  const std::vector<QuantLib::Date>& dates,
+                                                                  Size samples, Size cubeDepth) const {
+    if (inputs_->contiguousCube())
+        return QuantLib::ext::make_shared<SinglePrecisionContiguousNpvCube>(asof, ids, dates, samples, cubeDepth,
+                                                                            CubeAxisOrder::IdDateSample, 0.0f);
+    else if (cubeDepth == 1)
+        return QuantLib::ext::make_shared<SinglePrecisionInMemoryCube>(asof, ids, dates, samples, 0.0f);
     else
-        cube = QuantLib::ext::make_shared<SinglePrecisionInMemoryCubeN>(inputs_->asof(), ids, grid_->valuationDates(),
-                                                                        samples_, cubeDepth, 0.0f);
+        return QuantLib::ext::make_shared<SinglePrecisionInMemoryCubeN>(asof, ids, dates, samples, cubeDepth, 0.0f);
 }
 
 void XvaAnalyticImpl::initClassicRun(const QuantLib::ext::shared_ptr<Portfolio>& portfolio) {
@@ -357,11 +376,16 @@ void XvaAnalyticImpl::buildClassicCube(const QuantLib::ext::shared_ptr<Portfolio
                                                                      ConsoleLog::instance().progressBarWidth());
     auto progressLog = QuantLib::ext::make_shared<ProgressLog>("XVA: Building cube", 100, oreSeverity::notice);
 
+    QuantLib::ext::shared_ptr<ValuationProfiler> profiler;
+    if (inputs_->valuationProfile())
+        profiler = QuantLib::ext::make_shared<ValuationProfiler>(inputs_->simulationPricingEngine());
+
     if (inputs_->nThreads() == 1) {
 
         // single-threaded engine run
 
         ValuationEngine engine(inputs_->asof(), grid_, simMarket_);
+        engine.setProfiler(profiler);
         engine.registerProgressIndicator(progressBar);
         engine.registerProgressIndicator(progressLog);
         engine.buildCube(portfolio, cube_, calculators(),
@@ -377,11 +401,7 @@ void XvaAnalyticImpl::buildClassicCube(const QuantLib::ext::shared_ptr<Portfolio
         auto cubeFactory = [this](const QuantLib::Date& asof, const std::set<std::string>& ids,
                                   const std::vector<QuantLib::Date>& dates,
                                   const Size samples) -> QuantLib::ext::shared_ptr<NPVCube> {
-            if (cubeDepth_ == 1)
-                return QuantLib::ext::make_shared<SinglePrecisionInMemoryCube>(asof, ids, dates, samples, 0.0f);
-            else
-                return QuantLib::ext::make_shared<SinglePrecisionInMemoryCubeN>(asof, ids, dates, samples, cubeDepth_,
-                                                                                0.0f);
+            return createNpvCube(asof, ids, dates, samples, cubeDepth_);
         };
 
         std::function<QuantLib::ext::shared_ptr<NPVCube>(const QuantLib::Date&, const std::set<std::string>&,
@@ -408,6 +428,8 @@ void XvaAnalyticImpl::buildClassicCube(const QuantLib::ext::shared_ptr<Portfolio
             cptyCubeFactory, "xva-simulation", offsetScenario_);
 
         engine.setAggregationScenarioData(*scenarioData_);
+        engine.setShareInitMarket(inputs_->shareInitMarket());
+        engine.setProfiler(profiler);
         engine.registerProgressIndicator(progressBar);
         engine.registerProgressIndicator(progressLog);
 
@@ -422,6 +444,15 @@ void XvaAnalyticImpl::buildClassicCube(const QuantLib::ext::shared_ptr<Portfolio
                 [](Real a, Real x) { return std::max(a, x); }, 0.0);
     }
 
+    if (profiler) {
+        auto profileReport = QuantLib::ext::make_shared<InMemoryReport>();
+        ReportWriter(inputs_->reportNaString()).writeValuationProfile(*profileReport, *profiler);
+        analytic()->reports()["XVA"]["valuation_profile"] = profileReport;
+        auto histogramReport = QuantLib::ext::make_shared<InMemoryReport>();
+        ReportWriter(inputs_->reportNaString()).writeValuationProfileHistogram(*histogramReport, *profiler);
+        analytic()->reports()["XVA"]["valuation_profile_histogram"] = histogramReport;
+    }
+
     CONSOLE("OK");
 
     LOG("XVA::buildCube done");
@@ -524,11 +555,7 @@ void XvaAnalyticImpl::amcRun(bool doClassicRun) {
         auto cubeFactory = [this](const QuantLib::Date& asof, const std::set<std::string>& ids,
                                   const std::vector<QuantLib::Date>& dates,
                                   const Size samples) -> QuantLib::ext::shared_ptr<NPVCube> {
-            if (cubeDepth_ == 1)
-                return QuantLib::ext::make_shared<SinglePrecisionInMemoryCube>(asof, ids, dates, samples, 0.0f);
-            else
-                return QuantLib::ext::make_shared<SinglePrecisionInMemoryCubeN>(asof, ids, dates, samples, cubeDepth_,
-                                                                                0.0f);
+            return createNpvCube(asof, ids, dates, samples, cubeDepth_);
         };
 
         auto simMarketParams =
@@ -671,7 +698,8 @@ void XvaAnalyticImpl::runAnalytic(const QuantLib::ext::shared_ptr<ore::data::InM
             inputs_->xvaCgSensiScenarioData(), inputs_->refDataManager(), *inputs_->iborFallbackConfig(),
             inputs_->xvaCgBumpSensis(), inputs_->xvaCgUseExternalComputeDevice(),
             inputs_->xvaCgExternalDeviceCompatibilityMode(), inputs_->xvaCgUseDoublePrecisionForExternalCalculation(),
-            inputs_->xvaCgExternalComputeDevice(), true, true);
+            inputs_->xvaCgExternalComputeDevice(), inputs_->xvaCgExternalComputeDeviceThreads(),
+            inputs_->xvaCgRegressionMethod(), inputs_->xvaCgRegressionThreads(), true, true);
 
         analytic()->reports()["XVA"]["xvacg-exposure"] = engine.exposureReport();
         if (inputs_->xvaCgSensiScenarioData())
@@ -775,6 +803,10 @@ void XvaAnalyticImpl::runAnalytic(const QuantLib::ext::shared_ptr<ore::data::InM
 
         LOG("NPV cube generation completed");
 
+        // close the scenario dump, so that a binary scenario file is complete on disk
+        if (auto scenarioWriter = QuantLib::ext::dynamic_pointer_cast<ScenarioWriter>(scenarioGenerator_))
+            scenarioWriter->close();
+
         /***********************************************************************
          * We may have two non-empty portfolios to be merged for post processing
          ***********************************************************************/
@@ -54,6 +54,9 @@ protected:
 
     void initCubeDepth();
     void initCube(QuantLib::ext::shared_ptr<NPVCube>& cube, const std::set<std::string>& ids, Size cubeDepth);
+    QuantLib::ext::shared_ptr<NPVCube> createNpvCube(const QuantLib::Date& asof, const std::set<std::string>& ids,
+                                                     const std::vector<QuantLib::Date>& dates, Size samples,
+                                                     Size cubeDepth) const;
 
     void initClassicRun(const QuantLib::ext::shared_ptr<Portfolio>& portfolio);
     void buildClassicCube(const QuantLib::ext::shared_ptr<Portfolio>& portfolio);
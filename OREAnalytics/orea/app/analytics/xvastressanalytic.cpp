@@ -23,6 +23,7 @@
 #include <orea/app/structuredanalyticswarning.hpp>
 #include <orea/cube/cube_io.hpp>
 #include <orea/engine/parstressconverter.hpp>
+#include <orea/scenario/binaryscenariofile.hpp>
 #include <orea/scenario/clonescenariofactory.hpp>
 #include <orea/scenario/scenariosimmarket.hpp>
 #include <orea/scenario/stressscenariogenerator.hpp>
@@ -67,7 +68,8 @@ void XvaStressAnalyticImpl::writeCubes(const std::string& label,
         }
     }
 
-    if (inputs_->writeScenarios()) {
+    // binary scenario files are written by the xva analytic directly
+    if (inputs_->writeScenarios() && !isBinaryScenarioFile(inputs_->scenarioDumpFile())) {
         DLOG("Write scenario report under scenario " << label);
         // analytic()->reports()["XVA_STRESS"]["scenario" + label] = xvaAnalytic->reports()["XVA"]["scenario"];
         xvaAnalytic->reports()["XVA"]["scenario"]->toFile(inputs_->resultsPath().string() + "/scenario" + label +
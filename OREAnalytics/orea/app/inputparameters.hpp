@@ -53,6 +53,7 @@
 #include <ored/portfolio/portfolio.hpp>
 #include <ored/portfolio/referencedata.hpp>
 #include <ored/utilities/csvfilereader.hpp>
+#include <qle/math/randomvariable.hpp>
 #include <boost/filesystem/path.hpp>
 #include <filesystem>
 
@@ -97,6 +98,7 @@ public:
     void setPortfolioFromFile(const std::string& fileNameString, const std::filesystem::path& inputPath); 
     void setMarketConfigs(const std::map<std::string, std::string>& m);
     void setThreads(int i) { nThreads_ = i; }
+    void setShareInitMarket(bool b) { shareInitMarket_ = b; }
     void setEntireMarket(bool b) { entireMarket_ = b; }
     void setAllFixings(bool b) { allFixings_ = b; }
     void setEomInflationFixings(bool b) { eomInflationFixings_ = b; }
@@ -198,6 +200,9 @@ public:
     void setXvaCgExternalDeviceCompatibilityMode(bool b) { xvaCgExternalDeviceCompatibilityMode_ = b; }
     void setXvaCgUseDoublePrecisionForExternalCalculation(bool b) { xvaCgUseDoublePrecisionForExternalCalculation_ = b; }
     void setXvaCgExternalComputeDevice(string s) { xvaCgExternalComputeDevice_ = std::move(s); }
+    void setXvaCgExternalComputeDeviceThreads(Size n) { xvaCgExternalComputeDeviceThreads_ = n; }
+    void setXvaCgRegressionMethod(QuantExt::RandomVariableRegressionMethod m) { xvaCgRegressionMethod_ = m; }
+    void setXvaCgRegressionThreads(Size n) { xvaCgRegressionThreads_ = n; }
     void setXvaCgSensiScenarioData(const std::string& xml);
     void setXvaCgSensiScenarioDataFromFile(const std::string& fileName);
     void setAmcTradeTypes(const std::string& s); // parse to set<string>
@@ -206,10 +211,13 @@ public:
     void setNettingSetId(const std::string& s) { nettingSetId_ = s; }
     void setScenarioGenType(const std::string& s) { scenarioGenType_ = s; }
     void setStoreFlows(bool b) { storeFlows_ = b; }
+    void setValuationProfile(bool b) { valuationProfile_ = b; }
+    void setContiguousCube(bool b) { contiguousCube_ = b; }
     void setStoreCreditStateNPVs(Size states) { storeCreditStateNPVs_ = states; }
     void setStoreSurvivalProbabilities(bool b) { storeSurvivalProbabilities_ = b; }
     void setWriteCube(bool b) { writeCube_ = b; }
     void setWriteScenarios(bool b) { writeScenarios_ = b; }
+    void setScenarioDumpFile(const std::string& filename) { scenarioDumpFile_ = filename; }
     void setExposureSimMarketParams(const std::string& xml);
     void setExposureSimMarketParamsFromFile(const std::string& fileName);
     void setScenarioGeneratorData(const std::string& xml);
@@ -451,6 +459,7 @@ public:
 
     QuantLib::Size maxRetries() const { return maxRetries_; }
     QuantLib::Size nThreads() const { return nThreads_; }
+    bool shareInitMarket() const { return shareInitMarket_; }
     bool entireMarket() const { return entireMarket_; }
     bool allFixings() const { return allFixings_; }
     bool eomInflationFixings() const { return eomInflationFixings_; }
@@ -572,6 +581,9 @@ public:
         return xvaCgUseDoublePrecisionForExternalCalculation_;
     }
     const std::string& xvaCgExternalComputeDevice() const { return xvaCgExternalComputeDevice_; }
+    Size xvaCgExternalComputeDeviceThreads() const { return xvaCgExternalComputeDeviceThreads_; }
+    QuantExt::RandomVariableRegressionMethod xvaCgRegressionMethod() const { return xvaCgRegressionMethod_; }
+    Size xvaCgRegressionThreads() const { return xvaCgRegressionThreads_; }
     const QuantLib::ext::shared_ptr<ore::analytics::SensitivityScenarioData>& xvaCgSensiScenarioData() const { return xvaCgSensiScenarioData_; }
     const std::set<std::string>& amcTradeTypes() const { return amcTradeTypes_; }
     const std::string& exposureBaseCurrency() const { return exposureBaseCurrency_; }
@@ -579,10 +591,13 @@ public:
     const std::string& nettingSetId() const { return nettingSetId_; }
     const std::string& scenarioGenType() const { return scenarioGenType_; }
     bool storeFlows() const { return storeFlows_; }
+    bool valuationProfile() const { return valuationProfile_; }
+    bool contiguousCube() const { return contiguousCube_; }
     Size storeCreditStateNPVs() const { return storeCreditStateNPVs_; }
     bool storeSurvivalProbabilities() const { return storeSurvivalProbabilities_; }
     bool writeCube() const { return writeCube_; }
     bool writeScenarios() const { return writeScenarios_; }
+    const std::string& scenarioDumpFile() const { return scenarioDumpFile_; }
     const QuantLib::ext::shared_ptr<ore::analytics::ScenarioSimMarketParameters>& exposureSimMarketParams() const { return exposureSimMarketParams_; }
     const QuantLib::ext::shared_ptr<ScenarioGeneratorData> scenarioGeneratorData() const { return scenarioGeneratorData_; }
     const QuantLib::ext::shared_ptr<CrossAssetModelData>& crossAssetModelData() const { return crossAssetModelData_; }
@@ -810,6 +825,7 @@ protected:
     QuantLib::ext::shared_ptr<ore::data::Portfolio> portfolio_, useCounterpartyOriginalPortfolio_;
     QuantLib::Size maxRetries_ = 7;
     QuantLib::Size nThreads_ = 1;
+    bool shareInitMarket_ = false;
    
     bool entireMarket_ = false; 
     bool allFixings_ = false; 
@@ -915,6 +931,9 @@ protected:
     bool xvaCgExternalDeviceCompatibilityMode_ = false;
     bool xvaCgUseDoublePrecisionForExternalCalculation_ = false;
     string xvaCgExternalComputeDevice_;
+    Size xvaCgExternalComputeDeviceThreads_ = 0;
+    QuantExt::RandomVariableRegressionMethod xvaCgRegressionMethod_ = QuantExt::RandomVariableRegressionMethod::QR;
+    Size xvaCgRegressionThreads_ = 1;
     QuantLib::ext::shared_ptr<ore::analytics::SensitivityScenarioData> xvaCgSensiScenarioData_;
     std::set<std::string> amcTradeTypes_;
     std::string exposureBaseCurrency_ = "";
@@ -922,10 +941,13 @@ protected:
     std::string nettingSetId_ = "";
     std::string scenarioGenType_ = "";
     bool storeFlows_ = false;
+    bool valuationProfile_ = false;
+    bool contiguousCube_ = false;
     Size storeCreditStateNPVs_ = 0;
     bool storeSurvivalProbabilities_ = false;
     bool writeCube_ = false;
     bool writeScenarios_ = false;
+    std::string scenarioDumpFile_;
     QuantLib::ext::shared_ptr<ore::analytics::ScenarioSimMarketParameters> exposureSimMarketParams_;
     QuantLib::ext::shared_ptr<ScenarioGeneratorData> scenarioGeneratorData_;
     QuantLib::ext::shared_ptr<CrossAssetModelData> crossAssetModelData_;
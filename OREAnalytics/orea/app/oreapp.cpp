@@ -210,7 +210,11 @@ QuantLib::ext::shared_ptr<CSVLoader> OREApp::buildCsvLoader(const QuantLib::ext:
         WLOG("fixing cutoff date not set");
     }
     
-    auto loader = boost::make_shared<CSVLoader>(marketFiles, fixingFiles, dividendFiles, implyTodaysFixings, cutoff);
+    tmp = params->get("setup", "nThreads", false);
+    Size nThreads = tmp != "" ? parseInteger(tmp) : 1;
+
+    auto loader = boost::make_shared<CSVLoader>(marketFiles, fixingFiles, dividendFiles, implyTodaysFixings, cutoff,
+                                                nThreads);
 
     return loader;
 }
@@ -357,6 +361,10 @@ void OREApp::initFromParams() {
         if (!tmp.empty()) {
             structuredLogRotationSize_ = static_cast<Size>(parseInteger(tmp));
         }
+        tmp = params_->get("logging", "asynchronous", false);
+        if (!tmp.empty()) {
+            asynchronousLog_ = ore::data::parseBool(tmp);
+        }
     }
     
     setupLog(outputPath_, logFile_, logMask_, logRootPath_, progressLogFile_, progressLogRotationSize_, progressLogToConsole_,
@@ -539,6 +547,7 @@ void OREApp::setupLog(const std::string& path, const std::string& file, Size mas
     Log::instance().setRootPath(oreRootPath);
     Log::instance().setMask(mask);
     Log::instance().switchOn();
+    Log::instance().setAsynchronous(asynchronousLog_);
 
     // Progress logger
     auto progressLogger = QuantLib::ext::make_shared<ProgressLogger>();
@@ -559,7 +568,10 @@ void OREApp::setupLog(const std::string& path, const std::string& file, Size mas
     ore::data::Log::instance().registerIndependentLogger(eventLogger);
 }
 
-void OREApp::closeLog() { Log::instance().removeAllLoggers(); }
+void OREApp::closeLog() {
+    Log::instance().setAsynchronous(false);
+    Log::instance().removeAllLoggers();
+}
 
 std::string OREApp::version() { return std::string(OPEN_SOURCE_RISK_VERSION); }
 
@@ -637,6 +649,10 @@ void OREAppInputParameters::loadParameters() {
     if (tmp != "")
         setThreads(parseInteger(tmp));
 
+    tmp = params_->get("setup", "shareInitMarket", false);
+    if (tmp != "")
+        setShareInitMarket(parseBool(tmp));
+
     tmp = params_->get("setup", "entireMarket", false);
     if (tmp != "")
         setEntireMarket(parseBool(tmp));
@@ -1514,6 +1530,14 @@ void OREAppInputParameters::loadParameters() {
         if (tmp == "Y")
             setStoreSurvivalProbabilities(true);
 
+        tmp = params_->get("simulation", "valuationProfile", false);
+        if (!tmp.empty())
+            setValuationProfile(parseBool(tmp));
+
+        tmp = params_->get("simulation", "contiguousCube", false);
+        if (!tmp.empty())
+            setContiguousCube(parseBool(tmp));
+
         tmp = params_->get("simulation", "nettingSetId", false);
         if (tmp != "")
             setNettingSetId(tmp);
@@ -1523,8 +1547,10 @@ void OREAppInputParameters::loadParameters() {
             setWriteCube(true);
 
         tmp = params_->get("simulation", "scenariodump", false);
-        if (tmp != "")
+        if (tmp != "") {
             setWriteScenarios(true);
+            setScenarioDumpFile(tmp);
+        }
 
         tmp = params_->get("simulation", "xvaCgBumpSensis", false);
 	if (!tmp.empty())
@@ -1544,6 +1570,18 @@ void OREAppInputParameters::loadParameters() {
 
         setXvaCgExternalComputeDevice(params_->get("simulation", "xvaCgExternalComputeDevice", false));
 
+        tmp = params_->get("simulation", "xvaCgExternalComputeDeviceThreads", false);
+	if (!tmp.empty())
+	    setXvaCgExternalComputeDeviceThreads(parseInteger(tmp));
+
+        tmp = params_->get("simulation", "xvaCgRegressionMethod", false);
+	if (!tmp.empty())
+	    setXvaCgRegressionMethod(parseRandomVariableRegressionMethod(tmp));
+
+        tmp = params_->get("simulation", "xvaCgRegressionThreads", false);
+	if (!tmp.empty())
+	    setXvaCgRegressionThreads(parseInteger(tmp));
+
         tmp = params_->get("simulation", "xvaCgBumpSensis", false);
 	if (!tmp.empty())
 	    setXvaCgBumpSensis(parseBool(tmp));
@@ -2033,8 +2071,10 @@ void OREAppInputParameters::loadParameters() {
         }
 
         tmp = params_->get("scenarioStatistics", "scenariodump", false);
-        if (tmp != "")
+        if (tmp != "") {
             setWriteScenarios(true);
+            setScenarioDumpFile(tmp);
+        }
     }
 
     if (analytics().size() == 0) {
@@ -120,6 +120,7 @@ protected:
     bool progressLogToConsole_ = false;
     string structuredLogFile_ = "";
     QuantLib::Size structuredLogRotationSize_ = 100 * 1024 * 1024;
+    bool asynchronousLog_ = false;
 
     // Cached error messages of a run
     std::vector<std::string> errorMessages_;
@@ -1491,6 +1491,86 @@ void ReportWriter::writePricingStats(ore::data::Report& report, const QuantLib::
     LOG("Pricing stats report written");
 }
 
+namespace {
+// calls f(section, name, phase, statistics) for all statistics recorded by the profiler
+template <class F> void forEachProfileEntry(const ValuationProfiler& profiler, F f) {
+    for (auto const& [phase, s] : profiler.phases())
+        f("Total", "", ore::data::to_string(phase), s);
+    for (auto const& [d, phases] : profiler.dates())
+        for (auto const& [phase, s] : phases)
+            f("Date", ore::data::to_string(d), ore::data::to_string(phase), s);
+    for (auto const& [tradeType, s] : profiler.tradeTypes())
+        f("TradeType", tradeType, ore::data::to_string(ValuationProfiler::Phase::Pricing), s);
+    for (auto const& [engine, s] : profiler.pricingEngines())
+        f("PricingEngine", engine, ore::data::to_string(ValuationProfiler::Phase::Pricing), s);
+}
+} // namespace
+
+void ReportWriter::writeValuationProfile(ore::data::Report& report, const ValuationProfiler& profiler) {
+
+    LOG("Writing valuation profile report");
+
+    report.addColumn("Section", string())
+        .addColumn("Name", string())
+        .addColumn("Phase", string())
+        .addColumn("Count", Size())
+        .addColumn("Recalculations", Size())
+        .addColumn("TotalTime", double(), 6)
+        .addColumn("AverageTime", double(), 3)
+        .addColumn("MinTime", double(), 3)
+        .addColumn("MaxTime", double(), 3);
+
+    forEachProfileEntry(profiler, [&report](const string& section, const string& name, const string& phase,
+                                            const ValuationProfiler::Statistics& s) {
+        report.next()
+            .add(section)
+            .add(name)
+            .add(phase)
+            .add(s.count)
+            .add(s.recalculations)
+            .add(s.total)
+            .add(s.count > 0 ? s.total / s.count * 1.0E6 : 0.0)
+            .add(s.min * 1.0E6)
+            .add(s.max * 1.0E6);
+    });
+
+    report.end();
+    LOG("Valuation profile report written");
+}
+
+void ReportWriter::writeValuationProfileHistogram(ore::data::Report& report, const ValuationProfiler& profiler) {
+
+    LOG("Writing valuation profile histogram report");
+
+    report.addColumn("Section", string())
+        .addColumn("Name", string())
+        .addColumn("Phase", string())
+        .addColumn("LowerBound", double(), 0)
+        .addColumn("UpperBound", double(), 0)
+        .addColumn("Count", Size());
+
+    forEachProfileEntry(profiler, [&report](const string& section, const string& name, const string& phase,
+                                            const ValuationProfiler::Statistics& s) {
+        for (Size b = 0; b < ValuationProfiler::histogramBuckets; ++b) {
+            if (s.histogram[b] == 0)
+                continue;
+            Real upper = b + 1 < ValuationProfiler::histogramBuckets
+                             ? ValuationProfiler::Statistics::bucketLowerBound(b + 1)
+                             : QL_MAX_REAL;
+            report.next()
+                .add(section)
+                .add(name)
+                .add(phase)
+                .add(ValuationProfiler::Statistics::bucketLowerBound(b))
+                .add(upper)
+                .add(s.histogram[b]);
+        }
+    });
+
+    report.end();
+    LOG("Valuation profile histogram report written");
+}
+
 void ReportWriter::writeCube(ore::data::Report& report, const QuantLib::ext::shared_ptr<NPVCube>& cube,
                              const std::map<std::string, std::string>& nettingSetMap) {
     LOG("Writing cube report");
@@ -30,6 +30,7 @@
 #include <orea/cube/npvcube.hpp>
 #include <orea/cube/sensitivitycube.hpp>
 #include <orea/engine/sensitivitystream.hpp>
+#include <orea/engine/valuationprofiler.hpp>
 #include <orea/simm/crifrecord.hpp>
 #include <orea/simm/simmresults.hpp>
 #include <orea/simm/crif.hpp>
@@ -126,6 +127,14 @@ public:
 
     virtual void writePricingStats(ore::data::Report& report, const QuantLib::ext::shared_ptr<Portfolio>& portfolio);
 
+    /*! Write the timings recorded by a valuation profiler, i.e. per phase (Section "Total"), per date and phase
+        (Section "Date"), per trade type and per pricing engine. Total times are in seconds, the average, min and max
+        times in microseconds. */
+    virtual void writeValuationProfile(ore::data::Report& report, const ValuationProfiler& profiler);
+
+    //! Write the non-empty buckets of the timing histograms of a valuation profiler, bounds in microseconds
+    virtual void writeValuationProfileHistogram(ore::data::Report& report, const ValuationProfiler& profiler);
+
     virtual void writeCube(ore::data::Report& report, const QuantLib::ext::shared_ptr<NPVCube>& cube,
                            const std::map<std::string, std::string>& nettingSetMap = std::map<std::string, std::string>());
 
@@ -0,0 +1,164 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file orea/cube/contiguouscube.hpp
+    \brief A cube implementation that stores the cube in one contiguous block of memory
+    \ingroup cube
+*/
+
+#pragma once
+
+#include <orea/cube/npvcube.hpp>
+
+#include <ql/errors.hpp>
+
+#include <array>
+#include <set>
+#include <vector>
+
+namespace ore {
+namespace analytics {
+using QuantLib::Date;
+using QuantLib::Real;
+using QuantLib::Size;
+
+//! Order of the id, date and sample axes in a ContiguousNpvCube, from outermost to innermost
+enum class CubeAxisOrder { IdDateSample, IdSampleDate, DateIdSample, DateSampleId, SampleIdDate, SampleDateId };
+
+//! ContiguousNpvCube stores the cube in one contiguous block of memory
+/*! The values are stored in a single allocation, the order of the id, date and sample axes is given by the axis order,
+ *  the depth is always the innermost axis. The order should be chosen to match the predominant access pattern:
+ *  - IdDateSample (the default) stores the samples for an (id, date) contiguously, which is what the exposure
+ *    calculations and getSamples() read
+ *  - DateSampleId stores the values for all ids of a (date, sample) contiguously, which suits aggregations across
+ *    ids, e.g. netting or DIM regressions
+ *
+ *  This class is a template to allow both single and double precision implementations.
+
+ \ingroup cube
+ */
+template <typename T> class ContiguousNpvCube : public NPVCube {
+public:
+    ContiguousNpvCube(const Date& asof, const std::set<std::string>& ids, const std::vector<Date>& dates, Size samples,
+                      Size depth = 1, CubeAxisOrder axisOrder = CubeAxisOrder::IdDateSample, const T& t = T())
+        : asof_(asof), dates_(dates), samples_(samples), depth_(depth), axisOrder_(axisOrder),
+          t0Data_(ids.size() * depth, t), data_(ids.size() * dates.size() * samples * depth, t) {
+        QL_REQUIRE(ids.size() > 0, "ContiguousNpvCube: no ids specified");
+        QL_REQUIRE(dates.size() > 0, "ContiguousNpvCube: no dates specified");
+        QL_REQUIRE(samples > 0, "ContiguousNpvCube: samples must be > 0");
+        QL_REQUIRE(depth > 0, "ContiguousNpvCube: depth must be > 0");
+        Size pos = 0;
+        for (const auto& id : ids)
+            idIdx_[id] = pos++;
+        // axes 0, 1, 2 are id, date, sample, list them from innermost to outermost and accumulate the strides
+        std::array<Size, 3> dims = {ids.size(), dates.size(), samples};
+        std::array<Size, 3> order;
+        switch (axisOrder) {
+        case CubeAxisOrder::IdDateSample:
+            order = {2, 1, 0};
+            break;
+        case CubeAxisOrder::IdSampleDate:
+            order = {1, 2, 0};
+            break;
+        case CubeAxisOrder::DateIdSample:
+            order = {2, 0, 1};
+            break;
+        case CubeAxisOrder::DateSampleId:
+            order = {0, 2, 1};
+            break;
+        case CubeAxisOrder::SampleIdDate:
+            order = {1, 0, 2};
+            break;
+        case CubeAxisOrder::SampleDateId:
+            order = {0, 1, 2};
+            break;
+        default:
+            QL_FAIL("ContiguousNpvCube: unhandled axis order " << static_cast<int>(axisOrder));
+        }
+        Size stride = depth;
+        for (Size a : order) {
+            strides_[a] = stride;
+            stride *= dims[a];
+        }
+    }
+
+    Size numIds() const override { return idIdx_.size(); }
+    Size numDates() const override { return dates_.size(); }
+    Size samples() const override { return samples_; }
+    Size depth() const override { return depth_; }
+    const std::map<std::string, Size>& idsAndIndexes() const override { return idIdx_; }
+    const std::vector<QuantLib::Date>& dates() const override { return dates_; }
+    QuantLib::Date asof() const override { return asof_; }
+
+    //! The order of the id, date and sample axes
+    CubeAxisOrder axisOrder() const { return axisOrder_; }
+
+    Real getT0(Size i, Size d) const override {
+        check(i, 0, 0, d);
+        return static_cast<Real>(t0Data_[i * depth_ + d]);
+    }
+    void setT0(Real value, Size i, Size d) override {
+        check(i, 0, 0, d);
+        t0Data_[i * depth_ + d] = static_cast<T>(value);
+    }
+    Real get(Size i, Size j, Size k, Size d) const override {
+        check(i, j, k, d);
+        return static_cast<Real>(data_[pos(i, j, k, d)]);
+    }
+    void set(Real value, Size i, Size j, Size k, Size d) override {
+        check(i, j, k, d);
+        data_[pos(i, j, k, d)] = static_cast<T>(value);
+    }
+
+    void getSamples(std::vector<Real>& values, Size i, Size j, Size d) const override {
+        check(i, j, 0, d);
+        values.resize(samples_);
+        const T* p = data_.data() + pos(i, j, 0, d);
+        const Size stride = strides_[2];
+        for (Size k = 0; k < samples_; ++k)
+            values[k] = static_cast<Real>(p[k * stride]);
+    }
+
+private:
+    Size pos(Size i, Size j, Size k, Size d) const { return i * strides_[0] + j * strides_[1] + k * strides_[2] + d; }
+    void check(Size i, Size j, Size k, Size d) const {
+        QL_REQUIRE(i < numIds(), "Out of bounds on ids (i=" << i << ", numIds=" << numIds() << ")");
+        QL_REQUIRE(j < numDates(), "Out of bounds on dates (j=" << j << ", numDates=" << numDates() << ")");
+        QL_REQUIRE(k < samples(), "Out of bounds on samples (k=" << k << ", samples=" << samples() << ")");
+        QL_REQUIRE(d < depth(), "Out of bounds on depth (d=" << d << ", depth=" << depth() << ")");
+    }
+
+    QuantLib::Date asof_;
+    std::vector<QuantLib::Date> dates_;
+    Size samples_;
+    Size depth_;
+    CubeAxisOrder axisOrder_;
+    std::map<std::string, Size> idIdx_;
+    std::array<Size, 3> strides_;
+    std::vector<T> t0Data_;
+    std::vector<T> data_;
+};
+
+//! ContiguousNpvCube with single precision floating point numbers.
+using SinglePrecisionContiguousNpvCube = ContiguousNpvCube<float>;
+
+//! ContiguousNpvCube with double precision floating point numbers.
+using DoublePrecisionContiguousNpvCube = ContiguousNpvCube<double>;
+
+} // namespace analytics
+} // namespace ore
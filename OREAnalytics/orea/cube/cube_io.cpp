@@ -18,6 +18,7 @@
 
 #include <orea/cube/cube_io.hpp>
 #include <orea/cube/inmemorycube.hpp>
+#include <orea/cube/memorymappedcube.hpp>
 
 #include <ored/utilities/to_string.hpp>
 
@@ -28,6 +29,9 @@
 #endif
 #include <boost/iostreams/filtering_stream.hpp>
 
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
 #include <iomanip>
 #include <regex>
 
@@ -47,6 +51,60 @@ bool use_compression(const std::string& filename) {
 #endif
 }
 
+bool use_binary(const std::string& filename) {
+    return boost::filesystem::path(filename).extension().string() == ".bin";
+}
+
+// binary cube format: magic, byte order mark and version
+constexpr char binaryCubeMagic[8] = {'O', 'R', 'E', 'C', 'U', 'B', 'E', '\0'};
+constexpr std::uint32_t binaryCubeByteOrderMark = 0x01020304;
+constexpr std::uint32_t binaryCubeVersion = 1;
+constexpr std::uint64_t binaryCubeDataAlignment = 64;
+
+template <typename I> void writeBinary(std::ostream& out, const I& value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(I));
+}
+
+void writeBinary(std::ostream& out, const std::string& value) {
+    writeBinary<std::uint64_t>(out, value.size());
+    out.write(value.data(), value.size());
+}
+
+template <typename I> I readBinary(std::istream& in, const std::string& filename) {
+    I value;
+    in.read(reinterpret_cast<char*>(&value), sizeof(I));
+    QL_REQUIRE(in, "loadCubeBinary(): unexpected end of header in file '" << filename << "'");
+    return value;
+}
+
+std::string readBinaryString(std::istream& in, const std::string& filename) {
+    std::string value(readBinary<std::uint64_t>(in, filename), '\0');
+    in.read(&value[0], value.size());
+    QL_REQUIRE(in, "loadCubeBinary(): unexpected end of header in file '" << filename << "'");
+    return value;
+}
+
+template <typename T> void writeBinaryCubeData(std::ostream& out, const NPVCube& cube) {
+    std::vector<T> buffer(cube.depth());
+    for (Size i = 0; i < cube.numIds(); ++i) {
+        for (Size d = 0; d < cube.depth(); ++d)
+            buffer[d] = static_cast<T>(cube.getT0(i, d));
+        out.write(reinterpret_cast<const char*>(buffer.data()), sizeof(T) * buffer.size());
+    }
+    buffer.resize(cube.numDates() * cube.samples() * cube.depth());
+    for (Size i = 0; i < cube.numIds(); ++i) {
+        Size pos = 0;
+        for (Size j = 0; j < cube.numDates(); ++j) {
+            for (Size k = 0; k < cube.samples(); ++k) {
+                for (Size d = 0; d < cube.depth(); ++d) {
+                    buffer[pos++] = static_cast<T>(cube.get(i, j, k, d));
+                }
+            }
+        }
+        out.write(reinterpret_cast<const char*>(buffer.data()), sizeof(T) * buffer.size());
+    }
+}
+
 std::string getMetaData(const std::string& line, const std::string& tag, const bool mandatory = true) {
 
     // assuming a fixed width format "# tag        : <value>"
@@ -62,6 +120,11 @@ std::string getMetaData(const std::string& line, const std::string& tag, const b
 
 NPVCubeWithMetaData loadCube(const std::string& filename, const bool doublePrecision) {
 
+    // the precision of a binary cube is determined by the file
+
+    if (use_binary(filename))
+        return loadCubeBinary(filename);
+
     NPVCubeWithMetaData result;
 
     // open file
@@ -166,6 +229,11 @@ NPVCubeWithMetaData loadCube(const std::string& filename, const bool doublePreci
 
 void saveCube(const std::string& filename, const NPVCubeWithMetaData& cube, const bool doublePrecision) {
 
+    if (use_binary(filename)) {
+        saveCubeBinary(filename, cube, doublePrecision);
+        return;
+    }
+
     // open file
 
     bool gzip = use_compression(filename);
@@ -231,6 +299,134 @@ void saveCube(const std::string& filename, const NPVCubeWithMetaData& cube, cons
     }
 }
 
+NPVCubeWithMetaData loadCubeBinary(const std::string& filename) {
+
+    NPVCubeWithMetaData result;
+
+    // read header
+
+    std::ifstream in(filename, std::ios::binary | std::ios::in);
+    QL_REQUIRE(in.is_open(), "loadCubeBinary(): could not open file '" << filename << "'");
+
+    char magic[sizeof(binaryCubeMagic)];
+    in.read(magic, sizeof(magic));
+    QL_REQUIRE(in && std::equal(magic, magic + sizeof(magic), binaryCubeMagic),
+               "loadCubeBinary(): file '" << filename << "' is not a binary cube file");
+    QL_REQUIRE(readBinary<std::uint32_t>(in, filename) == binaryCubeByteOrderMark,
+               "loadCubeBinary(): file '" << filename << "' was written on a platform with different byte order");
+    std::uint32_t version = readBinary<std::uint32_t>(in, filename);
+    QL_REQUIRE(version == binaryCubeVersion,
+               "loadCubeBinary(): unsupported version " << version << " in file '" << filename << "', expected "
+                                                        << binaryCubeVersion);
+    std::uint32_t valueSize = readBinary<std::uint32_t>(in, filename);
+    QL_REQUIRE(valueSize == sizeof(float) || valueSize == sizeof(double),
+               "loadCubeBinary(): invalid value size " << valueSize << " in file '" << filename << "'");
+
+    Size numIds = readBinary<std::uint64_t>(in, filename);
+    Size numDates = readBinary<std::uint64_t>(in, filename);
+    Size samples = readBinary<std::uint64_t>(in, filename);
+    Size depth = readBinary<std::uint64_t>(in, filename);
+
+    // serial number 0 represents the null date
+    auto toDate = [](std::int64_t serial) {
+        return serial == 0 ? QuantLib::Date() : QuantLib::Date(static_cast<QuantLib::Date::serial_type>(serial));
+    };
+
+    QuantLib::Date asof = toDate(readBinary<std::int64_t>(in, filename));
+    std::vector<QuantLib::Date> dates;
+    for (Size i = 0; i < numDates; ++i)
+        dates.push_back(toDate(readBinary<std::int64_t>(in, filename)));
+
+    std::vector<std::string> ids;
+    for (Size i = 0; i < numIds; ++i)
+        ids.push_back(readBinaryString(in, filename));
+
+    if (std::string md = readBinaryString(in, filename); !md.empty()) {
+        result.scenarioGeneratorData = QuantLib::ext::make_shared<ScenarioGeneratorData>();
+        result.scenarioGeneratorData->fromXMLString(md);
+        DLOG("overwrite scenario generator data with meta data from cube: " << md);
+    }
+
+    if (std::uint8_t storeFlows = readBinary<std::uint8_t>(in, filename); storeFlows != 0) {
+        result.storeFlows = storeFlows == 2;
+        DLOG("overwrite storeFlows with meta data from cube: " << std::boolalpha << *result.storeFlows);
+    }
+
+    std::uint8_t hasStoreCrSt = readBinary<std::uint8_t>(in, filename);
+    std::uint64_t storeCrSt = readBinary<std::uint64_t>(in, filename);
+    if (hasStoreCrSt != 0) {
+        result.storeCreditStateNPVs = storeCrSt;
+        DLOG("overwrite storeCreditStateNPVs with meta data from cube: " << storeCrSt);
+    }
+
+    // data section starts at the next aligned position after the header
+
+    std::uint64_t headerSize = static_cast<std::uint64_t>(in.tellg());
+    Size dataOffset = (headerSize + binaryCubeDataAlignment - 1) / binaryCubeDataAlignment * binaryCubeDataAlignment;
+    in.close();
+
+    if (valueSize == sizeof(double))
+        result.cube = QuantLib::ext::make_shared<DoublePrecisionMemoryMappedNpvCube>(filename, dataOffset, asof, ids,
+                                                                                    dates, samples, depth);
+    else
+        result.cube = QuantLib::ext::make_shared<SinglePrecisionMemoryMappedNpvCube>(filename, dataOffset, asof, ids,
+                                                                                    dates, samples, depth);
+
+    LOG("mapped binary cube from " << filename << ": asof = " << asof << ", dim = " << numIds << " x " << numDates
+                                   << " x " << samples << " x " << depth << ", value size " << valueSize);
+
+    return result;
+}
+
+void saveCubeBinary(const std::string& filename, const NPVCubeWithMetaData& cube, const bool doublePrecision) {
+
+    std::ofstream out(filename, std::ios::binary | std::ios::out);
+    QL_REQUIRE(out.is_open(), "saveCubeBinary(): could not open file '" << filename << "'");
+
+    // write header
+
+    out.write(binaryCubeMagic, sizeof(binaryCubeMagic));
+    writeBinary(out, binaryCubeByteOrderMark);
+    writeBinary(out, binaryCubeVersion);
+    writeBinary<std::uint32_t>(out, doublePrecision ? sizeof(double) : sizeof(float));
+
+    writeBinary<std::uint64_t>(out, cube.cube->numIds());
+    writeBinary<std::uint64_t>(out, cube.cube->numDates());
+    writeBinary<std::uint64_t>(out, cube.cube->samples());
+    writeBinary<std::uint64_t>(out, cube.cube->depth());
+
+    writeBinary<std::int64_t>(out, cube.cube->asof().serialNumber());
+    for (auto const& d : cube.cube->dates())
+        writeBinary<std::int64_t>(out, d.serialNumber());
+
+    std::vector<std::string> ids(cube.cube->numIds());
+    for (auto const& d : cube.cube->idsAndIndexes())
+        ids[d.second] = d.first;
+    for (auto const& id : ids)
+        writeBinary(out, id);
+
+    writeBinary(out, cube.scenarioGeneratorData ? cube.scenarioGeneratorData->toXMLString() : std::string());
+    writeBinary<std::uint8_t>(out, cube.storeFlows ? (*cube.storeFlows ? 2 : 1) : 0);
+    writeBinary<std::uint8_t>(out, cube.storeCreditStateNPVs ? 1 : 0);
+    writeBinary<std::uint64_t>(out, cube.storeCreditStateNPVs ? *cube.storeCreditStateNPVs : 0);
+
+    // pad to the aligned start of the data section
+
+    std::uint64_t headerSize = static_cast<std::uint64_t>(out.tellp());
+    std::uint64_t padding = (binaryCubeDataAlignment - headerSize % binaryCubeDataAlignment) % binaryCubeDataAlignment;
+    for (Size i = 0; i < padding; ++i)
+        out.put('\0');
+
+    // write cube data
+
+    if (doublePrecision)
+        writeBinaryCubeData<double>(out, *cube.cube);
+    else
+        writeBinaryCubeData<float>(out, *cube.cube);
+
+    QL_REQUIRE(out, "saveCubeBinary(): error while writing to file '" << filename << "'");
+}
+
 QuantLib::ext::shared_ptr<AggregationScenarioData> loadAggregationScenarioData(const std::string& filename) {
 
     // open file
@@ -43,9 +43,19 @@ struct NPVCubeWithMetaData {
     boost::optional<Size> storeCreditStateNPVs;
 };
 
+/*! Files with extension .bin are read / written in the binary cube format, see loadCubeBinary() and
+    saveCubeBinary(). All other files use the text format (which is gzip-compressed unless the extension is .csv or .txt,
+    if ORE_USE_ZLIB is defined). */
 NPVCubeWithMetaData loadCube(const std::string& filename, const bool doublePrecision = false);
 void saveCube(const std::string& filename, const NPVCubeWithMetaData& cube, const bool doublePrecision = false);
 
+/*! The binary cube format consists of a header holding the dimensions, asof, dates, ids and the optional meta data,
+    followed by a data section starting at a 64 byte aligned offset. The data section contains the T0 values
+    (numIds x depth) and the cube values (numIds x numDates x samples x depth) as raw float or double values in the
+    native byte order. The loaded cube is a MemoryMappedNpvCube serving the values from the mapped file. */
+NPVCubeWithMetaData loadCubeBinary(const std::string& filename);
+void saveCubeBinary(const std::string& filename, const NPVCubeWithMetaData& cube, const bool doublePrecision = false);
+
 QuantLib::ext::shared_ptr<AggregationScenarioData> loadAggregationScenarioData(const std::string& filename);
 void saveAggregationScenarioData(const std::string& filename, const AggregationScenarioData& cube);
 
@@ -137,6 +137,12 @@ public:
         this->check(i, j, k, d);
         this->data_[i][j][k] = static_cast<T>(value);
     }
+
+    //! Get all samples for an id and date
+    void getSamples(std::vector<Real>& values, Size i, Size j, Size d) const override {
+        this->check(i, j, 0, d);
+        values.assign(this->data_[i][j].begin(), this->data_[i][j].end());
+    }
 };
 
 //! InMemoryCube of variable depth
@@ -178,6 +184,14 @@ public:
         this->check(i, j, k, d);
         this->data_[i][j][k][d] = static_cast<T>(value);
     }
+
+    //! Get all samples for an id, date and depth
+    void getSamples(std::vector<Real>& values, Size i, Size j, Size d) const override {
+        this->check(i, j, 0, d);
+        values.resize(this->samples_);
+        for (Size k = 0; k < this->samples_; ++k)
+            values[k] = this->data_[i][j][k][d];
+    }
 };
 
 //! InMemoryCube of depth 1 with single precision floating point numbers.
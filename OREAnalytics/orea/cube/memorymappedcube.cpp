@@ -0,0 +1,60 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <orea/cube/memorymappedcube.hpp>
+
+#include <ql/errors.hpp>
+
+namespace ore {
+namespace analytics {
+
+template <typename T>
+MemoryMappedNpvCube<T>::MemoryMappedNpvCube(const std::string& filename, Size dataOffset, const Date& asof,
+                                            const std::vector<std::string>& ids, const std::vector<Date>& dates,
+                                            Size samples, Size depth)
+    : asof_(asof), dates_(dates), samples_(samples), depth_(depth) {
+    QL_REQUIRE(ids.size() > 0, "MemoryMappedNpvCube: no ids specified");
+    QL_REQUIRE(dates.size() > 0, "MemoryMappedNpvCube: no dates specified");
+    QL_REQUIRE(samples > 0, "MemoryMappedNpvCube: samples must be > 0");
+    QL_REQUIRE(depth > 0, "MemoryMappedNpvCube: depth must be > 0");
+    QL_REQUIRE(dataOffset % sizeof(T) == 0,
+               "MemoryMappedNpvCube: data offset " << dataOffset << " is not aligned to " << sizeof(T) << " bytes");
+
+    for (Size i = 0; i < ids.size(); ++i)
+        ids_[ids[i]] = i;
+    QL_REQUIRE(ids_.size() == ids.size(), "MemoryMappedNpvCube: ids are not unique");
+
+    boost::iostreams::mapped_file_params params(filename);
+    params.flags = boost::iostreams::mapped_file::priv;
+    file_.open(params);
+    QL_REQUIRE(file_.is_open(), "MemoryMappedNpvCube: could not map file '" << filename << "'");
+
+    Size expectedSize = dataOffset + sizeof(T) * ids.size() * depth * (1 + dates.size() * samples);
+    QL_REQUIRE(file_.size() >= expectedSize, "MemoryMappedNpvCube: file '" << filename << "' has size "
+                                                                           << file_.size() << ", expected at least "
+                                                                           << expectedSize << " bytes");
+
+    t0Data_ = reinterpret_cast<T*>(file_.data() + dataOffset);
+    data_ = t0Data_ + ids.size() * depth;
+}
+
+template class MemoryMappedNpvCube<float>;
+template class MemoryMappedNpvCube<double>;
+
+} // namespace analytics
+} // namespace ore
@@ -0,0 +1,115 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file orea/cube/memorymappedcube.hpp
+    \brief cube serving its values directly from a memory mapped binary cube file
+    \ingroup cube
+*/
+
+#pragma once
+
+#include <orea/cube/npvcube.hpp>
+
+#include <boost/iostreams/device/mapped_file.hpp>
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace ore {
+namespace analytics {
+using QuantLib::Date;
+using QuantLib::Real;
+using QuantLib::Size;
+
+//! Cube backed by a memory mapped binary cube file
+/*! The cube maps the data section of a binary cube file written by saveCube() (see cube_io.hpp) and serves get()
+    directly from the mapped pages, i.e. no data is copied on construction. The file is mapped privately
+    (copy-on-write), so set() and setT0() are allowed, but changes are never written back to the file.
+
+    The data section consists of a T0 block of numIds x depth values followed by the main block of
+    numIds x numDates x samples x depth values, both in row-major order.
+
+    \ingroup cube
+*/
+template <typename T> class MemoryMappedNpvCube : public NPVCube {
+public:
+    /*! The ids are given in index order, dataOffset is the byte offset of the T0 block in the file, it must be a
+        multiple of sizeof(T). */
+    MemoryMappedNpvCube(const std::string& filename, Size dataOffset, const Date& asof,
+                        const std::vector<std::string>& ids, const std::vector<Date>& dates, Size samples, Size depth);
+
+    Size numIds() const override { return ids_.size(); }
+    Size numDates() const override { return dates_.size(); }
+    Size samples() const override { return samples_; }
+    Size depth() const override { return depth_; }
+    const std::map<std::string, Size>& idsAndIndexes() const override { return ids_; }
+    const std::vector<QuantLib::Date>& dates() const override { return dates_; }
+    QuantLib::Date asof() const override { return asof_; }
+
+    Real getT0(Size i, Size d) const override {
+        check(i, 0, 0, d);
+        return static_cast<Real>(t0Data_[i * depth_ + d]);
+    }
+    void setT0(Real value, Size i, Size d) override {
+        check(i, 0, 0, d);
+        t0Data_[i * depth_ + d] = static_cast<T>(value);
+    }
+    Real get(Size i, Size j, Size k, Size d) const override {
+        check(i, j, k, d);
+        return static_cast<Real>(data_[pos(i, j, k, d)]);
+    }
+    void set(Real value, Size i, Size j, Size k, Size d) override {
+        check(i, j, k, d);
+        data_[pos(i, j, k, d)] = static_cast<T>(value);
+    }
+    void getSamples(std::vector<Real>& values, Size i, Size j, Size d) const override {
+        check(i, j, 0, d);
+        values.resize(samples_);
+        const T* p = data_ + pos(i, j, 0, d);
+        for (Size k = 0; k < samples_; ++k)
+            values[k] = static_cast<Real>(p[k * depth_]);
+    }
+
+private:
+    Size pos(Size i, Size j, Size k, Size d) const { return ((i * dates_.size() + j) * samples_ + k) * depth_ + d; }
+    void check(Size i, Size j, Size k, Size d) const {
+        QL_REQUIRE(i < numIds(), "Out of bounds on ids (i=" << i << ", numIds=" << numIds() << ")");
+        QL_REQUIRE(j < numDates(), "Out of bounds on dates (j=" << j << ", numDates=" << numDates() << ")");
+        QL_REQUIRE(k < samples(), "Out of bounds on samples (k=" << k << ", samples=" << samples() << ")");
+        QL_REQUIRE(d < depth(), "Out of bounds on depth (d=" << d << ", depth=" << depth() << ")");
+    }
+
+    boost::iostreams::mapped_file file_;
+    QuantLib::Date asof_;
+    std::map<std::string, Size> ids_;
+    std::vector<QuantLib::Date> dates_;
+    Size samples_;
+    Size depth_;
+    T* t0Data_;
+    T* data_;
+};
+
+//! Memory mapped cube of single precision floating point numbers.
+using SinglePrecisionMemoryMappedNpvCube = MemoryMappedNpvCube<float>;
+
+//! Memory mapped cube of double precision floating point numbers.
+using DoublePrecisionMemoryMappedNpvCube = MemoryMappedNpvCube<double>;
+
+} // namespace analytics
+} // namespace ore
@@ -108,6 +108,15 @@ public:
         set(value, index(id), index(date), sample, depth);
     }
 
+    /*! Get the values of all samples for a given id, date and depth, values is resized to samples(). The default
+        implementation calls get() for each sample, derived classes override this to read the samples in one go. */
+    virtual void getSamples(std::vector<Real>& values, Size id, Size date, Size depth = 0) const;
+    //! Get the values of all samples using trade id and date
+    void getSamples(std::vector<Real>& values, const std::string& id, const QuantLib::Date& date,
+                    Size depth = 0) const {
+        getSamples(values, index(id), index(date), depth);
+    }
+
     /*! remove all values for a given id, i.e. change the state as if setT0() and set() has never been called for the id
         the default implementation has generelly to be overriden in derived classes depending on how values are stored */
     virtual void remove(Size id);
@@ -134,6 +143,12 @@ protected:
 
 // impl
 
+inline void NPVCube::getSamples(std::vector<Real>& values, Size id, Size date, Size depth) const {
+    values.resize(samples());
+    for (Size sample = 0; sample < values.size(); ++sample)
+        values[sample] = get(id, date, sample, depth);
+}
+
 inline void NPVCube::remove(Size id) {
     for (Size date = 0; date < this->numDates(); ++date) {
         for (Size depth = 0; depth < this->depth(); ++depth) {
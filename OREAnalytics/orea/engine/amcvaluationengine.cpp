@@ -21,6 +21,7 @@
 #include <orea/app/structuredanalyticserror.hpp>
 #include <orea/cube/inmemorycube.hpp>
 #include <orea/engine/observationmode.hpp>
+#include <orea/scenario/aggregationscenariodata.hpp>
 
 #include <ored/marketdata/clonedloader.hpp>
 #include <ored/marketdata/todaysmarket.hpp>
@@ -42,7 +43,9 @@
 
 #include <boost/timer/timer.hpp>
 
+#include <condition_variable>
 #include <future>
+#include <mutex>
 
 using namespace ore::data;
 using namespace ore::analytics;
@@ -140,17 +143,54 @@ feeContributions(const Size j, const QuantLib::ext::shared_ptr<ScenarioGenerator
     return result;
 }
 
-void runCoreEngine(const QuantLib::ext::shared_ptr<ore::data::Portfolio>& portfolio,
-                   const QuantLib::ext::shared_ptr<QuantExt::CrossAssetModel>& model,
-                   const QuantLib::ext::shared_ptr<ore::data::Market>& market,
-                   const QuantLib::ext::shared_ptr<ore::analytics::ScenarioGeneratorData>& sgd,
-                   const std::vector<string>& aggDataIndices, const std::vector<string>& aggDataCurrencies,
-                   const Size aggDataNumberCreditStates, QuantLib::ext::shared_ptr<ore::analytics::AggregationScenarioData> asd,
-                   QuantLib::ext::shared_ptr<NPVCube> outputCube, QuantLib::ext::shared_ptr<ProgressIndicator> progressIndicator) {
+/* Paths of the cam state process on the simulation grid (excluding T0) and the fx rates and ir states derived from
+   them on the full grid (including T0). The paths only depend on the cam and the scenario generator data, so in
+   multi-threaded runs they are generated once and shared read-only between the threads. */
+struct AmcPathData {
+    std::vector<Real> pathTimes;
+    std::vector<std::vector<RandomVariable>> paths;
+    std::vector<std::vector<std::vector<Real>>> fxBuffer;
+    std::vector<std::vector<std::vector<Real>>> irStateBuffer;
+};
+
+/* allocates the path data for the given number of samples, if expandPaths is true the paths are allocated as
+   non-deterministic random variables, so that blocks of samples can be written concurrently */
+QuantLib::ext::shared_ptr<AmcPathData>
+allocatePathData(const QuantLib::ext::shared_ptr<QuantExt::CrossAssetModel>& model,
+                 const QuantLib::ext::shared_ptr<ore::analytics::ScenarioGeneratorData>& sgd, const Size samples,
+                 const bool expandPaths) {
+    QL_REQUIRE(sgd->getGrid()->timeGrid().size() > 0, "AMCValuationEngine: empty time grid given");
+    auto pathData = QuantLib::ext::make_shared<AmcPathData>();
+    pathData->fxBuffer.resize(
+        model->components(CrossAssetModel::AssetType::FX),
+        std::vector<std::vector<Real>>(sgd->getGrid()->dates().size() + 1, std::vector<Real>(samples)));
+    pathData->irStateBuffer.resize(
+        model->components(CrossAssetModel::AssetType::IR),
+        std::vector<std::vector<Real>>(sgd->getGrid()->dates().size() + 1, std::vector<Real>(samples)));
+    pathData->pathTimes.assign(std::next(sgd->getGrid()->timeGrid().begin(), 1), sgd->getGrid()->timeGrid().end());
+    pathData->paths.resize(pathData->pathTimes.size(),
+                           std::vector<RandomVariable>(model->stateProcess()->size(), RandomVariable(samples)));
+    if (expandPaths) {
+        for (auto& p : pathData->paths)
+            for (auto& r : p)
+                r.expand();
+    }
+    return pathData;
+}
 
-    std::ostringstream detail;
-    detail << portfolio->size() << " trade" << (portfolio->size() == 1 ? "" : "s");
-    progressIndicator->updateProgress(0, portfolio->size(), detail.str());
+/* generates the paths with indices firstSample, ..., firstSample + samples - 1 into the given path data and writes
+   them to the asd (if given) at sample indices starting at asdFirstSample */
+void generatePathDataBlock(const QuantLib::ext::shared_ptr<QuantExt::CrossAssetModel>& model,
+                           const QuantLib::ext::shared_ptr<ore::data::Market>& market,
+                           const QuantLib::ext::shared_ptr<ore::analytics::ScenarioGeneratorData>& sgd,
+                           const std::vector<string>& aggDataIndices, const std::vector<string>& aggDataCurrencies,
+                           const Size aggDataNumberCreditStates,
+                           QuantLib::ext::shared_ptr<ore::analytics::AggregationScenarioData> asd,
+                           const Size asdFirstSample, const QuantLib::ext::shared_ptr<AmcPathData>& pathData,
+                           const Size firstSample, const Size samples) {
+
+    if (samples == 0)
+        return;
 
     // base currency is the base currency of the cam
 
@@ -158,10 +198,8 @@ void runCoreEngine(const QuantLib::ext::shared_ptr<ore::data::Portfolio>& portfo
 
     // timings
 
-    boost::timer::cpu_timer timer, timerTotal;
-    Real calibrationTime = 0.0, valuationTime = 0.0, asdTime = 0.0, bufferTime = 0.0, pathGenTime = 0.0, residualTime,
-         totalTime;
-    timerTotal.start();
+    boost::timer::cpu_timer timer;
+    Real asdTime = 0.0, bufferTime = 0.0, pathGenTime = 0.0;
 
     // prepare for asd writing
 
@@ -201,6 +239,200 @@ void runCoreEngine(const QuantLib::ext::shared_ptr<ore::data::Portfolio>& portfo
         LOG("No asd object set, won't write aggregation scenario data...");
     }
 
+    // the buffers for fx rates and ir states that we need for the runs against interface 1 and 2 are set up
+    // on the full grid (i.e. valuation + close-out dates, also including the T0 date)
+
+    auto& fxBuffer = pathData->fxBuffer;
+    auto& irStateBuffer = pathData->irStateBuffer;
+    auto& pathTimes = pathData->pathTimes;
+    auto& paths = pathData->paths;
+
+    // set up cache for paths
+
+    auto process = model->stateProcess();
+    if (auto tmp = QuantLib::ext::dynamic_pointer_cast<CrossAssetStateProcess>(process)) {
+        tmp->resetCache(sgd->getGrid()->timeGrid().size() - 1);
+    }
+    Size nStates = process->size();
+
+    // fill fx buffer, ir state buffer and write ASD
+
+    auto pathGenerator = makeMultiPathGenerator(sgd->sequenceType(), process, sgd->getGrid()->timeGrid(), sgd->seed(),
+                                                sgd->ordering(), sgd->directionIntegers());
+    pathGenerator->skip(firstSample);
+
+    LOG("Write ASD, fill internal fx and irState buffers for samples " << firstSample << " to "
+                                                                      << firstSample + samples << "...");
+
+    for (Size i = firstSample; i < firstSample + samples; ++i) {
+        timer.start();
+        const auto& path = pathGenerator->next().value;
+        timer.stop();
+        pathGenTime += timer.elapsed().wall * 1e-9;
+
+        // populate fx and ir state buffers, populate cached paths for interface 2
+
+        timer.start();
+        for (Size k = 0; k < fxBuffer.size(); ++k) {
+            for (Size j = 0; j < sgd->getGrid()->timeGrid().size(); ++j) {
+                fxBuffer[k][j][i] = std::exp(path[model->pIdx(CrossAssetModel::AssetType::FX, k)][j]);
+            }
+        }
+        for (Size k = 0; k < irStateBuffer.size(); ++k) {
+            for (Size j = 0; j < sgd->getGrid()->timeGrid().size(); ++j) {
+                irStateBuffer[k][j][i] = path[model->pIdx(CrossAssetModel::AssetType::IR, k)][j];
+            }
+        }
+
+        for (Size k = 0; k < nStates; ++k) {
+            for (Size j = 0; j < pathTimes.size(); ++j) {
+                paths[j][k].set(i, path[k][j + 1]);
+            }
+        }
+        timer.stop();
+        bufferTime += timer.elapsed().wall * 1e-9;
+
+        // write aggregation scenario data, TODO this seems relatively slow, can we speed it up using LgmVectorised
+
+        if (asd != nullptr) {
+            timer.start();
+            Size asdSample = asdFirstSample + i - firstSample;
+            Size dateIndex = 0;
+            for (Size k = 1; k < sgd->getGrid()->timeGrid().size(); ++k) {
+                // only write asd on valuation dates
+                if (!sgd->getGrid()->isValuationDate()[k - 1])
+                    continue;
+                // set numeraire
+                asd->set(dateIndex, asdSample, model->numeraire(0, path[0].time(k), path[0][k]),
+                         AggregationScenarioDataType::Numeraire);
+                // set fx spots
+                for (Size j = 0; j < asdCurrencyIndex.size(); ++j) {
+                    asd->set(dateIndex, asdSample, fx(fxBuffer, asdCurrencyIndex[j], k, i),
+                             AggregationScenarioDataType::FXSpot, asdCurrencyCode[j]);
+                }
+                // set index fixings
+                Date d = sgd->getGrid()->dates()[k - 1];
+                for (Size j = 0; j < asdIndex.size(); ++j) {
+                    asdIndexCurve[j]->move(d, state(irStateBuffer, asdIndexIndex[j], k, i));
+                    auto index = asdIndex[j];
+                    if (auto fb = QuantLib::ext::dynamic_pointer_cast<FallbackIborIndex>(asdIndex[j])) {
+                        // proxy fallback ibor index by its rfr index's fixing
+                        index = fb->rfrIndex();
+                    }
+                    asd->set(dateIndex, asdSample, index->fixing(index->fixingCalendar().adjust(d)),
+                             AggregationScenarioDataType::IndexFixing, asdIndexName[j]);
+                }
+                // set credit states
+                for (Size j = 0; j < aggDataNumberCreditStates; ++j) {
+                    asd->set(dateIndex, asdSample, path[model->pIdx(CrossAssetModel::AssetType::CrState, j)][k],
+                             AggregationScenarioDataType::CreditState, std::to_string(j));
+                }
+                ++dateIndex;
+            }
+            timer.stop();
+            asdTime += timer.elapsed().wall * 1e-9;
+        }
+    }
+
+    LOG("asd time             : " << asdTime << " sec");
+    LOG("buffer time          : " << bufferTime << " sec");
+    LOG("path generation time : " << pathGenTime << " sec");
+}
+
+QuantLib::ext::shared_ptr<AmcPathData>
+generatePathData(const QuantLib::ext::shared_ptr<QuantExt::CrossAssetModel>& model,
+                 const QuantLib::ext::shared_ptr<ore::data::Market>& market,
+                 const QuantLib::ext::shared_ptr<ore::analytics::ScenarioGeneratorData>& sgd,
+                 const std::vector<string>& aggDataIndices, const std::vector<string>& aggDataCurrencies,
+                 const Size aggDataNumberCreditStates,
+                 QuantLib::ext::shared_ptr<ore::analytics::AggregationScenarioData> asd, const Size samples) {
+    auto pathData = allocatePathData(model, sgd, samples, false);
+    generatePathDataBlock(model, market, sgd, aggDataIndices, aggDataCurrencies, aggDataNumberCreditStates, asd, 0,
+                          pathData, 0, samples);
+    return pathData;
+}
+
+/* The path data shared between the threads of a multi-threaded run. Thread 0 allocates the data, then each thread
+   generates the paths of its own block of samples. The data can be used once all blocks are generated. */
+class SharedAmcPathData {
+public:
+    explicit SharedAmcPathData(const Size numberOfBlocks) : pendingBlocks_(numberOfBlocks) {}
+
+    void setAllocated(const QuantLib::ext::shared_ptr<AmcPathData>& pathData) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pathData_ = pathData;
+        cv_.notify_all();
+    }
+
+    QuantLib::ext::shared_ptr<AmcPathData> allocated() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this]() { return pathData_ != nullptr || !error_.empty(); });
+        QL_REQUIRE(error_.empty(), "path generation failed: " << error_);
+        return pathData_;
+    }
+
+    void setBlockDone() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (--pendingBlocks_ == 0) {
+            // set the paths that are constant to deterministic as in a single-threaded generation
+            for (auto& p : pathData_->paths)
+                for (auto& r : p)
+                    r.updateDeterministic();
+            cv_.notify_all();
+        }
+    }
+
+    QuantLib::ext::shared_ptr<AmcPathData> complete() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this]() { return pendingBlocks_ == 0 || !error_.empty(); });
+        QL_REQUIRE(error_.empty(), "path generation failed: " << error_);
+        return pathData_;
+    }
+
+    // to be called by a thread that fails before its block is generated
+    void setError(const std::string& error) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (error_.empty())
+            error_ = error.empty() ? "unknown error" : error;
+        cv_.notify_all();
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    QuantLib::ext::shared_ptr<AmcPathData> pathData_;
+    Size pendingBlocks_;
+    std::string error_;
+};
+
+void runCoreEngine(const QuantLib::ext::shared_ptr<ore::data::Portfolio>& portfolio,
+                   const QuantLib::ext::shared_ptr<QuantExt::CrossAssetModel>& model,
+                   const QuantLib::ext::shared_ptr<ore::analytics::ScenarioGeneratorData>& sgd,
+                   const QuantLib::ext::shared_ptr<AmcPathData>& pathData, QuantLib::ext::shared_ptr<NPVCube> outputCube,
+                   QuantLib::ext::shared_ptr<ProgressIndicator> progressIndicator) {
+
+    std::ostringstream detail;
+    detail << portfolio->size() << " trade" << (portfolio->size() == 1 ? "" : "s");
+    progressIndicator->updateProgress(0, portfolio->size(), detail.str());
+
+    QL_REQUIRE(pathData->paths.empty() || pathData->paths.front().front().size() == outputCube->samples(),
+               "AMCValuationEngine: number of samples in path data ("
+                   << pathData->paths.front().front().size() << ") does not match output cube samples ("
+                   << outputCube->samples() << ") - internal error.");
+
+    // the path data is shared with other threads, it is only read here
+
+    const auto& pathTimes = pathData->pathTimes;
+    auto& paths = pathData->paths;
+    const auto& fxBuffer = pathData->fxBuffer;
+    const auto& irStateBuffer = pathData->irStateBuffer;
+
+    // timings
+
+    boost::timer::cpu_timer timer, timerTotal;
+    Real calibrationTime = 0.0, valuationTime = 0.0, residualTime, totalTime;
+    timerTotal.start();
+
     // extract AMC calculators, fees and some other infos we need from the ore wrapper
 
     LOG("Extract AMC Calculators...");
@@ -217,6 +449,8 @@ void runCoreEngine(const QuantLib::ext::shared_ptr<ore::data::Portfolio>& portfo
     RandomVariableStats::instance().enabled = true;
     RandomVariableStats::instance().data_ops = 0;
     RandomVariableStats::instance().calc_ops = 0;
+    RandomVariableStats::instance().buffer_allocations = 0;
+    RandomVariableStats::instance().buffer_reuses = 0;
     RandomVariableStats::instance().data_timer.start();
     RandomVariableStats::instance().data_timer.stop();
     RandomVariableStats::instance().calc_timer.start();
@@ -308,104 +542,6 @@ void runCoreEngine(const QuantLib::ext::shared_ptr<ore::data::Portfolio>& portfo
     calibrationTime += timer.elapsed().wall * 1e-9;
     LOG("Extracted " << amcCalculators.size() << " AMCCalculators for " << portfolio->size() << " source trades");
 
-    // set up buffers for fx rates and ir states that we need below for the runs against interface 1 and 2
-    // we set these buffers up on the full grid (i.e. valuation + close-out dates, also including the T0 date)
-
-    std::vector<std::vector<std::vector<Real>>> fxBuffer(
-        model->components(CrossAssetModel::AssetType::FX),
-        std::vector<std::vector<Real>>(sgd->getGrid()->dates().size() + 1, std::vector<Real>(outputCube->samples())));
-    std::vector<std::vector<std::vector<Real>>> irStateBuffer(
-        model->components(CrossAssetModel::AssetType::IR),
-        std::vector<std::vector<Real>>(sgd->getGrid()->dates().size() + 1, std::vector<Real>(outputCube->samples())));
-
-    // set up cache for paths
-
-    auto process = model->stateProcess();
-    if (auto tmp = QuantLib::ext::dynamic_pointer_cast<CrossAssetStateProcess>(process)) {
-        tmp->resetCache(sgd->getGrid()->timeGrid().size() - 1);
-    }
-    Size nStates = process->size();
-    QL_REQUIRE(sgd->getGrid()->timeGrid().size() > 0, "AMCValuationEngine: empty time grid given");
-    std::vector<Real> pathTimes(std::next(sgd->getGrid()->timeGrid().begin(), 1), sgd->getGrid()->timeGrid().end());
-    std::vector<std::vector<RandomVariable>> paths(
-        pathTimes.size(), std::vector<RandomVariable>(nStates, RandomVariable(outputCube->samples())));
-
-    // fill fx buffer, ir state buffer and write ASD
-
-    auto pathGenerator = makeMultiPathGenerator(sgd->sequenceType(), process, sgd->getGrid()->timeGrid(), sgd->seed(),
-                                                sgd->ordering(), sgd->directionIntegers());
-
-    LOG("Write ASD, fill internal fx and irState buffers...");
-
-    for (Size i = 0; i < outputCube->samples(); ++i) {
-        timer.start();
-        const auto& path = pathGenerator->next().value;
-        timer.stop();
-        pathGenTime += timer.elapsed().wall * 1e-9;
-
-        // populate fx and ir state buffers, populate cached paths for interface 2
-
-        timer.start();
-        for (Size k = 0; k < fxBuffer.size(); ++k) {
-            for (Size j = 0; j < sgd->getGrid()->timeGrid().size(); ++j) {
-                fxBuffer[k][j][i] = std::exp(path[model->pIdx(CrossAssetModel::AssetType::FX, k)][j]);
-            }
-        }
-        for (Size k = 0; k < irStateBuffer.size(); ++k) {
-            for (Size j = 0; j < sgd->getGrid()->timeGrid().size(); ++j) {
-                irStateBuffer[k][j][i] = path[model->pIdx(CrossAssetModel::AssetType::IR, k)][j];
-            }
-        }
-
-        for (Size k = 0; k < nStates; ++k) {
-            for (Size j = 0; j < pathTimes.size(); ++j) {
-                paths[j][k].set(i, path[k][j + 1]);
-            }
-        }
-        timer.stop();
-        bufferTime += timer.elapsed().wall * 1e-9;
-
-        // write aggregation scenario data, TODO this seems relatively slow, can we speed it up using LgmVectorised
-
-        if (asd != nullptr) {
-            timer.start();
-            Size dateIndex = 0;
-            for (Size k = 1; k < sgd->getGrid()->timeGrid().size(); ++k) {
-                // only write asd on valuation dates
-                if (!sgd->getGrid()->isValuationDate()[k - 1])
-                    continue;
-                // set numeraire
-                asd->set(dateIndex, i, model->numeraire(0, path[0].time(k), path[0][k]),
-                         AggregationScenarioDataType::Numeraire);
-                // set fx spots
-                for (Size j = 0; j < asdCurrencyIndex.size(); ++j) {
-                    asd->set(dateIndex, i, fx(fxBuffer, asdCurrencyIndex[j], k, i), AggregationScenarioDataType::FXSpot,
-                             asdCurrencyCode[j]);
-                }
-                // set index fixings
-                Date d = sgd->getGrid()->dates()[k - 1];
-                for (Size j = 0; j < asdIndex.size(); ++j) {
-                    asdIndexCurve[j]->move(d, state(irStateBuffer, asdIndexIndex[j], k, i));
-                    auto index = asdIndex[j];
-                    if (auto fb = QuantLib::ext::dynamic_pointer_cast<FallbackIborIndex>(asdIndex[j])) {
-                        // proxy fallback ibor index by its rfr index's fixing
-                        index = fb->rfrIndex();
-                    }
-                    asd->set(dateIndex, i, index->fixing(index->fixingCalendar().adjust(d)),
-                             AggregationScenarioDataType::IndexFixing, asdIndexName[j]);
-                }
-                // set credit states
-                for (Size j = 0; j < aggDataNumberCreditStates; ++j) {
-                    asd->set(dateIndex, i, path[model->pIdx(CrossAssetModel::AssetType::CrState, j)][k],
-                             AggregationScenarioDataType::CreditState, std::to_string(j));
-                }
-                ++dateIndex;
-            }
-            timer.stop();
-            asdTime += timer.elapsed().wall * 1e-9;
-        }
-    }
-
     // Run AmcCalculators
 
     LOG("Run simulation...");
@@ -573,11 +709,8 @@ void runCoreEngine(const QuantLib::ext::shared_ptr<ore::data::Portfolio>& portfo
     valuationTime += timer.elapsed().wall * 1e-9;
 
     totalTime = timerTotal.elapsed().wall * 1e-9;
-    residualTime = totalTime - (calibrationTime + pathGenTime + valuationTime + asdTime + bufferTime);
+    residualTime = totalTime - (calibrationTime + valuationTime);
     LOG("calibration time     : " << calibrationTime << " sec");
-    LOG("asd time             : " << asdTime << " sec");
-    LOG("buffer time          : " << bufferTime << " sec");
-    LOG("path generation time : " << pathGenTime << " sec");
     LOG("valuation time       : " << valuationTime << " sec");
     LOG("residual time        : " << residualTime << " sec");
     LOG("total time           : " << totalTime << " sec");
@@ -585,6 +718,8 @@ void runCoreEngine(const QuantLib::ext::shared_ptr<ore::data::Portfolio>& portfo
     LOG("RandomVariableStats  : ");
     LOG("Data Ops             : " << RandomVariableStats::instance().data_ops / 1E6 << " MOPS");
     LOG("Calc Ops             : " << RandomVariableStats::instance().calc_ops / 1E6 << " MOPS");
+    LOG("Buffer Allocations   : " << RandomVariableStats::instance().buffer_allocations);
+    LOG("Buffer Reuses        : " << RandomVariableStats::instance().buffer_reuses);
     LOG("Data Timer           : " << RandomVariableStats::instance().data_timer.elapsed().wall / 1E9 << " sec");
     LOG("Calc Timer           : " << RandomVariableStats::instance().calc_timer.elapsed().wall / 1E9 << " sec");
     LOG("Data Performace      : " << RandomVariableStats::instance().data_ops * 1E3 /
@@ -691,8 +826,9 @@ void AMCValuationEngine::buildCube(const QuantLib::ext::shared_ptr<Portfolio>& p
 
     try {
         // we can use the mt progress indicator here although we are running on a single thread
-        runCoreEngine(portfolio, model_, market_, scenarioGeneratorData_, aggDataIndices_, aggDataCurrencies_,
-                      aggDataNumberCreditStates_, asd_, outputCube,
+        auto pathData = generatePathData(model_, market_, scenarioGeneratorData_, aggDataIndices_, aggDataCurrencies_,
+                                         aggDataNumberCreditStates_, asd_, outputCube->samples());
+        runCoreEngine(portfolio, model_, scenarioGeneratorData_, pathData, outputCube,
                       QuantLib::ext::make_shared<ore::analytics::MultiThreadedProgressIndicator>(this->progressIndicators()));
     } catch (const std::exception& e) {
         QL_FAIL("Error during amc val engine run: " << e.what());
@@ -791,9 +927,25 @@ void AMCValuationEngine::buildCube(const QuantLib::ext::shared_ptr<ore::data::Po
 
     ore::analytics::ObservationMode::Mode obsMode = ore::analytics::ObservationMode::instance().mode();
 
+    /* the paths are generated once and shared read-only between the threads, which all build identical cams from the
+       same inputs. Each thread generates the paths of one block of samples against its own cam and writes the asd of
+       its block to a separate object, these are copied to the asd once all threads are finished. */
+
+    SharedAmcPathData sharedPathData(eff_nThreads);
+    std::vector<Size> blockStart(eff_nThreads + 1);
+    for (Size i = 0; i <= eff_nThreads; ++i)
+        blockStart[i] = i * nSamples_ / eff_nThreads;
+    std::vector<QuantLib::ext::shared_ptr<AggregationScenarioData>> blockAsd(eff_nThreads);
+    if (asd_ != nullptr) {
+        for (Size i = 0; i < eff_nThreads; ++i)
+            blockAsd[i] = QuantLib::ext::make_shared<InMemoryAggregationScenarioData>(
+                asd_->dimDates(), blockStart[i + 1] - blockStart[i]);
+    }
+
     for (Size i = 0; i < eff_nThreads; ++i) {
 
-        auto job = [this, obsMode, &portfoliosAsString, &loaders, &simDates, &progressIndicator](int id) -> resultType {
+        auto job = [this, obsMode, &portfoliosAsString, &loaders, &simDates, &progressIndicator, &sharedPathData,
+                    &blockStart, &blockAsd](int id) -> resultType {
             // set thread local singletons
 
             QuantLib::Settings::instance().evaluationDate() = today_;
@@ -802,6 +954,7 @@ void AMCValuationEngine::buildCube(const QuantLib::ext::shared_ptr<ore::data::Po
             LOG("Start thread " << id);
 
             int rc;
+            bool blockDone = false;
 
             try {
 
@@ -832,6 +985,16 @@ void AMCValuationEngine::buildCube(const QuantLib::ext::shared_ptr<ore::data::Po
 
                 auto cam = *modelBuilder.model();
 
+                // generate the paths of the block of this thread, the path data is allocated by thread 0
+
+                if (id == 0)
+                    sharedPathData.setAllocated(allocatePathData(cam, scenarioGeneratorData_, nSamples_, true));
+                generatePathDataBlock(cam, market, scenarioGeneratorData_, aggDataIndices_, aggDataCurrencies_,
+                                      aggDataNumberCreditStates_, blockAsd[id], 0, sharedPathData.allocated(),
+                                      blockStart[id], blockStart[id + 1] - blockStart[id]);
+                sharedPathData.setBlockDone();
+                blockDone = true;
+
                 // build portfolio against init market
 
                 auto portfolio = QuantLib::ext::make_shared<ore::data::Portfolio>();
@@ -850,10 +1013,11 @@ void AMCValuationEngine::buildCube(const QuantLib::ext::shared_ptr<ore::data::Po
 
                 portfolio->build(engineFactory, "amc-val-engine", true);
 
-                // run core engine code (asd is written for thread id 0 only)
+                // wait for the paths of the other threads and run core engine code
 
-                runCoreEngine(portfolio, cam, market, scenarioGeneratorData_, aggDataIndices_, aggDataCurrencies_,
-                              aggDataNumberCreditStates_, id == 0 ? asd_ : nullptr, miniCubes_[id], progressIndicator);
+                auto pathData = sharedPathData.complete();
+
+                runCoreEngine(portfolio, cam, scenarioGeneratorData_, pathData, miniCubes_[id], progressIndicator);
 
                 // return code 0 = ok
 
@@ -863,12 +1027,24 @@ void AMCValuationEngine::buildCube(const QuantLib::ext::shared_ptr<ore::data::Po
 
             } catch (const std::exception& e) {
 
+                // make sure the other threads do not wait for paths that this thread will never generate
+
+                if (!blockDone)
+                    sharedPathData.setError(e.what());
+
                 // log error and return code 1 = not ok
 
                 ore::analytics::StructuredAnalyticsErrorMessage("AMC Valuation Engine (multithreaded mode)", "",
                                                                 e.what())
                     .log();
                 rc = 1;
+            } catch (...) {
+                if (!blockDone)
+                    sharedPathData.setError("unknown error");
+                ore::analytics::StructuredAnalyticsErrorMessage("AMC Valuation Engine (multithreaded mode)", "",
+                                                                "unknown error")
+                    .log();
+                rc = 1;
             }
 
             // exit
@@ -900,6 +1076,19 @@ void AMCValuationEngine::buildCube(const QuantLib::ext::shared_ptr<ore::data::Po
                                              << ". Check for structured errors from 'AMCValuationEngine'.");
     }
 
+    // copy the asd of the blocks to the asd
+
+    if (asd_ != nullptr) {
+        for (Size b = 0; b < eff_nThreads; ++b) {
+            for (auto const& [type, qualifier] : blockAsd[b]->keys()) {
+                for (Size d = 0; d < blockAsd[b]->dimDates(); ++d) {
+                    for (Size i = 0; i < blockAsd[b]->dimSamples(); ++i)
+                        asd_->set(d, blockStart[b] + i, blockAsd[b]->get(d, i, type, qualifier), type, qualifier);
+                }
+            }
+        }
+    }
+
     // stop the thread pool, wait for unfinished jobs
 
     // LOG("Stop thread pool");
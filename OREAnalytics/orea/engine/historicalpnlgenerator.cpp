@@ -24,6 +24,9 @@
 #include <orea/cube/jointnpvcube.hpp>
 #include <orea/cube/inmemorycube.hpp>
 
+#include <orea/scenario/deltascenario.hpp>
+#include <orea/scenario/simplescenario.hpp>
+
 #include <boost/range/adaptor/indexed.hpp>
 
 using ore::data::EngineBuilder;
@@ -42,13 +45,89 @@ using std::vector;
 namespace ore {
 namespace analytics {
 
+namespace {
+
+/* Returns each scenario of the historical scenario generator once per filter, restricted to the risk factors the
+   filter allows. The restricted scenarios are delta scenarios on the base scenario, so that the sim market resets
+   the risk factors changed under the previous filter to their base values before the next one is applied. */
+class FilteredScenarioGenerator : public ScenarioGenerator {
+public:
+    FilteredScenarioGenerator(const QuantLib::ext::shared_ptr<HistoricalScenarioGenerator>& generator,
+                              const vector<QuantLib::ext::shared_ptr<ScenarioFilter>>& filters)
+        : generator_(generator), filters_(filters) {
+        for (Size i = 0; i < filters_.size(); ++i)
+            sharedData_.push_back(QuantLib::ext::make_shared<SimpleScenario::SharedData>());
+    }
+
+    QuantLib::ext::shared_ptr<Scenario> next(const Date& d) override {
+        if (filterIndex_ == 0)
+            scenario_ = generator_->next(d);
+        auto delta = QuantLib::ext::make_shared<SimpleScenario>(scenario_->asof(), scenario_->label(),
+                                                                scenario_->getNumeraire(), sharedData_[filterIndex_]);
+        delta->setAbsolute(scenario_->isAbsolute());
+        for (auto const& key : scenario_->keys()) {
+            if (filters_[filterIndex_]->allow(key))
+                delta->add(key, scenario_->get(key));
+        }
+        filterIndex_ = (filterIndex_ + 1) % filters_.size();
+        return QuantLib::ext::make_shared<DeltaScenario>(generator_->baseScenario(), delta);
+    }
+
+    void reset() override {
+        generator_->reset();
+        filterIndex_ = 0;
+    }
+
+private:
+    QuantLib::ext::shared_ptr<HistoricalScenarioGenerator> generator_;
+    vector<QuantLib::ext::shared_ptr<ScenarioFilter>> filters_;
+    vector<QuantLib::ext::shared_ptr<SimpleScenario::SharedData>> sharedData_;
+    QuantLib::ext::shared_ptr<Scenario> scenario_;
+    Size filterIndex_ = 0;
+};
+
+/* View on a cube of depth n with depth one and n times the number of samples, sample s of the view is stored as
+   sample s / n at depth s % n of the underlying cube. This matches the order of the FilteredScenarioGenerator. */
+class DepthInterleavedCube : public NPVCube {
+public:
+    explicit DepthInterleavedCube(const QuantLib::ext::shared_ptr<NPVCube>& cube) : cube_(cube), n_(cube->depth()) {}
+
+    Size numIds() const override { return cube_->numIds(); }
+    Size numDates() const override { return cube_->numDates(); }
+    Size samples() const override { return cube_->samples() * n_; }
+    Size depth() const override { return 1; }
+
+    const std::map<std::string, Size>& idsAndIndexes() const override { return cube_->idsAndIndexes(); }
+    const std::vector<QuantLib::Date>& dates() const override { return cube_->dates(); }
+    QuantLib::Date asof() const override { return cube_->asof(); }
+
+    Real getT0(Size id, Size depth = 0) const override { return cube_->getT0(id, 0); }
+    void setT0(Real value, Size id, Size depth = 0) override {
+        for (Size d = 0; d < n_; ++d)
+            cube_->setT0(value, id, d);
+    }
+
+    Real get(Size id, Size date, Size sample, Size depth = 0) const override {
+        return cube_->get(id, date, sample / n_, sample % n_);
+    }
+    void set(Real value, Size id, Size date, Size sample, Size depth = 0) override {
+        cube_->set(value, id, date, sample / n_, sample % n_);
+    }
+
+private:
+    QuantLib::ext::shared_ptr<NPVCube> cube_;
+    Size n_;
+};
+
+} // namespace
+
 HistoricalPnlGenerator::HistoricalPnlGenerator(
     const string& baseCurrency, const QuantLib::ext::shared_ptr<Portfolio>& portfolio,
     const QuantLib::ext::shared_ptr<ScenarioSimMarket>& simMarket,
     const QuantLib::ext::shared_ptr<HistoricalScenarioGenerator>& hisScenGen, const QuantLib::ext::shared_ptr<NPVCube>& cube,
     const set<std::pair<string, QuantLib::ext::shared_ptr<QuantExt::ModelBuilder>>>& modelBuilders, bool dryRun)
     : useSingleThreadedEngine_(true), portfolio_(portfolio), simMarket_(simMarket), hisScenGen_(hisScenGen),
-      cube_(cube), dryRun_(dryRun),
+      cube_(cube), singleDepthCube_(cube), dryRun_(dryRun),
       npvCalculator_([&baseCurrency]() -> std::vector<QuantLib::ext::shared_ptr<ValuationCalculator>> {
           return {QuantLib::ext::make_shared<NPVCalculator>(baseCurrency)};
       }) {
@@ -98,6 +177,9 @@ void HistoricalPnlGenerator::generateCube(const QuantLib::ext::shared_ptr<Scenar
     DLOG("Filling historical P&L cube for " << portfolio_->size() << " trades and " << hisScenGen_->numScenarios()
                                             << " scenarios.");
 
+    depth_ = 0;
+    skippedUpdates_ = 0;
+
     if (useSingleThreadedEngine_) {
 
         valuationEngine_->unregisterAllProgressIndicators();
@@ -106,6 +188,7 @@ void HistoricalPnlGenerator::generateCube(const QuantLib::ext::shared_ptr<Scenar
             valuationEngine_->registerProgressIndicator(i);
         }
 
+        cube_ = singleDepthCube_;
         hisScenGen_->reset();
         simMarket_->filter() = filter;
         simMarket_->reset();
@@ -129,6 +212,76 @@ void HistoricalPnlGenerator::generateCube(const QuantLib::ext::shared_ptr<Scenar
     DLOG("Historical P&L cube generated");
 }
 
+void HistoricalPnlGenerator::generateCube(const vector<QuantLib::ext::shared_ptr<ScenarioFilter>>& filters) {
+
+    QL_REQUIRE(!filters.empty(), "HistoricalPnlGenerator::generateCube(): no scenario filters given");
+
+    DLOG("Filling historical P&L cube for " << portfolio_->size() << " trades, " << hisScenGen_->numScenarios()
+                                            << " scenarios and " << filters.size() << " filters.");
+
+    depth_ = 0;
+    skippedUpdates_ = 0;
+
+    Date asof = useSingleThreadedEngine_ ? simMarket_->asofDate() : today_;
+    auto cube = QuantLib::ext::make_shared<DoublePrecisionInMemoryCubeN>(
+        asof, portfolio_->ids(), vector<Date>(1, asof), hisScenGen_->numScenarios(), filters.size());
+    QuantLib::ext::shared_ptr<NPVCube> view = QuantLib::ext::make_shared<DepthInterleavedCube>(cube);
+    auto scenarioGenerator = QuantLib::ext::make_shared<FilteredScenarioGenerator>(hisScenGen_, filters);
+
+    if (useSingleThreadedEngine_) {
+
+        valuationEngine_->unregisterAllProgressIndicators();
+        for (auto const& i : this->progressIndicators()) {
+            i->reset();
+            valuationEngine_->registerProgressIndicator(i);
+        }
+
+        // the filtered scenarios are applied without further filtering in the sim market
+        hisScenGen_->reset();
+        simMarket_->filter() = QuantLib::ext::make_shared<ScenarioFilter>();
+        simMarket_->reset();
+        hisScenGen_->baseScenario() = simMarket_->baseScenario();
+        simMarket_->scenarioGenerator() = scenarioGenerator;
+        // consecutive scenarios differ only in the risk factors of one filter, only reprice the affected trades
+        valuationEngine_->setSkipUnchangedTrades(true);
+        valuationEngine_->buildCube(portfolio_, view, npvCalculator_(), true, nullptr, nullptr, {}, dryRun_);
+        valuationEngine_->setSkipUnchangedTrades(false);
+        skippedUpdates_ = valuationEngine_->skippedUpdates();
+        simMarket_->scenarioGenerator() = hisScenGen_;
+
+    } else {
+        MultiThreadedValuationEngine engine(
+            nThreads_, today_, QuantLib::ext::make_shared<ore::analytics::DateGrid>(),
+            hisScenGen_->numScenarios() * filters.size(), loader_, scenarioGenerator, engineData_, curveConfigs_,
+            todaysMarketParams_, configuration_, simMarketData_, false, false, nullptr, referenceData_,
+            iborFallbackConfig_, true, true, true, {}, {}, {}, context_);
+        engine.setSkipUnchangedTrades(true);
+        for (auto const& i : this->progressIndicators()) {
+            i->reset();
+            engine.registerProgressIndicator(i);
+        }
+        engine.buildCube(portfolio_, npvCalculator_, {}, true, dryRun_);
+        for (auto const& s : engine.workerStatistics())
+            skippedUpdates_ += s.skippedUpdates;
+        JointNPVCube result(engine.outputCubes(), portfolio_->ids(), true);
+        for (Size i = 0; i < result.numIds(); ++i) {
+            view->setT0(result.getT0(i), i);
+            for (Size s = 0; s < result.samples(); ++s)
+                view->set(result.get(i, 0, s), i, 0, s);
+        }
+    }
+
+    cube_ = cube;
+
+    DLOG("Historical P&L cube generated");
+}
+
+void HistoricalPnlGenerator::setCubeDepth(Size depth) {
+    QL_REQUIRE(depth < cube_->depth(), "HistoricalPnlGenerator::setCubeDepth(): depth " << depth
+                                           << " out of range, cube has depth " << cube_->depth());
+    depth_ = depth;
+}
+
 vector<Real> HistoricalPnlGenerator::pnl(const TimePeriod& period, const set<pair<string, Size>>& tradeIds) const {
 
     // Create result with enough space
@@ -146,8 +299,8 @@ vector<Real> HistoricalPnlGenerator::pnl(const TimePeriod& period, const set<pai
         if (period.contains(start) && period.contains(end)) {
             Real pnl = 0.0;
             for (const auto& tradeId : tradeIds) {
-                pnl -= cube_->getT0(tradeId.second);
-                pnl += cube_->get(tradeId.second, dateIdx, s);
+                pnl -= cube_->getT0(tradeId.second, depth_);
+                pnl += cube_->get(tradeId.second, dateIdx, s, depth_);
             }
             pnls.push_back(pnl);
         }
@@ -193,7 +346,7 @@ TradePnlStore HistoricalPnlGenerator::tradeLevelPnl(const TimePeriod& period,
             // Store the t0 NPVs on first pass.
             if (t0Npvs.empty()) {
                 for (const auto& p : tradeIds) {
-                    t0Npvs.push_back(cube_->getT0(p.second));
+                    t0Npvs.push_back(cube_->getT0(p.second, depth_));
                 }
             }
 
@@ -203,7 +356,7 @@ TradePnlStore HistoricalPnlGenerator::tradeLevelPnl(const TimePeriod& period,
             // Populate the trade level P&L vector
             for (const auto elem : tradeIds | boost::adaptors::indexed(0)) {
                 auto idx = elem.index();
-                pnls.back()[idx] = cube_->get(elem.value().second, dateIdx, s) - t0Npvs[idx];
+                pnls.back()[idx] = cube_->get(elem.value().second, dateIdx, s, depth_) - t0Npvs[idx];
             }
         }
     }
@@ -86,6 +86,25 @@ public:
     */
     void generateCube(const QuantLib::ext::shared_ptr<ScenarioFilter>& filter);
 
+    /*! Generate a cube of P&L values for several scenario \p filters in a single pass over the historical
+        scenarios. Each historical scenario is applied once per filter in turn, the NPVs under filters[i] are
+        stored at depth i of the resulting cube. This is equivalent to calling generateCube(filter) for each
+        of the filters, but the historical scenarios are generated only once and, in observation modes Disable and
+        Unregister, trades that do not depend on the risk factors changed by a filter are not repriced, see
+        skippedUpdates(). The P&L methods use depth 0 of the cube after this call, use setCubeDepth() to select
+        the results for a different filter.
+    */
+    void generateCube(const std::vector<QuantLib::ext::shared_ptr<ScenarioFilter>>& filters);
+
+    /*! Select the depth of the last generated cube from which the P&L values are calculated. */
+    void setCubeDepth(QuantLib::Size depth);
+
+    /*! The number of trade updates that were skipped in the last single pass generateCube() call, since no risk
+        factor of the trade was changed by the scenario. Trades are only skipped in observation modes Disable and
+        Unregister, see ValuationEngine.
+    */
+    QuantLib::Size skippedUpdates() const { return skippedUpdates_; }
+
     /*! Return a vector of historical portfolio P&L values restricted to scenarios
         falling in \p period and restricted to the given \p tradeIds. The P&L values
         are calculated from the last cube generated by generateCube.
@@ -153,6 +172,10 @@ private:
     QuantLib::ext::shared_ptr<ScenarioSimMarket> simMarket_;
     QuantLib::ext::shared_ptr<HistoricalScenarioGenerator> hisScenGen_;
     QuantLib::ext::shared_ptr<NPVCube> cube_;
+    // the cube passed to the single-threaded ctor, cube_ may point to a multi-depth cube after a single pass run
+    QuantLib::ext::shared_ptr<NPVCube> singleDepthCube_;
+    QuantLib::Size depth_ = 0;
+    QuantLib::Size skippedUpdates_ = 0;
     QuantLib::ext::shared_ptr<ValuationEngine> valuationEngine_;
 
     // additional parameters needed for multi-threaded ctor
@@ -264,20 +264,39 @@ void MarketRiskReport::calculate(const ext::shared_ptr<MarketRiskReport::Reports
     bool runDetailTrd = runTradeDetail(reports);
     addPnlCalculators(reports);
 
-    // Loop over all the risk groups
+    // Build the scenario filters for all risk groups, skip the risk groups that disable all risk factors
+    vector<pair<ext::shared_ptr<MarketRiskGroupBase>, ext::shared_ptr<ScenarioFilter>>> riskGroupFilters;
     riskGroups_->reset();
-    Size currentRiskGroup = 0;
     while (ext::shared_ptr<MarketRiskGroupBase> riskGroup = riskGroups_->next()) {
-        LOG("[progress] Processing RiskGroup " << ++currentRiskGroup << " out of " << riskGroups_->size()
-                                                  << ") = " << riskGroup);
-
         ext::shared_ptr<ScenarioFilter> filter = createScenarioFilter(riskGroup);
-
-        // If this filter disables all risk factors, move to next risk group
         if (disablesAll(filter))
             continue;
-
         updateFilter(riskGroup, filter);
+        riskGroupFilters.push_back(std::make_pair(riskGroup, filter));
+    }
+
+    // If doing a full revaluation backtest, generate the cubes for all risk groups in one go, unless we write them
+    bool singlePass = fullReval_ && fullRevalArgs_->singlePass_ && !fullRevalArgs_->writeCube_;
+    map<ext::shared_ptr<MarketRiskGroupBase>, Size> cubeDepth;
+    if (singlePass) {
+        vector<ext::shared_ptr<ScenarioFilter>> filters;
+        for (const auto& [riskGroup, filter] : riskGroupFilters) {
+            if (generateCube(riskGroup)) {
+                cubeDepth[riskGroup] = filters.size();
+                filters.push_back(filter);
+            }
+        }
+        if (!filters.empty()) {
+            LOG("Generating the historical P&L cube for " << filters.size() << " risk groups");
+            histPnlGen_->generateCube(filters);
+        }
+    }
+
+    // Loop over all the risk groups
+    Size currentRiskGroup = 0;
+    for (const auto& [riskGroup, filter] : riskGroupFilters) {
+        LOG("[progress] Processing RiskGroup " << ++currentRiskGroup << " out of " << riskGroupFilters.size()
+                                                  << ") = " << riskGroup);
 
         if (sensiBased_)
             sensiAgg->aggregate(*sensiArgs_->sensitivityStream_, filter);
@@ -285,10 +304,14 @@ void MarketRiskReport::calculate(const ext::shared_ptr<MarketRiskReport::Reports
         // If doing a full revaluation backtest, generate the cube under this filter
         if (fullReval_) {
             if (generateCube(riskGroup)) {
-                histPnlGen_->generateCube(filter);
-                if (fullRevalArgs_->writeCube_) {
-                    CubeWriter writer(cubeFilePath(riskGroup));
-                    writer.write(histPnlGen_->cube(), {});
+                if (singlePass) {
+                    histPnlGen_->setCubeDepth(cubeDepth.at(riskGroup));
+                } else {
+                    histPnlGen_->generateCube(filter);
+                    if (fullRevalArgs_->writeCube_) {
+                        CubeWriter writer(cubeFilePath(riskGroup));
+                        writer.write(histPnlGen_->cube(), {});
+                    }
                 }
             }
         }
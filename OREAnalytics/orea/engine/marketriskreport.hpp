@@ -184,6 +184,11 @@ public:
             FILTER pattern replaced by a description of the scenario filter
         */
         std::string cubeFilename_;
+        /*! True to generate the P&L cubes for all risk groups in a single pass over the historical scenarios.
+            This requires a cube of depth equal to the number of risk groups and is not used if cube writing is
+            enabled.
+        */
+        bool singlePass_ = true;
 
         FullRevalArgs(const QuantLib::ext::shared_ptr<ore::analytics::ScenarioSimMarket>& sm,
                       const QuantLib::ext::shared_ptr<ore::data::EngineData>& ed,
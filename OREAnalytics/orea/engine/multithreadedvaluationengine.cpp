@@ -20,25 +20,89 @@
 #include <orea/cube/inmemorycube.hpp>
 #include <orea/engine/multithreadedvaluationengine.hpp>
 #include <orea/engine/observationmode.hpp>
+#include <orea/engine/valuationprofiler.hpp>
+#include <orea/engine/workstealingqueues.hpp>
 #include <orea/scenario/clonedscenariogenerator.hpp>
 
 #include <ored/marketdata/clonedloader.hpp>
+#include <ored/marketdata/fixings.hpp>
 #include <ored/marketdata/todaysmarket.hpp>
 #include <ored/portfolio/enginefactory.hpp>
 #include <ored/portfolio/trade.hpp>
 #include <ored/utilities/dategrid.hpp>
 
+#include <qle/indexes/dividendmanager.hpp>
+
 #include <boost/timer/timer.hpp>
 
+#include <atomic>
 #include <future>
-
-// #include <ctpl_stl.h>
+#include <iomanip>
+#include <mutex>
 
 namespace ore {
 namespace analytics {
 
 using QuantLib::Size;
 
+namespace {
+
+// a chunk's mini-cube shared between the threads processing the chunk's sample blocks
+struct SharedCube {
+    QuantLib::ext::shared_ptr<NPVCube> cube;
+    std::mutex mutex;
+    std::set<Size> removedIds;
+};
+
+/* view on a sample block of a shared cube; the sample blocks of the units of a chunk are disjoint, so get() and set()
+   access the underlying cube without a lock, while accesses to the T0 values and removals, which are shared between
+   the units, are serialised; removal of ids is deferred until all units have written their results */
+class SampleBlockCube : public NPVCube {
+public:
+    SampleBlockCube(SharedCube& shared, const Size firstSample, const Size samples)
+        : shared_(shared), firstSample_(firstSample), samples_(samples) {}
+
+    Size numIds() const override { return shared_.cube->numIds(); }
+    Size numDates() const override { return shared_.cube->numDates(); }
+    Size samples() const override { return samples_; }
+    Size depth() const override { return shared_.cube->depth(); }
+    const std::map<std::string, Size>& idsAndIndexes() const override { return shared_.cube->idsAndIndexes(); }
+    const std::vector<QuantLib::Date>& dates() const override { return shared_.cube->dates(); }
+    QuantLib::Date asof() const override { return shared_.cube->asof(); }
+
+    Real getT0(Size id, Size depth) const override {
+        std::lock_guard<std::mutex> lock(shared_.mutex);
+        return shared_.cube->getT0(id, depth);
+    }
+    // the units of a chunk write identical T0 values
+    void setT0(Real value, Size id, Size depth) override {
+        std::lock_guard<std::mutex> lock(shared_.mutex);
+        shared_.cube->setT0(value, id, depth);
+    }
+    Real get(Size id, Size date, Size sample, Size depth) const override {
+        QL_REQUIRE(sample < samples_, "Out of bounds on samples (k=" << sample << ", samples=" << samples_ << ")");
+        return shared_.cube->get(id, date, firstSample_ + sample, depth);
+    }
+    void set(Real value, Size id, Size date, Size sample, Size depth) override {
+        QL_REQUIRE(sample < samples_, "Out of bounds on samples (k=" << sample << ", samples=" << samples_ << ")");
+        shared_.cube->set(value, id, date, firstSample_ + sample, depth);
+    }
+    void remove(Size id) override {
+        std::lock_guard<std::mutex> lock(shared_.mutex);
+        shared_.removedIds.insert(id);
+    }
+    void remove(Size id, Size sample) override {
+        std::lock_guard<std::mutex> lock(shared_.mutex);
+        shared_.cube->remove(id, firstSample_ + sample);
+    }
+
+private:
+    SharedCube& shared_;
+    Size firstSample_, samples_;
+};
+
+} // namespace
+
 MultiThreadedValuationEngine::MultiThreadedValuationEngine(
     const Size nThreads, const QuantLib::Date& today, const QuantLib::ext::shared_ptr<ore::data::DateGrid>& dateGrid,
     const Size nSamples, const QuantLib::ext::shared_ptr<ore::data::Loader>& loader,
@@ -101,6 +165,27 @@ void MultiThreadedValuationEngine::setAggregationScenarioData(
     aggregationScenarioData_ = aggregationScenarioData;
 }
 
+void MultiThreadedValuationEngine::setWorkUnitGranularity(const Size tradeChunksPerThread, const Size samplesPerUnit) {
+    QL_REQUIRE(tradeChunksPerThread > 0, "MultiThreadedValuationEngine: tradeChunksPerThread must be > 0");
+    tradeChunksPerThread_ = tradeChunksPerThread;
+    samplesPerUnit_ = samplesPerUnit;
+}
+
+void MultiThreadedValuationEngine::setShareInitMarket(const bool shareInitMarket) {
+#ifndef QL_ENABLE_THREAD_SAFE_OBSERVER_PATTERN
+    QL_REQUIRE(!shareInitMarket, "MultiThreadedValuationEngine: sharing the init market between the threads requires a "
+                                 "build with QL_ENABLE_THREAD_SAFE_OBSERVER_PATTERN = ON.");
+#endif
+    // spreaded sim market curves evaluate the shared curves while the trades are priced, we can not allow this
+    if (shareInitMarket && useSpreadedTermStructures_) {
+        WLOG("MultiThreadedValuationEngine: init market can not be shared with spreaded term structures, each thread "
+             "builds its own todays market");
+        shareInitMarket_ = false;
+        return;
+    }
+    shareInitMarket_ = shareInitMarket;
+}
+
 void MultiThreadedValuationEngine::buildCube(
     const QuantLib::ext::shared_ptr<ore::data::Portfolio>& portfolio,
     const std::function<std::vector<QuantLib::ext::shared_ptr<ore::analytics::ValuationCalculator>>()>& calculators,
@@ -125,8 +210,11 @@ void MultiThreadedValuationEngine::buildCube(
         "configuration '"
         << configuration_ << "'.");
 
+    // if the init market is shared between the threads, it is built non-lazily, so that its objects are fully built
+    // before the threads access them
+
     QuantLib::ext::shared_ptr<ore::data::Market> initMarket = QuantLib::ext::make_shared<ore::data::TodaysMarket>(
-        today_, todaysMarketParams_, loader_, curveConfigs_, true, true, true, referenceData_, false,
+        today_, todaysMarketParams_, loader_, curveConfigs_, true, true, !shareInitMarket_, referenceData_, false,
         iborFallbackConfig_, false, handlePseudoCurrenciesTodaysMarket_);
 
     auto engineFactory = QuantLib::ext::make_shared<ore::data::EngineFactory>(
@@ -141,20 +229,20 @@ void MultiThreadedValuationEngine::buildCube(
                             << t->npvCurrency());
     }
 
-    // split portfolio into nThreads parts such that each part has an approximately similar total avg pricing time
+    // split portfolio into trade chunks such that each chunk has an approximately similar total avg pricing time
 
-    Size eff_nThreads = std::min(portfolio->size(), nThreads_);
+    Size nChunks = std::min(portfolio->size(), nThreads_ * tradeChunksPerThread_);
 
     LOG("Splitting portfolio.");
 
     LOG("portfolio size = " << portfolio->size());
     LOG("nThreads       = " << nThreads_);
-    LOG("eff nThreads   = " << eff_nThreads);
+    LOG("trade chunks   = " << nChunks);
 
-    QL_REQUIRE(eff_nThreads > 0, "effective threads are zero, this is not allowed.");
+    QL_REQUIRE(nChunks > 0, "number of trade chunks is zero, this is not allowed.");
 
     std::vector<QuantLib::ext::shared_ptr<ore::data::Portfolio>> portfolios;
-    for (Size i = 0; i < eff_nThreads; ++i)
+    for (Size i = 0; i < nChunks; ++i)
         portfolios.push_back(QuantLib::ext::make_shared<ore::data::Portfolio>());
 
     double totalAvgPricingTime = 0.0;
@@ -183,29 +271,66 @@ void MultiThreadedValuationEngine::buildCube(
     for (auto const& t : timings) {
         portfolios[portfolioIndex]->add(portfolio->get(t.first));
         portfolioTotalAvgPricingTime[portfolioIndex] += t.second;
-        if (++portfolioIndex >= eff_nThreads)
+        if (++portfolioIndex >= nChunks)
             portfolioIndex = 0;
     }
 
-    // output the portfolios into strings so that the worker threads can load them from there
+    /* output the portfolios into strings so that the worker threads can load them from there, unless the trade
+       objects are handed over to the worker threads; in the latter case we restore the pricing stats from before the
+       single pricing above, the worker threads then accumulate the stats on the trade objects directly */
 
     std::vector<std::string> portfoliosAsString;
-    for (auto const& p : portfolios) {
-        portfoliosAsString.emplace_back(p->toXMLString());
+    if (shareInitMarket_) {
+        for (auto const& [tid, t] : portfolio->trades())
+            t->resetPricingStats(pricingStats[tid].first, pricingStats[tid].second);
+    } else {
+        for (auto const& p : portfolios) {
+            portfoliosAsString.emplace_back(p->toXMLString());
+        }
     }
 
     // log info on the portfolio split
 
     LOG("Total avg pricing time     : " << totalAvgPricingTime / 1E6 << " ms");
-    for (Size i = 0; i < eff_nThreads; ++i) {
-        LOG("Portfolio #" << i << " number of trades       : " << portfolios[i]->size());
-        LOG("Portfolio #" << i << " total avg pricing time : " << portfolioTotalAvgPricingTime[i] / 1E6 << " ms");
+    for (Size i = 0; i < nChunks; ++i) {
+        LOG("Chunk #" << i << " number of trades       : " << portfolios[i]->size());
+        LOG("Chunk #" << i << " total avg pricing time : " << portfolioTotalAvgPricingTime[i] / 1E6 << " ms");
+    }
+
+    // split the samples of each chunk into blocks, the chunk populating the agg scen data is not split, since the
+    // data is populated sample by sample in the order of the simulation; in a dry run only the first sample is priced
+
+    Size samplesPerUnit = samplesPerUnit_ == 0 ? (nSamples_ + 3) / 4 : samplesPerUnit_;
+    if (dryRun || samplesPerUnit == 0)
+        samplesPerUnit = std::max<Size>(nSamples_, 1);
+
+    std::vector<std::vector<WorkUnit>> chunkUnits(nChunks);
+    Size nUnits = 0;
+    for (Size c = 0; c < nChunks; ++c) {
+        Size blockSize = c == 0 && aggregationScenarioData_ != nullptr ? std::max<Size>(nSamples_, 1) : samplesPerUnit;
+        for (Size s = 0; s < std::max<Size>(nSamples_, 1); s += blockSize)
+            chunkUnits[c].push_back(WorkUnit{c, s, std::min(blockSize, nSamples_ - s)});
+        nUnits += chunkUnits[c].size();
+    }
+
+    Size eff_nThreads = std::min(nUnits, nThreads_);
+
+    LOG("samples/unit   = " << samplesPerUnit);
+    LOG("work units     = " << nUnits);
+    LOG("eff nThreads   = " << eff_nThreads);
+
+    // distribute the units over the thread queues, all blocks of a chunk go to the same queue
+
+    WorkStealingQueues queues(eff_nThreads, nChunks, shareInitMarket_);
+    for (Size c = 0; c < nChunks; ++c) {
+        for (auto const& u : chunkUnits[c])
+            queues.push(c % eff_nThreads, u);
     }
 
     // build scenario generators for each thread as clones of the original one
 
     LOG("Cloning scenario generators for " << eff_nThreads << " threads...");
-    std::vector<QuantLib::ext::shared_ptr<ore::analytics::ScenarioGenerator>> scenarioGenerators;
+    std::vector<QuantLib::ext::shared_ptr<ore::analytics::ClonedScenarioGenerator>> scenarioGenerators;
     auto tmp =
         QuantLib::ext::make_shared<ore::analytics::ClonedScenarioGenerator>(scenarioGenerator_, dateGrid_->dates(), nSamples_);
     scenarioGenerators.push_back(tmp);
@@ -215,54 +340,79 @@ void MultiThreadedValuationEngine::buildCube(
         DLOG("generator for thread " << (i + 1) << " cloned.");
     }
 
-    // build loaders for each thread as clones of the original one
+    // build loaders for each thread as clones of the original one, unless the init market is shared
 
-    LOG("Cloning loaders for " << eff_nThreads << " threads...");
     std::vector<QuantLib::ext::shared_ptr<ore::data::ClonedLoader>> loaders;
-    for (Size i = 0; i < eff_nThreads; ++i)
-        loaders.push_back(QuantLib::ext::make_shared<ore::data::ClonedLoader>(today_, loader_));
+    if (shareInitMarket_) {
+        LOG("Sharing init market between " << eff_nThreads << " threads.");
+    } else {
+        LOG("Cloning loaders for " << eff_nThreads << " threads...");
+        for (Size i = 0; i < eff_nThreads; ++i)
+            loaders.push_back(QuantLib::ext::make_shared<ore::data::ClonedLoader>(today_, loader_));
+    }
+
+    // serialises the accesses to the shared init market and trade objects which register observers
 
-    // build nThreads mini-cubes to which each thread writes its results
+    std::mutex sharedMarketMutex;
 
-    LOG("Build " << eff_nThreads << " mini result cubes...");
+    // build one mini-cube per chunk to which the threads write the results of the chunk's sample blocks
+
+    LOG("Build " << nChunks << " mini result cubes...");
     miniCubes_.clear();
     miniNettingSetCubes_.clear();
     miniCptyCubes_.clear();
-    for (Size i = 0; i < eff_nThreads; ++i) {
+    std::vector<SharedCube> sharedCubes(nChunks), sharedNettingSetCubes(nChunks), sharedCptyCubes(nChunks);
+    for (Size i = 0; i < nChunks; ++i) {
         miniCubes_.push_back(cubeFactory_(today_, portfolios[i]->ids(), dateGrid_->valuationDates(), nSamples_));
         miniNettingSetCubes_.push_back(nettingSetCubeFactory_(today_, dateGrid_->valuationDates(), nSamples_));
         miniCptyCubes_.push_back(
             cptyCubeFactory_(today_, portfolios[i]->counterparties(), dateGrid_->valuationDates(), nSamples_));
+        sharedCubes[i].cube = miniCubes_.back();
+        sharedNettingSetCubes[i].cube = miniNettingSetCubes_.back();
+        sharedCptyCubes[i].cube = miniCptyCubes_.back();
     }
 
-    // build progress indicator consolidating the results from the threads
-
-    auto progressIndicator =
-        QuantLib::ext::make_shared<ore::analytics::MultiThreadedProgressIndicator>(this->progressIndicators());
+    // progress is reported per finished unit, measured in priced trade samples
 
-    // create the thread pool with eff_nThreads and queue size = eff_nThreads as well
+    std::mutex progressMutex;
+    unsigned long progressDone = 0;
+    unsigned long progressTotal = 0;
+    for (Size c = 0; c < nChunks; ++c)
+        progressTotal += portfolios[c]->size() * nSamples_;
 
-    // LOG("Create thread pool with " << eff_nThreads);
-    // ctpl::thread_pool threadPool(eff_nThreads);
-
-    // create the jobs and push them to the pool
+    // create the jobs
 
     using resultType = int;
     std::vector<std::future<resultType>> results(eff_nThreads);
 
-    std::vector<std::thread> jobs; // not needed if thread pool is used
+    std::vector<std::thread> jobs;
 
-    // pricing stats accumulated in worker threads
+    // pricing stats and worker statistics accumulated in worker threads
     std::vector<std::map<std::string, std::pair<std::size_t, boost::timer::nanosecond_type>>> workerPricingStats(
         eff_nThreads);
+    workerStatistics_ = std::vector<WorkerStatistics>(eff_nThreads);
+
+    // profilers of the worker threads, merged into the profiler set on this engine at the end
+    std::vector<QuantLib::ext::shared_ptr<ValuationProfiler>> workerProfilers(eff_nThreads);
+    if (profiler_) {
+        for (auto& p : workerProfilers)
+            p = QuantLib::ext::make_shared<ValuationProfiler>(engineData_);
+    }
+
+    // set by a failing thread, so that the other threads stop early
+    std::atomic<bool> failed(false);
 
     // get obs mode of main thread, so that we can set this mode in the worker threads below
     ore::analytics::ObservationMode::Mode obsMode = ore::analytics::ObservationMode::instance().mode();
 
+    boost::timer::cpu_timer parallelTimer;
+
     for (Size i = 0; i < eff_nThreads; ++i) {
 
         auto job = [this, obsMode, dryRun, &calculators, &cptyCalculators, mporStickyDate, &portfoliosAsString,
-                    &scenarioGenerators, &loaders, &workerPricingStats, &progressIndicator](int id) -> resultType {
+                    &portfolios, &initMarket, &sharedMarketMutex, &scenarioGenerators, &loaders, &workerPricingStats,
+                    &queues, &sharedCubes, &sharedNettingSetCubes, &workerProfilers,
+                    &sharedCptyCubes, &progressMutex, &progressDone, progressTotal, &failed](int id) -> resultType {
             // set thread local singletons
 
             QuantLib::Settings::instance().evaluationDate() = today_;
@@ -270,28 +420,54 @@ void MultiThreadedValuationEngine::buildCube(
 
             LOG("Start thread " << id);
 
+            boost::timer::cpu_timer threadTimer;
+            WorkerStatistics& stats = workerStatistics_[id];
+
             int rc;
 
+            // harvest the pricing stats of the chunk portfolio built in this thread
+
+            auto harvestPricingStats = [this, &workerPricingStats,
+                                        id](const QuantLib::ext::shared_ptr<ore::data::Portfolio>& p) {
+                if (p == nullptr || shareInitMarket_)
+                    return;
+                for (auto const& [tid, t] : p->trades()) {
+                    auto& s = workerPricingStats[id][tid];
+                    s.first += t->getNumberOfPricings();
+                    s.second += t->getCumulativePricingTime();
+                }
+            };
+
             try {
 
-                // build todays market using cloned market data
+                // build todays market using cloned market data or use the shared init market
 
-                QuantLib::ext::shared_ptr<ore::data::Market> initMarket = QuantLib::ext::make_shared<ore::data::TodaysMarket>(
-                    today_, todaysMarketParams_, loaders[id], curveConfigs_, true, true, true, referenceData_, false,
-                    iborFallbackConfig_, false, handlePseudoCurrenciesTodaysMarket_);
+                std::unique_lock<std::mutex> sharedMarketLock(sharedMarketMutex, std::defer_lock);
+
+                QuantLib::ext::shared_ptr<ore::data::Market> threadInitMarket;
+                if (shareInitMarket_) {
+                    // the fixings and dividends are session specific, they were applied by the todays market in the
+                    // main session only, so we apply them to this thread's session here
+                    ore::data::applyFixings(loader_->loadFixings());
+                    QuantExt::applyDividends(loader_->loadDividends());
+                    threadInitMarket = initMarket;
+                    sharedMarketLock.lock();
+                } else {
+                    threadInitMarket = QuantLib::ext::make_shared<ore::data::TodaysMarket>(
+                        today_, todaysMarketParams_, loaders[id], curveConfigs_, true, true, true, referenceData_,
+                        false, iborFallbackConfig_, false, handlePseudoCurrenciesTodaysMarket_);
+                }
 
                 // build sim market
 
                 QuantLib::ext::shared_ptr<ore::analytics::ScenarioSimMarket> simMarket =
                     QuantLib::ext::make_shared<ore::analytics::ScenarioSimMarket>(
-                        initMarket, simMarketData_, configuration_, *curveConfigs_, *todaysMarketParams_, true,
+                        threadInitMarket, simMarketData_, configuration_, *curveConfigs_, *todaysMarketParams_, true,
                         useSpreadedTermStructures_, cacheSimData_, false, iborFallbackConfig_,
                         handlePseudoCurrenciesSimMarket_, offsetScenario_);
 
-                // set aggregation scenario data, but only in one of the sim markets, that's sufficient to populate it
-
-                if (id == 0 && aggregationScenarioData_ != nullptr)
-                    simMarket->aggregationScenarioData() = aggregationScenarioData_;
+                if (sharedMarketLock.owns_lock())
+                    sharedMarketLock.unlock();
 
                 // link scenario generator to sim market
 
@@ -302,37 +478,122 @@ void MultiThreadedValuationEngine::buildCube(
                 if (scenarioFilter_)
                     simMarket->filter() = scenarioFilter_;
 
-                // build portfolio against sim market
-
-                auto portfolio = QuantLib::ext::make_shared<ore::data::Portfolio>();
-                portfolio->fromXMLString(portfoliosAsString[id]);
-                auto engineFactory = QuantLib::ext::make_shared<ore::data::EngineFactory>(
-                    engineData_, simMarket, std::map<ore::data::MarketContext, string>(), referenceData_,
-                    iborFallbackConfig_);
-
-                portfolio->build(engineFactory, context_, true);
-
-                // build valuation engine
-
-                auto valEngine = QuantLib::ext::make_shared<ore::analytics::ValuationEngine>(
-                    today_, dateGrid_, simMarket,
-                    recalibrateModels_ ? engineFactory->modelBuilders()
-                                       : std::set<std::pair<std::string, QuantLib::ext::shared_ptr<QuantExt::ModelBuilder>>>());
-                valEngine->registerProgressIndicator(progressIndicator);
-
-                // build mini-cube
-
-                valEngine->buildCube(portfolio, miniCubes_[id], calculators(), mporStickyDate, miniNettingSetCubes_[id],
-                                     miniCptyCubes_[id],
-                                     cptyCalculators ? cptyCalculators()
-                                                     : std::vector<QuantLib::ext::shared_ptr<CounterpartyCalculator>>(),
-                                     dryRun);
-
-                // set pricing stats for val engine run
-
-                for (auto const& [tid, t] : portfolio->trades())
-                    workerPricingStats[id][tid] =
-                        std::make_pair(t->getNumberOfPricings(), t->getCumulativePricingTime());
+                stats.setupTime = threadTimer.elapsed().wall * 1e-9;
+
+                /* the chunks processed by this thread with their portfolio built against the sim market, their
+                   valuation engine and calculators; the state of a chunk is set up once per thread, i.e. the trades
+                   are built and the T0 values are priced once, and is kept until all units of the chunk are handed
+                   out, so that the units share the initialisation */
+
+                struct ChunkState {
+                    QuantLib::ext::shared_ptr<ore::data::Portfolio> portfolio;
+                    QuantLib::ext::shared_ptr<ore::analytics::ValuationEngine> valEngine;
+                    std::vector<QuantLib::ext::shared_ptr<ValuationCalculator>> calculators;
+                    std::vector<QuantLib::ext::shared_ptr<CounterpartyCalculator>> cptyCalculators;
+                };
+                std::map<Size, ChunkState> chunkStates;
+
+                // process own units, then steal from the other threads
+
+                WorkUnit unit;
+                bool stolen;
+                while (!failed && queues.next(id, unit, stolen)) {
+
+                    boost::timer::cpu_timer unitTimer;
+
+                    // price the unit into sample block views on the chunk's mini-cubes
+
+                    auto blockCube = [&unit](SharedCube& c) -> QuantLib::ext::shared_ptr<NPVCube> {
+                        return c.cube ? QuantLib::ext::make_shared<SampleBlockCube>(c, unit.firstSample, unit.samples)
+                                      : nullptr;
+                    };
+
+                    // build the chunk portfolio against sim market and initialise its valuation, unless this thread
+                    // has done so already
+
+                    auto state = chunkStates.find(unit.chunk);
+                    if (state == chunkStates.end()) {
+                        ChunkState s;
+                        auto engineFactory = QuantLib::ext::make_shared<ore::data::EngineFactory>(
+                            engineData_, simMarket, std::map<ore::data::MarketContext, string>(), referenceData_,
+                            iborFallbackConfig_);
+                        if (shareInitMarket_) {
+                            // the chunk is pinned to this thread, so we can rebuild the trade objects directly
+                            std::lock_guard<std::mutex> lock(sharedMarketMutex);
+                            s.portfolio = portfolios[unit.chunk];
+                            s.portfolio->build(engineFactory, context_, true);
+                        } else {
+                            s.portfolio = QuantLib::ext::make_shared<ore::data::Portfolio>();
+                            s.portfolio->fromXMLString(portfoliosAsString[unit.chunk]);
+                            s.portfolio->build(engineFactory, context_, true);
+                        }
+                        s.valEngine = QuantLib::ext::make_shared<ore::analytics::ValuationEngine>(
+                            today_, dateGrid_, simMarket,
+                            recalibrateModels_
+                                ? engineFactory->modelBuilders()
+                                : std::set<std::pair<std::string, QuantLib::ext::shared_ptr<QuantExt::ModelBuilder>>>());
+                        s.valEngine->setProfiler(workerProfilers[id]);
+                        s.valEngine->setSkipUnchangedTrades(skipUnchangedTrades_);
+                        s.calculators = calculators();
+                        if (cptyCalculators)
+                            s.cptyCalculators = cptyCalculators();
+                        s.valEngine->initialiseCube(s.portfolio, blockCube(sharedCubes[unit.chunk]), s.calculators,
+                                                    blockCube(sharedNettingSetCubes[unit.chunk]));
+                        state = chunkStates.emplace(unit.chunk, std::move(s)).first;
+                    }
+
+                    // set aggregation scenario data, but only for the first chunk, that's sufficient to populate it
+
+                    simMarket->aggregationScenarioData() =
+                        unit.chunk == 0 ? aggregationScenarioData_ : QuantLib::ext::shared_ptr<AggregationScenarioData>();
+
+                    // position scenario generator on the first sample of the unit
+
+                    scenarioGenerators[id]->setNextSample(unit.firstSample);
+
+                    ChunkState& s = state->second;
+                    s.valEngine->buildCubeBlock(s.portfolio, blockCube(sharedCubes[unit.chunk]), s.calculators,
+                                                mporStickyDate, blockCube(sharedNettingSetCubes[unit.chunk]),
+                                                blockCube(sharedCptyCubes[unit.chunk]), s.cptyCalculators, dryRun);
+
+                    stats.skippedUpdates += s.valEngine->skippedUpdates();
+                    ++stats.units;
+                    if (stolen)
+                        ++stats.stolenUnits;
+                    stats.busyTime += unitTimer.elapsed().wall * 1e-9;
+
+                    // report progress
+
+                    {
+                        std::lock_guard<std::mutex> lock(progressMutex);
+                        progressDone += s.portfolio->size() * unit.samples;
+                        std::ostringstream detail;
+                        detail << progressDone << " of " << progressTotal << " trade samples";
+                        updateProgress(progressDone, progressTotal, detail.str());
+                    }
+
+                    // release the chunk state once no thread can get another unit of the chunk
+
+                    if (queues.exhausted(unit.chunk)) {
+                        harvestPricingStats(s.portfolio);
+                        chunkStates.erase(state);
+                    }
+                }
+
+                simMarket->aggregationScenarioData() = nullptr;
+
+                // set pricing stats for val engine runs
+
+                for (auto const& [c, s] : chunkStates)
+                    harvestPricingStats(s.portfolio);
+
+                // release the sim market, which might unregister observers from the shared init market
+
+                if (shareInitMarket_) {
+                    std::lock_guard<std::mutex> lock(sharedMarketMutex);
+                    chunkStates.clear();
+                    simMarket.reset();
+                }
 
                 // return code 0 = ok
 
@@ -345,17 +606,17 @@ void MultiThreadedValuationEngine::buildCube(
                 // log error and return code 1 = not ok
 
                 ore::analytics::StructuredAnalyticsErrorMessage("Multithreaded Valuation Engine", "", e.what()).log();
+                failed = true;
                 rc = 1;
             }
 
+            stats.totalTime = threadTimer.elapsed().wall * 1e-9;
+
             // exit
 
             return rc;
         };
 
-        // results[i] = threadPool.push(job);
-
-        // not needed if thread pool is used
         std::packaged_task<resultType(int)> task(job);
         results[i] = task.get_future();
         std::thread thread(std::move(task), i);
@@ -364,10 +625,25 @@ void MultiThreadedValuationEngine::buildCube(
 
     // check return codes from jobs
 
-    // not needed if thread pool is used
     for (auto& t : jobs)
         t.join();
 
+    /* if the trade objects were handed over to the worker threads, they are bound to the threads' sim markets, which
+       are released at this point, so we rebuild them against the init market, keeping the pricing stats accumulated
+       in the worker threads */
+
+    if (shareInitMarket_) {
+        LOG("Rebuild portfolio against init market.");
+        std::map<std::string, std::pair<std::size_t, boost::timer::nanosecond_type>> workerStats;
+        for (auto const& [tid, t] : portfolio->trades())
+            workerStats[tid] = std::make_pair(t->getNumberOfPricings(), t->getCumulativePricingTime());
+        portfolio->build(engineFactory, context_, true);
+        for (auto const& [tid, t] : portfolio->trades()) {
+            if (auto w = workerStats.find(tid); w != workerStats.end())
+                t->resetPricingStats(w->second.first, w->second.second);
+        }
+    }
+
     for (Size i = 0; i < results.size(); ++i) {
         results[i].wait();
     }
@@ -379,27 +655,53 @@ void MultiThreadedValuationEngine::buildCube(
                                              << ". Check for structured errors from 'MultiThreaded Valuation Engine'.");
     }
 
-    // stop the thread pool, wait for unfinished jobs
+    // zero out the results for trades with errors in any of the units (once all units have written their results)
+
+    for (auto* cubes : {&sharedCubes, &sharedNettingSetCubes, &sharedCptyCubes}) {
+        for (auto& c : *cubes) {
+            for (auto const& id : c.removedIds)
+                c.cube->remove(id);
+        }
+    }
 
-    // LOG("Stop thread pool");
-    // threadPool.stop(true);
+    // log per-thread utilisation
 
-    // set updated pricing stats in original portfolio
+    double parallelTime = parallelTimer.elapsed().wall * 1e-9;
+    LOG("Worker thread statistics (parallel section " << std::fixed << std::setprecision(2) << parallelTime
+                                                      << "s wall):");
+    for (Size i = 0; i < eff_nThreads; ++i) {
+        auto const& s = workerStatistics_[i];
+        LOG("Thread #" << i << ": units " << s.units << " (stolen " << s.stolenUnits << "), skipped trade updates "
+                       << s.skippedUpdates << ", setup " << std::fixed << std::setprecision(2) << s.setupTime
+                       << "s, busy " << s.busyTime << "s, total "
+                       << s.totalTime << "s, idle " << (parallelTime - s.totalTime) << "s, utilisation "
+                       << std::setprecision(1) << (parallelTime > 0.0 ? 100.0 * s.busyTime / parallelTime : 0.0)
+                       << "%");
+    }
 
-    LOG("Update pricing stats of trades.");
+    if (profiler_) {
+        for (auto const& p : workerProfilers)
+            profiler_->merge(*p);
+    }
 
-    for (auto const& [tid, t] : portfolio->trades()) {
-        auto p = pricingStats[tid];
-        std::size_t n = p.first;
-        boost::timer::nanosecond_type d = p.second;
-        for (auto const& w : workerPricingStats) {
-            auto p = w.find(tid);
-            if (p != w.end()) {
-                n += p->second.first;
-                d += p->second.second;
+    // set updated pricing stats in original portfolio, if the trade objects were handed over to the worker threads
+    // the stats are already up to date
+
+    if (!shareInitMarket_) {
+        LOG("Update pricing stats of trades.");
+        for (auto const& [tid, t] : portfolio->trades()) {
+            auto p = pricingStats[tid];
+            std::size_t n = p.first;
+            boost::timer::nanosecond_type d = p.second;
+            for (auto const& w : workerPricingStats) {
+                auto p = w.find(tid);
+                if (p != w.end()) {
+                    n += p->second.first;
+                    d += p->second.second;
+                }
             }
+            t->resetPricingStats(n, d);
         }
-        t->resetPricingStats(n, d);
     }
 
     // log timings and return the result mini-cubes
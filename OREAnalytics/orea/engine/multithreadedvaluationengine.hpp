@@ -34,12 +34,51 @@
 namespace ore {
 namespace analytics {
 
+/*! The portfolio is split into trade chunks of similar average pricing time, and the samples of each chunk are split
+    into sample blocks. Each (trade chunk, sample block) is a work unit. The units are distributed over per-thread
+    queues, each thread processes the units of its own queue and steals units from the other queues once its own
+    queue is exhausted (see WorkStealingQueues). The results of all sample blocks of a trade chunk are written to the
+    same mini-cube. A thread builds the trades of a chunk and prices their T0 values once (see
+    ValuationEngine::initialiseCube()) and prices each sample block of the chunk it processes on top of this
+    initialisation (see ValuationEngine::buildCubeBlock()).
+
+    By default each thread builds its own todays market from a cloned loader and loads its trades from an xml copy of
+    the portfolio. If setShareInitMarket(true) is called, the todays market built in buildCube() is shared between
+    the threads instead, so that the curve bootstraps are done once and each thread only builds its own sim market on
+    top of the shared market. In this mode, the trade objects of the given portfolio are handed over to the threads
+    and rebuilt against the threads' sim markets, and each trade chunk is processed by a single thread.
+
+    The shared market is not thread-safe in general, its lazy objects are calculated on first access and the objects
+    observe the evaluation date of the main session only. The mode therefore requires that the objects of the shared
+    market are fully calculated before the threads price their trades and are only read afterwards:
+    - the shared market is built non-lazily and the portfolio is priced against it before the threads start,
+    - the construction of the sim markets, which read the values of the shared market, and the trade builds are
+      serialised, since they may calculate shared objects and register observers with them,
+    - the sim markets do not refer to the shared objects during the simulation, i.e. the mode is not available with
+      spreaded term structures, in this case each thread builds its own todays market,
+    - the observers registered with the shared objects from several threads require a build with
+      QL_ENABLE_THREAD_SAFE_OBSERVER_PATTERN = ON, setShareInitMarket() throws otherwise.
+    The fixings and dividends of the loader are applied in each thread's session. Once the threads have finished, the
+    trades of the given portfolio are rebuilt against the shared market, so that they remain usable after
+    buildCube(). */
 class MultiThreadedValuationEngine : public ore::data::ProgressReporter {
 public:
+    //! statistics collected for each worker thread during buildCube()
+    struct WorkerStatistics {
+        QuantLib::Size units = 0;
+        QuantLib::Size stolenUnits = 0;
+        QuantLib::Size skippedUpdates = 0;
+        double setupTime = 0.0;
+        double busyTime = 0.0;
+        double totalTime = 0.0;
+    };
+
     /* if no cube factories are given, we create default ones as follows
        - cubeFactory          : creates DoublePrecisionInMemoryCube
        - nettingSetCubeFactory: creates nullptr
-       - cptyCubeFactory:       creates nullptr */
+       - cptyCubeFactory:       creates nullptr
+       The cubes created by the factories are written to by several threads concurrently, each thread writing to a
+       disjoint range of samples via set(), which the in-memory cubes support. */
     MultiThreadedValuationEngine(
         const QuantLib::Size nThreads, const QuantLib::Date& today,
         const QuantLib::ext::shared_ptr<ore::analytics::DateGrid>& dateGrid, const QuantLib::Size nSamples,
@@ -72,6 +111,22 @@ public:
     // can be optionally called to set the agg scen data (which is done in the ssm for single-threaded runs)
     void setAggregationScenarioData(const QuantLib::ext::shared_ptr<AggregationScenarioData>& aggregationScenarioData);
 
+    /* can be optionally called to set the granularity of the work units, the defaults are 4 trade chunks per thread
+       and samplesPerUnit = 0, which means that the samples of each chunk are split into 4 blocks. The trade chunk that
+       populates the aggregation scenario data (if set) is never split into sample blocks. */
+    void setWorkUnitGranularity(const QuantLib::Size tradeChunksPerThread, const QuantLib::Size samplesPerUnit);
+
+    /* can be optionally called to share the todays market between the threads, see the class documentation for the
+       requirements of this mode */
+    void setShareInitMarket(const bool shareInitMarket);
+
+    /* can be optionally called to profile the valuation loops, each thread records into its own profiler, these are
+       merged into the given profiler at the end of buildCube() */
+    void setProfiler(const QuantLib::ext::shared_ptr<ValuationProfiler>& profiler) { profiler_ = profiler; }
+
+    // can be optionally called to skip the update of trades whose risk factors did not change, see ValuationEngine
+    void setSkipUnchangedTrades(const bool skipUnchangedTrades) { skipUnchangedTrades_ = skipUnchangedTrades; }
+
     /* analoguous to buildCube() in the single-threaded engine, results are retrieved using below constructors
        if no cptyCalculators is given a function returning an empty vector of calculators will be returned */
     void
@@ -81,7 +136,7 @@ public:
                   cptyCalculators = {},
               bool mporStickyDate = true, bool dryRun = false);
 
-    // result output cubes (mini-cubes, one per thread)
+    // result output cubes (mini-cubes, one per trade chunk)
     std::vector<QuantLib::ext::shared_ptr<ore::analytics::NPVCube>> outputCubes() const { return miniCubes_; }
 
     // result netting cubes (might be null, if nettingSetCubeFactory is returning null)
@@ -92,6 +147,9 @@ public:
     // result cpty cubes (might be null, if cptyCubeFactory is returning null)
     std::vector<QuantLib::ext::shared_ptr<ore::analytics::NPVCube>> outputCptyCubes() const { return miniCptyCubes_; }
 
+    // worker thread statistics from the last buildCube() call
+    const std::vector<WorkerStatistics>& workerStatistics() const { return workerStatistics_; }
+
 private:
     QuantLib::Size nThreads_;
     QuantLib::Date today_;
@@ -128,6 +186,12 @@ private:
     std::vector<QuantLib::ext::shared_ptr<ore::analytics::NPVCube>> miniCubes_;
     std::vector<QuantLib::ext::shared_ptr<ore::analytics::NPVCube>> miniNettingSetCubes_;
     std::vector<QuantLib::ext::shared_ptr<ore::analytics::NPVCube>> miniCptyCubes_;
+    QuantLib::Size tradeChunksPerThread_ = 4;
+    QuantLib::Size samplesPerUnit_ = 0;
+    bool shareInitMarket_ = false;
+    QuantLib::ext::shared_ptr<ValuationProfiler> profiler_;
+    bool skipUnchangedTrades_ = false;
+    std::vector<WorkerStatistics> workerStatistics_;
 };
 
 } // namespace analytics
@@ -31,6 +31,11 @@ namespace analytics {
 //! The Global Observation setting
 /*!
   This singleton is used in ORE to control the usage of the QuantLib::ObservableSettings
+
+  In mode Batch the ScenarioSimMarket writes the quote values of a scenario with updates disabled. Afterwards each
+  yield and index curve with changed quotes is updated once and the other changed quotes notify their observers, with
+  updates deferred, so that each observer of the curves and quotes is updated once per scenario. Otherwise this mode
+  behaves like None.
   \ingroup utilities
  */
 class ObservationMode : public QuantLib::Singleton<ObservationMode> {
@@ -41,7 +46,7 @@ private:
 
 public:
     //! Allowable mode mode
-    enum class Mode { None, Disable, Defer, Unregister };
+    enum class Mode { None, Disable, Defer, Unregister, Batch };
 
     Mode mode() { return mode_; }
 
@@ -56,6 +61,8 @@ public:
             mode_ = Mode::Defer;
         else if (s == "Unregister")
             mode_ = Mode::Unregister;
+        else if (s == "Batch")
+            mode_ = Mode::Batch;
         else {
             QL_FAIL("Invalid ObserverMode string " << s);
         }
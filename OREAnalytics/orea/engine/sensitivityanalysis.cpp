@@ -189,6 +189,7 @@ void SensitivityAnalysis::generateSensitivities() {
             else
                 modelBuilders_.clear();
             ValuationEngine engine(asof_, dg, simMarket_, modelBuilders_);
+            engine.setSkipUnchangedTrades(skipUnchangedTrades_);
             for (auto const& i : this->progressIndicators())
                 engine.registerProgressIndicator(i);
             engine.buildCube(pf, cube, calculators, true, nullptr, nullptr, {}, dryRun_);
@@ -245,6 +246,7 @@ void SensitivityAnalysis::generateSensitivities() {
                     return QuantLib::ext::make_shared<ore::analytics::DoublePrecisionSensiCube>(ids, asof, samples);
                 },
                 {}, {}, context_);
+            engine.setSkipUnchangedTrades(skipUnchangedTrades_);
             for (auto const& i : this->progressIndicators())
                 engine.registerProgressIndicator(i);
 
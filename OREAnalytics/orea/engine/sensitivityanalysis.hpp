@@ -117,6 +117,9 @@ public:
     //! override shift tenors with sim market tenors
     void overrideTenors(const bool b) { overrideTenors_ = b; }
 
+    //! skip the update of trades whose risk factors are not changed by a scenario, see ValuationEngine, default true
+    void skipUnchangedTrades(const bool b) { skipUnchangedTrades_ = b; }
+
     //! the portfolio of trades
     QuantLib::ext::shared_ptr<Portfolio> portfolio() const { return portfolio_; }
 
@@ -144,6 +147,7 @@ private:
     //! Optional todays market parameters. Used in building the scenario sim market.
     QuantLib::ext::shared_ptr<ore::data::TodaysMarketParameters> todaysMarketParams_;
     bool overrideTenors_;
+    bool skipUnchangedTrades_ = true;
 
     // if true, convert sensis to base currency using the original (non-shifted) FX rate
     bool nonShiftedBaseCurrencyConversion_;
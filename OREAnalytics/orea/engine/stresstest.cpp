@@ -44,7 +44,8 @@ StressTest::StressTest(const QuantLib::ext::shared_ptr<ore::data::Portfolio>& po
                        const CurveConfigurations& curveConfigs, const TodaysMarketParameters& todaysMarketParams,
                        QuantLib::ext::shared_ptr<ScenarioFactory> scenarioFactory,
                        const QuantLib::ext::shared_ptr<ReferenceDataManager>& referenceData,
-                       const IborFallbackConfig& iborFallbackConfig, bool continueOnError) {
+                       const IborFallbackConfig& iborFallbackConfig, bool continueOnError,
+                       bool skipUnchangedTrades) {
 
     LOG("Run Stress Test");
     DLOG("Build Simulation Market");
@@ -81,6 +82,7 @@ StressTest::StressTest(const QuantLib::ext::shared_ptr<ore::data::Portfolio>& po
     vector<QuantLib::ext::shared_ptr<ValuationCalculator>> calculators;
     calculators.push_back(QuantLib::ext::make_shared<NPVCalculator>(simMarketData->baseCcy()));
     ValuationEngine engine(asof, dg, simMarket, factory->modelBuilders());
+    engine.setSkipUnchangedTrades(skipUnchangedTrades);
 
     engine.registerProgressIndicator(QuantLib::ext::make_shared<ProgressLog>("stress scenarios", 100, oreSeverity::notice));
     engine.buildCube(portfolio, cube, calculators);
@@ -65,7 +65,7 @@ public:
                QuantLib::ext::shared_ptr<ScenarioFactory> scenarioFactory = {},
                const QuantLib::ext::shared_ptr<ReferenceDataManager>& referenceData = nullptr,
                const IborFallbackConfig& iborFallbackConfig = IborFallbackConfig::defaultConfig(),
-               bool continueOnError = false);
+               bool continueOnError = false, bool skipUnchangedTrades = true);
 
     //! Return set of trades analysed
     const std::set<std::string>& trades() { return trades_; }
@@ -21,8 +21,11 @@
 #include <orea/engine/observationmode.hpp>
 #include <orea/engine/valuationcalculator.hpp>
 #include <orea/engine/valuationengine.hpp>
+#include <orea/engine/valuationprofiler.hpp>
+#include <orea/scenario/scenariosimmarket.hpp>
 #include <orea/simulation/simmarket.hpp>
 
+#include <ored/marketdata/marketobjectrecorder.hpp>
 #include <ored/portfolio/optionwrapper.hpp>
 #include <ored/portfolio/portfolio.hpp>
 #include <ored/portfolio/structuredtradeerror.hpp>
@@ -36,6 +39,9 @@
 
 #include <boost/timer/timer.hpp>
 
+#include <algorithm>
+#include <optional>
+
 using namespace QuantLib;
 using namespace QuantExt;
 using namespace std;
@@ -73,15 +79,15 @@ void ValuationEngine::buildCube(const QuantLib::ext::shared_ptr<data::Portfolio>
                                 QuantLib::ext::shared_ptr<analytics::NPVCube> outputCubeNettingSet,
                                 QuantLib::ext::shared_ptr<analytics::NPVCube> outputCptyCube,
                                 vector<QuantLib::ext::shared_ptr<CounterpartyCalculator>> cptyCalculators, bool dryRun) {
-
-    struct SimMarketResetter {
-        SimMarketResetter(QuantLib::ext::shared_ptr<SimMarket> simMarket) : simMarket_(simMarket) {}
-        ~SimMarketResetter() { simMarket_->reset(); }
-        QuantLib::ext::shared_ptr<SimMarket> simMarket_;
-    } simMarketResetter(simMarket_);
-
     LOG("Build cube with mporStickyDate=" << mporStickyDate << ", dryRun=" << std::boolalpha << dryRun);
+    initialiseCube(portfolio, outputCube, calculators, outputCubeNettingSet);
+    buildCubeBlock(portfolio, outputCube, calculators, mporStickyDate, outputCubeNettingSet, outputCptyCube,
+                   cptyCalculators, dryRun);
+}
 
+void ValuationEngine::checkCubes(const QuantLib::ext::shared_ptr<data::Portfolio>& portfolio,
+                                 const QuantLib::ext::shared_ptr<analytics::NPVCube>& outputCube,
+                                 const QuantLib::ext::shared_ptr<analytics::NPVCube>& outputCptyCube) const {
     QL_REQUIRE(portfolio->size() > 0, "ValuationEngine: Error portfolio is empty");
 
     QL_REQUIRE(outputCube->numIds() == portfolio->trades().size(),
@@ -104,14 +110,16 @@ void ValuationEngine::buildCube(const QuantLib::ext::shared_ptr<data::Portfolio>
                                                                           << "different from number of time steps ("
                                                                           << dg_->dates().size() << ")");
     }
+}
 
-    LOG("Starting ValuationEngine for " << portfolio->size() << " trades, " << outputCube->samples() << " samples and "
-                                        << dg_->size() << " dates.");
+void ValuationEngine::initialiseCube(const QuantLib::ext::shared_ptr<data::Portfolio>& portfolio,
+                                     QuantLib::ext::shared_ptr<analytics::NPVCube> outputCube,
+                                     const vector<QuantLib::ext::shared_ptr<ValuationCalculator>>& calculators,
+                                     QuantLib::ext::shared_ptr<analytics::NPVCube> outputCubeNettingSet) {
+
+    checkCubes(portfolio, outputCube, nullptr);
 
     ObservationMode::Mode om = ObservationMode::instance().mode();
-    Real updateTime = 0.0;
-    Real pricingTime = 0.0;
-    Real fixingTime = 0.0;
 
     LOG("Initialise " << calculators.size() << " valuation calculators");
     for (auto const& c : calculators) {
@@ -119,11 +127,9 @@ void ValuationEngine::buildCube(const QuantLib::ext::shared_ptr<data::Portfolio>
         c->initScenario();
     }
 
-    // Loop is Samples, Dates, Trades
     const auto& dates = dg_->dates();
     const auto& trades = portfolio->trades();
-    auto& counterparties = outputCptyCube ? outputCptyCube->idsAndIndexes() : std::map<string, Size>();
-    std::vector<bool> tradeHasError(portfolio->size(), false);
+    tradeHasError_ = std::vector<bool>(portfolio->size(), false);
     LOG("Initialise state objects...");
     // initialise state objects for each trade (required for path-dependent derivatives in particular)
     size_t i = 0;
@@ -142,7 +148,7 @@ void ValuationEngine::buildCube(const QuantLib::ext::shared_ptr<data::Portfolio>
         } catch (const std::exception& e) {
             string expMsg = string("T0 valuation error: ") + e.what();
             StructuredTradeErrorMessage(tradeId, trade->tradeType(), "ScenarioValuation", expMsg.c_str()).log();
-            tradeHasError[i] = true;
+            tradeHasError_[i] = true;
         }
 
         if (om == ObservationMode::Mode::Unregister) {
@@ -164,11 +170,66 @@ void ValuationEngine::buildCube(const QuantLib::ext::shared_ptr<data::Portfolio>
     }
     LOG("Total number of trades = " << portfolio->size());
 
+    initTradeRiskFactors(trades);
+}
+
+void ValuationEngine::buildCubeBlock(const QuantLib::ext::shared_ptr<data::Portfolio>& portfolio,
+                                     QuantLib::ext::shared_ptr<analytics::NPVCube> outputCube,
+                                     const vector<QuantLib::ext::shared_ptr<ValuationCalculator>>& calculators,
+                                     bool mporStickyDate,
+                                     QuantLib::ext::shared_ptr<analytics::NPVCube> outputCubeNettingSet,
+                                     QuantLib::ext::shared_ptr<analytics::NPVCube> outputCptyCube,
+                                     const vector<QuantLib::ext::shared_ptr<CounterpartyCalculator>>& cptyCalculators,
+                                     bool dryRun) {
+
+    struct SimMarketResetter {
+        SimMarketResetter(QuantLib::ext::shared_ptr<SimMarket> simMarket) : simMarket_(simMarket) {}
+        ~SimMarketResetter() { simMarket_->reset(); }
+        QuantLib::ext::shared_ptr<SimMarket> simMarket_;
+    } simMarketResetter(simMarket_);
+
+    checkCubes(portfolio, outputCube, outputCptyCube);
+
+    QL_REQUIRE(tradeHasError_.size() == portfolio->size(),
+               "ValuationEngine: portfolio size (" << portfolio->size()
+                                                   << ") does not match the initialised portfolio ("
+                                                   << tradeHasError_.size() << "), call initialiseCube() first");
+
+    LOG("Starting ValuationEngine for " << portfolio->size() << " trades, " << outputCube->samples() << " samples and "
+                                        << dg_->size() << " dates.");
+
+    Real updateTime = 0.0;
+    Real pricingTime = 0.0;
+    Real fixingTime = 0.0;
+
+    if (profiler_)
+        profiler_->setPortfolio(*portfolio);
+
+    // Loop is Samples, Dates, Trades
+    const auto& dates = dg_->dates();
+    const auto& trades = portfolio->trades();
+    auto& counterparties = outputCptyCube ? outputCptyCube->idsAndIndexes() : std::map<string, Size>();
+    std::vector<bool>& tradeHasError = tradeHasError_;
+
+    // track the risk factors changed by the scenarios of this block only
+    lastPricingDate_ = Date();
+    skippedUpdates_ = 0;
+    if (trackedSimMarket_) {
+        trackedSimMarket_->clearChangedRiskFactors();
+        trackedSimMarket_->trackChangedRiskFactors(true);
+    }
+
     if (!dates.empty() && dates.front() > simMarket_->asofDate()) {
         // the fixing manager is only required if sim dates contain future dates
         simMarket_->fixingManager()->initialise(portfolio, simMarket_);
     }
 
+    // notification counters of the sim market before the valuation loop
+    auto scenarioSimMarket = QuantLib::ext::dynamic_pointer_cast<ScenarioSimMarket>(simMarket_);
+    ScenarioSimMarket::NotificationCounters notificationCounters;
+    if (scenarioSimMarket)
+        notificationCounters = scenarioSimMarket->notificationCounters();
+
     cpu_timer timer;
     cpu_timer loopTimer;
     Size nTrades = trades.size();
@@ -253,7 +314,9 @@ void ValuationEngine::buildCube(const QuantLib::ext::shared_ptr<data::Portfolio>
         updateProgress(sample * nTrades, outputCube->samples() * nTrades, detail.str());
 
         timer.start();
+        ValuationProfiler::Stopwatch stopwatch(profiler_.get());
         simMarket_->fixingManager()->reset();
+        stopwatch.lap(Date(), ValuationProfiler::Phase::FixingReset);
         fixingTime += timer.elapsed().wall * 1e-9;
     }
 
@@ -273,6 +336,13 @@ void ValuationEngine::buildCube(const QuantLib::ext::shared_ptr<data::Portfolio>
         }
     }
 
+    if (trackedSimMarket_) {
+        trackedSimMarket_->trackChangedRiskFactors(false);
+        trackedSimMarket_->clearChangedRiskFactors();
+        LOG("ValuationEngine: skipped " << skippedUpdates_ << " trade updates, since no risk factor of the trade "
+                                         "changed");
+    }
+
     std::ostringstream detail;
     detail << nTrades << " trade" << (nTrades == 1 ? "" : "s") << ", " << outputCube->samples() << " sample"
            << (outputCube->samples() == 1 ? "" : "s");
@@ -282,9 +352,17 @@ void ValuationEngine::buildCube(const QuantLib::ext::shared_ptr<data::Portfolio>
                                            << "pricing " << pricingTime << " sec, "
                                            << "update " << updateTime << " sec "
                                            << "fixing " << fixingTime);
+    if (scenarioSimMarket) {
+        auto const& c = scenarioSimMarket->notificationCounters();
+        LOG("ValuationEngine: applied "
+            << c.scenarios - notificationCounters.scenarios << " scenarios with "
+            << c.quoteUpdates - notificationCounters.quoteUpdates << " quote updates, "
+            << c.changedQuotes - notificationCounters.changedQuotes << " changed quotes and "
+            << c.notifications - notificationCounters.notifications << " notifications");
+    }
 
     // for trades with errors set all output cube values to zero
-    i = 0;
+    Size i = 0;
     for (auto& [tradeId, trade] : trades) {
         if (tradeHasError[i]) {
             ALOG("setting all results in output cube to zero for trade '"
@@ -295,6 +373,76 @@ void ValuationEngine::buildCube(const QuantLib::ext::shared_ptr<data::Portfolio>
     }
 }
 
+void ValuationEngine::initTradeRiskFactors(const std::map<std::string, QuantLib::ext::shared_ptr<Trade>>& trades) {
+    trackedSimMarket_ = nullptr;
+    riskFactorIndex_.clear();
+    tradeRiskFactors_.clear();
+    tradeAlwaysUpdated_.clear();
+    tradeToUpdate_.clear();
+    lastPricingDate_ = Date();
+    skippedUpdates_ = 0;
+
+    ObservationMode::Mode om = ObservationMode::instance().mode();
+    if (!skipUnchangedTrades_ || (om != ObservationMode::Mode::Disable && om != ObservationMode::Mode::Unregister))
+        return;
+
+    trackedSimMarket_ = QuantLib::ext::dynamic_pointer_cast<ScenarioSimMarket>(simMarket_);
+    if (!trackedSimMarket_) {
+        WLOG("ValuationEngine: can not skip unchanged trades, since the sim market is not a ScenarioSimMarket");
+        return;
+    }
+
+    Size j = 0, nAlwaysUpdated = 0;
+    tradeRiskFactors_.resize(trades.size());
+    tradeAlwaysUpdated_.resize(trades.size(), false);
+    tradeToUpdate_.resize(trades.size(), true);
+    for (auto const& [tradeId, trade] : trades) {
+        std::set<std::pair<RiskFactorKey::KeyType, std::string>> factors;
+        if (trade->requiredMarketObjectsComplete() &&
+            trackedSimMarket_->riskFactors(trade->requiredMarketObjects(), factors)) {
+            for (auto const& f : factors)
+                tradeRiskFactors_[j].push_back(riskFactorIndex_.emplace(f, riskFactorIndex_.size()).first->second);
+        } else {
+            DLOG("ValuationEngine: risk factors of trade '" << tradeId << "' unknown, will always update it");
+            tradeAlwaysUpdated_[j] = true;
+            ++nAlwaysUpdated;
+        }
+        ++j;
+    }
+
+    LOG("ValuationEngine: skip unchanged trades, " << riskFactorIndex_.size() << " risk factors, " << nAlwaysUpdated
+                                                   << " out of " << trades.size() << " trades are always updated");
+}
+
+void ValuationEngine::updateTradesToUpdate(const Date& d, bool isCloseOutDate) {
+    if (!trackedSimMarket_)
+        return;
+
+    // on a new date or after a close-out date all trades are updated
+    bool all = isCloseOutDate || d != lastPricingDate_;
+    lastPricingDate_ = isCloseOutDate ? Date() : d;
+
+    if (all) {
+        std::fill(tradeToUpdate_.begin(), tradeToUpdate_.end(), true);
+    } else {
+        // a risk factor with empty name stands for all risk factors of the key type
+        std::vector<bool> changed(riskFactorIndex_.size(), false);
+        for (auto const& [keyType, name] : trackedSimMarket_->changedRiskFactors()) {
+            if (auto f = riskFactorIndex_.find(std::make_pair(keyType, name)); f != riskFactorIndex_.end())
+                changed[f->second] = true;
+            if (auto f = riskFactorIndex_.find(std::make_pair(keyType, std::string())); f != riskFactorIndex_.end())
+                changed[f->second] = true;
+        }
+        for (Size j = 0; j < tradeToUpdate_.size(); ++j) {
+            tradeToUpdate_[j] = tradeAlwaysUpdated_[j] ||
+                                std::any_of(tradeRiskFactors_[j].begin(), tradeRiskFactors_[j].end(),
+                                            [&changed](Size f) { return changed[f]; });
+        }
+    }
+
+    trackedSimMarket_->clearChangedRiskFactors();
+}
+
 void ValuationEngine::runCalculators(bool isCloseOutDate, const std::map<std::string, QuantLib::ext::shared_ptr<Trade>>& trades,
                                      std::vector<bool>& tradeHasError,
                                      const std::vector<QuantLib::ext::shared_ptr<ValuationCalculator>>& calculators,
@@ -312,19 +460,40 @@ void ValuationEngine::runCalculators(bool isCloseOutDate, const std::map<std::st
             continue;
         }
 
+        ValuationProfiler::Stopwatch stopwatch(profiler_.get());
+        std::size_t numberOfPricings = profiler_ ? trade->getNumberOfPricings() : 0;
+
+        // market objects that are required after the build are not covered by the trade's risk factors, if there are
+        // any, the risk factors of the trade are unknown and we update it always from now on
+        std::optional<MarketObjectRecorder> recorder;
+        if (trackedSimMarket_ && !tradeAlwaysUpdated_[j])
+            recorder.emplace();
+
         // We can avoid checking mode here and always call updateQlInstruments()
-        if (om == ObservationMode::Mode::Disable || om == ObservationMode::Mode::Unregister)
-            trade->instrument()->updateQlInstruments();
+        if (om == ObservationMode::Mode::Disable || om == ObservationMode::Mode::Unregister) {
+            if (tradeToUpdate_.empty() || tradeToUpdate_[j])
+                trade->instrument()->updateQlInstruments();
+            else
+                ++skippedUpdates_;
+        }
         try {
             for (auto& calc : calculators)
                 calc->calculate(trade, j, simMarket_, outputCube, outputCubeNettingSet, d, cubeDateIndex, sample,
                                 isCloseOutDate);
+            if (profiler_)
+                profiler_->addTradePricing(j, stopwatch.lap(), trade->getNumberOfPricings() - numberOfPricings);
         } catch (const std::exception& e) {
             string expMsg = "date = " + ore::data::to_string(io::iso_date(d)) +
                             ", sample = " + ore::data::to_string(sample) + ", label = " + label + ": " + e.what();
             StructuredTradeErrorMessage(trade->id(), trade->tradeType(), "ScenarioValuation", expMsg.c_str()).log();
             tradeHasError[j] = true;
         }
+
+        if (recorder && (!recorder->objects().empty() || !recorder->complete())) {
+            DLOG("ValuationEngine: trade '" << trade->id()
+                                            << "' required market objects after its build, will always update it");
+            tradeAlwaysUpdated_[j] = true;
+        }
     }
 }
 
@@ -365,21 +534,27 @@ std::pair<double, double> ValuationEngine::populateCube(
     QL_REQUIRE(cubeDateIndex >= 0, "first date should be a valuation date");
     cpu_timer timer;
     timer.start();
+    ValuationProfiler::Stopwatch stopwatch(profiler_.get());
     simMarket_->preUpdate();
     if (isValueDate || !isStickyDate) {
         simMarket_->updateDate(d);
     }
+    stopwatch.lap(d, ValuationProfiler::Phase::UpdateDate);
     // We can skip this step, if we have done that above in the close-out date section
     if (!scenarioUpdated) {
         simMarket_->updateScenario(d);
+        stopwatch.lap(d, ValuationProfiler::Phase::UpdateScenario);
     }
     // Always with fixing update here, in contrast to the close-out date section
     simMarket_->postUpdate(d, !isStickyDate || isValueDate);
+    stopwatch.lap(d, ValuationProfiler::Phase::PostUpdate);
     // Aggregation scenario data update on valuation dates only
     if (isValueDate) {
         simMarket_->updateAsd(d);
+        stopwatch.lap(d, ValuationProfiler::Phase::UpdateAsd);
     }
     recalibrateModels();
+    stopwatch.lap(d, ValuationProfiler::Phase::Recalibration);
 
     timer.stop();
     updateTime += timer.elapsed().wall * 1e-9;
@@ -388,13 +563,16 @@ std::pair<double, double> ValuationEngine::populateCube(
     if (isStickyDate && !isValueDate) // switch on again, if sticky
         tradeExercisable(false, trades);
     // loop over trades
+    updateTradesToUpdate(d, !isValueDate);
     runCalculators(!isValueDate, trades, tradeHasError, calculators, outputCube, outputCubeNettingSet, d, cubeDateIndex,
                    sample, simMarket_->label());
     if (isStickyDate && !isValueDate) // switch on again, if sticky
         tradeExercisable(true, trades);
+    stopwatch.lap(d, ValuationProfiler::Phase::Pricing);
     // loop over counterparty names
     if (isValueDate) {
         runCalculators(false, counterparties, cptyCalculators, outputCptyCube, d, cubeDateIndex, sample);
+        stopwatch.lap(d, ValuationProfiler::Phase::CounterpartyCalcs);
     }
     timer.stop();
     pricingTime += timer.elapsed().wall * 1e-9;
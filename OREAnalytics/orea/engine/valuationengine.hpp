@@ -23,6 +23,8 @@
 
 #pragma once
 
+#include <orea/scenario/scenario.hpp>
+
 #include <ored/utilities/progressbar.hpp>
 
 #include <ql/time/date.hpp>
@@ -47,6 +49,8 @@ class NPVCube;
 class CounterpartyCalculator;
 class ValuationCalculator;
 class SimMarket;
+class ScenarioSimMarket;
+class ValuationProfiler;
 
 using std::set;
 
@@ -64,6 +68,18 @@ using std::set;
   In addition to storing the resulting NPVs it can be given any number of calculators
   that can store additional values in the cube.
 
+  If a profiler is set, the time spent in each phase of the valuation loop and the pricing time of each trade are
+  recorded in the profiler, see ValuationProfiler.
+
+  In observation modes Disable and Unregister the instruments of all trades are updated before each pricing. If
+  setSkipUnchangedTrades() is called with true and the sim market is a ScenarioSimMarket, the engine builds an index
+  from each trade to the risk factors of the market objects it required during its build (see
+  ore::data::MarketObjectRecorder) and only updates the instruments of the trades with risk factors that were changed
+  by the last scenario. The other trades return their cached NPV. This applies to repeated pricings on the same date
+  only, i.e. to sensitivity and stress runs, on a change of the valuation date all trades are updated. A trade that
+  requires market objects after its build, e.g. while it is priced, is updated always from then on, since its risk
+  factors are not known.
+
   \ingroup simulation
 */
 class ValuationEngine : public ore::data::ProgressReporter {
@@ -99,7 +115,54 @@ public:
         //! Limit samples to one and fill the rest of the cube with random values
         bool dryRun = false);
 
+    /*! Initialise the valuation of a portfolio, i.e. the calculators, the state objects of the trades and the risk
+        factor index used to skip unchanged trades, and write the T0 values to the output cubes. This is the first
+        part of buildCube(), the samples are priced by subsequent calls of buildCubeBlock(). */
+    void initialiseCube(
+        //! Portfolio to be priced
+        const QuantLib::ext::shared_ptr<data::Portfolio>& portfolio,
+        //! Object for storing the T0 results at trade level
+        QuantLib::ext::shared_ptr<analytics::NPVCube> outputCube,
+        //! Calculators to use
+        const std::vector<QuantLib::ext::shared_ptr<ValuationCalculator>>& calculators,
+        //! Output cube for netting set-level results
+        QuantLib::ext::shared_ptr<analytics::NPVCube> outputCubeNettingSet = nullptr);
+
+    /*! Price all samples of the output cube, which might be a block of the samples of a larger cube. The portfolio and
+        calculators must be the ones given to the last initialiseCube() call, they are not initialised again. Trades
+        with an error in the initialisation or in a previous block are not priced. The scenario generator of the sim
+        market must be positioned on the first sample of the block. */
+    void buildCubeBlock(
+        //! Portfolio to be priced
+        const QuantLib::ext::shared_ptr<data::Portfolio>& portfolio,
+        //! Object for storing the results at trade level (e.g. NPVs, close-out NPVs, flows)
+        QuantLib::ext::shared_ptr<analytics::NPVCube> outputCube,
+        //! Calculators to use
+        const std::vector<QuantLib::ext::shared_ptr<ValuationCalculator>>& calculators,
+        //! Use sticky date in MPOR evaluation?
+        bool mporStickyDate = true,
+        //! Output cube for netting set-level results
+        QuantLib::ext::shared_ptr<analytics::NPVCube> outputCubeNettingSet = nullptr,
+        //! Output cube for storing counterparty-level survival probabilities
+        QuantLib::ext::shared_ptr<analytics::NPVCube> outputCptyCube = nullptr,
+        //! Calculators for filling counterparty-level results
+        const std::vector<QuantLib::ext::shared_ptr<CounterpartyCalculator>>& cptyCalculators = {},
+        //! Limit samples to one and fill the rest of the cube with random values
+        bool dryRun = false);
+
+    //! Set a profiler for the following buildCube() calls, a null pointer disables the profiling
+    void setProfiler(const QuantLib::ext::shared_ptr<ValuationProfiler>& profiler) { profiler_ = profiler; }
+
+    //! Skip the update of trades whose risk factors did not change, see the class documentation
+    void setSkipUnchangedTrades(const bool skipUnchangedTrades) { skipUnchangedTrades_ = skipUnchangedTrades; }
+
+    //! The number of trade updates that were skipped in the last buildCube() or buildCubeBlock() call
+    QuantLib::Size skippedUpdates() const { return skippedUpdates_; }
+
 private:
+    void checkCubes(const QuantLib::ext::shared_ptr<data::Portfolio>& portfolio,
+                    const QuantLib::ext::shared_ptr<analytics::NPVCube>& outputCube,
+                    const QuantLib::ext::shared_ptr<analytics::NPVCube>& outputCptyCube) const;
     void recalibrateModels();
     std::pair<double, double> populateCube(const QuantLib::Date& d, size_t cubeDateIndex, size_t sample,
                                            bool isValueDate, bool isStickyDate, bool scenarioUpdated,
@@ -122,10 +185,25 @@ private:
                         QuantLib::ext::shared_ptr<analytics::NPVCube>& cptyCube, const QuantLib::Date& d,
                         const QuantLib::Size cubeDateIndex, const QuantLib::Size sample);
     void tradeExercisable(bool enable, const std::map<std::string, QuantLib::ext::shared_ptr<ore::data::Trade>>& trades);
+    void initTradeRiskFactors(const std::map<std::string, QuantLib::ext::shared_ptr<ore::data::Trade>>& trades);
+    void updateTradesToUpdate(const QuantLib::Date& d, bool isCloseOutDate);
     QuantLib::Date today_;
     QuantLib::ext::shared_ptr<ore::data::DateGrid> dg_;
     QuantLib::ext::shared_ptr<ore::analytics::SimMarket> simMarket_;
     set<std::pair<std::string, QuantLib::ext::shared_ptr<QuantExt::ModelBuilder>>> modelBuilders_;
+    QuantLib::ext::shared_ptr<ValuationProfiler> profiler_;
+    // trades with an error in initialiseCube() or one of the buildCubeBlock() calls
+    std::vector<bool> tradeHasError_;
+
+    // tracking of the trades to update, see setSkipUnchangedTrades()
+    bool skipUnchangedTrades_ = false;
+    QuantLib::ext::shared_ptr<ScenarioSimMarket> trackedSimMarket_;
+    std::map<std::pair<RiskFactorKey::KeyType, std::string>, QuantLib::Size> riskFactorIndex_;
+    std::vector<std::vector<QuantLib::Size>> tradeRiskFactors_;
+    std::vector<bool> tradeAlwaysUpdated_;
+    std::vector<bool> tradeToUpdate_;
+    QuantLib::Date lastPricingDate_;
+    QuantLib::Size skippedUpdates_ = 0;
 };
 } // namespace analytics
 } // namespace ore
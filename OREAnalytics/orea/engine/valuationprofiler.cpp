@@ -0,0 +1,142 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <orea/engine/valuationprofiler.hpp>
+
+#include <ored/portfolio/enginedata.hpp>
+#include <ored/portfolio/portfolio.hpp>
+
+#include <ql/errors.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace ore {
+namespace analytics {
+
+void ValuationProfiler::Statistics::add(double seconds, QuantLib::Size recalculations) {
+    min = count == 0 ? seconds : std::min(min, seconds);
+    max = count == 0 ? seconds : std::max(max, seconds);
+    ++count;
+    this->recalculations += recalculations;
+    total += seconds;
+    double micros = seconds * 1.0E6;
+    QuantLib::Size b = micros < 1.0 ? 0 : static_cast<QuantLib::Size>(std::floor(std::log2(micros))) + 1;
+    ++histogram[std::min(b, histogramBuckets - 1)];
+}
+
+void ValuationProfiler::Statistics::add(const Statistics& s) {
+    if (s.count == 0)
+        return;
+    min = count == 0 ? s.min : std::min(min, s.min);
+    max = count == 0 ? s.max : std::max(max, s.max);
+    count += s.count;
+    recalculations += s.recalculations;
+    total += s.total;
+    for (QuantLib::Size b = 0; b < histogramBuckets; ++b)
+        histogram[b] += s.histogram[b];
+}
+
+double ValuationProfiler::Statistics::bucketLowerBound(QuantLib::Size b) {
+    return b == 0 ? 0.0 : std::ldexp(1.0, static_cast<int>(b) - 1);
+}
+
+ValuationProfiler::Stopwatch::Stopwatch(ValuationProfiler* profiler) : profiler_(profiler) {
+    if (profiler_)
+        start_ = std::chrono::steady_clock::now();
+}
+
+double ValuationProfiler::Stopwatch::lap() {
+    auto now = std::chrono::steady_clock::now();
+    double seconds = std::chrono::duration<double>(now - start_).count();
+    start_ = now;
+    return seconds;
+}
+
+void ValuationProfiler::Stopwatch::lap(const QuantLib::Date& d, Phase phase) {
+    if (profiler_)
+        profiler_->addPhase(d, phase, lap());
+}
+
+ValuationProfiler::ValuationProfiler(const QuantLib::ext::shared_ptr<ore::data::EngineData>& engineData)
+    : engineData_(engineData) {}
+
+void ValuationProfiler::setPortfolio(const ore::data::Portfolio& portfolio) {
+    tradeTypeSlots_.clear();
+    pricingEngineSlots_.clear();
+    for (auto const& [id, trade] : portfolio.trades()) {
+        const std::string& tradeType = trade->tradeType();
+        // model / engine of the builder the trade was built with, fall back on the engine data for the trade type
+        std::string engine = trade->pricingModelEngine();
+        if (engine.empty()) {
+            if (engineData_ && engineData_->hasProduct(tradeType)) {
+                const ore::data::EngineData& ed = *engineData_;
+                engine = ed.model(tradeType) + "/" + ed.engine(tradeType);
+            } else {
+                engine = "Unknown";
+            }
+        }
+        tradeTypeSlots_.push_back(&tradeTypes_[tradeType]);
+        pricingEngineSlots_.push_back(&pricingEngines_[engine]);
+    }
+}
+
+void ValuationProfiler::addPhase(const QuantLib::Date& d, Phase phase, double seconds) {
+    phases_[phase].add(seconds);
+    if (d != QuantLib::Date())
+        dates_[d][phase].add(seconds);
+}
+
+void ValuationProfiler::merge(const ValuationProfiler& other) {
+    QL_REQUIRE(&other != this, "ValuationProfiler::merge(): can not merge profiler with itself");
+    for (auto const& [p, s] : other.phases_)
+        phases_[p].add(s);
+    for (auto const& [d, m] : other.dates_)
+        for (auto const& [p, s] : m)
+            dates_[d][p].add(s);
+    for (auto const& [t, s] : other.tradeTypes_)
+        tradeTypes_[t].add(s);
+    for (auto const& [e, s] : other.pricingEngines_)
+        pricingEngines_[e].add(s);
+}
+
+std::ostream& operator<<(std::ostream& out, const ValuationProfiler::Phase phase) {
+    switch (phase) {
+    case ValuationProfiler::Phase::UpdateDate:
+        return out << "UpdateDate";
+    case ValuationProfiler::Phase::UpdateScenario:
+        return out << "UpdateScenario";
+    case ValuationProfiler::Phase::PostUpdate:
+        return out << "PostUpdate";
+    case ValuationProfiler::Phase::UpdateAsd:
+        return out << "UpdateAsd";
+    case ValuationProfiler::Phase::Recalibration:
+        return out << "Recalibration";
+    case ValuationProfiler::Phase::Pricing:
+        return out << "Pricing";
+    case ValuationProfiler::Phase::CounterpartyCalcs:
+        return out << "CounterpartyCalcs";
+    case ValuationProfiler::Phase::FixingReset:
+        return out << "FixingReset";
+    default:
+        QL_FAIL("ValuationProfiler::Phase (" << static_cast<int>(phase) << ") not handled");
+    }
+}
+
+} // namespace analytics
+} // namespace ore
@@ -0,0 +1,145 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file orea/engine/valuationprofiler.hpp
+    \brief profiler for the valuation loop of the valuation engine
+    \ingroup simulation
+*/
+
+#pragma once
+
+#include <ql/shared_ptr.hpp>
+#include <ql/time/date.hpp>
+#include <ql/types.hpp>
+
+#include <array>
+#include <chrono>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace ore::data {
+class EngineData;
+class Portfolio;
+} // namespace ore::data
+
+namespace ore {
+namespace analytics {
+
+//! Profiler for the valuation loop of the ValuationEngine
+/*! If a profiler is set on a ValuationEngine, the engine records the time spent in each phase of the valuation loop
+    per simulation date, and the pricing time of each trade, which is aggregated by trade type and by pricing engine.
+    The pricing engine of a trade is the model/engine of the engine builder it was built with. For trades that do not
+    record their builder it is looked up in the engine data given in the constructor by trade type, if no engine data
+    is given or the trade type is not configured, it is reported as "Unknown".
+
+    Together with the pricing time the number of recalculations of the trades' instruments is recorded, i.e. the
+    number of pricings that were triggered by observer notifications as opposed to cached NPVs.
+
+    \ingroup simulation
+*/
+class ValuationProfiler {
+public:
+    //! Phases of the valuation loop
+    enum class Phase {
+        UpdateDate,        //!< sim market preUpdate() and updateDate(), this moves the evaluation date
+        UpdateScenario,    //!< sim market updateScenario(), this applies the scenario to the sim market
+        PostUpdate,        //!< sim market postUpdate(), this applies fixings and notifies observers
+        UpdateAsd,         //!< aggregation scenario data update
+        Recalibration,     //!< model recalibration
+        Pricing,           //!< trade valuation calculators
+        CounterpartyCalcs, //!< counterparty calculators
+        FixingReset        //!< fixing manager reset after each sample
+    };
+
+    //! Number of buckets of the timing histograms
+    static constexpr QuantLib::Size histogramBuckets = 32;
+
+    //! Timing statistics with a histogram of the single timings
+    /*! Bucket 0 counts timings below 1 microsecond, bucket b > 0 timings in [2^(b-1), 2^b) microseconds, the last
+        bucket also counts all longer timings. */
+    struct Statistics {
+        void add(double seconds, QuantLib::Size recalculations = 0);
+        void add(const Statistics& s);
+        //! lower bound of bucket b in microseconds, the upper bound is the lower bound of bucket b + 1
+        static double bucketLowerBound(QuantLib::Size b);
+
+        QuantLib::Size count = 0;
+        QuantLib::Size recalculations = 0;
+        double total = 0.0;
+        double min = 0.0;
+        double max = 0.0;
+        std::array<QuantLib::Size, histogramBuckets> histogram = {};
+    };
+
+    //! Measures the time between consecutive laps, does nothing if the given profiler is null
+    class Stopwatch {
+    public:
+        explicit Stopwatch(ValuationProfiler* profiler);
+        //! returns the time since construction or the previous lap in seconds
+        double lap();
+        //! records the time since construction or the previous lap for the given date and phase
+        void lap(const QuantLib::Date& d, Phase phase);
+
+    private:
+        ValuationProfiler* profiler_;
+        std::chrono::steady_clock::time_point start_;
+    };
+
+    explicit ValuationProfiler(const QuantLib::ext::shared_ptr<ore::data::EngineData>& engineData = nullptr);
+
+    //! Set the portfolio for the following calls of addTradePricing(), the trades are identified by their index
+    void setPortfolio(const ore::data::Portfolio& portfolio);
+
+    //! Record the time of a phase of the valuation loop, if the date is null, the time is only added to the totals
+    void addPhase(const QuantLib::Date& d, Phase phase, double seconds);
+
+    //! Record the pricing time and number of instrument recalculations of a trade
+    void addTradePricing(QuantLib::Size tradeIndex, double seconds, QuantLib::Size recalculations) {
+        tradeTypeSlots_[tradeIndex]->add(seconds, recalculations);
+        pricingEngineSlots_[tradeIndex]->add(seconds, recalculations);
+    }
+
+    //! Add the statistics of another profiler, e.g. of a worker thread
+    void merge(const ValuationProfiler& other);
+
+    //! Statistics per phase over all dates
+    const std::map<Phase, Statistics>& phases() const { return phases_; }
+    //! Statistics per date and phase
+    const std::map<QuantLib::Date, std::map<Phase, Statistics>>& dates() const { return dates_; }
+    //! Pricing statistics per trade type
+    const std::map<std::string, Statistics>& tradeTypes() const { return tradeTypes_; }
+    //! Pricing statistics per pricing engine (model/engine)
+    const std::map<std::string, Statistics>& pricingEngines() const { return pricingEngines_; }
+
+private:
+    QuantLib::ext::shared_ptr<ore::data::EngineData> engineData_;
+    std::map<Phase, Statistics> phases_;
+    std::map<QuantLib::Date, std::map<Phase, Statistics>> dates_;
+    std::map<std::string, Statistics> tradeTypes_;
+    std::map<std::string, Statistics> pricingEngines_;
+    // statistics to update for the trade with a given index in the current portfolio
+    std::vector<Statistics*> tradeTypeSlots_;
+    std::vector<Statistics*> pricingEngineSlots_;
+};
+
+std::ostream& operator<<(std::ostream& out, const ValuationProfiler::Phase phase);
+
+} // namespace analytics
+} // namespace ore
@@ -0,0 +1,110 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <orea/engine/workstealingqueues.hpp>
+
+#include <ql/errors.hpp>
+#include <ql/utilities/null.hpp>
+
+namespace ore {
+namespace analytics {
+
+using QuantLib::Size;
+
+WorkStealingQueues::WorkStealingQueues(const Size nThreads, const Size nChunks, const bool pinChunks)
+    : pinChunks_(pinChunks), queues_(nThreads), mutexes_(nThreads), startedChunk_(nThreads, QuantLib::Null<Size>()),
+      pending_(nChunks, 0) {
+    QL_REQUIRE(nThreads > 0, "WorkStealingQueues: nThreads must be > 0");
+}
+
+void WorkStealingQueues::push(const Size thread, const WorkUnit& unit) {
+    QL_REQUIRE(thread < queues_.size(), "WorkStealingQueues: thread " << thread << " out of range");
+    QL_REQUIRE(unit.chunk < pending_.size(), "WorkStealingQueues: chunk " << unit.chunk << " out of range");
+    {
+        std::lock_guard<std::mutex> lock(mutexes_[thread]);
+        queues_[thread].push_back(unit);
+    }
+    std::lock_guard<std::mutex> lock(pendingMutex_);
+    ++pending_[unit.chunk];
+}
+
+bool WorkStealingQueues::next(const Size thread, WorkUnit& unit, bool& stolen) {
+    auto handOut = [this](const WorkUnit& u) {
+        std::lock_guard<std::mutex> lock(pendingMutex_);
+        --pending_[u.chunk];
+    };
+    {
+        std::lock_guard<std::mutex> lock(mutexes_[thread]);
+        if (!queues_[thread].empty()) {
+            unit = queues_[thread].front();
+            queues_[thread].pop_front();
+            startedChunk_[thread] = unit.chunk;
+            stolen = false;
+            handOut(unit);
+            return true;
+        }
+    }
+    // no new units are added once the threads are running, so we are done if all queues are empty
+    while (true) {
+        Size victim = QuantLib::Null<Size>(), victimSize = 0;
+        for (Size i = 0; i < queues_.size(); ++i) {
+            if (i == thread)
+                continue;
+            std::lock_guard<std::mutex> lock(mutexes_[i]);
+            if (queues_[i].size() > victimSize && stealable(i)) {
+                victim = i;
+                victimSize = queues_[i].size();
+            }
+        }
+        if (victim == QuantLib::Null<Size>())
+            return false;
+        std::vector<WorkUnit> loot;
+        {
+            std::lock_guard<std::mutex> lock(mutexes_[victim]);
+            if (!queues_[victim].empty() && stealable(victim)) {
+                Size chunk = queues_[victim].back().chunk;
+                do {
+                    loot.push_back(queues_[victim].back());
+                    queues_[victim].pop_back();
+                } while (pinChunks_ && !queues_[victim].empty() && queues_[victim].back().chunk == chunk);
+            }
+        }
+        if (!loot.empty()) {
+            std::lock_guard<std::mutex> lock(mutexes_[thread]);
+            unit = loot.back();
+            for (Size i = 0; i + 1 < loot.size(); ++i)
+                queues_[thread].push_front(loot[i]);
+            startedChunk_[thread] = unit.chunk;
+            stolen = true;
+            handOut(unit);
+            return true;
+        }
+    }
+}
+
+bool WorkStealingQueues::exhausted(const Size chunk) const {
+    std::lock_guard<std::mutex> lock(pendingMutex_);
+    return pending_.at(chunk) == 0;
+}
+
+bool WorkStealingQueues::stealable(const Size victim) const {
+    return !queues_[victim].empty() && (!pinChunks_ || queues_[victim].back().chunk != startedChunk_[victim]);
+}
+
+} // namespace analytics
+} // namespace ore
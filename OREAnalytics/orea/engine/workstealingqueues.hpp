@@ -0,0 +1,77 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file orea/engine/workstealingqueues.hpp
+    \brief work unit queues of the multi-threaded valuation engine
+    \ingroup engine
+*/
+
+#pragma once
+
+#include <ql/types.hpp>
+
+#include <deque>
+#include <mutex>
+#include <vector>
+
+namespace ore {
+namespace analytics {
+
+//! A sample block of a trade chunk processed by the MultiThreadedValuationEngine
+struct WorkUnit {
+    QuantLib::Size chunk = 0;
+    QuantLib::Size firstSample = 0;
+    QuantLib::Size samples = 0;
+};
+
+//! Work unit queues with work stealing
+/*! There is one queue of work units per thread. A thread pops units from the front of its own queue and steals units
+    from the back of the longest other queue once its own queue is empty. If pinChunks is true, a chunk is processed
+    by one thread only, i.e. a thread steals all units of a chunk the victim has not started yet.
+
+    All units must be pushed before the threads call next().
+
+    \ingroup engine
+*/
+class WorkStealingQueues {
+public:
+    WorkStealingQueues(const QuantLib::Size nThreads, const QuantLib::Size nChunks, const bool pinChunks);
+
+    //! adds a unit to the back of the queue of the given thread
+    void push(const QuantLib::Size thread, const WorkUnit& unit);
+
+    //! gets the next unit for the given thread, returns false if all queues are empty
+    bool next(const QuantLib::Size thread, WorkUnit& unit, bool& stolen);
+
+    //! true if all units of the given chunk were handed out by next()
+    bool exhausted(const QuantLib::Size chunk) const;
+
+private:
+    // requires the lock on the victim's queue
+    bool stealable(const QuantLib::Size victim) const;
+
+    bool pinChunks_;
+    std::vector<std::deque<WorkUnit>> queues_;
+    std::vector<std::mutex> mutexes_;
+    std::vector<QuantLib::Size> startedChunk_;
+    mutable std::mutex pendingMutex_;
+    std::vector<QuantLib::Size> pending_;
+};
+
+} // namespace analytics
+} // namespace ore
@@ -67,6 +67,8 @@ XvaEngineCG::XvaEngineCG(const Size nThreads, const Date& asof,
                          const IborFallbackConfig& iborFallbackConfig, const bool bumpCvaSensis,
                          const bool useExternalComputeDevice, const bool externalDeviceCompatibilityMode,
                          const bool useDoublePrecisionForExternalCalculation, const std::string& externalComputeDevice,
+                         const Size externalComputeDeviceThreads,
+                         const RandomVariableRegressionMethod regressionMethod, const Size regressionThreads,
                          const bool continueOnCalibrationError, const bool continueOnError, const std::string& context)
     : asof_(asof), loader_(loader), curveConfigs_(curveConfigs), todaysMarketParams_(todaysMarketParams),
       simMarketData_(simMarketData), engineData_(engineData), crossAssetModelData_(crossAssetModelData),
@@ -76,7 +78,9 @@ XvaEngineCG::XvaEngineCG(const Size nThreads, const Date& asof,
       useExternalComputeDevice_(useExternalComputeDevice),
       externalDeviceCompatibilityMode_(externalDeviceCompatibilityMode),
       useDoublePrecisionForExternalCalculation_(useDoublePrecisionForExternalCalculation),
-      externalComputeDevice_(externalComputeDevice), continueOnCalibrationError_(continueOnCalibrationError),
+      externalComputeDevice_(externalComputeDevice), externalComputeDeviceThreads_(externalComputeDeviceThreads),
+      regressionMethod_(regressionMethod), regressionThreads_(regressionThreads),
+      continueOnCalibrationError_(continueOnCalibrationError),
       continueOnError_(continueOnError), context_(context) {
 
     // Just for performance testing, duplicate the trades in input portfolio as specified by env var N
@@ -279,6 +283,7 @@ XvaEngineCG::XvaEngineCG(const Size nThreads, const Date& asof,
         externalComputeDeviceSettings.rngSequenceType = scenarioGeneratorData_->sequenceType();
         externalComputeDeviceSettings.rngSeed = scenarioGeneratorData_->seed();
         externalComputeDeviceSettings.regressionOrder = 4;
+        externalComputeDeviceSettings.numberOfThreads = externalComputeDeviceThreads_;
         externalCalculationId_ = ComputeEnvironment::instance()
                                      .context()
                                      .initiateCalculation(model_->size(), 0, 0, externalComputeDeviceSettings)
@@ -327,7 +332,8 @@ XvaEngineCG::XvaEngineCG(const Size nThreads, const Date& asof,
         gradsExternal_ = getExternalRandomVariableGradients();
     } else {
         ops_ = getRandomVariableOps(model_->size(), 4, QuantLib::LsmBasisSystem::Monomial, bumpCvaSensis_ ? eps : 0.0,
-                                    Null<Real>()); // todo set regression variance cutoff
+                                    Null<Real>(), // todo set regression variance cutoff
+                                    regressionMethod_, regressionThreads_);
         grads_ = getRandomVariableGradients(model_->size(), 4, QuantLib::LsmBasisSystem::Monomial, eps);
     }
 
@@ -38,6 +38,7 @@
 #include <ored/marketdata/todaysmarket.hpp>
 
 #include <qle/ad/external_randomvariable_ops.hpp>
+#include <qle/math/randomvariable_ops.hpp>
 
 #include <ql/types.hpp>
 
@@ -65,7 +66,10 @@ public:
                 const bool bumpCvaSensis = false, const bool useExternalComputeDevice = false,
                 const bool externalDeviceCompatibilityMode = false,
                 const bool useDoublePrecisionForExternalCalculation = false,
-                const std::string& externalComputeDevice = std::string(), const bool continueOnCalibrationError = true,
+                const std::string& externalComputeDevice = std::string(),
+                const Size externalComputeDeviceThreads = 0,
+                const RandomVariableRegressionMethod regressionMethod = RandomVariableRegressionMethod::QR,
+                const Size regressionThreads = 1, const bool continueOnCalibrationError = true,
                 const bool continueOnError = true, const std::string& context = "xva engine cg");
 
     QuantLib::ext::shared_ptr<InMemoryReport> exposureReport() { return epeReport_; }
@@ -100,6 +104,9 @@ private:
     bool externalDeviceCompatibilityMode_;
     bool useDoublePrecisionForExternalCalculation_;
     std::string externalComputeDevice_;
+    Size externalComputeDeviceThreads_;
+    RandomVariableRegressionMethod regressionMethod_;
+    Size regressionThreads_;
     bool continueOnCalibrationError_;
     bool continueOnError_;
     std::string context_;
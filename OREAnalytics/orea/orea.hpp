@@ -54,6 +54,7 @@
 #include <orea/app/structuredanalyticswarning.hpp>
 #include <orea/app/xvarunner.hpp>
 #include <orea/app/zerosensitivityloader.hpp>
+#include <orea/cube/contiguouscube.hpp>
 #include <orea/cube/cube_io.hpp>
 #include <orea/cube/cubecsvreader.hpp>
 #include <orea/cube/cubeinterpretation.hpp>
@@ -62,6 +63,7 @@
 #include <orea/cube/jaggedcube.hpp>
 #include <orea/cube/jointnpvcube.hpp>
 #include <orea/cube/jointnpvsensicube.hpp>
+#include <orea/cube/memorymappedcube.hpp>
 #include <orea/cube/npvcube.hpp>
 #include <orea/cube/npvsensicube.hpp>
 #include <orea/cube/sensicube.hpp>
@@ -102,12 +104,15 @@
 #include <orea/engine/stresstest.hpp>
 #include <orea/engine/valuationcalculator.hpp>
 #include <orea/engine/valuationengine.hpp>
+#include <orea/engine/valuationprofiler.hpp>
 #include <orea/engine/varbacktest.hpp>
 #include <orea/engine/varcalculator.hpp>
+#include <orea/engine/workstealingqueues.hpp>
 #include <orea/engine/xvaenginecg.hpp>
 #include <orea/engine/zerotoparcube.hpp>
 #include <orea/engine/zerotoparshift.hpp>
 #include <orea/scenario/aggregationscenariodata.hpp>
+#include <orea/scenario/binaryscenariofile.hpp>
 #include <orea/scenario/clonedscenariogenerator.hpp>
 #include <orea/scenario/clonescenariofactory.hpp>
 #include <orea/scenario/crossassetmodelscenariogenerator.hpp>
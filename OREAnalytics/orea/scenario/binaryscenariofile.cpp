@@ -0,0 +1,160 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <orea/scenario/binaryscenariofile.hpp>
+#include <ored/utilities/log.hpp>
+#include <ored/utilities/to_string.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+namespace ore {
+namespace analytics {
+
+namespace {
+
+// binary scenario format: magic, byte order mark and version
+constexpr char binaryScenarioMagic[8] = {'O', 'R', 'E', 'S', 'C', 'E', 'N', '\0'};
+constexpr std::uint32_t binaryScenarioByteOrderMark = 0x01020304;
+constexpr std::uint32_t binaryScenarioVersion = 1;
+constexpr std::uint64_t binaryScenarioDataAlignment = 64;
+
+static_assert(sizeof(Real) == sizeof(double), "binary scenario files require Real = double");
+
+template <typename I> void writeBinary(FILE* fp, const I& value) { fwrite(&value, sizeof(I), 1, fp); }
+
+void writeBinary(FILE* fp, const std::string& value) {
+    writeBinary<std::uint64_t>(fp, value.size());
+    fwrite(value.data(), 1, value.size(), fp);
+}
+
+// reads from the mapped header, pos is advanced
+template <typename I> I readBinary(const char* data, Size size, Size& pos, const std::string& filename) {
+    QL_REQUIRE(pos + sizeof(I) <= size, "BinaryScenarioFile: unexpected end of header in file '" << filename << "'");
+    I value;
+    std::memcpy(&value, data + pos, sizeof(I));
+    pos += sizeof(I);
+    return value;
+}
+
+std::string readBinaryString(const char* data, Size size, Size& pos, const std::string& filename) {
+    Size n = readBinary<std::uint64_t>(data, size, pos, filename);
+    QL_REQUIRE(pos + n <= size, "BinaryScenarioFile: unexpected end of header in file '" << filename << "'");
+    std::string value(data + pos, n);
+    pos += n;
+    return value;
+}
+
+} // namespace
+
+bool isBinaryScenarioFile(const std::string& filename) {
+    return boost::filesystem::path(filename).extension().string() == ".bin";
+}
+
+void writeBinaryScenarioFileHeader(FILE* fp, const std::vector<RiskFactorKey>& keys) {
+    QL_REQUIRE(fp, "writeBinaryScenarioFileHeader(): no file given");
+    long start = ftell(fp);
+    fwrite(binaryScenarioMagic, 1, sizeof(binaryScenarioMagic), fp);
+    writeBinary(fp, binaryScenarioByteOrderMark);
+    writeBinary(fp, binaryScenarioVersion);
+    writeBinary<std::uint64_t>(fp, keys.size());
+    for (auto const& k : keys)
+        writeBinary(fp, ore::data::to_string(k));
+    // pad to the aligned start of the data section
+    std::uint64_t headerSize = static_cast<std::uint64_t>(ftell(fp) - start);
+    std::uint64_t padding =
+        (binaryScenarioDataAlignment - headerSize % binaryScenarioDataAlignment) % binaryScenarioDataAlignment;
+    for (Size i = 0; i < padding; ++i)
+        fputc('\0', fp);
+    QL_REQUIRE(!ferror(fp), "writeBinaryScenarioFileHeader(): error while writing header");
+}
+
+void writeBinaryScenarioFileRow(FILE* fp, const QuantLib::Date& date, Size scenarioNumber, Real numeraire,
+                                const Real* values, Size numValues) {
+    QL_REQUIRE(fp, "writeBinaryScenarioFileRow(): no file given");
+    Real rowHeader[3] = {static_cast<Real>(date.serialNumber()), static_cast<Real>(scenarioNumber), numeraire};
+    fwrite(rowHeader, sizeof(Real), 3, fp);
+    fwrite(values, sizeof(Real), numValues, fp);
+    QL_REQUIRE(!ferror(fp), "writeBinaryScenarioFileRow(): error while writing scenario " << scenarioNumber);
+}
+
+BinaryScenarioFile::BinaryScenarioFile(const std::string& filename)
+    : filename_(filename), sharedData_(QuantLib::ext::make_shared<SimpleScenario::SharedData>()) {
+
+    file_.open(filename);
+    QL_REQUIRE(file_.is_open(), "BinaryScenarioFile: could not map file '" << filename << "'");
+
+    // read header
+
+    const char* data = file_.data();
+    Size size = file_.size();
+    Size pos = 0;
+
+    QL_REQUIRE(size >= sizeof(binaryScenarioMagic) &&
+                   std::equal(data, data + sizeof(binaryScenarioMagic), binaryScenarioMagic),
+               "BinaryScenarioFile: file '" << filename << "' is not a binary scenario file");
+    pos += sizeof(binaryScenarioMagic);
+    QL_REQUIRE(readBinary<std::uint32_t>(data, size, pos, filename) == binaryScenarioByteOrderMark,
+               "BinaryScenarioFile: file '" << filename << "' was written on a platform with different byte order");
+    std::uint32_t version = readBinary<std::uint32_t>(data, size, pos, filename);
+    QL_REQUIRE(version == binaryScenarioVersion, "BinaryScenarioFile: unsupported version "
+                                                     << version << " in file '" << filename << "', expected "
+                                                     << binaryScenarioVersion);
+
+    // the shared data block is populated by adding the keys to a scenario, this also sets the keys hash
+    Size numKeys = readBinary<std::uint64_t>(data, size, pos, filename);
+    SimpleScenario keyScenario(QuantLib::Date(), std::string(), 0.0, sharedData_);
+    for (Size k = 0; k < numKeys; ++k)
+        keyScenario.add(parseRiskFactorKey(readBinaryString(data, size, pos, filename)), 0.0);
+    QL_REQUIRE(sharedData_->keys.size() == numKeys,
+               "BinaryScenarioFile: duplicate keys in header of file '" << filename << "'");
+
+    // data section starts at the next aligned position after the header
+
+    Size dataOffset =
+        (pos + binaryScenarioDataAlignment - 1) / binaryScenarioDataAlignment * binaryScenarioDataAlignment;
+    QL_REQUIRE(dataOffset <= size, "BinaryScenarioFile: unexpected end of header in file '" << filename << "'");
+    rowSize_ = 3 + numKeys;
+    size_ = (size - dataOffset) / (rowSize_ * sizeof(Real));
+    if ((size - dataOffset) % (rowSize_ * sizeof(Real)) != 0) {
+        WLOG("BinaryScenarioFile: file '" << filename << "' ends with an incomplete scenario, which is ignored");
+    }
+    data_ = reinterpret_cast<const Real*>(data + dataOffset);
+
+    LOG("mapped binary scenario file " << filename << ": " << size_ << " scenarios, " << numKeys << " keys");
+}
+
+QuantLib::Date BinaryScenarioFile::date(Size i) const {
+    auto serial = static_cast<QuantLib::Date::serial_type>(row(i)[0]);
+    // serial 0 encodes a null date, which the Date(serial) constructor would reject
+    return serial == 0 ? QuantLib::Date() : QuantLib::Date(serial);
+}
+
+QuantLib::ext::shared_ptr<SimpleScenario> BinaryScenarioFile::scenario(Size i) const {
+    const Real* v = values(i);
+    auto s = QuantLib::ext::make_shared<SimpleScenario>(date(i), std::string(), numeraire(i), sharedData_);
+    s->setData(std::vector<Real>(v, v + sharedData_->keys.size()));
+    return s;
+}
+
+} // namespace analytics
+} // namespace ore
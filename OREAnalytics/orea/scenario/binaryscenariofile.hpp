@@ -0,0 +1,93 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file orea/scenario/binaryscenariofile.hpp
+    \brief binary scenario file format with memory mapped random access
+    \ingroup scenario
+*/
+
+#pragma once
+
+#include <orea/scenario/simplescenario.hpp>
+
+#include <ql/errors.hpp>
+
+#include <boost/iostreams/device/mapped_file.hpp>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace ore {
+namespace analytics {
+
+/*! Files with extension .bin are read / written in the binary scenario format by the ScenarioWriter,
+    CSVScenarioGenerator and HistoricalScenarioFileReader. */
+bool isBinaryScenarioFile(const std::string& filename);
+
+/*! The binary scenario format consists of a header holding the risk factor keys, followed by a data section starting
+    at a 64 byte aligned offset. The data section contains one row per scenario of 3 + number of keys double values
+    in the native byte order: the date serial number, the scenario number, the numeraire and the values in the order
+    of the keys. Since the rows have a fixed size, scenarios can be appended to a file and read by index. */
+void writeBinaryScenarioFileHeader(FILE* fp, const std::vector<RiskFactorKey>& keys);
+void writeBinaryScenarioFileRow(FILE* fp, const QuantLib::Date& date, Size scenarioNumber, Real numeraire,
+                                const Real* values, Size numValues);
+
+//! Read access to a memory mapped binary scenario file
+/*! The keys of the file are held in a SimpleScenario::SharedData block which is shared by all scenarios returned by
+    scenario(), their values are copied from the mapped file without parsing. The number of scenarios is determined
+    by the file size when the file is opened.
+
+    \ingroup scenario
+*/
+class BinaryScenarioFile {
+public:
+    explicit BinaryScenarioFile(const std::string& filename);
+
+    //! number of scenarios in the file
+    Size size() const { return size_; }
+    const std::vector<RiskFactorKey>& keys() const { return sharedData_->keys; }
+    const QuantLib::ext::shared_ptr<SimpleScenario::SharedData>& sharedData() const { return sharedData_; }
+
+    QuantLib::Date date(Size i) const;
+    //! scenario number as written by the ScenarioWriter
+    Size scenarioNumber(Size i) const { return static_cast<Size>(row(i)[1]); }
+    Real numeraire(Size i) const { return row(i)[2]; }
+    //! values of scenario i in the order of keys()
+    const Real* values(Size i) const { return row(i) + 3; }
+
+    //! build scenario i
+    QuantLib::ext::shared_ptr<SimpleScenario> scenario(Size i) const;
+
+private:
+    const Real* row(Size i) const {
+        QL_REQUIRE(i < size_, "BinaryScenarioFile: scenario " << i << " out of range, file '" << filename_
+                                                                << "' contains " << size_ << " scenarios");
+        return data_ + i * rowSize_;
+    }
+
+    std::string filename_;
+    boost::iostreams::mapped_file_source file_;
+    QuantLib::ext::shared_ptr<SimpleScenario::SharedData> sharedData_;
+    const Real* data_ = nullptr;
+    Size rowSize_ = 0;
+    Size size_ = 0;
+};
+
+} // namespace analytics
+} // namespace ore
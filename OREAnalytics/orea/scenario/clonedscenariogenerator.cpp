@@ -56,5 +56,12 @@ void ClonedScenarioGenerator::reset() {
     nSim_ = 0;
 }
 
+void ClonedScenarioGenerator::setNextSample(const Size sample) {
+    QL_REQUIRE(sample * dates_.size() < scenarios_.size(),
+               "ClonedScenarioGenerator::setNextSample(" << sample << "): sample out of range, have "
+                                                         << scenarios_.size() / dates_.size() << " samples.");
+    nSim_ = sample;
+}
+
 } // namespace analytics
 } // namespace ore
@@ -34,6 +34,8 @@ public:
                             const std::vector<Date>& dates, const Size nSamples);
     QuantLib::ext::shared_ptr<Scenario> next(const Date& d) override;
     virtual void reset() override;
+    //! position the generator such that the next path starts with the given sample
+    void setNextSample(const Size sample);
 
 private:
     std::map<Date, size_t> dates_;
@@ -17,11 +17,14 @@
 */
 
 #include <orea/scenario/crossassetmodelscenariogenerator.hpp>
+#include <orea/scenario/simplescenario.hpp>
 #include <ored/utilities/log.hpp>
 #include <ored/utilities/parsers.hpp>
 
 #include <qle/indexes/inflationindexobserver.hpp>
 
+#include <ql/math/comparison.hpp>
+
 using namespace QuantLib;
 using namespace QuantExt;
 using namespace std;
@@ -34,7 +37,7 @@ CrossAssetModelScenarioGenerator::CrossAssetModelScenarioGenerator(
     QuantLib::ext::shared_ptr<QuantExt::MultiPathGeneratorBase> pathGenerator,
     QuantLib::ext::shared_ptr<ScenarioFactory> scenarioFactory, QuantLib::ext::shared_ptr<ScenarioSimMarketParameters> simMarketConfig,
     Date today, QuantLib::ext::shared_ptr<DateGrid> grid, QuantLib::ext::shared_ptr<ore::data::Market> initMarket,
-    const std::string& configuration)
+    const std::string& configuration, const Size pathBlockSize)
     : ScenarioPathGenerator(today, grid->dates(), grid->timeGrid()), model_(model), pathGenerator_(pathGenerator),
       scenarioFactory_(scenarioFactory), simMarketConfig_(simMarketConfig), initMarket_(initMarket),
       configuration_(configuration) {
@@ -310,270 +313,421 @@ CrossAssetModelScenarioGenerator::CrossAssetModelScenarioGenerator(
         }
     }
 
-    LOG("CrossAssetModelScenarioGenerator ctor done");
-}
+    // Cache the model currencies of the index and yield curves
+    for (Size j = 0; j < n_indices_; ++j)
+        indexCcyIdx_.push_back(model_->ccyIndex(indices_[j]->currency()));
+    for (Size j = 0; j < n_curves_; ++j)
+        yieldCurveCcyIdx_.push_back(model_->ccyIndex(yieldCurveCurrency_[j]));
+
+    // Collect the keys in the order in which the values are generated
+    keys_.insert(keys_.end(), discountCurveKeys_.begin(), discountCurveKeys_.end());
+    keys_.insert(keys_.end(), indexCurveKeys_.begin(), indexCurveKeys_.end());
+    keys_.insert(keys_.end(), yieldCurveKeys_.begin(), yieldCurveKeys_.end());
+    keys_.insert(keys_.end(), fxKeys_.begin(), fxKeys_.end());
+    for (Size k = 0; k < fxVols_.size(); ++k) {
+        const string& ccyPair = simMarketConfig_->fxVolCcyPairs()[k];
+        for (Size j = 0; j < simMarketConfig_->fxVolExpiries(ccyPair).size(); ++j)
+            keys_.emplace_back(RiskFactorKey::KeyType::FXVolatility, ccyPair, j);
+    }
+    keys_.insert(keys_.end(), eqKeys_.begin(), eqKeys_.end());
+    for (Size k = 0; k < eqVols_.size(); ++k) {
+        const string& equityName = simMarketConfig_->equityVolNames()[k];
+        for (Size j = 0; j < simMarketConfig_->equityVolExpiries(equityName).size(); ++j)
+            keys_.emplace_back(RiskFactorKey::KeyType::EquityVolatility, equityName, j);
+    }
+    keys_.insert(keys_.end(), cpiKeys_.begin(), cpiKeys_.end());
+    keys_.insert(keys_.end(), zeroInflationKeys_.begin(), zeroInflationKeys_.end());
+    keys_.insert(keys_.end(), yoyInflationKeys_.begin(), yoyInflationKeys_.end());
+    for (Size j = 0, offset = 0; j < n_cr_; ++j) {
+        auto mt = model_->modelType(CrossAssetModel::AssetType::CR, j);
+        if (mt == CrossAssetModel::ModelType::LGM1F || mt == CrossAssetModel::ModelType::CIRPP)
+            keys_.insert(keys_.end(), defaultCurveKeys_.begin() + offset,
+                         defaultCurveKeys_.begin() + offset + ten_dfc_[j].size());
+        offset += ten_dfc_[j].size();
+    }
+    keys_.insert(keys_.end(), commodityCurveKeys_.begin(), commodityCurveKeys_.end());
+    keys_.insert(keys_.end(), crStateKeys_.begin(), crStateKeys_.end());
+    for (Size k = 0; k < n_survivalweights_; ++k) {
+        keys_.push_back(survivalWeightKeys_[k]);
+        keys_.push_back(recoveryRateKeys_[k]);
+    }
+
+    // Precompute the coefficients of the LGM1F implied discount factors, the discount curves are moved by time, the
+    // index and yield curves by date and are fwd-fwd corrected against the initial market curves
+    auto lgmCoefficients = [this, &dc](const Size ccyIdx, const vector<Period>& tenors, const bool timeBased,
+                                       const Handle<YieldTermStructure>& targetCurve) {
+        std::vector<Real> a, b;
+        if (model_->modelType(CrossAssetModel::AssetType::IR, ccyIdx) != CrossAssetModel::ModelType::LGM1F)
+            return std::make_pair(a, b);
+        auto p = model_->irlgm1f(ccyIdx);
+        Handle<YieldTermStructure> curve = targetCurve.empty() ? p->termStructure() : targetCurve;
+        for (Size i = 0; i < dates_.size(); ++i) {
+            Time t = timeBased ? timeGrid_[i + 1]
+                               : dc.yearFraction(model_->irModel(ccyIdx)->termStructure()->referenceDate(), dates_[i]);
+            Real Ht = p->H(t), zeta = p->zeta(t);
+            for (Size k = 0; k < tenors.size(); ++k) {
+                Time tau = dc.yearFraction(dates_[i], dates_[i] + tenors[k]);
+                if (!targetCurve.empty() && QuantLib::close_enough(t, 0.0)) {
+                    a.push_back(targetCurve->discount(tau));
+                    b.push_back(0.0);
+                } else if (QuantLib::close_enough(t, t + tau)) {
+                    a.push_back(1.0);
+                    b.push_back(0.0);
+                } else {
+                    Real HT = p->H(t + tau);
+                    a.push_back(curve->discount(t + tau) / curve->discount(t) *
+                                std::exp(-0.5 * (HT * HT - Ht * Ht) * zeta));
+                    b.push_back(HT - Ht);
+                }
+            }
+        }
+        return std::make_pair(a, b);
+    };
+
+    auto addCoefficients = [this](const std::pair<std::vector<Real>, std::vector<Real>>& c) {
+        lgmCurveA_.push_back(c.first);
+        lgmCurveB_.push_back(c.second);
+    };
+    for (Size j = 0; j < n_ccy_; ++j)
+        addCoefficients(lgmCoefficients(j, ten_dsc_[j], true, Handle<YieldTermStructure>()));
+    for (Size j = 0; j < n_indices_; ++j)
+        addCoefficients(lgmCoefficients(indexCcyIdx_[j], ten_idx_[j], false,
+                                        initMarket_->iborIndex(simMarketConfig_->indices()[j], configuration_)
+                                            ->forwardingTermStructure()));
+    for (Size j = 0; j < n_curves_; ++j)
+        addCoefficients(lgmCoefficients(yieldCurveCcyIdx_[j], ten_yc_[j], false,
+                                        initMarket_->yieldCurve(simMarketConfig_->yieldCurveNames()[j], configuration_)));
+
+    // Size the path blocks such that the state and value blocks stay below a fixed number of values
+    constexpr Size maxBlockValues = 1 << 22;
+    Size valuesPerPath = std::max<Size>(dates_.size() * std::max(keys_.size(), model_->stateProcess()->size()), 1);
+    blockSize_ = std::max<Size>(std::min<Size>(pathBlockSize, maxBlockValues / valuesPerPath), 1);
+    blockPos_ = blockSize_;
+    DLOG("CrossAssetModelScenarioGenerator: " << keys_.size() << " keys, path block size " << blockSize_);
 
-namespace {
-void copyPathToArray(const MultiPath& p, Size t, Size a, Array& target) {
-    for (Size k = 0; k < target.size(); ++k)
-        target[k] = p[a + k][t];
+    LOG("CrossAssetModelScenarioGenerator ctor done");
 }
-} // namespace
 
 std::vector<QuantLib::ext::shared_ptr<Scenario>> CrossAssetModelScenarioGenerator::nextPath() {
+    if (blockPos_ == blockSize_) {
+        generateBlock();
+        blockPos_ = 0;
+    }
+
     std::vector<QuantLib::ext::shared_ptr<Scenario>> scenarios(dates_.size());
+    Size nKeys = keys_.size();
+    for (Size i = 0; i < dates_.size(); i++) {
+        scenarios[i] = scenarioFactory_->buildScenario(dates_[i], true);
+        scenarios[i]->setNumeraire(numeraireBlock_[i * blockSize_ + blockPos_]);
+        const Real* values = &valueBlock_[i * nKeys * blockSize_ + blockPos_];
+        // if the scenario shares a data block with the expected keys we can set the data directly
+        auto s = QuantLib::ext::dynamic_pointer_cast<SimpleScenario>(scenarios[i]);
+        if (s != nullptr && hasKeys(*s)) {
+            std::vector<Real> data(nKeys);
+            for (Size k = 0; k < nKeys; ++k)
+                data[k] = values[k * blockSize_];
+            s->setData(std::move(data));
+        } else {
+            for (Size k = 0; k < nKeys; ++k)
+                scenarios[i]->add(keys_[k], values[k * blockSize_]);
+        }
+    }
+
+    ++blockPos_;
+    return scenarios;
+}
+
+bool CrossAssetModelScenarioGenerator::hasKeys(const SimpleScenario& s) {
+    // the scenario factory usually hands out scenarios sharing one data block, so the keys are compared once only
+    if (s.sharedData() != checkedSharedData_ || s.keysHash() != checkedKeysHash_) {
+        checkedSharedData_ = s.sharedData();
+        checkedKeysHash_ = s.keysHash();
+        checkedHasKeys_ = s.keys() == keys_;
+    }
+    return checkedHasKeys_;
+}
+
+void CrossAssetModelScenarioGenerator::generateBlock() {
     QL_REQUIRE(pathGenerator_ != nullptr, "CrossAssetModelScenarioGenerator::nextPath(): pathGenerator is null");
-    Sample<MultiPath> sample = pathGenerator_->next();
     DayCounter dc = model_->irModel(0)->termStructure()->dayCounter();
 
+    const Size n = blockSize_;
+    const Size nDates = dates_.size();
+    const Size nStates = model_->stateProcess()->size();
+    const Size nKeys = keys_.size();
+
+    stateBlock_.resize(nDates * nStates * n);
+    valueBlock_.resize(nDates * nKeys * n);
+    numeraireBlock_.resize(nDates * n);
+
+    std::vector<std::vector<Real*>> paths(nDates, std::vector<Real*>(nStates));
+    for (Size i = 0; i < nDates; ++i)
+        for (Size j = 0; j < nStates; ++j)
+            paths[i][j] = &stateBlock_[(i * nStates + j) * n];
+    pathGenerator_->nextBlock(n, paths);
+
+    // state variable j on date i and output values for key slot k on date i, for all paths of the block
+    auto state = [this, nStates, n](const Size i, const Size j) -> const Real* {
+        return &stateBlock_[(i * nStates + j) * n];
+    };
+    auto value = [this, nKeys, n](const Size i, const Size k) -> Real* { return &valueBlock_[(i * nKeys + k) * n]; };
+    auto copyState = [&state](const Size i, const Size j, const Size p, Array& target) {
+        for (Size k = 0; k < target.size(); ++k)
+            target[k] = state(i, j + k)[p];
+    };
+
     std::vector<Array> ir_state(n_ccy_);
     for (Size j = 0; j < n_ccy_; ++j)
         ir_state[j] = Array(model_->irModel(j)->n());
-
     Array ir_state_aux(model_->irModel(0)->n_aux());
 
-    std::vector<Size> indexCcyIdx(n_indices_);
-    for (Size j = 0; j < n_indices_; ++j)
-        indexCcyIdx[j] = model_->ccyIndex(indices_[j]->currency());
-
-    std::vector<Size> yieldCurveCcyIdx(n_curves_);
-    for (Size j = 0; j < n_curves_; ++j)
-        yieldCurveCcyIdx[j] = model_->ccyIndex(yieldCurveCurrency_[j]);
-
-    for (Size i = 0; i < dates_.size(); i++) {
+    for (Size i = 0; i < nDates; i++) {
         Real t = timeGrid_[i + 1]; // recall: time grid has inserted t=0
-
-        scenarios[i] = scenarioFactory_->buildScenario(dates_[i], true);
-
-        // populate IR states
-        copyPathToArray(sample.value, i + 1, model_->pIdx(CrossAssetModel::AssetType::IR, 0), ir_state[0]);
-        copyPathToArray(sample.value, i + 1, model_->pIdx(CrossAssetModel::AssetType::IR, 0) + ir_state[0].size(),
-                        ir_state_aux);
-        for (Size j = 1; j < n_ccy_; ++j)
-            copyPathToArray(sample.value, i + 1, model_->pIdx(CrossAssetModel::AssetType::IR, j), ir_state[j]);
+        Size slot = 0;
 
         // Set numeraire from domestic ir process
-        scenarios[i]->setNumeraire(model_->numeraire(0, t, ir_state[0], Handle<YieldTermStructure>(), ir_state_aux));
-
-        // Discount curves
-        for (Size j = 0; j < n_ccy_; j++) {
-            curves_[j]->move(t, ir_state[j]);
-            for (Size k = 0; k < ten_dsc_[j].size(); k++) {
-                Date d = dates_[i] + ten_dsc_[j][k];
-                Time T = dc.yearFraction(dates_[i], d);
-                Real discount = std::max(curves_[j]->discount(T), 0.00001);
-                scenarios[i]->add(discountCurveKeys_[j * ten_dsc_[j].size() + k], discount);
-            }
+        Size irIdx0 = model_->pIdx(CrossAssetModel::AssetType::IR, 0);
+        for (Size p = 0; p < n; ++p) {
+            copyState(i, irIdx0, p, ir_state[0]);
+            copyState(i, irIdx0 + ir_state[0].size(), p, ir_state_aux);
+            numeraireBlock_[i * n + p] =
+                model_->numeraire(0, t, ir_state[0], Handle<YieldTermStructure>(), ir_state_aux);
         }
 
-        // Index curves and Index fixings
-        for (Size j = 0; j < n_indices_; ++j) {
-            fwdCurves_[j]->move(dates_[i], ir_state[indexCcyIdx[j]]);
-            for (Size k = 0; k < ten_idx_[j].size(); ++k) {
-                Date d = dates_[i] + ten_idx_[j][k];
-                Time T = dc.yearFraction(dates_[i], d);
-                Real discount = std::max(fwdCurves_[j]->discount(T), 0.00001);
-                scenarios[i]->add(indexCurveKeys_[j * ten_idx_[j].size() + k], discount);
+        // Discount, index and yield curves
+        auto populateCurve = [&](const Size c, const QuantLib::ext::shared_ptr<ModelImpliedYieldTermStructure>& ts,
+                                 const Size ccyIdx, const std::vector<Period>& tenors, const bool timeBased) {
+            Size nTen = tenors.size();
+            Size irIdx = model_->pIdx(CrossAssetModel::AssetType::IR, ccyIdx);
+            if (!lgmCurveA_[c].empty()) {
+                const Real* x = state(i, irIdx);
+                for (Size k = 0; k < nTen; ++k) {
+                    Real a = lgmCurveA_[c][i * nTen + k], b = lgmCurveB_[c][i * nTen + k];
+                    Real* v = value(i, slot + k);
+                    for (Size p = 0; p < n; ++p)
+                        v[p] = std::max(a * std::exp(-b * x[p]), 0.00001);
+                }
+            } else {
+                std::vector<Time> T(nTen);
+                for (Size k = 0; k < nTen; ++k)
+                    T[k] = dc.yearFraction(dates_[i], dates_[i] + tenors[k]);
+                for (Size p = 0; p < n; ++p) {
+                    copyState(i, irIdx, p, ir_state[ccyIdx]);
+                    if (timeBased)
+                        ts->move(t, ir_state[ccyIdx]);
+                    else
+                        ts->move(dates_[i], ir_state[ccyIdx]);
+                    for (Size k = 0; k < nTen; ++k)
+                        value(i, slot + k)[p] = std::max(ts->discount(T[k]), 0.00001);
+                }
             }
-        }
+            slot += nTen;
+        };
 
-        // Yield curves
-        for (Size j = 0; j < n_curves_; ++j) {
-            yieldCurves_[j]->move(dates_[i], ir_state[yieldCurveCcyIdx[j]]);
-            for (Size k = 0; k < ten_yc_[j].size(); ++k) {
-                Date d = dates_[i] + ten_yc_[j][k];
-                Time T = dc.yearFraction(dates_[i], d);
-                Real discount = std::max(yieldCurves_[j]->discount(T), 0.00001);
-                scenarios[i]->add(yieldCurveKeys_[j * ten_yc_[j].size() + k], discount);
-            }
-        }
+        for (Size j = 0; j < n_ccy_; j++)
+            populateCurve(j, curves_[j], j, ten_dsc_[j], true);
+        for (Size j = 0; j < n_indices_; ++j)
+            populateCurve(n_ccy_ + j, fwdCurves_[j], indexCcyIdx_[j], ten_idx_[j], false);
+        for (Size j = 0; j < n_curves_; ++j)
+            populateCurve(n_ccy_ + n_indices_ + j, yieldCurves_[j], yieldCurveCcyIdx_[j], ten_yc_[j], false);
 
         // FX rates
         for (Size k = 0; k < n_ccy_ - 1; k++) {
-            Real fx = std::exp(sample.value[model_->pIdx(CrossAssetModel::AssetType::FX, k)][i + 1]);
-            scenarios[i]->add(fxKeys_[k], fx);
+            const Real* x = state(i, model_->pIdx(CrossAssetModel::AssetType::FX, k));
+            Real* v = value(i, slot++);
+            for (Size p = 0; p < n; ++p)
+                v[p] = std::exp(x[p]);
         }
 
         // FX vols
-        if (simMarketConfig_->simulateFXVols()) {
-            for (Size k = 0; k < simMarketConfig_->fxVolCcyPairs().size(); k++) {
-                const string ccyPair = simMarketConfig_->fxVolCcyPairs()[k];
-                const vector<Period>& expires = simMarketConfig_->fxVolExpiries(ccyPair);
-
-                Size fxIndex = fxVols_[k]->fxIndex();
-                Real zFor = sample.value[fxIndex + 1][i + 1];
-                Real logFx = sample.value[n_ccy_ + fxIndex][i + 1]; // multiplies USD amount to get EUR
-                fxVols_[k]->move(dates_[i], ir_state[0][0], zFor, logFx);
-
-                for (Size j = 0; j < expires.size(); j++) {
-                    Real vol = fxVols_[k]->blackVol(dates_[i] + expires[j], Null<Real>(), true);
-                    scenarios[i]->add(RiskFactorKey(RiskFactorKey::KeyType::FXVolatility, ccyPair, j), vol);
-                }
+        for (Size k = 0; k < fxVols_.size(); k++) {
+            const vector<Period>& expiries = simMarketConfig_->fxVolExpiries(simMarketConfig_->fxVolCcyPairs()[k]);
+            Size fxIndex = fxVols_[k]->fxIndex();
+            const Real* zDom = state(i, model_->pIdx(CrossAssetModel::AssetType::IR, 0));
+            const Real* zFor = state(i, fxIndex + 1);
+            const Real* logFx = state(i, n_ccy_ + fxIndex); // multiplies USD amount to get EUR
+            for (Size p = 0; p < n; ++p) {
+                fxVols_[k]->move(dates_[i], zDom[p], zFor[p], logFx[p]);
+                for (Size j = 0; j < expiries.size(); j++)
+                    value(i, slot + j)[p] = fxVols_[k]->blackVol(dates_[i] + expiries[j], Null<Real>(), true);
             }
+            slot += expiries.size();
         }
 
         // Equity spots
         for (Size k = 0; k < n_eq_; k++) {
-            Real eqSpot = std::exp(sample.value[model_->pIdx(CrossAssetModel::AssetType::EQ, k)][i + 1]);
-            scenarios[i]->add(eqKeys_[k], eqSpot);
+            const Real* x = state(i, model_->pIdx(CrossAssetModel::AssetType::EQ, k));
+            Real* v = value(i, slot++);
+            for (Size p = 0; p < n; ++p)
+                v[p] = std::exp(x[p]);
         }
 
         // Equity vols
-        if (simMarketConfig_->simulateEquityVols()) {
-            for (Size k = 0; k < simMarketConfig_->equityVolNames().size(); k++) {
-                const string equityName = simMarketConfig_->equityVolNames()[k];
-
-                const vector<Period>& expiries = simMarketConfig_->equityVolExpiries(equityName);
-
-                Size eqIndex = eqVols_[k]->equityIndex();
-                Size eqCcyIdx = eqVols_[k]->eqCcyIndex();
-                Real z_eqIr = sample.value[eqCcyIdx][i + 1];
-                Real logEq = sample.value[eqIndex][i + 1];
-                eqVols_[k]->move(dates_[i], z_eqIr, logEq);
-
-                for (Size j = 0; j < expiries.size(); j++) {
-                    Real vol = eqVols_[k]->blackVol(dates_[i] + expiries[j], Null<Real>(), true);
-                    scenarios[i]->add(RiskFactorKey(RiskFactorKey::KeyType::EquityVolatility, equityName, j), vol);
-                }
+        for (Size k = 0; k < eqVols_.size(); k++) {
+            const vector<Period>& expiries = simMarketConfig_->equityVolExpiries(simMarketConfig_->equityVolNames()[k]);
+            const Real* z_eqIr = state(i, eqVols_[k]->eqCcyIndex());
+            const Real* logEq = state(i, eqVols_[k]->equityIndex());
+            for (Size p = 0; p < n; ++p) {
+                eqVols_[k]->move(dates_[i], z_eqIr[p], logEq[p]);
+                for (Size j = 0; j < expiries.size(); j++)
+                    value(i, slot + j)[p] = eqVols_[k]->blackVol(dates_[i] + expiries[j], Null<Real>(), true);
             }
+            slot += expiries.size();
         }
 
         // Inflation index values
         for (Size j = 0; j < n_inf_; j++) {
 
             // Depending on type of model, i.e. DK or JY, z and y mean different things.
-            Real z = sample.value[model_->pIdx(CrossAssetModel::AssetType::INF, j, 0)][i + 1];
-            Real y = sample.value[model_->pIdx(CrossAssetModel::AssetType::INF, j, 1)][i + 1];
+            const Real* z = state(i, model_->pIdx(CrossAssetModel::AssetType::INF, j, 0));
+            const Real* y = state(i, model_->pIdx(CrossAssetModel::AssetType::INF, j, 1));
+            Real* v = value(i, slot++);
 
-            // Could possibly cache the model type outside the loop to improve performance.
-            Real cpi = 0.0;
             if (model_->modelType(CrossAssetModel::AssetType::INF, j) == CrossAssetModel::ModelType::JY) {
-                cpi = std::exp(sample.value[model_->pIdx(CrossAssetModel::AssetType::INF, j, 1)][i + 1]);
+                for (Size p = 0; p < n; ++p)
+                    v[p] = std::exp(y[p]);
             } else if (model_->modelType(CrossAssetModel::AssetType::INF, j) == CrossAssetModel::ModelType::DK) {
                 auto index = *initMarket_->zeroInflationIndex(model_->inf(j)->name());
                 Date baseDate = index->zeroInflationTermStructure()->baseDate();
                 auto zts = index->zeroInflationTermStructure();
-                Time relativeTime = inflationYearFraction(zts->frequency(), false, zts->dayCounter(),
-                                                          baseDate, dates_[i] - zts->observationLag());
-                std::tie(cpi, std::ignore) = model_->infdkI(j, relativeTime, relativeTime, z, y);
-                cpi *= index->fixing(baseDate);
+                Time relativeTime = inflationYearFraction(zts->frequency(), false, zts->dayCounter(), baseDate,
+                                                          dates_[i] - zts->observationLag());
+                Real baseFixing = index->fixing(baseDate);
+                for (Size p = 0; p < n; ++p) {
+                    Real cpi;
+                    std::tie(cpi, std::ignore) = model_->infdkI(j, relativeTime, relativeTime, z[p], y[p]);
+                    v[p] = cpi * baseFixing;
+                }
             } else {
                 QL_FAIL("CrossAssetModelScenarioGenerator: expected inflation model to be JY or DK.");
             }
-
-            scenarios[i]->add(cpiKeys_[j], cpi);
         }
 
         // Zero inflation curves
         for (Size j = 0; j < zeroInfCurves_.size(); ++j) {
 
-            auto tup = zeroInfCurves_[j];
+            const auto& tup = zeroInfCurves_[j];
 
             // State variables needed depends on model, 3 for JY and 2 for DK.
             auto idx = std::get<0>(tup);
-            Array state(3);
-            state[0] = sample.value[model_->pIdx(CrossAssetModel::AssetType::INF, idx, 0)][i + 1];
-            state[1] = sample.value[model_->pIdx(CrossAssetModel::AssetType::INF, idx, 1)][i + 1];
-            if (std::get<2>(tup) == CrossAssetModel::ModelType::DK) {
-                state.resize(2);
-            } else {
-                state[2] = ir_state[std::get<1>(tup)][0];
-            }
-
-            // Update the term structure's date and state.
+            bool isDk = std::get<2>(tup) == CrossAssetModel::ModelType::DK;
+            const Real* s0 = state(i, model_->pIdx(CrossAssetModel::AssetType::INF, idx, 0));
+            const Real* s1 = state(i, model_->pIdx(CrossAssetModel::AssetType::INF, idx, 1));
+            const Real* s2 = state(i, model_->pIdx(CrossAssetModel::AssetType::IR, std::get<1>(tup)));
             auto ts = std::get<3>(tup);
-            ts->move(dates_[i], state);
 
-            // Populate the zero inflation scenario values based on the current date and state.
-            for (Size k = 0; k < ten_zinf_[j].size(); k++) {
-                Time T = dc.yearFraction(dates_[i], dates_[i] + ten_zinf_[j][k]);
-                scenarios[i]->add(zeroInflationKeys_[j * ten_zinf_[j].size() + k], ts->zeroRate(T));
+            std::vector<Time> T(ten_zinf_[j].size());
+            for (Size k = 0; k < T.size(); k++)
+                T[k] = dc.yearFraction(dates_[i], dates_[i] + ten_zinf_[j][k]);
+
+            Array infState(isDk ? 2 : 3);
+            for (Size p = 0; p < n; ++p) {
+                infState[0] = s0[p];
+                infState[1] = s1[p];
+                if (!isDk)
+                    infState[2] = s2[p];
+                // Update the term structure's date and state.
+                ts->move(dates_[i], infState);
+                for (Size k = 0; k < T.size(); k++)
+                    value(i, slot + k)[p] = ts->zeroRate(T[k]);
             }
+            slot += T.size();
         }
 
         // YoY inflation curves
         for (Size j = 0; j < yoyInfCurves_.size(); ++j) {
 
-            auto tup = yoyInfCurves_[j];
+            const auto& tup = yoyInfCurves_[j];
 
             // For YoY model implied term structure, JY and DK both need 3 state variables.
             auto idx = std::get<0>(tup);
-            Array state(3);
-            state[0] = sample.value[model_->pIdx(CrossAssetModel::AssetType::INF, idx, 0)][i + 1];
-            state[1] = sample.value[model_->pIdx(CrossAssetModel::AssetType::INF, idx, 1)][i + 1];
-            state[2] = ir_state[std::get<1>(tup)][0];
-
-            // Update the term structure's date and state.
+            const Real* s0 = state(i, model_->pIdx(CrossAssetModel::AssetType::INF, idx, 0));
+            const Real* s1 = state(i, model_->pIdx(CrossAssetModel::AssetType::INF, idx, 1));
+            const Real* s2 = state(i, model_->pIdx(CrossAssetModel::AssetType::IR, std::get<1>(tup)));
             auto ts = std::get<3>(tup);
-            ts->move(dates_[i], state);
 
             // Create the YoY pillar dates from the tenors.
             vector<Date> pillarDates(ten_yinf_[j].size());
             for (Size k = 0; k < pillarDates.size(); ++k)
                 pillarDates[k] = dates_[i] + ten_yinf_[j][k];
 
-            // Use the YoY term structure's YoY rates to populate the scenarios.
-            auto yoyRates = ts->yoyRates(pillarDates);
-            for (Size k = 0; k < pillarDates.size(); ++k) {
-                scenarios[i]->add(yoyInflationKeys_[j * ten_yinf_[j].size() + k], yoyRates.at(pillarDates[k]));
+            Array infState(3);
+            for (Size p = 0; p < n; ++p) {
+                infState[0] = s0[p];
+                infState[1] = s1[p];
+                infState[2] = s2[p];
+                // Update the term structure's date and state and use its YoY rates.
+                ts->move(dates_[i], infState);
+                auto yoyRates = ts->yoyRates(pillarDates);
+                for (Size k = 0; k < pillarDates.size(); ++k)
+                    value(i, slot + k)[p] = yoyRates.at(pillarDates[k]);
             }
+            slot += pillarDates.size();
         }
 
         // Credit curves
         for (Size j = 0; j < n_cr_; ++j) {
+            std::vector<Time> T(ten_dfc_[j].size());
+            for (Size k = 0; k < T.size(); k++)
+                T[k] = dc.yearFraction(dates_[i], dates_[i] + ten_dfc_[j][k]);
             if (model_->modelType(CrossAssetModel::AssetType::CR, j) == CrossAssetModel::ModelType::LGM1F) {
-                Real z = sample.value[model_->pIdx(CrossAssetModel::AssetType::CR, j, 0)][i + 1];
-                Real y = sample.value[model_->pIdx(CrossAssetModel::AssetType::CR, j, 1)][i + 1];
-                lgmDefaultCurves_[j]->move(dates_[i], z, y);
-                for (Size k = 0; k < ten_dfc_[j].size(); k++) {
-                    Date d = dates_[i] + ten_dfc_[j][k];
-                    Time T = dc.yearFraction(dates_[i], d);
-                    Real survProb = std::max(lgmDefaultCurves_[j]->survivalProbability(T), 0.00001);
-                    scenarios[i]->add(defaultCurveKeys_[j * ten_dfc_[j].size() + k], survProb);
+                const Real* z = state(i, model_->pIdx(CrossAssetModel::AssetType::CR, j, 0));
+                const Real* y = state(i, model_->pIdx(CrossAssetModel::AssetType::CR, j, 1));
+                for (Size p = 0; p < n; ++p) {
+                    lgmDefaultCurves_[j]->move(dates_[i], z[p], y[p]);
+                    for (Size k = 0; k < T.size(); k++)
+                        value(i, slot + k)[p] = std::max(lgmDefaultCurves_[j]->survivalProbability(T[k]), 0.00001);
                 }
+                slot += T.size();
             } else if (model_->modelType(CrossAssetModel::AssetType::CR, j) == CrossAssetModel::ModelType::CIRPP) {
-                Real y = sample.value[model_->pIdx(CrossAssetModel::AssetType::CR, j, 0)][i + 1];
-                cirppDefaultCurves_[j]->move(dates_[i], y);
-                for (Size k = 0; k < ten_dfc_[j].size(); k++) {
-                    Date d = dates_[i] + ten_dfc_[j][k];
-                    Time T = dc.yearFraction(dates_[i], d);
-                    Real survProb = std::max(cirppDefaultCurves_[j]->survivalProbability(T), 0.00001);
-                    scenarios[i]->add(defaultCurveKeys_[j * ten_dfc_[j].size() + k], survProb);
+                const Real* y = state(i, model_->pIdx(CrossAssetModel::AssetType::CR, j, 0));
+                for (Size p = 0; p < n; ++p) {
+                    cirppDefaultCurves_[j]->move(dates_[i], y[p]);
+                    for (Size k = 0; k < T.size(); k++)
+                        value(i, slot + k)[p] =
+                            std::max(cirppDefaultCurves_[j]->survivalProbability(T[k]), 0.00001);
                 }
+                slot += T.size();
             }
         }
 
         // Commodity curves
         Array comState(1, 0.0); // FIXME: single-factor for now
         for (Size j = 0; j < n_com_; j++) {
-            comState[0] = sample.value[model_->pIdx(CrossAssetModel::AssetType::COM, j)][i + 1];
-            comCurves_[j]->move(t, comState);
-            for (Size k = 0; k < ten_com_[j].size(); k++) {
-                Date d = dates_[i] + ten_com_[j][k];
-                Time T = dc.yearFraction(dates_[i], d);
-                Real price = std::max(comCurves_[j]->price(T), 0.00001);
-                scenarios[i]->add(commodityCurveKeys_[j * ten_com_[j].size() + k], price);
+            const Real* x = state(i, model_->pIdx(CrossAssetModel::AssetType::COM, j));
+            std::vector<Time> T(ten_com_[j].size());
+            for (Size k = 0; k < T.size(); k++)
+                T[k] = dc.yearFraction(dates_[i], dates_[i] + ten_com_[j][k]);
+            for (Size p = 0; p < n; ++p) {
+                comState[0] = x[p];
+                comCurves_[j]->move(t, comState);
+                for (Size k = 0; k < T.size(); k++)
+                    value(i, slot + k)[p] = std::max(comCurves_[j]->price(T[k]), 0.00001);
             }
+            slot += T.size();
         }
 
         // Credit States
         for (Size k = 0; k < n_crstates_; ++k) {
-            Real z = sample.value[model_->pIdx(CrossAssetModel::AssetType::CrState, k)][i + 1];
-            scenarios[i]->add(crStateKeys_[k], z);
+            const Real* z = state(i, model_->pIdx(CrossAssetModel::AssetType::CrState, k));
+            std::copy(z, z + n, value(i, slot++));
         }
 
         // Survival Weights, stochastic cumulative survival probability, Recovery Rates
         for (Size k = 0; k < n_survivalweights_; ++k) {
-            string name = simMarketConfig_->additionalScenarioDataSurvivalWeights()[k];
             Real rr = survivalWeightsDefaultCurves_[k]->recovery().empty()
                           ? 0.0
                           : survivalWeightsDefaultCurves_[k]->recovery()->value();
-            scenarios[i]->add(survivalWeightKeys_[k],
-                              survivalWeightsDefaultCurves_[k]->curve()->survivalProbability(dates_[i]));
-            scenarios[i]->add(recoveryRateKeys_[k], rr);
+            Real sp = survivalWeightsDefaultCurves_[k]->curve()->survivalProbability(dates_[i]);
+            std::fill(value(i, slot), value(i, slot) + n, sp);
+            std::fill(value(i, slot + 1), value(i, slot + 1) + n, rr);
+            slot += 2;
         }
+
+        QL_REQUIRE(slot == nKeys, "CrossAssetModelScenarioGenerator: internal error, generated "
+                                      << slot << " values, expected " << nKeys);
     }
-    return scenarios;
 }
+
 } // namespace analytics
 } // namespace ore
@@ -27,6 +27,7 @@
 #include <orea/scenario/scenariogenerator.hpp>
 #include <orea/scenario/scenariosimmarket.hpp>
 #include <orea/scenario/scenariosimmarketparameters.hpp>
+#include <orea/scenario/simplescenario.hpp>
 #include <ored/marketdata/market.hpp>
 #include <ored/utilities/dategrid.hpp>
 
@@ -60,6 +61,11 @@ using namespace QuantExt;
   - a simulation date grid that starts in the future, i.e. does not include today's date
   - the associated time grid including t=0
 
+  Paths are simulated in blocks of up to \p pathBlockSize paths. The risk factor values of a block are computed for
+  all paths of the block in one pass over the dates and risk factor keys and stored in a dense (date x key x path)
+  block, from which nextPath() builds the scenarios. For LGM1F ir models the model implied discount factors on the
+  simulation dates are of the form \f$ a \exp(-b x) \f$, the coefficients are computed once in the constructor.
+
   \ingroup scenario
  */
 class CrossAssetModelScenarioGenerator : public ScenarioPathGenerator {
@@ -71,13 +77,21 @@ public:
                                      QuantLib::ext::shared_ptr<ScenarioSimMarketParameters> simMarketConfig,
                                      QuantLib::Date today, QuantLib::ext::shared_ptr<DateGrid> grid,
                                      QuantLib::ext::shared_ptr<ore::data::Market> initMarket,
-                                     const std::string& configuration = Market::defaultConfiguration);
+                                     const std::string& configuration = Market::defaultConfiguration,
+                                     const QuantLib::Size pathBlockSize = 1);
     //! Default destructor
     ~CrossAssetModelScenarioGenerator(){};
     std::vector<QuantLib::ext::shared_ptr<Scenario>> nextPath() override;
-    void reset() override { pathGenerator_->reset(); }
+    void reset() override {
+        pathGenerator_->reset();
+        blockPos_ = blockSize_;
+    }
 
 private:
+    void generateBlock();
+    // true if the scenario's keys are keys_, the comparison is cached per shared data block and keys hash
+    bool hasKeys(const SimpleScenario& s);
+
     QuantLib::ext::shared_ptr<QuantExt::CrossAssetModel> model_;
     QuantLib::ext::shared_ptr<QuantExt::MultiPathGeneratorBase> pathGenerator_;
     QuantLib::ext::shared_ptr<ScenarioFactory> scenarioFactory_;
@@ -107,6 +121,20 @@ private:
     vector<QuantLib::ext::shared_ptr<QuantExt::LgmImpliedDefaultTermStructure>> lgmDefaultCurves_;
     vector<QuantLib::ext::shared_ptr<QuantExt::CirppImpliedDefaultTermStructure>> cirppDefaultCurves_;
     vector<QuantLib::ext::shared_ptr<QuantExt::CreditCurve>> survivalWeightsDefaultCurves_;
+    vector<Size> indexCcyIdx_, yieldCurveCcyIdx_;
+
+    // all keys in the order in which the values are generated
+    std::vector<RiskFactorKey> keys_;
+    // LGM1F only: the discount factors of the c-th discount, index or yield curve on date i for tenor k are given by
+    // a * exp(-b * x), the coefficients are stored at index i * number of tenors + k, empty for other ir models
+    std::vector<std::vector<Real>> lgmCurveA_, lgmCurveB_;
+    // current block of simulated paths (date x state x path), values (date x key x path), numeraires (date x path)
+    Size blockSize_, blockPos_;
+    std::vector<Real> stateBlock_, valueBlock_, numeraireBlock_;
+    // shared data block and keys hash of the last scenario checked in hasKeys() and the result of the check
+    QuantLib::ext::shared_ptr<SimpleScenario::SharedData> checkedSharedData_;
+    std::size_t checkedKeysHash_ = 0;
+    bool checkedHasKeys_ = false;
 };
 
 } // namespace analytics
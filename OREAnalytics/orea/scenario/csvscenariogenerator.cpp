@@ -34,6 +34,12 @@ namespace analytics {
 CSVScenarioGenerator::CSVScenarioGenerator(const std::string& filename,
                                            const QuantLib::ext::shared_ptr<ScenarioFactory> scenarioFactory, const char sep)
     : sep_(sep), filename_(filename), scenarioFactory_(scenarioFactory) {
+    if (isBinaryScenarioFile(filename)) {
+        binaryFile_ = QuantLib::ext::make_shared<BinaryScenarioFile>(filename);
+        QL_REQUIRE(!binaryFile_->keys().empty(), "No RiskFactorKeys found in " << filename);
+        keys_ = binaryFile_->keys();
+        return;
+    }
     file_.open(filename_.c_str());
     QL_REQUIRE(file_.is_open(), "error opening file " << filename_);
     readKeys();
@@ -54,6 +60,13 @@ void CSVScenarioGenerator::readKeys() {
     }
 }
 QuantLib::ext::shared_ptr<Scenario> CSVScenarioGenerator::next(const Date& d) {
+    if (binaryFile_) {
+        QL_REQUIRE(binaryPos_ < binaryFile_->size(), "unexpected end of scenario file " << filename_);
+        QL_REQUIRE(binaryFile_->date(binaryPos_) == d,
+                   "Incompatible date " << binaryFile_->date(binaryPos_) << " in " << filename_);
+        return binaryFile_->scenario(binaryPos_++);
+    }
+
     // Read in the next line
     QL_REQUIRE(!file_.eof(), "unexpected end of scenario file " << filename_);
     string line;
@@ -81,6 +94,10 @@ QuantLib::ext::shared_ptr<Scenario> CSVScenarioGenerator::next(const Date& d) {
 }
 
 void CSVScenarioGenerator::reset() {
+    if (binaryFile_) {
+        binaryPos_ = 0;
+        return;
+    }
     file_.seekg(std::ios::beg);
     string dummy;
     getline(file_, dummy);
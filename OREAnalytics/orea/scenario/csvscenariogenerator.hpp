@@ -20,6 +20,7 @@
 
 #include <fstream>
 
+#include <orea/scenario/binaryscenariofile.hpp>
 #include <orea/scenario/scenario.hpp>
 #include <orea/scenario/scenariofactory.hpp>
 #include <orea/scenario/scenariogenerator.hpp>
@@ -28,6 +29,8 @@ namespace ore {
 namespace analytics {
 
 //! Class for generating scenarios from a csv file assumed to be in a format compatible with ScenarioWriter.
+/*! Files with extension .bin are read in the binary scenario format. In this case the scenarios are built directly
+    from the mapped file, sharing the keys of the file, and the scenario factory is not used. */
 class CSVScenarioGenerator : public ScenarioGenerator {
 public:
     CSVScenarioGenerator(const std::string& filename, const QuantLib::ext::shared_ptr<ScenarioFactory> scenarioFactory,
@@ -47,6 +50,8 @@ private:
     const char sep_;
     const std::string& filename_;
     const QuantLib::ext::shared_ptr<ScenarioFactory> scenarioFactory_;
+    QuantLib::ext::shared_ptr<BinaryScenarioFile> binaryFile_;
+    Size binaryPos_ = 0;
 };
 } // namespace analytics
 } // namespace ore
@@ -22,6 +22,9 @@
 #include <ored/utilities/parsers.hpp>
 #include <ql/errors.hpp>
 
+#include <algorithm>
+#include <cmath>
+
 using ore::data::CSVFileReader;
 using ore::data::parseDate;
 using ore::data::parseReal;
@@ -33,52 +36,85 @@ namespace analytics {
 
 HistoricalScenarioFileReader::HistoricalScenarioFileReader(const string& fileName,
                                                            const QuantLib::ext::shared_ptr<ScenarioFactory>& scenarioFactory)
-    : scenarioFactory_(scenarioFactory), file_(fileName, true), finished_(false) {
+    : scenarioFactory_(scenarioFactory), finished_(false) {
+
+    if (isBinaryScenarioFile(fileName)) {
+        binaryFile_ = QuantLib::ext::make_shared<BinaryScenarioFile>(fileName);
+        QL_REQUIRE(!binaryFile_->keys().empty(), "Need at least one risk factor key in the file " << fileName);
+        keys_ = binaryFile_->keys();
+        return;
+    }
+
+    file_ = QuantLib::ext::make_shared<CSVFileReader>(fileName, true);
 
     // Do some checks
-    QL_REQUIRE(file_.fields().size() >= 4, "Need at least 4 columns in the file " << fileName);
-    QL_REQUIRE(file_.fields()[0] == "Date", "First column must be 'Date' in the file " << fileName);
-    QL_REQUIRE(file_.fields()[1] == "Scenario", "Second column should be 'Scenario' in the file " << fileName);
-    QL_REQUIRE(file_.fields()[2] == "Numeraire", "Third column should be 'Numeraire' in the file " << fileName);
+    QL_REQUIRE(file_->fields().size() >= 4, "Need at least 4 columns in the file " << fileName);
+    QL_REQUIRE(file_->fields()[0] == "Date", "First column must be 'Date' in the file " << fileName);
+    QL_REQUIRE(file_->fields()[1] == "Scenario", "Second column should be 'Scenario' in the file " << fileName);
+    QL_REQUIRE(file_->fields()[2] == "Numeraire", "Third column should be 'Numeraire' in the file " << fileName);
 
     // Populate the risk factor keys vector
-    keys_.reserve(file_.fields().size() - 3);
-    for (Size k = 3; k < file_.fields().size(); ++k) {
-        keys_.push_back(parseRiskFactorKey(file_.fields()[k]));
+    keys_.reserve(file_->fields().size() - 3);
+    for (Size k = 3; k < file_->fields().size(); ++k) {
+        keys_.push_back(parseRiskFactorKey(file_->fields()[k]));
     }
 }
 
 HistoricalScenarioFileReader::~HistoricalScenarioFileReader() {
     // Close the file
-    file_.close();
+    if (file_)
+        file_->close();
     LOG("The file has been closed");
 }
 
 bool HistoricalScenarioFileReader::next() {
-    finished_ = file_.next() ? false : true;
+    if (binaryFile_) {
+        finished_ = next_ >= binaryFile_->size();
+        if (!finished_)
+            current_ = next_++;
+        return !finished_;
+    }
+    finished_ = file_->next() ? false : true;
     return !finished_;
 }
 
 Date HistoricalScenarioFileReader::date() const {
     if (finished_) {
         return Null<Date>();
+    } else if (binaryFile_) {
+        return binaryFile_->date(current_);
     } else {
-        return parseDate(file_.get("Date"));
+        return parseDate(file_->get("Date"));
     }
 }
 
 QuantLib::ext::shared_ptr<ore::analytics::Scenario> HistoricalScenarioFileReader::scenario() const {
     if (finished_) {
         return nullptr;
+    } else if (binaryFile_) {
+        // a row without missing values is returned as a scenario sharing the keys of the file, otherwise the missing
+        // (NaN) values are skipped as for empty fields in the csv format
+        const Real* values = binaryFile_->values(current_);
+        if (std::none_of(values, values + keys_.size(), [](Real v) { return std::isnan(v); }))
+            return binaryFile_->scenario(current_);
+        Date date = binaryFile_->date(current_);
+        TLOG("Creating scenario for date " << io::iso_date(date));
+        QuantLib::ext::shared_ptr<Scenario> scenario =
+            scenarioFactory_->buildScenario(date, true, std::string(), binaryFile_->numeraire(current_));
+        for (Size k = 0; k < keys_.size(); ++k) {
+            if (!std::isnan(values[k]))
+                scenario->add(keys_[k], values[k]);
+        }
+        return scenario;
     } else {
-        Date date = parseDate(file_.get("Date"));
-        Real numeraire = parseReal(file_.get("Numeraire"));
+        Date date = parseDate(file_->get("Date"));
+        Real numeraire = parseReal(file_->get("Numeraire"));
         TLOG("Creating scenario for date " << io::iso_date(date));
         QuantLib::ext::shared_ptr<Scenario> scenario =
             scenarioFactory_->buildScenario(date, true, std::string(), numeraire);
         Real value;
         for (Size k = 0; k < keys_.size(); ++k) {
-            if (ore::data::tryParseReal(file_.get(k + 3), value))
+            if (ore::data::tryParseReal(file_->get(k + 3), value))
                 scenario->add(keys_[k], value);
         }
         return scenario;
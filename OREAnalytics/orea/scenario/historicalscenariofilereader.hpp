@@ -25,6 +25,7 @@
 
 #include <orea/scenario/historicalscenarioreader.hpp>
 
+#include <orea/scenario/binaryscenariofile.hpp>
 #include <orea/scenario/scenariofactory.hpp>
 #include <ored/utilities/csvfilereader.hpp>
 #include <string>
@@ -34,6 +35,7 @@ namespace ore {
 namespace analytics {
 
 //! Class for reading historical scenarios from a csv file
+/*! Files with extension .bin are read in the binary scenario format, see BinaryScenarioFile. */
 class HistoricalScenarioFileReader : public HistoricalScenarioReader {
 public:
     /*! Constructor where \p filename gives the path to the file from which to
@@ -54,7 +56,11 @@ private:
     //! Scenario factory
     QuantLib::ext::shared_ptr<ScenarioFactory> scenarioFactory_;
     //! Handle on the csv file
-    ore::data::CSVFileReader file_;
+    QuantLib::ext::shared_ptr<ore::data::CSVFileReader> file_;
+    //! Handle on the binary file, if the file is in the binary scenario format
+    QuantLib::ext::shared_ptr<BinaryScenarioFile> binaryFile_;
+    //! Current and next scenario index in the binary file
+    Size current_ = 0, next_ = 0;
     //! The risk factor keys of the scenarios in the file
     std::vector<RiskFactorKey> keys_;
     //! Flag indicating if the reader has no more scenarios to read
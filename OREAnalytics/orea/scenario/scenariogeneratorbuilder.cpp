@@ -58,8 +58,12 @@ ScenarioGeneratorBuilder::build(QuantLib::ext::shared_ptr<QuantExt::CrossAssetMo
     auto pathGen = pf->build(data_->sequenceType(), process, data_->getGrid()->timeGrid(), data_->seed(),
                              data_->ordering(), data_->directionIntegers());
 
+    // generate the paths in blocks, but not more than we need
+    Size pathBlockSize = std::min<Size>(std::max<Size>(data_->samples(), 1), 256);
+
     return QuantLib::ext::make_shared<CrossAssetModelScenarioGenerator>(model, pathGen, scenarioFactory, marketConfig, asof,
-                                                                data_->getGrid(), initMarket, configuration);
+                                                                data_->getGrid(), initMarket, configuration,
+                                                                pathBlockSize);
 }
 } // namespace analytics
 } // namespace ore
@@ -107,6 +107,8 @@
 #include <boost/algorithm/string.hpp>
 #include <boost/timer/timer.hpp>
 
+#include <algorithm>
+
 using namespace QuantLib;
 using namespace QuantExt;
 using namespace ore::data;
@@ -297,6 +299,8 @@ void ScenarioSimMarket::addYieldCurve(const QuantLib::ext::shared_ptr<Market>& i
         makeYieldCurve(key, spreaded, wrapper, yieldCurveTimes, quotes, dc, TARGET(), parameters_->interpolation(),
                        parameters_->extrapolation());
 
+    addBatchedCurve(quotes, yieldCurve);
+
     Handle<YieldTermStructure> ych(yieldCurve);
     if (wrapper->allowsExtrapolation())
         ych->enableExtrapolation();
@@ -482,6 +486,8 @@ ScenarioSimMarket::ScenarioSimMarket(
                             name, useSpreadedTermStructures_, wrapperIndex, yieldCurveTimes, quotes, dc,
                             index->fixingCalendar(), parameters_->interpolation(), parameters_->extrapolation());
 
+                        addBatchedCurve(quotes, indexCurve);
+
                         Handle<YieldTermStructure> ich(indexCurve);
                         if (wrapperIndex->allowsExtrapolation())
                             ich->enableExtrapolation();
@@ -2978,6 +2984,60 @@ void ScenarioSimMarket::reset() {
 void ScenarioSimMarket::applyScenario(const QuantLib::ext::shared_ptr<Scenario>& scenario) {
 
     currentScenario_ = scenario;
+    ++notificationCounters_.scenarios;
+
+    /* in observation mode Batch the quotes are written with updates disabled and the changed quotes notify their
+       observers after the whole scenario is written, unless updates are disabled already */
+
+    if (ObservationMode::instance().mode() != ObservationMode::Mode::Batch ||
+        !ObservableSettings::instance().updatesEnabled()) {
+        writeScenario(scenario);
+        return;
+    }
+
+    batchNotifications_ = true;
+    ObservableSettings::instance().disableUpdates(false);
+    try {
+        writeScenario(scenario);
+    } catch (...) {
+        notifyBatchedQuotes();
+        throw;
+    }
+    notifyBatchedQuotes();
+}
+
+void ScenarioSimMarket::notifyBatchedQuotes() {
+    batchNotifications_ = false;
+    std::sort(batchedQuotes_.begin(), batchedQuotes_.end());
+    batchedQuotes_.erase(std::unique(batchedQuotes_.begin(), batchedQuotes_.end()), batchedQuotes_.end());
+    // each quote of a curve has its own handle observing it, so notifying the quotes would update the curve once per
+    // changed quote, instead the curve itself is updated once
+    std::set<TermStructure*> curves;
+    // with deferred updates the observers of all quotes and curves are collected in a set and updated once on
+    // enableUpdates()
+    ObservableSettings::instance().disableUpdates(true);
+    for (auto q : batchedQuotes_) {
+        if (auto c = batchedCurves_.find(q); c != batchedCurves_.end()) {
+            curves.insert(c->second.get());
+        } else {
+            q->notifyObservers();
+            ++notificationCounters_.notifications;
+        }
+    }
+    for (auto c : curves)
+        c->update();
+    notificationCounters_.notifications += curves.size();
+    batchedQuotes_.clear();
+    ObservableSettings::instance().enableUpdates();
+}
+
+void ScenarioSimMarket::addBatchedCurve(const std::vector<Handle<Quote>>& quotes,
+                                        const QuantLib::ext::shared_ptr<TermStructure>& curve) {
+    for (auto const& q : quotes)
+        batchedCurves_[q.currentLink().get()] = curve;
+}
+
+void ScenarioSimMarket::writeScenario(const QuantLib::ext::shared_ptr<Scenario>& scenario) {
 
     // 1 handle delta scenario
 
@@ -2987,13 +3047,10 @@ void ScenarioSimMarket::applyScenario(const QuantLib::ext::shared_ptr<Scenario>&
         delta scenarios or the base scenario */
 
     if (deltaScenario != nullptr) {
-        for (auto const& key : diffToBaseKeys_) {
-            auto it = simData_.find(key);
-            if (it != simData_.end()) {
-                it->second->setValue(baseScenario_->get(key));
-            }
-        }
-        diffToBaseKeys_.clear();
+        // the keys of the previous delta that are not in this delta are reset to their base values afterwards, so
+        // that a key that is set to the same value again is not tracked as changed
+        std::set<RiskFactorKey> previousDiffToBaseKeys;
+        previousDiffToBaseKeys.swap(diffToBaseKeys_);
         auto delta = deltaScenario->delta();
         bool missingPoint = false;
         for (auto const& key : delta->keys()) {
@@ -3003,11 +3060,19 @@ void ScenarioSimMarket::applyScenario(const QuantLib::ext::shared_ptr<Scenario>&
                 missingPoint = true;
             } else {
                 if (filter_->allow(key)) {
-                    it->second->setValue(delta->get(key));
+                    setSimDataValue(key, *it->second, delta->get(key));
                     diffToBaseKeys_.insert(key);
                 }
             }
         }
+        for (auto const& key : previousDiffToBaseKeys) {
+            if (diffToBaseKeys_.find(key) != diffToBaseKeys_.end())
+                continue;
+            auto it = simData_.find(key);
+            if (it != simData_.end()) {
+                setSimDataValue(key, *it->second, baseScenario_->get(key));
+            }
+        }
         QL_REQUIRE(!missingPoint, "simulation data points missing from scenario, exit.");
 
         return;
@@ -3051,8 +3116,12 @@ void ScenarioSimMarket::applyScenario(const QuantLib::ext::shared_ptr<Scenario>&
 
             Size i = 0;
             for (auto const& q : s->data()) {
-                if (cachedSimDataActive_[i])
-                    cachedSimData_[i]->setValue(q);
+                if (cachedSimDataActive_[i]) {
+                    if (trackChangedRiskFactors_)
+                        setSimDataValue(s->keys()[i], *cachedSimData_[i], q);
+                    else
+                        setQuoteValue(*cachedSimData_[i], q);
+                }
                 ++i;
             }
 
@@ -3076,7 +3145,7 @@ void ScenarioSimMarket::applyScenario(const QuantLib::ext::shared_ptr<Scenario>&
             WLOG("simulation data point missing for key " << key);
         } else {
             if (filter_->allow(key)) {
-                it->second->setValue(scenario->get(key));
+                setSimDataValue(key, *it->second, scenario->get(key));
             }
             count++;
         }
@@ -3193,6 +3262,110 @@ bool ScenarioSimMarket::isSimulated(const RiskFactorKey::KeyType& factor) const
     return std::find(nonSimulatedFactors_.begin(), nonSimulatedFactors_.end(), factor) == nonSimulatedFactors_.end();
 }
 
+bool ScenarioSimMarket::riskFactors(const std::set<std::pair<MarketObject, std::string>>& objects,
+                                    std::set<std::pair<RiskFactorKey::KeyType, std::string>>& result) const {
+
+    using KT = RiskFactorKey::KeyType;
+
+    // the risk factors a market object depends on, given as key type and a flag whether only the risk factor with the
+    // name of the market object (true) or all risk factors of the key type (false) are relevant. Vols can be proxied
+    // by other vols, fx spots and indices can be triangulated and composite objects (e.g. equity curves or swap
+    // indices) reference curves under other names, in these cases all risk factors of the key type are considered.
+
+    static const std::vector<std::pair<KT, bool>> curves = {
+        {KT::DiscountCurve, false}, {KT::YieldCurve, false}, {KT::IndexCurve, false}};
+
+    std::vector<std::pair<KT, bool>> factors;
+    for (auto const& [o, name] : objects) {
+        factors.clear();
+        switch (o) {
+        case MarketObject::DiscountCurve:
+            factors = {{KT::DiscountCurve, true}};
+            break;
+        case MarketObject::YieldCurve:
+            factors = {{KT::YieldCurve, true}};
+            break;
+        case MarketObject::IndexCurve:
+            factors = {{KT::IndexCurve, true}};
+            if (iborFallbackConfig_.isIndexReplaced(name))
+                result.emplace(KT::IndexCurve, iborFallbackConfig_.fallbackData(name).rfrIndex);
+            break;
+        case MarketObject::SwapIndexCurve:
+            factors = curves;
+            break;
+        case MarketObject::FXSpot:
+            factors = {{KT::FXSpot, false}, {KT::DiscountCurve, false}};
+            break;
+        case MarketObject::FXVol:
+            factors = curves;
+            factors.insert(factors.end(), {{KT::FXVolatility, false}, {KT::FXSpot, false}});
+            break;
+        case MarketObject::SwaptionVol:
+        case MarketObject::YieldVol:
+            factors = curves;
+            factors.insert(factors.end(), {{KT::SwaptionVolatility, false}, {KT::YieldVolatility, false}});
+            break;
+        case MarketObject::CapFloorVol:
+            factors = curves;
+            factors.push_back({KT::OptionletVolatility, false});
+            break;
+        case MarketObject::DefaultCurve:
+            factors = {{KT::SurvivalProbability, true}, {KT::RecoveryRate, true}};
+            break;
+        case MarketObject::CDSVol:
+            factors = {{KT::CDSVolatility, false}, {KT::SurvivalProbability, false}, {KT::RecoveryRate, false}};
+            break;
+        case MarketObject::BaseCorrelation:
+            factors = {{KT::BaseCorrelation, true}};
+            break;
+        case MarketObject::ZeroInflationCurve:
+            factors = {{KT::ZeroInflationCurve, true}, {KT::CPIIndex, true}};
+            break;
+        case MarketObject::YoYInflationCurve:
+            factors = {{KT::YoYInflationCurve, true}, {KT::ZeroInflationCurve, true}, {KT::CPIIndex, true}};
+            break;
+        case MarketObject::ZeroInflationCapFloorVol:
+            factors = {{KT::ZeroInflationCapFloorVolatility, false}, {KT::ZeroInflationCurve, true},
+                       {KT::CPIIndex, true}};
+            break;
+        case MarketObject::YoYInflationCapFloorVol:
+            factors = {{KT::YoYInflationCapFloorVolatility, false},
+                       {KT::YoYInflationCurve, true},
+                       {KT::ZeroInflationCurve, true},
+                       {KT::CPIIndex, true}};
+            break;
+        case MarketObject::EquityCurve:
+            factors = curves;
+            factors.insert(factors.end(), {{KT::EquitySpot, true}, {KT::DividendYield, true}});
+            break;
+        case MarketObject::EquityVol:
+            factors = curves;
+            factors.insert(factors.end(),
+                           {{KT::EquityVolatility, false}, {KT::EquitySpot, true}, {KT::DividendYield, true}});
+            break;
+        case MarketObject::Security:
+            factors = {{KT::SecuritySpread, true}, {KT::RecoveryRate, true}, {KT::CPR, true}};
+            break;
+        case MarketObject::CommodityCurve:
+            factors = {{KT::CommodityCurve, false}};
+            break;
+        case MarketObject::CommodityVolatility:
+            factors = curves;
+            factors.insert(factors.end(), {{KT::CommodityVolatility, false}, {KT::CommodityCurve, false}});
+            break;
+        case MarketObject::Correlation:
+            factors = {{KT::Correlation, false}};
+            break;
+        default:
+            DLOG("ScenarioSimMarket::riskFactors(): market object " << o << " not handled");
+            return false;
+        }
+        for (auto const& [keyType, sameName] : factors)
+            result.emplace(keyType, sameName ? name : std::string());
+    }
+    return true;
+}
+
 Handle<YieldTermStructure> ScenarioSimMarket::getYieldCurve(const string& yieldSpecId,
                                                             const TodaysMarketParameters& todaysMarketParams,
                                                             const string& configuration,
@@ -141,8 +141,71 @@ public:
 
     void applyScenario(const QuantLib::ext::shared_ptr<Scenario>& scenario);
 
+    //! \name Risk factor dependencies
+    //@{
+    /*! Adds the risk factors, given as key type and name, that the given market objects of this market depend on to
+        the result. An empty name stands for all risk factors of the key type. The result is conservative, i.e. it can
+        contain risk factors the market objects do not depend on. Returns false if the risk factors can not be
+        determined for one of the market objects. */
+    bool riskFactors(const std::set<std::pair<ore::data::MarketObject, std::string>>& objects,
+                     std::set<std::pair<RiskFactorKey::KeyType, std::string>>& result) const;
+
+    /*! If set to true, the risk factors whose sim data values are changed by the following scenario applications are
+        collected, until clearChangedRiskFactors() is called */
+    void trackChangedRiskFactors(const bool b) { trackChangedRiskFactors_ = b; }
+    const std::set<std::pair<RiskFactorKey::KeyType, std::string>>& changedRiskFactors() const {
+        return changedRiskFactors_;
+    }
+    void clearChangedRiskFactors() { changedRiskFactors_.clear(); }
+    //@}
+
+    //! \name Notification counters
+    //@{
+    /*! Number of applied scenarios, of quote values written by them, of written values that changed a quote and of
+        the notifications sent to the observers of the sim market. Without observation mode Batch each changed quote
+        notifies its observers. In observation mode Batch a yield or index curve notifies its observers once per
+        scenario if any of its quotes changed, the other changed quotes notify once after the whole scenario is
+        written. */
+    struct NotificationCounters {
+        Size scenarios = 0;
+        Size quoteUpdates = 0;
+        Size changedQuotes = 0;
+        Size notifications = 0;
+    };
+    const NotificationCounters& notificationCounters() const { return notificationCounters_; }
+    void resetNotificationCounters() { notificationCounters_ = NotificationCounters(); }
+    //@}
+
 protected:
-    
+    // write the scenario values to the sim data quotes
+    void writeScenario(const QuantLib::ext::shared_ptr<Scenario>& scenario);
+
+    // notify the curves and quotes collected in observation mode Batch, each distinct observer is updated once
+    void notifyBatchedQuotes();
+
+    // register the curve built on the given quotes, in observation mode Batch the curve is notified instead of them
+    void addBatchedCurve(const std::vector<Handle<Quote>>& quotes,
+                         const QuantLib::ext::shared_ptr<TermStructure>& curve);
+
+    // set a sim data quote value, returns true if the value changed
+    bool setQuoteValue(SimpleQuote& q, const Real value) {
+        ++notificationCounters_.quoteUpdates;
+        if (q.isValid() && q.value() == value)
+            return false;
+        q.setValue(value);
+        ++notificationCounters_.changedQuotes;
+        if (batchNotifications_)
+            batchedQuotes_.push_back(&q);
+        else
+            ++notificationCounters_.notifications;
+        return true;
+    }
+
+    // set a sim data value and track the change, if required
+    void setSimDataValue(const RiskFactorKey& key, SimpleQuote& q, const Real value) {
+        if (setQuoteValue(q, value) && trackChangedRiskFactors_)
+            changedRiskFactors_.emplace(key.keytype, key.name);
+    }
 
     void writeSimData(std::map<RiskFactorKey, QuantLib::ext::shared_ptr<SimpleQuote>>& simDataTmp,
                       std::map<RiskFactorKey, Real>& absoluteSimDataTmp, const RiskFactorKey::KeyType keyType,
@@ -196,6 +259,16 @@ protected:
 
     mutable QuantLib::ext::shared_ptr<Scenario> currentScenario_;
     QuantLib::ext::shared_ptr<Scenario> offsetScenario_;
+
+    // for risk factor dependencies
+    bool trackChangedRiskFactors_ = false;
+    std::set<std::pair<RiskFactorKey::KeyType, std::string>> changedRiskFactors_;
+
+    // for observation mode Batch
+    bool batchNotifications_ = false;
+    std::vector<SimpleQuote*> batchedQuotes_;
+    std::map<const Quote*, QuantLib::ext::shared_ptr<TermStructure>> batchedCurves_;
+    NotificationCounters notificationCounters_;
 };
 } // namespace analytics
 } // namespace ore
@@ -16,9 +16,13 @@
  FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
 */
 
+#include <orea/scenario/binaryscenariofile.hpp>
 #include <orea/scenario/scenariowriter.hpp>
+#include <orea/scenario/simplescenario.hpp>
 #include <ored/utilities/to_string.hpp>
 
+#include <limits>
+
 using ore::data::to_string;
 
 namespace ore {
@@ -42,7 +46,11 @@ ScenarioWriter::ScenarioWriter(const QuantLib::ext::shared_ptr<ScenarioGenerator
     : src_(src), report_(report), fp_(nullptr), i_(0), sep_(','), headerKeys_(headerKeys) {}
 
 void ScenarioWriter::open(const std::string& filename, const std::string& filemode) {
-    fp_ = fopen(filename.c_str(), filemode.c_str());
+    binary_ = isBinaryScenarioFile(filename);
+    std::string mode = filemode;
+    if (binary_ && mode.find('b') == std::string::npos)
+        mode += "b";
+    fp_ = fopen(filename.c_str(), mode.c_str());
     QL_REQUIRE(fp_, "Error opening file " << filename << " for scenarios");
 }
 
@@ -72,6 +80,10 @@ QuantLib::ext::shared_ptr<Scenario> ScenarioWriter::next(const Date& d) {
 
 void ScenarioWriter::writeScenario(const QuantLib::ext::shared_ptr<Scenario>& s, const bool writeHeader) {
     const Date d = s->asof();
+    if (fp_ && binary_) {
+        writeBinaryScenario(s, writeHeader);
+        return;
+    }
     // take a copy of the keys here to ensure the order is preserved
     keys_ = s->keys();
     std::sort(keys_.begin(), keys_.end());
@@ -124,5 +136,40 @@ void ScenarioWriter::writeScenario(const QuantLib::ext::shared_ptr<Scenario>& s,
     }
 }
 
+void ScenarioWriter::writeBinaryScenario(const QuantLib::ext::shared_ptr<Scenario>& s, const bool writeHeader) {
+    const Date d = s->asof();
+    if (writeHeader || keys_.empty()) {
+        // the keys are written in the order of the scenario (or the given header keys), so that the data of a
+        // SimpleScenario can be written without lookups
+        keys_ = headerKeys_.empty() ? s->keys() : headerKeys_;
+        QL_REQUIRE(keys_.size() > 0, "No keys in scenario");
+        checkedSharedData_ = nullptr;
+    }
+    if (writeHeader) {
+        writeBinaryScenarioFileHeader(fp_, keys_);
+        // set the first date, this will bump i_ to 1 below
+        firstDate_ = d;
+    }
+    if (d == firstDate_)
+        i_++;
+
+    // scenarios usually share their data block, so the keys are compared once per block (and keys hash) only
+    auto simple = QuantLib::ext::dynamic_pointer_cast<SimpleScenario>(s);
+    if (simple && (simple->sharedData() != checkedSharedData_ || simple->keysHash() != checkedKeysHash_)) {
+        checkedSharedData_ = simple->sharedData();
+        checkedKeysHash_ = simple->keysHash();
+        checkedHasKeys_ = simple->keys() == keys_;
+    }
+    if (simple && checkedHasKeys_) {
+        writeBinaryScenarioFileRow(fp_, d, i_, s->getNumeraire(), simple->data().data(), keys_.size());
+    } else {
+        // keys missing in the scenario are written as NaN
+        buffer_.resize(keys_.size());
+        for (Size i = 0; i < keys_.size(); ++i)
+            buffer_[i] = s->has(keys_[i]) ? s->get(keys_[i]) : std::numeric_limits<Real>::quiet_NaN();
+        writeBinaryScenarioFileRow(fp_, d, i_, s->getNumeraire(), buffer_.data(), buffer_.size());
+    }
+}
+
 } // namespace analytics
 } // namespace ore
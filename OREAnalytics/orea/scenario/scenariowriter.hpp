@@ -25,12 +25,15 @@
 
 #include <orea/scenario/scenario.hpp>
 #include <orea/scenario/scenariogenerator.hpp>
+#include <orea/scenario/simplescenario.hpp>
 #include <ored/report/report.hpp>
 
 namespace ore {
 namespace analytics {
 
 //! Class for writing scenarios to file.
+/*! If the file name has the extension .bin, the scenarios are written in the binary scenario format, see
+    BinaryScenarioFile. */
 class ScenarioWriter : public ScenarioGenerator {
 public:
     //! Constructor
@@ -62,6 +65,7 @@ public:
 
 private:
     void open(const std::string& filename, const std::string& filemode = "w+");
+    void writeBinaryScenario(const QuantLib::ext::shared_ptr<Scenario>& s, const bool writeHeader);
 
     QuantLib::ext::shared_ptr<ScenarioGenerator> src_;
     std::vector<RiskFactorKey> keys_;
@@ -71,6 +75,13 @@ private:
     Size i_;
     const char sep_ = ',';
     std::vector<RiskFactorKey> headerKeys_;
+    //! files with extension .bin are written in the binary scenario format, see binaryscenariofile.hpp
+    bool binary_ = false;
+    std::vector<Real> buffer_;
+    //! shared data block and keys hash of the last SimpleScenario whose keys were compared with keys_, and the result
+    QuantLib::ext::shared_ptr<SimpleScenario::SharedData> checkedSharedData_;
+    std::size_t checkedKeysHash_ = 0;
+    bool checkedHasKeys_ = false;
 };
 } // namespace analytics
 } // namespace ore
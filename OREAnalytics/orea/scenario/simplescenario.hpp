@@ -80,6 +80,9 @@ public:
     //! get data, order is the same as in keys()
     const std::vector<Real>& data() const { return data_; }
 
+    //! set data, order is the same as in keys()
+    void setData(std::vector<Real> data);
+
 private:
     QuantLib::ext::shared_ptr<SharedData> sharedData_;
     bool isAbsolute_ = true;
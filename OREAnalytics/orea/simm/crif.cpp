@@ -38,6 +38,93 @@ namespace analytics {
 auto isSimmParameter = [](const ore::analytics::CrifRecord& x) { return x.isSimmParameter(); };
 auto isNotSimmParameter = std::not_fn(isSimmParameter);
 
+Crif::Crif(const Crif& other)
+    : type_(other.type_), records_(other.records_), portfolioIds_(other.portfolioIds_),
+      nettingSetDetails_(other.nettingSetDetails_) {
+    rebuildDiffAmountCurrenciesIndex();
+}
+
+// the nodes of the moved set stay alive, so the pointers in the indices remain valid
+Crif::Crif(Crif&& other) noexcept
+    : type_(other.type_), records_(std::move(other.records_)),
+      diffAmountCurrenciesIndex_(std::move(other.diffAmountCurrenciesIndex_)),
+      portfolioIds_(std::move(other.portfolioIds_)), nettingSetDetails_(std::move(other.nettingSetDetails_)) {
+    index_ = std::move(other.index_);
+    indexed_ = other.indexed_.load();
+    other.invalidateIndex();
+}
+
+Crif& Crif::operator=(const Crif& other) {
+    if (this != &other) {
+        type_ = other.type_;
+        records_ = other.records_;
+        portfolioIds_ = other.portfolioIds_;
+        nettingSetDetails_ = other.nettingSetDetails_;
+        rebuildDiffAmountCurrenciesIndex();
+        invalidateIndex();
+    }
+    return *this;
+}
+
+Crif& Crif::operator=(Crif&& other) noexcept {
+    if (this != &other) {
+        type_ = other.type_;
+        records_ = std::move(other.records_);
+        diffAmountCurrenciesIndex_ = std::move(other.diffAmountCurrenciesIndex_);
+        portfolioIds_ = std::move(other.portfolioIds_);
+        nettingSetDetails_ = std::move(other.nettingSetDetails_);
+        index_ = std::move(other.index_);
+        indexed_ = other.indexed_.load();
+        other.invalidateIndex();
+    }
+    return *this;
+}
+
+void Crif::clear() {
+    records_.clear();
+    diffAmountCurrenciesIndex_.clear();
+    invalidateIndex();
+}
+
+void Crif::rebuildDiffAmountCurrenciesIndex() {
+    diffAmountCurrenciesIndex_.clear();
+    for (const auto& r : records_)
+        diffAmountCurrenciesIndex_[r.getSimmAmountCcyKey()] = &r;
+}
+
+void Crif::invalidateIndex() {
+    indexed_ = false;
+    index_.clear();
+}
+
+const Crif::Index& Crif::index() const {
+    if (!indexed_.load(std::memory_order_acquire)) {
+        std::lock_guard<std::mutex> lock(indexMutex_);
+        if (!indexed_.load(std::memory_order_relaxed)) {
+            // the records are added in the order of the set, so that the views preserve that order
+            index_.clear();
+            for (const auto& r : records_) {
+                auto& g = index_[r.nettingSetDetails][std::make_pair(r.productClass, r.riskType)];
+                g.records.push_back(&r);
+                g.byQualifier[r.qualifier].push_back(&r);
+                g.byBucket[r.bucket].push_back(&r);
+            }
+            indexed_.store(true, std::memory_order_release);
+        }
+    }
+    return index_;
+}
+
+const Crif::IndexGroup* Crif::indexGroup(const NettingSetDetails& nsd, const CrifRecord::ProductClass pc,
+                                         const CrifRecord::RiskType rt) const {
+    const auto& idx = index();
+    auto n = idx.find(nsd);
+    if (n == idx.end())
+        return nullptr;
+    auto g = n->second.find(std::make_pair(pc, rt));
+    return g == n->second.end() ? nullptr : &g->second;
+}
+
 void Crif::addRecord(const CrifRecord& record, bool aggregateDifferentAmountCurrencies, bool sortFxVolQualifer) {
     if (record.type() == CrifRecord::RecordType::FRTB) {
         addFrtbCrifRecord(record, aggregateDifferentAmountCurrencies, sortFxVolQualifer);
@@ -84,6 +171,7 @@ void Crif::insertCrifRecord(const CrifRecord& record, bool aggregateDifferentAmo
     if (it == records_.end() && itDiffAmountCcy == diffAmountCurrenciesIndex_.end()) {
         auto recordIt = records_.insert(record);
         diffAmountCurrenciesIndex_[record.getSimmAmountCcyKey()] = &(*(recordIt.first));
+        invalidateIndex();
         portfolioIds_.insert(record.portfolioId);
         nettingSetDetails_.insert(record.nettingSetDetails);
     } else if (it != records_.end()) {
@@ -96,9 +184,9 @@ void Crif::insertCrifRecord(const CrifRecord& record, bool aggregateDifferentAmo
 void Crif::addSimmParameterRecord(const CrifRecord& record) {
     auto it = records_.find(record);
     if (it == records_.end()) {
-        CrifRecord newRecord = record;
-        records_.insert(newRecord);
-        diffAmountCurrenciesIndex_[record.getSimmAmountCcyKey()] = &newRecord;
+        auto recordIt = records_.insert(record);
+        diffAmountCurrenciesIndex_[record.getSimmAmountCcyKey()] = &(*(recordIt.first));
+        invalidateIndex();
     } else if (it->riskType == CrifRecord::RiskType::AddOnFixedAmount) {
         updateAmountExistingRecord(it, record);
     } else if (it->riskType == CrifRecord::RiskType::AddOnNotionalFactor ||
@@ -195,11 +283,12 @@ Crif Crif::simmParameters() const {
 //! Find first element
 std::set<CrifRecord>::const_iterator Crif::findBy(const NettingSetDetails nsd, CrifRecord::ProductClass pc,
                                                   const CrifRecord::RiskType rt, const std::string& qualifier) const {
-    return std::find_if(records_.begin(), records_.end(), [&nsd, &pc, &rt, &qualifier](const CrifRecord& record) {
-        return record.nettingSetDetails == nsd && record.productClass == pc && record.riskType == rt &&
-               record.qualifier == qualifier;
-    });
-};
+    if (const IndexGroup* g = indexGroup(nsd, pc, rt)) {
+        if (auto q = g->byQualifier.find(qualifier); q != g->byQualifier.end())
+            return records_.find(*q->second.front());
+    }
+    return records_.end();
+}
 
 Crif Crif::filterNonZeroAmount(double threshold, std::string alwaysIncludeFxRiskCcy) const {
     Crif results;
@@ -226,49 +315,52 @@ Crif Crif::filterNonZeroAmount(double threshold, std::string alwaysIncludeFxRisk
 
 std::set<std::string> Crif::qualifiersBy(const NettingSetDetails nsd, CrifRecord::ProductClass pc,
                                          const CrifRecord::RiskType rt) const {
-    auto res = records_ | boost::adaptors::filtered([&nsd, &pc, &rt](const CrifRecord& record) {
-                   return record.nettingSetDetails == nsd && record.productClass == pc && record.riskType == rt;
-               }) |
-               boost::adaptors::transformed([](const CrifRecord& record) { return record.qualifier; });
-    return boost::copy_range<std::set<std::string>>(res);
+    std::set<std::string> qualifiers;
+    if (const IndexGroup* g = indexGroup(nsd, pc, rt)) {
+        for (const auto& [q, _] : g->byQualifier)
+            qualifiers.insert(q);
+    }
+    return qualifiers;
 }
 
-std::vector<CrifRecord> Crif::filterByQualifierAndBucket(const NettingSetDetails& nsd,
-                                                         const CrifRecord::ProductClass pc,
-                                                         const CrifRecord::RiskType rt, const std::string& qualifier,
-                                                         const std::string& bucket) const {
-    return boost::copy_range<std::vector<CrifRecord>>(
-        records_ | boost::adaptors::filtered([&nsd, &pc, &rt, &qualifier, &bucket](const CrifRecord& record) {
-            return record.nettingSetDetails == nsd && record.productClass == pc && record.riskType == rt &&
-                   record.qualifier == qualifier && record.bucket == bucket;
-        }));
+CrifRecordView Crif::filterByQualifierAndBucket(const NettingSetDetails& nsd, const CrifRecord::ProductClass pc,
+                                                const CrifRecord::RiskType rt, const std::string& qualifier,
+                                                const std::string& bucket) const {
+    std::vector<const CrifRecord*> records;
+    if (const IndexGroup* g = indexGroup(nsd, pc, rt)) {
+        if (auto q = g->byQualifier.find(qualifier); q != g->byQualifier.end()) {
+            for (const CrifRecord* r : q->second) {
+                if (r->bucket == bucket)
+                    records.push_back(r);
+            }
+        }
+    }
+    return CrifRecordView(std::move(records));
 }
 
-std::vector<CrifRecord> Crif::filterByQualifier(const NettingSetDetails& nsd, const CrifRecord::ProductClass pc,
-                                                const CrifRecord::RiskType rt, const std::string& qualifier) const {
-
-    return boost::copy_range<std::vector<CrifRecord>>(
-        records_ | boost::adaptors::filtered([&nsd, &pc, &rt, &qualifier](const CrifRecord& record) {
-            return record.nettingSetDetails == nsd && record.productClass == pc && record.riskType == rt &&
-                   record.qualifier == qualifier;
-        }));
+CrifRecordView Crif::filterByQualifier(const NettingSetDetails& nsd, const CrifRecord::ProductClass pc,
+                                       const CrifRecord::RiskType rt, const std::string& qualifier) const {
+    if (const IndexGroup* g = indexGroup(nsd, pc, rt)) {
+        if (auto q = g->byQualifier.find(qualifier); q != g->byQualifier.end())
+            return CrifRecordView(&q->second);
+    }
+    return CrifRecordView();
 }
 
-std::vector<CrifRecord> Crif::filterByBucket(const NettingSetDetails& nsd, const CrifRecord::ProductClass pc,
-                                             const CrifRecord::RiskType rt, const std::string& bucket) const {
-    return boost::copy_range<std::vector<CrifRecord>>(
-        records_ | boost::adaptors::filtered([&nsd, &pc, &rt, &bucket](const CrifRecord& record) {
-            return record.nettingSetDetails == nsd && record.productClass == pc && record.riskType == rt &&
-                   record.bucket == bucket;
-        }));
+CrifRecordView Crif::filterByBucket(const NettingSetDetails& nsd, const CrifRecord::ProductClass pc,
+                                    const CrifRecord::RiskType rt, const std::string& bucket) const {
+    if (const IndexGroup* g = indexGroup(nsd, pc, rt)) {
+        if (auto b = g->byBucket.find(bucket); b != g->byBucket.end())
+            return CrifRecordView(&b->second);
+    }
+    return CrifRecordView();
 }
 
-std::vector<CrifRecord> Crif::filterBy(const NettingSetDetails& nsd, const CrifRecord::ProductClass pc,
-                                       const CrifRecord::RiskType rt) const {
-    return boost::copy_range<std::vector<CrifRecord>>(
-        records_ | boost::adaptors::filtered([&nsd, &pc, &rt](const CrifRecord& record) {
-            return record.nettingSetDetails == nsd && record.productClass == pc && record.riskType == rt;
-        }));
+CrifRecordView Crif::filterBy(const NettingSetDetails& nsd, const CrifRecord::ProductClass pc,
+                              const CrifRecord::RiskType rt) const {
+    if (const IndexGroup* g = indexGroup(nsd, pc, rt))
+        return CrifRecordView(&g->records);
+    return CrifRecordView();
 }
 
 std::vector<CrifRecord> Crif::filterBy(const CrifRecord::RiskType rt) const {
@@ -289,7 +381,7 @@ std::set<std::string> Crif::tradeIds() const {
 //! deletes all existing simmParameter and replaces them with the new one
 void Crif::setSimmParameters(const Crif& crif) {
     auto backup = records_;
-    records_.clear();
+    clear();
     for (auto& r : backup) {
         if (!r.isSimmParameter()) {
             addRecord(r);
@@ -304,7 +396,7 @@ void Crif::setSimmParameters(const Crif& crif) {
 
 void Crif::setCrifRecords(const Crif& crif) {
     auto backup = records_;
-    records_.clear();
+    clear();
     for (auto& r : backup) {
         if (r.isSimmParameter()) {
             addRecord(r);
@@ -323,20 +415,21 @@ const std::set<NettingSetDetails>& Crif::nettingSetDetails() const { return nett
 
 std::set<CrifRecord::ProductClass> Crif::ProductClassesByNettingSetDetails(const NettingSetDetails nsd) const {
     std::set<CrifRecord::ProductClass> keys;
-    for (const auto& record : records_) {
-        if (record.nettingSetDetails == nsd) {
-            keys.insert(record.productClass);
-        }
+    const auto& idx = index();
+    if (auto n = idx.find(nsd); n != idx.end()) {
+        for (const auto& [k, _] : n->second)
+            keys.insert(k.first);
     }
     return keys;
 }
 
 size_t Crif::countMatching(const NettingSetDetails& nsd, const CrifRecord::ProductClass pc,
                            const CrifRecord::RiskType rt, const std::string& qualifier) const {
-    return std::count_if(records_.begin(), records_.end(), [&nsd, &pc, &rt, &qualifier](const CrifRecord& record) {
-        return record.nettingSetDetails == nsd && record.productClass == pc && record.riskType == rt &&
-               record.qualifier == qualifier;
-    });
+    if (const IndexGroup* g = indexGroup(nsd, pc, rt)) {
+        if (auto q = g->byQualifier.find(qualifier); q != g->byQualifier.end())
+            return q->second.size();
+    }
+    return 0;
 }
 
 bool Crif::hasNettingSetDetails() const {
@@ -375,6 +468,8 @@ void Crif::fillAmountUsd(const QuantLib::ext::shared_ptr<ore::data::Market> mark
         results.insert(cr);
     }
     records_ = results;
+    rebuildDiffAmountCurrenciesIndex();
+    invalidateIndex();
 }
 
 } // namespace analytics
@@ -25,6 +25,12 @@
 #include <ored/report/report.hpp>
 #include <ored/marketdata/market.hpp>
 
+#include <boost/iterator/indirect_iterator.hpp>
+
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+
 namespace ore {
 namespace analytics {
 
@@ -32,17 +38,48 @@ struct crifRecordIsSimmParameter {
     bool operator()(const CrifRecord& x) { return x.isSimmParameter(); }
 };
 
+//! Lightweight view on records of a Crif
+/*! The view refers to the records held by the Crif it was obtained from, it is valid as long as that Crif is alive
+    and not modified. The records are in the order of the Crif.
+*/
+class CrifRecordView {
+public:
+    typedef boost::indirect_iterator<std::vector<const CrifRecord*>::const_iterator> const_iterator;
+
+    CrifRecordView() = default;
+    //! view owning its list of records
+    explicit CrifRecordView(std::vector<const CrifRecord*> records) : owned_(std::move(records)) {}
+    //! view on a list of records held elsewhere, e.g. in the index of a Crif
+    explicit CrifRecordView(const std::vector<const CrifRecord*>* records) : records_(records) {}
+
+    const_iterator begin() const { return const_iterator(records().begin()); }
+    const_iterator end() const { return const_iterator(records().end()); }
+    std::size_t size() const { return records().size(); }
+    bool empty() const { return records().empty(); }
+    const CrifRecord& operator[](std::size_t i) const { return *records()[i]; }
+    const CrifRecord& front() const { return *records().front(); }
+
+private:
+    const std::vector<const CrifRecord*>& records() const { return records_ ? *records_ : owned_; }
+    std::vector<const CrifRecord*> owned_;
+    const std::vector<const CrifRecord*>* records_ = nullptr;
+};
+
 class Crif {
 public:
     enum class CrifType { Empty, Frtb, Simm };
     Crif() = default;
+    Crif(const Crif& other);
+    Crif(Crif&& other) noexcept;
+    Crif& operator=(const Crif& other);
+    Crif& operator=(Crif&& other) noexcept;
 
     CrifType type() const { return type_; }
 
     void addRecord(const CrifRecord& record, bool aggregateDifferentAmountCurrencies = false, bool sortFxVolQualifer = true);
     void addRecords(const Crif& crif, bool aggregateDifferentAmountCurrencies = false, bool sortFxVolQualfier = true);
 
-    void clear() { records_.clear(); }
+    void clear();
 
     std::set<CrifRecord>::const_iterator begin() const { return records_.cbegin(); }
     std::set<CrifRecord>::const_iterator end() const { return records_.cend(); }
@@ -97,18 +134,22 @@ public:
     std::set<std::string> qualifiersBy(const NettingSetDetails nsd, CrifRecord::ProductClass pc,
                                        const CrifRecord::RiskType rt) const;
 
-    std::vector<CrifRecord> filterByQualifierAndBucket(const NettingSetDetails& nsd, const CrifRecord::ProductClass pc,
-                                                       const CrifRecord::RiskType rt, const std::string& qualifier,
-                                                       const std::string& bucket) const;
-    
-    std::vector<CrifRecord> filterByQualifier(const NettingSetDetails& nsd, const CrifRecord::ProductClass pc,
-                                              const CrifRecord::RiskType rt, const std::string& qualifier) const;
+    /*! The filters by netting set details, product class and risk type (and qualifier or bucket) are served from
+        a hash index that is built on first use after the last modification of the Crif and return views on the
+        records
+    */
+    CrifRecordView filterByQualifierAndBucket(const NettingSetDetails& nsd, const CrifRecord::ProductClass pc,
+                                              const CrifRecord::RiskType rt, const std::string& qualifier,
+                                              const std::string& bucket) const;
 
-    std::vector<CrifRecord> filterByBucket(const NettingSetDetails& nsd, const CrifRecord::ProductClass pc,
-                                           const CrifRecord::RiskType rt, const std::string& bucket) const;
+    CrifRecordView filterByQualifier(const NettingSetDetails& nsd, const CrifRecord::ProductClass pc,
+                                     const CrifRecord::RiskType rt, const std::string& qualifier) const;
 
-    std::vector<CrifRecord> filterBy(const NettingSetDetails& nsd, const CrifRecord::ProductClass pc,
-                                     const CrifRecord::RiskType rt) const;
+    CrifRecordView filterByBucket(const NettingSetDetails& nsd, const CrifRecord::ProductClass pc,
+                                  const CrifRecord::RiskType rt, const std::string& bucket) const;
+
+    CrifRecordView filterBy(const NettingSetDetails& nsd, const CrifRecord::ProductClass pc,
+                            const CrifRecord::RiskType rt) const;
     std::vector<CrifRecord> filterBy(const CrifRecord::RiskType rt) const;
     std::vector<CrifRecord> filterByTradeId(const std::string& id) const;
     std::set<std::string> tradeIds() const;
@@ -122,10 +163,40 @@ private:
     void updateAmountExistingRecord(std::map<CrifRecord::SimmAmountCcyKey, const CrifRecord*>::iterator& it, const CrifRecord& record);
 
 
+    //! Records with the same netting set details, product class and risk type
+    struct IndexGroup {
+        std::vector<const CrifRecord*> records;
+        std::unordered_map<std::string, std::vector<const CrifRecord*>> byQualifier;
+        std::unordered_map<std::string, std::vector<const CrifRecord*>> byBucket;
+    };
+    struct IndexKeyHash {
+        std::size_t operator()(const std::pair<CrifRecord::ProductClass, CrifRecord::RiskType>& k) const {
+            return static_cast<std::size_t>(k.first) * 1024 + static_cast<std::size_t>(k.second);
+        }
+    };
+    typedef std::map<NettingSetDetails,
+                     std::unordered_map<std::pair<CrifRecord::ProductClass, CrifRecord::RiskType>, IndexGroup,
+                                        IndexKeyHash>>
+        Index;
+
+    //! Index by netting set details, product class and risk type, built on first use
+    const Index& index() const;
+    //! Index group for the given netting set details, product class and risk type, or nullptr if there is none
+    const IndexGroup* indexGroup(const NettingSetDetails& nsd, const CrifRecord::ProductClass pc,
+                                 const CrifRecord::RiskType rt) const;
+    //! Invalidates the index, to be called on each modification of the records
+    void invalidateIndex();
+    //! Rebuilds the pointers into the records after they were copied
+    void rebuildDiffAmountCurrenciesIndex();
+
     CrifType type_ = CrifType::Empty;
     std::set<CrifRecord> records_;
     std::map<CrifRecord::SimmAmountCcyKey, const CrifRecord*> diffAmountCurrenciesIndex_;
 
+    mutable Index index_;
+    mutable std::atomic<bool> indexed_{false};
+    mutable std::mutex indexMutex_;
+
     //SIMM members
     //! Set of portfolio IDs that have been loaded
     std::set<std::string> portfolioIds_;
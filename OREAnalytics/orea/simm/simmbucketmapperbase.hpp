@@ -28,6 +28,9 @@
 #include <ored/utilities/xmlutils.hpp>
 #include <ored/portfolio/referencedata.hpp>
 
+#include <boost/thread/lock_types.hpp>
+#include <boost/thread/shared_mutex.hpp>
+
 #include <map>
 #include <set>
 #include <string>
@@ -115,6 +118,9 @@ protected:
     std::set<CrifRecord::RiskType> rtWithBuckets_;
 
 private:
+    //! Bucket lookup without the cache
+    std::string lookupBucket(const CrifRecord::RiskType& riskType, const std::string& qualifier) const;
+
     mutable std::map<std::pair<CrifRecord::RiskType, std::string>, std::string> cache_;
 
     //! Reset the SIMM bucket mapper i.e. clears all mappings and adds the initial hard-coded commodity mappings
@@ -127,6 +133,9 @@ private:
     QuantLib::ext::shared_ptr<SimmBasicNameMapper> nameMapper_;
 
     mutable std::set<FailedMapping> failedMappings_;
+
+    //! Guards the cache and the failed mappings, so that buckets can be looked up from several threads
+    mutable boost::shared_mutex mutex_;
 };
 
 } // namespace analytics
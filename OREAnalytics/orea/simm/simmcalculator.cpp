@@ -23,13 +23,17 @@
 #include <orea/simm/simmconfigurationbase.hpp>
 
 #include <boost/math/distributions/normal.hpp>
+#include <atomic>
+#include <exception>
 #include <numeric>
+#include <thread>
 #include <ored/portfolio/structuredtradewarning.hpp>
 #include <ored/utilities/log.hpp>
 #include <ored/utilities/to_string.hpp>
 #include <ored/utilities/parsers.hpp>
 #include <ql/math/comparison.hpp>
 #include <ql/quote.hpp>
+#include <ql/settings.hpp>
 
 using std::abs;
 using std::accumulate;
@@ -50,6 +54,7 @@ using ore::data::to_string;
 using ore::data::parseBool;
 using QuantLib::close_enough;
 using QuantLib::Real;
+using QuantLib::Size;
 
 namespace ore {
 namespace analytics {
@@ -62,13 +67,64 @@ typedef CrifRecord::RiskType RiskType;
 typedef SimmConfiguration::Regulation Regulation;
 typedef SimmConfiguration::SimmSide SimmSide;
 
+namespace {
+
+// Sensitivities interned into their distinct risk factors (qualifier, label1, label2)
+struct RiskFactors {
+    std::vector<string> qualifiers, labels1, labels2;
+    // Risk factor id of each sensitivity
+    std::vector<QuantLib::Size> ids;
+    QuantLib::Size size() const { return qualifiers.size(); }
+};
+
+RiskFactors riskFactors(const CrifRecordView& records, const bool useLabel1 = true,
+                        const bool useLabel2 = true) {
+    RiskFactors result;
+    map<std::tuple<string, string, string>, QuantLib::Size> index;
+    result.ids.reserve(records.size());
+    for (const auto& r : records) {
+        auto key = make_tuple(r.qualifier, useLabel1 ? r.label1 : string(), useLabel2 ? r.label2 : string());
+        auto f = index.emplace(key, result.size());
+        if (f.second) {
+            result.qualifiers.push_back(std::get<0>(key));
+            result.labels1.push_back(std::get<1>(key));
+            result.labels2.push_back(std::get<2>(key));
+        }
+        result.ids.push_back(f.first->second);
+    }
+    return result;
+}
+
+/* Returns $\sum_k WS_k^2 + 2 \sum_{k<l} m_{f_k,f_l} WS_k WS_l$ for the weighted sensitivities $WS_k$ with risk factor
+   ids $f_k$ and a symmetric matrix $m$ on the risk factors. With $W_f$ and $S_f$ the sum of the weighted sensitivities
+   and of their squares by risk factor, this is computed as $\sum_f (1 - m_{f,f}) S_f + W^T m W$. */
+Real aggregateWeightedSensis(const std::vector<Real>& ws, const std::vector<QuantLib::Size>& ids,
+                             const QuantLib::Matrix& m) {
+    QuantLib::Size n = m.rows();
+    std::vector<Real> w(n, 0.0), s(n, 0.0);
+    for (QuantLib::Size k = 0; k < ws.size(); ++k) {
+        w[ids[k]] += ws[k];
+        s[ids[k]] += ws[k] * ws[k];
+    }
+    Real result = 0.0;
+    for (QuantLib::Size f = 0; f < n; ++f) {
+        Real mw = 0.0;
+        for (QuantLib::Size g = 0; g < n; ++g)
+            mw += m[f][g] * w[g];
+        result += (1.0 - m[f][f]) * s[f] + w[f] * mw;
+    }
+    return result;
+}
+
+} // namespace
+
 SimmCalculator::SimmCalculator(const ore::analytics::Crif& crif,
                                const QuantLib::ext::shared_ptr<SimmConfiguration>& simmConfiguration,
                                const string& calculationCcyCall, const string& calculationCcyPost,
                                const string& resultCcy, const QuantLib::ext::shared_ptr<Market> market,
                                const bool determineWinningRegulations, const bool enforceIMRegulations,
                                const bool quiet, const map<SimmSide, set<NettingSetDetails>>& hasSEC,
-                               const map<SimmSide, set<NettingSetDetails>>& hasCFTC)
+                               const map<SimmSide, set<NettingSetDetails>>& hasCFTC, const Size nThreads)
     : simmConfiguration_(simmConfiguration), calculationCcyCall_(calculationCcyCall),
       calculationCcyPost_(calculationCcyPost), resultCcy_(resultCcy.empty() ? calculationCcyCall_ : resultCcy),
       market_(market), quiet_(quiet), hasSEC_(hasSEC), hasCFTC_(hasCFTC) {
@@ -80,6 +136,11 @@ SimmCalculator::SimmCalculator(const ore::analytics::Crif& crif,
     QL_REQUIRE(checkCurrency(resultCcy_),
                "SIMM Calculator: The result currency (" << resultCcy_ << ") must be a valid ISO currency code");
 
+    // The FX rate used to convert the concentration thresholds, read once so that the margin calculations do not
+    // access the market
+    if (resultCcy_ != "USD" && market_)
+        usdToResultCcy_ = market_->fxRate("USD" + resultCcy_)->value();
+
     for (const CrifRecord& cr : crif) {
         // Remove empty
         if (cr.riskType == CrifRecord::RiskType::Empty) {
@@ -185,10 +246,16 @@ SimmCalculator::SimmCalculator(const ore::analytics::Crif& crif,
         }
     }
 
-    // Calculate SIMM call and post for each regulation under each netting set
+    // Collect the side-nettingSet-regulation combinations to calculate SIMM for
+    struct Task {
+        SimmSide side;
+        const NettingSetDetails* nsd;
+        const string* regulation;
+        const Crif* crif;
+    };
+    std::vector<Task> tasks;
     for (const auto& [side, nettingSetRegulationCrifMap] : regSensitivities_) {
         for (const auto& [nsd, regulationCrifMap] : nettingSetRegulationCrifMap) {
-            // Calculate SIMM for particular side-nettingSet-regulation combination
             for (const auto& [regulation, crif] : regulationCrifMap) {
                 bool hasFixedAddOn = false;
                 for (const auto& sp : crif) {
@@ -198,11 +265,70 @@ SimmCalculator::SimmCalculator(const ore::analytics::Crif& crif,
                     }
                 }
                 if (crif.hasCrifRecords() || hasFixedAddOn)
-                    calculateRegulationSimm(crif, nsd, regulation, side);
+                    tasks.push_back({side, &nsd, &regulation, &crif});
             }
         }
     }
 
+    // Calculate SIMM call and post for each regulation under each netting set
+    Size nWorkers = std::min<Size>(nThreads, tasks.size());
+#ifndef QL_ENABLE_SESSIONS
+    // the workers set the evaluation date, which is only safe if the singletons are thread local
+    if (nWorkers > 1) {
+        WLOG("SimmCalculator: calculating SIMM on " << nWorkers
+                                                    << " threads requires a QuantLib build with QL_ENABLE_SESSIONS, "
+                                                       "the SIMM is calculated on one thread.");
+        nWorkers = 1;
+    }
+#endif
+    if (nWorkers <= 1) {
+        SimmConfiguration::CorrelationCache cache;
+        for (const auto& t : tasks) {
+            calculateRegulationSimm(*t.crif, *t.nsd, *t.regulation, t.side,
+                                    simmResults_[t.side][*t.nsd][*t.regulation], simmParameters_, cache);
+        }
+    } else {
+        // The combinations are independent. Each one is calculated into its own results and SIMM parameters, these
+        // are merged in the order of the serial calculation afterwards, so that the results are identical.
+        if (!quiet_) {
+            LOG("SimmCalculator: Calculating SIMM for " << tasks.size() << " side, netting set and regulation "
+                                                        << "combinations on " << nWorkers << " threads");
+        }
+        std::vector<SimmResults> taskResults(tasks.size());
+        std::vector<Crif> taskSimmParameters(tasks.size());
+        std::vector<std::exception_ptr> errors(nWorkers);
+        std::atomic<Size> nextTask(0);
+        QuantLib::Date today = QuantLib::Settings::instance().evaluationDate();
+        std::vector<std::thread> workers;
+        for (Size w = 0; w < nWorkers; ++w) {
+            workers.emplace_back([this, w, today, &tasks, &taskResults, &taskSimmParameters, &errors, &nextTask]() {
+                try {
+                    // set thread local singletons
+                    QuantLib::Settings::instance().evaluationDate() = today;
+                    SimmConfiguration::CorrelationCache cache;
+                    for (Size i = nextTask++; i < tasks.size(); i = nextTask++) {
+                        calculateRegulationSimm(*tasks[i].crif, *tasks[i].nsd, *tasks[i].regulation, tasks[i].side,
+                                                taskResults[i], taskSimmParameters[i], cache);
+                    }
+                } catch (...) {
+                    errors[w] = std::current_exception();
+                    nextTask = tasks.size();
+                }
+            });
+        }
+        for (auto& t : workers)
+            t.join();
+        for (const auto& e : errors) {
+            if (e)
+                std::rethrow_exception(e);
+        }
+        for (Size i = 0; i < tasks.size(); ++i) {
+            simmResults_[tasks[i].side][*tasks[i].nsd][*tasks[i].regulation] = std::move(taskResults[i]);
+            for (const auto& r : taskSimmParameters[i])
+                simmParameters_.addRecord(r);
+        }
+    }
+
     // Determine winning call and post regulations
     if (determineWinningRegulations) {
         if (!quiet_) {
@@ -251,6 +377,14 @@ SimmCalculator::SimmCalculator(const ore::analytics::Crif& crif,
 const void SimmCalculator::calculateRegulationSimm(const Crif& crif,
                                                    const NettingSetDetails& nettingSetDetails, const string& regulation,
                                                    const SimmSide& side) {
+    SimmConfiguration::CorrelationCache cache;
+    calculateRegulationSimm(crif, nettingSetDetails, regulation, side, simmResults_[side][nettingSetDetails][regulation],
+                            simmParameters_, cache);
+}
+
+void SimmCalculator::calculateRegulationSimm(const Crif& crif, const NettingSetDetails& nettingSetDetails,
+                                             const string& regulation, const SimmSide& side, SimmResults& results,
+                                             Crif& simmParameters, SimmConfiguration::CorrelationCache& cache) const {
 
     if (!quiet_) {
         LOG("SimmCalculator: Calculating SIMM " << side << " for portfolio [" << nettingSetDetails << "], regulation "
@@ -265,115 +399,115 @@ const void SimmCalculator::calculateRegulationSimm(const Crif& crif,
         // Delta margin components
         RiskClass rc = RiskClass::InterestRate;
         MarginType mt = MarginType::Delta;
-        auto p = irDeltaMargin(nettingSetDetails, productClass, crif, side);
+        auto p = irDeltaMargin(nettingSetDetails, productClass, crif, side, cache);
         if (p.second)
-            add(nettingSetDetails, regulation, productClass, rc, mt, p.first, side);
+            add(results, nettingSetDetails, productClass, rc, mt, p.first, side);
 
         rc = RiskClass::FX;
-        p = margin(nettingSetDetails, productClass, RiskType::FX, crif, side);
+        p = margin(nettingSetDetails, productClass, RiskType::FX, crif, side, cache);
         if (p.second)
-            add(nettingSetDetails, regulation, productClass, rc, mt, p.first, side);
+            add(results, nettingSetDetails, productClass, rc, mt, p.first, side);
 
         rc = RiskClass::CreditQualifying;
-        p = margin(nettingSetDetails, productClass, RiskType::CreditQ, crif, side);
+        p = margin(nettingSetDetails, productClass, RiskType::CreditQ, crif, side, cache);
         if (p.second)
-            add(nettingSetDetails, regulation, productClass, rc, mt, p.first, side);
+            add(results, nettingSetDetails, productClass, rc, mt, p.first, side);
 
         rc = RiskClass::CreditNonQualifying;
-        p = margin(nettingSetDetails, productClass, RiskType::CreditNonQ, crif, side);
+        p = margin(nettingSetDetails, productClass, RiskType::CreditNonQ, crif, side, cache);
         if (p.second)
-            add(nettingSetDetails, regulation, productClass, rc, mt, p.first, side);
+            add(results, nettingSetDetails, productClass, rc, mt, p.first, side);
 
         rc = RiskClass::Equity;
-        p = margin(nettingSetDetails, productClass, RiskType::Equity, crif, side);
+        p = margin(nettingSetDetails, productClass, RiskType::Equity, crif, side, cache);
         if (p.second)
-            add(nettingSetDetails, regulation, productClass, rc, mt, p.first, side);
+            add(results, nettingSetDetails, productClass, rc, mt, p.first, side);
 
         rc = RiskClass::Commodity;
-        p = margin(nettingSetDetails, productClass, RiskType::Commodity, crif, side);
+        p = margin(nettingSetDetails, productClass, RiskType::Commodity, crif, side, cache);
         if (p.second)
-            add(nettingSetDetails, regulation, productClass, rc, mt, p.first, side);
+            add(results, nettingSetDetails, productClass, rc, mt, p.first, side);
 
         // Vega margin components
         mt = MarginType::Vega;
         rc = RiskClass::InterestRate;
-        p = irVegaMargin(nettingSetDetails, productClass, crif, side);
+        p = irVegaMargin(nettingSetDetails, productClass, crif, side, cache);
         if (p.second)
-            add(nettingSetDetails, regulation, productClass, rc, mt, p.first, side);
+            add(results, nettingSetDetails, productClass, rc, mt, p.first, side);
 
         rc = RiskClass::FX;
-        p = margin(nettingSetDetails, productClass, RiskType::FXVol, crif, side);
+        p = margin(nettingSetDetails, productClass, RiskType::FXVol, crif, side, cache);
         if (p.second)
-            add(nettingSetDetails, regulation, productClass, rc, mt, p.first, side);
+            add(results, nettingSetDetails, productClass, rc, mt, p.first, side);
 
         rc = RiskClass::CreditQualifying;
-        p = margin(nettingSetDetails, productClass, RiskType::CreditVol, crif, side);
+        p = margin(nettingSetDetails, productClass, RiskType::CreditVol, crif, side, cache);
         if (p.second)
-            add(nettingSetDetails, regulation, productClass, rc, mt, p.first, side);
+            add(results, nettingSetDetails, productClass, rc, mt, p.first, side);
 
         rc = RiskClass::CreditNonQualifying;
-        p = margin(nettingSetDetails, productClass, RiskType::CreditVolNonQ, crif, side);
+        p = margin(nettingSetDetails, productClass, RiskType::CreditVolNonQ, crif, side, cache);
         if (p.second)
-            add(nettingSetDetails, regulation, productClass, rc, mt, p.first, side);
+            add(results, nettingSetDetails, productClass, rc, mt, p.first, side);
 
         rc = RiskClass::Equity;
-        p = margin(nettingSetDetails, productClass, RiskType::EquityVol, crif, side);
+        p = margin(nettingSetDetails, productClass, RiskType::EquityVol, crif, side, cache);
         if (p.second)
-            add(nettingSetDetails, regulation, productClass, rc, mt, p.first, side);
+            add(results, nettingSetDetails, productClass, rc, mt, p.first, side);
 
         rc = RiskClass::Commodity;
-        p = margin(nettingSetDetails, productClass, RiskType::CommodityVol, crif, side);
+        p = margin(nettingSetDetails, productClass, RiskType::CommodityVol, crif, side, cache);
         if (p.second)
-            add(nettingSetDetails, regulation, productClass, rc, mt, p.first, side);
+            add(results, nettingSetDetails, productClass, rc, mt, p.first, side);
 
         // Curvature margin components for sides call and post
         mt = MarginType::Curvature;
         rc = RiskClass::InterestRate;
 
-        p = irCurvatureMargin(nettingSetDetails, productClass, side, crif);
+        p = irCurvatureMargin(nettingSetDetails, productClass, side, crif, cache);
         if (p.second)
-            add(nettingSetDetails, regulation, productClass, rc, mt, p.first, side);
+            add(results, nettingSetDetails, productClass, rc, mt, p.first, side);
 
         rc = RiskClass::FX;
-        p = curvatureMargin(nettingSetDetails, productClass, RiskType::FXVol, side, crif, false);
+        p = curvatureMargin(nettingSetDetails, productClass, RiskType::FXVol, side, crif, cache, false);
         if (p.second)
-            add(nettingSetDetails, regulation, productClass, rc, mt, p.first, side);
+            add(results, nettingSetDetails, productClass, rc, mt, p.first, side);
 
         rc = RiskClass::CreditQualifying;
-        p = curvatureMargin(nettingSetDetails, productClass, RiskType::CreditVol, side, crif);
+        p = curvatureMargin(nettingSetDetails, productClass, RiskType::CreditVol, side, crif, cache);
         if (p.second)
-            add(nettingSetDetails, regulation, productClass, rc, mt, p.first, side);
+            add(results, nettingSetDetails, productClass, rc, mt, p.first, side);
 
         rc = RiskClass::CreditNonQualifying;
-        p = curvatureMargin(nettingSetDetails, productClass, RiskType::CreditVolNonQ, side, crif);
+        p = curvatureMargin(nettingSetDetails, productClass, RiskType::CreditVolNonQ, side, crif, cache);
         if (p.second)
-            add(nettingSetDetails, regulation, productClass, rc, mt, p.first, side);
+            add(results, nettingSetDetails, productClass, rc, mt, p.first, side);
 
         rc = RiskClass::Equity;
-        p = curvatureMargin(nettingSetDetails, productClass, RiskType::EquityVol, side, crif, false);
+        p = curvatureMargin(nettingSetDetails, productClass, RiskType::EquityVol, side, crif, cache, false);
         if (p.second)
-            add(nettingSetDetails, regulation, productClass, rc, mt, p.first, side);
+            add(results, nettingSetDetails, productClass, rc, mt, p.first, side);
 
         rc = RiskClass::Commodity;
-        p = curvatureMargin(nettingSetDetails, productClass, RiskType::CommodityVol, side, crif, false);
+        p = curvatureMargin(nettingSetDetails, productClass, RiskType::CommodityVol, side, crif, cache, false);
         if (p.second)
-            add(nettingSetDetails, regulation, productClass, rc, mt, p.first, side);
+            add(results, nettingSetDetails, productClass, rc, mt, p.first, side);
 
         // Base correlation margin components. This risk type came later so need to check
         // first if it is valid under the configuration
         if (simmConfiguration_->isValidRiskType(RiskType::BaseCorr)) {
-            p = margin(nettingSetDetails, productClass, RiskType::BaseCorr, crif, side);
+            p = margin(nettingSetDetails, productClass, RiskType::BaseCorr, crif, side, cache);
             if (p.second)
-                add(nettingSetDetails, regulation, productClass, RiskClass::CreditQualifying, MarginType::BaseCorr,
+                add(results, nettingSetDetails, productClass, RiskClass::CreditQualifying, MarginType::BaseCorr,
                     p.first, side);
         }
     }
 
     // Calculate the higher level margins
-    populateResults(side, nettingSetDetails, regulation);
+    populateResults(results, side, nettingSetDetails);
 
     // For each portfolio, calculate the additional margin
-    calcAddMargin(side, nettingSetDetails, regulation, crif);
+    calcAddMargin(results, simmParameters, side, nettingSetDetails, regulation, crif);
 }
 
 const string& SimmCalculator::winningRegulations(const SimmSide& side, const NettingSetDetails& nettingSetDetails) const {
@@ -443,8 +577,8 @@ const map<SimmSide, map<NettingSetDetails, pair<string, SimmResults>>>& SimmCalc
 
 pair<map<string, Real>, bool> SimmCalculator::irDeltaMargin(const NettingSetDetails& nettingSetDetails,
                                                             const ProductClass& pc, const Crif& crif,
-                                                            const SimmSide& side) const {
-    const string& calcCcy = side == SimmSide::Call ? calculationCcyCall_ : calculationCcyPost_;
+                                                            const SimmSide& side,
+                                                            SimmConfiguration::CorrelationCache& cache) const {
 
     // "Bucket" here referse to exposures under the CRIF qualifiers
     map<string, Real> bucketMargins;
@@ -500,35 +634,36 @@ pair<map<string, Real>, bool> SimmCalculator::irDeltaMargin(const NettingSetDeta
         // Divide by the concentration risk threshold
         Real concThreshold = simmConfiguration_->concentrationThreshold(RiskType::IRCurve, qualifier);
         if (resultCcy_ != "USD")
-            concThreshold *= market_->fxRate("USD" + resultCcy_)->value();
+            concThreshold *= usdToResultCcy();
         concentrationRisk[qualifier] /= concThreshold;
         // Final concentration risk amount
         concentrationRisk[qualifier] = max(1.0, sqrt(std::abs(concentrationRisk[qualifier])));
 
         // Calculate the delta margin piece for this qualifier i.e. $K_b$ from SIMM docs
-        for (auto itOuter = pIrQualifier.begin(); itOuter != pIrQualifier.end(); ++itOuter) {
-            // Risk weight i.e. $RW_k$ from SIMM docs
-            Real rwOuter = simmConfiguration_->weight(RiskType::IRCurve, qualifier, itOuter->label1);
-            // Weighted sensitivity i.e. $WS_{k,i}$ from SIMM docs
-            Real wsOuter = rwOuter * itOuter->amountResultCcy * concentrationRisk[qualifier];
+        // Risk factors (Label1, Label2) of the IRCurve sensitivities, the risk weight i.e. $RW_k$ from SIMM docs only
+        // depends on Label1
+        RiskFactors factors = riskFactors(pIrQualifier);
+        std::vector<Real> rw(factors.size());
+        for (QuantLib::Size f = 0; f < factors.size(); ++f)
+            rw[f] = simmConfiguration_->weight(RiskType::IRCurve, qualifier, factors.labels1[f]);
+        // Weighted sensitivities i.e. $WS_{k,i}$ from SIMM docs
+        std::vector<Real> ws(pIrQualifier.size());
+        for (QuantLib::Size k = 0; k < pIrQualifier.size(); ++k) {
+            ws[k] = rw[factors.ids[k]] * pIrQualifier[k].amountResultCcy * concentrationRisk[qualifier];
             // Update weighted sensitivity sum
-            sumWeightedSensis[qualifier] += wsOuter;
-            // Add diagonal element to delta margin
-            deltaMargin[qualifier] += wsOuter * wsOuter;
-            // Add the cross elements to the delta margin
-            for (auto itInner = pIrQualifier.begin(); itInner != itOuter; ++itInner) {
-                // Label2 level correlation i.e. $\phi_{i,j}$ from SIMM docs
-                Real subCurveCorr = simmConfiguration_->correlation(RiskType::IRCurve, qualifier, "", itOuter->label2,
-                                                                    RiskType::IRCurve, qualifier, "", itInner->label2);
-                // Label1 level correlation i.e. $\rho_{k,l}$ from SIMM docs
-                Real tenorCorr = simmConfiguration_->correlation(RiskType::IRCurve, qualifier, itOuter->label1, "",
-                                                                 RiskType::IRCurve, qualifier, itInner->label1, "");
-                // Add cross element to delta margin
-                Real rwInner = simmConfiguration_->weight(RiskType::IRCurve, qualifier, itInner->label1);
-                Real wsInner = rwInner * itInner->amountResultCcy * concentrationRisk[qualifier];
-                deltaMargin[qualifier] += 2 * subCurveCorr * tenorCorr * wsOuter * wsInner;
-            }
+            sumWeightedSensis[qualifier] += ws[k];
         }
+        // Label2 level correlation i.e. $\phi_{i,j}$ times Label1 level correlation i.e. $\rho_{k,l}$ from SIMM docs
+        std::vector<string> empty(factors.size()), sameQualifier(factors.size(), qualifier);
+        QuantLib::Matrix correlations =
+            simmConfiguration_->correlationMatrix(RiskType::IRCurve, sameQualifier, empty, factors.labels2, "", &cache);
+        QuantLib::Matrix tenorCorr =
+            simmConfiguration_->correlationMatrix(RiskType::IRCurve, sameQualifier, factors.labels1, empty, "", &cache);
+        for (QuantLib::Size f = 0; f < factors.size(); ++f)
+            for (QuantLib::Size g = 0; g < factors.size(); ++g)
+                correlations[f][g] *= tenorCorr[f][g];
+        // Diagonal and cross elements of the delta margin
+        deltaMargin[qualifier] += aggregateWeightedSensis(ws, factors.ids, correlations);
 
         // Add the Inflation component, if any
         Real wsInflation = 0.0;
@@ -545,11 +680,9 @@ pair<map<string, Real>, bool> SimmCalculator::irDeltaMargin(const NettingSetDeta
             // Correlation (know that Label1 and Label2 do not matter)
             Real corr = simmConfiguration_->correlation(RiskType::IRCurve, qualifier, "", "", RiskType::Inflation,
                                                         qualifier, "", "");
-            for (auto it = pIrQualifier.begin(); it != pIrQualifier.end(); ++it) {
+            for (QuantLib::Size k = 0; k < ws.size(); ++k) {
                 // Add cross element to delta margin
-                Real rw = simmConfiguration_->weight(RiskType::IRCurve, qualifier, it->label1);
-                Real ws = rw * it->amountResultCcy * concentrationRisk[qualifier];
-                deltaMargin[qualifier] += 2 * corr * ws * wsInflation;
+                deltaMargin[qualifier] += 2 * corr * ws[k] * wsInflation;
             }
         }
 
@@ -567,11 +700,9 @@ pair<map<string, Real>, bool> SimmCalculator::irDeltaMargin(const NettingSetDeta
             // Correlation (know that Label1 and Label2 do not matter)
             Real corr = simmConfiguration_->correlation(RiskType::IRCurve, qualifier, "", "", RiskType::XCcyBasis,
                                                         qualifier, "", "");
-            for (auto it = pIrQualifier.begin(); it != pIrQualifier.end(); ++it) {
+            for (QuantLib::Size k = 0; k < ws.size(); ++k) {
                 // Add cross element to delta margin
-                Real rw = simmConfiguration_->weight(RiskType::IRCurve, qualifier, it->label1, calcCcy);
-                Real ws = rw * it->amountResultCcy * concentrationRisk[qualifier];
-                deltaMargin[qualifier] += 2 * corr * ws * wsXccy;
+                deltaMargin[qualifier] += 2 * corr * ws[k] * wsXccy;
             }
 
             // Inflation vs. XccyBasis cross component if any
@@ -614,7 +745,8 @@ pair<map<string, Real>, bool> SimmCalculator::irDeltaMargin(const NettingSetDeta
 
 pair<map<string, Real>, bool> SimmCalculator::irVegaMargin(const NettingSetDetails& nettingSetDetails,
                                                            const CrifRecord::ProductClass& pc, const Crif& crif,
-                                                           const SimmSide& side) const {
+                                                           const SimmSide& side,
+                                                           SimmConfiguration::CorrelationCache& cache) const {
 
     const string& calcCcy = side == SimmSide::Call ? calculationCcyCall_ : calculationCcyPost_;
 
@@ -655,34 +787,31 @@ pair<map<string, Real>, bool> SimmCalculator::irVegaMargin(const NettingSetDetai
         // Divide by the concentration risk threshold
         Real concThreshold = simmConfiguration_->concentrationThreshold(RiskType::IRVol, qualifier);
         if (resultCcy_ != "USD")
-            concThreshold *= market_->fxRate("USD" + resultCcy_)->value();
+            concThreshold *= usdToResultCcy();
         concentrationRisk[qualifier] /= concThreshold;
 
         // Final concentration risk amount
         concentrationRisk[qualifier] = max(1.0, sqrt(std::abs(concentrationRisk[qualifier])));
 
         // Calculate the margin piece for this qualifier i.e. $K_b$ from SIMM docs
-        // Start with IRVol vs. IRVol components
-        for (auto itOuter = pIrQualifier.begin(); itOuter != pIrQualifier.end(); ++itOuter) {
-            // Risk weight i.e. $RW_k$ from SIMM docs
-            Real rwOuter = simmConfiguration_->weight(RiskType::IRVol, qualifier, itOuter->label1);
-            // Weighted sensitivity i.e. $WS_{k,i}$ from SIMM docs
-            Real wsOuter = rwOuter * itOuter->amountResultCcy * concentrationRisk[qualifier];
+        // Start with IRVol vs. IRVol components, the risk weight i.e. $RW_k$ from SIMM docs and the correlation only
+        // depend on Label1
+        RiskFactors factors = riskFactors(pIrQualifier, true, false);
+        std::vector<Real> rw(factors.size());
+        for (QuantLib::Size f = 0; f < factors.size(); ++f)
+            rw[f] = simmConfiguration_->weight(RiskType::IRVol, qualifier, factors.labels1[f]);
+        // Weighted sensitivities i.e. $WS_{k,i}$ from SIMM docs
+        std::vector<Real> ws(pIrQualifier.size());
+        for (QuantLib::Size k = 0; k < pIrQualifier.size(); ++k) {
+            ws[k] = rw[factors.ids[k]] * pIrQualifier[k].amountResultCcy * concentrationRisk[qualifier];
             // Update weighted sensitivity sum
-            sumWeightedSensis[qualifier] += wsOuter;
-            // Add diagonal element to vega margin
-            vegaMargin[qualifier] += wsOuter * wsOuter;
-            // Add the cross elements to the vega margin
-            for (auto itInner = pIrQualifier.begin(); itInner != itOuter; ++itInner) {
-                // Label1 level correlation i.e. $\rho_{k,l}$ from SIMM docs
-                Real corr = simmConfiguration_->correlation(RiskType::IRVol, qualifier, itOuter->label1, "",
-                                                            RiskType::IRVol, qualifier, itInner->label1, "");
-                // Add cross element to vega margin
-                Real rwInner = simmConfiguration_->weight(RiskType::IRVol, qualifier, itInner->label1);
-                Real wsInner = rwInner * itInner->amountResultCcy * concentrationRisk[qualifier];
-                vegaMargin[qualifier] += 2 * corr * wsOuter * wsInner;
-            }
+            sumWeightedSensis[qualifier] += ws[k];
         }
+        // Label1 level correlation i.e. $\rho_{k,l}$ from SIMM docs
+        QuantLib::Matrix correlations = simmConfiguration_->correlationMatrix(
+            RiskType::IRVol, factors.qualifiers, factors.labels1, factors.labels2, "", &cache);
+        // Diagonal and cross elements of the vega margin
+        vegaMargin[qualifier] += aggregateWeightedSensis(ws, factors.ids, correlations);
 
         // Now deal with inflation component
         // To be generic/future-proof, assume that we don't know correlation structure. The way SIMM is
@@ -698,14 +827,12 @@ pair<map<string, Real>, bool> SimmCalculator::irVegaMargin(const NettingSetDetai
             vegaMargin[qualifier] += wsOuter * wsOuter;
             // Add the cross elements to the vega margin
             // Firstly, against all IRVol components
-            for (auto itInner = pIrQualifier.begin(); itInner != pIrQualifier.end(); ++itInner) {
+            for (QuantLib::Size k = 0; k < pIrQualifier.size(); ++k) {
                 // Correlation i.e. $\rho_{k,l}$ from SIMM docs
                 Real corr = simmConfiguration_->correlation(RiskType::InflationVol, qualifier, itOuter->label1, "",
-                                                            RiskType::IRVol, qualifier, itInner->label1, "");
+                                                            RiskType::IRVol, qualifier, pIrQualifier[k].label1, "");
                 // Add cross element to vega margin
-                Real rwInner = simmConfiguration_->weight(RiskType::IRVol, qualifier, itInner->label1);
-                Real wsInner = rwInner * itInner->amountResultCcy * concentrationRisk[qualifier];
-                vegaMargin[qualifier] += 2 * corr * wsOuter * wsInner;
+                vegaMargin[qualifier] += 2 * corr * wsOuter * ws[k];
             }
             // Secondly, against all previous InflationVol components
             for (auto itInner = pInfQualifier.begin(); itInner != itOuter; ++itInner) {
@@ -750,7 +877,8 @@ pair<map<string, Real>, bool> SimmCalculator::irVegaMargin(const NettingSetDetai
 
 pair<map<string, Real>, bool> SimmCalculator::irCurvatureMargin(const NettingSetDetails& nettingSetDetails,
                                                                 const CrifRecord::ProductClass& pc,
-                                                                const SimmSide& side, const Crif& crif) const {
+                                                                const SimmSide& side, const Crif& crif,
+                                                                SimmConfiguration::CorrelationCache& cache) const {
 
     // "Bucket" here refers to exposures under the CRIF qualifiers
     map<string, Real> bucketMargins;
@@ -786,29 +914,29 @@ pair<map<string, Real>, bool> SimmCalculator::irCurvatureMargin(const NettingSet
             crif.filterByQualifier(nettingSetDetails, pc, RiskType::InflationVol, qualifier);
 
         // Calculate the margin piece for this qualifier i.e. $K_b$ from SIMM docs
-        // Start with IRVol vs. IRVol components
-        for (auto itOuter = pIrQualifier.begin(); itOuter != pIrQualifier.end(); ++itOuter) {
-            // Curvature weight i.e. $SF(t_{kj})$ from SIMM docs
-            Real sfOuter = simmConfiguration_->curvatureWeight(RiskType::IRVol, itOuter->label1);
-            // Curvature sensitivity i.e. $CVR_{ik}$ from SIMM docs
-            Real wsOuter = sfOuter * (itOuter->amountResultCcy * multiplier);
+        // Start with IRVol vs. IRVol components, the curvature weight i.e. $SF(t_{kj})$ from SIMM docs and the
+        // correlation only depend on Label1
+        RiskFactors factors = riskFactors(pIrQualifier, true, false);
+        std::vector<Real> sf(factors.size());
+        for (QuantLib::Size f = 0; f < factors.size(); ++f)
+            sf[f] = simmConfiguration_->curvatureWeight(RiskType::IRVol, factors.labels1[f]);
+        // Curvature sensitivities i.e. $CVR_{ik}$ from SIMM docs
+        std::vector<Real> ws(pIrQualifier.size());
+        for (QuantLib::Size k = 0; k < pIrQualifier.size(); ++k) {
+            ws[k] = sf[factors.ids[k]] * (pIrQualifier[k].amountResultCcy * multiplier);
             // Update weighted sensitivity sums
-            sumWeightedSensis[qualifier] += wsOuter;
-            sumWs += wsOuter;
-            sumAbsWs += std::abs(wsOuter);
-            // Add diagonal element to curvature margin
-            curvatureMargin[qualifier] += wsOuter * wsOuter;
-            // Add the cross elements to the curvature margin
-            for (auto itInner = pIrQualifier.begin(); itInner != itOuter; ++itInner) {
-                // Label1 level correlation i.e. $\rho_{k,l}$ from SIMM docs
-                Real corr = simmConfiguration_->correlation(RiskType::IRVol, qualifier, itOuter->label1, "",
-                                                            RiskType::IRVol, qualifier, itInner->label1, "");
-                // Add cross element to curvature margin
-                Real sfInner = simmConfiguration_->curvatureWeight(RiskType::IRVol, itInner->label1);
-                Real wsInner = sfInner * (itInner->amountResultCcy * multiplier);
-                curvatureMargin[qualifier] += 2 * corr * corr * wsOuter * wsInner;
-            }
+            sumWeightedSensis[qualifier] += ws[k];
+            sumWs += ws[k];
+            sumAbsWs += std::abs(ws[k]);
         }
+        // Squared Label1 level correlation i.e. $\rho_{k,l}^2$ from SIMM docs
+        QuantLib::Matrix correlations = simmConfiguration_->correlationMatrix(
+            RiskType::IRVol, factors.qualifiers, factors.labels1, factors.labels2, "", &cache);
+        for (QuantLib::Size f = 0; f < factors.size(); ++f)
+            for (QuantLib::Size g = 0; g < factors.size(); ++g)
+                correlations[f][g] *= correlations[f][g];
+        // Diagonal and cross elements of the curvature margin
+        curvatureMargin[qualifier] += aggregateWeightedSensis(ws, factors.ids, correlations);
 
         // Now deal with inflation component
         const string simmVersion = simmConfiguration_->version();
@@ -831,14 +959,12 @@ pair<map<string, Real>, bool> SimmCalculator::irCurvatureMargin(const NettingSet
 
             // Add the cross elements to the curvature margin against IRVol components.
             // There are no cross elements against InflationVol since we only have one element.
-            for (auto irIt = pIrQualifier.begin(); irIt != pIrQualifier.end(); ++irIt) {
+            for (QuantLib::Size k = 0; k < pIrQualifier.size(); ++k) {
                 // Correlation i.e. $\rho_{k,l}$ from SIMM docs
                 Real corr = simmConfiguration_->correlation(RiskType::InflationVol, qualifier, "", "", RiskType::IRVol,
-                                                            qualifier, irIt->label1, "");
+                                                            qualifier, pIrQualifier[k].label1, "");
                 // Add cross element to curvature margin
-                Real irSf = simmConfiguration_->curvatureWeight(RiskType::IRVol, irIt->label1);
-                Real irWs = irSf * (irIt->amountResultCcy * multiplier);
-                curvatureMargin[qualifier] += 2 * corr * corr * infWs * irWs;
+                curvatureMargin[qualifier] += 2 * corr * corr * infWs * ws[k];
             }
         }
 
@@ -884,7 +1010,8 @@ pair<map<string, Real>, bool> SimmCalculator::irCurvatureMargin(const NettingSet
 }
 
 pair<map<string, Real>, bool> SimmCalculator::margin(const NettingSetDetails& nettingSetDetails, const ProductClass& pc,
-                                                     const RiskType& rt, const Crif& crif, const SimmSide& side) const {
+                                                     const RiskType& rt, const Crif& crif, const SimmSide& side,
+                                                     SimmConfiguration::CorrelationCache& cache) const {
 
     const string& calcCcy = side == SimmSide::Call ? calculationCcyCall_ : calculationCcyPost_;
     
@@ -898,15 +1025,13 @@ pair<map<string, Real>, bool> SimmCalculator::margin(const NettingSetDetails& ne
     bool riskClassIsFX = rt == RiskType::FX || rt == RiskType::FXVol;
 
     // precomputed
-    map<std::pair<std::string,std::string>, std::vector<CrifRecord>> crifByQualifierAndBucket;
-    map<std::string, std::vector<CrifRecord>> crifByBucket;
+    map<std::string, std::vector<const CrifRecord*>> crifByBucket;
 
     // Find the set of buckets and associated qualifiers for the netting set details, product class and risk type
     map<string, set<string>> buckets;
     for(const auto& it : crif.filterBy(nettingSetDetails, pc, rt)) {
         buckets[it.bucket].insert(it.qualifier);
-        crifByQualifierAndBucket[std::make_pair(it.qualifier,it.bucket)].push_back(it);
-        crifByBucket[it.bucket].push_back(it);
+        crifByBucket[it.bucket].push_back(&it);
     }
 
     // If there are no buckets, return early and set bool to false to indicate margin does not apply
@@ -929,98 +1054,70 @@ pair<map<string, Real>, bool> SimmCalculator::margin(const NettingSetDetails& ne
         // Initialise sumWeightedSensis here to ensure it is not empty in the later calculations
         sumWeightedSensis[bucket] = 0.0;
 
-        // Get the concentration risk for each qualifier in current bucket i.e. $CR_k$ from SIMM docs
-        map<string, Real> concentrationRisk;
-
-        for (const auto& qualifier : kv.second) {
-
+        // Sensitivities within current bucket
+        std::vector<const CrifRecord*> bucketRecords;
+        for (const CrifRecord* r : crifByBucket[bucket]) {
             // Do not include Risk_FX components in the calculation currency in the SIMM calculation
-            if (rt == RiskType::FX && qualifier == calcCcy) {
+            if (rt == RiskType::FX && r->qualifier == calcCcy) {
                 if (!quiet_) {
-                    DLOG("Not calculating concentration risk for qualifier "
-                         << qualifier << " of risk type " << rt
-                         << " since the qualifier equals the SIMM calculation currency " << calcCcy);
+                    DLOG("Skipping qualifier " << r->qualifier << " of risk type " << rt
+                                               << " since the qualifier equals the SIMM calculation currency "
+                                               << calcCcy);
                 }
                 continue;
             }
+            bucketRecords.push_back(r);
+        }
+        CrifRecordView pBucket(std::move(bucketRecords));
+
+        // Risk weight i.e. $RW_k$ from SIMM docs and sigma value (1.0 if not applicable) for each risk factor
+        RiskFactors factors = riskFactors(pBucket);
+        std::vector<Real> rw(factors.size()), sigma(factors.size());
+        for (QuantLib::Size f = 0; f < factors.size(); ++f) {
+            rw[f] = simmConfiguration_->weight(rt, factors.qualifiers[f], factors.labels1[f], calcCcy);
+            sigma[f] = simmConfiguration_->sigma(rt, factors.qualifiers[f], factors.labels1[f], calcCcy);
+        }
 
-            // Pair of iterators to start and end of sensitivities with current qualifier
-            auto pQualifier = crifByQualifierAndBucket[std::make_pair(qualifier,bucket)];
-
-            // One pass to get the concentration risk for this qualifier
-            for (auto it = pQualifier.begin(); it != pQualifier.end(); ++it) {
-                // Get the sigma value if applicable - returns 1.0 if not applicable
-                Real sigma = simmConfiguration_->sigma(rt, it->qualifier, it->label1, calcCcy);
-                concentrationRisk[qualifier] += it->amountResultCcy * sigma * hvr;
-            }
+        // Get the concentration risk for each qualifier in current bucket i.e. $CR_k$ from SIMM docs
+        map<string, Real> concentrationRisk;
+        for (QuantLib::Size k = 0; k < pBucket.size(); ++k)
+            concentrationRisk[pBucket[k].qualifier] += pBucket[k].amountResultCcy * sigma[factors.ids[k]] * hvr;
+        for (auto& [qualifier, cr] : concentrationRisk) {
             // Divide by the concentration risk threshold
             Real concThreshold = simmConfiguration_->concentrationThreshold(rt, qualifier);
             if (resultCcy_ != "USD")
-                concThreshold *= market_->fxRate("USD" + resultCcy_)->value();
-            concentrationRisk[qualifier] /= concThreshold;
+                concThreshold *= usdToResultCcy();
+            cr /= concThreshold;
             // Final concentration risk amount
-            concentrationRisk[qualifier] = max(1.0, sqrt(std::abs(concentrationRisk[qualifier])));
+            cr = max(1.0, sqrt(std::abs(cr)));
         }
 
-
-        // Calculate the margin component for the current bucket
-        // Pair of iterators to start and end of sensitivities within current bucket
-        auto pBucket = crifByBucket[bucket];
-        for (auto itOuter = pBucket.begin(); itOuter != pBucket.end(); ++itOuter) {
-            // Do not include Risk_FX components in the calculation currency in the SIMM calculation
-            if (rt == RiskType::FX && itOuter->qualifier == calcCcy) {
-                if (!quiet_) {
-                    DLOG("Skipping qualifier " << itOuter->qualifier << " of risk type " << rt
-                                               << " since the qualifier equals the SIMM calculation currency "
-                                               << calcCcy);
-                }
-                continue;
-            }
-            // Risk weight i.e. $RW_k$ from SIMM docs
-            Real rwOuter = simmConfiguration_->weight(rt, itOuter->qualifier, itOuter->label1, calcCcy);
-            // Get the sigma value if applicable - returns 1.0 if not applicable
-            Real sigmaOuter = simmConfiguration_->sigma(rt, itOuter->qualifier, itOuter->label1, calcCcy);
-            // Weighted sensitivity i.e. $WS_{k}$ from SIMM docs
-            Real wsOuter =
-                rwOuter * (itOuter->amountResultCcy * sigmaOuter * hvr) * concentrationRisk[itOuter->qualifier];
-            // Get concentration risk for outer qualifier
-            Real outerConcentrationRisk = concentrationRisk.at(itOuter->qualifier);
+        // Weighted sensitivities i.e. $WS_{k}$ from SIMM docs
+        std::vector<Real> ws(pBucket.size());
+        for (QuantLib::Size k = 0; k < pBucket.size(); ++k) {
+            QuantLib::Size f = factors.ids[k];
+            ws[k] = rw[f] * (pBucket[k].amountResultCcy * sigma[f] * hvr) * concentrationRisk[pBucket[k].qualifier];
             // Update weighted sensitivity sum
-            sumWeightedSensis[bucket] += wsOuter;
-            // Add diagonal element to bucket margin
-            bucketMargin[bucket] += wsOuter * wsOuter;
-            // Add the cross elements to the bucket margin
-            for (auto itInner = pBucket.begin(); itInner != itOuter; ++itInner) {
-                // Do not include Risk_FX components in the calculation currency in the SIMM calculation
-                if (rt == RiskType::FX && itInner->qualifier == calcCcy) {
-                    if (!quiet_) {
-                        DLOG("Skipping qualifier " << itInner->qualifier << " of risk type " << rt
-                                                   << " since the qualifier equals the SIMM calculation currency "
-                                                   << calcCcy);
-                    }
-                    continue;
-                }
-                // Correlation, $\rho_{k,l}$ in the SIMM docs
-                Real corr =
-                    simmConfiguration_->correlation(rt, itOuter->qualifier, itOuter->label1, itOuter->label2, rt,
-                                                    itInner->qualifier, itInner->label1, itInner->label2, calcCcy);
-                // $f_{k,l}$ from the SIMM docs
-                Real f = min(outerConcentrationRisk, concentrationRisk.at(itInner->qualifier)) /
-                         max(outerConcentrationRisk, concentrationRisk.at(itInner->qualifier));
-                // Add cross element to delta margin
-                Real sigmaInner = simmConfiguration_->sigma(rt, itInner->qualifier, itInner->label1, calcCcy);
-                Real rwInner = simmConfiguration_->weight(rt, itInner->qualifier, itInner->label1, calcCcy);
-                Real wsInner =
-                    rwInner * (itInner->amountResultCcy * sigmaInner * hvr) * concentrationRisk[itInner->qualifier];
-                bucketMargin[bucket] += 2 * corr * f * wsOuter * wsInner;
-            }
-            // For FX risk class, results are broken down by qualifier, i.e. currency, instead of bucket, which is not used for Risk_FX
+            sumWeightedSensis[bucket] += ws[k];
+            // For FX risk class, results are broken down by qualifier, i.e. currency, instead of bucket, which is not
+            // used for Risk_FX
             if (riskClassIsFX)
-                bucketMargins[itOuter->qualifier] += wsOuter;
+                bucketMargins[pBucket[k].qualifier] += ws[k];
+        }
+
+        // Correlation $\rho_{k,l}$ times $f_{k,l}$ from the SIMM docs between the risk factors
+        QuantLib::Matrix correlations = simmConfiguration_->correlationMatrix(rt, factors.qualifiers, factors.labels1,
+                                                                              factors.labels2, calcCcy, &cache);
+        for (QuantLib::Size f = 0; f < factors.size(); ++f) {
+            Real crf = concentrationRisk.at(factors.qualifiers[f]);
+            for (QuantLib::Size g = 0; g < factors.size(); ++g) {
+                Real crg = concentrationRisk.at(factors.qualifiers[g]);
+                correlations[f][g] *= min(crf, crg) / max(crf, crg);
+            }
         }
 
         // Finally have the value of $K_b$
-        bucketMargin[bucket] = sqrt(max(bucketMargin[bucket], 0.0));
+        bucketMargin[bucket] = sqrt(max(aggregateWeightedSensis(ws, factors.ids, correlations), 0.0));
     }
 
     // If there is a "Residual" bucket entry store it separately
@@ -1074,7 +1171,8 @@ pair<map<string, Real>, bool> SimmCalculator::margin(const NettingSetDetails& ne
 
 pair<map<string, Real>, bool>
 SimmCalculator::curvatureMargin(const NettingSetDetails& nettingSetDetails, const ProductClass& pc, const RiskType& rt,
-                                const SimmSide& side, const Crif& crif, bool rfLabels) const {
+                                const SimmSide& side, const Crif& crif,
+                                SimmConfiguration::CorrelationCache& cache, bool rfLabels) const {
 
     const string& calcCcy = side == SimmSide::Call ? calculationCcyCall_ : calculationCcyPost_;
 
@@ -1115,47 +1213,50 @@ SimmCalculator::curvatureMargin(const NettingSetDetails& nettingSetDetails, cons
         sumAbsTemp[bucket] = {};
 
         // Calculate the margin component for the current bucket
-        // Pair of iterators to start and end of sensitivities within current bucket
+        // Sensitivities within current bucket
         auto pBucket = crif.filterByBucket(nettingSetDetails, pc, rt, bucket);
-        for (auto itOuter = pBucket.begin(); itOuter != pBucket.end(); ++itOuter) {
-            // Curvature weight i.e. $SF(t_{kj})$ from SIMM docs
-            Real sfOuter = simmConfiguration_->curvatureWeight(rt, itOuter->label1);
-            // Get the sigma value if applicable - returns 1.0 if not applicable
-            Real sigmaOuter = simmConfiguration_->sigma(rt, itOuter->qualifier, itOuter->label1, calcCcy);
-            // Weighted curvature i.e. $CVR_{ik}$ from SIMM docs
+
+        // Curvature weight i.e. $SF(t_{kj})$ from SIMM docs and sigma value (1.0 if not applicable) for each risk factor
+        RiskFactors factors = riskFactors(pBucket);
+        std::vector<Real> sf(factors.size()), sigma(factors.size());
+        for (QuantLib::Size f = 0; f < factors.size(); ++f) {
+            sf[f] = simmConfiguration_->curvatureWeight(rt, factors.labels1[f]);
+            sigma[f] = simmConfiguration_->sigma(rt, factors.qualifiers[f], factors.labels1[f], calcCcy);
+        }
+
+        // for ISDA SIMM 2.2 or higher, the $CVR_{ik}$ for EQ bucket 12 is zero
+        const string simmVersion = simmConfiguration_->version();
+        SimmVersion thresholdVersion = SimmVersion::V2_2;
+        bool zeroCurvature =
+            (simmConfiguration_->isSimmConfigCalibration() || parseSimmVersion(simmVersion) >= thresholdVersion) &&
+            bucket == "12" && rt == RiskType::EquityVol;
+
+        // Weighted curvatures i.e. $CVR_{ik}$ from SIMM docs
+        std::vector<Real> ws(pBucket.size());
+        for (QuantLib::Size k = 0; k < pBucket.size(); ++k) {
+            QuantLib::Size f = factors.ids[k];
             // WARNING: The order of multiplication here is important because unit tests fail if for
-            //          example you use sfOuter * (itOuter->amountResultCcy * multiplier) * sigmaOuter;
-            Real wsOuter = sfOuter * ((itOuter->amountResultCcy * multiplier) * sigmaOuter);
-            // for ISDA SIMM 2.2 or higher, this $CVR_{ik}$ for EQ bucket 12 is zero
-            const string simmVersion = simmConfiguration_->version();
-            SimmVersion thresholdVersion = SimmVersion::V2_2;
-            if ((simmConfiguration_->isSimmConfigCalibration() || parseSimmVersion(simmVersion) >= thresholdVersion) &&
-                bucket == "12" && rt == RiskType::EquityVol) {
-                wsOuter = 0.0;
-            }
+            //          example you use sf[f] * (pBucket[k].amountResultCcy * multiplier) * sigma[f];
+            ws[k] = zeroCurvature ? 0.0 : sf[f] * ((pBucket[k].amountResultCcy * multiplier) * sigma[f]);
             // Update weighted sensitivity sum
-            sumWeightedSensis[bucket] += wsOuter;
-            sumAbsTemp[bucket][itOuter->qualifier] += rfLabels ? std::abs(wsOuter) : wsOuter;
-            // Add diagonal element to curvature margin
-            curvatureMargin[bucket] += wsOuter * wsOuter;
-            // Add the cross elements to the curvature margin
-            for (auto itInner = pBucket.begin(); itInner != itOuter; ++itInner) {
-                // Correlation, $\rho_{k,l}$ in the SIMM docs
-                Real corr = simmConfiguration_->correlation(rt, itOuter->qualifier, itOuter->label1, itOuter->label2,
-                                                            rt, itInner->qualifier, itInner->label1, itInner->label2,
-                                                            calcCcy);
-                // Add cross element to delta margin
-                Real sfInner = simmConfiguration_->curvatureWeight(rt, itInner->label1);
-                Real sigmaInner = simmConfiguration_->sigma(rt, itInner->qualifier, itInner->label1, calcCcy);
-                Real wsInner = sfInner * ((itInner->amountResultCcy * multiplier) * sigmaInner);
-                curvatureMargin[bucket] += 2 * corr * corr * wsOuter * wsInner;
-            }
+            sumWeightedSensis[bucket] += ws[k];
+            sumAbsTemp[bucket][pBucket[k].qualifier] += rfLabels ? std::abs(ws[k]) : ws[k];
             // For FX risk class, results are broken down by qualifier, i.e. currency, instead of bucket, which is not
             // used for Risk_FX
             if (riskClassIsFX)
-                bucketMargins[itOuter->qualifier] += wsOuter;
+                bucketMargins[pBucket[k].qualifier] += ws[k];
         }
 
+        // Squared correlation $\rho_{k,l}^2$ from the SIMM docs between the risk factors
+        QuantLib::Matrix correlations = simmConfiguration_->correlationMatrix(rt, factors.qualifiers, factors.labels1,
+                                                                              factors.labels2, calcCcy, &cache);
+        for (QuantLib::Size f = 0; f < factors.size(); ++f)
+            for (QuantLib::Size g = 0; g < factors.size(); ++g)
+                correlations[f][g] *= correlations[f][g];
+
+        // Diagonal and cross elements of the curvature margin
+        curvatureMargin[bucket] += aggregateWeightedSensis(ws, factors.ids, correlations);
+
         // Finally have the value of $K_b$
         Real bucketCurvatureMargin = sqrt(max(curvatureMargin[bucket], 0.0));
         curvatureMargin[bucket] = bucketCurvatureMargin;
@@ -1233,11 +1334,9 @@ SimmCalculator::curvatureMargin(const NettingSetDetails& nettingSetDetails, cons
     return make_pair(bucketMargins, true);
 }
 
-void SimmCalculator::calcAddMargin(const SimmSide& side, const NettingSetDetails& nettingSetDetails,
-                                   const string& regulation, const Crif& crif) {
-
-    // Reference to SIMM results for this portfolio
-    auto& results = simmResults_[side][nettingSetDetails][regulation];
+void SimmCalculator::calcAddMargin(SimmResults& results, Crif& simmParameters, const SimmSide& side,
+                                   const NettingSetDetails& nettingSetDetails, const string& regulation,
+                                   const Crif& crif) const {
 
     const bool overwrite = false;
 
@@ -1261,23 +1360,23 @@ void SimmCalculator::calcAddMargin(const SimmSide& side, const NettingSetDetails
             QL_REQUIRE(factor >= 0.0, "SIMM Calculator: Amount for risk type "
                 << rt << " must be greater than or equal to 0 but we got " << factor);
             Real pcmMargin = (factor - 1.0) * im;
-            add(nettingSetDetails, regulation, qpc, RiskClass::All, MarginType::AdditionalIM, "All", pcmMargin, side,
+            add(results, nettingSetDetails, qpc, RiskClass::All, MarginType::AdditionalIM, "All", pcmMargin, side,
                 overwrite);
 
             // Add to aggregation at margin type level
-            add(nettingSetDetails, regulation, qpc, RiskClass::All, MarginType::All, "All", pcmMargin, side, overwrite);
+            add(results, nettingSetDetails, qpc, RiskClass::All, MarginType::All, "All", pcmMargin, side, overwrite);
             // Add to aggregation at product class level
-            add(nettingSetDetails, regulation, ProductClass::All, RiskClass::All, MarginType::AdditionalIM, "All", pcmMargin,
+            add(results, nettingSetDetails, ProductClass::All, RiskClass::All, MarginType::AdditionalIM, "All", pcmMargin,
                 side, overwrite);
             // Add to aggregation at portfolio level
-            add(nettingSetDetails, regulation, ProductClass::All, RiskClass::All, MarginType::All, "All", pcmMargin, side,
+            add(results, nettingSetDetails, ProductClass::All, RiskClass::All, MarginType::All, "All", pcmMargin, side,
                 overwrite);
             CrifRecord spRecord = it;
             if (side == SimmSide::Call)
                 spRecord.collectRegulations = regulation;
             else
                 spRecord.postRegulations = regulation;
-            simmParameters_.addRecord(spRecord);
+            simmParameters.addRecord(spRecord);
         }
     }
 
@@ -1285,25 +1384,25 @@ void SimmCalculator::calcAddMargin(const SimmSide& side, const NettingSetDetails
     pIt = crif.filterBy(nettingSetDetails, pc, RiskType::AddOnFixedAmount);
     for(const auto& it : pIt){
         Real fixedMargin = it.amountResultCcy;
-        add(nettingSetDetails, regulation, ProductClass::AddOnFixedAmount, RiskClass::All, MarginType::AdditionalIM,
+        add(results, nettingSetDetails, ProductClass::AddOnFixedAmount, RiskClass::All, MarginType::AdditionalIM,
             "All", fixedMargin, side, overwrite);
 
         // Add to aggregation at margin type level
-        add(nettingSetDetails, regulation, ProductClass::AddOnFixedAmount, RiskClass::All, MarginType::All, "All",
+        add(results, nettingSetDetails, ProductClass::AddOnFixedAmount, RiskClass::All, MarginType::All, "All",
             fixedMargin,
             side, overwrite);
         // Add to aggregation at product class level
-        add(nettingSetDetails, regulation, ProductClass::All, RiskClass::All, MarginType::AdditionalIM, "All",
+        add(results, nettingSetDetails, ProductClass::All, RiskClass::All, MarginType::AdditionalIM, "All",
             fixedMargin, side, overwrite);
         // Add to aggregation at portfolio level
-        add(nettingSetDetails, regulation, ProductClass::All, RiskClass::All, MarginType::All, "All", fixedMargin, side,
+        add(results, nettingSetDetails, ProductClass::All, RiskClass::All, MarginType::All, "All", fixedMargin, side,
             overwrite);
         CrifRecord spRecord = it;
         if (side == SimmSide::Call)
             spRecord.collectRegulations = regulation;
         else
             spRecord.postRegulations = regulation;
-        simmParameters_.addRecord(spRecord);
+        simmParameters.addRecord(spRecord);
     }
 
     // Third, add percentage of notional amounts IM, using "AddOnNotionalFactor"
@@ -1324,18 +1423,18 @@ void SimmCalculator::calcAddMargin(const SimmSide& side, const NettingSetDetails
             Real factor = it.amount;
             Real notionalFactorMargin = notional * factor / 100.0;
 
-            add(nettingSetDetails, regulation, ProductClass::AddOnNotionalFactor, RiskClass::All,
+            add(results, nettingSetDetails, ProductClass::AddOnNotionalFactor, RiskClass::All,
                 MarginType::AdditionalIM, "All", notionalFactorMargin, side, overwrite);
 
             // Add to aggregation at margin type level
-            add(nettingSetDetails, regulation, ProductClass::AddOnNotionalFactor, RiskClass::All, MarginType::All,
+            add(results, nettingSetDetails, ProductClass::AddOnNotionalFactor, RiskClass::All, MarginType::All,
                 "All",
                 notionalFactorMargin, side, overwrite);
             // Add to aggregation at product class level
-            add(nettingSetDetails, regulation, ProductClass::All, RiskClass::All, MarginType::AdditionalIM, "All",
+            add(results, nettingSetDetails, ProductClass::All, RiskClass::All, MarginType::AdditionalIM, "All",
                 notionalFactorMargin, side, overwrite);
             // Add to aggregation at portfolio level
-            add(nettingSetDetails, regulation, ProductClass::All, RiskClass::All, MarginType::All, "All",
+            add(results, nettingSetDetails, ProductClass::All, RiskClass::All, MarginType::All, "All",
                 notionalFactorMargin,
                 side, overwrite);
             CrifRecord spRecord = it;
@@ -1343,13 +1442,13 @@ void SimmCalculator::calcAddMargin(const SimmSide& side, const NettingSetDetails
                 spRecord.collectRegulations = regulation;
             else
                 spRecord.postRegulations = regulation;
-            simmParameters_.addRecord(spRecord);
+            simmParameters.addRecord(spRecord);
         }
     }
 }
 
-void SimmCalculator::populateResults(const SimmSide& side, const NettingSetDetails& nettingSetDetails,
-                                     const string& regulation) {
+void SimmCalculator::populateResults(SimmResults& results, const SimmSide& side,
+                                     const NettingSetDetails& nettingSetDetails) const {
 
     if (!quiet_) {
         LOG("SimmCalculator: Populating higher level results")
@@ -1362,9 +1461,6 @@ void SimmCalculator::populateResults(const SimmSide& side, const NettingSetDetai
 
     // Populate netting set level results for each portfolio
 
-    // Reference to SIMM results for this portfolio
-    auto& results = simmResults_[side][nettingSetDetails][regulation];
-
     // Fill in the margin within each (product class, risk class) combination
     for (const auto& pc : pcs) {
         for (const auto& rc : rcs) {
@@ -1382,7 +1478,7 @@ void SimmCalculator::populateResults(const SimmSide& side, const NettingSetDetai
 
             // Add the margin to the results if it was calculated
             if (hasRiskClass) {
-                add(nettingSetDetails, regulation, pc, rc, MarginType::All, "All", riskClassMargin, side);
+                add(results, nettingSetDetails, pc, rc, MarginType::All, "All", riskClassMargin, side);
             }
         }
     }
@@ -1420,7 +1516,7 @@ void SimmCalculator::populateResults(const SimmSide& side, const NettingSetDetai
         // Add the margin to the results if it was calculated
         if (hasProductClass) {
             productClassMargin = sqrt(max(productClassMargin, 0.0));
-            add(nettingSetDetails, regulation, pc, RiskClass::All, MarginType::All, "All", productClassMargin, side);
+            add(results, nettingSetDetails, pc, RiskClass::All, MarginType::All, "All", productClassMargin, side);
         }
     }
 
@@ -1432,7 +1528,7 @@ void SimmCalculator::populateResults(const SimmSide& side, const NettingSetDetai
             im += results.get(pc, RiskClass::All, MarginType::All, "All");
         }
     }
-    add(nettingSetDetails, regulation, ProductClass::All, RiskClass::All, MarginType::All, "All", im, side);
+    add(results, nettingSetDetails, ProductClass::All, RiskClass::All, MarginType::All, "All", im, side);
 
     // Combinations outside of the natural SIMM hierarchy
 
@@ -1470,7 +1566,7 @@ void SimmCalculator::populateResults(const SimmSide& side, const NettingSetDetai
             // Add the margin to the results if it was calculated
             if (hasPcMt) {
                 margin = sqrt(max(margin, 0.0));
-                add(nettingSetDetails, regulation, pc, RiskClass::All, mt, "All", margin, side);
+                add(results, nettingSetDetails, pc, RiskClass::All, mt, "All", margin, side);
             }
         }
     }
@@ -1495,7 +1591,7 @@ void SimmCalculator::populateResults(const SimmSide& side, const NettingSetDetai
 
             // Add the margin to the results if it was calculated
             if (hasRcMt) {
-                add(nettingSetDetails, regulation, ProductClass::All, rc, mt, "All", margin, side);
+                add(results, nettingSetDetails, ProductClass::All, rc, mt, "All", margin, side);
             }
         }
     }
@@ -1520,7 +1616,7 @@ void SimmCalculator::populateResults(const SimmSide& side, const NettingSetDetai
 
         // Add the margin to the results if it was calculated
         if (hasRc) {
-            add(nettingSetDetails, regulation, ProductClass::All, rc, MarginType::All, "All", margin, side);
+            add(results, nettingSetDetails, ProductClass::All, rc, MarginType::All, "All", margin, side);
         }
     }
 
@@ -1544,7 +1640,7 @@ void SimmCalculator::populateResults(const SimmSide& side, const NettingSetDetai
 
         // Add the margin to the results if it was calculated
         if (hasMt) {
-            add(nettingSetDetails, regulation, ProductClass::All, RiskClass::All, mt, "All", margin, side);
+            add(results, nettingSetDetails, ProductClass::All, RiskClass::All, mt, "All", margin, side);
         }
     }
 }
@@ -1596,9 +1692,9 @@ void SimmCalculator::populateFinalResults() {
     populateFinalResults(winningRegulations_);
 }
 
-void SimmCalculator::add(const NettingSetDetails& nettingSetDetails, const string& regulation, const ProductClass& pc,
+void SimmCalculator::add(SimmResults& results, const NettingSetDetails& nettingSetDetails, const ProductClass& pc,
                          const RiskClass& rc, const MarginType& mt, const string& b, Real margin, SimmSide side,
-                         const bool overwrite) {
+                         const bool overwrite) const {
     if (!quiet_) {
         DLOG("Calculated " << side << " margin for [netting set details, product class, risk class, margin type] = ["
                            << "[" << NettingSetDetails(nettingSetDetails) << "]"
@@ -1606,15 +1702,15 @@ void SimmCalculator::add(const NettingSetDetails& nettingSetDetails, const strin
     }
 
     const string& calculationCcy = side == SimmSide::Call ? calculationCcyCall_ : calculationCcyPost_;
-    simmResults_[side][nettingSetDetails][regulation].add(pc, rc, mt, b, margin, resultCcy_, calculationCcy, overwrite);
+    results.add(pc, rc, mt, b, margin, resultCcy_, calculationCcy, overwrite);
 }
 
-void SimmCalculator::add(const NettingSetDetails& nettingSetDetails, const string& regulation, const ProductClass& pc,
+void SimmCalculator::add(SimmResults& results, const NettingSetDetails& nettingSetDetails, const ProductClass& pc,
                          const RiskClass& rc, const MarginType& mt, const map<string, Real>& margins, SimmSide side,
-                         const bool overwrite) {
+                         const bool overwrite) const {
 
     for (const auto& kv : margins)
-        add(nettingSetDetails, regulation, pc, rc, mt, kv.first, kv.second, side, overwrite);
+        add(results, nettingSetDetails, pc, rc, mt, kv.first, kv.second, side, overwrite);
 }
 
 void SimmCalculator::splitCrifByRegulationsAndPortfolios(const Crif& crif, const bool enforceIMRegulations) {
@@ -1656,6 +1752,12 @@ void SimmCalculator::splitCrifByRegulationsAndPortfolios(const Crif& crif, const
     }
 }
 
+Real SimmCalculator::usdToResultCcy() const {
+    QL_REQUIRE(usdToResultCcy_ != QuantLib::Null<Real>(),
+               "SimmCalculator: no market given to convert USD amounts to the result currency " << resultCcy_);
+    return usdToResultCcy_;
+}
+
 Real SimmCalculator::lambda(Real theta) const {
     // Use boost inverse normal here as opposed to QL. Using QL inverse normal
     // will cause the ISDA SIMM unit tests to fail
@@ -44,6 +44,10 @@ public:
         \p calculationCcy is not USD then the \p usdSpot parameter must be used to
         give the FX spot rate between USD and the \p calculationCcy. This spot rate is
         interpreted as the number of USD per unit of \p calculationCcy.
+
+        If \p nThreads is greater than one, the SIMM for the side, netting set and regulation combinations is
+        calculated on up to \p nThreads threads. The results are identical to the single threaded calculation.
+        This requires a QuantLib build with QL_ENABLE_SESSIONS, otherwise the calculation runs on one thread.
     */
     SimmCalculator(const ore::analytics::Crif& crif,
                    const QuantLib::ext::shared_ptr<SimmConfiguration>& simmConfiguration,
@@ -56,7 +60,8 @@ public:
                    const std::map<SimmSide, std::set<NettingSetDetails>>& hasSEC =
                        std::map<SimmSide, std::set<NettingSetDetails>>(),
                    const std::map<SimmSide, std::set<NettingSetDetails>>& hasCFTC =
-                       std::map<SimmSide, std::set<NettingSetDetails>>());
+                       std::map<SimmSide, std::set<NettingSetDetails>>(),
+                   const QuantLib::Size nThreads = 1);
 
     //! Calculates SIMM for a given regulation under a given netting set
     const void calculateRegulationSimm(const ore::analytics::Crif& crif, const ore::data::NettingSetDetails& nsd,
@@ -132,6 +137,9 @@ private:
     //! If true, no logging is written out
     bool quiet_;
 
+    //! FX rate USD to result currency, used to convert the concentration thresholds
+    QuantLib::Real usdToResultCcy_ = QuantLib::Null<QuantLib::Real>();
+
     std::map<SimmSide, std::set<NettingSetDetails>> hasSEC_, hasCFTC_;
 
     //! For each netting set, whether all CRIF records' collect regulations are empty
@@ -162,20 +170,32 @@ private:
 
     std::map<SimmSide, set<string>> finalTradeIds_;
 
+    /*! Calculates SIMM for a given regulation under a given netting set into the given results and SIMM parameters
+        containers, does not modify the calculator's state. The correlation \p cache is shared by all calculations
+        on one thread.
+    */
+    void calculateRegulationSimm(const ore::analytics::Crif& crif, const ore::data::NettingSetDetails& nsd,
+                                 const string& regulation, const SimmSide& side, SimmResults& results,
+                                 ore::analytics::Crif& simmParameters,
+                                 SimmConfiguration::CorrelationCache& cache) const;
+
     //! Calculate the Interest Rate delta margin component for the given portfolio and product class
     std::pair<std::map<std::string, QuantLib::Real>, bool>
     irDeltaMargin(const ore::data::NettingSetDetails& nettingSetDetails, const CrifRecord::ProductClass& pc,
-                  const ore::analytics::Crif& netRecords, const SimmSide& side) const;
+                  const ore::analytics::Crif& netRecords, const SimmSide& side,
+                  SimmConfiguration::CorrelationCache& cache) const;
 
     //! Calculate the Interest Rate vega margin component for the given portfolio and product class
     std::pair<std::map<std::string, QuantLib::Real>, bool>
     irVegaMargin(const ore::data::NettingSetDetails& nettingSetDetails, const CrifRecord::ProductClass& pc,
-                 const ore::analytics::Crif& netRecords, const SimmSide& side) const;
+                 const ore::analytics::Crif& netRecords, const SimmSide& side,
+                 SimmConfiguration::CorrelationCache& cache) const;
 
     //! Calculate the Interest Rate curvature margin component for the given portfolio and product class
     std::pair<std::map<std::string, QuantLib::Real>, bool>
     irCurvatureMargin(const ore::data::NettingSetDetails& nettingSetDetails, const CrifRecord::ProductClass& pc,
-                      const SimmSide& side, const ore::analytics::Crif& crif) const;
+                      const SimmSide& side, const ore::analytics::Crif& crif,
+                      SimmConfiguration::CorrelationCache& cache) const;
 
     /*! Calculate the (delta or vega) margin component for the given portfolio, product class and risk type
         Used to calculate delta or vega or base correlation margin for all risk types except IR, IRVol
@@ -185,7 +205,8 @@ private:
                                                                   const CrifRecord::ProductClass& pc,
                                                                   const CrifRecord::RiskType& rt,
                                                                   const ore::analytics::Crif& netRecords,
-                                                                  const SimmSide& side) const;
+                                                                  const SimmSide& side,
+                                                                  SimmConfiguration::CorrelationCache& cache) const;
 
     /*! Calculate the curvature margin component for the given portfolio, product class and risk type
         Used to calculate curvature margin for all risk types except IR
@@ -193,40 +214,45 @@ private:
     std::pair<std::map<std::string, QuantLib::Real>, bool>
     curvatureMargin(const ore::data::NettingSetDetails& nettingSetDetails, const CrifRecord::ProductClass& pc,
                     const CrifRecord::RiskType& rt, const SimmSide& side, const ore::analytics::Crif& netRecords,
-                    bool rfLabels = true) const;
+                    SimmConfiguration::CorrelationCache& cache, bool rfLabels = true) const;
 
     //! Calculate the additional initial margin for the portfolio ID and regulation
-    void calcAddMargin(const SimmSide& side, const ore::data::NettingSetDetails& nsd, const string& regulation, const ore::analytics::Crif& netRecords);
+    void calcAddMargin(SimmResults& results, ore::analytics::Crif& simmParameters, const SimmSide& side,
+                       const ore::data::NettingSetDetails& nsd, const string& regulation,
+                       const ore::analytics::Crif& netRecords) const;
 
     /*! Populate the results structure with the higher level results after the IMs have been
         calculated at the (product class, risk class, margin type) level for the given
         regulation under the given portfolio
     */
-    void populateResults(const SimmSide& side, const ore::data::NettingSetDetails& nsd, const string& regulation);
+    void populateResults(SimmResults& results, const SimmSide& side, const ore::data::NettingSetDetails& nsd) const;
 
     /*! Populate final (i.e. winning regulators') using own list of winning regulators, which were determined
         solely by the SIMM results (i.e. not including any external IMSchedule results)
     */
     void populateFinalResults();
 
-    /*! Add a margin result to either call or post results container depending on the
+    /*! Add a margin result to the given results container, the calculation currency is determined by the
         \p side parameter.
 
         \remark all additions to the results containers should happen in this method
     */
-    void add(const ore::data::NettingSetDetails& nettingSetDetails, const string& regulation,
+    void add(SimmResults& results, const ore::data::NettingSetDetails& nettingSetDetails,
              const CrifRecord::ProductClass& pc, const SimmConfiguration::RiskClass& rc,
              const SimmConfiguration::MarginType& mt, const std::string& b, QuantLib::Real margin, SimmSide side,
-             const bool overwrite = true);
+             const bool overwrite = true) const;
 
-    void add(const ore::data::NettingSetDetails& nettingSetDetails, const string& regulation,
+    void add(SimmResults& results, const ore::data::NettingSetDetails& nettingSetDetails,
              const CrifRecord::ProductClass& pc, const SimmConfiguration::RiskClass& rc,
              const SimmConfiguration::MarginType& mt, const std::map<std::string, QuantLib::Real>& margins, SimmSide side,
-             const bool overwrite = true);
+             const bool overwrite = true) const;
 
     //! Add CRIF record to the CRIF records container that correspondsd to the given regulation/s and portfolio ID
     void splitCrifByRegulationsAndPortfolios(const Crif& crif, const bool enforceIMRegulations);
 
+    //! Give the FX rate USD to result currency, requires a market if the result currency is not USD
+    QuantLib::Real usdToResultCcy() const;
+
     //! Give the \f$\lambda\f$ used in the curvature margin calculation
     QuantLib::Real lambda(QuantLib::Real theta) const;
 
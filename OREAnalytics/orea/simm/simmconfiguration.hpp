@@ -22,14 +22,17 @@
 
 #pragma once
 
+#include <map>
 #include <set>
 #include <string>
+#include <tuple>
 #include <vector>
 
 #include <boost/optional.hpp>
 #include <orea/simm/crifconfiguration.hpp>
 #include <orea/simm/crifrecord.hpp>
 #include <ql/indexes/interestrateindex.hpp>
+#include <ql/math/matrix.hpp>
 #include <ql/types.hpp>
 
 namespace ore {
@@ -228,6 +231,32 @@ public:
                                        const std::string& secondLabel_1, const std::string& secondLabel_2,
                                        const std::string& calculationCurrency = "") const = 0;
 
+    /*! Ids of qualifiers, labels and buckets and correlations computed by correlationMatrix(), which can be reused
+        in later calls, e.g. for all buckets of one SIMM calculation. A cache must only be used with the configuration
+        that filled it and by one thread at a time.
+    */
+    struct CorrelationCache {
+        //! Ids of the qualifiers, labels and buckets, equal strings get the same id
+        std::map<std::string, QuantLib::Size> ids;
+        //! Bucket id by risk type and qualifier id
+        std::map<std::pair<CrifRecord::RiskType, QuantLib::Size>, QuantLib::Size> buckets;
+        //! Correlation by risk type, calculation currency, key ids of the two risk factors and equality flags
+        std::map<std::tuple<CrifRecord::RiskType, std::string, QuantLib::Size, QuantLib::Size, QuantLib::Size>,
+                 QuantLib::Real>
+            correlations;
+    };
+
+    /*! Return the matrix of correlations between the risk factors of risk type \p rt given by \p qualifiers,
+        \p labels_1 and \p labels_2, which must have the same size. Entry \f$(i,j)\f$ is the value of
+        correlation() for the i-th and j-th risk factor. If a \p cache is given, it is used and updated.
+    */
+    virtual QuantLib::Matrix correlationMatrix(const CrifRecord::RiskType& rt,
+                                               const std::vector<std::string>& qualifiers,
+                                               const std::vector<std::string>& labels_1,
+                                               const std::vector<std::string>& labels_2,
+                                               const std::string& calculationCurrency = "",
+                                               CorrelationCache* cache = nullptr) const = 0;
+
     virtual bool isSimmConfigCalibration() const { return false; }
 
 protected:
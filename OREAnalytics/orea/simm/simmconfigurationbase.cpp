@@ -19,6 +19,7 @@
 #include <orea/simm/simmconfigurationbase.hpp>
 #include <orea/simm/utilities.hpp>
 
+#include <algorithm>
 #include <boost/math/distributions/normal.hpp>
 #include <boost/optional/optional_io.hpp>
 #include <ored/utilities/parsers.hpp>
@@ -63,7 +64,14 @@ std::ostream& operator<<(std::ostream& out, const tuple<string, string, string>&
                << std::get<2>(tup) << "']";
 }
 
-
+// Replace the \p values by consecutive integer ids, equal values get the same id. Returns the number of distinct ids.
+Size intern(const vector<Size>& values, vector<Size>& ids) {
+    map<Size, Size> index;
+    ids.resize(values.size());
+    for (Size i = 0; i < values.size(); ++i)
+        ids[i] = index.emplace(values[i], index.size()).first->second;
+    return index.size();
+}
 
 } // anonymous namespace
 
@@ -428,6 +436,100 @@ QuantLib::Real SimmConfigurationBase::correlation(const RiskType& firstRt, const
     return 0.0;
 }
 
+Matrix SimmConfigurationBase::correlationMatrix(const RiskType& rt, const vector<string>& qualifiers,
+                                                const vector<string>& labels_1, const vector<string>& labels_2,
+                                                const string& calculationCurrency, CorrelationCache* cache) const {
+
+    Size n = qualifiers.size();
+    QL_REQUIRE(labels_1.size() == n && labels_2.size() == n,
+               "SimmConfigurationBase::correlationMatrix(): number of qualifiers ("
+                   << n << "), Label1 values (" << labels_1.size() << ") and Label2 values (" << labels_2.size()
+                   << ") must be equal");
+
+    Matrix result(n, n);
+    if (n == 0)
+        return result;
+
+    // The key of each risk factor that, together with the equality of qualifiers and labels, determines the
+    // correlation between two risk factors is the bucket or the Label1 value. If there is no such key, correlation()
+    // is called for each pair.
+    bool bucketKeys = false;
+    switch (rt) {
+    case RiskType::Equity:
+    case RiskType::EquityVol:
+    case RiskType::CreditQ:
+    case RiskType::CreditVol:
+    case RiskType::CreditNonQ:
+    case RiskType::CreditVolNonQ:
+    case RiskType::Commodity:
+    case RiskType::CommodityVol:
+        bucketKeys = true;
+        break;
+    case RiskType::IRCurve:
+    case RiskType::IRVol:
+        break;
+    default:
+        for (Size i = 0; i < n; ++i) {
+            for (Size j = 0; j <= i; ++j) {
+                result[i][j] = result[j][i] =
+                    correlation(rt, qualifiers[i], labels_1[i], labels_2[i], rt, qualifiers[j], labels_1[j],
+                                labels_2[j], calculationCurrency);
+            }
+        }
+        return result;
+    }
+
+    // Without a cache the ids and correlations are only reused within this call
+    CorrelationCache localCache;
+    CorrelationCache& c = cache ? *cache : localCache;
+    auto id = [&c](const string& s) { return c.ids.emplace(s, c.ids.size()).first->second; };
+
+    // Intern the qualifiers, labels and keys
+    vector<Size> qualifierIds(n), label1Ids(n), label2Ids(n), keys(n);
+    for (Size i = 0; i < n; ++i) {
+        qualifierIds[i] = id(qualifiers[i]);
+        label1Ids[i] = id(labels_1[i]);
+        label2Ids[i] = id(labels_2[i]);
+        if (bucketKeys) {
+            auto b = c.buckets.find(std::make_pair(rt, qualifierIds[i]));
+            if (b == c.buckets.end()) {
+                Size bucketId = id(simmBucketMapper_->bucket(rt, qualifiers[i]));
+                b = c.buckets.emplace(std::make_pair(rt, qualifierIds[i]), bucketId).first;
+            }
+            keys[i] = b->second;
+        } else {
+            keys[i] = label1Ids[i];
+        }
+    }
+
+    // Correlations by pair of keys and equality of qualifiers, Label1 and Label2 values, the table is indexed by the
+    // keys of this call and filled from the cache
+    vector<Size> localKeys;
+    Size nKeys = intern(keys, localKeys);
+    vector<Real> table(nKeys * nKeys * 8, Null<Real>());
+    for (Size i = 0; i < n; ++i) {
+        for (Size j = 0; j <= i; ++j) {
+            Size flags = (qualifierIds[i] == qualifierIds[j]) * 4 + (label1Ids[i] == label1Ids[j]) * 2 +
+                         (label2Ids[i] == label2Ids[j]);
+            Size k = (localKeys[i] * nKeys + localKeys[j]) * 8 + flags;
+            if (table[k] == Null<Real>()) {
+                auto key = std::make_tuple(rt, calculationCurrency, keys[i], keys[j], flags);
+                auto corr = c.correlations.find(key);
+                if (corr == c.correlations.end()) {
+                    corr = c.correlations
+                               .emplace(key, correlation(rt, qualifiers[i], labels_1[i], labels_2[i], rt, qualifiers[j],
+                                                         labels_1[j], labels_2[j], calculationCurrency))
+                               .first;
+                }
+                table[k] = corr->second;
+            }
+            result[i][j] = result[j][i] = table[k];
+        }
+    }
+
+    return result;
+}
+
 Real SimmConfigurationBase::sigmaMultiplier() const {
     // return 2.19486471232815;
     // Use boost inverse normal here as opposed to QL. Using QL inverse normal
@@ -152,6 +152,23 @@ public:
                                const std::string& secondLabel_1, const std::string& secondLabel_2,
                                const std::string& calculationCurrency = "") const override;
 
+    /*! Return the matrix of correlations between the risk factors of risk type \p rt given by \p qualifiers,
+        \p labels_1 and \p labels_2.
+
+        The qualifiers and labels are interned into integer ids. For risk types with buckets (other than FX) the
+        correlation is assumed to depend on the qualifiers only through their buckets and through equality, for
+        IRCurve and IRVol on the Label1 values and the equality of qualifiers and Label2 values. For these the
+        correlation() method is therefore only called once per distinct combination and the remaining entries are
+        filled from a table indexed by the ids. The ids, buckets and correlations are kept in the \p cache, so that
+        they are computed once for all calls sharing the cache. For all other risk types correlation() is called
+        for each pair.
+    */
+    QuantLib::Matrix correlationMatrix(const CrifRecord::RiskType& rt, const std::vector<std::string>& qualifiers,
+                                       const std::vector<std::string>& labels_1,
+                                       const std::vector<std::string>& labels_2,
+                                       const std::string& calculationCurrency = "",
+                                       CorrelationCache* cache = nullptr) const override;
+
     //! MPOR in days
     QuantLib::Size mporDays() const { return mporDays_; }
 
@@ -18,10 +18,12 @@
 
 #include <boost/filesystem.hpp>
 #include <boost/test/unit_test.hpp>
+#include <orea/cube/contiguouscube.hpp>
 #include <orea/cube/inmemorycube.hpp>
 #include <orea/cube/cube_io.hpp>
 #include <orea/cube/npvcube.hpp>
 #include <orea/cube/jaggedcube.hpp>
+#include <orea/cube/memorymappedcube.hpp>
 #include <orea/engine/filteredsensitivitystream.hpp>
 #include <orea/engine/observationmode.hpp>
 #include <orea/engine/parametricvar.hpp>
@@ -91,6 +93,18 @@ void checkCube(NPVCube& cube, Real tolerance) {
             }
         }
     }
+    // check the bulk access to the samples
+    vector<Real> samples;
+    for (Size i = 0; i < cube.numIds(); ++i) {
+        for (Size j = 0; j < cube.numDates(); ++j) {
+            for (Size d = 0; d < cube.depth(); ++d) {
+                cube.getSamples(samples, i, j, d);
+                BOOST_REQUIRE_EQUAL(samples.size(), cube.samples());
+                for (Size k = 0; k < cube.samples(); ++k)
+                    BOOST_CHECK_CLOSE(samples[k], cube.get(i, j, k, d), tolerance);
+            }
+        }
+    }
 }
 
 void testCube(NPVCube& cube, const std::string& cubeName, Real tolerance) {
@@ -143,6 +157,57 @@ void testCubeFileIO(QuantLib::ext::shared_ptr<NPVCube> cube, const std::string&
     checkCube(*cube2, tolerance);
 }
 
+void testBinaryCubeFileIO(QuantLib::ext::shared_ptr<NPVCube> cube, const std::string& cubeName, Real tolerance,
+                          bool doublePrecision) {
+
+    initCube(*cube);
+    for (Size i = 0; i < cube->numIds(); ++i)
+        for (Size d = 0; d < cube->depth(); ++d)
+            cube->setT0(i * 10.0 + d, i, d);
+
+    // get a random filename, the extension .bin selects the binary format
+    string filename = boost::filesystem::unique_path().string() + ".bin";
+    BOOST_TEST_MESSAGE("Saving cube " << cubeName << " to binary file " << filename);
+    saveCube(filename, NPVCubeWithMetaData{cube, nullptr, true, 2}, doublePrecision);
+
+    BOOST_TEST_MESSAGE("Loading from binary file " << filename);
+    auto r = loadCube(filename);
+    auto cube2 = r.cube;
+    BOOST_CHECK(QuantLib::ext::dynamic_pointer_cast<MemoryMappedNpvCube<float>>(cube2) ||
+                QuantLib::ext::dynamic_pointer_cast<MemoryMappedNpvCube<double>>(cube2));
+
+    // check meta data and dimensions
+    BOOST_REQUIRE(r.storeFlows);
+    BOOST_CHECK(*r.storeFlows);
+    BOOST_REQUIRE(r.storeCreditStateNPVs);
+    BOOST_CHECK_EQUAL(*r.storeCreditStateNPVs, 2);
+    BOOST_CHECK(!r.scenarioGeneratorData);
+    BOOST_CHECK_EQUAL(cube->asof(), cube2->asof());
+    BOOST_CHECK_EQUAL(cube->numIds(), cube2->numIds());
+    BOOST_CHECK_EQUAL(cube->numDates(), cube2->numDates());
+    BOOST_CHECK_EQUAL(cube->samples(), cube2->samples());
+    BOOST_CHECK_EQUAL(cube->depth(), cube2->depth());
+    BOOST_CHECK(cube->idsAndIndexes() == cube2->idsAndIndexes());
+
+    // check all values
+    checkCube(*cube2, tolerance);
+    for (Size i = 0; i < cube->numIds(); ++i)
+        for (Size d = 0; d < cube->depth(); ++d)
+            BOOST_CHECK_CLOSE(cube2->getT0(i, d), i * 10.0 + d, tolerance);
+
+    // the file is mapped copy-on-write, i.e. changes are not written back to the file
+    cube2->set(-1.0, 0, 0, 0, 0);
+    BOOST_CHECK_CLOSE(cube2->get(0, 0, 0, 0), -1.0, tolerance);
+    auto cube3 = loadCube(filename).cube;
+    BOOST_CHECK_CLOSE(cube3->get(0, 0, 0, 0), cube->get(0, 0, 0, 0), tolerance);
+
+    // release the mappings before deleting the file
+    cube2.reset();
+    cube3.reset();
+    r.cube.reset();
+    boost::filesystem::remove(filename);
+}
+
 void testCubeGetSetbyDateID(NPVCube& cube, Real tolerance) {
     std::map<string, Size> ids = cube.idsAndIndexes();
     vector<Date> dates = cube.dates();
@@ -442,6 +507,20 @@ BOOST_AUTO_TEST_CASE(testDoublePrecisionInMemoryCubeN) {
     testCube(c, "DoublePrecisionInMemoryCubeN", 1e-14);
 }
 
+BOOST_AUTO_TEST_CASE(testContiguousCube) {
+    std::set<string> ids{string("id1"), string("id2"), string("id3")};
+    vector<Date> dates(20, Date());
+    Size samples = 50;
+    Size depth = 4;
+    for (auto order : {CubeAxisOrder::IdDateSample, CubeAxisOrder::IdSampleDate, CubeAxisOrder::DateIdSample,
+                       CubeAxisOrder::DateSampleId, CubeAxisOrder::SampleIdDate, CubeAxisOrder::SampleDateId}) {
+        DoublePrecisionContiguousNpvCube c(Date(), ids, dates, samples, depth, order);
+        testCube(c, "DoublePrecisionContiguousNpvCube, axis order " + std::to_string(static_cast<int>(order)), 1e-14);
+        SinglePrecisionContiguousNpvCube s(Date(), ids, dates, samples, 1, order);
+        testCube(s, "SinglePrecisionContiguousNpvCube, axis order " + std::to_string(static_cast<int>(order)), 1e-5);
+    }
+}
+
 BOOST_AUTO_TEST_CASE(testDoublePrecisionInMemoryCubeFileIO) {
     std::set<string> ids{string("id")}; // the overlap doesn't matter
     Date d(1, QuantLib::Jan, 2016);        // need a real date here
@@ -461,6 +540,20 @@ BOOST_AUTO_TEST_CASE(testDoublePrecisionInMemoryCubeFileNIO) {
     testCubeFileIO<DoublePrecisionInMemoryCubeN>(c, "DoublePrecisionInMemoryCubeN", 1e-14, true);
 }
 
+BOOST_AUTO_TEST_CASE(testBinaryCubeFileIO) {
+    std::set<string> ids{string("id1"), string("id2"), string("id3")};
+    Date d(1, QuantLib::Jan, 2016); // need a real date here
+    vector<Date> dates(20, d);
+    Size samples = 100;
+    Size depth = 3;
+    testBinaryCubeFileIO(QuantLib::ext::make_shared<DoublePrecisionInMemoryCube>(d, ids, dates, samples),
+                         "DoublePrecisionInMemoryCube", 1e-14, true);
+    testBinaryCubeFileIO(QuantLib::ext::make_shared<DoublePrecisionInMemoryCubeN>(d, ids, dates, samples, depth),
+                         "DoublePrecisionInMemoryCubeN", 1e-14, true);
+    testBinaryCubeFileIO(QuantLib::ext::make_shared<SinglePrecisionInMemoryCubeN>(d, ids, dates, samples, depth),
+                         "SinglePrecisionInMemoryCubeN", 1e-5, false);
+}
+
 BOOST_AUTO_TEST_CASE(testInMemoryCubeGetSetbyDateID) {
     std::set<string> ids = {"id1", "id2", "id3"}; // the overlap doesn't matter
     Date today = Date::todaysDate();
@@ -0,0 +1,157 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <boost/test/unit_test.hpp>
+#include <orea/cube/inmemorycube.hpp>
+#include <orea/engine/historicalpnlgenerator.hpp>
+#include <orea/engine/observationmode.hpp>
+#include <orea/engine/riskfilter.hpp>
+#include <orea/scenario/historicalscenarioloader.hpp>
+#include <orea/scenario/scenariosimmarket.hpp>
+#include <orea/scenario/simplescenariofactory.hpp>
+#include <ored/portfolio/builders/swap.hpp>
+#include <ored/portfolio/portfolio.hpp>
+#include <oret/toplevelfixture.hpp>
+#include <test/oreatoplevelfixture.hpp>
+#include <test/testportfolio.hpp>
+
+#include "testmarket.hpp"
+
+using namespace std;
+using namespace QuantLib;
+using namespace ore;
+using namespace ore::data;
+using namespace ore::analytics;
+
+using testsuite::buildSwap;
+using testsuite::TestConfigurationObjects;
+using testsuite::TestMarket;
+
+BOOST_FIXTURE_TEST_SUITE(OREAnalyticsTestSuite, ore::test::OreaTopLevelFixture)
+
+BOOST_AUTO_TEST_SUITE(HistoricalPnlGeneratorTest)
+
+BOOST_AUTO_TEST_CASE(testSinglePassCube) {
+
+    BOOST_TEST_MESSAGE("Testing historical P&L cube generation for several filters in a single pass...");
+
+    // trades whose risk factors are not changed by a filter are only skipped in observation mode Disable or Unregister,
+    // the fixture restores the observation mode
+    ObservationMode::instance().setMode(ObservationMode::Mode::Disable);
+
+    Date today(14, April, 2016);
+    Settings::instance().evaluationDate() = today;
+
+    TestConfigurationObjects::setConventions();
+    auto initMarket = QuantLib::ext::make_shared<TestMarket>(today);
+    auto simMarketData = TestConfigurationObjects::setupSimMarketData5();
+    auto simMarket = QuantLib::ext::make_shared<ScenarioSimMarket>(initMarket, simMarketData);
+
+    auto engineData = QuantLib::ext::make_shared<EngineData>();
+    engineData->model("Swap") = "DiscountedCashflows";
+    engineData->engine("Swap") = "DiscountingSwapEngine";
+    auto factory = QuantLib::ext::make_shared<EngineFactory>(engineData, simMarket);
+
+    auto portfolio = QuantLib::ext::make_shared<Portfolio>();
+    portfolio->add(buildSwap("1_Swap_EUR", "EUR", true, 10000000.0, 0, 10, 0.03, 0.00, "1Y", "30/360", "6M", "A360",
+                             "EUR-EURIBOR-6M"));
+    portfolio->add(buildSwap("2_Swap_USD", "USD", true, 10000000.0, 0, 15, 0.02, 0.00, "6M", "30/360", "3M", "A360",
+                             "USD-LIBOR-3M"));
+    portfolio->build(factory);
+
+    // historical scenarios with small moves of all risk factors around the base scenario
+    auto baseScenario = simMarket->baseScenario();
+    auto loader = QuantLib::ext::make_shared<HistoricalScenarioLoader>();
+    Date d = Date(1, March, 2016);
+    for (Size i = 0; i < 5; ++i, d = TARGET().advance(d, 1 * Days)) {
+        auto s = QuantLib::ext::make_shared<SimpleScenario>(d);
+        Real factor = 1.0 + 0.01 * (i % 2 == 0 ? 1.0 : -1.0) * static_cast<Real>(i);
+        for (auto const& key : baseScenario->keys())
+            s->add(key, baseScenario->get(key) * factor);
+        loader->historicalScenarios().push_back(s);
+        loader->dates().push_back(d);
+    }
+    auto hisScenGen =
+        QuantLib::ext::make_shared<HistoricalScenarioGenerator>(loader, QuantLib::ext::make_shared<SimpleScenarioFactory>(true));
+    hisScenGen->baseScenario() = baseScenario;
+
+    auto cube = QuantLib::ext::make_shared<DoublePrecisionInMemoryCube>(today, portfolio->ids(), vector<Date>(1, today),
+                                                                        hisScenGen->numScenarios());
+    HistoricalPnlGenerator pnlGenerator(simMarketData->baseCcy(), portfolio, simMarket, hisScenGen, cube,
+                                        factory->modelBuilders());
+
+    vector<QuantLib::ext::shared_ptr<ScenarioFilter>> filters = {
+        QuantLib::ext::make_shared<RiskFilter>(MarketRiskConfiguration::RiskClass::All,
+                                               MarketRiskConfiguration::RiskType::All),
+        QuantLib::ext::make_shared<RiskFilter>(MarketRiskConfiguration::RiskClass::InterestRate,
+                                               MarketRiskConfiguration::RiskType::All),
+        QuantLib::ext::make_shared<RiskFilter>(MarketRiskConfiguration::RiskClass::FX,
+                                               MarketRiskConfiguration::RiskType::All)};
+
+    // reference results, one cube per filter
+    vector<vector<Real>> expectedPnl;
+    vector<HistoricalPnlGenerator::TradePnlStore> expectedTradePnl;
+    for (auto const& filter : filters) {
+        pnlGenerator.generateCube(filter);
+        expectedPnl.push_back(pnlGenerator.pnl());
+        expectedTradePnl.push_back(pnlGenerator.tradeLevelPnl());
+    }
+
+    // the fx filter moves the usd swap only, the ir filter both swaps
+    BOOST_REQUIRE_EQUAL(expectedPnl[0].size(), hisScenGen->numScenarios());
+    BOOST_CHECK(std::abs(expectedTradePnl[1][1][0]) > 1.0);
+    BOOST_CHECK(std::abs(expectedTradePnl[2][1][0]) < 1E-8);
+    BOOST_CHECK(std::abs(expectedTradePnl[2][1][1]) > 1.0);
+
+    pnlGenerator.generateCube(filters);
+    BOOST_REQUIRE_EQUAL(pnlGenerator.cube()->depth(), filters.size());
+
+    // the swaps only depend on ir risk factors, which are the same under the ir filter as under the preceding filter
+    // for all risk factors, so both swaps are skipped at least once per historical scenario
+    BOOST_TEST_MESSAGE("skipped " << pnlGenerator.skippedUpdates() << " out of "
+                                  << portfolio->size() * hisScenGen->numScenarios() * filters.size()
+                                  << " trade updates");
+    BOOST_CHECK(pnlGenerator.skippedUpdates() >= portfolio->size() * hisScenGen->numScenarios());
+
+    for (Size f = 0; f < filters.size(); ++f) {
+        pnlGenerator.setCubeDepth(f);
+        auto pnl = pnlGenerator.pnl();
+        auto tradePnl = pnlGenerator.tradeLevelPnl();
+        BOOST_REQUIRE_EQUAL(pnl.size(), expectedPnl[f].size());
+        BOOST_REQUIRE_EQUAL(tradePnl.size(), expectedTradePnl[f].size());
+        for (Size s = 0; s < pnl.size(); ++s) {
+            BOOST_CHECK_SMALL(pnl[s] - expectedPnl[f][s], 1E-6);
+            for (Size t = 0; t < tradePnl[s].size(); ++t)
+                BOOST_CHECK_SMALL(tradePnl[s][t] - expectedTradePnl[f][s][t], 1E-6);
+        }
+    }
+
+    BOOST_CHECK_THROW(pnlGenerator.setCubeDepth(filters.size()), QuantLib::Error);
+
+    // a single filter run resets the cube
+    pnlGenerator.generateCube(filters[1]);
+    BOOST_CHECK_EQUAL(pnlGenerator.cube()->depth(), 1);
+    BOOST_CHECK_EQUAL(pnlGenerator.skippedUpdates(), 0);
+    auto pnl = pnlGenerator.pnl();
+    for (Size s = 0; s < pnl.size(); ++s)
+        BOOST_CHECK_SMALL(pnl[s] - expectedPnl[1][s], 1E-6);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE_END()
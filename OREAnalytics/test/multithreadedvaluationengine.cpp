@@ -0,0 +1,384 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <boost/test/unit_test.hpp>
+#include <orea/cube/inmemorycube.hpp>
+#include <orea/cube/jointnpvcube.hpp>
+#include <orea/engine/multithreadedvaluationengine.hpp>
+#include <orea/engine/valuationcalculator.hpp>
+#include <orea/engine/valuationengine.hpp>
+#include <orea/engine/workstealingqueues.hpp>
+#include <orea/scenario/scenariogenerator.hpp>
+#include <orea/scenario/scenariosimmarket.hpp>
+#include <orea/scenario/scenariosimmarketparameters.hpp>
+#include <ored/configuration/curveconfigurations.hpp>
+#include <ored/configuration/yieldcurveconfig.hpp>
+#include <ored/marketdata/inmemoryloader.hpp>
+#include <ored/marketdata/todaysmarket.hpp>
+#include <ored/marketdata/todaysmarketparameters.hpp>
+#include <ored/portfolio/enginedata.hpp>
+#include <ored/portfolio/enginefactory.hpp>
+#include <ored/portfolio/portfolio.hpp>
+#include <ored/utilities/dategrid.hpp>
+#include <ored/utilities/to_string.hpp>
+#include <oret/toplevelfixture.hpp>
+#include <test/oreatoplevelfixture.hpp>
+#include <test/testportfolio.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+using namespace std;
+using namespace QuantLib;
+using namespace ore;
+using namespace ore::data;
+using namespace ore::analytics;
+
+using testsuite::buildSwap;
+
+namespace {
+
+// scales the values of the base scenario by factors depending on the sample, the date and the risk factor
+class ScaledScenarioGenerator : public ScenarioGenerator {
+public:
+    ScaledScenarioGenerator(const QuantLib::ext::shared_ptr<Scenario>& baseScenario, const Date& firstDate)
+        : baseScenario_(baseScenario), firstDate_(firstDate) {}
+
+    QuantLib::ext::shared_ptr<Scenario> next(const Date& d) override {
+        if (d == firstDate_)
+            ++sample_;
+        auto s = baseScenario_->clone();
+        s->setAsof(d);
+        s->setNumeraire(1.0);
+        Real factor = 1.0 + 0.002 * static_cast<Real>((7 * sample_ + d.serialNumber()) % 11) - 0.01;
+        Size k = 0;
+        for (auto const& key : baseScenario_->keys())
+            s->add(key, baseScenario_->get(key) * std::pow(factor, static_cast<Real>(++k % 5)));
+        return s;
+    }
+
+    void reset() override { sample_ = 0; }
+
+private:
+    QuantLib::ext::shared_ptr<Scenario> baseScenario_;
+    Date firstDate_;
+    Size sample_ = 0;
+};
+
+// a EUR market built from discount factor quotes, with one curve for discounting and the Euribor index
+struct MarketInputs {
+    explicit MarketInputs(const Date& today) {
+        loader = QuantLib::ext::make_shared<InMemoryLoader>();
+        vector<string> quotes;
+        for (Size y = 1; y <= 30; ++y) {
+            string name = "DISCOUNT/RATE/EUR/EUR-CURVE/" + ore::data::to_string(today + y * Years);
+            loader->add(today, name, std::exp(-(0.02 + 0.0005 * static_cast<Real>(y)) * static_cast<Real>(y)));
+            quotes.push_back(name);
+        }
+
+        curveConfigs = QuantLib::ext::make_shared<CurveConfigurations>();
+        vector<QuantLib::ext::shared_ptr<YieldCurveSegment>> segments{
+            QuantLib::ext::make_shared<DirectYieldCurveSegment>("Discount", "", quotes)};
+        curveConfigs->add(CurveSpec::CurveType::Yield, "EUR-CURVE",
+                          QuantLib::ext::make_shared<YieldCurveConfig>("EUR-CURVE", "EUR curve", "EUR", "", segments));
+
+        todaysMarketParams = QuantLib::ext::make_shared<TodaysMarketParameters>();
+        todaysMarketParams->addMarketObject(MarketObject::DiscountCurve, Market::defaultConfiguration,
+                                            {{"EUR", "Yield/EUR/EUR-CURVE"}});
+        todaysMarketParams->addMarketObject(MarketObject::IndexCurve, Market::defaultConfiguration,
+                                            {{"EUR-EURIBOR-6M", "Yield/EUR/EUR-CURVE"}});
+        todaysMarketParams->addConfiguration(Market::defaultConfiguration, MarketConfiguration());
+
+        simMarketData = QuantLib::ext::make_shared<ScenarioSimMarketParameters>();
+        simMarketData->baseCcy() = "EUR";
+        simMarketData->setDiscountCurveNames({"EUR"});
+        simMarketData->setYieldCurveTenors("", {6 * Months, 1 * Years, 2 * Years, 5 * Years, 10 * Years, 20 * Years});
+        simMarketData->setIndices({"EUR-EURIBOR-6M"});
+        simMarketData->interpolation() = "LogLinear";
+
+        engineData = QuantLib::ext::make_shared<EngineData>();
+        engineData->model("Swap") = "DiscountedCashflows";
+        engineData->engine("Swap") = "DiscountingSwapEngine";
+    }
+
+    QuantLib::ext::shared_ptr<InMemoryLoader> loader;
+    QuantLib::ext::shared_ptr<CurveConfigurations> curveConfigs;
+    QuantLib::ext::shared_ptr<TodaysMarketParameters> todaysMarketParams;
+    QuantLib::ext::shared_ptr<ScenarioSimMarketParameters> simMarketData;
+    QuantLib::ext::shared_ptr<EngineData> engineData;
+};
+
+// forward starting swaps, so that no fixings are required on the simulation dates
+QuantLib::ext::shared_ptr<Portfolio> swapPortfolio() {
+    auto portfolio = QuantLib::ext::make_shared<Portfolio>();
+    for (Size i = 0; i < 8; ++i) {
+        portfolio->add(buildSwap("Swap_" + std::to_string(i), "EUR", i % 2 == 0, 1000000.0 * static_cast<Real>(i + 1),
+                                 2, 5 + i, 0.02 + 0.001 * static_cast<Real>(i), 0.0, "1Y", "30/360", "6M", "A360",
+                                 "EUR-EURIBOR-6M"));
+    }
+    return portfolio;
+}
+
+// runs the multi-threaded valuation engine with 3 threads, 2 trade chunks per thread and 3 samples per unit
+QuantLib::ext::shared_ptr<NPVCube> multiThreadedCube(const MarketInputs& inputs, const Date& today,
+                                                     const QuantLib::ext::shared_ptr<DateGrid>& dateGrid,
+                                                     const Size nSamples,
+                                                     const QuantLib::ext::shared_ptr<Scenario>& baseScenario,
+                                                     const bool shareInitMarket,
+                                                     vector<MultiThreadedValuationEngine::WorkerStatistics>& stats) {
+    MultiThreadedValuationEngine engine(
+        3, today, dateGrid, nSamples, inputs.loader,
+        QuantLib::ext::make_shared<ScaledScenarioGenerator>(baseScenario, dateGrid->dates().front()),
+        inputs.engineData, inputs.curveConfigs, inputs.todaysMarketParams, Market::defaultConfiguration,
+        inputs.simMarketData);
+    engine.setWorkUnitGranularity(2, 3);
+    engine.setShareInitMarket(shareInitMarket);
+    engine.buildCube(swapPortfolio(), []() {
+        return vector<QuantLib::ext::shared_ptr<ValuationCalculator>>{QuantLib::ext::make_shared<NPVCalculator>("EUR")};
+    });
+    stats = engine.workerStatistics();
+    return QuantLib::ext::make_shared<JointNPVCube>(engine.outputCubes());
+}
+
+// checks that two cubes contain the same results
+void checkCubes(const QuantLib::ext::shared_ptr<NPVCube>& result, const QuantLib::ext::shared_ptr<NPVCube>& expected) {
+    BOOST_REQUIRE_EQUAL(result->numIds(), expected->numIds());
+    BOOST_REQUIRE_EQUAL(result->numDates(), expected->numDates());
+    BOOST_REQUIRE_EQUAL(result->samples(), expected->samples());
+    for (auto const& [id, index] : expected->idsAndIndexes()) {
+        BOOST_CHECK_SMALL(result->getT0(id) - expected->getT0(index), 1E-6);
+        for (Size d = 0; d < expected->numDates(); ++d) {
+            for (Size s = 0; s < expected->samples(); ++s) {
+                BOOST_CHECK_SMALL(result->get(id, expected->dates()[d], s) - expected->get(index, d, s), 1E-6);
+            }
+        }
+    }
+}
+
+// checks that all units are handed out exactly once
+void checkUnits(const vector<WorkUnit>& units, Size nChunks, Size unitsPerChunk) {
+    BOOST_REQUIRE_EQUAL(units.size(), nChunks * unitsPerChunk);
+    set<pair<Size, Size>> seen;
+    for (auto const& u : units)
+        seen.insert(make_pair(u.chunk, u.firstSample));
+    BOOST_CHECK_EQUAL(seen.size(), units.size());
+}
+
+} // namespace
+
+BOOST_FIXTURE_TEST_SUITE(OREAnalyticsTestSuite, ore::test::OreaTopLevelFixture)
+
+BOOST_AUTO_TEST_SUITE(MultiThreadedValuationEngineTest)
+
+BOOST_AUTO_TEST_CASE(testWorkStealingQueues) {
+
+    BOOST_TEST_MESSAGE("Testing work stealing queues...");
+
+    WorkUnit unit;
+    bool stolen;
+
+    // a thread processes its own queue in order, an idle thread steals a single unit from the back
+    WorkStealingQueues queues(2, 1, false);
+    for (Size s = 0; s < 3; ++s)
+        queues.push(0, WorkUnit{0, s, 1});
+    BOOST_CHECK(!queues.exhausted(0));
+    BOOST_REQUIRE(queues.next(0, unit, stolen));
+    BOOST_CHECK_EQUAL(unit.firstSample, 0);
+    BOOST_CHECK(!stolen);
+    BOOST_REQUIRE(queues.next(1, unit, stolen));
+    BOOST_CHECK_EQUAL(unit.firstSample, 2);
+    BOOST_CHECK(stolen);
+    BOOST_REQUIRE(queues.next(0, unit, stolen));
+    BOOST_CHECK_EQUAL(unit.firstSample, 1);
+    BOOST_CHECK(!stolen);
+    BOOST_CHECK(queues.exhausted(0));
+    BOOST_CHECK(!queues.next(0, unit, stolen));
+    BOOST_CHECK(!queues.next(1, unit, stolen));
+}
+
+BOOST_AUTO_TEST_CASE(testWorkStealingQueuesPinnedChunks) {
+
+    BOOST_TEST_MESSAGE("Testing work stealing queues with pinned chunks...");
+
+    WorkUnit unit;
+    bool stolen;
+
+    // a thread steals all units of a chunk the victim has not started and never a unit of a started chunk
+    WorkStealingQueues queues(2, 2, true);
+    for (Size c = 0; c < 2; ++c) {
+        for (Size s = 0; s < 2; ++s)
+            queues.push(0, WorkUnit{c, s, 1});
+    }
+    BOOST_REQUIRE(queues.next(0, unit, stolen));
+    BOOST_CHECK_EQUAL(unit.chunk, 0);
+    BOOST_REQUIRE(queues.next(1, unit, stolen));
+    BOOST_CHECK_EQUAL(unit.chunk, 1);
+    BOOST_CHECK_EQUAL(unit.firstSample, 0);
+    BOOST_CHECK(stolen);
+    BOOST_REQUIRE(queues.next(1, unit, stolen));
+    BOOST_CHECK_EQUAL(unit.chunk, 1);
+    BOOST_CHECK_EQUAL(unit.firstSample, 1);
+    BOOST_CHECK(!stolen);
+    BOOST_CHECK(queues.exhausted(1));
+    BOOST_CHECK(!queues.exhausted(0));
+    BOOST_CHECK(!queues.next(1, unit, stolen));
+    BOOST_REQUIRE(queues.next(0, unit, stolen));
+    BOOST_CHECK_EQUAL(unit.chunk, 0);
+    BOOST_CHECK_EQUAL(unit.firstSample, 1);
+    BOOST_CHECK(queues.exhausted(0));
+    BOOST_CHECK(!queues.next(0, unit, stolen));
+}
+
+BOOST_AUTO_TEST_CASE(testWorkStealingQueuesConcurrent) {
+
+    BOOST_TEST_MESSAGE("Testing work stealing queues on several threads...");
+
+    const Size nThreads = 4, nChunks = 8, unitsPerChunk = 50;
+
+    for (bool pinChunks : {false, true}) {
+        // all units are pushed to the first queue, so that the other threads only get work by stealing
+        WorkStealingQueues queues(nThreads, nChunks, pinChunks);
+        for (Size c = 0; c < nChunks; ++c) {
+            for (Size s = 0; s < unitsPerChunk; ++s)
+                queues.push(0, WorkUnit{c, s, 1});
+        }
+        vector<vector<WorkUnit>> processed(nThreads);
+        vector<Size> stolenUnits(nThreads, 0);
+        vector<std::thread> threads;
+        for (Size t = 0; t < nThreads; ++t) {
+            threads.emplace_back([&queues, &processed, &stolenUnits, t]() {
+                WorkUnit unit;
+                bool stolen;
+                while (queues.next(t, unit, stolen)) {
+                    processed[t].push_back(unit);
+                    if (stolen)
+                        ++stolenUnits[t];
+                }
+            });
+        }
+        for (auto& t : threads)
+            t.join();
+
+        vector<WorkUnit> all;
+        for (Size t = 0; t < nThreads; ++t) {
+            all.insert(all.end(), processed[t].begin(), processed[t].end());
+            BOOST_CHECK(stolenUnits[t] <= processed[t].size());
+        }
+        checkUnits(all, nChunks, unitsPerChunk);
+        BOOST_CHECK_EQUAL(stolenUnits[0], 0);
+        for (Size c = 0; c < nChunks; ++c)
+            BOOST_CHECK(queues.exhausted(c));
+
+        // with pinned chunks all units of a chunk are processed by one thread
+        if (pinChunks) {
+            for (Size c = 0; c < nChunks; ++c) {
+                Size nThreadsOfChunk = 0;
+                for (Size t = 0; t < nThreads; ++t) {
+                    if (std::any_of(processed[t].begin(), processed[t].end(),
+                                    [c](const WorkUnit& u) { return u.chunk == c; }))
+                        ++nThreadsOfChunk;
+                }
+                BOOST_CHECK_EQUAL(nThreadsOfChunk, 1);
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(testMultiThreadedCube) {
+
+    BOOST_TEST_MESSAGE("Testing multi-threaded valuation engine against the single-threaded engine...");
+
+#ifndef QL_ENABLE_SESSIONS
+    BOOST_TEST_MESSAGE("QuantLib is built without sessions, the multi-threaded valuation engine is not available");
+#else
+    Date today(14, April, 2016);
+    Settings::instance().evaluationDate() = today;
+
+    MarketInputs inputs(today);
+    auto dateGrid = QuantLib::ext::make_shared<DateGrid>("3,6M");
+    const Size nSamples = 10;
+
+    // single-threaded reference cube
+    auto initMarket = QuantLib::ext::make_shared<TodaysMarket>(today, inputs.todaysMarketParams, inputs.loader,
+                                                               inputs.curveConfigs);
+    auto simMarket = QuantLib::ext::make_shared<ScenarioSimMarket>(initMarket, inputs.simMarketData);
+    auto baseScenario = simMarket->baseScenario();
+    simMarket->scenarioGenerator() =
+        QuantLib::ext::make_shared<ScaledScenarioGenerator>(baseScenario, dateGrid->dates().front());
+    auto factory = QuantLib::ext::make_shared<EngineFactory>(inputs.engineData, simMarket);
+    auto portfolio = swapPortfolio();
+    portfolio->build(factory);
+    QuantLib::ext::shared_ptr<NPVCube> expected = QuantLib::ext::make_shared<DoublePrecisionInMemoryCube>(
+        today, portfolio->ids(), dateGrid->valuationDates(), nSamples);
+    ValuationEngine valEngine(today, dateGrid, simMarket, factory->modelBuilders());
+    valEngine.buildCube(portfolio, expected, {QuantLib::ext::make_shared<NPVCalculator>("EUR")});
+
+    // multi-threaded cube with several sample blocks per trade chunk
+    vector<MultiThreadedValuationEngine::WorkerStatistics> stats;
+    checkCubes(multiThreadedCube(inputs, today, dateGrid, nSamples, baseScenario, false, stats), expected);
+
+    // 6 trade chunks with 4 sample blocks each are processed by the 3 threads
+    BOOST_REQUIRE_EQUAL(stats.size(), 3);
+    Size units = 0;
+    for (auto const& s : stats) {
+        units += s.units;
+        BOOST_CHECK(s.stolenUnits <= s.units);
+        BOOST_CHECK(s.totalTime >= s.busyTime);
+        BOOST_CHECK(s.totalTime >= s.setupTime);
+    }
+    BOOST_CHECK_EQUAL(units, 24);
+#endif
+}
+
+BOOST_AUTO_TEST_CASE(testSharedInitMarket) {
+
+    BOOST_TEST_MESSAGE("Testing multi-threaded valuation engine with a shared init market...");
+
+#if !defined(QL_ENABLE_SESSIONS) || !defined(QL_ENABLE_THREAD_SAFE_OBSERVER_PATTERN)
+    BOOST_TEST_MESSAGE("QuantLib is built without sessions or the thread safe observer pattern, the init market can "
+                       "not be shared between threads");
+#else
+    Date today(14, April, 2016);
+    Settings::instance().evaluationDate() = today;
+
+    MarketInputs inputs(today);
+    auto dateGrid = QuantLib::ext::make_shared<DateGrid>("3,6M");
+    const Size nSamples = 10;
+
+    auto initMarket = QuantLib::ext::make_shared<TodaysMarket>(today, inputs.todaysMarketParams, inputs.loader,
+                                                               inputs.curveConfigs);
+    auto baseScenario = QuantLib::ext::make_shared<ScenarioSimMarket>(initMarket, inputs.simMarketData)->baseScenario();
+
+    // the cube built on per-thread markets is the reference
+    vector<MultiThreadedValuationEngine::WorkerStatistics> stats;
+    auto expected = multiThreadedCube(inputs, today, dateGrid, nSamples, baseScenario, false, stats);
+    auto result = multiThreadedCube(inputs, today, dateGrid, nSamples, baseScenario, true, stats);
+    checkCubes(result, expected);
+
+    // the trade chunks are pinned to the threads in this mode, so all units are processed
+    Size units = 0;
+    for (auto const& s : stats)
+        units += s.units;
+    BOOST_CHECK_EQUAL(units, 24);
+#endif
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE_END()
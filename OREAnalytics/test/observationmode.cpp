@@ -144,7 +144,15 @@ QuantLib::ext::shared_ptr<Portfolio> buildPortfolio(QuantLib::ext::shared_ptr<En
     return portfolio;
 }
 
-void simulation(string dateGridString, bool checkFixings) {
+// counts the notifications of the observed sim market curves
+class UpdateCounter : public Observer {
+public:
+    void update() override { ++updates; }
+    Size updates = 0;
+};
+
+// returns the npv cube and the number of notifications of the sim market discount and index curves
+std::pair<QuantLib::ext::shared_ptr<NPVCube>, Size> simulation(string dateGridString, bool checkFixings) {
     SavedSettings backup;
 
     // Log::instance().registerLogger(QuantLib::ext::make_shared<StderrLogger>());
@@ -323,11 +331,33 @@ void simulation(string dateGridString, bool checkFixings) {
         QuantLib::ext::make_shared<DoublePrecisionInMemoryCube>(today, portfolio->ids(), dg->dates(), samples);
     vector<QuantLib::ext::shared_ptr<ValuationCalculator>> calculators;
     calculators.push_back(QuantLib::ext::make_shared<NPVCalculator>(baseCcy));
+    UpdateCounter curveUpdates;
+    for (auto const& ccy : parameters->discountCurveNames())
+        curveUpdates.registerWith(simMarket->discountCurve(ccy));
+    for (auto const& index : parameters->indices())
+        curveUpdates.registerWith(simMarket->iborIndex(index)->forwardingTermStructure());
+    auto counters = simMarket->notificationCounters();
     valEngine.buildCube(portfolio, cube, calculators);
     t.stop();
 
     BOOST_TEST_MESSAGE("Cube generated in " << t.format(default_places, "%w") << " seconds");
 
+    // each scenario writes all sim market quotes, only the changed ones notify, in mode Batch once per curve
+    Size scenarios = simMarket->notificationCounters().scenarios - counters.scenarios;
+    Size quoteUpdates = simMarket->notificationCounters().quoteUpdates - counters.quoteUpdates;
+    Size changedQuotes = simMarket->notificationCounters().changedQuotes - counters.changedQuotes;
+    Size notifications = simMarket->notificationCounters().notifications - counters.notifications;
+    BOOST_TEST_MESSAGE("Applied " << scenarios << " scenarios with " << quoteUpdates << " quote updates, "
+                                  << changedQuotes << " changed quotes and " << notifications
+                                  << " notifications, the curves notified " << curveUpdates.updates << " times");
+    BOOST_CHECK_EQUAL(scenarios, samples * dg->dates().size());
+    BOOST_CHECK(changedQuotes > 0);
+    BOOST_CHECK(changedQuotes <= quoteUpdates);
+    if (ObservationMode::instance().mode() == ObservationMode::Mode::Batch)
+        BOOST_CHECK(notifications < changedQuotes);
+    else
+        BOOST_CHECK_EQUAL(notifications, changedQuotes);
+
     map<string, vector<Real>> referenceFixings;
     // First 10 EUR-EURIBOR-6M fixings at dateIndex 5, date grid 11,1Y
     referenceFixings["11,1Y"] = {0.00739033, 0.0281673, 0.0344399, 0.03362,   0.0325276, 0.030573,
@@ -353,6 +383,8 @@ void simulation(string dateGridString, bool checkFixings) {
                 BOOST_FAIL("Stored fixing differs from reference value, found " << fix << ", expected " << ref);
         }
     }
+
+    return std::make_pair(cube, curveUpdates.updates);
 }
 
 BOOST_FIXTURE_TEST_SUITE(OREAnalyticsTestSuite, ore::test::OreaTopLevelFixture)
@@ -432,6 +464,50 @@ BOOST_AUTO_TEST_CASE(testDefer) {
     simulation("10,1Y", true);
 }
 
+BOOST_AUTO_TEST_CASE(testBatch) {
+    ObservationMode::instance().setMode(ObservationMode::Mode::Batch);
+    setConventions();
+
+    BOOST_TEST_MESSAGE("Testing Observation Mode Batch, Long Grid, No Fixing Checks");
+    simulation("11,1Y", false);
+
+    BOOST_TEST_MESSAGE("Testing Observation Mode Batch, Long Grid, With Fixing Checks");
+    simulation("11,1Y", true);
+
+    BOOST_TEST_MESSAGE("Testing Observation Mode Batch, Short Grid, No Fixing Checks");
+    simulation("10,1Y", false);
+
+    BOOST_TEST_MESSAGE("Testing Observation Mode Batch, Short Grid, With Fixing Checks");
+    simulation("10,1Y", true);
+
+    BOOST_CHECK(ObservableSettings::instance().updatesEnabled());
+}
+
+BOOST_AUTO_TEST_CASE(testBatchAgainstNone) {
+    setConventions();
+
+    BOOST_TEST_MESSAGE("Testing Observation Mode Batch against None");
+
+    ObservationMode::instance().setMode(ObservationMode::Mode::None);
+    auto none = simulation("10,1Y", false);
+    ObservationMode::instance().setMode(ObservationMode::Mode::Batch);
+    auto batch = simulation("10,1Y", false);
+
+    // identical npvs, but the curves notify once per scenario instead of once per changed quote
+    const NPVCube& noneCube = *none.first;
+    const NPVCube& batchCube = *batch.first;
+    BOOST_REQUIRE_EQUAL(batchCube.numIds(), noneCube.numIds());
+    for (Size i = 0; i < noneCube.numIds(); ++i) {
+        BOOST_CHECK_CLOSE(batchCube.getT0(i), noneCube.getT0(i), 1E-10);
+        for (Size d = 0; d < noneCube.numDates(); ++d)
+            for (Size s = 0; s < noneCube.samples(); ++s)
+                BOOST_CHECK_CLOSE(batchCube.get(i, d, s), noneCube.get(i, d, s), 1E-10);
+    }
+    BOOST_TEST_MESSAGE("Curve notifications: None " << none.second << ", Batch " << batch.second);
+    BOOST_CHECK(batch.second > 0);
+    BOOST_CHECK(batch.second < none.second);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE_END()
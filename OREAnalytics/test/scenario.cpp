@@ -9,6 +9,8 @@ All rights reserved.
 #include <orea/scenario/simplescenario.hpp>
 #include <orea/scenario/simplescenariofactory.hpp>
 #include <orea/scenario/csvscenariogenerator.hpp>
+#include <orea/scenario/binaryscenariofile.hpp>
+#include <orea/scenario/historicalscenariofilereader.hpp>
 
 using namespace boost::unit_test_framework;
 using namespace QuantLib;
@@ -87,6 +89,86 @@ BOOST_AUTO_TEST_CASE(testCSVScenarioGenerator) {
     remove("test_csv_scenario_generator.csv");
 }
 
+BOOST_AUTO_TEST_CASE(testBinaryScenarioFile) {
+
+    // Make up three samples on two dates each, the keys are deliberately not sorted
+    vector<Date> dates = {Date(21, Dec, 2016), Date(22, Dec, 2016)};
+    vector<RiskFactorKey> rfks = {{RiskFactorKey::KeyType::YieldCurve, "CHF-LIBOR", 1},
+                                  {RiskFactorKey::KeyType::DiscountCurve, "CHF", 0},
+                                  {RiskFactorKey::KeyType::DiscountCurve, "CHF", 2},
+                                  {RiskFactorKey::KeyType::FXSpot, "CHF"},
+                                  {RiskFactorKey::KeyType::SwaptionVolatility, "SwapVol"}};
+
+    QuantLib::ext::shared_ptr<TestScenarioGenerator> tsg = QuantLib::ext::make_shared<TestScenarioGenerator>();
+    for (Size i = 0; i < 3; ++i) {
+        for (auto const& d : dates) {
+            auto s = QuantLib::ext::make_shared<SimpleScenario>(d, std::string(), 1.0 + 0.1 * i);
+            for (auto rf : rfks)
+                s->add(rf, rand());
+            tsg->addScenario(s);
+        }
+    }
+
+    // Write scenarios to file
+    string filename = "test_binary_scenario_generator.bin";
+    ScenarioWriter sw(tsg, filename);
+    tsg->reset();
+    for (auto const& s : tsg->scenarios)
+        sw.next(s->asof());
+    sw.reset();
+
+    // Random access to the file
+    BinaryScenarioFile file(filename);
+    BOOST_REQUIRE_EQUAL(file.size(), tsg->scenarios.size());
+    BOOST_CHECK_EQUAL_COLLECTIONS(file.keys().begin(), file.keys().end(), rfks.begin(), rfks.end());
+    for (Size i = tsg->scenarios.size(); i > 0; --i) {
+        auto const& s = tsg->scenarios[i - 1];
+        BOOST_CHECK_EQUAL(file.date(i - 1), s->asof());
+        BOOST_CHECK_EQUAL(file.scenarioNumber(i - 1), (i - 1) / dates.size() + 1);
+        BOOST_CHECK_EQUAL(file.numeraire(i - 1), s->getNumeraire());
+        for (Size k = 0; k < rfks.size(); ++k)
+            BOOST_CHECK_EQUAL(file.values(i - 1)[k], s->get(rfks[k]));
+    }
+    BOOST_CHECK_THROW(file.date(tsg->scenarios.size()), QuantLib::Error);
+
+    // Read in scenarios from file via the scenario generator, the scenarios share the keys of the file
+    QuantLib::ext::shared_ptr<SimpleScenarioFactory> ssf = QuantLib::ext::make_shared<SimpleScenarioFactory>(true);
+    CSVScenarioGenerator gen(filename, ssf);
+    for (Size pass = 0; pass < 2; ++pass) {
+        if (pass > 0)
+            gen.reset();
+        for (auto const& expected : tsg->scenarios) {
+            QuantLib::ext::shared_ptr<Scenario> s = gen.next(expected->asof());
+            BOOST_CHECK_EQUAL(s->keysHash(), file.scenario(0)->keysHash());
+            BOOST_CHECK_EQUAL(s->getNumeraire(), expected->getNumeraire());
+            BOOST_CHECK_EQUAL_COLLECTIONS(s->keys().begin(), s->keys().end(), expected->keys().begin(),
+                                          expected->keys().end());
+            for (auto rfk : s->keys())
+                BOOST_CHECK_EQUAL(s->get(rfk), expected->get(rfk));
+        }
+    }
+    BOOST_CHECK_THROW(gen.next(dates[0]), QuantLib::Error);
+
+    // Read in scenarios from file via the historical scenario reader
+    {
+        HistoricalScenarioFileReader reader(filename, ssf);
+        Size i = 0;
+        while (reader.next()) {
+            BOOST_REQUIRE(i < tsg->scenarios.size());
+            auto const& expected = tsg->scenarios[i++];
+            BOOST_CHECK_EQUAL(reader.date(), expected->asof());
+            QuantLib::ext::shared_ptr<Scenario> s = reader.scenario();
+            BOOST_CHECK_EQUAL(s->getNumeraire(), expected->getNumeraire());
+            for (auto rfk : rfks)
+                BOOST_CHECK_EQUAL(s->get(rfk), expected->get(rfk));
+        }
+        BOOST_CHECK_EQUAL(i, tsg->scenarios.size());
+        BOOST_CHECK(reader.scenario() == nullptr);
+    }
+
+    remove("test_binary_scenario_generator.bin");
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE_END()
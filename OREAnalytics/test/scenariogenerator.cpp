@@ -40,6 +40,7 @@
 #include <qle/models/fxbspiecewiseconstantparametrization.hpp>
 #include <qle/models/irlgm1fpiecewiseconstantparametrization.hpp>
 #include <qle/models/lgm.hpp>
+#include <qle/models/modelimpliedyieldtermstructure.hpp>
 #include <qle/pricingengines/analyticcclgmfxoptionengine.hpp>
 #include <qle/pricingengines/analyticdkcpicapfloorengine.hpp>
 #include <qle/pricingengines/analyticlgmswaptionengine.hpp>
@@ -481,6 +482,129 @@ BOOST_AUTO_TEST_CASE(testCrossAssetLowDiscrepancyBrownianBridge) {
     test_crossasset(true, false, true);
 }
 
+BOOST_AUTO_TEST_CASE(testCrossAssetPathBlocks) {
+    BOOST_TEST_MESSAGE("Testing CrossAssetScenarioGenerator with path blocks...");
+    setConventions();
+
+    TestData d;
+
+    Date today = d.referenceDate;
+    std::vector<Period> tenorGrid = {1 * Years, 2 * Years, 3 * Years, 5 * Years, 7 * Years, 10 * Years};
+    QuantLib::ext::shared_ptr<DateGrid> grid = QuantLib::ext::make_shared<DateGrid>(tenorGrid);
+    QuantLib::ext::shared_ptr<QuantExt::CrossAssetModel> model = d.ccLgm;
+    QuantLib::ext::shared_ptr<StochasticProcess> stateProcess = model->stateProcess();
+
+    QuantLib::ext::shared_ptr<ScenarioSimMarketParameters> simMarketConfig(new ScenarioSimMarketParameters);
+    simMarketConfig->setYieldCurveTenors("", {3 * Months, 6 * Months, 1 * Years, 2 * Years, 5 * Years, 10 * Years,
+                                              20 * Years, 30 * Years});
+    simMarketConfig->setSimulateFXVols(false);
+    simMarketConfig->setSimulateEquityVols(false);
+    simMarketConfig->baseCcy() = "EUR";
+    simMarketConfig->setDiscountCurveNames({"EUR", "USD", "GBP"});
+    simMarketConfig->setIndices({"EUR-EURIBOR-6M", "USD-LIBOR-3M", "GBP-LIBOR-6M"});
+    simMarketConfig->setFxCcyPairs({"USDEUR", "GBPEUR"});
+    simMarketConfig->setCpiIndices({"UKRPI", "EUHICPXT"});
+
+    // path by path with a separate data block per scenario vs. blocks of 7 paths with a shared data block
+    auto buildGenerator = [&](const Size pathBlockSize, const bool sharedDataBlock) {
+        auto pathGen = QuantLib::ext::make_shared<MultiPathGeneratorSobolBrownianBridge>(
+            stateProcess, grid->timeGrid(), SobolBrownianGenerator::Diagonal, 42);
+        return QuantLib::ext::make_shared<CrossAssetModelScenarioGenerator>(
+            model, pathGen, QuantLib::ext::make_shared<SimpleScenarioFactory>(sharedDataBlock), simMarketConfig,
+            today, grid, d.market, Market::defaultConfiguration, pathBlockSize);
+    };
+    auto scenGen1 = buildGenerator(1, false);
+    auto scenGen7 = buildGenerator(7, true);
+
+    Size samples = 20;
+    std::vector<QuantLib::ext::shared_ptr<Scenario>> firstPath;
+    for (Size run = 0; run < 2; ++run) {
+        scenGen1->reset();
+        scenGen7->reset();
+        for (Size i = 0; i < samples; ++i) {
+            for (Date d : grid->dates()) {
+                auto s1 = scenGen1->next(d);
+                auto s7 = scenGen7->next(d);
+                if (run == 0 && i == 0)
+                    firstPath.push_back(s7);
+                BOOST_REQUIRE(s1->keys() == s7->keys());
+                BOOST_CHECK_CLOSE(s1->getNumeraire(), s7->getNumeraire(), 1E-10);
+                for (auto const& key : s1->keys())
+                    BOOST_CHECK_CLOSE(s1->get(key), s7->get(key), 1E-10);
+                // after a reset we get the same paths again, although the generator was reset within a block
+                if (run == 1 && i == 0) {
+                    Size idx = std::distance(grid->dates().begin(),
+                                             std::find(grid->dates().begin(), grid->dates().end(), d));
+                    for (auto const& key : s7->keys())
+                        BOOST_CHECK_EQUAL(s7->get(key), firstPath[idx]->get(key));
+                }
+            }
+        }
+        // leave the generators in the middle of a block before the reset
+        for (Date d : grid->dates()) {
+            scenGen1->next(d);
+            scenGen7->next(d);
+        }
+    }
+
+    // the discount and index curves are computed from precomputed lgm coefficients, check them against the model
+    // implied term structures for the same states
+    Size nDates = grid->dates().size(), nStates = stateProcess->size();
+    std::vector<Real> states(nDates * nStates * samples);
+    std::vector<std::vector<Real*>> paths(nDates, std::vector<Real*>(nStates));
+    for (Size i = 0; i < nDates; ++i)
+        for (Size j = 0; j < nStates; ++j)
+            paths[i][j] = &states[(i * nStates + j) * samples];
+    MultiPathGeneratorSobolBrownianBridge(stateProcess, grid->timeGrid(), SobolBrownianGenerator::Diagonal, 42)
+        .nextBlock(samples, paths);
+
+    struct ReferenceCurve {
+        RiskFactorKey::KeyType keyType;
+        std::string name;
+        Size ccyIndex;
+        QuantLib::ext::shared_ptr<ModelImpliedYieldTermStructure> ts;
+        bool timeBased;
+    };
+    DayCounter dc = model->irModel(0)->termStructure()->dayCounter();
+    std::vector<ReferenceCurve> referenceCurves;
+    for (Size j = 0; j < model->components(CrossAssetModel::AssetType::IR); ++j) {
+        referenceCurves.push_back(
+            {RiskFactorKey::KeyType::DiscountCurve, model->parametrizations()[j]->currency().code(), j,
+             QuantLib::ext::make_shared<ModelImpliedYieldTermStructure>(model->irModel(j), dc, true), true});
+    }
+    for (auto const& name : simMarketConfig->indices()) {
+        auto index = *d.market->iborIndex(name);
+        Size j = model->ccyIndex(index->currency());
+        referenceCurves.push_back({RiskFactorKey::KeyType::IndexCurve, name, j,
+                                   QuantLib::ext::make_shared<ModelImpliedYtsFwdFwdCorrected>(
+                                       model->irModel(j), index->forwardingTermStructure(), dc, false),
+                                   false});
+    }
+
+    scenGen7->reset();
+    for (Size p = 0; p < samples; ++p) {
+        auto path = scenGen7->nextPath();
+        for (Size i = 0; i < nDates; ++i) {
+            Date date = grid->dates()[i];
+            for (auto const& c : referenceCurves) {
+                Size irIdx = model->pIdx(CrossAssetModel::AssetType::IR, c.ccyIndex);
+                Array x(model->irModel(c.ccyIndex)->n());
+                for (Size k = 0; k < x.size(); ++k)
+                    x[k] = states[(i * nStates + irIdx + k) * samples + p];
+                if (c.timeBased)
+                    c.ts->move(grid->timeGrid()[i + 1], x);
+                else
+                    c.ts->move(date, x);
+                const std::vector<Period>& tenors = simMarketConfig->yieldCurveTenors(c.name);
+                for (Size k = 0; k < tenors.size(); ++k) {
+                    Real expected = std::max(c.ts->discount(dc.yearFraction(date, date + tenors[k])), 0.00001);
+                    BOOST_CHECK_CLOSE(path[i]->get(RiskFactorKey(c.keyType, c.name, k)), expected, 1E-8);
+                }
+            }
+        }
+    }
+}
+
 BOOST_AUTO_TEST_CASE(testCrossAssetSimMarket) {
     BOOST_TEST_MESSAGE("Testing CrossAssetScenarioGenerator via SimMarket (Martingale tests)...");
     setConventions();
@@ -815,6 +815,99 @@ void testPortfolioSensitivity(ObservationMode::Mode om) {
     ObservationMode::instance().setMode(backupMode);
     IndexManager::instance().clearHistories();
 }
+
+void testSkipUnchangedTrades(ObservationMode::Mode om) {
+    SavedSettings backup;
+
+    ObservationMode::Mode backupMode = ObservationMode::instance().mode();
+    ObservationMode::instance().setMode(om);
+
+    Date today = Date(14, April, 2016);
+    Settings::instance().evaluationDate() = today;
+
+    QuantLib::ext::shared_ptr<Market> initMarket = QuantLib::ext::make_shared<TestMarket>(today);
+    QuantLib::ext::shared_ptr<analytics::ScenarioSimMarketParameters> simMarketData =
+        TestConfigurationObjects::setupSimMarketData5();
+    QuantLib::ext::shared_ptr<SensitivityScenarioData> sensiData =
+        TestConfigurationObjects::setupSensitivityScenarioData5();
+
+    QuantLib::ext::shared_ptr<EngineData> data = QuantLib::ext::make_shared<EngineData>();
+    data->model("Swap") = "DiscountedCashflows";
+    data->engine("Swap") = "DiscountingSwapEngine";
+    data->model("EuropeanSwaption") = "BlackBachelier";
+    data->engine("EuropeanSwaption") = "BlackBachelierSwaptionEngine";
+    data->model("FxOption") = "GarmanKohlhagen";
+    data->engine("FxOption") = "AnalyticEuropeanEngine";
+    data->model("CapFloor") = "IborCapModel";
+    data->engine("CapFloor") = "IborCapEngine";
+    data->model("CapFlooredIborLeg") = "BlackOrBachelier";
+    data->engine("CapFlooredIborLeg") = "BlackIborCouponPricer";
+
+    QuantLib::ext::shared_ptr<Portfolio> portfolio(new Portfolio());
+    portfolio->add(buildSwap("1_Swap_EUR", "EUR", true, 10000000.0, 0, 10, 0.03, 0.00, "1Y", "30/360", "6M", "A360",
+                             "EUR-EURIBOR-6M"));
+    portfolio->add(buildSwap("2_Swap_USD", "USD", true, 10000000.0, 0, 15, 0.02, 0.00, "6M", "30/360", "3M", "A360",
+                             "USD-LIBOR-3M"));
+    portfolio->add(buildEuropeanSwaption("6_Swaption_EUR", "Long", "EUR", true, 1000000.0, 2, 5, 0.02, 0.00, "1Y",
+                                         "30/360", "6M", "A360", "EUR-EURIBOR-6M", "Physical"));
+    portfolio->add(buildFxOption("7_FxOption_EUR_USD", "Long", "Call", 3, "EUR", 10000000.0, "USD", 11000000.0));
+    portfolio->add(buildCap("9_Cap_EUR", "EUR", "Long", 0.05, 1000000.0, 0, 10, "6M", "A360", "EUR-EURIBOR-6M"));
+    portfolio->add(buildFloor("10_Floor_USD", "USD", "Long", 0.01, 1000000.0, 0, 10, "3M", "A360", "USD-LIBOR-3M"));
+
+    // the cubes with and without skipping of unchanged trades must be identical
+    auto checkCubes = [](const NPVCube& cube, const NPVCube& refCube) {
+        BOOST_REQUIRE_EQUAL(cube.numIds(), refCube.numIds());
+        BOOST_REQUIRE_EQUAL(cube.samples(), refCube.samples());
+        for (Size i = 0; i < cube.numIds(); ++i) {
+            BOOST_CHECK_EQUAL(cube.getT0(i, 0), refCube.getT0(i, 0));
+            for (Size j = 0; j < cube.samples(); ++j)
+                BOOST_CHECK_EQUAL(cube.get(i, 0, j, 0), refCube.get(i, 0, j, 0));
+        }
+    };
+
+    // valuation engine on a sensitivity scenario generator
+    auto simMarket = QuantLib::ext::make_shared<analytics::ScenarioSimMarket>(initMarket, simMarketData);
+    QuantLib::ext::shared_ptr<Scenario> baseScenario = simMarket->baseScenario();
+    auto scenarioFactory = QuantLib::ext::make_shared<CloneScenarioFactory>(baseScenario);
+    auto scenarioGenerator = QuantLib::ext::make_shared<SensitivityScenarioGenerator>(
+        sensiData, baseScenario, simMarketData, simMarket, scenarioFactory, false);
+    simMarket->scenarioGenerator() = scenarioGenerator;
+    auto factory = QuantLib::ext::make_shared<EngineFactory>(data, simMarket);
+    portfolio->build(factory);
+    BOOST_REQUIRE_EQUAL(portfolio->size(), 6);
+
+    auto dg = QuantLib::ext::make_shared<DateGrid>("1,0W");
+    vector<QuantLib::ext::shared_ptr<ValuationCalculator>> calculators;
+    calculators.push_back(QuantLib::ext::make_shared<NPVCalculator>(simMarketData->baseCcy()));
+    std::vector<QuantLib::ext::shared_ptr<NPVCube>> cubes;
+    std::vector<Size> skippedUpdates;
+    for (bool skip : {false, true}) {
+        cubes.push_back(QuantLib::ext::make_shared<DoublePrecisionInMemoryCube>(
+            today, portfolio->ids(), vector<Date>(1, today), scenarioGenerator->samples()));
+        ValuationEngine engine(today, dg, simMarket, factory->modelBuilders());
+        engine.setSkipUnchangedTrades(skip);
+        engine.buildCube(portfolio, cubes.back(), calculators);
+        skippedUpdates.push_back(engine.skippedUpdates());
+    }
+    BOOST_TEST_MESSAGE("skipped " << skippedUpdates[1] << " out of " << portfolio->size() * scenarioGenerator->samples()
+                                  << " trade updates");
+    BOOST_CHECK_EQUAL(skippedUpdates[0], 0);
+    BOOST_CHECK(skippedUpdates[1] > 0);
+    checkCubes(*cubes[1], *cubes[0]);
+
+    // sensitivity analysis
+    std::vector<QuantLib::ext::shared_ptr<SensitivityAnalysis>> analyses;
+    for (bool skip : {false, true}) {
+        analyses.push_back(QuantLib::ext::make_shared<SensitivityAnalysis>(
+            portfolio, initMarket, Market::defaultConfiguration, data, simMarketData, sensiData, false));
+        analyses.back()->skipUnchangedTrades(skip);
+        analyses.back()->generateSensitivities();
+    }
+    checkCubes(*analyses[1]->sensiCube()->npvCube(), *analyses[0]->sensiCube()->npvCube());
+
+    ObservationMode::instance().setMode(backupMode);
+    IndexManager::instance().clearHistories();
+}
 } // namespace
 
 BOOST_FIXTURE_TEST_SUITE(OREAnalyticsTestSuite, ore::test::OreaTopLevelFixture)
@@ -841,6 +934,16 @@ BOOST_AUTO_TEST_CASE(testPortfolioSensitivityUnregisterObs) {
     testPortfolioSensitivity(ObservationMode::Mode::Unregister);
 }
 
+BOOST_AUTO_TEST_CASE(testSkipUnchangedTradesDisableObs) {
+    BOOST_TEST_MESSAGE("Testing skipping of unchanged trades in sensitivity runs (Disable observation mode)");
+    testSkipUnchangedTrades(ObservationMode::Mode::Disable);
+}
+
+BOOST_AUTO_TEST_CASE(testSkipUnchangedTradesUnregisterObs) {
+    BOOST_TEST_MESSAGE("Testing skipping of unchanged trades in sensitivity runs (Unregister observation mode)");
+    testSkipUnchangedTrades(ObservationMode::Mode::Unregister);
+}
+
 void test1dShifts(bool granular) {
     BOOST_TEST_MESSAGE("Testing 1d shifts " << (granular ? "granular" : "sparse"));
 
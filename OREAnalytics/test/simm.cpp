@@ -0,0 +1,298 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <boost/test/unit_test.hpp>
+#include <orea/simm/crif.hpp>
+#include <orea/simm/simmbucketmapperbase.hpp>
+#include <orea/simm/simmcalculator.hpp>
+#include <orea/simm/simmconfigurationisdav2_6.hpp>
+#include <oret/toplevelfixture.hpp>
+#include <test/oreatoplevelfixture.hpp>
+
+#include <functional>
+
+using namespace std;
+using namespace QuantLib;
+using namespace ore::analytics;
+
+using ore::data::NettingSetDetails;
+typedef CrifRecord::ProductClass ProductClass;
+typedef CrifRecord::RiskType RiskType;
+typedef SimmConfiguration::SimmSide SimmSide;
+
+namespace {
+
+// check correlationMatrix() against pairwise correlation(), without and with a cache that is shared between the calls
+void checkCorrelationMatrix(const SimmConfiguration& config, SimmConfiguration::CorrelationCache& cache,
+                            const RiskType rt, const vector<string>& qualifiers, const vector<string>& labels1,
+                            const vector<string>& labels2, const string& calculationCurrency = "") {
+    BOOST_TEST_MESSAGE("Checking correlation matrix for risk type " << rt);
+    for (auto c : {static_cast<SimmConfiguration::CorrelationCache*>(nullptr), &cache}) {
+        Matrix m = config.correlationMatrix(rt, qualifiers, labels1, labels2, calculationCurrency, c);
+        BOOST_REQUIRE_EQUAL(m.rows(), qualifiers.size());
+        BOOST_REQUIRE_EQUAL(m.columns(), qualifiers.size());
+        for (Size i = 0; i < qualifiers.size(); ++i) {
+            for (Size j = 0; j < qualifiers.size(); ++j) {
+                BOOST_CHECK_EQUAL(m[i][j], config.correlation(rt, qualifiers[i], labels1[i], labels2[i], rt,
+                                                              qualifiers[j], labels1[j], labels2[j],
+                                                              calculationCurrency));
+            }
+        }
+    }
+}
+
+QuantLib::ext::shared_ptr<SimmBucketMapperBase> testBucketMapper() {
+    auto bucketMapper = QuantLib::ext::make_shared<SimmBucketMapperBase>();
+    bucketMapper->addMapping(RiskType::Equity, "EQ_A", "1");
+    bucketMapper->addMapping(RiskType::Equity, "EQ_B", "1");
+    bucketMapper->addMapping(RiskType::Equity, "EQ_C", "5");
+    bucketMapper->addMapping(RiskType::Equity, "EQ_D", "Residual");
+    bucketMapper->addMapping(RiskType::CreditQ, "ISIN:A", "1");
+    bucketMapper->addMapping(RiskType::CreditQ, "ISIN:B", "1");
+    bucketMapper->addMapping(RiskType::CreditQ, "ISIN:C", "3");
+    bucketMapper->addMapping(RiskType::Commodity, "CO_A", "1");
+    bucketMapper->addMapping(RiskType::Commodity, "CO_B", "1");
+    bucketMapper->addMapping(RiskType::Commodity, "CO_C", "12");
+    return bucketMapper;
+}
+
+// a CRIF with several netting sets and regulations, the amounts differ by netting set
+Crif testCrif() {
+    Crif crif;
+    vector<string> tenors = {"2w", "1y", "5y", "10y", "30y"};
+    for (Size n = 0; n < 4; ++n) {
+        NettingSetDetails nsd("NS" + std::to_string(n + 1));
+        string collectRegulations = n % 2 == 0 ? "SEC,CFTC" : "ESA,USPR";
+        string postRegulations = n % 2 == 0 ? "ESA" : "SEC";
+        Real f = 1.0 + 0.37 * n;
+        auto add = [&crif, &nsd, &collectRegulations, &postRegulations](ProductClass pc, RiskType rt,
+                                                                        const string& qualifier, const string& bucket,
+                                                                        const string& label1, const string& label2,
+                                                                        Real amount) {
+            crif.addRecord(CrifRecord("trade_" + qualifier, "Swap", nsd, pc, rt, qualifier, bucket, label1, label2,
+                                      "USD", amount, amount, "SIMM", collectRegulations, postRegulations));
+        };
+        for (Size t = 0; t < tenors.size(); ++t) {
+            add(ProductClass::RatesFX, RiskType::IRCurve, "USD", "1", tenors[t], "OIS", f * (1000.0 - 300.0 * t));
+            add(ProductClass::RatesFX, RiskType::IRCurve, "USD", "1", tenors[t], "Libor3m", f * 700.0 * t);
+            add(ProductClass::RatesFX, RiskType::IRCurve, "EUR", "1", tenors[t], "OIS", -f * 500.0);
+            add(ProductClass::RatesFX, RiskType::IRVol, "USD", "", tenors[t], "", f * 20000.0 * (t + 1));
+            add(ProductClass::RatesFX, RiskType::IRVol, "EUR", "", tenors[t], "", -f * 15000.0);
+        }
+        add(ProductClass::RatesFX, RiskType::FX, "EUR", "", "", "", f * 150000.0);
+        add(ProductClass::RatesFX, RiskType::FX, "GBP", "", "", "", -f * 90000.0);
+        add(ProductClass::Equity, RiskType::Equity, "EQ_A", "1", "", "spot", f * 30000.0);
+        add(ProductClass::Equity, RiskType::Equity, "EQ_B", "1", "", "spot", -f * 12000.0);
+        add(ProductClass::Equity, RiskType::Equity, "EQ_C", "5", "", "spot", f * 8000.0);
+        add(ProductClass::Equity, RiskType::EquityVol, "EQ_A", "1", "1y", "", f * 40000.0);
+        add(ProductClass::Equity, RiskType::EquityVol, "EQ_C", "5", "5y", "", -f * 25000.0);
+        add(ProductClass::Credit, RiskType::CreditQ, "ISIN:A", "1", "5y", "", f * 2000.0);
+        add(ProductClass::Credit, RiskType::CreditQ, "ISIN:C", "3", "1y", "", -f * 700.0);
+        add(ProductClass::Commodity, RiskType::Commodity, "CO_A", "1", "", "", f * 5000.0);
+        add(ProductClass::Commodity, RiskType::Commodity, "CO_C", "12", "", "", f * 3000.0);
+    }
+    return crif;
+}
+
+// check the indexed filters of the crif against a linear scan over its records
+void checkCrifFilters(const Crif& crif, const string& label) {
+    BOOST_TEST_MESSAGE("Checking filters of " << label << " crif");
+    BOOST_REQUIRE(!crif.empty());
+    // the records in the views must be the records of this crif
+    auto checkView = [&crif](const CrifRecordView& view, const std::function<bool(const CrifRecord&)>& pred) {
+        std::vector<const CrifRecord*> expected;
+        for (const auto& r : crif) {
+            if (pred(r))
+                expected.push_back(&r);
+        }
+        BOOST_REQUIRE_EQUAL(view.size(), expected.size());
+        for (Size i = 0; i < expected.size(); ++i)
+            BOOST_CHECK(&view[i] == expected[i]);
+    };
+    for (const auto& nsd : crif.nettingSetDetails()) {
+        std::set<ProductClass> productClasses;
+        for (const auto& r : crif) {
+            if (r.nettingSetDetails == nsd)
+                productClasses.insert(r.productClass);
+        }
+        BOOST_CHECK(crif.ProductClassesByNettingSetDetails(nsd) == productClasses);
+        for (auto pc : productClasses) {
+            for (auto rt : {RiskType::IRCurve, RiskType::IRVol, RiskType::FX, RiskType::Equity, RiskType::EquityVol,
+                            RiskType::CreditQ, RiskType::Commodity, RiskType::CreditNonQ}) {
+                auto inGroup = [&nsd, pc, rt](const CrifRecord& r) {
+                    return r.nettingSetDetails == nsd && r.productClass == pc && r.riskType == rt;
+                };
+                checkView(crif.filterBy(nsd, pc, rt), inGroup);
+                std::set<string> qualifiers, buckets;
+                for (const auto& r : crif) {
+                    if (inGroup(r)) {
+                        qualifiers.insert(r.qualifier);
+                        buckets.insert(r.bucket);
+                    }
+                }
+                BOOST_CHECK(crif.qualifiersBy(nsd, pc, rt) == qualifiers);
+                qualifiers.insert("unknown");
+                buckets.insert("unknown");
+                for (const auto& q : qualifiers) {
+                    auto inQualifier = [&inGroup, &q](const CrifRecord& r) { return inGroup(r) && r.qualifier == q; };
+                    checkView(crif.filterByQualifier(nsd, pc, rt, q), inQualifier);
+                    Size count = 0;
+                    auto first = crif.end();
+                    for (auto r = crif.begin(); r != crif.end(); ++r) {
+                        if (inQualifier(*r) && count++ == 0)
+                            first = r;
+                    }
+                    BOOST_CHECK_EQUAL(crif.countMatching(nsd, pc, rt, q), count);
+                    BOOST_CHECK(crif.findBy(nsd, pc, rt, q) == first);
+                    for (const auto& b : buckets) {
+                        checkView(crif.filterByQualifierAndBucket(nsd, pc, rt, q, b),
+                                  [&inQualifier, &b](const CrifRecord& r) { return inQualifier(r) && r.bucket == b; });
+                    }
+                }
+                for (const auto& b : buckets) {
+                    checkView(crif.filterByBucket(nsd, pc, rt, b),
+                              [&inGroup, &b](const CrifRecord& r) { return inGroup(r) && r.bucket == b; });
+                }
+            }
+        }
+    }
+    BOOST_CHECK(crif.filterBy(NettingSetDetails("unknown"), ProductClass::RatesFX, RiskType::IRCurve).empty());
+}
+
+} // namespace
+
+BOOST_FIXTURE_TEST_SUITE(OREAnalyticsTestSuite, ore::test::OreaTopLevelFixture)
+
+BOOST_AUTO_TEST_SUITE(SimmTest)
+
+BOOST_AUTO_TEST_CASE(testCorrelationMatrix) {
+
+    BOOST_TEST_MESSAGE("Testing SIMM correlation matrix against pairwise correlations...");
+
+    SimmConfiguration_ISDA_V2_6 config(testBucketMapper());
+
+    // one cache for all risk types, as in a SIMM calculation
+    SimmConfiguration::CorrelationCache cache;
+
+    // IRCurve tenor and sub curve correlations as requested by the IR delta margin
+    vector<string> usd(4, "USD"), empty(4, "");
+    checkCorrelationMatrix(config, cache, RiskType::IRCurve, usd, {"2w", "1y", "5y", "1y"}, empty);
+    checkCorrelationMatrix(config, cache, RiskType::IRCurve, usd, empty, {"OIS", "Libor3m", "OIS", "Libor6m"});
+    checkCorrelationMatrix(config, cache, RiskType::IRVol, {"USD", "EUR", "USD", "EUR"}, {"1y", "1y", "10y", "30y"},
+                           empty);
+    checkCorrelationMatrix(config, cache, RiskType::Equity, {"EQ_A", "EQ_B", "EQ_C", "EQ_D", "EQ_A"},
+                           {"", "", "", "", "1y"}, {"spot", "spot", "repo", "spot", "spot"});
+    checkCorrelationMatrix(config, cache, RiskType::EquityVol, {"EQ_A", "EQ_C", "EQ_B"}, {"1y", "1y", "5y"},
+                           {"", "", ""});
+    checkCorrelationMatrix(config, cache, RiskType::CreditQ, {"ISIN:A", "ISIN:B", "ISIN:C", "ISIN:A"},
+                           {"1y", "1y", "5y", "5y"}, {"", "", "", "Sec"});
+    checkCorrelationMatrix(config, cache, RiskType::Commodity, {"CO_A", "CO_B", "CO_C"}, {"", "", ""},
+                           {"", "", ""});
+    // FX is computed pairwise, the correlation depends on the calculation currency
+    checkCorrelationMatrix(config, cache, RiskType::FX, {"EUR", "GBP", "JPY", "BRL"}, empty, empty, "USD");
+    checkCorrelationMatrix(config, cache, RiskType::FX, {"EUR", "GBP", "JPY", "BRL"}, empty, empty, "BRL");
+
+    // the cached correlations are reused for risk factors in a different order
+    checkCorrelationMatrix(config, cache, RiskType::IRCurve, usd, {"5y", "2w", "1y", "5y"}, empty);
+    checkCorrelationMatrix(config, cache, RiskType::Equity, {"EQ_C", "EQ_A", "EQ_D", "EQ_B", "EQ_A"},
+                           {"", "", "", "", "1y"}, {"repo", "spot", "spot", "spot", "spot"});
+    BOOST_CHECK(!cache.ids.empty());
+    BOOST_CHECK(!cache.correlations.empty());
+}
+
+BOOST_AUTO_TEST_CASE(testMultiThreadedCalculation) {
+
+    BOOST_TEST_MESSAGE("Testing SIMM calculation on several threads against the single threaded calculation...");
+
+    auto config = QuantLib::ext::make_shared<SimmConfiguration_ISDA_V2_6>(testBucketMapper());
+    Crif crif = testCrif();
+
+    SimmCalculator serial(crif, config, "USD", "USD", "USD", nullptr, true, true, true);
+    SimmCalculator parallel(crif, config, "USD", "USD", "USD", nullptr, true, true, true, {}, {}, 4);
+
+    // the 4 netting sets have call and post regulations
+    BOOST_REQUIRE_EQUAL(serial.simmResults().size(), 2);
+    BOOST_REQUIRE_EQUAL(parallel.simmResults().size(), 2);
+    for (const auto& [side, nettingSetResults] : serial.simmResults()) {
+        BOOST_REQUIRE_EQUAL(nettingSetResults.size(), 4);
+        BOOST_REQUIRE_EQUAL(parallel.simmResults(side).size(), nettingSetResults.size());
+        for (const auto& [nsd, regulationResults] : nettingSetResults) {
+            BOOST_REQUIRE_EQUAL(parallel.simmResults(side, nsd).size(), regulationResults.size());
+            for (const auto& [regulation, results] : regulationResults) {
+                const auto& parallelResults = parallel.simmResults(side, nsd, regulation);
+                BOOST_CHECK_EQUAL(parallelResults.resultCurrency(), results.resultCurrency());
+                BOOST_CHECK_EQUAL(parallelResults.calculationCurrency(), results.calculationCurrency());
+                BOOST_REQUIRE_EQUAL(parallelResults.data().size(), results.data().size());
+                BOOST_CHECK(!results.data().empty());
+                for (const auto& [key, margin] : results.data()) {
+                    auto p = parallelResults.data().find(key);
+                    BOOST_REQUIRE(p != parallelResults.data().end());
+                    // exact equality, the task split must not change the summation order
+                    BOOST_CHECK_EQUAL(p->second, margin);
+                }
+            }
+            BOOST_CHECK_EQUAL(parallel.winningRegulations(side, nsd), serial.winningRegulations(side, nsd));
+            const auto& serialFinal = serial.finalSimmResults(side, nsd);
+            const auto& parallelFinal = parallel.finalSimmResults(side, nsd);
+            BOOST_CHECK_EQUAL(parallelFinal.first, serialFinal.first);
+            BOOST_CHECK(parallelFinal.second.data() == serialFinal.second.data());
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(testCrifIndex) {
+
+    BOOST_TEST_MESSAGE("Testing crif filters on copied and moved crifs...");
+
+    Crif original = testCrif();
+    checkCrifFilters(original, "original");
+
+    // the index of the source is built before the copies and moves, it must not be shared with the targets
+    Crif copied(original);
+    Crif copyAssigned;
+    copyAssigned = original;
+    Crif source1(original), source2(original);
+    BOOST_REQUIRE(!source1.filterBy(NettingSetDetails("NS1"), ProductClass::RatesFX, RiskType::IRCurve).empty());
+    BOOST_REQUIRE(!source2.filterBy(NettingSetDetails("NS1"), ProductClass::RatesFX, RiskType::IRCurve).empty());
+    Crif moved(std::move(source1));
+    Crif moveAssigned;
+    moveAssigned = std::move(source2);
+
+    // a modification of the original must not be visible in the copies
+    Size n = original.size();
+    original.clear();
+    BOOST_CHECK(original.filterBy(NettingSetDetails("NS1"), ProductClass::RatesFX, RiskType::IRCurve).empty());
+
+    std::vector<std::pair<const Crif*, string>> crifs = {
+        {&copied, "copied"}, {&copyAssigned, "copy assigned"}, {&moved, "moved"}, {&moveAssigned, "move assigned"}};
+    for (auto const& [crif, label] : crifs) {
+        BOOST_CHECK_EQUAL(crif->size(), n);
+        checkCrifFilters(*crif, label);
+    }
+
+    // modifications invalidate the index
+    CrifRecord r = *copied.begin();
+    r.qualifier = "JPY";
+    copied.addRecord(r);
+    BOOST_CHECK_EQUAL(copied.countMatching(r.nettingSetDetails, r.productClass, r.riskType, "JPY"), 1);
+    checkCrifFilters(copied, "modified copy");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -239,6 +239,72 @@ QuantLib::ext::shared_ptr<StressTestScenarioData> setupStressScenarioData() {
     return stressData;
 }
 
+namespace {
+void testSkipUnchangedTrades(ObservationMode::Mode om) {
+    SavedSettings backup;
+
+    ObservationMode::Mode backupMode = ObservationMode::instance().mode();
+    ObservationMode::instance().setMode(om);
+
+    Date today = Date(14, April, 2016);
+    Settings::instance().evaluationDate() = today;
+
+    QuantLib::ext::shared_ptr<Market> initMarket = QuantLib::ext::make_shared<TestMarket>(today);
+    QuantLib::ext::shared_ptr<analytics::ScenarioSimMarketParameters> simMarketData = setupStressSimMarketData();
+    stressConv();
+
+    // add a scenario that only shifts the EUR discount curve, so that the USD trades are not updated
+    QuantLib::ext::shared_ptr<StressTestScenarioData> stressData = setupStressScenarioData();
+    StressTestScenarioData::StressTestData eurOnly;
+    eurOnly.label = "stresstest_2";
+    eurOnly.discountCurveShifts["EUR"] = stressData->data().front().discountCurveShifts.at("EUR");
+    stressData->data().push_back(eurOnly);
+
+    QuantLib::ext::shared_ptr<EngineData> engineData = QuantLib::ext::make_shared<EngineData>();
+    engineData->model("Swap") = "DiscountedCashflows";
+    engineData->engine("Swap") = "DiscountingSwapEngine";
+    engineData->model("EuropeanSwaption") = "BlackBachelier";
+    engineData->engine("EuropeanSwaption") = "BlackBachelierSwaptionEngine";
+    engineData->model("FxOption") = "GarmanKohlhagen";
+    engineData->engine("FxOption") = "AnalyticEuropeanEngine";
+    engineData->model("CapFloor") = "IborCapModel";
+    engineData->engine("CapFloor") = "IborCapEngine";
+    engineData->model("CapFlooredIborLeg") = "BlackOrBachelier";
+    engineData->engine("CapFlooredIborLeg") = "BlackIborCouponPricer";
+
+    QuantLib::ext::shared_ptr<Portfolio> portfolio(new Portfolio());
+    portfolio->add(buildSwap("1_Swap_EUR", "EUR", true, 10000000.0, 0, 10, 0.03, 0.00, "1Y", "30/360", "6M", "A360",
+                             "EUR-EURIBOR-6M"));
+    portfolio->add(buildSwap("2_Swap_USD", "USD", true, 10000000.0, 0, 15, 0.02, 0.00, "6M", "30/360", "3M", "A360",
+                             "USD-LIBOR-3M"));
+    portfolio->add(buildEuropeanSwaption("6_Swaption_EUR", "Long", "EUR", true, 1000000.0, 2, 5, 0.03, 0.00, "1Y",
+                                         "30/360", "6M", "A360", "EUR-EURIBOR-6M"));
+    portfolio->add(buildFxOption("7_FxOption_EUR_USD", "Long", "Call", 3, "EUR", 10000000.0, "USD", 11000000.0));
+    portfolio->add(buildCap("9_Cap_EUR", "EUR", "Long", 0.05, 1000000.0, 0, 10, "6M", "A360", "EUR-EURIBOR-6M"));
+    portfolio->add(buildFloor("10_Floor_USD", "USD", "Long", 0.01, 1000000.0, 0, 10, "3M", "A360", "USD-LIBOR-3M"));
+
+    // the results with and without skipping of unchanged trades must be identical
+    ore::analytics::StressTest reference(portfolio, initMarket, "default", engineData, simMarketData, stressData, {},
+                                         {}, {}, nullptr, IborFallbackConfig::defaultConfig(), false, false);
+    ore::analytics::StressTest analysis(portfolio, initMarket, "default", engineData, simMarketData, stressData, {}, {},
+                                        {}, nullptr, IborFallbackConfig::defaultConfig(), false, true);
+
+    BOOST_REQUIRE_EQUAL(reference.baseNPV().size(), 6);
+    BOOST_REQUIRE_EQUAL(reference.shiftedNPV().count(std::make_pair("2_Swap_USD", "stresstest_2")), 1);
+    BOOST_REQUIRE_EQUAL(analysis.baseNPV().size(), reference.baseNPV().size());
+    BOOST_REQUIRE_EQUAL(analysis.shiftedNPV().size(), reference.shiftedNPV().size());
+    for (auto const& [id, npv] : reference.baseNPV())
+        BOOST_CHECK_EQUAL(analysis.baseNPV().at(id), npv);
+    for (auto const& [key, npv] : reference.shiftedNPV()) {
+        BOOST_TEST_MESSAGE(key.first << " " << key.second << ": " << npv);
+        BOOST_CHECK_EQUAL(analysis.shiftedNPV().at(key), npv);
+    }
+
+    ObservationMode::instance().setMode(backupMode);
+    IndexManager::instance().clearHistories();
+}
+} // namespace
+
 BOOST_FIXTURE_TEST_SUITE(OREAnalyticsTestSuite, ore::test::OreaTopLevelFixture)
 
 BOOST_AUTO_TEST_SUITE(StressTestingTest)
@@ -381,6 +447,16 @@ BOOST_AUTO_TEST_CASE(regression) {
     IndexManager::instance().clearHistories();
 }
 
+BOOST_AUTO_TEST_CASE(testSkipUnchangedTradesDisableObs) {
+    BOOST_TEST_MESSAGE("Testing skipping of unchanged trades in stress tests (Disable observation mode)");
+    testSkipUnchangedTrades(ObservationMode::Mode::Disable);
+}
+
+BOOST_AUTO_TEST_CASE(testSkipUnchangedTradesUnregisterObs) {
+    BOOST_TEST_MESSAGE("Testing skipping of unchanged trades in stress tests (Unregister observation mode)");
+    testSkipUnchangedTrades(ObservationMode::Mode::Unregister);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,168 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <boost/test/unit_test.hpp>
+#include <orea/app/reportwriter.hpp>
+#include <orea/engine/valuationprofiler.hpp>
+#include <ored/portfolio/enginedata.hpp>
+#include <ored/portfolio/enginefactory.hpp>
+#include <ored/portfolio/portfolio.hpp>
+#include <ored/report/inmemoryreport.hpp>
+#include <oret/toplevelfixture.hpp>
+#include <test/oreatoplevelfixture.hpp>
+#include <test/testportfolio.hpp>
+
+#include "testmarket.hpp"
+
+using namespace std;
+using namespace QuantLib;
+using namespace ore;
+using namespace ore::data;
+using namespace ore::analytics;
+
+using testsuite::buildEuropeanSwaption;
+using testsuite::buildSwap;
+using testsuite::TestMarket;
+
+BOOST_FIXTURE_TEST_SUITE(OREAnalyticsTestSuite, ore::test::OreaTopLevelFixture)
+
+BOOST_AUTO_TEST_SUITE(ValuationProfilerTest)
+
+BOOST_AUTO_TEST_CASE(testStatistics) {
+
+    BOOST_TEST_MESSAGE("Testing valuation profiler statistics and merge...");
+
+    ValuationProfiler::Statistics s;
+    s.add(0.5E-6);
+    s.add(3.0E-6, 2);
+    s.add(1.0E4, 1);
+
+    BOOST_CHECK_EQUAL(s.count, 3);
+    BOOST_CHECK_EQUAL(s.recalculations, 3);
+    BOOST_CHECK_CLOSE(s.total, 1.0E4 + 3.5E-6, 1.0E-10);
+    BOOST_CHECK_EQUAL(s.min, 0.5E-6);
+    BOOST_CHECK_EQUAL(s.max, 1.0E4);
+    // 0.5 mus is in bucket 0, 3 mus in [2, 4) mus = bucket 2, 10000 seconds in the last bucket
+    BOOST_CHECK_EQUAL(s.histogram[0], 1);
+    BOOST_CHECK_EQUAL(s.histogram[2], 1);
+    BOOST_CHECK_EQUAL(s.histogram[ValuationProfiler::histogramBuckets - 1], 1);
+    BOOST_CHECK_EQUAL(ValuationProfiler::Statistics::bucketLowerBound(0), 0.0);
+    BOOST_CHECK_EQUAL(ValuationProfiler::Statistics::bucketLowerBound(2), 2.0);
+
+    Date d1(14, April, 2016), d2(14, April, 2017);
+    ValuationProfiler p1, p2;
+    p1.addPhase(d1, ValuationProfiler::Phase::Pricing, 1.0);
+    p1.addPhase(Date(), ValuationProfiler::Phase::UpdateDate, 2.0);
+    p2.addPhase(d1, ValuationProfiler::Phase::Pricing, 3.0);
+    p2.addPhase(d2, ValuationProfiler::Phase::Pricing, 4.0);
+    p1.merge(p2);
+
+    BOOST_CHECK_EQUAL(p1.phases().at(ValuationProfiler::Phase::Pricing).count, 3);
+    BOOST_CHECK_EQUAL(p1.phases().at(ValuationProfiler::Phase::Pricing).total, 8.0);
+    BOOST_CHECK_EQUAL(p1.phases().at(ValuationProfiler::Phase::UpdateDate).count, 1);
+    BOOST_CHECK_EQUAL(p1.dates().size(), 2);
+    BOOST_CHECK_EQUAL(p1.dates().at(d1).at(ValuationProfiler::Phase::Pricing).min, 1.0);
+    BOOST_CHECK_EQUAL(p1.dates().at(d1).at(ValuationProfiler::Phase::Pricing).max, 3.0);
+    BOOST_CHECK_EQUAL(p1.dates().at(d2).at(ValuationProfiler::Phase::Pricing).count, 1);
+    BOOST_CHECK_THROW(p1.merge(p1), QuantLib::Error);
+}
+
+BOOST_AUTO_TEST_CASE(testPricingEngines) {
+
+    BOOST_TEST_MESSAGE("Testing valuation profiler pricing engine attribution...");
+
+    SavedSettings backup;
+    Date today(14, April, 2016);
+    Settings::instance().evaluationDate() = today;
+
+    auto initMarket = QuantLib::ext::make_shared<TestMarket>(today);
+    auto data = QuantLib::ext::make_shared<EngineData>();
+    data->model("Swap") = "DiscountedCashflows";
+    data->engine("Swap") = "DiscountingSwapEngine";
+    data->model("EuropeanSwaption") = "BlackBachelier";
+    data->engine("EuropeanSwaption") = "BlackBachelierSwaptionEngine";
+    auto factory = QuantLib::ext::make_shared<EngineFactory>(data, initMarket);
+
+    // the trade type Swaption is not configured in the engine data, its product is EuropeanSwaption
+    auto portfolio = QuantLib::ext::make_shared<Portfolio>();
+    portfolio->add(buildSwap("1_Swap_EUR", "EUR", true, 10000000.0, 0, 10, 0.03, 0.00, "1Y", "30/360", "6M", "A360",
+                             "EUR-EURIBOR-6M"));
+    portfolio->add(buildEuropeanSwaption("2_Swaption_EUR", "Long", "EUR", true, 1000000.0, 2, 5, 0.02, 0.00, "1Y",
+                                         "30/360", "6M", "A360", "EUR-EURIBOR-6M"));
+    portfolio->build(factory);
+    BOOST_REQUIRE_EQUAL(portfolio->size(), 2);
+    BOOST_CHECK_EQUAL(portfolio->get("1_Swap_EUR")->pricingModelEngine(), "DiscountedCashflows/DiscountingSwapEngine");
+    BOOST_CHECK_EQUAL(portfolio->get("2_Swaption_EUR")->pricingModelEngine(),
+                      "BlackBachelier/BlackBachelierSwaptionEngine");
+
+    ValuationProfiler profiler(data);
+    profiler.setPortfolio(*portfolio);
+    // the trades are identified by their index in the portfolio, i.e. sorted by id
+    profiler.addTradePricing(0, 1.0, 1);
+    profiler.addTradePricing(0, 2.0, 0);
+    profiler.addTradePricing(1, 4.0, 1);
+
+    BOOST_REQUIRE_EQUAL(profiler.tradeTypes().size(), 2);
+    BOOST_CHECK_EQUAL(profiler.tradeTypes().at("Swap").count, 2);
+    BOOST_CHECK_EQUAL(profiler.tradeTypes().at("Swap").recalculations, 1);
+    BOOST_CHECK_EQUAL(profiler.tradeTypes().at("Swaption").total, 4.0);
+    BOOST_REQUIRE_EQUAL(profiler.pricingEngines().size(), 2);
+    BOOST_CHECK_EQUAL(profiler.pricingEngines().count("Unknown"), 0);
+    BOOST_CHECK_EQUAL(profiler.pricingEngines().at("DiscountedCashflows/DiscountingSwapEngine").total, 3.0);
+    BOOST_CHECK_EQUAL(profiler.pricingEngines().at("BlackBachelier/BlackBachelierSwaptionEngine").count, 1);
+}
+
+BOOST_AUTO_TEST_CASE(testValuationProfileReports) {
+
+    BOOST_TEST_MESSAGE("Testing valuation profile reports...");
+
+    Date d(14, April, 2017);
+    ValuationProfiler profiler;
+    profiler.addPhase(d, ValuationProfiler::Phase::UpdateScenario, 3.0E-6);
+    profiler.addPhase(d, ValuationProfiler::Phase::UpdateScenario, 5.0E-6);
+
+    InMemoryReport report;
+    ReportWriter().writeValuationProfile(report, profiler);
+    BOOST_REQUIRE_EQUAL(report.columns(), 9);
+    // one row for the totals and one for the date
+    BOOST_REQUIRE_EQUAL(report.rows(), 2);
+    BOOST_CHECK_EQUAL(boost::get<string>(report.data(0)[0]), "Total");
+    BOOST_CHECK_EQUAL(boost::get<string>(report.data(0)[1]), "Date");
+    BOOST_CHECK_EQUAL(boost::get<string>(report.data(1)[1]), ore::data::to_string(d));
+    BOOST_CHECK_EQUAL(boost::get<string>(report.data(2)[1]), "UpdateScenario");
+    BOOST_CHECK_EQUAL(boost::get<Size>(report.data(3)[1]), 2);
+    BOOST_CHECK_CLOSE(boost::get<Real>(report.data(6)[1]), 4.0, 1.0E-8);
+    BOOST_CHECK_CLOSE(boost::get<Real>(report.data(7)[1]), 3.0, 1.0E-8);
+    BOOST_CHECK_CLOSE(boost::get<Real>(report.data(8)[1]), 5.0, 1.0E-8);
+
+    InMemoryReport histogram;
+    ReportWriter().writeValuationProfileHistogram(histogram, profiler);
+    BOOST_REQUIRE_EQUAL(histogram.columns(), 6);
+    // 3 mus in [2, 4) and 5 mus in [4, 8), for the totals and the date
+    BOOST_REQUIRE_EQUAL(histogram.rows(), 4);
+    BOOST_CHECK_EQUAL(boost::get<Real>(histogram.data(3)[0]), 2.0);
+    BOOST_CHECK_EQUAL(boost::get<Real>(histogram.data(4)[0]), 4.0);
+    BOOST_CHECK_EQUAL(boost::get<Size>(histogram.data(5)[0]), 1);
+    BOOST_CHECK_EQUAL(boost::get<Real>(histogram.data(3)[1]), 4.0);
+    BOOST_CHECK_EQUAL(boost::get<Real>(histogram.data(4)[1]), 8.0);
+    BOOST_CHECK_EQUAL(boost::get<Size>(histogram.data(5)[1]), 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -147,28 +147,38 @@ void CurveConfigurations::parseNode(const CurveSpec::CurveType& type, const stri
 
 void CurveConfigurations::add(const CurveSpec::CurveType& type, const string& curveId,
     const QuantLib::ext::shared_ptr<CurveConfig>& config) {
+    boost::unique_lock<boost::shared_mutex> lock(mutex_);
     configs_[type][curveId] = config;
 }
 
 bool CurveConfigurations::has(const CurveSpec::CurveType& type, const string& curveId) const {
+    boost::shared_lock<boost::shared_mutex> lock(mutex_);
     return (configs_.count(type) > 0 && configs_.at(type).count(curveId) > 0) ||
            (unparsed_.count(type) > 0 && unparsed_.at(type).count(curveId) > 0);
 }
 
 const QuantLib::ext::shared_ptr<CurveConfig>& CurveConfigurations::get(const CurveSpec::CurveType& type,
     const string& curveId) const {
-    const auto& it = configs_.find(type);
-    if (it != configs_.end()) {
-        const auto& itc = it->second.find(curveId);
-        if (itc != it->second.end()) {
-            return itc->second;
+    {
+        boost::shared_lock<boost::shared_mutex> lock(mutex_);
+        const auto& it = configs_.find(type);
+        if (it != configs_.end()) {
+            const auto& itc = it->second.find(curveId);
+            if (itc != it->second.end()) {
+                return itc->second;
+            }
         }
     }
-    parseNode(type, curveId);
+    boost::unique_lock<boost::shared_mutex> lock(mutex_);
+    // another thread might have parsed the node in the meantime
+    const auto& it = configs_.find(type);
+    if (it == configs_.end() || it->second.find(curveId) == it->second.end())
+        parseNode(type, curveId);
     return configs_.at(type).at(curveId);
 }
 
 void CurveConfigurations::parseAll() {
+    boost::unique_lock<boost::shared_mutex> lock(mutex_);
     for (const auto& u : unparsed_) {
         for (auto it = u.second.cbegin(), nit = it; it != u.second.cend(); it = nit) {
             nit++;
@@ -330,6 +340,7 @@ std::set<string> CurveConfigurations::conventions() const {
 }
 
 set<string> CurveConfigurations::yieldCurveConfigIds() {
+    boost::shared_lock<boost::shared_mutex> lock(mutex_);
     set<string> curves;
     const auto& it = configs_.find(CurveSpec::CurveType::Yield);
     if (it != configs_.end()) {
@@ -44,6 +44,8 @@
 #include <ored/marketdata/todaysmarketparameters.hpp>
 #include <ored/utilities/xmlutils.hpp>
 
+#include <boost/thread/shared_mutex.hpp>
+
 #include <typeindex>
 #include <typeinfo>
 
@@ -169,8 +171,11 @@ public:
 
     mutable std::map<CurveSpec::CurveType, std::map<std::string, QuantLib::ext::shared_ptr<CurveConfig>>> configs_;
     mutable std::map<CurveSpec::CurveType, std::map<std::string, std::string>> unparsed_;
+    // guards configs_ and unparsed_, the lazy parsing in get() might be triggered from several threads
+    mutable boost::shared_mutex mutex_;
 
-    // utility function for parsing a node of name "parentName" and storing the result in the map
+    // utility function for parsing a node of name "parentName" and storing the result in the map, the caller must
+    // hold a unique lock on mutex_
     void parseNode(const CurveSpec::CurveType& type, const string& curveId) const;
     
     // utility function for getting a child curve config node
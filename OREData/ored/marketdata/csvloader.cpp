@@ -23,34 +23,38 @@
 
 #include <algorithm>
 #include <boost/algorithm/string.hpp>
+#include <exception>
 #include <fstream>
 #include <map>
 #include <ored/marketdata/csvloader.hpp>
 #include <ored/marketdata/marketdatumparser.hpp>
 #include <ored/utilities/log.hpp>
 #include <ored/utilities/parsers.hpp>
+#include <thread>
 
 using namespace std;
+using QuantLib::Size;
 
 namespace ore {
 namespace data {
 
 CSVLoader::CSVLoader(const string& marketFilename, const string& fixingFilename, bool implyTodaysFixings,
-		     Date fixingCutOffDate)
-    : CSVLoader(marketFilename, fixingFilename, "", implyTodaysFixings, fixingCutOffDate) {}
+		     Date fixingCutOffDate, Size nThreads)
+    : CSVLoader(marketFilename, fixingFilename, "", implyTodaysFixings, fixingCutOffDate, nThreads) {}
 
-CSVLoader::CSVLoader(const vector<string>& marketFiles, const vector<string>& fixingFiles, bool implyTodaysFixings, Date fixingCutOffDate)
-    : CSVLoader(marketFiles, fixingFiles, {}, implyTodaysFixings, fixingCutOffDate) {}
+CSVLoader::CSVLoader(const vector<string>& marketFiles, const vector<string>& fixingFiles, bool implyTodaysFixings, Date fixingCutOffDate,
+                     Size nThreads)
+    : CSVLoader(marketFiles, fixingFiles, {}, implyTodaysFixings, fixingCutOffDate, nThreads) {}
 
 CSVLoader::CSVLoader(const string& marketFilename, const string& fixingFilename, const string& dividendFilename,
-                     bool implyTodaysFixings, Date fixingCutOffDate)
-    : implyTodaysFixings_(implyTodaysFixings), fixingCutOffDate_(fixingCutOffDate) {
+                     bool implyTodaysFixings, Date fixingCutOffDate, Size nThreads)
+    : implyTodaysFixings_(implyTodaysFixings), fixingCutOffDate_(fixingCutOffDate), nThreads_(std::max<Size>(nThreads, 1)) {
 
     // load market data
     loadFile(marketFilename, DataType::Market);
     // log
-    for (auto it : data_) {
-        LOG("CSVLoader loaded " << it.second.size() << " market data points for " << it.first);
+    for (auto const& it : data_) {
+        LOG("CSVLoader loaded " << it.second.quotes.size() << " market data points for " << it.first);
     }
 
     // load fixings
@@ -68,16 +72,16 @@ CSVLoader::CSVLoader(const string& marketFilename, const string& fixingFilename,
 
 CSVLoader::CSVLoader(const vector<string>& marketFiles, const vector<string>& fixingFiles,
                      const vector<string>& dividendFiles, bool implyTodaysFixings,
-		     Date fixingCutOffDate)
-    : implyTodaysFixings_(implyTodaysFixings), fixingCutOffDate_(fixingCutOffDate) {
+		     Date fixingCutOffDate, Size nThreads)
+    : implyTodaysFixings_(implyTodaysFixings), fixingCutOffDate_(fixingCutOffDate), nThreads_(std::max<Size>(nThreads, 1)) {
 
     for (auto marketFile : marketFiles)
         // load market data
         loadFile(marketFile, DataType::Market);
 
     // log
-    for (auto it : data_)
-        LOG("CSVLoader loaded " << it.second.size() << " market data points for " << it.first);
+    for (auto const& it : data_)
+        LOG("CSVLoader loaded " << it.second.quotes.size() << " market data points for " << it.first);
 
     for (auto fixingFile : fixingFiles)
         // load fixings
@@ -92,71 +96,142 @@ CSVLoader::CSVLoader(const vector<string>& marketFiles, const vector<string>& fi
     LOG("CSVLoader complete.");
 }
 
-QuantLib::ext::shared_ptr<MarketDatum> makeDummyMarketDatum(const Date& d, const std::string& name) {
-    return QuantLib::ext::make_shared<MarketDatum>(0.0, d, name, MarketDatum::QuoteType::NONE,
-                                           MarketDatum::InstrumentType::NONE);
-}
+namespace {
+
+// a tokenised line of a csv file
+struct CsvLine {
+    Date date;
+    string key;
+    Real value;
+    Date payDate;
+    // only set for fx spot quotes which are needed to resolve the fx dominance while loading
+    QuantLib::ext::shared_ptr<MarketDatum> datum;
+};
+
+} // namespace
 
 void CSVLoader::loadFile(const string& filename, DataType dataType) {
     LOG("CSVLoader loading from " << filename);
 
     Date today = QuantLib::Settings::instance().evaluationDate();
 
-    ifstream file;
-    file.open(filename.c_str());
-    QL_REQUIRE(file.is_open(), "error opening file " << filename);
+    // read the whole file and split it into chunks of complete lines
+
+    string buffer;
+    {
+        ifstream file(filename.c_str(), std::ios::in | std::ios::binary);
+        QL_REQUIRE(file.is_open(), "error opening file " << filename);
+        file.seekg(0, std::ios::end);
+        std::streamoff size = file.tellg();
+        QL_REQUIRE(size >= 0, "error reading file " << filename);
+        file.seekg(0, std::ios::beg);
+        buffer.resize(static_cast<std::size_t>(size));
+        file.read(&buffer[0], size);
+    }
 
-    while (!file.eof()) {
-        string line;
-        getline(file, line);
-        boost::trim(line);
-        // skip blank and comment lines
-        if (line.size() > 0 && line[0] != '#') {
+    // we use one chunk per thread, but do not split small files
+    constexpr std::size_t minChunkSize = 1 << 20;
+    Size nChunks = std::max<Size>(1, std::min<Size>(nThreads_, buffer.size() / minChunkSize));
+    std::vector<std::pair<std::size_t, std::size_t>> chunks;
+    for (std::size_t start = 0, i = 1; i <= nChunks && start < buffer.size(); ++i) {
+        std::size_t end = buffer.size();
+        if (i < nChunks) {
+            end = buffer.find('\n', std::max(start, buffer.size() * i / nChunks));
+            end = end == string::npos ? buffer.size() : end + 1;
+        }
+        chunks.push_back(std::make_pair(start, end));
+        start = end;
+    }
 
+    // tokenise the chunks, the market datums are built on request except fx spot quotes
+
+    std::vector<std::vector<CsvLine>> lines(chunks.size());
+    std::vector<std::exception_ptr> errors(chunks.size());
+
+    auto parseChunk = [&buffer, &chunks, &lines, &errors, dataType](const Size c) {
+        try {
             vector<string> tokens;
-            boost::trim(line);
-            boost::split(tokens, line, boost::is_any_of(",;\t "), boost::token_compress_on);
+            std::size_t pos = chunks[c].first;
+            while (pos < chunks[c].second) {
+                std::size_t end = buffer.find('\n', pos);
+                if (end == string::npos || end > chunks[c].second)
+                    end = chunks[c].second;
+                string line = buffer.substr(pos, end - pos);
+                pos = end + 1;
+                boost::trim(line);
+                // skip blank and comment lines
+                if (line.empty() || line[0] == '#')
+                    continue;
+
+                boost::split(tokens, line, boost::is_any_of(",;\t "), boost::token_compress_on);
+
+                // TODO: should we try, catch and log any invalid lines?
+                QL_REQUIRE(tokens.size() == 3 || tokens.size() == 4, "Invalid CSVLoader line, 3 tokens expected " << line);
+                if (tokens.size() == 4)
+                    QL_REQUIRE(dataType == DataType::Dividend, "CSVLoader, dataType must be of type Dividend");
+                CsvLine l;
+                l.date = parseDate(tokens[0]);
+                l.key = std::move(tokens[1]);
+                l.value = parseReal(tokens[2]);
+                l.payDate = tokens.size() == 4 ? parseDate(tokens[3]) : l.date;
+
+                if (dataType == DataType::Market && boost::starts_with(l.key, "FX/RATE/")) {
+                    try {
+                        l.datum = parseMarketDatum(l.date, l.key, l.value);
+                    } catch (std::exception& e) {
+                        WLOG("Failed to parse MarketDatum " << l.key << ": " << e.what());
+                        continue;
+                    }
+                }
+                lines[c].push_back(std::move(l));
+            }
+        } catch (...) {
+            errors[c] = std::current_exception();
+        }
+    };
+
+    if (chunks.size() == 1) {
+        parseChunk(0);
+    } else {
+        std::vector<std::thread> threads;
+        for (Size c = 0; c < chunks.size(); ++c)
+            threads.emplace_back(parseChunk, c);
+        for (auto& t : threads)
+            t.join();
+    }
+
+    for (auto const& e : errors) {
+        if (e)
+            std::rethrow_exception(e);
+    }
 
-            // TODO: should we try, catch and log any invalid lines?
-            QL_REQUIRE(tokens.size() == 3 || tokens.size() == 4, "Invalid CSVLoader line, 3 tokens expected " << line);
-            if (tokens.size() == 4)
-                QL_REQUIRE(dataType == DataType::Dividend, "CSVLoader, dataType must be of type Dividend");
-            Date date = parseDate(tokens[0]);
-            const string& key = tokens[1];
-            Real value = parseReal(tokens[2]);
+    // add the lines in the order of the file
 
+    for (auto& chunk : lines) {
+        for (auto& l : chunk) {
+            const string& key = l.key;
+            const Date& date = l.date;
             if (dataType == DataType::Market) {
                 // process market
-                // build market datum and add to map
                 try {
-                    QuantLib::ext::shared_ptr<MarketDatum> md;
-                    try {
-                        md = parseMarketDatum(date, key, value);
-                    } catch (std::exception& e) {
-                        WLOG("Failed to parse MarketDatum " << key << ": " << e.what());
-                    }
-                    if (md != nullptr) {
-                        std::pair<bool, string> addFX = {true, ""};
-                        if (md->instrumentType() == MarketDatum::InstrumentType::FX_SPOT &&
-                            md->quoteType() == MarketDatum::QuoteType::RATE) {
-                            addFX = checkFxDuplicate(md, date);
-                            if (!addFX.second.empty()) {
-                                auto it2 = data_[date].find(makeDummyMarketDatum(date, addFX.second));
-                                TLOG("Replacing MarketDatum " << addFX.second << " with " << key
-                                                                  << " due to FX Dominance.");
-                                if (it2 != data_[date].end())
-                                    data_[date].erase(it2);
-                            }
-                        }
-                        if (addFX.first && data_[date].insert(md).second) {
-                            LOG("Added MarketDatum " << key);
-                        } else if (!addFX.first) {
-                            LOG("Skipped MarketDatum " << key << " - dominant FX already present.")
-                        }
-						else {
-                            LOG("Skipped MarketDatum " << key << " - this is already present.");
+                    std::pair<bool, string> addFX = {true, ""};
+                    if (l.datum && l.datum->instrumentType() == MarketDatum::InstrumentType::FX_SPOT &&
+                        l.datum->quoteType() == MarketDatum::QuoteType::RATE) {
+                        addFX = checkFxDuplicate(l.datum, date);
+                        if (!addFX.second.empty()) {
+                            TLOG("Replacing MarketDatum " << addFX.second << " with " << key
+                                                          << " due to FX Dominance.");
+                            data_[date].quotes.erase(addFX.second);
                         }
                     }
+                    if (addFX.first &&
+                        data_[date].quotes.emplace(key, Quote{l.value, l.datum, l.datum != nullptr}).second) {
+                        LOG("Added MarketDatum " << key);
+                    } else if (!addFX.first) {
+                        LOG("Skipped MarketDatum " << key << " - dominant FX already present.")
+                    } else {
+                        LOG("Skipped MarketDatum " << key << " - this is already present.");
+                    }
                 } catch (std::exception& e) {
                     WLOG("Failed to parse MarketDatum " << key << ": " << e.what());
                 }
@@ -164,18 +239,15 @@ void CSVLoader::loadFile(const string& filename, DataType dataType) {
                 // process fixings
                 if (date < today || (date == today && !implyTodaysFixings_)
 		    || (fixingCutOffDate_ != Date() && date <= fixingCutOffDate_)) {
-                    if(!fixings_.insert(Fixing(date, key, value)).second) {
+                    if(!fixings_.insert(Fixing(date, key, l.value)).second) {
                         WLOG("Skipped Fixing " << key << "@" << QuantLib::io::iso_date(date)
                                                << " - this is already present.");
                     }
                 }
             } else if (dataType == DataType::Dividend) {
-                Date payDate = date;
-                if (tokens.size() == 4)
-                    payDate = parseDate(tokens[3]);
                 // process dividends
                 if (date <= today) {
-                    if (!dividends_.insert(QuantExt::Dividend(date, key, value, payDate)).second) {
+                    if (!dividends_.insert(QuantExt::Dividend(date, key, l.value, l.payDate)).second) {
                         WLOG("Skipped Dividend " << key << "@" << QuantLib::io::iso_date(date)
                                                  << " - this is already present.");
                     }
@@ -185,23 +257,67 @@ void CSVLoader::loadFile(const string& filename, DataType dataType) {
             }
         }
     }
-    file.close();
     LOG("CSVLoader completed processing " << filename);
 }
 
+QuantLib::ext::shared_ptr<MarketDatum> CSVLoader::datum(const QuantLib::Date& d, const string& name,
+                                                        const Quote& quote) const {
+    {
+        boost::shared_lock<boost::shared_mutex> lock(mutex_);
+        if (quote.parsed)
+            return quote.datum;
+    }
+    QuantLib::ext::shared_ptr<MarketDatum> md;
+    try {
+        md = parseMarketDatum(d, name, quote.value);
+    } catch (std::exception& e) {
+        WLOG("Failed to parse MarketDatum " << name << ": " << e.what());
+    }
+    boost::unique_lock<boost::shared_mutex> lock(mutex_);
+    if (!quote.parsed) {
+        quote.datum = md;
+        quote.parsed = true;
+    }
+    return quote.datum;
+}
+
+const std::vector<std::string>& CSVLoader::sortedNames(const Quotes& quotes) const {
+    {
+        boost::shared_lock<boost::shared_mutex> lock(mutex_);
+        if (quotes.sorted)
+            return quotes.sortedNames;
+    }
+    boost::unique_lock<boost::shared_mutex> lock(mutex_);
+    if (!quotes.sorted) {
+        quotes.sortedNames.reserve(quotes.quotes.size());
+        for (auto const& q : quotes.quotes)
+            quotes.sortedNames.push_back(q.first);
+        std::sort(quotes.sortedNames.begin(), quotes.sortedNames.end());
+        quotes.sorted = true;
+    }
+    return quotes.sortedNames;
+}
+
 vector<QuantLib::ext::shared_ptr<MarketDatum>> CSVLoader::loadQuotes(const QuantLib::Date& d) const {
     auto it = data_.find(d);
     if (it == data_.end())
         return {};
-    return std::vector<QuantLib::ext::shared_ptr<MarketDatum>>(it->second.begin(), it->second.end());
+    std::vector<QuantLib::ext::shared_ptr<MarketDatum>> result;
+    for (auto const& n : sortedNames(it->second)) {
+        if (auto md = datum(d, n, it->second.quotes.at(n)))
+            result.push_back(md);
+    }
+    return result;
 }
 
 QuantLib::ext::shared_ptr<MarketDatum> CSVLoader::get(const string& name, const QuantLib::Date& d) const {
     auto it = data_.find(d);
     QL_REQUIRE(it != data_.end(), "No datum for " << name << " on date " << d);
-    auto it2 = it->second.find(makeDummyMarketDatum(d, name));
-    QL_REQUIRE(it2 != it->second.end(), "No datum for " << name << " on date " << d);
-    return *it2;
+    auto it2 = it->second.quotes.find(name);
+    QL_REQUIRE(it2 != it->second.quotes.end(), "No datum for " << name << " on date " << d);
+    auto md = datum(d, name, it2->second);
+    QL_REQUIRE(md, "No datum for " << name << " on date " << d);
+    return md;
 }
 
 std::set<QuantLib::ext::shared_ptr<MarketDatum>> CSVLoader::get(const std::set<std::string>& names,
@@ -211,9 +327,11 @@ std::set<QuantLib::ext::shared_ptr<MarketDatum>> CSVLoader::get(const std::set<s
         return {};
     std::set<QuantLib::ext::shared_ptr<MarketDatum>> result;
     for (auto const& n : names) {
-        auto it2 = it->second.find(makeDummyMarketDatum(asof, n));
-        if (it2 != it->second.end())
-            result.insert(*it2);
+        auto it2 = it->second.quotes.find(n);
+        if (it2 != it->second.quotes.end()) {
+            if (auto md = datum(asof, n, it2->second))
+                result.insert(md);
+        }
     }
     return result;
 }
@@ -232,20 +350,23 @@ std::set<QuantLib::ext::shared_ptr<MarketDatum>> CSVLoader::get(const Wildcard&
     if (it == data_.end())
         return {};
     std::set<QuantLib::ext::shared_ptr<MarketDatum>> result;
-    std::set<QuantLib::ext::shared_ptr<MarketDatum>>::iterator it1, it2;
+    const std::vector<std::string>& names = sortedNames(it->second);
+    std::vector<std::string>::const_iterator it1, it2;
     if (wildcard.wildcardPos() == 0) {
         // wildcard at first position => we have to search all of the data
-        it1 = it->second.begin();
-        it2 = it->second.end();
+        it1 = names.begin();
+        it2 = names.end();
     } else {
         // search the range matching the substring of the pattern until the wildcard
         std::string prefix = wildcard.pattern().substr(0, wildcard.wildcardPos());
-        it1 = it->second.lower_bound(makeDummyMarketDatum(asof, prefix));
-        it2 = it->second.upper_bound(makeDummyMarketDatum(asof, prefix + "\xFF"));
+        it1 = std::lower_bound(names.begin(), names.end(), prefix);
+        it2 = std::upper_bound(names.begin(), names.end(), prefix + "\xFF");
     }
-    for (auto it = it1; it != it2; ++it) {
-        if (wildcard.isPrefix() || wildcard.matches((*it)->name()))
-            result.insert(*it);
+    for (auto n = it1; n != it2; ++n) {
+        if (wildcard.isPrefix() || wildcard.matches(*n)) {
+            if (auto md = datum(asof, *n, it->second.quotes.at(*n)))
+                result.insert(md);
+        }
     }
     return result;
 }
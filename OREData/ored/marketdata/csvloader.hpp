@@ -26,6 +26,10 @@
 #include <map>
 #include <ored/marketdata/loader.hpp>
 
+#include <boost/thread/shared_mutex.hpp>
+
+#include <unordered_map>
+
 namespace ore {
 namespace data {
 
@@ -34,6 +38,11 @@ namespace data {
   Data is loaded with the call to the constructor.
   Inspectors can be called to then retrieve quotes and fixings.
 
+  Each file is read into memory in one go and split into chunks of lines that are tokenised on nThreads threads. The
+  market quotes are stored by date in a hash map on the quote name, the MarketDatum of a quote is only built on its
+  first request. Quotes that can not be parsed are skipped at that point. The inspectors can be called from several
+  threads.
+
   TODO implementation has large overlap with inmemoryloader.?pp, factor this out
 
   \ingroup marketdata
@@ -50,7 +59,9 @@ public:
         //! Enable/disable implying today's fixings
         bool implyTodaysFixings = false,
 	//! Load fixings up to this date
-	Date fixingCutOffDate = Date());
+	Date fixingCutOffDate = Date(),
+        //! Number of threads used to parse the files
+        QuantLib::Size nThreads = 1);
 
     CSVLoader( //! Quote file name
         const vector<string>& marketFiles,
@@ -59,7 +70,9 @@ public:
         //! Enable/disable implying today's fixings
         bool implyTodaysFixings = false,
 	//! Load fixings up to this date
-	Date fixingCutOffDate = Date());
+	Date fixingCutOffDate = Date(),
+        //! Number of threads used to parse the files
+        QuantLib::Size nThreads = 1);
 
     CSVLoader( //! Quote file name
         const string& marketFilename,
@@ -70,7 +83,9 @@ public:
         //! Enable/disable implying today's fixings
         bool implyTodaysFixings = false,
 	//! Load fixings up to this date
-	Date fixingCutOffDate = Date());
+	Date fixingCutOffDate = Date(),
+        //! Number of threads used to parse the files
+        QuantLib::Size nThreads = 1);
 
     CSVLoader( //! Quote file name
         const vector<string>& marketFiles,
@@ -81,7 +96,9 @@ public:
         //! Enable/disable implying today's fixings
         bool implyTodaysFixings = false,
 	//! Load fixings up to this date
-	Date fixingCutOffDate = Date());
+	Date fixingCutOffDate = Date(),
+        //! Number of threads used to parse the files
+        QuantLib::Size nThreads = 1);
 
     std::vector<QuantLib::ext::shared_ptr<MarketDatum>> loadQuotes(const QuantLib::Date&) const override;
 
@@ -101,11 +118,32 @@ private:
     enum class DataType { Market, Fixing, Dividend };
     void loadFile(const string&, DataType);
 
+    // a quote as read from the file, the market datum is built on the first request
+    struct Quote {
+        QuantLib::Real value;
+        mutable QuantLib::ext::shared_ptr<MarketDatum> datum;
+        mutable bool parsed;
+    };
+
+    // the quotes for one date, the sorted names are needed for loadQuotes() and wildcard lookups only
+    struct Quotes {
+        std::unordered_map<std::string, Quote> quotes;
+        mutable std::vector<std::string> sortedNames;
+        mutable bool sorted = false;
+    };
+
+    QuantLib::ext::shared_ptr<MarketDatum> datum(const QuantLib::Date& d, const std::string& name,
+                                                 const Quote& quote) const;
+    const std::vector<std::string>& sortedNames(const Quotes& quotes) const;
+
     bool implyTodaysFixings_;
-    std::map<QuantLib::Date, std::set<QuantLib::ext::shared_ptr<MarketDatum>, SharedPtrMarketDatumComparator>> data_;
+    std::map<QuantLib::Date, Quotes> data_;
     std::set<Fixing> fixings_;
     std::set<QuantExt::Dividend> dividends_;
     Date fixingCutOffDate_;
+    QuantLib::Size nThreads_;
+    // guards the lazily built market datums and sorted names
+    mutable boost::shared_mutex mutex_;
 };
 } // namespace data
 } // namespace ore
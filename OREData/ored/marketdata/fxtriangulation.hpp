@@ -31,6 +31,8 @@
 #include <ql/quote.hpp>
 #include <ql/types.hpp>
 
+#include <boost/thread/shared_mutex.hpp>
+
 #include <vector>
 
 namespace ore {
@@ -44,6 +46,11 @@ public:
     /*! Set up fx quote repository with available market quotes ccypair => quote */
     explicit FXTriangulation(std::map<std::string, QuantLib::Handle<QuantLib::Quote>> quotes);
 
+    /*! The caches are guarded by a mutex, so that quotes and indices can be retrieved from several threads. Copies
+        take a snapshot of the caches. */
+    FXTriangulation(const FXTriangulation& other);
+    FXTriangulation& operator=(const FXTriangulation& other);
+
     /*! Get quote, possibly via triangulation
         If you need an exact handling of spot lag differences, use getIndex() instead.
     */
@@ -75,6 +82,7 @@ private:
     // caches to improve perfomance
     mutable std::map<std::string, QuantLib::Handle<QuantLib::Quote>> quoteCache_;
     mutable std::map<std::pair<std::string, std::string>, QuantLib::Handle<QuantExt::FxIndex>> indexCache_;
+    mutable boost::shared_mutex cacheMutex_;
 
     // internal data structure to represent the undirected graph of currencies
     std::vector<std::string> nodeToCcy_;
@@ -17,6 +17,7 @@
 */
 
 #include <ored/marketdata/market.hpp>
+#include <ored/marketdata/marketobjectrecorder.hpp>
 #include <ored/utilities/currencyparser.hpp>
 #include <ored/utilities/indexparser.hpp>
 #include <ored/utilities/log.hpp>
@@ -168,6 +169,8 @@ QuantLib::Handle<QuantExt::FxIndex> Market::fxIndex(const string& fxIndex, const
     }
 
     if (hasPseudoCurrencyConfigPair(forCcy + domCcy)) {
+        // cached pseudo currency objects are not reported to a recorder, so we can not record them
+        MarketObjectRecorder::recordUnknown();
         DLOG("Market::fxIndex() requested for PM pair " << forCcy << domCcy);
         string index = "FX-" + familyName + "-" + forCcy + "-" + domCcy;
         Handle<QuantExt::FxIndex> fxInd;
@@ -217,6 +220,8 @@ Handle<Quote> Market::fxRate(const string& pair, const string& config) const {
     if (!handlePseudoCurrencies_ || GlobalPseudoCurrencyMarketParameters::instance().get().treatAsFX)
         return fxRateImpl(pair, config);
     if (hasPseudoCurrencyConfigPair(pair)) {
+        // cached pseudo currency objects are not reported to a recorder, so we can not record them
+        MarketObjectRecorder::recordUnknown();
         DLOG("Market::fxSpot() requested for PM pair " << pair);
         if (fxRateCache_.find(pair) == fxRateCache_.end()) {
             // Get the FX Spot rate. Rather than deal with all the combinations we just get the FX rate for each vs
@@ -242,6 +247,8 @@ Handle<Quote> Market::fxSpot(const string& pair, const string& config) const {
     if (!handlePseudoCurrencies_ || GlobalPseudoCurrencyMarketParameters::instance().get().treatAsFX)
         return fxSpotImpl(pair, config);
     if (hasPseudoCurrencyConfigPair(pair)) {
+        // cached pseudo currency objects are not reported to a recorder, so we can not record them
+        MarketObjectRecorder::recordUnknown();
         DLOG("Market::fxSpot() requested for PM pair " << pair);
         if (spotCache_.find(pair) == spotCache_.end()) {
             // Get the FX Spot rate. Rather than deal with all the combinations we just get the FX rate for each vs
@@ -289,6 +296,8 @@ Handle<BlackVolTermStructure> Market::fxVol(const string& pair, const string& co
         return fxVolImpl(pair, config);
 
     if (hasPseudoCurrencyConfigPair(pair)) {
+        // cached pseudo currency objects are not reported to a recorder, so we can not record them
+        MarketObjectRecorder::recordUnknown();
         DLOG("Market::fxVol() requested for PM pair " << pair);
         if (volCache_.find(pair) == volCache_.end()) {
 
@@ -20,6 +20,7 @@
 #include <boost/make_shared.hpp>
 #include <ored/configuration/conventions.hpp>
 #include <ored/marketdata/marketimpl.hpp>
+#include <ored/marketdata/marketobjectrecorder.hpp>
 #include <ored/utilities/indexparser.hpp>
 #include <ored/utilities/marketdata.hpp>
 #include <ored/utilities/parsers.hpp>
@@ -196,7 +197,13 @@ Handle<QuantLib::SwaptionVolatilityStructure> MarketImpl::yieldVol(const string&
                                                                  "yield volatility curve");
 }
 
+void MarketImpl::require(const MarketObject o, const string& name, const string& configuration,
+                         const bool forceBuild) const {
+    MarketObjectRecorder::record(o, name);
+}
+
 Handle<QuantExt::FxIndex> MarketImpl::fxIndexImpl(const string& fxIndex, const string& configuration) const {
+    MarketObjectRecorder::record(MarketObject::FXSpot, fxIndex);
     QL_REQUIRE(fx_ != nullptr,
                "MarketImpl::fxIndex(" << fxIndex << "): fx_ is null. This is an internal error. Contact dev.");
     return fx_->getIndex(fxIndex, this, configuration);
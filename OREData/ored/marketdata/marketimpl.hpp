@@ -197,9 +197,12 @@ protected:
         it should be tried to be built for the "default" configuration instead, because this is used
         as a fallback.
 
-        Notice that correlation curves are required with '&' as a delimiter between the indexes. */
+        Notice that correlation curves are required with '&' as a delimiter between the indexes.
+
+        The default implementation reports the object to the MarketObjectRecorder, derived classes that overwrite
+        this method should do the same. */
     virtual void require(const MarketObject o, const string& name, const string& configuration,
-                         const bool forceBuild = false) const {}
+                         const bool forceBuild = false) const;
     
     Date asof_;
     // fx quotes / indices, this is shared between all configurations
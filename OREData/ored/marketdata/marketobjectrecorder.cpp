@@ -0,0 +1,51 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <ored/marketdata/marketobjectrecorder.hpp>
+
+namespace ore {
+namespace data {
+
+namespace {
+thread_local MarketObjectRecorder* currentRecorder = nullptr;
+}
+
+MarketObjectRecorder::MarketObjectRecorder() : parent_(currentRecorder) { currentRecorder = this; }
+
+MarketObjectRecorder::~MarketObjectRecorder() {
+    currentRecorder = parent_;
+    if (parent_) {
+        parent_->objects_.insert(objects_.begin(), objects_.end());
+        parent_->complete_ = parent_->complete_ && complete_;
+    }
+}
+
+bool MarketObjectRecorder::active() { return currentRecorder != nullptr; }
+
+void MarketObjectRecorder::record(const MarketObject o, const std::string& name) {
+    if (currentRecorder)
+        currentRecorder->objects_.insert(std::make_pair(o, name));
+}
+
+void MarketObjectRecorder::recordUnknown() {
+    if (currentRecorder)
+        currentRecorder->complete_ = false;
+}
+
+} // namespace data
+} // namespace ore
@@ -0,0 +1,71 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file ored/marketdata/marketobjectrecorder.hpp
+    \brief records the market objects that are required from a market
+    \ingroup marketdata
+*/
+
+#pragma once
+
+#include <ored/marketdata/market.hpp>
+
+#include <set>
+#include <string>
+#include <utility>
+
+namespace ore {
+namespace data {
+
+//! Records the market objects that are required from a market on the current thread
+/*! While a recorder is alive, the market objects required on the same thread are recorded by it. Recorders can be
+    nested, the objects recorded by an inner recorder are added to the enclosing recorder on destruction.
+
+    A market reports the objects it is asked for by calling record(). If the objects required by a piece of code can
+    not be determined, e.g. because a pricing engine was taken from a cache that was filled while no recorder was
+    alive, recordUnknown() must be called, which marks the recorder as incomplete.
+
+    \ingroup marketdata
+*/
+class MarketObjectRecorder {
+public:
+    MarketObjectRecorder();
+    ~MarketObjectRecorder();
+    MarketObjectRecorder(const MarketObjectRecorder&) = delete;
+    MarketObjectRecorder& operator=(const MarketObjectRecorder&) = delete;
+
+    //! true if a recorder is alive on the current thread
+    static bool active();
+    //! record a market object with the innermost recorder on the current thread, if any
+    static void record(const MarketObject o, const std::string& name);
+    //! mark the innermost recorder on the current thread as incomplete, if any
+    static void recordUnknown();
+
+    //! the market objects recorded so far
+    const std::set<std::pair<MarketObject, std::string>>& objects() const { return objects_; }
+    //! false if recordUnknown() was called, i.e. objects() might not contain all required market objects
+    bool complete() const { return complete_; }
+
+private:
+    MarketObjectRecorder* parent_;
+    std::set<std::pair<MarketObject, std::string>> objects_;
+    bool complete_ = true;
+};
+
+} // namespace data
+} // namespace ore
@@ -34,6 +34,7 @@
 #include <ored/marketdata/fxvolcurve.hpp>
 #include <ored/marketdata/inflationcapfloorvolcurve.hpp>
 #include <ored/marketdata/inflationcurve.hpp>
+#include <ored/marketdata/marketobjectrecorder.hpp>
 #include <ored/marketdata/security.hpp>
 #include <ored/marketdata/structuredcurveerror.hpp>
 #include <ored/marketdata/swaptionvolcurve.hpp>
@@ -53,6 +54,7 @@
 #include <qle/termstructures/blackvolsurfacewithatm.hpp>
 #include <qle/termstructures/pricetermstructureadapter.hpp>
 
+#include <ql/settings.hpp>
 #include <ql/tuple.hpp>
 
 #include <boost/graph/topological_sort.hpp>
@@ -60,6 +62,11 @@
 #include <boost/range/adaptor/reversed.hpp>
 #include <boost/timer/timer.hpp>
 
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
 using namespace std;
 using namespace QuantLib;
 
@@ -79,11 +86,12 @@ TodaysMarket::TodaysMarket(const Date& asof, const QuantLib::ext::shared_ptr<Tod
                            const bool loadFixings, const bool lazyBuild,
                            const QuantLib::ext::shared_ptr<ReferenceDataManager>& referenceData,
                            const bool preserveQuoteLinkage, const IborFallbackConfig& iborFallbackConfig,
-                           const bool buildCalibrationInfo, const bool handlePseudoCurrencies)
+                           const bool buildCalibrationInfo, const bool handlePseudoCurrencies,
+                           const QuantLib::Size nThreads)
     : MarketImpl(handlePseudoCurrencies), params_(params), loader_(loader), curveConfigs_(curveConfigs),
       continueOnError_(continueOnError), loadFixings_(loadFixings), lazyBuild_(lazyBuild),
       preserveQuoteLinkage_(preserveQuoteLinkage), referenceData_(referenceData),
-      iborFallbackConfig_(iborFallbackConfig), buildCalibrationInfo_(buildCalibrationInfo) {
+      iborFallbackConfig_(iborFallbackConfig), buildCalibrationInfo_(buildCalibrationInfo), nThreads_(nThreads) {
     QL_REQUIRE(params_, "TodaysMarket: TodaysMarketParameters are null");
     QL_REQUIRE(loader_, "TodaysMarket: Loader is null");
     QL_REQUIRE(curveConfigs_, "TodaysMarket: CurveConfigurations are null");
@@ -159,6 +167,14 @@ void TodaysMarket::initialise(const Date& asof) {
 
     if (!lazyBuild_) {
 
+        // Build the yield curves on several threads upfront, the nodes are then only added to the market below
+
+        if (nThreads_ > 1) {
+            timer.start();
+            buildYieldCurvesInParallel();
+            timings["5 build yield curves in parallel"] = timer.elapsed().wall;
+        }
+
         // We need to build all discount curves first, since some curve builds ask for discount
         // curves from specific configurations
         timer.start();
@@ -259,6 +275,231 @@ void TodaysMarket::initialise(const Date& asof) {
 
 } // TodaysMarket::initialise()
 
+namespace {
+// provides the in-ccy discount curves looked up by cross currency yield curves that are built in parallel
+class InCcyDiscountCurves : public MarketImpl {
+public:
+    InCcyDiscountCurves(const bool handlePseudoCurrencies,
+                        const std::map<std::string, Handle<YieldTermStructure>>& discountCurves)
+        : MarketImpl(handlePseudoCurrencies) {
+        for (auto const& [ccy, c] : discountCurves)
+            yieldCurves_[make_tuple(Market::inCcyConfiguration, YieldCurveType::Discount, ccy)] = c;
+    }
+};
+} // namespace
+
+void TodaysMarket::buildYieldCurvesInParallel() {
+
+#if !defined(QL_ENABLE_SESSIONS) || !defined(QL_ENABLE_THREAD_SAFE_OBSERVER_PATTERN)
+
+    WLOG("TodaysMarket: building yield curves on "
+         << nThreads_
+         << " threads requires a QuantLib build with QL_ENABLE_SESSIONS and QL_ENABLE_THREAD_SAFE_OBSERVER_PATTERN, "
+            "the market is built on one thread.");
+
+#else
+
+    // collect the yield curve specs over all configurations and the yield curve specs they depend on, specs depending
+    // on other market objects than yield curves (directly or indirectly) are left to the serial build
+
+    std::map<std::string, QuantLib::ext::shared_ptr<YieldCurveSpec>> specs;
+    std::map<std::string, std::set<std::string>> dependencies;
+    std::map<std::string, std::set<std::string>> inCcyDiscountCurrencies;
+    std::set<std::string> excluded;
+
+    for (auto& [configuration, g] : dependencies_) {
+        VertexIterator v, vend;
+        for (std::tie(v, vend) = boost::vertices(g); v != vend; ++v) {
+            if (!g[*v].curveSpec || g[*v].curveSpec->baseType() != CurveSpec::CurveType::Yield)
+                continue;
+            auto ycspec = QuantLib::ext::dynamic_pointer_cast<YieldCurveSpec>(g[*v].curveSpec);
+            if (!ycspec || requiredYieldCurves_.count(ycspec->name()) > 0)
+                continue;
+            specs[ycspec->name()] = ycspec;
+            auto& deps = dependencies[ycspec->name()];
+            boost::graph_traits<Graph>::out_edge_iterator e, eend;
+            for (std::tie(e, eend) = boost::out_edges(*v, g); e != eend; ++e) {
+                const Node& w = g[boost::target(*e, g)];
+                if (w.curveSpec && w.curveSpec->baseType() == CurveSpec::CurveType::Yield)
+                    deps.insert(w.curveSpec->name());
+                else
+                    excluded.insert(ycspec->name());
+                // cross currency segments without a foreign discount curve id look up the in-ccy discount curve
+                if (w.obj == MarketObject::DiscountCurve)
+                    inCcyDiscountCurrencies[ycspec->name()].insert(w.name);
+            }
+        }
+    }
+
+    // resolve the in-ccy discount curves as the market lookup does, i.e. with a fallback to the default configuration,
+    // and add them to the dependencies, so that they can be passed to the yield curves built in parallel
+
+    auto inCcyDiscountSpec = [this](const std::string& ccy) -> std::string {
+        for (auto const& configuration : {Market::inCcyConfiguration, Market::defaultConfiguration}) {
+            auto g = dependencies_.find(configuration);
+            if (g == dependencies_.end())
+                continue;
+            VertexIterator v, vend;
+            for (std::tie(v, vend) = boost::vertices(g->second); v != vend; ++v) {
+                const Node& n = g->second[*v];
+                if (n.obj == MarketObject::DiscountCurve && n.name == ccy && n.curveSpec)
+                    return n.curveSpec->name();
+            }
+        }
+        return std::string();
+    };
+
+    std::map<std::string, std::map<std::string, std::string>> inCcyDiscountCurves;
+    for (auto const& [name, ccys] : inCcyDiscountCurrencies) {
+        for (auto const& ccy : ccys) {
+            std::string d = inCcyDiscountSpec(ccy);
+            if (d.empty() || d == name) {
+                excluded.insert(name);
+            } else {
+                inCcyDiscountCurves[name][ccy] = d;
+                dependencies[name].insert(d);
+            }
+        }
+    }
+
+    for (bool changed = true; changed;) {
+        changed = false;
+        for (auto const& [name, deps] : dependencies) {
+            if (excluded.count(name) > 0)
+                continue;
+            for (auto const& d : deps) {
+                if (excluded.count(d) > 0 || specs.count(d) == 0) {
+                    excluded.insert(name);
+                    changed = true;
+                    break;
+                }
+            }
+        }
+    }
+
+    // set up the number of open dependencies per spec and the specs that can be built right away
+
+    std::map<std::string, Size> openDependencies;
+    std::map<std::string, std::vector<std::string>> dependents;
+    std::deque<std::string> ready;
+    for (auto const& [name, deps] : dependencies) {
+        if (excluded.count(name) > 0)
+            continue;
+        openDependencies[name] = deps.size();
+        for (auto const& d : deps)
+            dependents[d].push_back(name);
+        if (deps.empty())
+            ready.push_back(name);
+    }
+
+    LOG("TodaysMarket: build " << openDependencies.size() << " yield curves on " << nThreads_ << " threads, "
+                               << excluded.size() << " yield curves are left to the serial build.");
+
+    // run the builds, a spec is scheduled as soon as all yield curves it depends on are built; failed builds are not
+    // reported here, they are retried and reported by the serial build together with their dependents
+
+    std::map<std::string, QuantLib::ext::shared_ptr<YieldCurve>> built;
+    std::map<std::string, std::string> errors;
+    Size inProgress = 0;
+    std::mutex mutex;
+    std::condition_variable cv;
+
+    Date evaluationDate = Settings::instance().evaluationDate();
+    std::set<Fixing> fixings;
+    if (loadFixings_)
+        fixings = loader_->loadFixings();
+
+    auto worker = [&]() {
+        // the evaluation date and the fixings are session specific, if they can not be set, this thread does not
+        // build any curves, these are left to the other threads or the serial build
+        try {
+            Settings::instance().evaluationDate() = evaluationDate;
+            applyFixings(fixings);
+        } catch (const std::exception& e) {
+            WLOG("TodaysMarket: could not set up thread for parallel yield curve build: " << e.what());
+            return;
+        } catch (...) {
+            WLOG("TodaysMarket: could not set up thread for parallel yield curve build: unknown error");
+            return;
+        }
+        while (true) {
+            std::string name;
+            map<string, QuantLib::ext::shared_ptr<YieldCurve>> requiredYieldCurves;
+            std::map<std::string, Handle<YieldTermStructure>> discountCurves;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                cv.wait(lock, [&]() { return !ready.empty() || inProgress == 0; });
+                if (ready.empty())
+                    return;
+                name = ready.front();
+                ready.pop_front();
+                ++inProgress;
+                for (auto const& d : dependencies.at(name))
+                    requiredYieldCurves[d] = built.at(d);
+                if (auto c = inCcyDiscountCurves.find(name); c != inCcyDiscountCurves.end()) {
+                    for (auto const& [ccy, d] : c->second)
+                        discountCurves[ccy] = built.at(d)->handle();
+                }
+            }
+            QuantLib::ext::shared_ptr<YieldCurve> yieldCurve;
+            std::string error;
+            try {
+                InCcyDiscountCurves market(handlePseudoCurrencies_, discountCurves);
+                yieldCurve = QuantLib::ext::make_shared<YieldCurve>(
+                    asof_, *specs.at(name), *curveConfigs_, *loader_, requiredYieldCurves, requiredDefaultCurves_, *fx_,
+                    referenceData_, iborFallbackConfig_, preserveQuoteLinkage_, buildCalibrationInfo_, &market);
+            } catch (const std::exception& e) {
+                error = e.what();
+            } catch (...) {
+                error = "unknown error";
+            }
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                --inProgress;
+                if (yieldCurve) {
+                    built[name] = yieldCurve;
+                    for (auto const& d : dependents[name]) {
+                        if (--openDependencies.at(d) == 0)
+                            ready.push_back(d);
+                    }
+                } else {
+                    errors[name] = error;
+                }
+            }
+            cv.notify_all();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (Size i = 0; i < std::min(nThreads_, openDependencies.size()); ++i)
+        threads.emplace_back(worker);
+    for (auto& t : threads)
+        t.join();
+
+    // add the built curves to the cache, the market objects themselves are added in buildNode()
+
+    for (auto const& [name, yieldCurve] : built) {
+        calibrationInfo_->yieldCurveCalibrationInfo[name] = yieldCurve->calibrationInfo();
+        requiredYieldCurves_[name] = yieldCurve;
+        DLOG("Added YieldCurve \"" << name << "\" to requiredYieldCurves map");
+        if (yieldCurve->currency().code() != specs.at(name)->ccy()) {
+            WLOG("Warning: YieldCurve has ccy " << yieldCurve->currency() << " but spec has ccy "
+                                                << specs.at(name)->ccy());
+        }
+    }
+
+    for (auto const& [name, error] : errors) {
+        DLOG("TodaysMarket: yield curve " << name << " could not be built in parallel (" << error
+                                          << "), it is retried in the serial build.");
+    }
+
+    LOG("TodaysMarket: built " << built.size() << " yield curves in parallel, " << errors.size() << " failed, "
+                               << openDependencies.size() - built.size() - errors.size()
+                               << " depend on failed curves.");
+
+#endif
+}
+
 void TodaysMarket::buildNode(const std::string& configuration, Node& node) const {
 
     // if the node is already built, there is nothing to do
@@ -815,6 +1056,8 @@ void TodaysMarket::buildNode(const std::string& configuration, Node& node) const
 void TodaysMarket::require(const MarketObject o, const string& name, const string& configuration,
                            const bool forceBuild) const {
 
+    MarketObjectRecorder::record(o, name);
+
     // if the market is not lazily built, do nothing
 
     if (!lazyBuild_ && !forceBuild)
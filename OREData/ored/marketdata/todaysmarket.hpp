@@ -103,7 +103,10 @@ public:
         //! build calibration info?
         const bool buildCalibrationInfo = true,
         //! support pseudo currencies
-        const bool handlePseudoCurrencies = true);
+        const bool handlePseudoCurrencies = true,
+        /*! Number of threads used to build the yield curves in a non-lazy build, this requires a QuantLib build
+            with sessions and the thread safe observer pattern enabled, otherwise the market is built on one thread */
+        const QuantLib::Size nThreads = 1);
 
     QuantLib::ext::shared_ptr<TodaysMarketCalibrationInfo> calibrationInfo() const { return calibrationInfo_; }
 
@@ -125,6 +128,7 @@ private:
     const QuantLib::ext::shared_ptr<ReferenceDataManager> referenceData_;
     const IborFallbackConfig iborFallbackConfig_;
     const bool buildCalibrationInfo_;
+    const QuantLib::Size nThreads_;
 
     // initialise market
     void initialise(const Date& asof);
@@ -142,6 +146,9 @@ private:
     // build a single market object
     void buildNode(const std::string& configuration, Node& node) const;
 
+    // build the yield curves of all configurations that only depend on other yield curves on several threads
+    void buildYieldCurvesInParallel();
+
     // calibration results
     QuantLib::ext::shared_ptr<TodaysMarketCalibrationInfo> calibrationInfo_;
 
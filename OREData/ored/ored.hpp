@@ -67,6 +67,7 @@
 #include <ored/marketdata/marketdatum.hpp>
 #include <ored/marketdata/marketdatumparser.hpp>
 #include <ored/marketdata/marketimpl.hpp>
+#include <ored/marketdata/marketobjectrecorder.hpp>
 #include <ored/marketdata/security.hpp>
 #include <ored/marketdata/strike.hpp>
 #include <ored/marketdata/structuredcurveerror.hpp>
@@ -378,6 +379,7 @@
 #include <ored/scripting/scriptedinstrument.hpp>
 #include <ored/scripting/scriptengine.hpp>
 #include <ored/scripting/scriptparser.hpp>
+#include <ored/scripting/scriptprogram.hpp>
 #include <ored/scripting/staticanalyser.hpp>
 #include <ored/scripting/utilities.hpp>
 #include <ored/scripting/value.hpp>
@@ -23,6 +23,7 @@
 
 #pragma once
 
+#include <ored/marketdata/marketobjectrecorder.hpp>
 #include <ored/portfolio/enginefactory.hpp>
 
 #include <ql/cashflows/couponpricer.hpp>
@@ -46,6 +47,10 @@ namespace data {
  *  The remaining variable arguments are to be passed to engine() and
  *  engineImpl(), these are the specific parameters required to build
  *  an engine or coupon pricer for this trade type.
+ *
+ *  If a MarketObjectRecorder is active when an engine is created, the market objects required to build it are
+ *  stored with the cached engine and recorded again whenever the cached engine is returned, so that the recorded
+ *  market objects of a trade do not depend on whether its engine was built or taken from the cache.
     \ingroup builders
  */
 template <class T, class U, typename... Args> class CachingEngineBuilder : public EngineBuilder {
@@ -62,21 +67,44 @@ public:
     QuantLib::ext::shared_ptr<U> engine(Args... params) {
         T key = keyImpl(params...);
         if (engines_.find(key) == engines_.end()) {
-            // build first (in case it throws)
-            QuantLib::ext::shared_ptr<U> engine = engineImpl(params...);
-            // then add to map
-            engines_[key] = engine;
+            if (MarketObjectRecorder::active()) {
+                MarketObjectRecorder recorder;
+                // build first (in case it throws)
+                QuantLib::ext::shared_ptr<U> engine = engineImpl(params...);
+                // then add to maps
+                engines_[key] = engine;
+                if (recorder.complete())
+                    marketObjects_[key] = recorder.objects();
+            } else {
+                // build first (in case it throws)
+                QuantLib::ext::shared_ptr<U> engine = engineImpl(params...);
+                // then add to map
+                engines_[key] = engine;
+            }
+        } else if (MarketObjectRecorder::active()) {
+            auto m = marketObjects_.find(key);
+            if (m == marketObjects_.end()) {
+                MarketObjectRecorder::recordUnknown();
+            } else {
+                for (auto const& [o, name] : m->second)
+                    MarketObjectRecorder::record(o, name);
+            }
         }
         return engines_[key];
     }
 
-    void reset() override { engines_.clear(); }
+    void reset() override {
+        engines_.clear();
+        marketObjects_.clear();
+    }
 
 protected:
     virtual T keyImpl(Args...) = 0;
     virtual QuantLib::ext::shared_ptr<U> engineImpl(Args...) = 0;
 
     map<T, QuantLib::ext::shared_ptr<U>> engines_;
+    // market objects required to build the cached engines, if they were recorded
+    map<T, std::set<std::pair<MarketObject, std::string>>> marketObjects_;
 };
 
 template <class T, typename... Args>
@@ -319,10 +319,15 @@ ScriptedTradeEngineBuilder::engine(const std::string& id, const ScriptedTrade& s
 
     QuantLib::ext::shared_ptr<ScriptedInstrument::engine> engine;
     if (model_) {
+        auto& program = programCache_[script.code()];
+        if (program == nullptr) {
+            program = QuantLib::ext::make_shared<ScriptProgram>(ast_);
+            DLOG("compiled ast to program with " << program->instructions().size() << " instructions");
+        }
         engine = QuantLib::ext::make_shared<ScriptedInstrumentPricingEngine>(
             script.npv(), script.results(), model_, ast_, context, script.code(), interactive_, amcCam_ != nullptr,
             std::set<std::string>(script.stickyCloseOutStates().begin(), script.stickyCloseOutStates().end()),
-            generateAdditionalResults, includePastCashflows_);
+            generateAdditionalResults, includePastCashflows_, program);
     } else if (modelCG_) {
         auto rt = globalParameters_.find("RunType");
         std::string runType = rt != globalParameters_.end() ? rt->second : "<<no run type set>>";
@@ -558,6 +563,10 @@ void ScriptedTradeEngineBuilder::populateModelParameters() {
         }
         mcParams_.regressionVarianceCutoff =
             parseRealOrNull(engineParameter("RegressionVarianceCutoff", {resolvedProductTag_}, false, std::string()));
+        mcParams_.regressionMethod =
+            parseRandomVariableRegressionMethod(engineParameter("RegressionMethod", {resolvedProductTag_}, false, "QR"));
+        mcParams_.regressionThreads =
+            parseInteger(engineParameter("RegressionThreads", {resolvedProductTag_}, false, "1"));
         mcParams_.externalDeviceCompatibilityMode = externalDeviceCompatibilityMode_;
     } else if (engineParam_ == "FD") {
         modelSize_ = parseInteger(engineParameter("StateGridPoints", {resolvedProductTag_}));
@@ -22,6 +22,7 @@
 #include <ored/scripting/models/modelcg.hpp>
 #include <ored/portfolio/scriptedtrade.hpp>
 #include <ored/scripting/ast.hpp>
+#include <ored/scripting/scriptprogram.hpp>
 #include <ored/scripting/staticanalyser.hpp>
 #include <ored/scripting/utilities.hpp>
 #include <ored/scripting/scriptedinstrument.hpp>
@@ -113,6 +114,8 @@ protected:
 
     // cache for parsed asts
     std::map<std::string, ASTNodePtr> astCache_;
+    // cache for programs compiled from the cached asts
+    std::map<std::string, QuantLib::ext::shared_ptr<ScriptProgram>> programCache_;
 
     // populated by a call to engine()
     ASTNodePtr ast_;
@@ -109,6 +109,7 @@ void CommodityDigitalOption::build(const QuantLib::ext::shared_ptr<EngineFactory
     QuantLib::ext::shared_ptr<Instrument> inst2 = opt2.instrument()->qlInstrument();
 
     setSensitivityTemplate(opt1.sensitivityTemplate());
+    setPricingModelEngine(opt1);
 
     QuantLib::ext::shared_ptr<CompositeInstrument> composite = QuantLib::ext::make_shared<CompositeInstrument>();
     // add and subtract such that the long call spread and long put spread have positive values
@@ -191,6 +191,7 @@ void EngineFactory::registerBuilder(const QuantLib::ext::shared_ptr<EngineBuilde
     const string& modelName = builder->model();
     const string& engineName = builder->engine();
     auto key = make_tuple(modelName, engineName, builder->tradeTypes());
+    resolvedBuilders_.clear();
     if (allowOverwrite)
         builders_.erase(key);
     QL_REQUIRE(builders_.insert(make_pair(key, builder)).second,
@@ -204,21 +205,30 @@ QuantLib::ext::shared_ptr<EngineBuilder> EngineFactory::builder(const string& tr
     QL_REQUIRE(engineData_->hasProduct(tradeType),
                "No Pricing Engine configuration was provided for trade type " << tradeType);
 
-    // Find a builder for the model/engine/tradeType
+    // Find a builder for the model/engine/tradeType, the result is cached since the search runs over all builders
     const string& model = engineData_->model(tradeType);
     const string& engine = engineData_->engine(tradeType);
-    typedef pair<tuple<string, string, set<string>>, QuantLib::ext::shared_ptr<EngineBuilder>> map_type;
-    auto pred = [&model, &engine, &tradeType](const map_type& v) -> bool {
-        const set<string>& types = std::get<2>(v.first);
-        return std::get<0>(v.first) == model && std::get<1>(v.first) == engine &&
-               std::find(types.begin(), types.end(), tradeType) != types.end();
-    };
-    auto it = std::find_if(builders_.begin(), builders_.end(), pred);
-    QL_REQUIRE(it != builders_.end(), "No EngineBuilder for " << model << "/" << engine << "/" << tradeType);
-    QL_REQUIRE(std::find_if(std::next(it, 1), builders_.end(), pred) == builders_.end(),
-               "Ambiguous EngineBuilder for " << model << "/" << engine << "/" << tradeType);
-
-    QuantLib::ext::shared_ptr<EngineBuilder> builder = it->second;
+    auto resolvedKey = std::make_tuple(tradeType, model, engine);
+
+    QuantLib::ext::shared_ptr<EngineBuilder> builder;
+    if (auto r = resolvedBuilders_.find(resolvedKey); r != resolvedBuilders_.end())
+        builder = r->second;
+
+    if (builder == nullptr) {
+        typedef pair<tuple<string, string, set<string>>, QuantLib::ext::shared_ptr<EngineBuilder>> map_type;
+        auto pred = [&model, &engine, &tradeType](const map_type& v) -> bool {
+            const set<string>& types = std::get<2>(v.first);
+            return std::get<0>(v.first) == model && std::get<1>(v.first) == engine &&
+                   std::find(types.begin(), types.end(), tradeType) != types.end();
+        };
+        auto it = std::find_if(builders_.begin(), builders_.end(), pred);
+        QL_REQUIRE(it != builders_.end(), "No EngineBuilder for " << model << "/" << engine << "/" << tradeType);
+        QL_REQUIRE(std::find_if(std::next(it, 1), builders_.end(), pred) == builders_.end(),
+                   "Ambiguous EngineBuilder for " << model << "/" << engine << "/" << tradeType);
+        builder = it->second;
+        resolvedBuilders_[resolvedKey] = builder;
+    }
+
     string effectiveTradeType = tradeType;
     if(auto db = QuantLib::ext::dynamic_pointer_cast<DelegatingEngineBuilder>(builder))
 	effectiveTradeType = db->effectiveTradeType();
@@ -237,6 +247,12 @@ void EngineFactory::registerLegBuilder(const QuantLib::ext::shared_ptr<LegBuilde
                                                            << "' - this is an internal error.");
 }
 
+void EngineFactory::clear() {
+    builders_.clear();
+    legBuilders_.clear();
+    resolvedBuilders_.clear();
+}
+
 QuantLib::ext::shared_ptr<LegBuilder> EngineFactory::legBuilder(const string& legType) {
     auto it = legBuilders_.find(legType);
     QL_REQUIRE(it != legBuilders_.end(), "No LegBuilder for " << legType);
@@ -131,11 +131,16 @@ public:
     void init(const QuantLib::ext::shared_ptr<Market> market, const map<MarketContext, string>& configurations,
               const map<string, string>& modelParameters, const map<string, string>& engineParameters,
               const std::map<std::string, std::string>& globalParameters = {}) {
+        // the builder is initialised on each request, only copy the parameters if they changed
         market_ = market;
-        configurations_ = configurations;
-        modelParameters_ = modelParameters;
-        engineParameters_ = engineParameters;
-        globalParameters_ = globalParameters;
+        if (configurations_ != configurations)
+            configurations_ = configurations;
+        if (modelParameters_ != modelParameters)
+            modelParameters_ = modelParameters;
+        if (engineParameters_ != engineParameters)
+            engineParameters_ = engineParameters;
+        if (globalParameters_ != globalParameters)
+            globalParameters_ = globalParameters;
     }
 
     //! return model builders
@@ -282,10 +287,7 @@ public:
                           const bool allowOverwrite = false);
 
     //! Clear all builders
-    void clear() {
-        builders_.clear();
-        legBuilders_.clear();
-    }
+    void clear();
 
     //! return model builders
     set<std::pair<string, QuantLib::ext::shared_ptr<QuantExt::ModelBuilder>>> modelBuilders() const;
@@ -298,6 +300,8 @@ private:
     map<string, QuantLib::ext::shared_ptr<LegBuilder>> legBuilders_;
     QuantLib::ext::shared_ptr<ReferenceDataManager> referenceData_;
     IborFallbackConfig iborFallbackConfig_;
+    // builders resolved by builder(), the key is (trade type, model, engine), reset when builders are registered
+    map<tuple<string, string, string>, QuantLib::ext::shared_ptr<EngineBuilder>> resolvedBuilders_;
 };
 
 //! Leg builder
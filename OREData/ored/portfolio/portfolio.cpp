@@ -16,6 +16,7 @@
  FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
 */
 
+#include <ored/marketdata/marketobjectrecorder.hpp>
 #include <ored/portfolio/failedtrade.hpp>
 #include <ored/portfolio/fxforward.hpp>
 #include <ored/portfolio/portfolio.hpp>
@@ -26,8 +27,14 @@
 #include <ored/utilities/log.hpp>
 #include <ored/utilities/xmlutils.hpp>
 #include <ql/errors.hpp>
+#include <ql/indexes/indexmanager.hpp>
+#include <ql/settings.hpp>
 #include <ql/time/date.hpp>
 
+#include <atomic>
+#include <exception>
+#include <thread>
+
 using namespace QuantLib;
 using namespace std;
 
@@ -36,6 +43,35 @@ namespace data {
 
 using namespace data;
 
+namespace {
+// logs a trade build error and returns the trade to keep in the portfolio, or null if the trade is removed
+QuantLib::ext::shared_ptr<Trade> tradeBuildFailed(const QuantLib::ext::shared_ptr<Trade>& trade,
+                                                  const QuantLib::ext::shared_ptr<EngineFactory>& engineFactory,
+                                                  const std::string& context, const std::string& error,
+                                                  const bool ignoreTradeBuildFail, const bool buildFailedTrades,
+                                                  const bool emitStructuredError) {
+    if (emitStructuredError) {
+        StructuredTradeErrorMessage(trade, "Error building trade for context '" + context + "'", error).log();
+    } else {
+        ALOG("Error building trade '" << trade->id() << "' for context '" + context + "': " + error);
+    }
+    if (ignoreTradeBuildFail) {
+        return trade;
+    } else if (buildFailedTrades) {
+        QuantLib::ext::shared_ptr<FailedTrade> failed = QuantLib::ext::make_shared<FailedTrade>();
+        failed->id() = trade->id();
+        failed->setUnderlyingTradeType(trade->tradeType());
+        failed->setEnvelope(trade->envelope());
+        failed->build(engineFactory);
+        failed->resetPricingStats(trade->getNumberOfPricings(), trade->getCumulativePricingTime());
+        LOG("Built failed trade with id " << failed->id());
+        return failed;
+    } else {
+        return nullptr;
+    }
+}
+} // namespace
+
 void Portfolio::clear() {
     trades_.clear();
     underlyingIndicesCache_.clear();
@@ -144,6 +180,117 @@ void Portfolio::build(const QuantLib::ext::shared_ptr<EngineFactory>& engineFact
     QL_REQUIRE(trades_.size() > 0, "Portfolio does not contain any built trades, context is '" + context + "'");
 }
 
+void Portfolio::build(const std::function<QuantLib::ext::shared_ptr<EngineFactory>()>& engineFactoryBuilder,
+                      const Size nThreads, const std::string& context, const bool emitStructuredError) {
+
+    Size nWorkers = std::min(nThreads, trades_.size());
+
+#if !defined(QL_ENABLE_SESSIONS) || !defined(QL_ENABLE_THREAD_SAFE_OBSERVER_PATTERN)
+    if (nWorkers > 1) {
+        WLOG("Building the portfolio on " << nWorkers
+                                           << " threads requires a QuantLib build with QL_ENABLE_SESSIONS and "
+                                              "QL_ENABLE_THREAD_SAFE_OBSERVER_PATTERN, the portfolio is built on one "
+                                              "thread.");
+        nWorkers = 1;
+    }
+#endif
+
+    if (nWorkers <= 1) {
+        build(engineFactoryBuilder(), context, emitStructuredError);
+        return;
+    }
+
+    LOG("Building Portfolio of size " << trades_.size() << " for context = '" << context << "' on " << nWorkers
+                                      << " threads");
+
+    std::vector<QuantLib::ext::shared_ptr<Trade>> trades;
+    for (auto const& [_, t] : trades_)
+        trades.push_back(t);
+
+    // the threads are separate sessions, they start with the evaluation date, settings and fixings of this session
+
+    Date evaluationDate = Settings::instance().evaluationDate();
+    auto includeReferenceDateEvents = Settings::instance().includeReferenceDateEvents();
+    auto includeTodaysCashFlows = Settings::instance().includeTodaysCashFlows();
+    auto enforcesTodaysHistoricFixings = Settings::instance().enforcesTodaysHistoricFixings();
+    std::map<std::string, TimeSeries<Real>> fixings;
+    for (auto const& name : IndexManager::instance().histories())
+        fixings[name] = IndexManager::instance().getHistory(name);
+
+    // the trades are built in portfolio order by the next free thread, errors are collected per trade and handled
+    // in portfolio order afterwards
+
+    std::vector<std::string> errors(trades.size());
+    std::vector<char> failed(trades.size(), 0);
+    std::vector<std::exception_ptr> threadErrors(nWorkers);
+    std::atomic<Size> nextTrade(0);
+
+    auto worker = [&](const Size w) {
+        try {
+            Settings::instance().evaluationDate() = evaluationDate;
+            Settings::instance().includeReferenceDateEvents() = includeReferenceDateEvents;
+            Settings::instance().includeTodaysCashFlows() = includeTodaysCashFlows;
+            Settings::instance().enforcesTodaysHistoricFixings() = enforcesTodaysHistoricFixings;
+            for (auto const& [name, history] : fixings)
+                IndexManager::instance().setHistory(name, history);
+            auto engineFactory = engineFactoryBuilder();
+            for (Size i = nextTrade++; i < trades.size(); i = nextTrade++) {
+                try {
+                    trades[i]->reset();
+                    MarketObjectRecorder recorder;
+                    trades[i]->build(engineFactory);
+                    trades[i]->setRequiredMarketObjects(recorder.objects(), recorder.complete());
+                } catch (std::exception& e) {
+                    errors[i] = e.what();
+                    failed[i] = 1;
+                }
+            }
+        } catch (...) {
+            threadErrors[w] = std::current_exception();
+            nextTrade = trades.size();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (Size w = 0; w < nWorkers; ++w)
+        threads.emplace_back(worker, w);
+    for (auto& t : threads)
+        t.join();
+    for (auto const& e : threadErrors) {
+        if (e)
+            std::rethrow_exception(e);
+    }
+
+    // failed trades are built against an engine factory of this session
+
+    QuantLib::ext::shared_ptr<EngineFactory> engineFactory;
+    Size initialSize = trades_.size();
+    Size failedTrades = 0;
+    auto trade = trades_.begin();
+    for (Size i = 0; i < trades.size(); ++i) {
+        if (!failed[i]) {
+            TLOG("Required Fixings for trade " << trade->second->id() << ":");
+            TLOGGERSTREAM(trade->second->requiredFixings());
+            ++trade;
+            continue;
+        }
+        if (!engineFactory && buildFailedTrades() && !ignoreTradeBuildFail())
+            engineFactory = engineFactoryBuilder();
+        if (auto ft = tradeBuildFailed(trade->second, engineFactory, context, errors[i], ignoreTradeBuildFail(),
+                                       buildFailedTrades(), emitStructuredError)) {
+            trade->second = ft;
+            ++failedTrades;
+            ++trade;
+        } else {
+            trade = trades_.erase(trade);
+        }
+    }
+    LOG("Built Portfolio. Initial size = " << initialSize << ", size now " << trades_.size() << ", built "
+                                           << failedTrades << " failed trades, context is " + context);
+
+    QL_REQUIRE(trades_.size() > 0, "Portfolio does not contain any built trades, context is '" + context + "'");
+}
+
 Date Portfolio::maturity() const {
     QL_REQUIRE(trades_.size() > 0, "Cannot get maturity of an empty portfolio");
     Date mat = Date::minDate();
@@ -272,30 +419,18 @@ std::pair<QuantLib::ext::shared_ptr<Trade>, bool> buildTrade(QuantLib::ext::shar
                                                      const bool buildFailedTrades, const bool emitStructuredError) {
     try {
         trade->reset();
-        trade->build(engineFactory);
+        {
+            MarketObjectRecorder recorder;
+            trade->build(engineFactory);
+            trade->setRequiredMarketObjects(recorder.objects(), recorder.complete());
+        }
         TLOG("Required Fixings for trade " << trade->id() << ":");
         TLOGGERSTREAM(trade->requiredFixings());
         return std::make_pair(nullptr, true);
     } catch (std::exception& e) {
-        if (emitStructuredError) {
-            StructuredTradeErrorMessage(trade, "Error building trade for context '" + context + "'", e.what()).log();
-        } else {
-            ALOG("Error building trade '" << trade->id() << "' for context '" + context + "': " + e.what());
-        }
-        if (ignoreTradeBuildFail) {
-            return std::make_pair(trade, false);
-        } else if (buildFailedTrades) {
-            QuantLib::ext::shared_ptr<FailedTrade> failed = QuantLib::ext::make_shared<FailedTrade>();
-            failed->id() = trade->id();
-            failed->setUnderlyingTradeType(trade->tradeType());
-            failed->setEnvelope(trade->envelope());
-            failed->build(engineFactory);
-            failed->resetPricingStats(trade->getNumberOfPricings(), trade->getCumulativePricingTime());
-            LOG("Built failed trade with id " << failed->id());
-            return std::make_pair(failed, false);
-        } else {
-            return std::make_pair(nullptr, false);
-        }
+        return std::make_pair(tradeBuildFailed(trade, engineFactory, context, e.what(), ignoreTradeBuildFail,
+                                               buildFailedTrades, emitStructuredError),
+                              false);
     }
 }
 
@@ -29,6 +29,7 @@
 #include <ored/portfolio/tradefactory.hpp>
 #include <ql/time/date.hpp>
 #include <ql/types.hpp>
+#include <functional>
 #include <vector>
 
 namespace ore {
@@ -83,6 +84,21 @@ public:
     void build(const QuantLib::ext::shared_ptr<EngineFactory>&, const std::string& context = "unspecified",
                const bool emitStructuredError = true);
 
+    /*! Call build on all trades in the portfolio on up to \p nThreads threads. Each thread builds trades with its own
+        engine factory created by \p engineFactoryBuilder, so that the engine builders and their caches are not shared.
+        The builder is called on the worker threads and must be safe to call concurrently, the market of the factories
+        is shared between the threads and must be fully built, i.e. not lazily.
+
+        Failed trades are handled and logged in portfolio order after all trades are built, as in the serial build.
+
+        The threads are separate QuantLib sessions starting with the evaluation date, settings and fixings of the
+        calling session. The built trades observe the evaluation date and fixings of these sessions, so fixings added
+        after the build do not notify them. This requires a QuantLib build with QL_ENABLE_SESSIONS and
+        QL_ENABLE_THREAD_SAFE_OBSERVER_PATTERN, otherwise the portfolio is built on one thread. */
+    void build(const std::function<QuantLib::ext::shared_ptr<EngineFactory>()>& engineFactoryBuilder,
+               const QuantLib::Size nThreads, const std::string& context = "unspecified",
+               const bool emitStructuredError = true);
+
     //! Calculates the maturity of the portfolio
     QuantLib::Date maturity() const;
 
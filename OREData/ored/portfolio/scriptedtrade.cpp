@@ -92,6 +92,7 @@ void ScriptedTrade::build(const QuantLib::ext::shared_ptr<EngineFactory>& engine
 
     // set sensitivity template
     setSensitivityTemplate(builder->sensitivityTemplate());
+    pricingModelEngine_ = builder->model() + "/" + builder->engine();
 }
 
 void ScriptedTrade::build(const QuantLib::ext::shared_ptr<EngineFactory>& engineFactory) {
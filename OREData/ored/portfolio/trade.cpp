@@ -144,8 +144,11 @@ void Trade::reset() {
     maturity_ = Date();
     issuer_.clear();
     requiredFixings_.clear();
+    requiredMarketObjects_.clear();
+    requiredMarketObjectsComplete_ = false;
     sensitivityTemplate_.clear();
     sensitivityTemplateSet_ = false;
+    pricingModelEngine_.clear();
 }
     
 const std::map<std::string, boost::any>& Trade::additionalData() const { return additionalData_; }
@@ -295,6 +298,7 @@ void Trade::setLegBasedAdditionalData(const Size i, Size resultLegId) const {
 void Trade::setSensitivityTemplate(const EngineBuilder& builder) {
     sensitivityTemplate_ = builder.engineParameter("SensitivityTemplate", {}, false, std::string());
     sensitivityTemplateSet_ = true;
+    pricingModelEngine_ = builder.model() + "/" + builder.engine();
 }
 
 void Trade::setSensitivityTemplate(const std::string& id) {
@@ -302,6 +306,8 @@ void Trade::setSensitivityTemplate(const std::string& id) {
     sensitivityTemplateSet_ = true;
 }
 
+void Trade::setPricingModelEngine(const Trade& delegate) { pricingModelEngine_ = delegate.pricingModelEngine(); }
+
 const std::string& Trade::sensitivityTemplate() const {
     if (!sensitivityTemplateSet_) {
         StructuredTradeWarningMessage(
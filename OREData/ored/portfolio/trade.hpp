@@ -89,6 +89,15 @@ public:
     /*! Return the full required fixing information */
     const RequiredFixings& requiredFixings() const { return requiredFixings_; }
 
+    /*! Return the market objects that were required to build the trade, as recorded by a MarketObjectRecorder, see
+        Portfolio::build(). This is only meaningful if requiredMarketObjectsComplete() returns true. */
+    const std::set<std::pair<MarketObject, std::string>>& requiredMarketObjects() const {
+        return requiredMarketObjects_;
+    }
+
+    /*! Return true if the required market objects were recorded completely in the last build */
+    bool requiredMarketObjectsComplete() const { return requiredMarketObjectsComplete_; }
+
     virtual std::map<AssetClass, std::set<std::string>>
     underlyingIndices(const QuantLib::ext::shared_ptr<ReferenceDataManager>& referenceDataManager = nullptr) const {
         return {};
@@ -124,6 +133,12 @@ public:
 
     //! Set the trade actions
     TradeActions& tradeActions() { return tradeActions_; }
+
+    //! Set the market objects required to build the trade
+    void setRequiredMarketObjects(const std::set<std::pair<MarketObject, std::string>>& objects, const bool complete) {
+        requiredMarketObjects_ = objects;
+        requiredMarketObjectsComplete_ = complete;
+    }
     //@}
 
     //! \name Inspectors
@@ -168,6 +183,10 @@ public:
     /*! returns the sensi template, e.g. "IR_Analytical" for this trade,
         this is only available after build() has been called */
     const std::string& sensitivityTemplate() const;
+
+    /*! returns the model and engine of the engine builder used to build this trade as "model/engine", or an empty
+        string if the trade did not record its engine builder, this is only available after build() has been called */
+    const std::string& pricingModelEngine() const { return pricingModelEngine_; }
     //@}
 
     //! \name Utility
@@ -205,6 +224,7 @@ protected:
     string issuer_;
     string sensitivityTemplate_;
     bool sensitivityTemplateSet_ = false;
+    string pricingModelEngine_;
 
     std::size_t savedNumberOfPricings_ = 0;
     boost::timer::nanosecond_type savedCumulativePricingTime_ = 0;
@@ -221,6 +241,8 @@ protected:
                      const string& configuration);
 
     RequiredFixings requiredFixings_;
+    std::set<std::pair<MarketObject, std::string>> requiredMarketObjects_;
+    bool requiredMarketObjectsComplete_ = false;
     mutable std::map<std::string,boost::any> additionalData_;
 
     /* sets additional data based on given internal legNo (0, 1, ...), the result leg id is derived from this
@@ -228,10 +250,14 @@ protected:
        parameter resultLegId. */
     void setLegBasedAdditionalData(const Size legNo, Size resultLegId = Null<Size>()) const;
 
-    /* sets the sensitivity template for this trade */
+    /* sets the sensitivity template for this trade, the first overload also sets the pricing model / engine from
+       the builder */
     void setSensitivityTemplate(const EngineBuilder& builder);
     void setSensitivityTemplate(const std::string& id);
 
+    /* sets the pricing model / engine to the one of a trade that this trade delegates its build to */
+    void setPricingModelEngine(const Trade& delegate);
+
 private:
     string id_;
     Envelope envelope_;
@@ -339,6 +339,7 @@ void TRS::build(const QuantLib::ext::shared_ptr<EngineFactory>& engineFactory) {
         // populate sensi template from first underlying, we have to make _some_ assumption here!
         if (sensitivityTemplate_.empty()) {
             setSensitivityTemplate(underlying_[i]->sensitivityTemplate());
+            setPricingModelEngine(*underlying_[i]);
         }
     }
 
@@ -95,7 +95,7 @@ std::vector<QuantExt::RandomVariable> ScriptedInstrumentAmcCalculator::simulateP
 
     // set up script engine and run it
 
-    ScriptEngine engine(ast_, workingContext, model_);
+    ScriptEngine engine(ast_, workingContext, model_, program_);
     engine.run(script_, interactive_, nullptr);
 
     // extract AMC Exposure result and return them
@@ -27,6 +27,7 @@
 #include <ored/scripting/ast.hpp>
 #include <ored/scripting/context.hpp>
 #include <ored/scripting/scriptedinstrument.hpp>
+#include <ored/scripting/scriptprogram.hpp>
 
 #include <qle/pricingengines/amccalculator.hpp>
 
@@ -40,9 +41,10 @@ public:
     ScriptedInstrumentAmcCalculator(const std::string& npv, const QuantLib::ext::shared_ptr<Model>& model, const ASTNodePtr ast,
                                     const QuantLib::ext::shared_ptr<Context>& context, const std::string& script = "",
                                     const bool interactive = false,
-                                    const std::set<std::string>& stickyCloseOutStates = {})
+                                    const std::set<std::string>& stickyCloseOutStates = {},
+                                    const QuantLib::ext::shared_ptr<ScriptProgram>& program = nullptr)
         : npv_(npv), model_(model), ast_(ast), context_(context), script_(script), interactive_(interactive),
-          stickyCloseOutStates_(stickyCloseOutStates) {}
+          stickyCloseOutStates_(stickyCloseOutStates), program_(program) {}
 
     QuantLib::Currency npvCurrency() override;
 
@@ -59,6 +61,7 @@ private:
     const std::string script_;
     const bool interactive_;
     const std::set<std::string> stickyCloseOutStates_;
+    const QuantLib::ext::shared_ptr<ScriptProgram> program_;
     //
     std::map<std::string, ValueType> stickyCloseOutRunScalars_;
     std::map<std::string, std::vector<ValueType>> stickyCloseOutRunArrays_;
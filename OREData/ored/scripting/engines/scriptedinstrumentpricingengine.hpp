@@ -26,6 +26,7 @@
 #include <ored/scripting/ast.hpp>
 #include <ored/scripting/context.hpp>
 #include <ored/scripting/scriptedinstrument.hpp>
+#include <ored/scripting/scriptprogram.hpp>
 
 #include <ored/configuration/conventions.hpp>
 
@@ -41,11 +42,12 @@ public:
                                     const bool interactive = false, const bool amcEnabled = false,
                                     const std::set<std::string>& amcStickyCloseOutStates = {},
                                     const bool generateAdditionalResults = false,
-                                    const bool includePastCashflows = false)
+                                    const bool includePastCashflows = false,
+                                    const QuantLib::ext::shared_ptr<ScriptProgram>& program = nullptr)
         : npv_(npv), additionalResults_(additionalResults), model_(model), ast_(ast), context_(context),
           script_(script), interactive_(interactive), amcEnabled_(amcEnabled),
           amcStickyCloseOutStates_(amcStickyCloseOutStates), generateAdditionalResults_(generateAdditionalResults),
-          includePastCashflows_(includePastCashflows) {
+          includePastCashflows_(includePastCashflows), program_(program) {
         registerWith(model_);
     }
 
@@ -69,6 +71,7 @@ private:
     const std::set<std::string> amcStickyCloseOutStates_;
     const bool generateAdditionalResults_;
     const bool includePastCashflows_;
+    const QuantLib::ext::shared_ptr<ScriptProgram> program_;
 };
 
 } // namespace data
@@ -94,7 +94,8 @@ ScriptedInstrumentPricingEngineCG::ScriptedInstrumentPricingEngineCG(
         gradsExternal_ = getExternalRandomVariableGradients();
     } else {
         ops_ = getRandomVariableOps(model_->size(), mcParams_.regressionOrder, mcParams_.polynomType, 0.0,
-                                    mcParams_.regressionVarianceCutoff);
+                                    mcParams_.regressionVarianceCutoff, mcParams_.regressionMethod,
+                                    mcParams_.regressionThreads);
         grads_ = getRandomVariableGradients(model_->size(), mcParams_.regressionOrder, mcParams_.polynomType, 0.2,
                                             mcParams_.regressionVarianceCutoff);
     }
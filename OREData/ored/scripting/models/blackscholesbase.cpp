@@ -304,7 +304,7 @@ RandomVariable BlackScholesBase::npv(const RandomVariable& amount, const Date& o
         coeff = regressionCoefficients(amount, state,
                                        multiPathBasisSystem(state.size(), mcParams_.regressionOrder,
                                                             mcParams_.polynomType, std::min(size(), trainingSamples())),
-                                       filter, RandomVariableRegressionMethod::QR);
+                                       filter, mcParams_.regressionMethod, std::string(), mcParams_.regressionThreads);
         DLOG("BlackScholesBase::npv(" << ore::data::to_string(obsdate) << "): regression coefficients are " << coeff
                                       << " (got model state size " << nModelStates << " and " << nAddReg
                                       << " additional regressors, coordinate transform "
@@ -322,14 +322,14 @@ void GaussianCam::populatePathValues(const Size nSamples, std::map<Date, std::ve
                 makeMultiPathGenerator(isTraining ? mcParams_.trainingSequenceType : mcParams_.sequenceType, process,
                                        timeGrid_, isTraining ? mcParams_.trainingSeed : mcParams_.seed,
                                        mcParams_.sobolOrdering, mcParams_.sobolDirectionIntegers);
-            for (Size i = 0; i < nSamples; ++i) {
-                MultiPath path = pathGen->next().value;
-                for (Size j = 0; j < effectiveSimulationDates_.size() - 1; ++j) {
-                    for (Size k = 0; k < process->size(); ++k) {
-                        pathValues[j][k][i] = path[k][positionInTimeGrid_[j + 1]];
-                    }
+            std::vector<std::vector<Real*>> pathValuesData(timeGrid_.size() - 1,
+                                                           std::vector<Real*>(process->size(), nullptr));
+            for (Size j = 0; j < effectiveSimulationDates_.size() - 1; ++j) {
+                for (Size k = 0; k < process->size(); ++k) {
+                    pathValuesData[positionInTimeGrid_[j + 1] - 1][k] = pathValues[j][k].data();
                 }
             }
+            pathGen->nextBlock(nSamples, pathValuesData);
         } else {
 
             // simple linear interpolation of injected paths, TODO explore the usage of Brownian Bridges here
@@ -668,7 +668,7 @@ RandomVariable GaussianCam::npv(const RandomVariable& amount, const Date& obsdat
         coeff = regressionCoefficients(amount, state,
                                        multiPathBasisSystem(state.size(), mcParams_.regressionOrder,
                                                             mcParams_.polynomType, std::min(size(), trainingSamples())),
-                                       filter, RandomVariableRegressionMethod::QR);
+                                       filter, mcParams_.regressionMethod, std::string(), mcParams_.regressionThreads);
         DLOG("GaussianCam::npv(" << ore::data::to_string(obsdate) << "): regression coefficients are " << coeff
                                  << " (got model state size " << nModelStates << " and " << nAddReg
                                  << " additional regressors, coordinate transform " << coordinateTransform.columns()
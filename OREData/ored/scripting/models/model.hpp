@@ -59,6 +59,8 @@ public:
         QuantLib::SobolBrownianGenerator::Ordering sobolOrdering = QuantLib::SobolBrownianGenerator::Steps;
         QuantLib::SobolRsg::DirectionIntegers sobolDirectionIntegers = QuantLib::SobolRsg::DirectionIntegers::JoeKuoD7;
         QuantLib::Real regressionVarianceCutoff = Null<QuantLib::Real>();
+        QuantExt::RandomVariableRegressionMethod regressionMethod = QuantExt::RandomVariableRegressionMethod::QR;
+        Size regressionThreads = 1;
     };
 
     explicit Model(const Size n) : n_(n) {}
@@ -1158,12 +1158,575 @@ public:
     SafeStack<ValueType> value;
 };
 
+// runs a compiled script program, nodes that are not compiled are delegated to the AST interpreter
+
+class ProgramRunner {
+public:
+    using OpCode = ScriptProgram::OpCode;
+    using Operand = ScriptProgram::Operand;
+    using Instruction = ScriptProgram::Instruction;
+
+    ProgramRunner(const ScriptProgram& program, ASTRunner& interpreter, const QuantLib::ext::shared_ptr<Model> model,
+                  Context& context, ASTNode*& lastVisitedNode, QuantLib::ext::shared_ptr<PayLog> paylog,
+                  bool includePastCashflows)
+        : program_(program), interpreter_(interpreter), model_(model), size_(model ? model->size() : 1),
+          paylog_(paylog), includePastCashflows_(includePastCashflows), context_(context),
+          lastVisitedNode_(lastVisitedNode), registers_(program.registers()), slots_(program.variables().size()),
+          loops_(program.loops()) {
+        for (auto const c : program.constants())
+            constants_.push_back(RandomVariable(size_, c));
+        for (Size k = 0; k < slots_.size(); ++k) {
+            const std::string& name = program.variables()[k];
+            slots_[k].ignoreAssignments = context_.ignoreAssignments.find(name) != context_.ignoreAssignments.end();
+            slots_[k].isConstant = context_.constants.find(name) != context_.constants.end();
+        }
+        filter_.push_back(Filter(size_, true));
+    }
+
+    Size filterStackSize() const { return filter_.size(); }
+
+    void run() {
+        const std::vector<Instruction>& code = program_.instructions();
+        Size pc = 0;
+        while (pc < code.size()) {
+            const Instruction& i = code[pc];
+            lastVisitedNode_ = i.node;
+            ++pc;
+            switch (i.op) {
+            // number operations
+            case OpCode::Add:
+                binaryOp(i, [](const RandomVariable& x, const RandomVariable& y) { return x + y; },
+                         [](const ValueType& x, const ValueType& y) { return x + y; });
+                break;
+            case OpCode::Subtract:
+                binaryOp(i, [](const RandomVariable& x, const RandomVariable& y) { return x - y; },
+                         [](const ValueType& x, const ValueType& y) { return x - y; });
+                break;
+            case OpCode::Multiply:
+                binaryOp(i, [](const RandomVariable& x, const RandomVariable& y) { return x * y; },
+                         [](const ValueType& x, const ValueType& y) { return x * y; });
+                break;
+            case OpCode::Divide:
+                binaryOp(i, [](const RandomVariable& x, const RandomVariable& y) { return x / y; },
+                         [](const ValueType& x, const ValueType& y) { return x / y; });
+                break;
+            case OpCode::Min:
+                binaryOp(i, [](const RandomVariable& x, const RandomVariable& y) { return min(x, y); },
+                         [](const ValueType& x, const ValueType& y) { return min(x, y); });
+                break;
+            case OpCode::Max:
+                binaryOp(i, [](const RandomVariable& x, const RandomVariable& y) { return max(x, y); },
+                         [](const ValueType& x, const ValueType& y) { return max(x, y); });
+                break;
+            case OpCode::Pow:
+                binaryOp(i, [](const RandomVariable& x, const RandomVariable& y) { return pow(x, y); },
+                         [](const ValueType& x, const ValueType& y) { return pow(x, y); });
+                break;
+            case OpCode::Negate:
+                unaryOp(i, [](const RandomVariable& x) { return -x; }, [](const ValueType& x) { return -x; });
+                break;
+            case OpCode::Abs:
+                unaryOp(i, [](const RandomVariable& x) { return abs(x); }, [](const ValueType& x) { return abs(x); });
+                break;
+            case OpCode::Exp:
+                unaryOp(i, [](const RandomVariable& x) { return exp(x); }, [](const ValueType& x) { return exp(x); });
+                break;
+            case OpCode::Log:
+                unaryOp(i, [](const RandomVariable& x) { return log(x); }, [](const ValueType& x) { return log(x); });
+                break;
+            case OpCode::Sqrt:
+                unaryOp(i, [](const RandomVariable& x) { return sqrt(x); }, [](const ValueType& x) { return sqrt(x); });
+                break;
+            case OpCode::NormalCdf:
+                unaryOp(i, [](const RandomVariable& x) { return normalCdf(x); },
+                        [](const ValueType& x) { return normalCdf(x); });
+                break;
+            case OpCode::NormalPdf:
+                unaryOp(i, [](const RandomVariable& x) { return normalPdf(x); },
+                        [](const ValueType& x) { return normalPdf(x); });
+                break;
+            // conditions
+            case OpCode::Equal:
+                binaryOp(i, [](const RandomVariable& x, const RandomVariable& y) { return close_enough(x, y); },
+                         [](const ValueType& x, const ValueType& y) { return equal(x, y); });
+                break;
+            case OpCode::NotEqual:
+                binaryOp(i, [](const RandomVariable& x, const RandomVariable& y) { return !close_enough(x, y); },
+                         [](const ValueType& x, const ValueType& y) { return notequal(x, y); });
+                break;
+            case OpCode::Lt:
+                binaryOp(i, [](const RandomVariable& x, const RandomVariable& y) { return x < y; },
+                         [](const ValueType& x, const ValueType& y) { return lt(x, y); });
+                break;
+            case OpCode::Leq:
+                binaryOp(i, [](const RandomVariable& x, const RandomVariable& y) { return x <= y; },
+                         [](const ValueType& x, const ValueType& y) { return leq(x, y); });
+                break;
+            case OpCode::Gt:
+                binaryOp(i, [](const RandomVariable& x, const RandomVariable& y) { return x > y; },
+                         [](const ValueType& x, const ValueType& y) { return gt(x, y); });
+                break;
+            case OpCode::Geq:
+                binaryOp(i, [](const RandomVariable& x, const RandomVariable& y) { return x >= y; },
+                         [](const ValueType& x, const ValueType& y) { return geq(x, y); });
+                break;
+            case OpCode::Not: {
+                const ValueType& x = value(i.args[0]);
+                if (x.which() == ValueTypeWhich::Filter)
+                    registers_[i.target] = !QuantLib::ext::get<Filter>(x);
+                else
+                    registers_[i.target] = logicalNot(x);
+                break;
+            }
+            case OpCode::And:
+            case OpCode::Or: {
+                const ValueType& x = value(i.args[0]);
+                const ValueType& y = value(i.args[1]);
+                bool isAnd = i.op == OpCode::And;
+                if (x.which() == ValueTypeWhich::Filter && y.which() == ValueTypeWhich::Filter) {
+                    const Filter& l = QuantLib::ext::get<Filter>(x);
+                    const Filter& r = QuantLib::ext::get<Filter>(y);
+                    registers_[i.target] = isAnd ? l && r : l || r;
+                } else {
+                    registers_[i.target] = isAnd ? logicalAnd(x, y) : logicalOr(x, y);
+                }
+                break;
+            }
+            case OpCode::AndShortCut:
+            case OpCode::OrShortCut: {
+                const ValueType& x = value(i.args[0]);
+                QL_REQUIRE(x.which() == ValueTypeWhich::Filter, "expected condition");
+                const Filter& l = QuantLib::ext::get<Filter>(x);
+                bool isAnd = i.op == OpCode::AndShortCut;
+                if (l.deterministic() && l[0] != isAnd) {
+                    registers_[i.target] = Filter(l.size(), !isAnd);
+                    pc = i.jump;
+                }
+                break;
+            }
+            // values
+            case OpCode::Copy:
+                registers_[i.target] = value(i.args[0]);
+                break;
+            case OpCode::Size: {
+                Slot& s = slot(i.args[0].index);
+                const std::string& name = program_.variables()[i.args[0].index];
+                if (s.array == nullptr) {
+                    if (s.scalar == nullptr)
+                        QL_FAIL("variable " << name << " is not defined");
+                    else
+                        QL_FAIL("SIZE can only be applied to array, " << name << " is a scalar");
+                }
+                registers_[i.target] = RandomVariable(size_, static_cast<double>(s.array->size()));
+                break;
+            }
+            case OpCode::IndexEval:
+                indexEval(i);
+                break;
+            case OpCode::PayCheck: {
+                const ValueType& paydate = value(i.args[0]);
+                QL_REQUIRE(paydate.which() == ValueTypeWhich::Event, "paydate must be EVENT");
+                QL_REQUIRE(model_, "model is null");
+                // past payments: do not evaluate the other parameters, since not needed (e.g. past fixings)
+                if (QuantLib::ext::get<EventVec>(paydate).value <= model_->referenceDate() &&
+                    (!i.flag || !includePastCashflows_)) {
+                    registers_[i.target] = RandomVariable(size_, 0.0);
+                    pc = i.jump;
+                }
+                break;
+            }
+            case OpCode::JumpIfNoPayLog:
+                if (paylog_ == nullptr)
+                    pc = i.jump;
+                break;
+            case OpCode::Pay:
+                pay(i);
+                break;
+            case OpCode::Npv:
+                npv(i);
+                break;
+            case OpCode::Delegate:
+                interpreter_.filter.push(filter_.back());
+                i.node->accept(interpreter_);
+                interpreter_.filter.pop();
+                if (i.flag)
+                    registers_[i.target] = interpreter_.value.pop();
+                break;
+            // statements
+            case OpCode::Assign:
+                assign(i);
+                break;
+            case OpCode::DeclareCheck: {
+                const std::string& name = program_.variables()[i.target];
+                if (slots_[i.target].ignoreAssignments) {
+                    pc = i.jump;
+                    break;
+                }
+                QL_REQUIRE(context_.scalars.find(name) == context_.scalars.end() &&
+                               context_.arrays.find(name) == context_.arrays.end(),
+                           "variable '" << name << "' already declared.");
+                break;
+            }
+            case OpCode::Declare:
+                declare(i);
+                break;
+            case OpCode::Require: {
+                const ValueType& condition = value(i.args[0]);
+                QL_REQUIRE(condition.which() == ValueTypeWhich::Filter, "expected condition");
+                // check implication filter true => condition true
+                auto c = !filter_.back() || QuantLib::ext::get<Filter>(condition);
+                c.updateDeterministic();
+                QL_REQUIRE(c.deterministic() && c.at(0), "required condition is not (always) fulfilled");
+                break;
+            }
+            case OpCode::IfBegin:
+            case OpCode::ElseBegin: {
+                const ValueType& cond = value(i.args[0]);
+                QL_REQUIRE(cond.which() == ValueTypeWhich::Filter,
+                           "IF must be followed by a boolean, got " << valueTypeLabels.at(cond.which()));
+                Filter currentFilter = i.op == OpCode::IfBegin ? filter_.back() && QuantLib::ext::get<Filter>(cond)
+                                                               : filter_.back() && !QuantLib::ext::get<Filter>(cond);
+                currentFilter.updateDeterministic();
+                // if the branch is not executed, jump to its PopFilter instruction
+                if (currentFilter.deterministic() && !currentFilter[0])
+                    pc = i.jump;
+                filter_.push_back(std::move(currentFilter));
+                break;
+            }
+            case OpCode::PopFilter:
+                filter_.pop_back();
+                break;
+            case OpCode::LoopInit:
+                loopInit(i);
+                break;
+            case OpCode::LoopTest: {
+                Loop& l = loops_[i.target];
+                if ((l.step > 0 && l.current <= l.end) || (l.step < 0 && l.current >= l.end))
+                    *l.variable = RandomVariable(size_, static_cast<double>(l.current));
+                else
+                    pc = i.jump;
+                break;
+            }
+            case OpCode::LoopNext: {
+                Loop& l = loops_[i.target];
+                QL_REQUIRE(l.variable->which() == ValueTypeWhich::Number &&
+                               close_enough_all(QuantLib::ext::get<RandomVariable>(*l.variable),
+                                                RandomVariable(size_, static_cast<double>(l.current))),
+                           "loop variable was modified in body from " << l.current << " to " << *l.variable
+                                                                      << ", this is illegal.");
+                l.current += l.step;
+                pc = i.jump;
+                break;
+            }
+            default:
+                QL_FAIL("ScriptEngine: op code " << i.op << " not handled");
+            }
+        }
+    }
+
+private:
+    // variable slot bound to the context, the binding is looked up on first use
+    struct Slot {
+        bool bound = false;
+        ValueType* scalar = nullptr;
+        std::vector<ValueType>* array = nullptr;
+        bool ignoreAssignments = false;
+        bool isConstant = false;
+    };
+
+    struct Loop {
+        ValueType* variable = nullptr;
+        long current = 0, end = 0, step = 0;
+    };
+
+    Slot& slot(const Size k) {
+        Slot& s = slots_[k];
+        if (!s.bound) {
+            const std::string& name = program_.variables()[k];
+            auto scalar = context_.scalars.find(name);
+            auto array = context_.arrays.find(name);
+            s.scalar = scalar == context_.scalars.end() ? nullptr : &scalar->second;
+            s.array = array == context_.arrays.end() ? nullptr : &array->second;
+            s.bound = s.scalar != nullptr || s.array != nullptr;
+        }
+        return s;
+    }
+
+    // get ref to operand value, for variables this is a ref to the context variable
+
+    ValueType& value(const Operand& o) {
+        switch (o.kind) {
+        case Operand::Kind::Register:
+            return registers_[o.index];
+        case Operand::Kind::Constant:
+            return constants_[o.index];
+        case Operand::Kind::Variable:
+        case Operand::Kind::ArrayElement:
+            try {
+                return variable(o);
+            } catch (...) {
+                // report the variable node as error location
+                lastVisitedNode_ = o.node;
+                throw;
+            }
+        default:
+            QL_FAIL("ScriptEngine: operand not set");
+        }
+    }
+
+    ValueType& variable(const Operand& o) {
+        Slot& s = slot(o.index);
+        if (o.kind == Operand::Kind::Variable) {
+            if (s.scalar != nullptr)
+                return *s.scalar;
+            QL_REQUIRE(s.array == nullptr,
+                       "array subscript required for variable '" << program_.variables()[o.index] << "'");
+            QL_FAIL("variable '" << program_.variables()[o.index] << "' is not defined.");
+        }
+        QL_REQUIRE(s.scalar == nullptr,
+                   "no array subscript allowed for variable '" << program_.variables()[o.index] << "'");
+        QL_REQUIRE(s.array != nullptr, "variable '" << program_.variables()[o.index] << "' is not defined.");
+        Operand subscript;
+        subscript.kind = o.subscriptIsVariable ? Operand::Kind::Variable : Operand::Kind::Register;
+        subscript.index = o.subscript;
+        const ValueType& arg = value(subscript);
+        QL_REQUIRE(arg.which() == ValueTypeWhich::Number,
+                   "array subscript must be of type NUMBER, got " << valueTypeLabels.at(arg.which()));
+        const RandomVariable& i = QuantLib::ext::get<RandomVariable>(arg);
+        QL_REQUIRE(i.deterministic(), "array subscript must be deterministic");
+        long il = std::lround(i.at(0));
+        QL_REQUIRE(static_cast<long>(s.array->size()) >= il && il >= 1,
+                   "array index " << il << " out of bounds 1..." << s.array->size());
+        return (*s.array)[il - 1];
+    }
+
+    // helpers to perform operations, numbers are handled directly, all other types by the ValueType functions
+
+    template <typename F, typename G> void binaryOp(const Instruction& i, const F& f, const G& g) {
+        const ValueType& x = value(i.args[0]);
+        const ValueType& y = value(i.args[1]);
+        if (x.which() == ValueTypeWhich::Number && y.which() == ValueTypeWhich::Number)
+            registers_[i.target] = f(QuantLib::ext::get<RandomVariable>(x), QuantLib::ext::get<RandomVariable>(y));
+        else
+            registers_[i.target] = g(x, y);
+    }
+
+    template <typename F, typename G> void unaryOp(const Instruction& i, const F& f, const G& g) {
+        const ValueType& x = value(i.args[0]);
+        if (x.which() == ValueTypeWhich::Number)
+            registers_[i.target] = f(QuantLib::ext::get<RandomVariable>(x));
+        else
+            registers_[i.target] = g(x);
+    }
+
+    void assign(const Instruction& i) {
+        const Operand& left = i.args[0];
+        const Slot& s = slots_[left.index];
+        const std::string& name = program_.variables()[left.index];
+        if (s.ignoreAssignments)
+            return;
+        QL_REQUIRE(!s.isConstant, "can not assign to const variable '" << name << "'");
+        ValueType& ref = value(left);
+        ValueType& right = value(i.args[1]);
+        if (ref.which() == ValueTypeWhich::Event || ref.which() == ValueTypeWhich::Currency ||
+            ref.which() == ValueTypeWhich::Index) {
+            typeSafeAssign(ref, right);
+        } else {
+            QL_REQUIRE(ref.which() == ValueTypeWhich::Number,
+                       "internal error: expected NUMBER, got " << valueTypeLabels.at(ref.which()));
+            QL_REQUIRE(right.which() == ValueTypeWhich::Number, "invalid assignment: type "
+                                                                    << valueTypeLabels.at(ref.which()) << " <- "
+                                                                    << valueTypeLabels.at(right.which()));
+            RandomVariable& x = QuantLib::ext::get<RandomVariable>(ref);
+            x.setTime(Null<Real>());
+            // a register value is not needed after the assignment and can be moved
+            if (i.args[1].kind == Operand::Kind::Register)
+                x = conditionalResult(filter_.back(), std::move(QuantLib::ext::get<RandomVariable>(right)), x);
+            else
+                x = conditionalResult(filter_.back(), QuantLib::ext::get<RandomVariable>(right), x);
+            x.updateDeterministic();
+        }
+    }
+
+    void declare(const Instruction& i) {
+        const std::string& name = program_.variables()[i.target];
+        Slot& s = slots_[i.target];
+        if (i.args[0].kind == Operand::Kind::None) {
+            auto& v = context_.scalars[name];
+            v = RandomVariable(size_, 0.0);
+            s.scalar = &v;
+        } else {
+            const ValueType& size = value(i.args[0]);
+            QL_REQUIRE(size.which() == ValueTypeWhich::Number, "expected NUMBER for array size definition");
+            const RandomVariable& arraySize = QuantLib::ext::get<RandomVariable>(size);
+            QL_REQUIRE(arraySize.deterministic(), "array size definition requires deterministic argument");
+            long arraySizeL = std::lround(arraySize.at(0));
+            QL_REQUIRE(arraySizeL >= 0, "expected non-negative array size, got " << arraySizeL);
+            auto& v = context_.arrays[name];
+            v = std::vector<ValueType>(arraySizeL, RandomVariable(size_, 0.0));
+            s.array = &v;
+        }
+        s.bound = true;
+    }
+
+    void loopInit(const Instruction& i) {
+        const std::string& name = program_.variables()[i.args[3].index];
+        Slot& s = slot(i.args[3].index);
+        QL_REQUIRE(s.scalar != nullptr, "loop variable '" << name << "' not defined or not scalar");
+        QL_REQUIRE(!s.isConstant, "loop variable '" << name << "' is constant");
+        const ValueType& left = value(i.args[0]);
+        const ValueType& right = value(i.args[1]);
+        const ValueType& step = value(i.args[2]);
+        QL_REQUIRE(left.which() == ValueTypeWhich::Number && right.which() == ValueTypeWhich::Number &&
+                       step.which() == ValueTypeWhich::Number,
+                   "loop bounds and step must be of type NUMBER, got " << valueTypeLabels.at(left.which()) << ", "
+                                                                       << valueTypeLabels.at(right.which()) << ", "
+                                                                       << valueTypeLabels.at(step.which()));
+        const RandomVariable& a = QuantLib::ext::get<RandomVariable>(left);
+        const RandomVariable& b = QuantLib::ext::get<RandomVariable>(right);
+        const RandomVariable& st = QuantLib::ext::get<RandomVariable>(step);
+        QL_REQUIRE(a.deterministic(), "first loop bound must be deterministic");
+        QL_REQUIRE(b.deterministic(), "second loop bound must be deterministic");
+        QL_REQUIRE(st.deterministic(), "loop step must be deterministic");
+        Loop& l = loops_[i.target];
+        l.variable = s.scalar;
+        l.current = std::lround(a.at(0));
+        l.end = std::lround(b.at(0));
+        l.step = std::lround(st.at(0));
+        QL_REQUIRE(l.step != 0, "loop step must be non-zero");
+    }
+
+    void indexEval(const Instruction& i) {
+        const ValueType& left = value(i.args[0]);
+        const ValueType& right = value(i.args[1]);
+        QL_REQUIRE(left.which() == ValueTypeWhich::Index,
+                   "evaluation operator () can only be applied to an INDEX, got " << valueTypeLabels.at(left.which()));
+        QL_REQUIRE(right.which() == ValueTypeWhich::Event,
+                   "evaluation operator () argument obsDate must be EVENT, got " << valueTypeLabels.at(right.which()));
+        Date obs = QuantLib::ext::get<EventVec>(right).value, fwd = Null<Date>();
+        QL_REQUIRE(model_, "model is null");
+        if (i.args[2].kind != Operand::Kind::None) {
+            const ValueType& fwdDate = value(i.args[2]);
+            QL_REQUIRE(fwdDate.which() == ValueTypeWhich::Event,
+                       "evaluation operator () argument fwdDate must be EVENT, got "
+                           << valueTypeLabels.at(fwdDate.which()));
+            fwd = QuantLib::ext::get<EventVec>(fwdDate).value;
+            if (fwd == obs)
+                fwd = Null<Date>();
+            else {
+                QL_REQUIRE(obs < fwd,
+                           "evaluation operator() requires obsDate (" << obs << ") < fwdDate (" << fwd << ")");
+            }
+        }
+        registers_[i.target] = model_->eval(QuantLib::ext::get<IndexVec>(left).value, obs, fwd);
+    }
+
+    void pay(const Instruction& i) {
+        const ValueType& amount = value(i.args[0]);
+        const ValueType& obsdate = value(i.args[1]);
+        const ValueType& paydate = value(i.args[2]);
+        const ValueType& paycurr = value(i.args[3]);
+        QL_REQUIRE(amount.which() == ValueTypeWhich::Number, "amount must be NUMBER");
+        QL_REQUIRE(obsdate.which() == ValueTypeWhich::Event, "obsdate must be EVENT");
+        QL_REQUIRE(paycurr.which() == ValueTypeWhich::Currency, "paycurr must be CURRENCY");
+        Date obs = QuantLib::ext::get<EventVec>(obsdate).value;
+        Date pay = QuantLib::ext::get<EventVec>(paydate).value;
+        const std::string& pccy = QuantLib::ext::get<CurrencyVec>(paycurr).value;
+        QL_REQUIRE(obs <= pay, "observation date (" << obs << ") <= payment date (" << pay << ") required");
+        RandomVariable result = pay <= model_->referenceDate()
+                                    ? RandomVariable(model_->size(), 0.0)
+                                    : model_->pay(QuantLib::ext::get<RandomVariable>(amount), obs, pay, pccy);
+        if (i.flag && paylog_ != nullptr) {
+            // cashflow logging
+            long legno = 0, slot = 0;
+            std::string cftype = "Unspecified";
+            if (i.args[4].kind != Operand::Kind::None) {
+                const ValueType& s = value(i.args[4]);
+                QL_REQUIRE(s.which() == ValueTypeWhich::Number, "legno must be NUMBER");
+                RandomVariable sv = QuantLib::ext::get<RandomVariable>(s);
+                sv.updateDeterministic();
+                QL_REQUIRE(sv.deterministic(), "legno must be deterministic");
+                legno = std::lround(sv.at(0));
+                cftype = i.name;
+                if (i.args[5].kind != Operand::Kind::None) {
+                    const ValueType& s = value(i.args[5]);
+                    QL_REQUIRE(s.which() == ValueTypeWhich::Number, "slot must be NUMBER");
+                    RandomVariable sv = QuantLib::ext::get<RandomVariable>(s);
+                    sv.updateDeterministic();
+                    QL_REQUIRE(sv.deterministic(), "slot must be deterministic");
+                    slot = std::lround(sv.at(0));
+                    QL_REQUIRE(slot >= 1, " slot must be >= 1");
+                }
+            }
+            paylog_->write(pay <= model_->referenceDate() ? QuantLib::ext::get<RandomVariable>(amount) : result,
+                           filter_.back(), obs, pay, pccy, static_cast<Size>(legno), cftype, static_cast<Size>(slot));
+        }
+        registers_[i.target] = std::move(result);
+    }
+
+    void npv(const Instruction& i) {
+        static const Filter noFilter;
+        static const RandomVariable noRegressor;
+        const ValueType& amount = value(i.args[0]);
+        const ValueType& obsdate = value(i.args[1]);
+        const Filter* regFilter = &noFilter;
+        const RandomVariable *addRegressor1 = &noRegressor, *addRegressor2 = &noRegressor;
+        if (i.args[3].kind != Operand::Kind::None) {
+            const ValueType& val = value(i.args[3]);
+            QL_REQUIRE(val.which() == ValueTypeWhich::Filter, "filter must be condition");
+            regFilter = &QuantLib::ext::get<Filter>(val);
+        }
+        if (i.args[4].kind != Operand::Kind::None) {
+            const ValueType& val = value(i.args[4]);
+            QL_REQUIRE(val.which() == ValueTypeWhich::Number, "addRegressor1 must be NUMBER");
+            addRegressor1 = &QuantLib::ext::get<RandomVariable>(val);
+        }
+        if (i.args[5].kind != Operand::Kind::None) {
+            const ValueType& val = value(i.args[5]);
+            QL_REQUIRE(val.which() == ValueTypeWhich::Number, "addRegressor2 must be NUMBER");
+            addRegressor2 = &QuantLib::ext::get<RandomVariable>(val);
+        }
+        QL_REQUIRE(amount.which() == ValueTypeWhich::Number, "amount must be NUMBER");
+        QL_REQUIRE(obsdate.which() == ValueTypeWhich::Event, "obsdate must be EVENT");
+        boost::optional<long> mem(boost::none);
+        if (i.flag) {
+            const ValueType& memSlot = value(i.args[2]);
+            QL_REQUIRE(memSlot.which() == ValueTypeWhich::Number, "memorySlot must be NUMBER");
+            const RandomVariable& v = QuantLib::ext::get<RandomVariable>(memSlot);
+            QL_REQUIRE(v.deterministic(), "memory slot must be deterministic");
+            mem = static_cast<long>(v.at(0));
+        }
+        QL_REQUIRE(model_, "model is null");
+        // roll back to past dates is treated as roll back to TODAY for convenience
+        Date obs = std::max(QuantLib::ext::get<EventVec>(obsdate).value, model_->referenceDate());
+        registers_[i.target] = model_->npv(QuantLib::ext::get<RandomVariable>(amount), obs, *regFilter, mem,
+                                           *addRegressor1, *addRegressor2);
+    }
+
+    // inputs
+    const ScriptProgram& program_;
+    ASTRunner& interpreter_;
+    const QuantLib::ext::shared_ptr<Model> model_;
+    const Size size_;
+    QuantLib::ext::shared_ptr<PayLog> paylog_;
+    bool includePastCashflows_;
+    // working variables
+    Context& context_;
+    ASTNode*& lastVisitedNode_;
+    // state of the runner
+    std::vector<ValueType> registers_;
+    std::vector<ValueType> constants_;
+    std::vector<Slot> slots_;
+    std::vector<Loop> loops_;
+    std::vector<Filter> filter_;
+};
+
 } // namespace
 
 void ScriptEngine::run(const std::string& script, bool interactive, QuantLib::ext::shared_ptr<PayLog> paylog,
                        bool includePastCashflows) {
 
-    ASTNode* loc;
+    ASTNode* loc = nullptr;
     ASTRunner runner(model_, script, interactive, *context_, loc, paylog, paylog != nullptr && includePastCashflows);
 
     randomvariable_output_pattern pattern;
@@ -1184,8 +1747,20 @@ void ScriptEngine::run(const std::string& script, bool interactive, QuantLib::ex
 
     boost::timer::cpu_timer timer;
     try {
-        reset(root_);
-        root_->accept(runner);
+        if (program_ && !interactive) {
+            // run the compiled program, only the nodes delegated to the interpreter have to be reset
+            for (auto const& n : program_->delegatedNodes())
+                reset(n);
+            ProgramRunner programRunner(*program_, runner, model_, *context_, loc, paylog,
+                                        paylog != nullptr && includePastCashflows);
+            programRunner.run();
+            QL_REQUIRE(programRunner.filterStackSize() == 1, "ScriptEngine::run(): filter stack has wrong size ("
+                                                                 << programRunner.filterStackSize()
+                                                                 << "), should be 1");
+        } else {
+            reset(root_);
+            root_->accept(runner);
+        }
         timer.stop();
         QL_REQUIRE(runner.value.size() == 1,
                    "ScriptEngine::run(): value stack has wrong size (" << runner.value.size() << "), should be 1");
@@ -27,17 +27,26 @@
 #include <ored/scripting/ast.hpp>
 #include <ored/scripting/context.hpp>
 #include <ored/scripting/paylog.hpp>
+#include <ored/scripting/scriptprogram.hpp>
 
 #include <ored/configuration/conventions.hpp>
 
+#include <ql/errors.hpp>
+
 namespace ore {
 namespace data {
 
+/*! Runs a script on a context. If a compiled program is given, it is run instead of interpreting the AST, unless
+    the engine is run in interactive mode. The program must be compiled from the given root node. */
 class ScriptEngine {
 public:
     ScriptEngine(const ASTNodePtr root, const QuantLib::ext::shared_ptr<Context> context,
-                 const QuantLib::ext::shared_ptr<Model> model = nullptr)
-        : root_(root), context_(context), model_(model) {}
+                 const QuantLib::ext::shared_ptr<Model> model = nullptr,
+                 const QuantLib::ext::shared_ptr<ScriptProgram> program = nullptr)
+        : root_(root), context_(context), model_(model), program_(program) {
+        QL_REQUIRE(!program_ || program_->root() == root_,
+                   "ScriptEngine: program is not compiled from the given root node");
+    }
     void run(const std::string& script = "", bool interactive = false, QuantLib::ext::shared_ptr<PayLog> paylog = nullptr,
              bool includePastCashflows = false);
 
@@ -45,6 +54,7 @@ private:
     const ASTNodePtr root_;
     const QuantLib::ext::shared_ptr<Context> context_;
     const QuantLib::ext::shared_ptr<Model> model_;
+    const QuantLib::ext::shared_ptr<ScriptProgram> program_;
 };
 
 } // namespace data
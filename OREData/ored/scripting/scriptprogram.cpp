@@ -0,0 +1,485 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <ored/scripting/scriptprogram.hpp>
+
+#include <ql/errors.hpp>
+
+#include <algorithm>
+#include <map>
+#include <tuple>
+
+namespace ore {
+namespace data {
+
+using Operand = ScriptProgram::Operand;
+using OpCode = ScriptProgram::OpCode;
+
+/* Compiles the AST into the instructions of a ScriptProgram. Each expression is compiled with a register depth d, if
+   its value is not a plain constant or variable reference it is written to register d, sub-expressions use the
+   registers d + 1, d + 2, ... Statements use the registers from their depth on as scratch space. */
+class ScriptCompiler : public AcyclicVisitor,
+                       public Visitor<ASTNode>,
+                       public Visitor<OperatorPlusNode>,
+                       public Visitor<OperatorMinusNode>,
+                       public Visitor<OperatorMultiplyNode>,
+                       public Visitor<OperatorDivideNode>,
+                       public Visitor<NegateNode>,
+                       public Visitor<FunctionAbsNode>,
+                       public Visitor<FunctionExpNode>,
+                       public Visitor<FunctionLogNode>,
+                       public Visitor<FunctionSqrtNode>,
+                       public Visitor<FunctionNormalCdfNode>,
+                       public Visitor<FunctionNormalPdfNode>,
+                       public Visitor<FunctionMinNode>,
+                       public Visitor<FunctionMaxNode>,
+                       public Visitor<FunctionPowNode>,
+                       public Visitor<FunctionPayNode>,
+                       public Visitor<FunctionLogPayNode>,
+                       public Visitor<FunctionNpvNode>,
+                       public Visitor<FunctionNpvMemNode>,
+                       public Visitor<ConstantNumberNode>,
+                       public Visitor<VariableNode>,
+                       public Visitor<SizeOpNode>,
+                       public Visitor<VarEvaluationNode>,
+                       public Visitor<AssignmentNode>,
+                       public Visitor<RequireNode>,
+                       public Visitor<DeclarationNumberNode>,
+                       public Visitor<SequenceNode>,
+                       public Visitor<ConditionEqNode>,
+                       public Visitor<ConditionNeqNode>,
+                       public Visitor<ConditionLtNode>,
+                       public Visitor<ConditionLeqNode>,
+                       public Visitor<ConditionGtNode>,
+                       public Visitor<ConditionGeqNode>,
+                       public Visitor<ConditionNotNode>,
+                       public Visitor<ConditionAndNode>,
+                       public Visitor<ConditionOrNode>,
+                       public Visitor<IfThenElseNode>,
+                       public Visitor<LoopNode> {
+public:
+    explicit ScriptCompiler(ScriptProgram& p) : p_(p) {}
+
+    void compile() { statement(p_.root_, 0); }
+
+    // everything not handled explicitly is run by the interpreter
+
+    void visit(ASTNode& n) override { delegate(n); }
+
+    // operator / function nodes
+
+    void visit(OperatorPlusNode& n) override { binary(n, OpCode::Add); }
+    void visit(OperatorMinusNode& n) override { binary(n, OpCode::Subtract); }
+    void visit(OperatorMultiplyNode& n) override { binary(n, OpCode::Multiply); }
+    void visit(OperatorDivideNode& n) override { binary(n, OpCode::Divide); }
+    void visit(NegateNode& n) override { unary(n, OpCode::Negate); }
+    void visit(FunctionAbsNode& n) override { unary(n, OpCode::Abs); }
+    void visit(FunctionExpNode& n) override { unary(n, OpCode::Exp); }
+    void visit(FunctionLogNode& n) override { unary(n, OpCode::Log); }
+    void visit(FunctionSqrtNode& n) override { unary(n, OpCode::Sqrt); }
+    void visit(FunctionNormalCdfNode& n) override { unary(n, OpCode::NormalCdf); }
+    void visit(FunctionNormalPdfNode& n) override { unary(n, OpCode::NormalPdf); }
+    void visit(FunctionMinNode& n) override { binary(n, OpCode::Min); }
+    void visit(FunctionMaxNode& n) override { binary(n, OpCode::Max); }
+    void visit(FunctionPowNode& n) override { binary(n, OpCode::Pow); }
+
+    // condition nodes
+
+    void visit(ConditionEqNode& n) override { binary(n, OpCode::Equal); }
+    void visit(ConditionNeqNode& n) override { binary(n, OpCode::NotEqual); }
+    void visit(ConditionLtNode& n) override { binary(n, OpCode::Lt); }
+    void visit(ConditionLeqNode& n) override { binary(n, OpCode::Leq); }
+    void visit(ConditionGtNode& n) override { binary(n, OpCode::Gt); }
+    void visit(ConditionGeqNode& n) override { binary(n, OpCode::Geq); }
+    void visit(ConditionNotNode& n) override { unary(n, OpCode::Not); }
+    void visit(ConditionAndNode& n) override { shortCut(n, OpCode::AndShortCut, OpCode::And); }
+    void visit(ConditionOrNode& n) override { shortCut(n, OpCode::OrShortCut, OpCode::Or); }
+
+    // constants / variable related nodes
+
+    void visit(ConstantNumberNode& n) override {
+        result_.kind = Operand::Kind::Constant;
+        result_.index = p_.constants_.size();
+        p_.constants_.push_back(n.value);
+    }
+
+    void visit(VariableNode& n) override { result_ = variable(n, depth_); }
+
+    void visit(SizeOpNode& n) override {
+        Operand v;
+        v.kind = Operand::Kind::Variable;
+        v.index = slot(n.name);
+        result_ = registerResult(emit(OpCode::Size, n, {v}));
+    }
+
+    void visit(VarEvaluationNode& n) override {
+        Size d = depth_;
+        Operand index = expression(n.args[0], d);
+        Operand obs = expression(n.args[1], d + 1);
+        Operand fwd = n.args[2] ? expression(n.args[2], d + 2) : Operand();
+        result_ = registerResult(emit(OpCode::IndexEval, n, {index, obs, fwd}, d));
+    }
+
+    void visit(DeclarationNumberNode& n) override {
+        for (auto const& arg : n.args) {
+            if (!QuantLib::ext::dynamic_pointer_cast<VariableNode>(arg)) {
+                delegate(n);
+                return;
+            }
+        }
+        Size d = depth_;
+        for (auto const& arg : n.args) {
+            auto v = QuantLib::ext::dynamic_pointer_cast<VariableNode>(arg);
+            Size s = slot(v->name);
+            Size check = emit(OpCode::DeclareCheck, *v, {}, s);
+            Operand size = v->args[0] ? expression(v->args[0], d) : Operand();
+            emit(OpCode::Declare, *v, {size}, s);
+            p_.instructions_[check].jump = p_.instructions_.size();
+        }
+    }
+
+    void visit(AssignmentNode& n) override {
+        auto v = QuantLib::ext::dynamic_pointer_cast<VariableNode>(n.args[0]);
+        if (!v) {
+            delegate(n);
+            return;
+        }
+        Size d = depth_;
+        // the right hand side must not alias the assigned variable
+        Operand right = toRegister(expression(n.args[1], d), d, n);
+        Operand left = variable(*v, d + 1);
+        emit(OpCode::Assign, n, {left, right}, left.index);
+    }
+
+    void visit(RequireNode& n) override { emit(OpCode::Require, n, {expression(n.args[0], depth_)}); }
+
+    // control flow nodes
+
+    void visit(SequenceNode& n) override {
+        for (auto const& arg : n.args)
+            statement(arg, depth_);
+    }
+
+    void visit(IfThenElseNode& n) override {
+        Size d = depth_;
+        Operand cond = toRegister(expression(n.args[0], d), d, n);
+        Size ifBegin = emit(OpCode::IfBegin, n, {cond});
+        statement(n.args[1], d + 1);
+        p_.instructions_[ifBegin].jump = emit(OpCode::PopFilter, n, {});
+        if (n.args[2]) {
+            Size elseBegin = emit(OpCode::ElseBegin, n, {cond});
+            statement(n.args[2], d + 1);
+            p_.instructions_[elseBegin].jump = emit(OpCode::PopFilter, n, {});
+        }
+    }
+
+    void visit(LoopNode& n) override {
+        Size d = depth_;
+        Size loop = p_.loops_++;
+        Operand var;
+        var.kind = Operand::Kind::Variable;
+        var.index = slot(n.name);
+        Operand left = expression(n.args[0], d);
+        Operand right = expression(n.args[1], d + 1);
+        Operand step = expression(n.args[2], d + 2);
+        emit(OpCode::LoopInit, n, {left, right, step, var}, loop);
+        Size test = emit(OpCode::LoopTest, n, {}, loop);
+        statement(n.args[3], d);
+        p_.instructions_[emit(OpCode::LoopNext, n, {}, loop)].jump = test;
+        p_.instructions_[test].jump = p_.instructions_.size();
+    }
+
+    // model dependent function nodes
+
+    void visit(FunctionPayNode& n) override { pay(n, false); }
+
+    void visit(FunctionLogPayNode& n) override { pay(n, true); }
+
+    void visit(FunctionNpvNode& n) override { npv(n, false); }
+
+    void visit(FunctionNpvMemNode& n) override { npv(n, true); }
+
+private:
+    // helpers to compile sub-nodes
+
+    Operand expression(const ASTNodePtr& n, const Size depth) {
+        auto saved = std::make_tuple(current_, depth_, expression_);
+        current_ = n;
+        depth_ = depth;
+        expression_ = true;
+        result_ = Operand();
+        n->accept(*this);
+        std::tie(current_, depth_, expression_) = saved;
+        return result_;
+    }
+
+    void statement(const ASTNodePtr& n, const Size depth) {
+        auto saved = std::make_tuple(current_, depth_, expression_);
+        current_ = n;
+        depth_ = depth;
+        expression_ = false;
+        n->accept(*this);
+        std::tie(current_, depth_, expression_) = saved;
+    }
+
+    Size slot(const std::string& name) {
+        auto s = slots_.find(name);
+        if (s != slots_.end())
+            return s->second;
+        p_.variables_.push_back(name);
+        return slots_[name] = p_.variables_.size() - 1;
+    }
+
+    Size emit(const OpCode op, ASTNode& n, const std::vector<Operand>& args, const Size target = 0) {
+        ScriptProgram::Instruction i;
+        i.op = op;
+        i.node = &n;
+        i.target = target;
+        i.args = args;
+        p_.instructions_.push_back(i);
+        return p_.instructions_.size() - 1;
+    }
+
+    Operand registerResult(const Size instruction) { return registerResult(instruction, depth_); }
+
+    Operand registerResult(const Size instruction, const Size r) {
+        p_.instructions_[instruction].target = r;
+        p_.registers_ = std::max(p_.registers_, r + 1);
+        Operand o;
+        o.kind = Operand::Kind::Register;
+        o.index = r;
+        return o;
+    }
+
+    Operand toRegister(const Operand& o, const Size depth, ASTNode& n) {
+        if (o.kind == Operand::Kind::Register || o.kind == Operand::Kind::Constant)
+            return o;
+        return registerResult(emit(OpCode::Copy, n, {o}), depth);
+    }
+
+    Operand variable(VariableNode& n, const Size depth) {
+        Operand v;
+        v.index = slot(n.name);
+        v.node = &n;
+        if (!n.args[0]) {
+            v.kind = Operand::Kind::Variable;
+            return v;
+        }
+        v.kind = Operand::Kind::ArrayElement;
+        Operand subscript = expression(n.args[0], depth);
+        if (subscript.kind == Operand::Kind::Variable) {
+            v.subscriptIsVariable = true;
+            v.subscript = subscript.index;
+        } else if (subscript.kind == Operand::Kind::Register) {
+            v.subscript = subscript.index;
+        } else {
+            // constants and array elements are copied to a register
+            v.subscript = registerResult(emit(OpCode::Copy, n, {subscript}), depth).index;
+        }
+        return v;
+    }
+
+    void delegate(ASTNode& n) {
+        QL_REQUIRE(current_.get() == &n, "ScriptCompiler: internal error, node to delegate is not the current node");
+        Size i = emit(OpCode::Delegate, n, {});
+        p_.instructions_[i].flag = expression_;
+        if (expression_)
+            result_ = registerResult(i);
+        p_.delegatedNodes_.push_back(current_);
+    }
+
+    void unary(ASTNode& n, const OpCode op) {
+        Size d = depth_;
+        Operand x = expression(n.args[0], d);
+        result_ = registerResult(emit(op, n, {x}));
+    }
+
+    void binary(ASTNode& n, const OpCode op) {
+        Size d = depth_;
+        Operand x = expression(n.args[0], d);
+        Operand y = expression(n.args[1], d + 1);
+        result_ = registerResult(emit(op, n, {x, y}));
+    }
+
+    void shortCut(ASTNode& n, const OpCode shortCutOp, const OpCode op) {
+        Size d = depth_;
+        Operand x = expression(n.args[0], d);
+        Size check = emit(shortCutOp, n, {x});
+        registerResult(check);
+        Operand y = expression(n.args[1], d + 1);
+        result_ = registerResult(emit(op, n, {x, y}));
+        p_.instructions_[check].jump = p_.instructions_.size();
+    }
+
+    void pay(ASTNode& n, const bool log) {
+        std::string cashflowType;
+        if (log && n.args[4]) {
+            auto cftname = QuantLib::ext::dynamic_pointer_cast<VariableNode>(n.args[5]);
+            if (!cftname || cftname->args[0]) {
+                // let the interpreter report the error when it is actually hit
+                delegate(n);
+                return;
+            }
+            cashflowType = cftname->name;
+        }
+        Size d = depth_;
+        Operand payDate = expression(n.args[2], d);
+        Size check = emit(OpCode::PayCheck, n, {payDate});
+        p_.instructions_[check].flag = log;
+        registerResult(check);
+        Operand amount = expression(n.args[0], d + 1);
+        Operand obsDate = expression(n.args[1], d + 2);
+        Operand payCcy = expression(n.args[3], d + 3);
+        Operand legNo, slot;
+        if (log && n.args[4]) {
+            Size noPayLog = emit(OpCode::JumpIfNoPayLog, n, {});
+            legNo = expression(n.args[4], d + 4);
+            if (n.args[6])
+                slot = expression(n.args[6], d + 5);
+            p_.instructions_[noPayLog].jump = p_.instructions_.size();
+        }
+        Size i = emit(OpCode::Pay, n, {amount, obsDate, payDate, payCcy, legNo, slot});
+        p_.instructions_[i].flag = log;
+        p_.instructions_[i].name = cashflowType;
+        result_ = registerResult(i);
+        p_.instructions_[check].jump = p_.instructions_.size();
+    }
+
+    void npv(ASTNode& n, const bool hasMemSlot) {
+        Size d = depth_;
+        Size opt = hasMemSlot ? 3 : 2;
+        Operand amount = expression(n.args[0], d);
+        Operand obsDate = expression(n.args[1], d + 1);
+        Operand memSlot = hasMemSlot ? expression(n.args[2], d + 2) : Operand();
+        Operand filter = n.args[opt] ? expression(n.args[opt], d + 3) : Operand();
+        Operand addRegressor1 = n.args[opt + 1] ? expression(n.args[opt + 1], d + 4) : Operand();
+        Operand addRegressor2 = n.args[opt + 2] ? expression(n.args[opt + 2], d + 5) : Operand();
+        Size i = emit(OpCode::Npv, n, {amount, obsDate, memSlot, filter, addRegressor1, addRegressor2});
+        p_.instructions_[i].flag = hasMemSlot;
+        result_ = registerResult(i);
+    }
+
+    ScriptProgram& p_;
+    std::map<std::string, Size> slots_;
+    // state of the compiler
+    ASTNodePtr current_;
+    Size depth_ = 0;
+    bool expression_ = false;
+    Operand result_;
+};
+
+ScriptProgram::ScriptProgram(const ASTNodePtr root) : root_(root) {
+    QL_REQUIRE(root_, "ScriptProgram: root node is null");
+    ScriptCompiler(*this).compile();
+}
+
+std::ostream& operator<<(std::ostream& out, const ScriptProgram::OpCode op) {
+    switch (op) {
+    case OpCode::Add:
+        return out << "Add";
+    case OpCode::Subtract:
+        return out << "Subtract";
+    case OpCode::Multiply:
+        return out << "Multiply";
+    case OpCode::Divide:
+        return out << "Divide";
+    case OpCode::Min:
+        return out << "Min";
+    case OpCode::Max:
+        return out << "Max";
+    case OpCode::Pow:
+        return out << "Pow";
+    case OpCode::Negate:
+        return out << "Negate";
+    case OpCode::Abs:
+        return out << "Abs";
+    case OpCode::Exp:
+        return out << "Exp";
+    case OpCode::Log:
+        return out << "Log";
+    case OpCode::Sqrt:
+        return out << "Sqrt";
+    case OpCode::NormalCdf:
+        return out << "NormalCdf";
+    case OpCode::NormalPdf:
+        return out << "NormalPdf";
+    case OpCode::Equal:
+        return out << "Equal";
+    case OpCode::NotEqual:
+        return out << "NotEqual";
+    case OpCode::Lt:
+        return out << "Lt";
+    case OpCode::Leq:
+        return out << "Leq";
+    case OpCode::Gt:
+        return out << "Gt";
+    case OpCode::Geq:
+        return out << "Geq";
+    case OpCode::Not:
+        return out << "Not";
+    case OpCode::And:
+        return out << "And";
+    case OpCode::Or:
+        return out << "Or";
+    case OpCode::AndShortCut:
+        return out << "AndShortCut";
+    case OpCode::OrShortCut:
+        return out << "OrShortCut";
+    case OpCode::Copy:
+        return out << "Copy";
+    case OpCode::Size:
+        return out << "Size";
+    case OpCode::IndexEval:
+        return out << "IndexEval";
+    case OpCode::PayCheck:
+        return out << "PayCheck";
+    case OpCode::JumpIfNoPayLog:
+        return out << "JumpIfNoPayLog";
+    case OpCode::Pay:
+        return out << "Pay";
+    case OpCode::Npv:
+        return out << "Npv";
+    case OpCode::Delegate:
+        return out << "Delegate";
+    case OpCode::Assign:
+        return out << "Assign";
+    case OpCode::DeclareCheck:
+        return out << "DeclareCheck";
+    case OpCode::Declare:
+        return out << "Declare";
+    case OpCode::Require:
+        return out << "Require";
+    case OpCode::IfBegin:
+        return out << "IfBegin";
+    case OpCode::ElseBegin:
+        return out << "ElseBegin";
+    case OpCode::PopFilter:
+        return out << "PopFilter";
+    case OpCode::LoopInit:
+        return out << "LoopInit";
+    case OpCode::LoopTest:
+        return out << "LoopTest";
+    case OpCode::LoopNext:
+        return out << "LoopNext";
+    default:
+        QL_FAIL("ScriptProgram::OpCode (" << static_cast<int>(op) << ") not handled");
+    }
+}
+
+} // namespace data
+} // namespace ore
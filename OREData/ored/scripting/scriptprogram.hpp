@@ -0,0 +1,151 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file ored/scripting/scriptprogram.hpp
+    \brief script ast compiled to register bytecode
+    \ingroup utilities
+*/
+
+#pragma once
+
+#include <ored/scripting/ast.hpp>
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace ore {
+namespace data {
+
+//! Script AST compiled to a register bytecode
+/*! The program is compiled once from an AST and can then be run by the ScriptEngine against any number of contexts
+    and models, it does not depend on either of them. Expression values are held in registers that are allocated at
+    compile time, variables are referenced by slots that are resolved from their names at compile time and bound to
+    the context on first use during a run. Constants are materialised once per run.
+
+    The control flow of the script (conditions with short cut evaluation, if-then-else with the filter stack, loops)
+    is translated to jumps. Nodes that are rarely used or dominated by the model calls they trigger (DATEINDEX, SORT,
+    PERMUTE, HISTFIXING, DISCOUNT, BLACK, DCF, DAYS, FWDCOMP, FWDAVG, ABOVEPROB, BELOWPROB) are delegated to the AST
+    interpreter, so that the results of a program run are identical to interpreting the AST.
+
+    The instructions refer to the nodes of the AST for error reporting, so the program keeps the AST alive.
+*/
+class ScriptProgram {
+public:
+    enum class OpCode {
+        // number operations, target = register
+        Add,
+        Subtract,
+        Multiply,
+        Divide,
+        Min,
+        Max,
+        Pow,
+        Negate,
+        Abs,
+        Exp,
+        Log,
+        Sqrt,
+        NormalCdf,
+        NormalPdf,
+        // conditions, target = register
+        Equal,
+        NotEqual,
+        Lt,
+        Leq,
+        Gt,
+        Geq,
+        Not,
+        And,
+        Or,
+        AndShortCut, // sets target to false and jumps if args[0] is deterministically false
+        OrShortCut,  // sets target to true and jumps if args[0] is deterministically true
+        // values, target = register
+        Copy,
+        Size,
+        IndexEval,
+        PayCheck,        // sets target to zero and jumps if the pay date is not after the reference date
+        JumpIfNoPayLog,  // jumps if the run does not write a pay log
+        Pay,
+        Npv,
+        Delegate, // runs the node with the AST interpreter, target = register if flag is set
+        // statements
+        Assign,
+        DeclareCheck, // target = variable slot, jumps if the declaration is ignored
+        Declare,      // target = variable slot
+        Require,
+        IfBegin,   // pushes filter && args[0], jumps if the result is deterministically false
+        ElseBegin, // pushes filter && !args[0], jumps if the result is deterministically false
+        PopFilter,
+        LoopInit, // target = loop
+        LoopTest, // target = loop, jumps if the loop is finished
+        LoopNext  // target = loop, jumps to the loop test
+    };
+
+    struct Operand {
+        enum class Kind : unsigned char { None, Register, Constant, Variable, ArrayElement };
+        Kind kind = Kind::None;
+        //! register, constant or variable slot
+        QuantLib::Size index = 0;
+        //! array elements only: register or variable slot holding the subscript
+        QuantLib::Size subscript = 0;
+        bool subscriptIsVariable = false;
+        //! variables and array elements only: variable node for error reporting
+        ASTNode* node = nullptr;
+    };
+
+    struct Instruction {
+        OpCode op;
+        ASTNode* node;
+        QuantLib::Size target = 0;
+        std::vector<Operand> args;
+        //! target instruction of jumps
+        QuantLib::Size jump = 0;
+        //! op specific: log pay for Pay / PayCheck, mem slot for Npv, expression for Delegate
+        bool flag = false;
+        //! op specific: cashflow type for Pay
+        std::string name;
+    };
+
+    explicit ScriptProgram(const ASTNodePtr root);
+
+    const ASTNodePtr& root() const { return root_; }
+    const std::vector<Instruction>& instructions() const { return instructions_; }
+    const std::vector<double>& constants() const { return constants_; }
+    //! variable names by slot
+    const std::vector<std::string>& variables() const { return variables_; }
+    QuantLib::Size registers() const { return registers_; }
+    QuantLib::Size loops() const { return loops_; }
+    //! nodes that are run by the AST interpreter
+    const std::vector<ASTNodePtr>& delegatedNodes() const { return delegatedNodes_; }
+
+private:
+    friend class ScriptCompiler;
+    ASTNodePtr root_;
+    std::vector<Instruction> instructions_;
+    std::vector<double> constants_;
+    std::vector<std::string> variables_;
+    QuantLib::Size registers_ = 0;
+    QuantLib::Size loops_ = 0;
+    std::vector<ASTNodePtr> delegatedNodes_;
+};
+
+std::ostream& operator<<(std::ostream& out, const ScriptProgram::OpCode op);
+
+} // namespace data
+} // namespace ore
@@ -209,6 +209,7 @@
 #include <ored/portfolio/worstofbasketswap.hpp>
 
 #include <qle/math/basiccpuenvironment.hpp>
+#include <qle/math/fusedcpuenvironment.hpp>
 #include <qle/math/openclenvironment.hpp>
 
 #include <boost/thread/lock_types.hpp>
@@ -544,6 +545,7 @@ void dataBuilders() {
 
     ORE_REGISTER_COMPUTE_FRAMEWORK_CREATOR("OpenCL", QuantExt::OpenClFramework, false);
     ORE_REGISTER_COMPUTE_FRAMEWORK_CREATOR("BasicCpu", QuantExt::BasicCpuFramework, false);
+    ORE_REGISTER_COMPUTE_FRAMEWORK_CREATOR("FusedCpu", QuantExt::FusedCpuFramework, false);
 }
 
 } // namespace ore::data
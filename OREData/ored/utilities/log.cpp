@@ -269,14 +269,23 @@ void EventLogger::setFormatter(
 }
 
 // The Log itself
-Log::Log() : loggers_(), enabled_(false), mask_(255), ls_() {
+Log::Log() : loggers_(), enabled_(false), mask_(255), ls_(), excludeFilters_(std::make_shared<ExcludeFilters>()) {
 
     ls_.setf(ios::fixed, ios::floatfield);
     ls_.setf(ios::showpoint);
+
+    queueTail_ = new AsyncRecord;
+    queueHead_.store(queueTail_);
+}
+
+Log::~Log() {
+    setAsynchronous(false);
+    delete queueTail_;
 }
 
 void Log::registerLogger(const QuantLib::ext::shared_ptr<Logger>& logger) {
     boost::unique_lock<boost::shared_mutex> lock(mutex_);
+    std::lock_guard<std::mutex> writerLock(writerMutex_);
     QL_REQUIRE(loggers_.find(logger->name()) == loggers_.end(),
                "Logger with name " << logger->name() << " already registered");
     loggers_[logger->name()] = logger;
@@ -318,7 +327,9 @@ QuantLib::ext::shared_ptr<IndependentLogger>& Log::independentLogger(const strin
 }
 
 void Log::removeLogger(const string& name) {
+    flush();
     boost::unique_lock<boost::shared_mutex> lock(mutex_);
+    std::lock_guard<std::mutex> writerLock(writerMutex_);
     map<string, QuantLib::ext::shared_ptr<Logger>>::iterator it = loggers_.find(name);
     if (it != loggers_.end()) {
         loggers_.erase(it);
@@ -339,7 +350,9 @@ void Log::removeIndependentLogger(const string& name) {
 }
 
 void Log::removeAllLoggers() {
+    flush();
     boost::unique_lock<boost::shared_mutex> lock(mutex_);
+    std::lock_guard<std::mutex> writerLock(writerMutex_);
     loggers_.clear();
     logging::core::get()->remove_all_sinks();
     independentLoggers_.clear();
@@ -370,18 +383,23 @@ string Log::source(const char* filename, int lineNo) const {
 }
 
 void Log::addExcludeFilter(const string& key, const std::function<bool(const std::string&)> func) {
+    // copy on write, readers keep the snapshot they have loaded
     boost::unique_lock<boost::shared_mutex> lock(mutex_);
-    excludeFilters_[key] = func;
+    auto filters = std::make_shared<ExcludeFilters>(*std::atomic_load(&excludeFilters_));
+    (*filters)[key] = func;
+    std::atomic_store(&excludeFilters_, std::shared_ptr<const ExcludeFilters>(std::move(filters)));
 }
 
 void Log::removeExcludeFilter(const string& key) {
     boost::unique_lock<boost::shared_mutex> lock(mutex_);
-    excludeFilters_.erase(key);
+    auto filters = std::make_shared<ExcludeFilters>(*std::atomic_load(&excludeFilters_));
+    filters->erase(key);
+    std::atomic_store(&excludeFilters_, std::shared_ptr<const ExcludeFilters>(std::move(filters)));
 }
 
 bool Log::checkExcludeFilters(const std::string& msg) {
-    boost::shared_lock<boost::shared_mutex> lock(mutex_);
-    for (const auto& f : excludeFilters_) {
+    auto filters = std::atomic_load(&excludeFilters_);
+    for (const auto& f : *filters) {
         if (f.second(msg))
             return true;
     }
@@ -389,6 +407,10 @@ bool Log::checkExcludeFilters(const std::string& msg) {
 }
 
 void Log::header(unsigned m, const char* filename, int lineNo) {
+    header(m, filename, lineNo, microsec_clock::local_time());
+}
+
+void Log::header(unsigned m, const char* filename, int lineNo, const ptime& time) {
     // 1. Reset stringstream
     ls_.str(string());
     ls_.clear();
@@ -425,7 +447,7 @@ void Log::header(unsigned m, const char* filename, int lineNo) {
     // Timestamp
     // Use boost::posix_time microsecond clock to get better precision (when available).
     // format is "2014-Apr-04 11:10:16.179347"
-    ls_ << '[' << to_simple_string(microsec_clock::local_time()) << ']';
+    ls_ << '[' << to_simple_string(time) << ']';
 
     // Filename & line no
     // format is " (file:line)"
@@ -466,6 +488,98 @@ void Log::log(unsigned m) {
     }
 }
 
+void Log::write(unsigned m, const char* filename, int lineNo, string&& msg) {
+    if (!asynchronous()) {
+        std::lock_guard<std::mutex> lock(writerMutex_);
+        header(m, filename, lineNo);
+        ls_ << msg;
+        log(m);
+        return;
+    }
+
+    auto record = new AsyncRecord;
+    record->mask = m;
+    record->filename = filename;
+    record->lineNo = lineNo;
+    record->time = microsec_clock::local_time();
+    record->msg = std::move(msg);
+    push(record);
+
+    // errors are written before we return, also if the mode was switched off in the meantime
+    if (m == ORE_ALERT || m == ORE_CRITICAL || m == ORE_ERROR || !asynchronous())
+        flush();
+    else if (writerWaiting_.load(std::memory_order_relaxed))
+        wakeCv_.notify_one();
+}
+
+void Log::push(AsyncRecord* record) {
+    // multi producer single consumer queue, the producers only exchange the head and link the previous head
+    AsyncRecord* prev = queueHead_.exchange(record, std::memory_order_acq_rel);
+    prev->next.store(record, std::memory_order_release);
+    enqueued_.fetch_add(1, std::memory_order_release);
+}
+
+void Log::drain() {
+    // the producers never take the writer mutex, so writing a batch does not block the LOG calls
+    std::lock_guard<std::mutex> lock(writerMutex_);
+    AsyncRecord* next;
+    while ((next = queueTail_->next.load(std::memory_order_acquire)) != nullptr) {
+        // the old stub is deleted, the record becomes the new stub
+        delete queueTail_;
+        queueTail_ = next;
+        header(next->mask, next->filename, next->lineNo, next->time);
+        ls_ << next->msg;
+        next->msg.clear();
+        // this might run on the writer thread, so errors of the loggers can not be passed on to the caller
+        try {
+            log(next->mask);
+        } catch (...) {
+        }
+        written_.fetch_add(1, std::memory_order_release);
+    }
+}
+
+void Log::flush() {
+    // a producer might have exchanged the head, but not yet linked its record, we wait for it in this case
+    std::size_t target = enqueued_.load(std::memory_order_acquire);
+    while (written_.load(std::memory_order_acquire) < target) {
+        drain();
+        if (written_.load(std::memory_order_acquire) < target)
+            std::this_thread::yield();
+    }
+}
+
+void Log::writeRecords() {
+    while (!stopWriter_.load(std::memory_order_acquire)) {
+        drain();
+        std::unique_lock<std::mutex> lock(wakeMutex_);
+        writerWaiting_.store(true, std::memory_order_relaxed);
+        // producers notify without holding the mutex, so a wake up might be missed, this is bounded by the timeout
+        wakeCv_.wait_for(lock, std::chrono::milliseconds(10), [this]() {
+            return stopWriter_.load(std::memory_order_acquire) ||
+                   written_.load(std::memory_order_acquire) < enqueued_.load(std::memory_order_acquire);
+        });
+        writerWaiting_.store(false, std::memory_order_relaxed);
+    }
+}
+
+void Log::setAsynchronous(const bool b) {
+    std::lock_guard<std::mutex> lock(asyncMutex_);
+    if (b == asynchronous())
+        return;
+    if (b) {
+        stopWriter_.store(false, std::memory_order_release);
+        writer_ = std::thread(&Log::writeRecords, this);
+        asynchronous_.store(true, std::memory_order_release);
+    } else {
+        asynchronous_.store(false, std::memory_order_release);
+        stopWriter_.store(true, std::memory_order_release);
+        wakeCv_.notify_one();
+        writer_.join();
+        flush();
+    }
+}
+
 // --------
 
 LoggerStream::LoggerStream(unsigned mask, const char* filename, unsigned lineNo)
@@ -479,12 +593,8 @@ LoggerStream::~LoggerStream() {
     string text;
     while (getline(ss_, text)) {
         // we expand the MLOG macro here so we can overwrite __FILE__ and __LINE__
-        if (ore::data::Log::instance().enabled() && ore::data::Log::instance().filter(mask_)) {
-            boost::unique_lock<boost::shared_mutex> lock(ore::data::Log::instance().mutex());
-            ore::data::Log::instance().header(mask_, filename_, lineNo_);
-            ore::data::Log::instance().logStream() << text;
-            ore::data::Log::instance().log(mask_);
-        }
+        if (ore::data::Log::instance().enabled() && ore::data::Log::instance().filter(mask_))
+            ore::data::Log::instance().write(mask_, filename_, lineNo_, std::move(text));
     }
 }
 
@@ -39,6 +39,7 @@
 #include <time.h>
 
 #include <boost/algorithm/string.hpp>
+#include <boost/date_time/posix_time/ptime.hpp>
 #include <boost/log/attributes/mutable_constant.hpp>
 #include <boost/log/utility/manipulators/add_value.hpp>
 #include <boost/log/attributes.hpp>
@@ -51,9 +52,15 @@
 #include <boost/filesystem.hpp>
 #include <ql/shared_ptr.hpp>
 #include <map>
+#include <memory>
 #include <ql/qldefines.hpp>
 #include <queue>
 
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
 #ifndef BOOST_MSVC
 #include <unistd.h>
 #endif
@@ -360,6 +367,12 @@ private:
 
   Logging is done by the calling thread and the LOG call blocks until all the loggers have returned.
 
+  In asynchronous mode, see setAsynchronous(), the calling thread formats the message and passes it with the source
+  location and time stamp through a lock-free queue to a background thread, which writes the header and calls the
+  loggers. The enabled and mask checks of the LOG macros do not take a lock in either mode. The exclude filters are
+  held in an immutable snapshot that is replaced on each change, so checking them does not take a lock either. The
+  header stream and the loggers are guarded by a writer mutex, which the producers of the asynchronous mode never take.
+
   At start up, the Log class has no loggers and so will ignore any LOG() messages until it is configured.
 
   To configure the Log class to log to a file "/tmp/my_log.txt"
@@ -441,29 +454,23 @@ public:
     std::ostream& logStream() { return ls_; }
     //! macro utility function - do not use directly, not thread safe
     void log(unsigned m);
+    //! macro utility function - do not use directly, writes a message with header to the loggers, thread safe
+    void write(unsigned m, const char* filename, int lineNo, std::string&& msg);
 
     //! mutex to acquire locks
     boost::shared_mutex& mutex() { return mutex_; }
 
     // Avoid a large number of warnings in VS by adding 0 !=
-    bool filter(unsigned mask) {
-        boost::shared_lock<boost::shared_mutex> lock(mutex());
-        return 0 != (mask & mask_);
-    }
-    unsigned mask() {
-        boost::shared_lock<boost::shared_mutex> lock(mutex());
-        return mask_;
-    }
-    void setMask(unsigned mask) {
-        boost::unique_lock<boost::shared_mutex> lock(mutex());
-        mask_ = mask;
-    }
+    bool filter(unsigned mask) { return 0 != (mask & mask_.load(std::memory_order_relaxed)); }
+    unsigned mask() { return mask_.load(std::memory_order_relaxed); }
+    void setMask(unsigned mask) { mask_.store(mask, std::memory_order_relaxed); }
     const boost::filesystem::path& rootPath() {
         boost::shared_lock<boost::shared_mutex> lock(mutex());
         return rootPath_;
     }
     void setRootPath(const boost::filesystem::path& pth) {
         boost::unique_lock<boost::shared_mutex> lock(mutex());
+        std::lock_guard<std::mutex> writerLock(writerMutex_);
         rootPath_ = pth;
     }
     int maxLen() {
@@ -472,40 +479,63 @@ public:
     }
     void setMaxLen(const int n) {
         boost::unique_lock<boost::shared_mutex> lock(mutex());
+        std::lock_guard<std::mutex> writerLock(writerMutex_);
         maxLen_ = n;
     }
 
-    bool enabled() {
-        boost::shared_lock<boost::shared_mutex> lock(mutex());
-        return enabled_;
-    }
-    void switchOn() {
-        boost::unique_lock<boost::shared_mutex> lock(mutex());
-        enabled_ = true;
-    }
-    void switchOff() {
-        boost::unique_lock<boost::shared_mutex> lock(mutex());
-        enabled_ = false;
-    }
+    bool enabled() { return enabled_.load(std::memory_order_relaxed); }
+    void switchOn() { enabled_.store(true, std::memory_order_relaxed); }
+    void switchOff() { enabled_.store(false, std::memory_order_relaxed); }
+
+    //! \name Asynchronous logging
+    //@{
+    /*! If set to true, messages are written to the loggers by a background thread, messages of level error and above
+        are written before the LOG call returns. Switching the mode off writes all pending messages. */
+    void setAsynchronous(const bool b);
+    bool asynchronous() const { return asynchronous_.load(std::memory_order_acquire); }
+    //! blocks until all messages logged before the call are written to the loggers
+    void flush();
+    //@}
 
     bool writeSuppressedMessagesHint() {
-        boost::shared_lock<boost::shared_mutex> lock(mutex());
+        std::lock_guard<std::mutex> lock(writerMutex_);
         return writeSuppressedMessagesHint_;
     }
 
     //! if a PID is set for the logger, messages are tagged with [1234] if pid = 1234
-    void setPid(const int pid) { pid_ = pid; }
+    void setPid(const int pid) {
+        std::lock_guard<std::mutex> lock(writerMutex_);
+        pid_ = pid;
+    }
+
+    ~Log();
 
 private:
     Log();
 
+    // a message of the asynchronous mode, the queue holds a stub record that carries no message
+    struct AsyncRecord {
+        std::atomic<AsyncRecord*> next = nullptr;
+        unsigned mask = 0;
+        const char* filename = nullptr;
+        int lineNo = 0;
+        boost::posix_time::ptime time;
+        std::string msg;
+    };
+
     // not thread safe
     std::string source(const char* filename, int lineNo) const;
+    void header(unsigned m, const char* filename, int lineNo, const boost::posix_time::ptime& time);
+
+    // asynchronous mode: the queue is lock-free for the producers, the consumer side is guarded by writerMutex_
+    void push(AsyncRecord* record);
+    void drain();
+    void writeRecords();
 
     std::map<std::string, QuantLib::ext::shared_ptr<Logger>> loggers_;
     std::map<std::string, QuantLib::ext::shared_ptr<IndependentLogger>> independentLoggers_;
-    bool enabled_;
-    unsigned mask_;
+    std::atomic<bool> enabled_;
+    std::atomic<unsigned> mask_;
     boost::filesystem::path rootPath_;
     std::ostringstream ls_;
 
@@ -520,7 +550,24 @@ private:
 
     mutable boost::shared_mutex mutex_;
 
-    std::map<std::string, std::function<bool(const std::string&)>> excludeFilters_;
+    // immutable snapshot, read with std::atomic_load and replaced with std::atomic_store under mutex_
+    using ExcludeFilters = std::map<std::string, std::function<bool(const std::string&)>>;
+    std::shared_ptr<const ExcludeFilters> excludeFilters_;
+
+    // guards ls_, the header statistics and the calls to the loggers, loggers_ changes take mutex_ and writerMutex_
+    mutable std::mutex writerMutex_;
+
+    // asynchronous mode
+    std::atomic<bool> asynchronous_ = false;
+    std::atomic<AsyncRecord*> queueHead_;
+    AsyncRecord* queueTail_;
+    std::atomic<std::size_t> enqueued_ = 0;
+    std::atomic<std::size_t> written_ = 0;
+    std::mutex asyncMutex_, wakeMutex_;
+    std::condition_variable wakeCv_;
+    std::atomic<bool> writerWaiting_ = false;
+    std::atomic<bool> stopWriter_ = false;
+    std::thread writer_;
 };
 
 /*!
@@ -532,10 +579,7 @@ private:
             std::ostringstream __ore_mlog_tmp_stringstream__;                                                          \
             __ore_mlog_tmp_stringstream__ << text;                                                                     \
             if (!ore::data::Log::instance().checkExcludeFilters(__ore_mlog_tmp_stringstream__.str())) {                \
-                boost::unique_lock<boost::shared_mutex> lock(ore::data::Log::instance().mutex());                      \
-                ore::data::Log::instance().header(mask, __FILE__, __LINE__);                                           \
-                ore::data::Log::instance().logStream() << __ore_mlog_tmp_stringstream__.str();                         \
-                ore::data::Log::instance().log(mask);                                                                  \
+                ore::data::Log::instance().write(mask, __FILE__, __LINE__, __ore_mlog_tmp_stringstream__.str());       \
             }                                                                                                          \
         }                                                                                                              \
     }
@@ -561,11 +605,9 @@ private:
 #define MEM_LOG_USING_LEVEL(LEVEL)                                                                                      \
     {                                                                                                                   \
         if (ore::data::Log::instance().enabled() && ore::data::Log::instance().filter(LEVEL)) {                         \
-            boost::unique_lock<boost::shared_mutex> lock(ore::data::Log::instance().mutex());                           \
-            ore::data::Log::instance().header(LEVEL, __FILE__, __LINE__);                                               \
-            ore::data::Log::instance().logStream() << std::to_string(ore::data::os::getPeakMemoryUsageBytes()) << "|";  \
-            ore::data::Log::instance().logStream() << std::to_string(ore::data::os::getMemoryUsageBytes());             \
-            ore::data::Log::instance().log(LEVEL);                                                                      \
+            ore::data::Log::instance().write(LEVEL, __FILE__, __LINE__,                                                 \
+                                             std::to_string(ore::data::os::getPeakMemoryUsageBytes()) + "|" +           \
+                                                 std::to_string(ore::data::os::getMemoryUsageBytes()));                 \
         }                                                                                                               \
     }
 
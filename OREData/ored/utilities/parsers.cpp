@@ -564,6 +564,19 @@ std::ostream& operator<<(std::ostream& os, QuantLib::LsmBasisSystem::PolynomialT
     }
 }
 
+QuantExt::RandomVariableRegressionMethod parseRandomVariableRegressionMethod(const std::string& s) {
+    static map<string, QuantExt::RandomVariableRegressionMethod> m = {
+        {"QR", QuantExt::RandomVariableRegressionMethod::QR},
+        {"SVD", QuantExt::RandomVariableRegressionMethod::SVD},
+        {"NormalEquations", QuantExt::RandomVariableRegressionMethod::NormalEquations}};
+    auto it = m.find(s);
+    if (it != m.end()) {
+        return it->second;
+    } else {
+        QL_FAIL("Regression method \"" << s << "\" not recognized");
+    }
+}
+
 SobolBrownianGenerator::Ordering parseSobolBrownianGeneratorOrdering(const std::string& s) {
     static map<string, SobolBrownianGenerator::Ordering> m = {{"Factors", SobolBrownianGenerator::Ordering::Factors},
                                                               {"Steps", SobolBrownianGenerator::Ordering::Steps},
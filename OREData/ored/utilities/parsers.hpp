@@ -33,6 +33,7 @@
 #include <qle/currencies/configurablecurrency.hpp>
 #include <qle/indexes/bondindex.hpp>
 #include <qle/instruments/cdsoption.hpp>
+#include <qle/math/randomvariable.hpp>
 #include <qle/methods/multipathgeneratorbase.hpp>
 #include <qle/models/crossassetmodel.hpp>
 #include <qle/pricingengines/mcmultilegbaseengine.hpp>
@@ -287,6 +288,12 @@ QuantLib::LsmBasisSystem::PolynomialType parsePolynomType(const std::string& s);
 */
 std::ostream& operator<<(std::ostream& os, QuantLib::LsmBasisSystem::PolynomialType a);
 
+//! Convert text to QuantExt::RandomVariableRegressionMethod
+/*!
+\ingroup utilities
+*/
+QuantExt::RandomVariableRegressionMethod parseRandomVariableRegressionMethod(const std::string& s);
+
 //! Convert text to QuantLib::SobolBrownianGenerator::Ordering
 /*!
 \ingroup utilities
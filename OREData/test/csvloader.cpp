@@ -0,0 +1,119 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <boost/filesystem.hpp>
+#include <boost/test/unit_test.hpp>
+#include <ored/marketdata/csvloader.hpp>
+#include <oret/toplevelfixture.hpp>
+#include <ql/settings.hpp>
+
+#include <fstream>
+
+using namespace ore::data;
+using namespace QuantLib;
+using namespace std;
+
+using ore::test::TopLevelFixture;
+
+namespace {
+
+// writes a market data file that is large enough to be split into several chunks and a fixing file
+class CsvLoaderFixture : public TopLevelFixture {
+public:
+    Date asof = Date(5, February, 2016);
+    string marketFile, fixingFile;
+
+    CsvLoaderFixture() {
+        Settings::instance().evaluationDate() = asof;
+        auto path = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+        marketFile = path.string() + "_market.txt";
+        fixingFile = path.string() + "_fixings.txt";
+
+        ofstream market(marketFile);
+        market << "# market data\n\n";
+        market << "2016-02-05 FX/RATE/USD/EUR 0.9\n";
+        market << "2016-02-05 FX/RATE/EUR/USD 1.1\n";
+        market << "2016-02-05,MM/RATE/EUR/0D/1W,0.01\n";
+        market << "2016-02-05;MM/RATE/EUR/0D/1W;0.02\n";
+        market << "2016-02-05 INVALID/QUOTE 1.0\n";
+        market << "2016-02-04 MM/RATE/EUR/0D/1W 0.03\r\n";
+        for (Size i = 1; i <= 100000; ++i)
+            market << "2016-02-05 MM/RATE/EUR/0D/" << i << "D " << 0.0001 * static_cast<Real>(i) << "\n";
+
+        ofstream fixings(fixingFile);
+        fixings << "2016-02-04 EUR-EURIBOR-6M 0.001\n";
+        fixings << "2016-02-05 EUR-EURIBOR-6M 0.002\n";
+    }
+
+    ~CsvLoaderFixture() {
+        boost::filesystem::remove(marketFile);
+        boost::filesystem::remove(fixingFile);
+    }
+};
+
+} // namespace
+
+BOOST_FIXTURE_TEST_SUITE(OREDataTestSuite, TopLevelFixture)
+
+BOOST_FIXTURE_TEST_SUITE(CSVLoaderTests, CsvLoaderFixture)
+
+BOOST_AUTO_TEST_CASE(testLoadQuotesAndFixings) {
+
+    BOOST_TEST_MESSAGE("Testing CSVLoader on one and several threads...");
+
+    CSVLoader loader1(marketFile, fixingFile, false, Date(), 1);
+    CSVLoader loader4(marketFile, fixingFile, false, Date(), 4);
+
+    for (auto const& loader : {&loader1, &loader4}) {
+
+        // duplicates are skipped, the first quote in the file is kept
+        BOOST_CHECK_CLOSE(loader->get("MM/RATE/EUR/0D/1W", asof)->quote()->value(), 0.01, 1E-10);
+        BOOST_CHECK_CLOSE(loader->get("MM/RATE/EUR/0D/1W", asof - 1)->quote()->value(), 0.03, 1E-10);
+
+        // the dominant fx quote replaces the inverted quote
+        BOOST_CHECK(loader->has("FX/RATE/EUR/USD", asof));
+        BOOST_CHECK(!loader->has("FX/RATE/USD/EUR", asof));
+
+        // quotes that can not be parsed are skipped on request
+        BOOST_CHECK(!loader->has("INVALID/QUOTE", asof));
+        BOOST_CHECK_THROW(loader->get("INVALID/QUOTE", asof), QuantLib::Error);
+
+        BOOST_CHECK_EQUAL(loader->get(Wildcard("MM/RATE/EUR/0D/1000*"), asof).size(), 12);
+        BOOST_CHECK_EQUAL(loader->get(std::set<string>{"MM/RATE/EUR/0D/7D", "INVALID/QUOTE"}, asof).size(), 1);
+
+        // today's fixing is applied, since we do not imply it
+        BOOST_CHECK_EQUAL(loader->loadFixings().size(), 2);
+    }
+
+    auto quotes1 = loader1.loadQuotes(asof);
+    auto quotes4 = loader4.loadQuotes(asof);
+    BOOST_REQUIRE_EQUAL(quotes1.size(), 100002);
+    BOOST_REQUIRE_EQUAL(quotes4.size(), quotes1.size());
+    bool identical = true, sorted = true;
+    for (Size i = 0; i < quotes1.size(); ++i) {
+        identical = identical && quotes1[i]->name() == quotes4[i]->name() &&
+                    quotes1[i]->quote()->value() == quotes4[i]->quote()->value();
+        sorted = sorted && (i == 0 || quotes1[i - 1]->name() < quotes1[i]->name());
+    }
+    BOOST_CHECK(identical);
+    BOOST_CHECK(sorted);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,182 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <boost/test/unit_test.hpp>
+#include <ored/utilities/log.hpp>
+#include <oret/toplevelfixture.hpp>
+
+#include <atomic>
+#include <sstream>
+#include <thread>
+
+using namespace ore::data;
+using namespace std;
+
+using QuantLib::Size;
+
+using ore::test::TopLevelFixture;
+
+namespace {
+
+// stores the messages, the loggers are called by one thread at a time
+class TestLogger : public Logger {
+public:
+    static const string name;
+    TestLogger() : Logger(name) {}
+    void log(unsigned level, const string& s) override { messages.emplace_back(level, s); }
+    vector<pair<unsigned, string>> messages;
+};
+
+const string TestLogger::name = "TestLogger";
+
+// registers the test logger and restores the log configuration afterwards
+class LogFixture : public TopLevelFixture {
+public:
+    QuantLib::ext::shared_ptr<TestLogger> logger = QuantLib::ext::make_shared<TestLogger>();
+    bool enabled = Log::instance().enabled();
+    unsigned mask = Log::instance().mask();
+
+    LogFixture() {
+        Log::instance().registerLogger(logger);
+        Log::instance().setMask(255);
+        Log::instance().switchOn();
+    }
+
+    ~LogFixture() {
+        Log::instance().setAsynchronous(false);
+        Log::instance().removeLogger(TestLogger::name);
+        Log::instance().setMask(mask);
+        if (!enabled)
+            Log::instance().switchOff();
+    }
+};
+
+} // namespace
+
+BOOST_FIXTURE_TEST_SUITE(OREDataTestSuite, TopLevelFixture)
+
+BOOST_FIXTURE_TEST_SUITE(LogTests, LogFixture)
+
+BOOST_AUTO_TEST_CASE(testAsynchronousLogging) {
+
+    BOOST_TEST_MESSAGE("Testing asynchronous logging from several threads...");
+
+    Log::instance().setAsynchronous(true);
+    BOOST_CHECK(Log::instance().asynchronous());
+
+    // errors are written before the log call returns
+    ELOG("error message");
+    BOOST_REQUIRE_EQUAL(logger->messages.size(), 1);
+    BOOST_CHECK(logger->messages[0].first == ORE_ERROR);
+    BOOST_CHECK(logger->messages[0].second.find("error message") != string::npos);
+
+    // messages filtered by the mask are not queued
+    Log::instance().setMask(ORE_ERROR | ORE_NOTICE);
+    DLOG("debug message");
+
+    // messages from the same source location are suppressed beyond a cutoff of 1000
+    const Size nThreads = 4, nMessages = 200;
+    vector<thread> threads;
+    for (Size t = 0; t < nThreads; ++t) {
+        threads.emplace_back([t]() {
+            for (Size i = 0; i < nMessages; ++i)
+                LOG("thread " << t << " message " << i);
+        });
+    }
+    for (auto& t : threads)
+        t.join();
+    Log::instance().flush();
+
+    BOOST_REQUIRE_EQUAL(logger->messages.size(), 1 + nThreads * nMessages);
+
+    // the messages of each thread are written in the order they were logged
+    vector<Size> next(nThreads, 0);
+    bool ordered = true;
+    for (Size k = 1; k < logger->messages.size(); ++k) {
+        BOOST_CHECK(logger->messages[k].first == ORE_NOTICE);
+        auto const& msg = logger->messages[k].second;
+        auto pos = msg.find("thread ");
+        BOOST_REQUIRE(pos != string::npos);
+        istringstream in(msg.substr(pos + 7));
+        Size t, i;
+        string tmp;
+        in >> t >> tmp >> i;
+        BOOST_REQUIRE(t < nThreads);
+        ordered = ordered && i == next[t]++;
+    }
+    BOOST_CHECK(ordered);
+
+    // switching the mode off writes pending messages
+    LOG("last message");
+    Log::instance().setAsynchronous(false);
+    BOOST_CHECK(!Log::instance().asynchronous());
+    BOOST_REQUIRE_EQUAL(logger->messages.size(), 2 + nThreads * nMessages);
+    BOOST_CHECK(logger->messages.back().second.find("last message") != string::npos);
+
+    // synchronous logging
+    LOG("sync message");
+    BOOST_REQUIRE_EQUAL(logger->messages.size(), 3 + nThreads * nMessages);
+}
+
+BOOST_AUTO_TEST_CASE(testExcludeFiltersWhileLogging) {
+
+    BOOST_TEST_MESSAGE("Testing exclude filter changes while logging asynchronously...");
+
+    Log::instance().setAsynchronous(true);
+    Log::instance().addExcludeFilter("drop", [](const string& msg) { return msg.find("drop") != string::npos; });
+
+    // the filters are changed by another thread while the messages are logged
+    atomic<bool> done = false;
+    thread changer([&done]() {
+        while (!done.load()) {
+            Log::instance().addExcludeFilter("other",
+                                             [](const string& msg) { return msg.find("other") != string::npos; });
+            Log::instance().removeExcludeFilter("other");
+        }
+    });
+
+    const Size nThreads = 4, nMessages = 100;
+    vector<thread> threads;
+    for (Size t = 0; t < nThreads; ++t) {
+        threads.emplace_back([t]() {
+            for (Size i = 0; i < nMessages; ++i) {
+                LOG("keep thread " << t << " message " << i);
+                LOG("drop thread " << t << " message " << i);
+            }
+        });
+    }
+    for (auto& t : threads)
+        t.join();
+    done.store(true);
+    changer.join();
+    Log::instance().removeExcludeFilter("drop");
+    Log::instance().flush();
+
+    BOOST_REQUIRE_EQUAL(logger->messages.size(), nThreads * nMessages);
+    for (auto const& m : logger->messages)
+        BOOST_CHECK(m.second.find("keep thread") != string::npos);
+
+    // removed filters do not apply any more
+    LOG("drop message");
+    Log::instance().flush();
+    BOOST_REQUIRE_EQUAL(logger->messages.size(), nThreads * nMessages + 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE_END()
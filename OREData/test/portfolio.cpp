@@ -18,15 +18,45 @@
 
 #include <boost/make_shared.hpp>
 #include <boost/test/unit_test.hpp>
+#include <ored/marketdata/marketobjectrecorder.hpp>
+#include <ored/portfolio/builders/cachingenginebuilder.hpp>
+#include <ored/portfolio/enginedata.hpp>
+#include <ored/portfolio/enginefactory.hpp>
 #include <ored/portfolio/fxforward.hpp>
 #include <ored/portfolio/portfolio.hpp>
 #include <oret/toplevelfixture.hpp>
 
+#include "oredtestmarket.hpp"
+
 using namespace QuantLib;
 using namespace boost::unit_test_framework;
 using namespace std;
 using namespace ore::data;
 
+namespace {
+// engine builder that requires the discount curve of the given currency, the engine itself is not needed
+class TestEngineBuilder : public CachingPricingEngineBuilder<std::string, const std::string&> {
+public:
+    TestEngineBuilder() : CachingEngineBuilder("Model", "Engine", {"Test"}) {}
+
+protected:
+    std::string keyImpl(const std::string& ccy) override { return ccy; }
+    QuantLib::ext::shared_ptr<PricingEngine> engineImpl(const std::string& ccy) override {
+        MarketObjectRecorder::record(MarketObject::DiscountCurve, ccy);
+        return nullptr;
+    }
+};
+
+QuantLib::ext::shared_ptr<EngineFactory> testEngineFactory() {
+    auto engineData = QuantLib::ext::make_shared<EngineData>();
+    engineData->model("Test") = "Model";
+    engineData->modelParameters("Test") = {};
+    engineData->engine("Test") = "Engine";
+    engineData->engineParameters("Test") = {};
+    return QuantLib::ext::make_shared<EngineFactory>(engineData, nullptr);
+}
+} // namespace
+
 BOOST_FIXTURE_TEST_SUITE(OREDataTestSuite, ore::test::TopLevelFixture)
 
 BOOST_AUTO_TEST_SUITE(PortfolioTests)
@@ -119,6 +149,140 @@ BOOST_AUTO_TEST_CASE(testIds) {
     BOOST_CHECK(portfolio->ids() == trade_ids);
 }
 
+BOOST_AUTO_TEST_CASE(testMarketObjectRecorder) {
+    BOOST_CHECK(!MarketObjectRecorder::active());
+    // without an active recorder nothing is recorded
+    MarketObjectRecorder::record(MarketObject::DiscountCurve, "EUR");
+
+    std::set<std::pair<MarketObject, std::string>> expected;
+    {
+        MarketObjectRecorder outer;
+        BOOST_CHECK(MarketObjectRecorder::active());
+        MarketObjectRecorder::record(MarketObject::DiscountCurve, "USD");
+        {
+            MarketObjectRecorder inner;
+            MarketObjectRecorder::record(MarketObject::IndexCurve, "EUR-EURIBOR-6M");
+            BOOST_CHECK_EQUAL(inner.objects().size(), 1);
+            BOOST_CHECK(inner.complete());
+        }
+        expected = {{MarketObject::DiscountCurve, "USD"}, {MarketObject::IndexCurve, "EUR-EURIBOR-6M"}};
+        BOOST_CHECK(outer.objects() == expected);
+        BOOST_CHECK(outer.complete());
+        {
+            MarketObjectRecorder inner;
+            MarketObjectRecorder::recordUnknown();
+            BOOST_CHECK(!inner.complete());
+        }
+        BOOST_CHECK(!outer.complete());
+    }
+    BOOST_CHECK(!MarketObjectRecorder::active());
+}
+
+BOOST_AUTO_TEST_CASE(testMarketObjectRecorderWithCachedEngine) {
+    TestEngineBuilder builder;
+    std::set<std::pair<MarketObject, std::string>> expected = {{MarketObject::DiscountCurve, "EUR"}};
+
+    // the second trade gets the cached engine, the market objects must be recorded nevertheless
+    for (Size i = 0; i < 2; ++i) {
+        MarketObjectRecorder recorder;
+        builder.engine("EUR");
+        BOOST_CHECK(recorder.complete());
+        BOOST_CHECK(recorder.objects() == expected);
+    }
+
+    // an engine cached while no recorder was active can not be recorded
+    builder.reset();
+    builder.engine("EUR");
+    MarketObjectRecorder recorder;
+    builder.engine("EUR");
+    BOOST_CHECK(!recorder.complete());
+}
+
+BOOST_AUTO_TEST_CASE(testEngineFactoryResolvedBuilderAfterRegisterBuilder) {
+    auto factory = testEngineFactory();
+    auto builder1 = QuantLib::ext::make_shared<TestEngineBuilder>();
+    factory->registerBuilder(builder1);
+
+    // the second lookup is served from the resolved builders
+    BOOST_CHECK(factory->builder("Test") == builder1);
+    BOOST_CHECK(factory->builder("Test") == builder1);
+
+    // overwriting the builder must not return the previously resolved one
+    auto builder2 = QuantLib::ext::make_shared<TestEngineBuilder>();
+    factory->registerBuilder(builder2, true);
+    BOOST_CHECK(factory->builder("Test") == builder2);
+
+    // registering a second builder for the same model / engine / trade types without overwrite is an error
+    BOOST_CHECK_THROW(factory->registerBuilder(QuantLib::ext::make_shared<TestEngineBuilder>()), QuantLib::Error);
+    BOOST_CHECK(factory->builder("Test") == builder2);
+}
+
+BOOST_AUTO_TEST_CASE(testEngineFactoryResolvedBuilderAfterClear) {
+    auto factory = testEngineFactory();
+    auto builder = QuantLib::ext::make_shared<TestEngineBuilder>();
+    factory->registerBuilder(builder);
+    BOOST_CHECK(factory->builder("Test") == builder);
+
+    // after clear() the previously resolved builder must not be returned
+    factory->clear();
+    BOOST_CHECK_THROW(factory->builder("Test"), QuantLib::Error);
+
+    // registering again resolves the new builder
+    auto builder2 = QuantLib::ext::make_shared<TestEngineBuilder>();
+    factory->registerBuilder(builder2);
+    BOOST_CHECK(factory->builder("Test") == builder2);
+}
+
+BOOST_AUTO_TEST_CASE(testParallelBuild) {
+
+    BOOST_TEST_MESSAGE("Testing portfolio build on several threads...");
+
+#if !defined(QL_ENABLE_SESSIONS) || !defined(QL_ENABLE_THREAD_SAFE_OBSERVER_PATTERN)
+    // without sessions the portfolio is built on one thread, so this only tests the fallback
+    BOOST_TEST_MESSAGE("QuantLib is built without sessions or the thread safe observer pattern, the portfolio is "
+                       "built serially");
+#endif
+
+    Date asof(7, July, 2019);
+    Settings::instance().evaluationDate() = asof;
+    auto market = QuantLib::ext::make_shared<OredTestMarket>(asof);
+    auto engineData = QuantLib::ext::make_shared<EngineData>();
+    engineData->model("FxForward") = "DiscountedCashflows";
+    engineData->engine("FxForward") = "DiscountingFxForwardEngine";
+    auto engineFactoryBuilder = [&engineData, &market]() {
+        return QuantLib::ext::make_shared<EngineFactory>(engineData, market);
+    };
+
+    // the trades in NOK fail to build, there is no NOK discount curve in the market
+    vector<string> ccys = {"USD", "GBP", "CHF", "NOK", "JPY", "CAD", "SEK"};
+    auto portfolio = [&ccys]() {
+        auto p = QuantLib::ext::make_shared<Portfolio>();
+        for (Size i = 0; i < 50; ++i) {
+            auto t = QuantLib::ext::make_shared<FxForward>(Envelope("CP", "NS"), "2025-07-07", "EUR", 1.0E6,
+                                                           ccys[i % ccys.size()], 1.1E6 + 1000.0 * i);
+            t->id() = "Trade_" + std::to_string(100 + i);
+            p->add(t);
+        }
+        return p;
+    };
+
+    auto serial = portfolio();
+    auto parallel = portfolio();
+    serial->build(engineFactoryBuilder(), "test");
+    parallel->build(engineFactoryBuilder, 4, "test");
+
+    BOOST_REQUIRE_EQUAL(serial->size(), parallel->size());
+    Size failed = 0;
+    for (auto s = serial->trades().begin(), p = parallel->trades().begin(); s != serial->trades().end(); ++s, ++p) {
+        BOOST_CHECK_EQUAL(s->first, p->first);
+        BOOST_CHECK_EQUAL(s->second->tradeType(), p->second->tradeType());
+        BOOST_CHECK_EQUAL(s->second->instrument()->NPV(), p->second->instrument()->NPV());
+        if (p->second->tradeType() == "Failed")
+            ++failed;
+    }
+    BOOST_CHECK_EQUAL(failed, 7);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE_END()
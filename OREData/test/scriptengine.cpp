@@ -1481,6 +1481,111 @@ BOOST_AUTO_TEST_CASE(testNestedIfThenElse) {
     }
 }
 
+namespace {
+// helper for testCompiledProgram
+QuantLib::ext::shared_ptr<Context> compiledProgramTestContext() {
+    auto context = QuantLib::ext::make_shared<Context>();
+    RandomVariable x(16), w(16);
+    for (Size i = 0; i < 16; ++i) {
+        x.set(i, static_cast<Real>(i));
+        w.set(i, static_cast<Real>((i * 7) % 5) - 2.0);
+    }
+    context->scalars["x"] = x;
+    context->scalars["w"] = w;
+    context->scalars["y"] = RandomVariable(16, 2.0);
+    context->scalars["result"] = RandomVariable(16, 0.0);
+    context->scalars["d1"] = EventVec{16, Date(6, Jun, 2019)};
+    context->scalars["d2"] = EventVec{16, Date(6, Jun, 2022)};
+    context->scalars["ccy"] = CurrencyVec{16, "EUR"};
+    context->scalars["und"] = IndexVec{16, "EQ-SP5"};
+    std::vector<ValueType> arr;
+    for (Size i = 0; i < 5; ++i) {
+        RandomVariable a(16);
+        for (Size j = 0; j < 16; ++j)
+            a.set(j, static_cast<Real>((i * 3 + j * 5) % 11));
+        arr.push_back(a);
+    }
+    context->arrays["arr"] = arr;
+    context->arrays["out"] = std::vector<ValueType>(5, RandomVariable(16, 0.0));
+    context->arrays["perm"] = std::vector<ValueType>(5, RandomVariable(16, 0.0));
+    return context;
+}
+
+// exact comparison, equal() compares random variables up to close_enough() only
+bool identical(const ValueType& x, const ValueType& y) {
+    if (x.which() != y.which())
+        return false;
+    if (x.which() == ValueTypeWhich::Number)
+        return QuantLib::ext::get<RandomVariable>(x) == QuantLib::ext::get<RandomVariable>(y);
+    if (x.which() == ValueTypeWhich::Filter)
+        return QuantLib::ext::get<Filter>(x) == QuantLib::ext::get<Filter>(y);
+    Filter f = equal(x, y);
+    return f.deterministic() && f.at(0);
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE(testCompiledProgram) {
+    BOOST_TEST_MESSAGE("Testing compiled script program against ast interpreter...");
+
+    std::vector<std::string> scripts = {
+        "NUMBER i; FOR i IN (1,100,1) DO result = result + i * x; END;",
+        "result = x + y * w - x / y - abs(w) + exp(w) + sqrt(x) + max(x, w) - min(x, 3) + pow(y, w);",
+        "IF x < 8 THEN IF x < 4 THEN result = 1; ELSE result = 2; END; ELSE IF x >= 12 THEN result = 3; END; END;",
+        "IF x > 3 AND w < 1 OR x == 0 THEN result = x; ELSE result = w; END;",
+        "IF {x > 30 OR y > 1} AND {x > 30 AND y > 1} THEN result = 1; ELSE result = 2; END;",
+        "IF d1 < d2 AND ccy == ccy THEN result = 1; END;",
+        "IF x > 4 THEN x = x + 1; x = x * x; END; result = x;",
+        "NUMBER i; FOR i IN (SIZE(arr), 1, -1) DO IF arr[i] > 5 THEN out[i] = arr[i] + i; END; END;",
+        "NUMBER i, j; FOR i IN (1, 3, 1) DO FOR j IN (i, 3, 2) DO result = result + arr[i] * arr[j]; END; END;",
+        "NUMBER a[SIZE(arr) + 1], i; FOR i IN (1, SIZE(a), 1) DO a[i] = i * x; END; result = a[6];",
+        "NUMBER i; SORT(arr, out, perm); FOR i IN (1, 5, 1) DO result = result + out[i] * perm[i]; END;",
+        "IF x > 4 THEN result = PAY(x, d1, d2, ccy) + NPV(x, d1, w > 0) + und(d1); END;",
+        "result = LOGPAY(x, d1, d2, ccy); IF w > 0 THEN result = result + LOGPAY(w, d1, d2, ccy, 1, Premium); END;"
+        "result = result + LOGPAY(y, d1, d2, ccy, 2, Fee, 1) + LOGPAY(x, d1, d2, ccy, 2, Fee, 1);"};
+
+    for (auto const& script : scripts) {
+        BOOST_TEST_MESSAGE("Script: " << script);
+        ScriptParser parser(script);
+        BOOST_REQUIRE(parser.success());
+        auto program = QuantLib::ext::make_shared<ScriptProgram>(parser.ast());
+        auto interpreted = compiledProgramTestContext();
+        auto compiled = compiledProgramTestContext();
+        ScriptEngine interpreter(parser.ast(), interpreted, QuantLib::ext::make_shared<DummyModel>(16));
+        ScriptEngine engine(parser.ast(), compiled, QuantLib::ext::make_shared<DummyModel>(16), program);
+        auto interpretedPaylog = QuantLib::ext::make_shared<PayLog>();
+        auto compiledPaylog = QuantLib::ext::make_shared<PayLog>();
+        BOOST_REQUIRE_NO_THROW(interpreter.run("", false, interpretedPaylog));
+        BOOST_REQUIRE_NO_THROW(engine.run("", false, compiledPaylog));
+        for (auto const& [name, value] : interpreted->scalars) {
+            BOOST_REQUIRE(compiled->scalars.find(name) != compiled->scalars.end());
+            BOOST_CHECK_MESSAGE(identical(value, compiled->scalars.at(name)), "scalar " << name << " differs");
+        }
+        for (auto const& [name, values] : interpreted->arrays) {
+            BOOST_REQUIRE(compiled->arrays.find(name) != compiled->arrays.end());
+            BOOST_REQUIRE_EQUAL(values.size(), compiled->arrays.at(name).size());
+            for (Size i = 0; i < values.size(); ++i)
+                BOOST_CHECK_MESSAGE(identical(values[i], compiled->arrays.at(name)[i]),
+                                    "array " << name << "[" << i + 1 << "] differs");
+        }
+        BOOST_REQUIRE_EQUAL(interpretedPaylog->size(), compiledPaylog->size());
+        for (Size i = 0; i < interpretedPaylog->size(); ++i) {
+            BOOST_CHECK_MESSAGE(interpretedPaylog->amounts()[i] == compiledPaylog->amounts()[i],
+                                "paylog amount #" << i << " differs");
+            BOOST_CHECK_EQUAL(interpretedPaylog->dates()[i], compiledPaylog->dates()[i]);
+            BOOST_CHECK_EQUAL(interpretedPaylog->currencies()[i], compiledPaylog->currencies()[i]);
+            BOOST_CHECK_EQUAL(interpretedPaylog->legNos()[i], compiledPaylog->legNos()[i]);
+            BOOST_CHECK_EQUAL(interpretedPaylog->cashflowTypes()[i], compiledPaylog->cashflowTypes()[i]);
+        }
+    }
+
+    // errors are reported by the compiled program as well
+    ScriptParser parser("NUMBER i; FOR i IN (1, 6, 1) DO result = result + arr[i]; END;");
+    BOOST_REQUIRE(parser.success());
+    ScriptEngine engine(parser.ast(), compiledProgramTestContext(), QuantLib::ext::make_shared<DummyModel>(16),
+                        QuantLib::ext::make_shared<ScriptProgram>(parser.ast()));
+    BOOST_CHECK_THROW(engine.run(), QuantLib::Error);
+}
+
 BOOST_AUTO_TEST_CASE(testInteractive, *boost::unit_test::disabled()) {
 
     // not a test, just for convenience, to be removed at some stage...
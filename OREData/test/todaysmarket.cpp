@@ -830,6 +830,38 @@ BOOST_AUTO_TEST_CASE(testZeroSpreadedYieldCurve) {
     }
 }
 
+BOOST_AUTO_TEST_CASE(testParallelYieldCurveBuild) {
+
+    BOOST_TEST_MESSAGE("Testing yield curve build on several threads...");
+
+#if !defined(QL_ENABLE_SESSIONS) || !defined(QL_ENABLE_THREAD_SAFE_OBSERVER_PATTERN)
+    // without sessions TodaysMarket falls back to the serial build, so this only tests the fallback
+    BOOST_TEST_MESSAGE("QuantLib is built without sessions or the thread safe observer pattern, the yield curves are "
+                       "built serially");
+#endif
+
+    Date asof(26, February, 2016);
+    auto parallelMarket = QuantLib::ext::make_shared<TodaysMarket>(
+        asof, marketParameters(), QuantLib::ext::make_shared<MarketDataLoader>(), curveConfigurations(), false, true,
+        false, nullptr, false, IborFallbackConfig::defaultConfig(), true, true, 4);
+
+    DayCounter dc = Actual365Fixed();
+    std::vector<std::pair<Handle<YieldTermStructure>, Handle<YieldTermStructure>>> curves = {
+        {market->discountCurve("EUR"), parallelMarket->discountCurve("EUR")},
+        {market->yieldCurve("EUR_LEND"), parallelMarket->yieldCurve("EUR_LEND")},
+        {market->yieldCurve("EUR_BORROW"), parallelMarket->yieldCurve("EUR_BORROW")}};
+    for (auto const& [serial, parallel] : curves) {
+        for (Size i = 1; i <= 120; i++) {
+            Date d = asof + i * Months;
+            BOOST_CHECK_EQUAL(serial->zeroRate(d, dc, Continuous).rate(),
+                              parallel->zeroRate(d, dc, Continuous).rate());
+        }
+    }
+
+    BOOST_CHECK_EQUAL(market->calibrationInfo()->yieldCurveCalibrationInfo.size(),
+                      parallelMarket->calibrationInfo()->yieldCurveCalibrationInfo.size());
+}
+
 BOOST_AUTO_TEST_CASE(testNormalOptionletVolatility) {
 
     BOOST_TEST_MESSAGE("Testing normal optionlet volatilities...");
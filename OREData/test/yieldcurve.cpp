@@ -34,6 +34,9 @@
 #include <boost/algorithm/string.hpp>
 #include <boost/make_shared.hpp>
 
+#include <mutex>
+#include <thread>
+
 using namespace QuantLib;
 using namespace QuantExt;
 using namespace boost::unit_test_framework;
@@ -158,6 +161,35 @@ struct TodaysMarketArguments {
     QuantLib::ext::shared_ptr<Loader> loader;
 };
 
+// Loader that records the threads on which the single quotes are requested
+class ThreadRecordingLoader : public Loader {
+public:
+    explicit ThreadRecordingLoader(const QuantLib::ext::shared_ptr<Loader>& loader) : loader_(loader) {}
+    vector<QuantLib::ext::shared_ptr<MarketDatum>> loadQuotes(const Date& d) const override {
+        return loader_->loadQuotes(d);
+    }
+    set<Fixing> loadFixings() const override { return loader_->loadFixings(); }
+    set<QuantExt::Dividend> loadDividends() const override { return loader_->loadDividends(); }
+    using Loader::get;
+    QuantLib::ext::shared_ptr<MarketDatum> get(const pair<string, bool>& name, const Date& d) const override {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            threads_[name.first].insert(std::this_thread::get_id());
+        }
+        return loader_->get(name, d);
+    }
+    set<std::thread::id> threads(const string& name) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = threads_.find(name);
+        return it == threads_.end() ? set<std::thread::id>() : it->second;
+    }
+
+private:
+    QuantLib::ext::shared_ptr<Loader> loader_;
+    mutable std::mutex mutex_;
+    mutable map<string, set<std::thread::id>> threads_;
+};
+
 // Used to check that the exception message contains the expected message string, expMsg.
 struct ExpErrorPred {
 
@@ -345,6 +377,38 @@ BOOST_DATA_TEST_CASE(testBootstrapARSinUSDPasses, bdata::make(curveConfigFiles),
     BOOST_TEST_MESSAGE("Discount: " << std::fixed << std::setprecision(14) << yts->discount(1.0));
 }
 
+// Test that ARS-IN-USD, which looks up the in-ccy USD discount curve, is built in parallel with the same result
+BOOST_AUTO_TEST_CASE(testParallelBuildARSinUSDWithInCcyDiscountCurve) {
+
+    BOOST_TEST_MESSAGE("Testing parallel build of ARS-IN-USD using the in-ccy USD discount curve...");
+
+#if !defined(QL_ENABLE_SESSIONS) || !defined(QL_ENABLE_THREAD_SAFE_OBSERVER_PATTERN)
+    BOOST_TEST_MESSAGE("QuantLib is built without sessions or the thread safe observer pattern, test is skipped");
+#else
+    TodaysMarketArguments tma(Date(25, Sep, 2019), "ars_in_usd", "inccy_discount.xml");
+    auto loader = QuantLib::ext::make_shared<ThreadRecordingLoader>(tma.loader);
+
+    QuantLib::ext::shared_ptr<TodaysMarket> serialMarket, parallelMarket;
+    BOOST_REQUIRE_NO_THROW(serialMarket = QuantLib::ext::make_shared<TodaysMarket>(
+                               tma.asof, tma.todaysMarketParameters, tma.loader, tma.curveConfigs, false, false));
+    BOOST_REQUIRE_NO_THROW(parallelMarket = QuantLib::ext::make_shared<TodaysMarket>(
+                               tma.asof, tma.todaysMarketParameters, loader, tma.curveConfigs, false, false, false,
+                               nullptr, false, IborFallbackConfig::defaultConfig(), true, true, 2));
+
+    // the curve must have been built on a worker thread, not by the serial build after a failed parallel build
+    set<std::thread::id> threads = loader->threads("FXFWD/RATE/USD/ARS/1M");
+    BOOST_REQUIRE(!threads.empty());
+    BOOST_CHECK(threads.count(std::this_thread::get_id()) == 0);
+
+    Handle<YieldTermStructure> serial = serialMarket->discountCurve("ARS");
+    Handle<YieldTermStructure> parallel = parallelMarket->discountCurve("ARS");
+    for (Size i = 1; i <= 12; ++i) {
+        Date d = tma.asof + i * Months;
+        BOOST_CHECK_EQUAL(serial->discount(d), parallel->discount(d));
+    }
+#endif
+}
+
 BOOST_DATA_TEST_CASE(testOiFirstFutureDateVsValuationDate, bdata::make(oiFutureCases), oiFutureCase) {
 
     BOOST_TEST_MESSAGE("Testing OI future. " << oiFutureCase);
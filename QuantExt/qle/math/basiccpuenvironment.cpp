@@ -21,6 +21,7 @@
 #include <qle/math/randomvariable_io.hpp>
 #include <qle/math/randomvariable_opcodes.hpp>
 #include <qle/math/randomvariable_ops.hpp>
+#include <qle/math/workerpool.hpp>
 #include <qle/methods/multipathgeneratorbase.hpp>
 
 #include <ql/errors.hpp>
@@ -31,11 +32,20 @@
 #include <boost/algorithm/string/join.hpp>
 #include <boost/timer/timer.hpp>
 
+#include <atomic>
+#include <functional>
+#include <thread>
+
 namespace QuantExt {
 
+namespace {
+// number of samples per chunk in multi-threaded calculations
+constexpr std::size_t chunkSize = 4096;
+} // namespace
+
 class BasicCpuContext : public ComputeContext {
 public:
-    BasicCpuContext();
+    explicit BasicCpuContext(const std::size_t numberOfThreads = 1);
     ~BasicCpuContext() override final;
     void init() override final;
 
@@ -53,6 +63,7 @@ public:
     void declareOutputVariable(const std::size_t id) override final;
     void finalizeCalculation(std::vector<double*>& output) override final;
 
+    std::vector<std::pair<std::string, std::string>> deviceInfo() const override;
     bool supportsDoublePrecision() const override { return true; }
 
     const DebugInfo& debugInfo() const override final;
@@ -60,6 +71,11 @@ public:
 private:
     enum class ComputeState { idle, createInput, createVariates, calc };
 
+    RandomVariable& value(const std::size_t id);
+    void runOps(const std::vector<RandomVariableOp>& ops, const std::size_t begin, const std::size_t end);
+    void runOpsChunked(const std::vector<RandomVariableOp>& ops, const std::size_t begin, const std::size_t end,
+                       const std::size_t numberOfThreads);
+
     class program {
     public:
         program() {}
@@ -84,6 +100,7 @@ private:
         std::vector<std::size_t> resultId_;
     };
 
+    std::size_t numberOfThreads_;
     bool initialized_ = false;
 
     // will be accumulated over all calcs
@@ -115,9 +132,21 @@ private:
     std::unique_ptr<QuantLib::MersenneTwisterUniformRng> rng_;
     QuantLib::InverseCumulativeNormal icn_;
     std::vector<RandomVariable> variates_;
+
+    // per thread work storage for multi-threaded calcs
+
+    std::vector<std::vector<RandomVariable>> chunkValues_;
+    std::vector<std::vector<bool>> chunkValid_;
+
+    // worker threads for multi-threaded calcs, kept for the lifetime of the context
+    WorkerPool pool_;
 };
 
-BasicCpuFramework::BasicCpuFramework() { contexts_["BasicCpu/Default/Default"] = new BasicCpuContext(); }
+BasicCpuFramework::BasicCpuFramework() {
+    contexts_["BasicCpu/Default/Default"] = new BasicCpuContext(1);
+    contexts_["BasicCpu/Default/MultiThreaded"] =
+        new BasicCpuContext(std::max<std::size_t>(1, std::thread::hardware_concurrency()));
+}
 
 BasicCpuFramework::~BasicCpuFramework() {
     for (auto& [_, c] : contexts_) {
@@ -125,7 +154,10 @@ BasicCpuFramework::~BasicCpuFramework() {
     }
 }
 
-BasicCpuContext::BasicCpuContext() : initialized_(false) {}
+BasicCpuContext::BasicCpuContext(const std::size_t numberOfThreads)
+    : numberOfThreads_(numberOfThreads), initialized_(false) {
+    QL_REQUIRE(numberOfThreads_ > 0, "BasicCpuContext: number of threads must be positive");
+}
 
 BasicCpuContext::~BasicCpuContext() {}
 
@@ -327,6 +359,145 @@ void BasicCpuContext::declareOutputVariable(const std::size_t id) {
     outputVars_[currentId_ - 1].push_back(id);
 }
 
+RandomVariable& BasicCpuContext::value(const std::size_t id) {
+    if (id < numberOfInputVars_[currentId_ - 1])
+        return values_[id];
+    else if (id < numberOfInputVars_[currentId_ - 1] + numberOfVariates_[currentId_ - 1])
+        return variates_[id - numberOfInputVars_[currentId_ - 1]];
+    else
+        return values_[id - numberOfVariates_[currentId_ - 1]];
+}
+
+void BasicCpuContext::runOps(const std::vector<RandomVariableOp>& ops, const std::size_t begin,
+                             const std::size_t end) {
+    const auto& p = program_[currentId_ - 1];
+    for (Size i = begin; i < end; ++i) {
+        std::vector<const RandomVariable*> args(p.args(i).size());
+        for (Size j = 0; j < p.args(i).size(); ++j)
+            args[j] = &value(p.args(i)[j]);
+        if (p.resultId(i) >= numberOfInputVars_[currentId_ - 1] &&
+            p.resultId(i) < numberOfInputVars_[currentId_ - 1] + numberOfVariates_[currentId_ - 1]) {
+            QL_FAIL("BasiCpuContext::finalizeCalculation(): internal error, result id "
+                    << p.resultId(i) << " does not fall into values array.");
+        }
+        value(p.resultId(i)) = ops[p.op(i)](args);
+    }
+}
+
+/* Runs the elementwise ops [begin, end) on chunks of samples in parallel. Each chunk is evaluated on local copies of
+   its slice of the variables, the results are collected in new full-size variables which replace the current ones
+   once all chunks are done, so that chunks still reading the previous value of a reused id are not affected. The
+   first chunk is run upfront to determine which results are deterministic. */
+void BasicCpuContext::runOpsChunked(const std::vector<RandomVariableOp>& ops, const std::size_t begin,
+                                    const std::size_t end, const std::size_t numberOfThreads) {
+    const auto& p = program_[currentId_ - 1];
+    const std::size_t n = size_[currentId_ - 1];
+    const std::size_t numberOfIds =
+        numberOfInputVars_[currentId_ - 1] + numberOfVariates_[currentId_ - 1] + numberOfVars_[currentId_ - 1];
+    const std::size_t numberOfChunks = (n + chunkSize - 1) / chunkSize;
+
+    std::vector<std::size_t> resultIds;
+    for (Size i = begin; i < end; ++i) {
+        QL_REQUIRE(p.resultId(i) < numberOfInputVars_[currentId_ - 1] ||
+                       p.resultId(i) >= numberOfInputVars_[currentId_ - 1] + numberOfVariates_[currentId_ - 1],
+                   "BasiCpuContext::finalizeCalculation(): internal error, result id "
+                       << p.resultId(i) << " does not fall into values array.");
+        resultIds.push_back(p.resultId(i));
+    }
+    std::sort(resultIds.begin(), resultIds.end());
+    resultIds.erase(std::unique(resultIds.begin(), resultIds.end()), resultIds.end());
+
+    std::vector<RandomVariable> results(resultIds.size());
+
+    auto runChunk = [this, &p, &ops, &resultIds, &results, begin, end, n](const std::size_t chunk,
+                                                                        std::vector<RandomVariable>& local,
+                                                                        std::vector<bool>& valid) {
+        const std::size_t offset = chunk * chunkSize;
+        const std::size_t len = std::min(chunkSize, n - offset);
+        std::vector<std::size_t> touched;
+        std::vector<const RandomVariable*> args;
+        for (Size i = begin; i < end; ++i) {
+            args.resize(p.args(i).size());
+            for (Size j = 0; j < p.args(i).size(); ++j) {
+                std::size_t id = p.args(i)[j];
+                if (!valid[id]) {
+                    RandomVariable& v = value(id);
+                    if (!v.initialised())
+                        local[id] = RandomVariable();
+                    else if (v.deterministic())
+                        local[id] = RandomVariable(len, v[0], v.time());
+                    else
+                        local[id] = RandomVariable(len, v.data() + offset, v.time());
+                    valid[id] = true;
+                    touched.push_back(id);
+                }
+                args[j] = &local[id];
+            }
+            local[p.resultId(i)] = ops[p.op(i)](args);
+            if (!valid[p.resultId(i)]) {
+                valid[p.resultId(i)] = true;
+                touched.push_back(p.resultId(i));
+            }
+        }
+        for (Size k = 0; k < resultIds.size(); ++k) {
+            RandomVariable& r = local[resultIds[k]];
+            if (chunk == 0) {
+                if (!r.initialised())
+                    results[k] = RandomVariable();
+                else if (r.deterministic())
+                    results[k] = RandomVariable(n, r[0], r.time());
+                else {
+                    results[k] = RandomVariable(n, 0.0, r.time());
+                    results[k].expand();
+                }
+            }
+            if (!results[k].initialised() || results[k].deterministic()) {
+                QL_REQUIRE(r.initialised() == results[k].initialised() && r.deterministic(),
+                           "BasicCpuContext::finalizeCalculation(): internal error, result id "
+                               << resultIds[k] << " is deterministic on the first chunk only.");
+            } else if (r.deterministic()) {
+                std::fill(results[k].data() + offset, results[k].data() + offset + len, r[0]);
+            } else {
+                std::copy(r.data(), r.data() + len, results[k].data() + offset);
+            }
+        }
+        for (auto id : touched) {
+            local[id].clear();
+            valid[id] = false;
+        }
+    };
+
+    // run the first chunk on the main thread, the remaining chunks are shared between the worker threads
+
+    auto& local = chunkValues_;
+    auto& valid = chunkValid_;
+    local.resize(std::max(local.size(), numberOfThreads));
+    valid.resize(std::max(valid.size(), numberOfThreads));
+    for (std::size_t t = 0; t < numberOfThreads; ++t) {
+        local[t].resize(numberOfIds);
+        valid[t].assign(numberOfIds, false);
+    }
+
+    runChunk(0, local[0], valid[0]);
+
+    std::atomic<std::size_t> nextChunk(1);
+    std::function<void(std::size_t)> worker = [&runChunk, &local, &valid, &nextChunk,
+                                               numberOfChunks](const std::size_t thread) {
+        try {
+            for (std::size_t c = nextChunk++; c < numberOfChunks; c = nextChunk++)
+                runChunk(c, local[thread], valid[thread]);
+        } catch (...) {
+            nextChunk = numberOfChunks;
+            throw;
+        }
+    };
+
+    pool_.run(numberOfThreads, worker);
+
+    for (Size k = 0; k < resultIds.size(); ++k)
+        value(resultIds[k]) = std::move(results[k]);
+}
+
 void BasicCpuContext::finalizeCalculation(std::vector<double*>& output) {
     struct exitGuard {
         exitGuard() {}
@@ -350,25 +521,27 @@ void BasicCpuContext::finalizeCalculation(std::vector<double*>& output) {
 
     values_.resize(numberOfInputVars_[currentId_ - 1] + numberOfVars_[currentId_ - 1]);
 
-    // execute calculation
+    // execute calculation, in the multi-threaded case the sample dimension is split into chunks, except for
+    // conditional expectations which require all samples
 
-    for (Size i = 0; i < program_[currentId_ - 1].size(); ++i) {
-        std::vector<const RandomVariable*> args(p.args(i).size());
-        for (Size j = 0; j < p.args(i).size(); ++j) {
-            if (p.args(i)[j] < numberOfInputVars_[currentId_ - 1])
-                args[j] = &values_[p.args(i)[j]];
-            else if (p.args(i)[j] < numberOfInputVars_[currentId_ - 1] + numberOfVariates_[currentId_ - 1])
-                args[j] = &variates_[p.args(i)[j] - numberOfInputVars_[currentId_ - 1]];
-            else
-                args[j] = &values_[p.args(i)[j] - numberOfVariates_[currentId_ - 1]];
-        }
-        if (p.resultId(i) < numberOfInputVars_[currentId_ - 1])
-            values_[p.resultId(i)] = ops[p.op(i)](args);
-        else if (p.resultId(i) >= numberOfInputVars_[currentId_ - 1] + numberOfVariates_[currentId_ - 1])
-            values_[p.resultId(i) - numberOfVariates_[currentId_ - 1]] = ops[p.op(i)](args);
-        else {
-            QL_FAIL("BasiCpuContext::finalizeCalculation(): internal error, result id "
-                    << p.resultId(i) << " does not fall into values array.");
+    std::size_t numberOfThreads = settings_.numberOfThreads == 0 ? numberOfThreads_ : settings_.numberOfThreads;
+    std::size_t numberOfChunks = (size_[currentId_ - 1] + chunkSize - 1) / chunkSize;
+    numberOfThreads = std::min(numberOfThreads, numberOfChunks);
+
+    if (numberOfThreads <= 1) {
+        runOps(ops, 0, p.size());
+    } else {
+        std::size_t begin = 0;
+        while (begin < p.size()) {
+            std::size_t end = begin;
+            while (end < p.size() && p.op(end) != RandomVariableOpCode::ConditionalExpectation)
+                ++end;
+            if (end == begin) {
+                runOps(ops, begin, ++end);
+            } else {
+                runOpsChunked(ops, begin, end, numberOfThreads);
+            }
+            begin = end;
         }
     }
 
@@ -390,15 +563,25 @@ void BasicCpuContext::finalizeCalculation(std::vector<double*>& output) {
     }
 }
 
+std::vector<std::pair<std::string, std::string>> BasicCpuContext::deviceInfo() const {
+    return {{"threads", std::to_string(numberOfThreads_)}, {"chunk size", std::to_string(chunkSize)}};
+}
+
 const ComputeContext::DebugInfo& BasicCpuContext::debugInfo() const { return debugInfo_; }
 
-std::set<std::string> BasicCpuFramework::getAvailableDevices() const { return {"BasicCpu/Default/Default"}; }
+std::set<std::string> BasicCpuFramework::getAvailableDevices() const {
+    std::set<std::string> result;
+    for (auto const& [d, _] : contexts_)
+        result.insert(d);
+    return result;
+}
 
 ComputeContext* BasicCpuFramework::getContext(const std::string& deviceName) {
-    QL_REQUIRE(deviceName == "BasicCpu/Default/Default",
-               "BasicCpuFramework::getContext(): device '"
-                   << deviceName << "' not supported. Available device is 'BasicCpu/Default/Default'.");
-    return contexts_[deviceName];
+    auto c = contexts_.find(deviceName);
+    QL_REQUIRE(c != contexts_.end(), "BasicCpuFramework::getContext(): device '"
+                                         << deviceName << "' not supported. Available devices are "
+                                         << boost::join(getAvailableDevices(), ", ") << ".");
+    return c->second;
 }
 
 }; // namespace QuantExt
@@ -66,12 +66,14 @@ public:
     struct Settings {
         Settings()
             : debug(false), useDoublePrecision(false), rngSequenceType(QuantExt::SequenceType::MersenneTwister),
-              rngSeed(42), regressionOrder(4) {}
+              rngSeed(42), regressionOrder(4), numberOfThreads(0) {}
         bool debug;
         bool useDoublePrecision;
         QuantExt::SequenceType rngSequenceType;
         std::size_t rngSeed;
         std::size_t regressionOrder;
+        // number of cpu threads used by contexts supporting this, 0 means the default of the device
+        std::size_t numberOfThreads;
     };
 
     struct DebugInfo {
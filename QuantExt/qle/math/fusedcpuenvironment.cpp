@@ -0,0 +1,943 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <qle/math/fusedcpuenvironment.hpp>
+#include <qle/math/randomvariable.hpp>
+#include <qle/math/randomvariable_opcodes.hpp>
+#include <qle/math/randomvariable_ops.hpp>
+#include <qle/math/workerpool.hpp>
+
+#include <ql/errors.hpp>
+#include <ql/math/comparison.hpp>
+#include <ql/math/distributions/normaldistribution.hpp>
+#include <ql/math/randomnumbers/mt19937uniformrng.hpp>
+
+#include <boost/timer/timer.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <limits>
+#include <thread>
+
+namespace QuantExt {
+
+namespace {
+
+// number of samples processed in one block, the register file of a thread holds this many samples per register
+constexpr std::size_t blockSize = 1024;
+
+// argument of an elementwise operation on a block of samples, a scalar is broadcast over the block
+struct Arg {
+    const double* data;
+    bool scalar;
+};
+
+template <class F> void applyUnary(double* r, const Arg& x, const std::size_t n, F f) {
+    if (x.scalar) {
+        std::fill(r, r + n, f(*x.data));
+    } else {
+        const double* xd = x.data;
+        for (std::size_t i = 0; i < n; ++i)
+            r[i] = f(xd[i]);
+    }
+}
+
+template <class F> void applyBinary(double* r, const Arg& x, const Arg& y, const std::size_t n, F f) {
+    if (x.scalar && y.scalar) {
+        std::fill(r, r + n, f(*x.data, *y.data));
+    } else if (x.scalar) {
+        const double xv = *x.data;
+        const double* yd = y.data;
+        for (std::size_t i = 0; i < n; ++i)
+            r[i] = f(xv, yd[i]);
+    } else if (y.scalar) {
+        const double* xd = x.data;
+        const double yv = *y.data;
+        for (std::size_t i = 0; i < n; ++i)
+            r[i] = f(xd[i], yv);
+    } else {
+        const double* xd = x.data;
+        const double* yd = y.data;
+        for (std::size_t i = 0; i < n; ++i)
+            r[i] = f(xd[i], yd[i]);
+    }
+}
+
+/* ops that are not plain arithmetic are evaluated by the random variable function used by the basic cpu context, so
+   that both contexts produce identical results */
+void applyRandomVariableFunction(double* r, const Arg& x, const std::size_t n,
+                                 RandomVariable (*f)(RandomVariable)) {
+    RandomVariable v = f(x.scalar ? RandomVariable(n, *x.data) : RandomVariable(n, x.data));
+    for (std::size_t i = 0; i < n; ++i)
+        r[i] = v[i];
+}
+
+// true if the arg is a scalar close to the given value, the random variable ops skip the operation in this case
+bool scalarCloseTo(const Arg& x, const double value) { return x.scalar && QuantLib::close_enough(*x.data, value); }
+
+void copyArg(double* r, const Arg& x, const std::size_t n) {
+    applyUnary(r, x, n, [](const double x) { return x; });
+}
+
+// the elementwise semantics must match the random variable ops used by the basic cpu context (with eps = 0)
+void applyElementwise(const std::size_t op, double* r, const std::vector<Arg>& args, const std::size_t n) {
+    switch (op) {
+    case RandomVariableOpCode::Add: {
+        /* the sum is accumulated starting from zero, skipping scalar summands close to zero; the first two summands
+           are added in one pass, since the result may overwrite one of them */
+        std::size_t j = 0;
+        while (j < args.size() && scalarCloseTo(args[j], 0.0))
+            ++j;
+        if (j == args.size()) {
+            std::fill(r, r + n, 0.0);
+            break;
+        }
+        std::size_t k = j + 1;
+        while (k < args.size() && scalarCloseTo(args[k], 0.0))
+            ++k;
+        if (k == args.size())
+            applyUnary(r, args[j], n, [](const double x) { return 0.0 + x; });
+        else
+            applyBinary(r, args[j], args[k], n, [](const double x, const double y) { return (0.0 + x) + y; });
+        for (++k; k < args.size(); ++k) {
+            if (!scalarCloseTo(args[k], 0.0))
+                applyBinary(r, Arg{r, false}, args[k], n, [](const double x, const double y) { return x + y; });
+        }
+        break;
+    }
+    case RandomVariableOpCode::Subtract:
+        if (scalarCloseTo(args[1], 0.0))
+            copyArg(r, args[0], n);
+        else
+            applyBinary(r, args[0], args[1], n, [](const double x, const double y) { return x - y; });
+        break;
+    case RandomVariableOpCode::Negative:
+        applyUnary(r, args[0], n, [](const double x) { return -x; });
+        break;
+    case RandomVariableOpCode::Mult:
+        if (scalarCloseTo(args[1], 1.0))
+            copyArg(r, args[0], n);
+        else
+            applyBinary(r, args[0], args[1], n, [](const double x, const double y) { return x * y; });
+        break;
+    case RandomVariableOpCode::Div:
+        if (scalarCloseTo(args[1], 1.0))
+            copyArg(r, args[0], n);
+        else
+            applyBinary(r, args[0], args[1], n, [](const double x, const double y) { return x / y; });
+        break;
+    case RandomVariableOpCode::IndicatorEq:
+        applyBinary(r, args[0], args[1], n,
+                    [](const double x, const double y) { return QuantLib::close_enough(x, y) ? 1.0 : 0.0; });
+        break;
+    case RandomVariableOpCode::IndicatorGt:
+        applyBinary(r, args[0], args[1], n, [](const double x, const double y) {
+            return x > y && !QuantLib::close_enough(x, y) ? 1.0 : 0.0;
+        });
+        break;
+    case RandomVariableOpCode::IndicatorGeq:
+        applyBinary(r, args[0], args[1], n, [](const double x, const double y) {
+            return x > y || QuantLib::close_enough(x, y) ? 1.0 : 0.0;
+        });
+        break;
+    case RandomVariableOpCode::Min:
+        applyBinary(r, args[0], args[1], n, [](const double x, const double y) { return std::min(x, y); });
+        break;
+    case RandomVariableOpCode::Max:
+        applyBinary(r, args[0], args[1], n, [](const double x, const double y) { return std::max(x, y); });
+        break;
+    case RandomVariableOpCode::Abs:
+        applyUnary(r, args[0], n, [](const double x) { return std::abs(x); });
+        break;
+    case RandomVariableOpCode::Exp:
+        applyUnary(r, args[0], n, [](const double x) { return std::exp(x); });
+        break;
+    case RandomVariableOpCode::Sqrt:
+        applyUnary(r, args[0], n, [](const double x) { return std::sqrt(x); });
+        break;
+    case RandomVariableOpCode::Log:
+        applyUnary(r, args[0], n, [](const double x) { return std::log(x); });
+        break;
+    case RandomVariableOpCode::Pow:
+        if (scalarCloseTo(args[1], 1.0))
+            copyArg(r, args[0], n);
+        else
+            applyBinary(r, args[0], args[1], n, [](const double x, const double y) { return std::pow(x, y); });
+        break;
+    case RandomVariableOpCode::NormalCdf:
+        applyRandomVariableFunction(r, args[0], n, &normalCdf);
+        break;
+    case RandomVariableOpCode::NormalPdf:
+        applyRandomVariableFunction(r, args[0], n, &normalPdf);
+        break;
+    default:
+        QL_FAIL("FusedCpuContext: internal error, op " << op << " is not elementwise.");
+    }
+}
+
+// number of arguments required by an op, or 0 if the op takes a variable number of arguments (at least one)
+std::size_t requiredNumberOfArgs(const std::size_t op) {
+    switch (op) {
+    case RandomVariableOpCode::Add:
+    case RandomVariableOpCode::ConditionalExpectation:
+        return 0;
+    case RandomVariableOpCode::Negative:
+    case RandomVariableOpCode::Abs:
+    case RandomVariableOpCode::Exp:
+    case RandomVariableOpCode::Sqrt:
+    case RandomVariableOpCode::Log:
+    case RandomVariableOpCode::NormalCdf:
+    case RandomVariableOpCode::NormalPdf:
+        return 1;
+    case RandomVariableOpCode::Subtract:
+    case RandomVariableOpCode::Mult:
+    case RandomVariableOpCode::Div:
+    case RandomVariableOpCode::IndicatorEq:
+    case RandomVariableOpCode::IndicatorGt:
+    case RandomVariableOpCode::IndicatorGeq:
+    case RandomVariableOpCode::Min:
+    case RandomVariableOpCode::Max:
+    case RandomVariableOpCode::Pow:
+        return 2;
+    default:
+        QL_FAIL("FusedCpuContext: op " << op << " is not supported.");
+    }
+}
+
+} // namespace
+
+class FusedCpuContext : public ComputeContext {
+public:
+    explicit FusedCpuContext(const std::size_t numberOfThreads);
+    ~FusedCpuContext() override final;
+    void init() override final;
+
+    std::pair<std::size_t, bool> initiateCalculation(const std::size_t n, const std::size_t id = 0,
+                                                     const std::size_t version = 0,
+                                                     const Settings settings = {}) override final;
+    void disposeCalculation(const std::size_t id) override final;
+    std::size_t createInputVariable(double v) override final;
+    std::size_t createInputVariable(double* v) override final;
+    std::vector<std::vector<std::size_t>> createInputVariates(const std::size_t dim,
+                                                              const std::size_t steps) override final;
+    std::size_t applyOperation(const std::size_t randomVariableOpCode,
+                               const std::vector<std::size_t>& args) override final;
+    void freeVariable(const std::size_t id) override final;
+    void declareOutputVariable(const std::size_t id) override final;
+    void finalizeCalculation(std::vector<double*>& output) override final;
+
+    std::vector<std::pair<std::string, std::string>> deviceInfo() const override final;
+    bool supportsDoublePrecision() const override final { return true; }
+
+    const DebugInfo& debugInfo() const override final;
+
+private:
+    enum class ComputeState { idle, createInput, createVariates, calc };
+
+    struct Instruction {
+        std::size_t op;
+        std::vector<std::size_t> args;
+        std::size_t resultId;
+    };
+
+    struct Input {
+        bool scalar = true;
+        double value = 0.0;
+        std::vector<double> data;
+    };
+
+    /* Storage location of a value in the compiled kernel:
+       - Scalar: index into scalars_, inputs are stored at their id
+       - Full: index into fullData_, which holds the inputs, then the variates, then the buffers
+       - Register: register number in the register file of the executing thread */
+    struct Operand {
+        enum class Kind { Scalar, Full, Register };
+        Kind kind;
+        std::size_t index;
+    };
+
+    struct Step {
+        std::size_t op;
+        std::vector<Operand> args;
+        Operand result;
+    };
+
+    /* A segment is a sequence of elementwise steps that are applied block by block, followed by the conditional
+       expectations that require the full sample dimension and therefore separate the segment from the next one. */
+    struct Segment {
+        std::vector<Step> steps;
+        std::vector<Step> barrierSteps;
+    };
+
+    struct Kernel {
+        bool compiled = false;
+        std::vector<bool> inputIsScalar;
+        std::size_t numberOfScalars = 0;
+        std::size_t numberOfBuffers = 0;
+        std::size_t numberOfRegisters = 0;
+        std::vector<Step> scalarSteps;
+        std::vector<Segment> segments;
+        std::vector<Operand> output;
+    };
+
+    void compile(const std::size_t id);
+    void runBlocks(const std::vector<Step>& steps, const std::size_t numberOfRegisters, const std::size_t n);
+    void runConditionalExpectation(const Step& step, const std::size_t n);
+    Arg resolve(const Operand& o, const std::size_t offset, double* registers) const;
+    double* target(const Operand& o, const std::size_t offset, double* registers) const;
+
+    std::size_t numberOfThreads_;
+    bool initialized_ = false;
+
+    // will be accumulated over all calcs
+    ComputeContext::DebugInfo debugInfo_;
+
+    // 1a vectors per current calc id
+
+    std::vector<std::size_t> size_;
+    std::vector<std::size_t> version_;
+    std::vector<bool> disposed_;
+    std::vector<std::vector<Instruction>> program_;
+    std::vector<Kernel> kernel_;
+    std::vector<std::size_t> numberOfInputVars_;
+    std::vector<std::size_t> numberOfVariates_;
+    std::vector<std::size_t> numberOfVars_;
+    std::vector<std::vector<std::size_t>> outputVars_;
+
+    // 2 curent calc
+
+    std::size_t currentId_ = 0;
+    ComputeState currentState_ = ComputeState::idle;
+    Settings settings_;
+    bool newCalc_;
+
+    std::vector<std::size_t> freedVariables_;
+
+    // 3 work storage, kept over calcs to avoid reallocations
+
+    std::vector<Input> inputs_;
+    std::vector<double> scalars_;
+    std::vector<double*> fullData_;
+    std::vector<std::vector<double>> buffers_;
+    std::vector<std::vector<double>> registers_;
+
+    // threads executing the blocks, kept over calcs
+    WorkerPool pool_;
+
+    // shared random variates for all calcs
+
+    std::unique_ptr<QuantLib::MersenneTwisterUniformRng> rng_;
+    QuantLib::InverseCumulativeNormal icn_;
+    std::vector<std::vector<double>> variates_;
+};
+
+FusedCpuFramework::FusedCpuFramework() {
+    contexts_["FusedCpu/Default/Default"] =
+        new FusedCpuContext(std::max<std::size_t>(1, std::thread::hardware_concurrency()));
+}
+
+FusedCpuFramework::~FusedCpuFramework() {
+    for (auto& [_, c] : contexts_) {
+        delete c;
+    }
+}
+
+FusedCpuContext::FusedCpuContext(const std::size_t numberOfThreads)
+    : numberOfThreads_(numberOfThreads), initialized_(false) {
+    QL_REQUIRE(numberOfThreads_ > 0, "FusedCpuContext: number of threads must be positive");
+}
+
+FusedCpuContext::~FusedCpuContext() {}
+
+void FusedCpuContext::init() {
+
+    if (initialized_) {
+        return;
+    }
+
+    debugInfo_.numberOfOperations = 0;
+    debugInfo_.nanoSecondsDataCopy = 0;
+    debugInfo_.nanoSecondsProgramBuild = 0;
+    debugInfo_.nanoSecondsCalculation = 0;
+
+    initialized_ = true;
+}
+
+void FusedCpuContext::disposeCalculation(const std::size_t id) {
+    QL_REQUIRE(!disposed_[id - 1], "FusedCpuContext::disposeCalculation(): id " << id << " was already disposed.");
+    program_[id - 1].clear();
+    kernel_[id - 1] = Kernel();
+    disposed_[id - 1] = true;
+}
+
+std::pair<std::size_t, bool> FusedCpuContext::initiateCalculation(const std::size_t n, const std::size_t id,
+                                                                  const std::size_t version, const Settings settings) {
+
+    QL_REQUIRE(n > 0, "FusedCpuContext::initiateCalculation(): n must not be zero");
+
+    newCalc_ = false;
+    settings_ = settings;
+
+    if (id == 0) {
+
+        // initiate new calculation
+
+        size_.push_back(n);
+        version_.push_back(version);
+        disposed_.push_back(false);
+        program_.push_back({});
+        kernel_.push_back(Kernel());
+        numberOfInputVars_.push_back(0);
+        numberOfVariates_.push_back(0);
+        numberOfVars_.push_back(0);
+        outputVars_.push_back({});
+
+        currentId_ = size_.size();
+        newCalc_ = true;
+
+    } else {
+
+        // initiate calculation on existing id
+
+        QL_REQUIRE(id <= size_.size(),
+                   "FusedCpuContext::initiateCalculation(): id (" << id << ") invalid, got 1..." << size_.size());
+        QL_REQUIRE(size_[id - 1] == n, "FusedCpuContext::initiateCalculation(): size ("
+                                           << size_[id - 1] << ") for id " << id << " does not match current size ("
+                                           << n << ")");
+        QL_REQUIRE(!disposed_[id - 1], "FusedCpuContext::initiateCalculation(): id ("
+                                           << id << ") was already disposed, it can not be used any more.");
+
+        if (version != version_[id - 1]) {
+            version_[id - 1] = version;
+            program_[id - 1].clear();
+            kernel_[id - 1] = Kernel();
+            numberOfInputVars_[id - 1] = 0;
+            numberOfVariates_[id - 1] = 0;
+            numberOfVars_[id - 1] = 0;
+            outputVars_[id - 1].clear();
+            newCalc_ = true;
+        }
+
+        currentId_ = id;
+    }
+
+    // reset variables
+
+    numberOfInputVars_[currentId_ - 1] = 0;
+
+    if (newCalc_)
+        freedVariables_.clear();
+
+    // set state
+
+    currentState_ = ComputeState::createInput;
+
+    // return calc id
+
+    return std::make_pair(currentId_, newCalc_);
+}
+
+std::size_t FusedCpuContext::createInputVariable(double v) {
+    QL_REQUIRE(currentState_ == ComputeState::createInput,
+               "FusedCpuContext::createInputVariable(): not in state createInput (" << static_cast<int>(currentState_)
+                                                                                    << ")");
+    std::size_t idx = numberOfInputVars_[currentId_ - 1];
+    if (idx == inputs_.size())
+        inputs_.push_back(Input());
+    inputs_[idx].scalar = true;
+    inputs_[idx].value = v;
+    return numberOfInputVars_[currentId_ - 1]++;
+}
+
+std::size_t FusedCpuContext::createInputVariable(double* v) {
+    QL_REQUIRE(currentState_ == ComputeState::createInput,
+               "FusedCpuContext::createInputVariable(): not in state createInput (" << static_cast<int>(currentState_)
+                                                                                    << ")");
+    std::size_t idx = numberOfInputVars_[currentId_ - 1];
+    if (idx == inputs_.size())
+        inputs_.push_back(Input());
+    inputs_[idx].scalar = false;
+    inputs_[idx].data.assign(v, v + size_[currentId_ - 1]);
+    return numberOfInputVars_[currentId_ - 1]++;
+}
+
+std::vector<std::vector<std::size_t>> FusedCpuContext::createInputVariates(const std::size_t dim,
+                                                                           const std::size_t steps) {
+    QL_REQUIRE(currentState_ == ComputeState::createInput || currentState_ == ComputeState::createVariates,
+               "FusedCpuContext::createInputVariates(): not in state createInput or createVariates ("
+                   << static_cast<int>(currentState_) << ")");
+    QL_REQUIRE(currentId_ > 0, "FusedCpuContext::createInputVariates(): current id is not set");
+    QL_REQUIRE(newCalc_, "FusedCpuContext::createInputVariates(): id (" << currentId_ << ") in version "
+                                                                        << version_[currentId_ - 1] << " is replayed.");
+    currentState_ = ComputeState::createVariates;
+
+    if (rng_ == nullptr) {
+        rng_ = std::make_unique<QuantLib::MersenneTwisterUniformRng>(settings_.rngSeed);
+    }
+
+    if (variates_.size() < numberOfVariates_[currentId_ - 1] + dim * steps) {
+        for (std::size_t i = variates_.size(); i < numberOfVariates_[currentId_ - 1] + dim * steps; ++i) {
+            variates_.push_back(std::vector<double>(size_[currentId_ - 1]));
+            for (auto& v : variates_.back())
+                v = icn_(rng_->nextReal());
+        }
+    }
+
+    std::vector<std::vector<std::size_t>> resultIds(dim, std::vector<std::size_t>(steps));
+    for (std::size_t i = 0; i < dim; ++i) {
+        for (std::size_t j = 0; j < steps; ++j) {
+            resultIds[i][j] = numberOfInputVars_[currentId_ - 1] + numberOfVariates_[currentId_ - 1] + j * dim + i;
+        }
+    }
+
+    numberOfVariates_[currentId_ - 1] += dim * steps;
+
+    return resultIds;
+}
+
+std::size_t FusedCpuContext::applyOperation(const std::size_t randomVariableOpCode,
+                                            const std::vector<std::size_t>& args) {
+    QL_REQUIRE(currentState_ == ComputeState::createInput || currentState_ == ComputeState::createVariates ||
+                   currentState_ == ComputeState::calc,
+               "FusedCpuContext::applyOperation(): not in state createInput or calc ("
+                   << static_cast<int>(currentState_) << ")");
+    currentState_ = ComputeState::calc;
+    QL_REQUIRE(currentId_ > 0, "FusedCpuContext::applyOperation(): current id is not set");
+    QL_REQUIRE(newCalc_, "FusedCpuContext::applyOperation(): id (" << currentId_ << ") in version "
+                                                                   << version_[currentId_ - 1] << " is replayed.");
+
+    // determine variable id to use for result
+
+    std::size_t resultId;
+    if (!freedVariables_.empty()) {
+        resultId = freedVariables_.back();
+        freedVariables_.pop_back();
+    } else {
+        resultId =
+            numberOfInputVars_[currentId_ - 1] + numberOfVariates_[currentId_ - 1] + numberOfVars_[currentId_ - 1]++;
+    }
+
+    // store operation
+
+    program_[currentId_ - 1].push_back(Instruction{randomVariableOpCode, args, resultId});
+
+    // update num of ops in debug info
+
+    if (settings_.debug)
+        debugInfo_.numberOfOperations += 1 * size_[currentId_ - 1];
+
+    // return result id
+
+    return resultId;
+}
+
+void FusedCpuContext::freeVariable(const std::size_t id) {
+    QL_REQUIRE(currentState_ == ComputeState::calc,
+               "FusedCpuContext::free(): not in state calc (" << static_cast<int>(currentState_) << ")");
+    QL_REQUIRE(currentId_ > 0, "FusedCpuContext::freeVariable(): current id is not set");
+    QL_REQUIRE(newCalc_, "FusedCpuContext::freeVariable(): id (" << currentId_ << ") in version "
+                                                                 << version_[currentId_ - 1] << " is replayed.");
+
+    // we do not free variates, since they are shared
+
+    if (id >= numberOfInputVars_[currentId_ - 1] &&
+        id < numberOfInputVars_[currentId_ - 1] + numberOfVariates_[currentId_ - 1])
+        return;
+
+    freedVariables_.push_back(id);
+}
+
+void FusedCpuContext::declareOutputVariable(const std::size_t id) {
+    QL_REQUIRE(currentState_ != ComputeState::idle, "FusedCpuContext::declareOutputVariable(): state is idle");
+    QL_REQUIRE(currentId_ > 0, "FusedCpuContext::declareOutputVariable(): current id not set");
+    QL_REQUIRE(newCalc_, "FusedCpuContext::declareOutputVariable(): id ("
+                             << currentId_ << ") in version " << version_[currentId_ - 1] << " is replayed.");
+    outputVars_[currentId_ - 1].push_back(id);
+}
+
+void FusedCpuContext::compile(const std::size_t id) {
+
+    constexpr std::size_t undefined = std::numeric_limits<std::size_t>::max();
+
+    const auto& program = program_[id - 1];
+    const std::size_t nInput = numberOfInputVars_[id - 1];
+    const std::size_t nVariates = numberOfVariates_[id - 1];
+    const std::size_t nFixed = nInput + nVariates;
+    const std::size_t nOps = program.size();
+    const std::size_t nIds = nFixed + numberOfVars_[id - 1];
+    const std::size_t nValues = nFixed + nOps;
+
+    Kernel kernel;
+    kernel.inputIsScalar.resize(nInput);
+    for (std::size_t i = 0; i < nInput; ++i)
+        kernel.inputIsScalar[i] = inputs_[i].scalar;
+
+    // 1 rename variables to values: value v < nFixed is an input or a variate, otherwise the result of op v - nFixed,
+    //   this resolves the reuse of freed variable ids
+
+    std::vector<std::size_t> def(nIds, undefined);
+    for (std::size_t i = 0; i < nFixed; ++i)
+        def[i] = i;
+
+    std::vector<std::vector<std::size_t>> args(nOps);
+    for (std::size_t k = 0; k < nOps; ++k) {
+        const auto& ins = program[k];
+        std::size_t r = requiredNumberOfArgs(ins.op);
+        QL_REQUIRE(r == 0 ? !ins.args.empty() : ins.args.size() == r,
+                   "FusedCpuContext::compile(): op " << ins.op << " has " << ins.args.size() << " args, expected "
+                                                     << (r == 0 ? "at least 1" : std::to_string(r)));
+        QL_REQUIRE(ins.op != RandomVariableOpCode::ConditionalExpectation || ins.args.size() >= 2,
+                   "FusedCpuContext::compile(): conditional expectation requires at least 2 args, got "
+                       << ins.args.size());
+        args[k].resize(ins.args.size());
+        for (std::size_t j = 0; j < ins.args.size(); ++j) {
+            QL_REQUIRE(ins.args[j] < nIds && def[ins.args[j]] != undefined,
+                       "FusedCpuContext::compile(): arg " << ins.args[j] << " of op #" << k << " is not defined.");
+            args[k][j] = def[ins.args[j]];
+        }
+        def[ins.resultId] = nFixed + k;
+    }
+
+    std::vector<std::size_t> output(outputVars_[id - 1].size());
+    for (std::size_t i = 0; i < output.size(); ++i) {
+        std::size_t o = outputVars_[id - 1][i];
+        QL_REQUIRE(o < nIds && def[o] != undefined,
+                   "FusedCpuContext::compile(): output variable " << o << " is not defined.");
+        output[i] = def[o];
+    }
+
+    // 2 determine the values contributing to the output, the remaining ops are not executed
+
+    std::vector<bool> needed(nValues, false);
+    for (auto v : output)
+        needed[v] = true;
+    for (std::size_t k = nOps; k > 0; --k) {
+        if (needed[nFixed + k - 1]) {
+            for (auto a : args[k - 1])
+                needed[a] = true;
+        }
+    }
+
+    /* 3 classify the values
+       - scalar: inputs given as a number and results of elementwise ops with scalar args only
+       - full: non-scalar values used outside the segment in which they are computed, by a conditional expectation
+         or as an output, these are stored over the full sample dimension
+       - all other values live in a register of the block-wise execution */
+
+    std::vector<bool> scalar(nValues, false), full(nValues, false);
+    std::vector<std::size_t> segment(nValues, 0), lastUse(nValues, 0);
+    for (std::size_t i = 0; i < nInput; ++i)
+        scalar[i] = inputs_[i].scalar;
+
+    std::size_t currentSegment = 0;
+    bool hasOps = false, afterBarrier = false;
+    for (std::size_t k = 0; k < nOps; ++k) {
+        std::size_t v = nFixed + k;
+        if (!needed[v])
+            continue;
+        hasOps = true;
+        if (program[k].op == RandomVariableOpCode::ConditionalExpectation) {
+            segment[v] = currentSegment;
+            full[v] = true;
+            afterBarrier = true;
+            for (auto a : args[k]) {
+                if (!scalar[a])
+                    full[a] = true;
+            }
+        } else {
+            scalar[v] = std::all_of(args[k].begin(), args[k].end(), [&scalar](std::size_t a) { return scalar[a]; });
+            if (!scalar[v]) {
+                if (afterBarrier) {
+                    ++currentSegment;
+                    afterBarrier = false;
+                }
+                segment[v] = currentSegment;
+                for (auto a : args[k]) {
+                    if (!scalar[a] && segment[a] != currentSegment)
+                        full[a] = true;
+                }
+            }
+        }
+        for (auto a : args[k])
+            lastUse[a] = k;
+    }
+
+    for (auto v : output) {
+        if (!scalar[v])
+            full[v] = true;
+        lastUse[v] = nOps;
+    }
+
+    // 4 assign storage to the values reusing buffers and registers of values that are no longer used, and emit steps
+
+    std::vector<Operand> operand(nValues);
+    for (std::size_t i = 0; i < nInput; ++i)
+        operand[i] = Operand{scalar[i] ? Operand::Kind::Scalar : Operand::Kind::Full, i};
+    for (std::size_t i = nInput; i < nFixed; ++i)
+        operand[i] = Operand{Operand::Kind::Full, i};
+
+    kernel.numberOfScalars = nInput;
+    kernel.segments.resize(hasOps ? currentSegment + 1 : 0);
+
+    std::vector<std::size_t> freeBuffers, freeRegisters;
+
+    auto releaseArgs = [&](const std::size_t k) {
+        for (std::size_t j = 0; j < args[k].size(); ++j) {
+            std::size_t a = args[k][j];
+            if (a < nFixed || lastUse[a] != k ||
+                std::find(args[k].begin(), std::next(args[k].begin(), j), a) != std::next(args[k].begin(), j))
+                continue;
+            if (operand[a].kind == Operand::Kind::Full)
+                freeBuffers.push_back(operand[a].index - nFixed);
+            else if (operand[a].kind == Operand::Kind::Register)
+                freeRegisters.push_back(operand[a].index);
+        }
+    };
+
+    for (std::size_t k = 0; k < nOps; ++k) {
+        std::size_t v = nFixed + k;
+        if (!needed[v])
+            continue;
+
+        // elementwise ops with up to two args can be computed in place, i.e. the result may overwrite an arg
+
+        bool inPlace = args[k].size() <= 2 && program[k].op != RandomVariableOpCode::ConditionalExpectation;
+        if (inPlace)
+            releaseArgs(k);
+
+        if (scalar[v]) {
+            operand[v] = Operand{Operand::Kind::Scalar, kernel.numberOfScalars++};
+        } else if (full[v]) {
+            std::size_t b;
+            if (!freeBuffers.empty()) {
+                b = freeBuffers.back();
+                freeBuffers.pop_back();
+            } else {
+                b = kernel.numberOfBuffers++;
+            }
+            operand[v] = Operand{Operand::Kind::Full, nFixed + b};
+        } else {
+            std::size_t r;
+            if (!freeRegisters.empty()) {
+                r = freeRegisters.back();
+                freeRegisters.pop_back();
+            } else {
+                r = kernel.numberOfRegisters++;
+            }
+            operand[v] = Operand{Operand::Kind::Register, r};
+        }
+
+        if (!inPlace)
+            releaseArgs(k);
+
+        Step step;
+        step.op = program[k].op;
+        for (auto a : args[k])
+            step.args.push_back(operand[a]);
+        step.result = operand[v];
+
+        if (scalar[v])
+            kernel.scalarSteps.push_back(step);
+        else if (step.op == RandomVariableOpCode::ConditionalExpectation)
+            kernel.segments[segment[v]].barrierSteps.push_back(step);
+        else
+            kernel.segments[segment[v]].steps.push_back(step);
+    }
+
+    for (auto v : output)
+        kernel.output.push_back(operand[v]);
+
+    kernel.compiled = true;
+    kernel_[id - 1] = std::move(kernel);
+}
+
+Arg FusedCpuContext::resolve(const Operand& o, const std::size_t offset, double* registers) const {
+    switch (o.kind) {
+    case Operand::Kind::Scalar:
+        return Arg{&scalars_[o.index], true};
+    case Operand::Kind::Full:
+        return Arg{fullData_[o.index] + offset, false};
+    default:
+        return Arg{registers + o.index * blockSize, false};
+    }
+}
+
+double* FusedCpuContext::target(const Operand& o, const std::size_t offset, double* registers) const {
+    return o.kind == Operand::Kind::Full ? fullData_[o.index] + offset : registers + o.index * blockSize;
+}
+
+void FusedCpuContext::runBlocks(const std::vector<Step>& steps, const std::size_t numberOfRegisters,
+                                const std::size_t n) {
+    const std::size_t nBlocks = (n + blockSize - 1) / blockSize;
+    const std::size_t nThreads =
+        std::min(settings_.numberOfThreads == 0 ? numberOfThreads_ : settings_.numberOfThreads, nBlocks);
+
+    if (registers_.size() < nThreads)
+        registers_.resize(nThreads);
+    for (std::size_t t = 0; t < nThreads; ++t) {
+        if (registers_[t].size() < numberOfRegisters * blockSize)
+            registers_[t].resize(numberOfRegisters * blockSize);
+    }
+
+    std::atomic<std::size_t> nextBlock(0);
+    std::function<void(std::size_t)> worker = [this, &steps, &nextBlock, nBlocks, n](const std::size_t thread) {
+        double* registers = registers_[thread].data();
+        std::vector<Arg> args;
+        for (std::size_t b = nextBlock++; b < nBlocks; b = nextBlock++) {
+            std::size_t offset = b * blockSize;
+            std::size_t len = std::min(blockSize, n - offset);
+            for (auto const& s : steps) {
+                args.clear();
+                for (auto const& a : s.args)
+                    args.push_back(resolve(a, offset, registers));
+                applyElementwise(s.op, target(s.result, offset, registers), args, len);
+            }
+        }
+    };
+
+    pool_.run(nThreads, worker);
+}
+
+void FusedCpuContext::runConditionalExpectation(const Step& step, const std::size_t n) {
+    std::vector<RandomVariable> values;
+    values.reserve(step.args.size());
+    for (auto const& a : step.args) {
+        if (a.kind == Operand::Kind::Scalar)
+            values.push_back(RandomVariable(n, scalars_[a.index]));
+        else
+            values.push_back(RandomVariable(n, fullData_[a.index]));
+    }
+    std::vector<const RandomVariable*> args(values.size());
+    for (std::size_t i = 0; i < values.size(); ++i)
+        args[i] = &values[i];
+    auto ops = getRandomVariableOps(n, settings_.regressionOrder);
+    RandomVariable result = ops[RandomVariableOpCode::ConditionalExpectation](args);
+    double* r = fullData_[step.result.index];
+    for (std::size_t i = 0; i < n; ++i)
+        r[i] = result[i];
+}
+
+void FusedCpuContext::finalizeCalculation(std::vector<double*>& output) {
+    struct exitGuard {
+        exitGuard() {}
+        ~exitGuard() { *currentState = ComputeState::idle; }
+        ComputeState* currentState;
+    } guard;
+
+    guard.currentState = &currentState_;
+
+    QL_REQUIRE(currentId_ > 0, "FusedCpuContext::finalizeCalculation(): current id is not set");
+    QL_REQUIRE(output.size() == outputVars_[currentId_ - 1].size(),
+               "FusedCpuContext::finalizeCalculation(): output size ("
+                   << output.size() << ") inconsistent to kernel output size (" << outputVars_[currentId_ - 1].size()
+                   << ")");
+
+    const std::size_t n = size_[currentId_ - 1];
+    const std::size_t nInput = numberOfInputVars_[currentId_ - 1];
+    const std::size_t nVariates = numberOfVariates_[currentId_ - 1];
+
+    // compile the kernel, unless we can reuse the existing one
+
+    boost::timer::cpu_timer timer;
+
+    auto& kernel = kernel_[currentId_ - 1];
+    bool signatureMatches = kernel.compiled && kernel.inputIsScalar.size() == nInput;
+    for (std::size_t i = 0; signatureMatches && i < nInput; ++i)
+        signatureMatches = kernel.inputIsScalar[i] == inputs_[i].scalar;
+    if (!signatureMatches)
+        compile(currentId_);
+
+    debugInfo_.nanoSecondsProgramBuild += timer.elapsed().wall;
+    timer.start();
+
+    // set up data
+
+    scalars_.resize(kernel.numberOfScalars);
+    fullData_.resize(nInput + nVariates + kernel.numberOfBuffers);
+    for (std::size_t i = 0; i < nInput; ++i) {
+        if (inputs_[i].scalar)
+            scalars_[i] = inputs_[i].value;
+        else
+            fullData_[i] = inputs_[i].data.data();
+    }
+    for (std::size_t i = 0; i < nVariates; ++i) {
+        QL_REQUIRE(variates_[i].size() == n, "FusedCpuContext::finalizeCalculation(): variate size ("
+                                                 << variates_[i].size() << ") does not match calculation size (" << n
+                                                 << ")");
+        fullData_[nInput + i] = variates_[i].data();
+    }
+    if (buffers_.size() < kernel.numberOfBuffers)
+        buffers_.resize(kernel.numberOfBuffers);
+    for (std::size_t i = 0; i < kernel.numberOfBuffers; ++i) {
+        buffers_[i].resize(n);
+        fullData_[nInput + nVariates + i] = buffers_[i].data();
+    }
+
+    debugInfo_.nanoSecondsDataCopy += timer.elapsed().wall;
+    timer.start();
+
+    // execute calculation
+
+    std::vector<Arg> args;
+    for (auto const& s : kernel.scalarSteps) {
+        args.clear();
+        for (auto const& a : s.args)
+            args.push_back(Arg{&scalars_[a.index], true});
+        applyElementwise(s.op, &scalars_[s.result.index], args, 1);
+    }
+
+    for (auto const& s : kernel.segments) {
+        if (!s.steps.empty())
+            runBlocks(s.steps, kernel.numberOfRegisters, n);
+        for (auto const& b : s.barrierSteps)
+            runConditionalExpectation(b, n);
+    }
+
+    debugInfo_.nanoSecondsCalculation += timer.elapsed().wall;
+    timer.start();
+
+    // fill output
+
+    for (std::size_t i = 0; i < kernel.output.size(); ++i) {
+        const auto& o = kernel.output[i];
+        if (o.kind == Operand::Kind::Scalar)
+            std::fill(output[i], output[i] + n, scalars_[o.index]);
+        else
+            std::copy(fullData_[o.index], fullData_[o.index] + n, output[i]);
+    }
+
+    debugInfo_.nanoSecondsDataCopy += timer.elapsed().wall;
+}
+
+std::vector<std::pair<std::string, std::string>> FusedCpuContext::deviceInfo() const {
+    return {{"threads", std::to_string(numberOfThreads_)}, {"block size", std::to_string(blockSize)}};
+}
+
+const ComputeContext::DebugInfo& FusedCpuContext::debugInfo() const { return debugInfo_; }
+
+std::set<std::string> FusedCpuFramework::getAvailableDevices() const { return {"FusedCpu/Default/Default"}; }
+
+ComputeContext* FusedCpuFramework::getContext(const std::string& deviceName) {
+    QL_REQUIRE(deviceName == "FusedCpu/Default/Default",
+               "FusedCpuFramework::getContext(): device '"
+                   << deviceName << "' not supported. Available device is 'FusedCpu/Default/Default'.");
+    return contexts_[deviceName];
+}
+
+} // namespace QuantExt
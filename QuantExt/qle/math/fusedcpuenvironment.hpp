@@ -0,0 +1,48 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file qle/math/fusedcpuenvironment.hpp
+    \brief compute env implementation using the cpu with fused, block-wise kernels
+*/
+
+#pragma once
+
+#include <qle/math/computeenvironment.hpp>
+
+#include <map>
+
+namespace QuantExt {
+
+/*! The fused cpu framework compiles the recorded operations of a calculation into a kernel that is executed on blocks
+    of samples. All elementwise operations between two conditional expectations are applied to one block before the
+    next block is processed, intermediate results are held in a small, reused register file per thread and only
+    values needed across conditional expectations or as outputs are stored over the full sample dimension. The blocks
+    are distributed over the available hardware threads, which are kept in a pool over the calculations. The
+    elementwise results are identical to those of the basic cpu framework. */
+class FusedCpuFramework : public ComputeFramework {
+public:
+    FusedCpuFramework();
+    ~FusedCpuFramework() override final;
+    std::set<std::string> getAvailableDevices() const override final;
+    ComputeContext* getContext(const std::string& deviceName) override final;
+
+private:
+    std::map<std::string, ComputeContext*> contexts_;
+};
+
+} // namespace QuantExt
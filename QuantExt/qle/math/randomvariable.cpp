@@ -18,6 +18,7 @@
 
 #include <qle/math/randomvariable.hpp>
 #include <qle/math/randomvariablelsmbasissystem.hpp>
+#include <qle/math/workerpool.hpp>
 
 #include <ql/experimental/math/moorepenroseinverse.hpp>
 #include <ql/math/comparison.hpp>
@@ -34,6 +35,9 @@
 #include <boost/accumulators/statistics/variance.hpp>
 #include <boost/accumulators/statistics/variates/covariate.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <bitset>
 #include <iostream>
 #include <map>
 
@@ -70,15 +74,111 @@ inline void stopCalcStats(const std::size_t n) {
     }
 }
 
+inline void countBufferAllocation(const bool fromPool) {
+    if (RandomVariableStats::instance().enabled) {
+        if (fromPool)
+            ++RandomVariableStats::instance().buffer_reuses;
+        else
+            ++RandomVariableStats::instance().buffer_allocations;
+    }
+}
+
 #else
 
 inline void resumeDataStats() {}
 inline void stopDataStats(const std::size_t n) {}
 inline void resumeCalcStats() {}
 inline void stopCalcStats(const std::size_t n) {}
+inline void countBufferAllocation(const bool fromPool) {}
 
 #endif
 
+/* Thread local pool of data buffers for random variables and filters. Released buffers are kept in bins by their
+   size and handed out again on the next allocation of the same size. Since the variables of a calculation usually all
+   share the number of paths, this avoids most of the heap allocations for temporaries. Each pool holds at most
+   maxPooledBytes, buffers released beyond that (or after the pool of the thread was destroyed) are freed. */
+template <class T> class BufferPool {
+public:
+    static T* allocate(const Size n) {
+        if (!destroyed()) {
+            auto& bins = instance().bins_;
+            for (auto& [size, buffers] : bins) {
+                if (size == n && !buffers.empty()) {
+                    T* p = buffers.back();
+                    buffers.pop_back();
+                    instance().pooledBytes_ -= n * sizeof(T);
+                    countBufferAllocation(true);
+                    return p;
+                }
+            }
+        }
+        countBufferAllocation(false);
+        return new T[n];
+    }
+
+    static void release(T* p, const Size n) {
+        if (destroyed() || instance().pooledBytes_ + n * sizeof(T) > maxPooledBytes) {
+            delete[] p;
+            return;
+        }
+        auto& pool = instance();
+        auto bin = std::find_if(pool.bins_.begin(), pool.bins_.end(),
+                                [n](const std::pair<Size, std::vector<T*>>& b) { return b.first == n; });
+        if (bin == pool.bins_.end())
+            bin = pool.bins_.insert(pool.bins_.end(), std::make_pair(n, std::vector<T*>()));
+        bin->second.push_back(p);
+        pool.pooledBytes_ += n * sizeof(T);
+    }
+
+private:
+    static constexpr Size maxPooledBytes = 64 * 1024 * 1024;
+
+    ~BufferPool() {
+        destroyed() = true;
+        for (auto& [_, buffers] : bins_)
+            for (auto p : buffers)
+                delete[] p;
+    }
+
+    static BufferPool& instance() {
+        thread_local BufferPool pool;
+        return pool;
+    }
+
+    // true once the thread local pool is destroyed, buffers released after that (by static or thread local random
+    // variables destroyed later) are freed directly
+    static bool& destroyed() {
+        thread_local bool flag = false;
+        return flag;
+    }
+
+    std::vector<std::pair<Size, std::vector<T*>>> bins_;
+    Size pooledBytes_ = 0;
+};
+
+// number of words holding the values of a filter of size n
+inline Size filterWords(const Size n) { return (n + 63) / 64; }
+
+// mask of the bits of the last word holding values of a filter of size n
+inline std::uint64_t lastWordMask(const Size n) {
+    return n % 64 == 0 ? ~std::uint64_t(0) : (std::uint64_t(1) << (n % 64)) - 1;
+}
+
+// filter with values predicate(i), the words are assembled directly instead of setting single values
+template <class P> Filter filterFromPredicate(const Size n, const P& predicate) {
+    Filter result(n, false);
+    result.expand();
+    std::uint64_t* w = result.data();
+    for (Size k = 0, i = 0; k < filterWords(n); ++k) {
+        std::uint64_t word = 0;
+        for (Size b = 0, end = std::min(i + 64, n); i < end; ++i, ++b)
+            word |= static_cast<std::uint64_t>(predicate(i)) << b;
+        w[k] = word;
+    }
+    result.updateDeterministic();
+    return result;
+}
+
 double getDelta(const RandomVariable& x, const Real eps) {
     Real sum = 0.0;
     for (Size i = 0; i < x.size(); ++i) {
@@ -98,10 +198,9 @@ Filter::Filter(const Filter& r) {
     constantData_ = r.constantData_;
     if (r.data_) {
         resumeDataStats();
-        data_ = new bool[n_];
-        // std::memcpy(data_, r.data_, n_ * sizeof(bool));
-        std::copy(r.data_, r.data_ + n_, data_);
-        stopDataStats(n_);
+        data_ = BufferPool<std::uint64_t>::allocate(filterWords(n_));
+        std::copy(r.data_, r.data_ + filterWords(n_), data_);
+        stopDataStats(filterWords(n_));
     } else {
         data_ = nullptr;
     }
@@ -120,24 +219,23 @@ Filter& Filter::operator=(const Filter& r) {
     if (r.deterministic_) {
         deterministic_ = true;
         if (data_) {
-            delete[] data_;
+            BufferPool<std::uint64_t>::release(data_, filterWords(n_));
             data_ = nullptr;
         }
     } else {
         deterministic_ = false;
         if (r.n_ != 0) {
             resumeDataStats();
-            if (n_ != r.n_) {
+            if (filterWords(n_) != filterWords(r.n_) || !data_) {
                 if (data_)
-                    delete[] data_;
-                data_ = new bool[r.n_];
+                    BufferPool<std::uint64_t>::release(data_, filterWords(n_));
+                data_ = BufferPool<std::uint64_t>::allocate(filterWords(r.n_));
             }
-            // std::memcpy(data_, r.data_, r.n_ * sizeof(bool));
-            std::copy(r.data_, r.data_ + r.n_, data_);
-            stopDataStats(r.n_);
+            std::copy(r.data_, r.data_ + filterWords(r.n_), data_);
+            stopDataStats(filterWords(r.n_));
         } else {
             if (data_) {
-                delete[] data_;
+                BufferPool<std::uint64_t>::release(data_, filterWords(n_));
                 data_ = nullptr;
             }
         }
@@ -148,11 +246,11 @@ Filter& Filter::operator=(const Filter& r) {
 }
 
 Filter& Filter::operator=(Filter&& r) {
-    n_ = r.n_;
-    constantData_ = r.constantData_;
     if (data_) {
-        delete[] data_;
+        BufferPool<std::uint64_t>::release(data_, filterWords(n_));
     }
+    n_ = r.n_;
+    constantData_ = r.constantData_;
     data_ = r.data_;
     r.data_ = nullptr;
     deterministic_ = r.deterministic_;
@@ -162,12 +260,12 @@ Filter& Filter::operator=(Filter&& r) {
 Filter::Filter(const Size n, const bool value) : n_(n), constantData_(value), data_(nullptr), deterministic_(n != 0) {}
 
 void Filter::clear() {
-    n_ = 0;
-    constantData_ = false;
     if (data_) {
-        delete[] data_;
+        BufferPool<std::uint64_t>::release(data_, filterWords(n_));
         data_ = nullptr;
     }
+    n_ = 0;
+    constantData_ = false;
     deterministic_ = false;
 }
 
@@ -175,20 +273,23 @@ void Filter::updateDeterministic() {
     if (deterministic_ || !initialised())
         return;
     resumeCalcStats();
-    for (Size i = 0; i < n_; ++i) {
-        if (data_[i] != constantData_) {
+    // the filter is deterministic if either no or all bits are set, stop at the first word showing both values
+    Size count = 0;
+    for (Size i = 0; i < filterWords(n_); ++i) {
+        count += std::bitset<64>(data_[i]).count();
+        if (count != 0 && count != std::min((i + 1) * 64, n_)) {
             stopCalcStats(i);
             return;
         }
     }
-    setAll(constantData_);
-    stopCalcStats(n_);
+    setAll(count != 0);
+    stopCalcStats(filterWords(n_));
 }
 
 void Filter::setAll(const bool v) {
     QL_REQUIRE(n_ > 0, "Filter::setAll(): dimension is zero");
     if (data_) {
-        delete[] data_;
+        BufferPool<std::uint64_t>::release(data_, filterWords(n_));
         data_ = nullptr;
     }
     constantData_ = v;
@@ -205,9 +306,11 @@ void Filter::expand() {
         return;
     deterministic_ = false;
     resumeDataStats();
-    data_ = new bool[n_];
-    std::fill(data_, data_ + n_, constantData_);
-    stopDataStats(n_);
+    data_ = BufferPool<std::uint64_t>::allocate(filterWords(n_));
+    std::fill(data_, data_ + filterWords(n_), constantData_ ? ~std::uint64_t(0) : 0);
+    if (n_ > 0)
+        data_[filterWords(n_) - 1] &= lastWordMask(n_);
+    stopDataStats(filterWords(n_));
 }
 
 bool operator==(const Filter& a, const Filter& b) {
@@ -217,12 +320,12 @@ bool operator==(const Filter& a, const Filter& b) {
         return a.constantData_ == b.constantData_;
     } else {
         resumeCalcStats();
-        for (Size j = 0; j < a.size(); ++j)
-            if (a[j] != b[j]) {
+        for (Size j = 0; j < filterWords(a.size()); ++j)
+            if (a.word(j) != b.word(j)) {
                 stopCalcStats(j);
                 return false;
             }
-        stopCalcStats(a.size());
+        stopCalcStats(filterWords(a.size()));
     }
     return true;
 }
@@ -244,10 +347,10 @@ Filter operator&&(Filter x, const Filter& y) {
         x.constantData_ = x.constantData_ && y.constantData_;
     } else {
         resumeCalcStats();
-        for (Size i = 0; i < x.size(); ++i) {
-            x.data_[i] = x.data_[i] && y[i];
+        for (Size i = 0; i < filterWords(x.size()); ++i) {
+            x.data_[i] &= y.word(i);
         }
-        stopCalcStats(x.size());
+        stopCalcStats(filterWords(x.size()));
     }
     return x;
 }
@@ -267,10 +370,10 @@ Filter operator||(Filter x, const Filter& y) {
         x.constantData_ = x.constantData_ || y.constantData_;
     } else {
         resumeCalcStats();
-        for (Size i = 0; i < x.size(); ++i) {
-            x.data_[i] = x.data_[i] || y[i];
+        for (Size i = 0; i < filterWords(x.size()); ++i) {
+            x.data_[i] |= y.word(i);
         }
-        stopCalcStats(x.size());
+        stopCalcStats(filterWords(x.size()));
     }
     return x;
 }
@@ -286,10 +389,11 @@ Filter equal(Filter x, const Filter& y) {
         x.constantData_ = x.constantData_ == y.constantData_;
     } else {
         resumeCalcStats();
-        for (Size i = 0; i < x.size(); ++i) {
-            x.data_[i] = x.data_[i] == y[i];
+        for (Size i = 0; i < filterWords(x.size()); ++i) {
+            x.data_[i] = ~(x.data_[i] ^ y.word(i));
         }
-        stopCalcStats(x.size());
+        x.data_[filterWords(x.size()) - 1] &= lastWordMask(x.size());
+        stopCalcStats(filterWords(x.size()));
     }
     return x;
 }
@@ -297,12 +401,13 @@ Filter equal(Filter x, const Filter& y) {
 Filter operator!(Filter x) {
     if (x.deterministic_)
         x.constantData_ = !x.constantData_;
-    else {
+    else if (x.initialised()) {
         resumeCalcStats();
-        for (Size i = 0; i < x.size(); ++i) {
-            x.data_[i] = !x.data_[i];
+        for (Size i = 0; i < filterWords(x.size()); ++i) {
+            x.data_[i] = ~x.data_[i];
         }
-        stopCalcStats(x.size());
+        x.data_[filterWords(x.size()) - 1] &= lastWordMask(x.size());
+        stopCalcStats(filterWords(x.size()));
     }
     return x;
 }
@@ -317,7 +422,7 @@ RandomVariable::RandomVariable(const RandomVariable& r) {
     constantData_ = r.constantData_;
     if (r.data_) {
         resumeDataStats();
-        data_ = new double[n_];
+        data_ = BufferPool<double>::allocate(n_);
         // std::memcpy(data_, r.data_, n_ * sizeof(double));
         std::copy(r.data_, r.data_ + n_, data_);
         stopDataStats(n_);
@@ -341,24 +446,24 @@ RandomVariable& RandomVariable::operator=(const RandomVariable& r) {
     if (r.deterministic_) {
         deterministic_ = true;
         if (data_) {
-            delete[] data_;
+            BufferPool<double>::release(data_, n_);
             data_ = nullptr;
         }
     } else {
         deterministic_ = false;
         if (r.n_ != 0) {
             resumeDataStats();
-            if (n_ != r.n_) {
+            if (n_ != r.n_ || !data_) {
                 if (data_)
-                    delete[] data_;
-                data_ = new double[r.n_];
+                    BufferPool<double>::release(data_, n_);
+                data_ = BufferPool<double>::allocate(r.n_);
             }
             // std::memcpy(data_, r.data_, r.n_ * sizeof(double));
             std::copy(r.data_, r.data_ + r.n_, data_);
             stopDataStats(r.n_);
         } else {
             if (data_) {
-                delete[] data_;
+                BufferPool<double>::release(data_, n_);
                 data_ = nullptr;
             }
         }
@@ -370,11 +475,11 @@ RandomVariable& RandomVariable::operator=(const RandomVariable& r) {
 }
 
 RandomVariable& RandomVariable::operator=(RandomVariable&& r) {
-    n_ = r.n_;
-    constantData_ = r.constantData_;
     if (data_) {
-        delete[] data_;
+        BufferPool<double>::release(data_, n_);
     }
+    n_ = r.n_;
+    constantData_ = r.constantData_;
     data_ = r.data_;
     r.data_ = nullptr;
     deterministic_ = r.deterministic_;
@@ -399,9 +504,10 @@ RandomVariable::RandomVariable(const Filter& f, const Real valueTrue, const Real
         resumeDataStats();
         constantData_ = 0.0;
         deterministic_ = false;
-        data_ = new double[n_];
+        data_ = BufferPool<double>::allocate(n_);
+        const std::uint64_t* w = f.data();
         for (Size i = 0; i < n_; ++i)
-            set(i, f[i] ? valueTrue : valueFalse);
+            data_[i] = (w[i / 64] >> (i % 64)) & 1 ? valueTrue : valueFalse;
         stopDataStats(n_);
     }
     time_ = time;
@@ -413,7 +519,7 @@ RandomVariable::RandomVariable(const Size n, const Real* const data, const Real
     time_ = time;
     if (n_ != 0) {
         resumeDataStats();
-        data_ = new double[n_];
+        data_ = BufferPool<double>::allocate(n_);
         // std::memcpy(data_, array.begin(), n_ * sizeof(double));
         std::copy(data, data + n_, data_);
         stopDataStats(n_);
@@ -451,12 +557,12 @@ void RandomVariable::copyToArray(QuantLib::Array& array) const {
 }
 
 void RandomVariable::clear() {
-    n_ = 0;
-    constantData_ = 0.0;
     if (data_) {
-        delete[] data_;
+        BufferPool<double>::release(data_, n_);
         data_ = nullptr;
     }
+    n_ = 0;
+    constantData_ = 0.0;
     deterministic_ = false;
     time_ = Null<Real>();
 }
@@ -478,7 +584,7 @@ void RandomVariable::updateDeterministic() {
 void RandomVariable::setAll(const Real v) {
     QL_REQUIRE(n_ > 0, "RandomVariable::setAll(): dimension is zero");
     if (data_) {
-        delete[] data_;
+        BufferPool<double>::release(data_, n_);
         data_ = nullptr;
     }
     constantData_ = v;
@@ -495,7 +601,7 @@ void RandomVariable::expand() {
         return;
     deterministic_ = false;
     resumeDataStats();
-    data_ = new double[n_];
+    data_ = BufferPool<double>::allocate(n_);
     std::fill(data_, data_ + n_, constantData_);
     stopDataStats(n_);
 }
@@ -845,10 +951,8 @@ Filter close_enough(const RandomVariable& x, const RandomVariable& y) {
         return Filter(x.size(), QuantLib::close_enough(x.constantData_, y.constantData_));
     }
     resumeCalcStats();
-    Filter result(x.size(), false);
-    for (Size i = 0; i < x.size(); ++i) {
-        result.set(i, QuantLib::close_enough(x[i], y[i]));
-    }
+    Filter result =
+        filterFromPredicate(x.size(), [&x, &y](const Size i) { return QuantLib::close_enough(x[i], y[i]); });
     stopCalcStats(x.size());
     return result;
 }
@@ -881,9 +985,26 @@ RandomVariable conditionalResult(const Filter& f, RandomVariable x, const Random
         return f.at(0) ? x : y;
     resumeCalcStats();
     x.expand();
-    for (Size i = 0; i < f.size(); ++i) {
-        if (!f[i])
-            x.set(i, y[i]);
+    // blocks of 64 paths with a constant filter value are skipped resp. copied, otherwise the values are blended
+    const std::uint64_t* w = f.data();
+    for (Size k = 0; k < filterWords(f.size()); ++k) {
+        Size begin = k * 64, end = std::min(begin + 64, f.size());
+        if (w[k] == lastWordMask(end - begin))
+            continue;
+        if (w[k] == 0) {
+            if (y.deterministic_)
+                std::fill(x.data_ + begin, x.data_ + end, y.constantData_);
+            else
+                std::copy(y.data_ + begin, y.data_ + end, x.data_ + begin);
+            continue;
+        }
+        if (y.deterministic_) {
+            for (Size i = begin; i < end; ++i)
+                x.data_[i] = (w[k] >> (i - begin)) & 1 ? x.data_[i] : y.constantData_;
+        } else {
+            for (Size i = begin; i < end; ++i)
+                x.data_[i] = (w[k] >> (i - begin)) & 1 ? x.data_[i] : y.data_[i];
+        }
     }
     stopCalcStats(f.size());
     return x;
@@ -996,10 +1117,8 @@ Filter operator<(const RandomVariable& x, const RandomVariable& y) {
                       x.constantData_ < y.constantData_ && !QuantLib::close_enough(x.constantData_, y.constantData_));
     }
     resumeCalcStats();
-    Filter result(x.size(), false);
-    for (Size i = 0; i < x.size(); ++i) {
-        result.set(i, x[i] < y[i] && !QuantLib::close_enough(x[i], y[i]));
-    }
+    Filter result = filterFromPredicate(
+        x.size(), [&x, &y](const Size i) { return x[i] < y[i] && !QuantLib::close_enough(x[i], y[i]); });
     stopCalcStats(x.size());
     return result;
 }
@@ -1015,10 +1134,8 @@ Filter operator<=(const RandomVariable& x, const RandomVariable& y) {
                       x.constantData_ < y.constantData_ || QuantLib::close_enough(x.constantData_, y.constantData_));
     }
     resumeCalcStats();
-    Filter result(x.size(), false);
-    for (Size i = 0; i < x.size(); ++i) {
-        result.set(i, x[i] < y[i] || QuantLib::close_enough(x[i], y[i]));
-    }
+    Filter result = filterFromPredicate(
+        x.size(), [&x, &y](const Size i) { return x[i] < y[i] || QuantLib::close_enough(x[i], y[i]); });
     stopCalcStats(x.size());
     return result;
 }
@@ -1033,10 +1150,10 @@ Filter operator>(const RandomVariable& x, const RandomVariable& y) {
         return Filter(x.size(),
                       x.constantData_ > y.constantData_ && !QuantLib::close_enough(x.constantData_, y.constantData_));
     }
-    Filter result(x.size(), false);
-    for (Size i = 0; i < x.size(); ++i) {
-        result.set(i, x[i] > y[i] && !QuantLib::close_enough(x[i], y[i]));
-    }
+    resumeCalcStats();
+    Filter result = filterFromPredicate(
+        x.size(), [&x, &y](const Size i) { return x[i] > y[i] && !QuantLib::close_enough(x[i], y[i]); });
+    stopCalcStats(x.size());
     return result;
 }
 
@@ -1051,10 +1168,8 @@ Filter operator>=(const RandomVariable& x, const RandomVariable& y) {
                       x.constantData_ > y.constantData_ || QuantLib::close_enough(x.constantData_, y.constantData_));
     }
     resumeCalcStats();
-    Filter result(x.size(), false);
-    for (Size i = 0; i < x.size(); ++i) {
-        result.set(i, x[i] > y[i] || QuantLib::close_enough(x[i], y[i]));
-    }
+    Filter result = filterFromPredicate(
+        x.size(), [&x, &y](const Size i) { return x[i] > y[i] || QuantLib::close_enough(x[i], y[i]); });
     stopCalcStats(x.size());
     return result;
 }
@@ -1076,10 +1191,10 @@ RandomVariable applyFilter(RandomVariable x, const Filter& f) {
     if (x.deterministic_ && QuantLib::close_enough(x.constantData_, 0.0))
         return x;
     resumeCalcStats();
-    for (Size i = 0; i < x.size(); ++i) {
-        if (!f[i])
-            x.set(i, 0.0);
-    }
+    x.expand();
+    const std::uint64_t* w = f.data();
+    for (Size i = 0; i < x.size(); ++i)
+        x.data_[i] = (w[i / 64] >> (i % 64)) & 1 ? x.data_[i] : 0.0;
     stopCalcStats(x.size());
     return x;
 }
@@ -1101,10 +1216,10 @@ RandomVariable applyInverseFilter(RandomVariable x, const Filter& f) {
     if (x.deterministic_ && QuantLib::close_enough(x.constantData_, 0.0))
         return x;
     resumeCalcStats();
-    for (Size i = 0; i < x.size(); ++i) {
-        if (f[i])
-            x.set(i, 0.0);
-    }
+    x.expand();
+    const std::uint64_t* w = f.data();
+    for (Size i = 0; i < x.size(); ++i)
+        x.data_[i] = (w[i / 64] >> (i % 64)) & 1 ? 0.0 : x.data_[i];
     stopCalcStats(x.size());
     return x;
 }
@@ -1160,10 +1275,181 @@ std::vector<const RandomVariable*> vec2vecptr(const std::vector<RandomVariable>&
     return result;
 }
 
+namespace {
+
+// number of samples per block in the normal equations regression
+constexpr Size normalEquationsBlockSize = 1024;
+
+// max number of partial sums in the normal equations regression, independent of the number of threads, so that the
+// result does not depend on the number of threads
+constexpr Size normalEquationsMaxChunks = 64;
+
+// the cholesky decomposition of the scaled gram matrix fails if a pivot is below this threshold
+constexpr Real normalEquationsPivotThreshold = 1E-10;
+
+/* add the gram matrix (lower triangle, row major) and the rhs of the normal equations for the samples in
+   [offset, offset + len) to the given sums, samples outside the filter do not contribute */
+void addNormalEquations(
+    const RandomVariable& r, const std::vector<const RandomVariable*>& regressor,
+    const std::vector<std::function<RandomVariable(const std::vector<const RandomVariable*>&)>>& basisFn,
+    const Filter& filter, const Size offset, const Size len, Real* gram, Real* rhs) {
+    const Size m = basisFn.size();
+    std::vector<RandomVariable> reg(regressor.size());
+    for (Size j = 0; j < regressor.size(); ++j) {
+        if (regressor[j]->deterministic())
+            reg[j] = RandomVariable(len, (*regressor[j])[0]);
+        else
+            reg[j] = RandomVariable(len, regressor[j]->data() + offset);
+    }
+    std::vector<const RandomVariable*> regPtr = vec2vecptr(reg);
+    std::vector<Real> mask(len, 1.0);
+    if (filter.initialised()) {
+        for (Size i = 0; i < len; ++i)
+            mask[i] = filter[offset + i] ? 1.0 : 0.0;
+    }
+    std::vector<Real> b(len), a(m * len);
+    for (Size i = 0; i < len; ++i)
+        b[i] = r[offset + i] * mask[i];
+    for (Size k = 0; k < m; ++k) {
+        RandomVariable v = basisFn[k](regPtr);
+        Real* col = &a[k * len];
+        for (Size i = 0; i < len; ++i)
+            col[i] = v[i] * mask[i];
+    }
+    for (Size k = 0; k < m; ++k) {
+        const Real* ak = &a[k * len];
+        for (Size l = 0; l <= k; ++l) {
+            const Real* al = &a[l * len];
+            Real sum = 0.0;
+            for (Size i = 0; i < len; ++i)
+                sum += ak[i] * al[i];
+            gram[k * m + l] += sum;
+        }
+        Real sum = 0.0;
+        for (Size i = 0; i < len; ++i)
+            sum += ak[i] * b[i];
+        rhs[k] += sum;
+    }
+}
+
+/* solve the normal equations, the samples are processed in blocks, the blocks are split into chunks of at least four
+   blocks that are run on up to maxThreads threads of the shared worker pool, returns false if the gram matrix is close
+   to singular */
+bool normalEquationsRegressionCoefficients(
+    const RandomVariable& r, const std::vector<const RandomVariable*>& regressor,
+    const std::vector<std::function<RandomVariable(const std::vector<const RandomVariable*>&)>>& basisFn,
+    const Filter& filter, const Size maxThreads, Array& result) {
+
+    const Size n = r.size();
+    const Size m = basisFn.size();
+    const Size numberOfBlocks = (n + normalEquationsBlockSize - 1) / normalEquationsBlockSize;
+    const Size numberOfChunks = std::min(normalEquationsMaxChunks, (numberOfBlocks + 3) / 4);
+    const Size numberOfThreads = std::max<Size>(1, std::min<Size>(numberOfChunks, maxThreads));
+
+    // partial sums per chunk, the chunk c covers the blocks [c * numberOfBlocks / numberOfChunks, ...)
+
+    std::vector<Real> gram(numberOfChunks * m * m, 0.0), rhs(numberOfChunks * m, 0.0);
+    auto runChunk = [&](const Size c) {
+        for (Size blk = c * numberOfBlocks / numberOfChunks; blk < (c + 1) * numberOfBlocks / numberOfChunks; ++blk) {
+            Size offset = blk * normalEquationsBlockSize;
+            addNormalEquations(r, regressor, basisFn, filter, offset, std::min(normalEquationsBlockSize, n - offset),
+                               &gram[c * m * m], &rhs[c * m]);
+        }
+    };
+
+    if (numberOfThreads == 1) {
+        for (Size c = 0; c < numberOfChunks; ++c)
+            runChunk(c);
+    } else {
+        std::atomic<Size> nextChunk(0);
+        WorkerPool::instance().run(numberOfThreads, [&runChunk, &nextChunk, numberOfChunks](const Size) {
+            try {
+                for (Size c = nextChunk++; c < numberOfChunks; c = nextChunk++)
+                    runChunk(c);
+            } catch (...) {
+                nextChunk = numberOfChunks;
+                throw;
+            }
+        });
+    }
+
+    // sum up the chunks in a fixed order
+
+    Matrix G(m, m, 0.0);
+    Array c(m, 0.0);
+    for (Size ch = 0; ch < numberOfChunks; ++ch) {
+        for (Size k = 0; k < m; ++k) {
+            for (Size l = 0; l <= k; ++l)
+                G[k][l] += gram[ch * m * m + k * m + l];
+            c[k] += rhs[ch * m + k];
+        }
+    }
+
+    /* scale the gram matrix to unit diagonal, basis functions that are zero on all (filtered) samples are removed,
+       their coefficient is zero as in the minimum norm solution */
+
+    Array scale(m, 0.0);
+    for (Size k = 0; k < m; ++k)
+        scale[k] = G[k][k] > 0.0 ? 1.0 / std::sqrt(G[k][k]) : 0.0;
+    for (Size k = 0; k < m; ++k) {
+        for (Size l = 0; l <= k; ++l)
+            G[k][l] *= scale[k] * scale[l];
+        c[k] *= scale[k];
+    }
+
+    // cholesky decomposition G = L L^T, L is stored in the lower triangle of G
+
+    for (Size k = 0; k < m; ++k) {
+        if (scale[k] == 0.0)
+            continue;
+        for (Size l = 0; l <= k; ++l) {
+            if (scale[l] == 0.0)
+                continue;
+            Real sum = G[k][l];
+            for (Size j = 0; j < l; ++j)
+                sum -= G[k][j] * G[l][j];
+            if (l == k) {
+                if (sum < normalEquationsPivotThreshold)
+                    return false;
+                G[k][k] = std::sqrt(sum);
+            } else {
+                G[k][l] = sum / G[l][l];
+            }
+        }
+    }
+
+    // solve L y = c and L^T x = y, undo the scaling
+
+    result = Array(m, 0.0);
+    for (Size k = 0; k < m; ++k) {
+        if (scale[k] == 0.0)
+            continue;
+        Real sum = c[k];
+        for (Size j = 0; j < k; ++j)
+            sum -= G[k][j] * result[j];
+        result[k] = sum / G[k][k];
+    }
+    for (Size k = m; k > 0; --k) {
+        if (scale[k - 1] == 0.0)
+            continue;
+        Real sum = result[k - 1];
+        for (Size j = k; j < m; ++j)
+            sum -= G[j][k - 1] * result[j];
+        result[k - 1] = sum / G[k - 1][k - 1];
+    }
+    for (Size k = 0; k < m; ++k)
+        result[k] *= scale[k];
+
+    return true;
+}
+
+} // namespace
+
 Array regressionCoefficients(
     RandomVariable r, std::vector<const RandomVariable*> regressor,
     const std::vector<std::function<RandomVariable(const std::vector<const RandomVariable*>&)>>& basisFn,
-    const Filter& filter, const RandomVariableRegressionMethod regressionMethod, const std::string& debugLabel) {
+    const Filter& filter, const RandomVariableRegressionMethod regressionMethod, const std::string& debugLabel,
+    const Size regressionThreads) {
 
     for (auto const reg : regressor) {
         QL_REQUIRE(reg->size() == r.size(),
@@ -1179,6 +1465,27 @@ Array regressionCoefficients(
 
     resumeCalcStats();
 
+    if (!debugLabel.empty()) {
+        for (Size i = 0; i < r.size(); ++i) {
+            std::cout << debugLabel << "," << r[i] << ",";
+            for (Size j = 0; j < regressor.size(); ++j) {
+                std::cout << regressor[j]->operator[](i) << (j == regressor.size() - 1 ? "\n" : ",");
+            }
+        }
+        std::cout << std::flush;
+    }
+
+    Array res;
+    RandomVariableRegressionMethod method = regressionMethod;
+    if (method == RandomVariableRegressionMethod::NormalEquations) {
+        if (normalEquationsRegressionCoefficients(r, regressor, basisFn, filter, regressionThreads, res)) {
+            stopCalcStats(r.size() * basisFn.size() * basisFn.size());
+            return res;
+        }
+        // the gram matrix is close to singular, fall back to svd
+        method = RandomVariableRegressionMethod::SVD;
+    }
+
     Matrix A(r.size(), basisFn.size());
     for (Size j = 0; j < basisFn.size(); ++j) {
         RandomVariable a = basisFn[j](regressor);
@@ -1191,16 +1498,6 @@ Array regressionCoefficients(
             a.copyToMatrixCol(A, j);
     }
 
-    if (!debugLabel.empty()) {
-        for (Size i = 0; i < r.size(); ++i) {
-            std::cout << debugLabel << "," << r[i] << ",";
-            for (Size j = 0; j < regressor.size(); ++j) {
-                std::cout << regressor[j]->operator[](i) << (j == regressor.size() - 1 ? "\n" : ",");
-            }
-        }
-        std::cout << std::flush;
-    }
-
     if (filter.size() > 0) {
         r = applyFilter(r, filter);
     }
@@ -1211,8 +1508,7 @@ Array regressionCoefficients(
     else
         r.copyToArray(b);
 
-    Array res;
-    if (regressionMethod == RandomVariableRegressionMethod::SVD) {
+    if (method == RandomVariableRegressionMethod::SVD) {
         SVD svd(A);
         const Matrix& V = svd.V();
         const Matrix& U = svd.U();
@@ -1227,10 +1523,10 @@ Array regressionCoefficients(
                 }
             }
         }
-    } else if (regressionMethod == RandomVariableRegressionMethod::QR) {
+    } else if (method == RandomVariableRegressionMethod::QR) {
         res = qrSolve(A, b);
     } else {
-        QL_FAIL("regressionCoefficients(): unknown regression method, expected SVD or QR");
+        QL_FAIL("regressionCoefficients(): unknown regression method, expected SVD, QR or NormalEquations");
     }
 
     // rough estimate, SVD is O(mn min(m,n))
@@ -1261,10 +1557,11 @@ RandomVariable conditionalExpectation(
 RandomVariable conditionalExpectation(
     const RandomVariable& r, const std::vector<const RandomVariable*>& regressor,
     const std::vector<std::function<RandomVariable(const std::vector<const RandomVariable*>&)>>& basisFn,
-    const Filter& filter, const RandomVariableRegressionMethod regressionMethod) {
+    const Filter& filter, const RandomVariableRegressionMethod regressionMethod, const Size regressionThreads) {
     if (r.deterministic())
         return r;
-    auto coeff = regressionCoefficients(r, regressor, basisFn, filter, regressionMethod);
+    auto coeff =
+        regressionCoefficients(r, regressor, basisFn, filter, regressionMethod, std::string(), regressionThreads);
     return conditionalExpectation(regressor, basisFn, coeff);
 }
 
@@ -29,6 +29,7 @@
 #include <ql/functional.hpp>
 #include <boost/timer/timer.hpp>
 
+#include <cstdint>
 #include <initializer_list>
 #include <vector>
 
@@ -50,6 +51,8 @@ struct RandomVariableStats : public QuantLib::Singleton<RandomVariableStats> {
       enabled = false;
       data_ops = 0;
       calc_ops = 0;
+      buffer_allocations = 0;
+      buffer_reuses = 0;
       data_timer.stop();
       calc_timer.stop();
     }
@@ -57,6 +60,9 @@ struct RandomVariableStats : public QuantLib::Singleton<RandomVariableStats> {
     bool enabled = false;
     std::size_t data_ops = 0;
     std::size_t calc_ops = 0;
+    // number of data buffers allocated on the heap resp. taken from the thread local buffer pool
+    std::size_t buffer_allocations = 0;
+    std::size_t buffer_reuses = 0;
     boost::timer::cpu_timer data_timer;
     boost::timer::cpu_timer calc_timer;
 };
@@ -98,14 +104,19 @@ struct Filter {
     // expand vector to full size and set deterministic to false
     void expand();
 
-    // pointer to raw data, this is null for deterministic variables
-    bool* data();
+    /* pointer to raw data, this is null for deterministic variables; the values are stored as a bitset, value i is
+       bit i % 64 of word i / 64, the unused bits of the last word are always zero */
+    std::uint64_t* data();
+    const std::uint64_t* data() const;
 
 private:
+    // word i of the bitset, also for deterministic filters
+    std::uint64_t word(const Size i) const;
+
     // for invariants see the corresponding section below in class RandomVariable
     Size n_;
     bool constantData_;
-    bool* data_;
+    std::uint64_t* data_;
     bool deterministic_;
 };
 
@@ -119,14 +130,17 @@ inline void Filter::set(const Size i, const bool v) {
         else
             return;
     }
-    data_[i] = v;
+    if (v)
+        data_[i / 64] |= std::uint64_t(1) << (i % 64);
+    else
+        data_[i / 64] &= ~(std::uint64_t(1) << (i % 64));
 }
 
 inline bool Filter::operator[](const Size i) const {
     if (deterministic_)
         return constantData_;
     else
-        return data_[i];
+        return (data_[i / 64] >> (i % 64)) & 1;
 }
 
 inline bool Filter::at(const Size i) const {
@@ -137,7 +151,17 @@ inline bool Filter::at(const Size i) const {
     return operator[](i);
 }
 
-inline bool* Filter::data() { return data_; }
+inline std::uint64_t* Filter::data() { return data_; }
+
+inline const std::uint64_t* Filter::data() const { return data_; }
+
+inline std::uint64_t Filter::word(const Size i) const {
+    if (!deterministic_)
+        return data_[i];
+    if (!constantData_)
+        return 0;
+    return (i + 1) * 64 <= n_ ? ~std::uint64_t(0) : (std::uint64_t(1) << (n_ % 64)) - 1;
+}
 
 bool operator==(const Filter& a, const Filter& b);
 bool operator!=(const Filter& a, const Filter& b);
@@ -223,6 +247,7 @@ struct RandomVariable {
     void expand();
     // pointer to raw data, this is null for deterministic variables
     double* data();
+    const double* data() const;
 
     static std::function<void(RandomVariable&)> deleter;
 
@@ -300,13 +325,21 @@ std::vector<RandomVariable> applyCoordinateTransform(const std::vector<const Ran
 /* Create vector of pointers to rvs from vector of rvs */
 std::vector<const RandomVariable*> vec2vecptr(const std::vector<RandomVariable>& values);
 
-// compute regression coefficients
-enum class RandomVariableRegressionMethod { QR, SVD };
+/* compute regression coefficients
+
+   QR and SVD solve the least squares problem on the full (samples x basis functions) matrix.
+
+   NormalEquations accumulates the gram matrix and the right hand side of the normal equations over blocks of samples,
+   on up to regressionThreads threads for large sample sizes, and solves them with a Cholesky decomposition of the
+   scaled gram matrix, so that the memory required is independent of the number of samples. The result does not depend
+   on the number of threads. If the gram matrix is close to singular, the coefficients are computed with SVD instead.
+   The basis functions must be evaluated pathwise for this method. */
+enum class RandomVariableRegressionMethod { QR, SVD, NormalEquations };
 Array regressionCoefficients(
     RandomVariable r, std::vector<const RandomVariable*> regressor,
     const std::vector<std::function<RandomVariable(const std::vector<const RandomVariable*>&)>>& basisFn,
     const Filter& filter = Filter(), const RandomVariableRegressionMethod = RandomVariableRegressionMethod::QR,
-    const std::string& debugLabel = std::string());
+    const std::string& debugLabel = std::string(), const Size regressionThreads = 1);
 
 // evaluate regression function
 RandomVariable conditionalExpectation(
@@ -318,7 +351,8 @@ RandomVariable conditionalExpectation(
 RandomVariable conditionalExpectation(
     const RandomVariable& r, const std::vector<const RandomVariable*>& regressor,
     const std::vector<std::function<RandomVariable(const std::vector<const RandomVariable*>&)>>& basisFn,
-    const Filter& filter = Filter(), const RandomVariableRegressionMethod = RandomVariableRegressionMethod::QR);
+    const Filter& filter = Filter(), const RandomVariableRegressionMethod = RandomVariableRegressionMethod::QR,
+    const Size regressionThreads = 1);
 
 // time zero expectation
 RandomVariable expectation(const RandomVariable& r);
@@ -372,6 +406,8 @@ inline Real RandomVariable::at(const Size i) const {
 
 inline double* RandomVariable::data() { return data_; }
 
+inline const double* RandomVariable::data() const { return data_; }
+
 /*! helper function that returns a LSM basis system with size restriction: the order is reduced until
   the size of the basis system is not greater than the given bound (if this is not null) or the order is 1 */
 std::vector<std::function<RandomVariable(const std::vector<const RandomVariable*>&)>>
@@ -26,7 +26,9 @@ namespace QuantExt {
 
 std::vector<RandomVariableOp> getRandomVariableOps(const Size size, const Size regressionOrder,
                                                    QuantLib::LsmBasisSystem::PolynomialType polynomType,
-                                                   const double eps, QuantLib::Real regressionVarianceCutoff) {
+                                                   const double eps, QuantLib::Real regressionVarianceCutoff,
+                                                   const RandomVariableRegressionMethod regressionMethod,
+                                                   const Size regressionThreads) {
     std::vector<RandomVariableOp> ops;
 
     // None = 0
@@ -51,8 +53,8 @@ std::vector<RandomVariableOp> getRandomVariableOps(const Size size, const Size r
     ops.push_back([](const std::vector<const RandomVariable*>& args) { return *args[0] / (*args[1]); });
 
     // ConditionalExpectation = 6
-    ops.push_back([size, regressionOrder, polynomType,
-                   regressionVarianceCutoff](const std::vector<const RandomVariable*>& args) {
+    ops.push_back([size, regressionOrder, polynomType, regressionVarianceCutoff, regressionMethod,
+                   regressionThreads](const std::vector<const RandomVariable*>& args) {
         std::vector<const RandomVariable*> regressor;
         for (auto r = std::next(args.begin(), 2); r != args.end(); ++r) {
             if ((*r)->initialised() && !(*r)->deterministic())
@@ -69,7 +71,8 @@ std::vector<RandomVariableOp> getRandomVariableOps(const Size size, const Size r
             return expectation(*args[0]);
         else {
             auto tmp = multiPathBasisSystem(regressor.size(), regressionOrder, polynomType, size);
-            return conditionalExpectation(*args[0], regressor, tmp, !close_enough(*args[1], RandomVariable(size, 0.0)));
+            return conditionalExpectation(*args[0], regressor, tmp, !close_enough(*args[1], RandomVariable(size, 0.0)),
+                                          regressionMethod, regressionThreads);
         }
     });
 
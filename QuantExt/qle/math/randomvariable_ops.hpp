@@ -39,7 +39,9 @@ using RandomVariableOp = std::function<RandomVariable(const std::vector<const Ra
 std::vector<RandomVariableOp>
 getRandomVariableOps(const Size size, const Size regressionOrder = 2,
                      const QuantLib::LsmBasisSystem::PolynomialType polynomType = QuantLib::LsmBasisSystem::Monomial,
-                     const double eps = 0.0, QuantLib::Real regressionVarianceCutoff = Null<Real>());
+                     const double eps = 0.0, QuantLib::Real regressionVarianceCutoff = Null<Real>(),
+                     const RandomVariableRegressionMethod regressionMethod = RandomVariableRegressionMethod::QR,
+                     const Size regressionThreads = 1);
 
 // random variable gradients
 
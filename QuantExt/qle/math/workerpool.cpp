@@ -0,0 +1,110 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <qle/math/workerpool.hpp>
+
+namespace QuantExt {
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    start_.notify_all();
+    for (auto& t : threads_)
+        t.join();
+}
+
+WorkerPool& WorkerPool::instance() {
+    static WorkerPool pool;
+    return pool;
+}
+
+void WorkerPool::run(const std::size_t nThreads, const std::function<void(std::size_t)>& job) {
+    if (nThreads <= 1) {
+        job(0);
+        return;
+    }
+    bool serial = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (busy_) {
+            // the workers are used by another caller
+            serial = true;
+        } else {
+            while (threads_.size() < nThreads - 1) {
+                std::size_t worker = threads_.size() + 1;
+                threads_.emplace_back([this, worker]() { workerLoop(worker); });
+            }
+            busy_ = true;
+            job_ = &job;
+            active_ = nThreads;
+            pending_ = nThreads - 1;
+            errors_.assign(nThreads, nullptr);
+            ++generation_;
+        }
+    }
+    if (serial) {
+        for (std::size_t i = 0; i < nThreads; ++i)
+            job(i);
+        return;
+    }
+    start_.notify_all();
+    std::exception_ptr error;
+    try {
+        job(0);
+    } catch (...) {
+        error = std::current_exception();
+    }
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock, [this]() { return pending_ == 0; });
+    job_ = nullptr;
+    busy_ = false;
+    errors_[0] = error;
+    for (auto const& e : errors_) {
+        if (e)
+            std::rethrow_exception(e);
+    }
+}
+
+void WorkerPool::workerLoop(const std::size_t worker) {
+    std::size_t generation = 0;
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        start_.wait(lock, [this, &generation]() { return stop_ || generation_ != generation; });
+        if (stop_)
+            return;
+        generation = generation_;
+        if (worker >= active_)
+            continue;
+        const std::function<void(std::size_t)>* job = job_;
+        lock.unlock();
+        std::exception_ptr error;
+        try {
+            (*job)(worker);
+        } catch (...) {
+            error = std::current_exception();
+        }
+        lock.lock();
+        errors_[worker] = error;
+        if (--pending_ == 0)
+            done_.notify_one();
+    }
+}
+
+} // namespace QuantExt
@@ -0,0 +1,65 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file qle/math/workerpool.hpp
+    \brief persistent worker threads for data parallel calculations
+*/
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace QuantExt {
+
+//! Persistent worker threads
+/*! run() executes job(0) on the calling thread and job(1), ..., job(nThreads - 1) on the workers, which are started on
+    first use and kept until the pool is destroyed. Exceptions thrown by a job are rethrown on the calling thread.
+
+    If run() is called while the pool executes the jobs of another caller, the jobs are executed one after another on
+    the calling thread instead, so that a pool can be shared between threads. */
+class WorkerPool {
+public:
+    WorkerPool() = default;
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+    ~WorkerPool();
+
+    void run(const std::size_t nThreads, const std::function<void(std::size_t)>& job);
+
+    //! a pool shared by the calculations which do not own a pool
+    static WorkerPool& instance();
+
+private:
+    void workerLoop(const std::size_t worker);
+
+    std::vector<std::thread> threads_;
+    std::mutex mutex_;
+    std::condition_variable start_, done_;
+    const std::function<void(std::size_t)>* job_ = nullptr;
+    std::size_t generation_ = 0, active_ = 0, pending_ = 0;
+    std::vector<std::exception_ptr> errors_;
+    bool busy_ = false, stop_ = false;
+};
+
+} // namespace QuantExt
@@ -20,10 +20,83 @@
 
 #include <boost/make_shared.hpp>
 
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+
 using namespace QuantLib;
 
 namespace QuantExt {
 
+namespace {
+
+// maximum number of variates held in the buffers of the Sobol Brownian bridge generators
+constexpr Size maxBlockValues = 1 << 20;
+
+// the orderings of the variates, as in SobolBrownianGenerator
+
+void fillByFactor(std::vector<std::vector<Size>>& m, const Size factors, const Size steps) {
+    Size counter = 0;
+    for (Size i = 0; i < factors; ++i)
+        for (Size j = 0; j < steps; ++j)
+            m[i][j] = counter++;
+}
+
+void fillByStep(std::vector<std::vector<Size>>& m, const Size factors, const Size steps) {
+    Size counter = 0;
+    for (Size j = 0; j < steps; ++j)
+        for (Size i = 0; i < factors; ++i)
+            m[i][j] = counter++;
+}
+
+void fillByDiagonal(std::vector<std::vector<Size>>& m, const Size factors, const Size steps) {
+    Size i0 = 0, j0 = 0, i = 0, j = 0, counter = 0;
+    while (counter < factors * steps) {
+        m[i][j] = counter++;
+        if (i == 0 || j == steps - 1) {
+            // start a new diagonal
+            if (i0 < factors - 1) {
+                i0 = i0 + 1;
+                j0 = 0;
+            } else {
+                i0 = factors - 1;
+                j0 = j0 + 1;
+            }
+            i = i0;
+            j = j0;
+        } else {
+            // move along the diagonal
+            i = i - 1;
+            j = j + 1;
+        }
+    }
+}
+
+} // namespace
+
+void MultiPathGeneratorBase::nextBlock(const Size nSamples, const std::vector<std::vector<Real*>>& paths) const {
+    for (Size k = 0; k < nSamples; ++k) {
+        const MultiPath& path = next().value;
+        QL_REQUIRE(paths.size() < path.pathSize(), "MultiPathGeneratorBase::nextBlock(): paths size ("
+                                                       << paths.size() << ") exceeds number of time steps ("
+                                                       << path.pathSize() - 1 << ")");
+        for (Size i = 0; i < paths.size(); ++i) {
+            QL_REQUIRE(paths[i].size() <= path.assetNumber(), "MultiPathGeneratorBase::nextBlock(): paths size ("
+                                                                  << paths[i].size() << ") exceeds number of assets ("
+                                                                  << path.assetNumber() << ")");
+            for (Size j = 0; j < paths[i].size(); ++j) {
+                if (paths[i][j] != nullptr)
+                    paths[i][j][k] = path[j][i + 1];
+            }
+        }
+    }
+}
+
+void MultiPathGeneratorBase::skip(const Size nSamples) {
+    for (Size k = 0; k < nSamples; ++k)
+        next();
+}
+
 MultiPathGeneratorMersenneTwister::MultiPathGeneratorMersenneTwister(
     const QuantLib::ext::shared_ptr<StochasticProcess>& process, const TimeGrid& grid, BigNatural seed, bool antitheticSampling)
     : process_(process), grid_(grid), seed_(seed), antitheticSampling_(antitheticSampling), antitheticVariate_(true),
@@ -131,27 +204,95 @@ MultiPathGeneratorSobolBrownianBridgeBase::MultiPathGeneratorSobolBrownianBridge
     const QuantLib::ext::shared_ptr<StochasticProcess>& process, const TimeGrid& grid,
     SobolBrownianGenerator::Ordering ordering, BigNatural seed, SobolRsg::DirectionIntegers directionIntegers)
     : process_(process), grid_(grid), ordering_(ordering), seed_(seed), directionIntegers_(directionIntegers),
-      next_(MultiPath(process->size(), grid), 1.0) {
+      next_(MultiPath(process->size(), grid), 1.0), factors_(process->factors()), steps_(grid.size() - 1),
+      bridge_(steps_), orderedIndices_(factors_, std::vector<Size>(steps_)) {
     process1D_ = QuantLib::ext::dynamic_pointer_cast<StochasticProcess1D>(process);
+    switch (ordering_) {
+    case SobolBrownianGenerator::Factors:
+        fillByFactor(orderedIndices_, factors_, steps_);
+        break;
+    case SobolBrownianGenerator::Steps:
+        fillByStep(orderedIndices_, factors_, steps_);
+        break;
+    case SobolBrownianGenerator::Diagonal:
+        fillByDiagonal(orderedIndices_, factors_, steps_);
+        break;
+    default:
+        QL_FAIL("MultiPathGeneratorSobolBrownianBridgeBase: unknown ordering");
+    }
+}
+
+void MultiPathGeneratorSobolBrownianBridgeBase::generateVariates(const Size nSamples) const {
+    Size dim = factors_ * steps_;
+    variates_.resize(dim * nSamples);
+    bridgedVariates_.resize(dim * nSamples);
+
+    // transpose the uniform sequences, so that the loops below run over contiguous samples
+
+    for (Size i = 0; i < nSamples; ++i) {
+        const std::vector<Real>& u = nextUniformSequence();
+        for (Size d = 0; d < dim; ++d)
+            variates_[d * nSamples + i] = u[d];
+    }
+
+    InverseCumulativeNormal icn;
+    for (auto& v : variates_)
+        v = icn(v);
+
+    // Brownian bridge per factor, this is BrownianBridge::transform() for unit time steps applied to all samples
+
+    const std::vector<Size>& bridgeIndex = bridge_.bridgeIndex();
+    const std::vector<Size>& leftIndex = bridge_.leftIndex();
+    const std::vector<Size>& rightIndex = bridge_.rightIndex();
+    const std::vector<Real>& leftWeight = bridge_.leftWeight();
+    const std::vector<Real>& rightWeight = bridge_.rightWeight();
+    const std::vector<Real>& stdDev = bridge_.stdDeviation();
+
+    for (Size f = 0; f < factors_; ++f) {
+        Real* b = &bridgedVariates_[f * steps_ * nSamples];
+        const Real* z = &variates_[orderedIndices_[f][0] * nSamples];
+        Real* out = b + (steps_ - 1) * nSamples;
+        for (Size i = 0; i < nSamples; ++i)
+            out[i] = stdDev[0] * z[i];
+        for (Size s = 1; s < steps_; ++s) {
+            z = &variates_[orderedIndices_[f][s] * nSamples];
+            out = b + bridgeIndex[s] * nSamples;
+            const Real* right = b + rightIndex[s] * nSamples;
+            if (leftIndex[s] != 0) {
+                const Real* left = b + (leftIndex[s] - 1) * nSamples;
+                for (Size i = 0; i < nSamples; ++i)
+                    out[i] = leftWeight[s] * left[i] + rightWeight[s] * right[i] + stdDev[s] * z[i];
+            } else {
+                for (Size i = 0; i < nSamples; ++i)
+                    out[i] = rightWeight[s] * right[i] + stdDev[s] * z[i];
+            }
+        }
+        for (Size s = steps_ - 1; s >= 1; --s) {
+            out = b + s * nSamples;
+            const Real* previous = out - nSamples;
+            for (Size i = 0; i < nSamples; ++i)
+                out[i] -= previous[i];
+        }
+    }
 }
 
 const Sample<MultiPath>& MultiPathGeneratorSobolBrownianBridgeBase::next() const {
+    generateVariates(1);
     Array asset = process_->initialValues();
     MultiPath& path = next_.value;
     for (Size j = 0; j < asset.size(); ++j) {
         path[j].front() = asset[j];
     }
-    next_.weight = gen_->nextPath();
-    std::vector<Real> output(process_->factors());
+    Array dw(factors_);
     for (Size i = 1; i < grid_.size(); ++i) {
         Real t = grid_[i - 1];
         Real dt = grid_.dt(i - 1);
-        gen_->nextStep(output);
+        for (Size f = 0; f < factors_; ++f)
+            dw[f] = bridgedVariates_[f * steps_ + i - 1];
         if (process1D_) {
-            path[0][i] = asset[0] = process1D_->evolve(t, asset[0], dt, output[0]);
+            path[0][i] = asset[0] = process1D_->evolve(t, asset[0], dt, dw[0]);
         } else {
-            Array tmp(output.begin(), output.end());
-            asset = process_->evolve(t, asset, dt, tmp);
+            asset = process_->evolve(t, asset, dt, dw);
             for (Size j = 0; j < asset.size(); ++j) {
                 path[j][i] = asset[j];
             }
@@ -160,6 +301,45 @@ const Sample<MultiPath>& MultiPathGeneratorSobolBrownianBridgeBase::next() const
     return next_;
 }
 
+void MultiPathGeneratorSobolBrownianBridgeBase::nextBlock(const Size nSamples,
+                                                          const std::vector<std::vector<Real*>>& paths) const {
+    QL_REQUIRE(paths.size() <= steps_, "MultiPathGeneratorSobolBrownianBridgeBase::nextBlock(): paths size ("
+                                           << paths.size() << ") exceeds number of time steps (" << steps_ << ")");
+    for (auto const& p : paths) {
+        QL_REQUIRE(p.size() <= process_->size(), "MultiPathGeneratorSobolBrownianBridgeBase::nextBlock(): paths size ("
+                                                     << p.size() << ") exceeds process size (" << process_->size()
+                                                     << ")");
+    }
+
+    Array initialValues = process_->initialValues(), asset, dw(factors_);
+    Size blockSize = std::max<Size>(1, std::min(nSamples, maxBlockValues / std::max<Size>(1, factors_ * steps_)));
+
+    for (Size offset = 0; offset < nSamples; offset += blockSize) {
+        Size n = std::min(blockSize, nSamples - offset);
+        generateVariates(n);
+        // the evolution has to run path by path, since the cross asset state process caches by time step
+        for (Size k = 0; k < n; ++k) {
+            asset = initialValues;
+            for (Size i = 0; i < steps_; ++i) {
+                Real t = grid_[i];
+                Real dt = grid_.dt(i);
+                for (Size f = 0; f < factors_; ++f)
+                    dw[f] = bridgedVariates_[(f * steps_ + i) * n + k];
+                if (process1D_)
+                    asset[0] = process1D_->evolve(t, asset[0], dt, dw[0]);
+                else
+                    asset = process_->evolve(t, asset, dt, dw);
+                if (i < paths.size()) {
+                    for (Size j = 0; j < paths[i].size(); ++j) {
+                        if (paths[i][j] != nullptr)
+                            paths[i][j][offset + k] = asset[j];
+                    }
+                }
+            }
+        }
+    }
+}
+
 MultiPathGeneratorSobolBrownianBridge::MultiPathGeneratorSobolBrownianBridge(
     const QuantLib::ext::shared_ptr<StochasticProcess>& process, const TimeGrid& grid,
     SobolBrownianGenerator::Ordering ordering, BigNatural seed, SobolRsg::DirectionIntegers directionIntegers)
@@ -168,8 +348,23 @@ MultiPathGeneratorSobolBrownianBridge::MultiPathGeneratorSobolBrownianBridge(
 }
 
 void MultiPathGeneratorSobolBrownianBridge::reset() {
-    gen_ = QuantLib::ext::make_shared<SobolBrownianGenerator>(process_->factors(), grid_.size() - 1, ordering_, seed_,
-                                                      directionIntegers_);
+    rsg_ = QuantLib::ext::make_shared<SobolRsg>(process_->factors() * (grid_.size() - 1), seed_, directionIntegers_);
+    nextSample_ = 0;
+}
+
+void MultiPathGeneratorSobolBrownianBridge::skip(const Size nSamples) {
+    Size target = nextSample_ + nSamples;
+    QL_REQUIRE(target <= std::numeric_limits<std::uint32_t>::max(),
+               "MultiPathGeneratorSobolBrownianBridge::skip(): sample index " << target << " out of range");
+    // SobolRsg::skipTo() positions the next draw correctly on a new generator only
+    reset();
+    rsg_->skipTo(static_cast<std::uint32_t>(target));
+    nextSample_ = target;
+}
+
+const std::vector<Real>& MultiPathGeneratorSobolBrownianBridge::nextUniformSequence() const {
+    ++nextSample_;
+    return rsg_->nextSequence().value;
 }
 
 MultiPathGeneratorBurley2020SobolBrownianBridge::MultiPathGeneratorBurley2020SobolBrownianBridge(
@@ -182,8 +377,22 @@ MultiPathGeneratorBurley2020SobolBrownianBridge::MultiPathGeneratorBurley2020Sob
 }
 
 void MultiPathGeneratorBurley2020SobolBrownianBridge::reset() {
-    gen_ = QuantLib::ext::make_shared<Burley2020SobolBrownianGenerator>(process_->factors(), grid_.size() - 1, ordering_, seed_,
-                                                                directionIntegers_, scrambleSeed_);
+    rsg_ = QuantLib::ext::make_shared<Burley2020SobolRsg>(process_->factors() * (grid_.size() - 1), seed_,
+                                                          directionIntegers_, scrambleSeed_);
+    nextSample_ = 0;
+}
+
+void MultiPathGeneratorBurley2020SobolBrownianBridge::skip(const Size nSamples) {
+    Size target = nextSample_ + nSamples;
+    QL_REQUIRE(target <= std::numeric_limits<std::uint32_t>::max(),
+               "MultiPathGeneratorBurley2020SobolBrownianBridge::skip(): sample index " << target << " out of range");
+    rsg_->skipTo(static_cast<std::uint32_t>(target));
+    nextSample_ = target;
+}
+
+const std::vector<Real>& MultiPathGeneratorBurley2020SobolBrownianBridge::nextUniformSequence() const {
+    ++nextSample_;
+    return rsg_->nextSequence().value;
 }
 
 QuantLib::ext::shared_ptr<MultiPathGeneratorBase>
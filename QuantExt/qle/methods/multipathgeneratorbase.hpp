@@ -23,7 +23,9 @@
 
 #pragma once
 
+#include <ql/math/randomnumbers/burley2020sobolrsg.hpp>
 #include <ql/math/randomnumbers/rngtraits.hpp>
+#include <ql/math/randomnumbers/sobolrsg.hpp>
 #include <ql/methods/montecarlo/brownianbridge.hpp>
 #include <ql/methods/montecarlo/multipath.hpp>
 #include <ql/methods/montecarlo/multipathgenerator.hpp>
@@ -51,6 +53,14 @@ public:
     virtual ~MultiPathGeneratorBase() {}
     virtual const Sample<MultiPath>& next() const = 0;
     virtual void reset() = 0;
+    /*! Generates the next nSamples paths, the result is the same as for nSamples calls to next(). The values are
+        written in structure-of-arrays layout: paths[i][j] points to an array of at least nSamples values receiving the
+        state variable j at time grid index i + 1. Null pointers are allowed for values that are not needed. The path
+        weights are not returned. The default implementation calls next() for each sample. */
+    virtual void nextBlock(const Size nSamples, const std::vector<std::vector<Real*>>& paths) const;
+    /*! Skips the next nSamples paths, i.e. the next call to next() returns the same path as after nSamples calls to
+        next(). The default implementation calls next() nSamples times. */
+    virtual void skip(const Size nSamples);
 };
 
 //! Instantiation of MultiPathGenerator with standard PseudoRandom traits
@@ -133,9 +143,13 @@ private:
     mutable Sample<MultiPath> next_;
 };
 
-//! Base class for instantiations using brownian generators from models/marketmodels/browniangenerators
-/*! \ingroup methods
- */
+//! Base class for Sobol generators with Brownian bridge
+/*! The variates are identical to those of the brownian generators from models/marketmodels/browniangenerators. They
+    are generated for blocks of paths in structure-of-arrays layout, so that the inverse cumulative normal and the
+    Brownian bridge run over contiguous arrays of samples, which allows the compiler to vectorise these loops.
+
+    \ingroup methods
+*/
 class MultiPathGeneratorSobolBrownianBridgeBase : public MultiPathGeneratorBase {
 public:
     MultiPathGeneratorSobolBrownianBridgeBase(const QuantLib::ext::shared_ptr<StochasticProcess>&, const TimeGrid&,
@@ -143,19 +157,33 @@ public:
                                               BigNatural seed = 0,
                                               SobolRsg::DirectionIntegers directionIntegers = SobolRsg::JoeKuoD7);
     const Sample<MultiPath>& next() const override;
+    void nextBlock(const Size nSamples, const std::vector<std::vector<Real*>>& paths) const override;
 
 protected:
+    //! next uniform sequence of dimension factors x time steps
+    virtual const std::vector<Real>& nextUniformSequence() const = 0;
+
     const QuantLib::ext::shared_ptr<StochasticProcess> process_;
     TimeGrid grid_;
     SobolBrownianGenerator::Ordering ordering_;
     BigNatural seed_;
     SobolRsg::DirectionIntegers directionIntegers_;
-    QuantLib::ext::shared_ptr<SobolBrownianGeneratorBase> gen_;
     mutable Sample<MultiPath> next_;
     QuantLib::ext::shared_ptr<StochasticProcess1D> process1D_;
+
+private:
+    // fills bridgedVariates_ with the brownian increments for the next nSamples paths
+    void generateVariates(const Size nSamples) const;
+
+    Size factors_, steps_;
+    BrownianBridge bridge_;
+    std::vector<std::vector<Size>> orderedIndices_;
+    // variates_[d * nSamples + i] = variate d of sample i
+    // bridgedVariates_[(f * steps_ + s) * nSamples + i] = increment for factor f and time step s of sample i
+    mutable std::vector<Real> variates_, bridgedVariates_;
 };
 
-//! Instantiation using SobolBrownianGenerator from  models/marketmodels/browniangenerators
+//! Instantiation using the variates of SobolBrownianGenerator from  models/marketmodels/browniangenerators
 /*! \ingroup methods
  */
 class MultiPathGeneratorSobolBrownianBridge : public MultiPathGeneratorSobolBrownianBridgeBase {
@@ -165,9 +193,17 @@ public:
                                           BigNatural seed = 0,
                                           SobolRsg::DirectionIntegers directionIntegers = SobolRsg::JoeKuoD7);
     void reset() override final;
+    void skip(const Size nSamples) override;
+
+protected:
+    const std::vector<Real>& nextUniformSequence() const override;
+
+private:
+    QuantLib::ext::shared_ptr<SobolRsg> rsg_;
+    mutable Size nextSample_ = 0;
 };
 
-//! Instantiation using Burley2020SobolBrownianGenerator from  models/marketmodels/browniangenerators
+//! Instantiation using the variates of Burley2020SobolBrownianGenerator from  models/marketmodels/browniangenerators
 /*! \ingroup methods
  */
 class MultiPathGeneratorBurley2020SobolBrownianBridge : public MultiPathGeneratorSobolBrownianBridgeBase {
@@ -177,9 +213,16 @@ public:
         SobolBrownianGenerator::Ordering ordering = SobolBrownianGenerator::Steps, BigNatural seed = 42,
         SobolRsg::DirectionIntegers directionIntegers = SobolRsg::JoeKuoD7, BigNatural scrambleSeed = 43);
     void reset() override final;
+    void skip(const Size nSamples) override;
 
 protected:
+    const std::vector<Real>& nextUniformSequence() const override;
+
     BigNatural scrambleSeed_;
+
+private:
+    QuantLib::ext::shared_ptr<Burley2020SobolRsg> rsg_;
+    mutable Size nextSample_ = 0;
 };
 
 //! Make function for path generators
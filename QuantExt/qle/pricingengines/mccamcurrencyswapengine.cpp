@@ -29,11 +29,12 @@ McCamCurrencySwapEngine::McCamCurrencySwapEngine(
     const LsmBasisSystem::PolynomialType polynomType, const SobolBrownianGenerator::Ordering ordering,
     const SobolRsg::DirectionIntegers directionIntegers, const std::vector<Handle<YieldTermStructure>>& discountCurves,
     const std::vector<Date>& simulationDates, const std::vector<Size>& externalModelIndices, const bool minimalObsDate,
-    const RegressorModel regressorModel, const Real regressionVarianceCutoff)
+    const RegressorModel regressorModel, const Real regressionVarianceCutoff,
+    const RandomVariableRegressionMethod regressionMethod, const Size regressionThreads)
     : McMultiLegBaseEngine(model, calibrationPathGenerator, pricingPathGenerator, calibrationSamples, pricingSamples,
                            calibrationSeed, pricingSeed, polynomOrder, polynomType, ordering, directionIntegers,
                            discountCurves, simulationDates, externalModelIndices, minimalObsDate, regressorModel,
-                           regressionVarianceCutoff),
+                           regressionVarianceCutoff, regressionMethod, regressionThreads),
       currencies_(currencies), npvCcy_(npvCcy) {
     registerWith(model_);
     for (auto const& h : discountCurves)
@@ -32,11 +32,12 @@ McCamFxForwardEngine::McCamFxForwardEngine(
     const SobolBrownianGenerator::Ordering ordering, const SobolRsg::DirectionIntegers directionIntegers,
     const std::vector<Handle<YieldTermStructure>>& discountCurves, const std::vector<Date>& simulationDates,
     const std::vector<Size>& externalModelIndices, const bool minimalObsDate, const RegressorModel regressorModel,
-    const Real regressionVarianceCutoff)
+    const Real regressionVarianceCutoff, const RandomVariableRegressionMethod regressionMethod,
+    const Size regressionThreads)
     : McMultiLegBaseEngine(model, calibrationPathGenerator, pricingPathGenerator, calibrationSamples, pricingSamples,
                            calibrationSeed, pricingSeed, polynomOrder, polynomType, ordering, directionIntegers,
                            discountCurves, simulationDates, externalModelIndices, minimalObsDate, regressorModel,
-                           regressionVarianceCutoff),
+                           regressionVarianceCutoff, regressionMethod, regressionThreads),
       domesticCcy_(domesticCcy), foreignCcy_(foreignCcy), npvCcy_(npvCcy) {
     registerWith(model_);
     for (auto const& h : discountCurves)
@@ -47,13 +47,15 @@ McMultiLegBaseEngine::McMultiLegBaseEngine(
     const LsmBasisSystem::PolynomialType polynomType, const SobolBrownianGenerator::Ordering ordering,
     SobolRsg::DirectionIntegers directionIntegers, const std::vector<Handle<YieldTermStructure>>& discountCurves,
     const std::vector<Date>& simulationDates, const std::vector<Size>& externalModelIndices, const bool minimalObsDate,
-    const RegressorModel regressorModel, const Real regressionVarianceCutoff)
+    const RegressorModel regressorModel, const Real regressionVarianceCutoff,
+    const RandomVariableRegressionMethod regressionMethod, const Size regressionThreads)
     : model_(model), calibrationPathGenerator_(calibrationPathGenerator), pricingPathGenerator_(pricingPathGenerator),
       calibrationSamples_(calibrationSamples), pricingSamples_(pricingSamples), calibrationSeed_(calibrationSeed),
       pricingSeed_(pricingSeed), polynomOrder_(polynomOrder), polynomType_(polynomType), ordering_(ordering),
       directionIntegers_(directionIntegers), discountCurves_(discountCurves), simulationDates_(simulationDates),
       externalModelIndices_(externalModelIndices), minimalObsDate_(minimalObsDate), regressorModel_(regressorModel),
-      regressionVarianceCutoff_(regressionVarianceCutoff) {
+      regressionVarianceCutoff_(regressionVarianceCutoff), regressionMethod_(regressionMethod),
+      regressionThreads_(regressionThreads) {
 
     if (discountCurves_.empty())
         discountCurves_.resize(model_->components(CrossAssetModel::AssetType::IR));
@@ -786,11 +788,14 @@ void McMultiLegBaseEngine::calculate() const {
         std::vector<RandomVariable>(model_->stateProcess()->size(), RandomVariable(calibrationSamples_)));
     std::vector<std::vector<const RandomVariable*>> pathValuesRef(
         simulationTimes.size(), std::vector<const RandomVariable*>(model_->stateProcess()->size()));
+    std::vector<std::vector<Real*>> pathValuesData(simulationTimes.size(),
+                                                   std::vector<Real*>(model_->stateProcess()->size()));
 
     for (Size i = 0; i < pathValues.size(); ++i) {
         for (Size j = 0; j < pathValues[i].size(); ++j) {
             pathValues[i][j].expand();
             pathValuesRef[i][j] = &pathValues[i][j];
+            pathValuesData[i][j] = pathValues[i][j].data();
         }
     }
 
@@ -810,14 +815,7 @@ void McMultiLegBaseEngine::calculate() const {
     auto pathGenerator = makeMultiPathGenerator(calibrationPathGenerator_, process, timeGrid, calibrationSeed_,
                                                 ordering_, directionIntegers_);
 
-    for (Size i = 0; i < calibrationSamples_; ++i) {
-        const MultiPath& path = pathGenerator->next().value;
-        for (Size j = 0; j < simulationTimes.size(); ++j) {
-            for (Size k = 0; k < model_->stateProcess()->size(); ++k) {
-                pathValues[j][k].data()[i] = path[k][j + 1];
-            }
-        }
-    }
+    pathGenerator->nextBlock(calibrationSamples_, pathValuesData);
 
     McEngineStats::instance().path_timer.stop();
 
@@ -875,7 +873,7 @@ void McMultiLegBaseEngine::calculate() const {
         if (exercise_ != nullptr) {
             regModelUndExInto[counter] = RegressionModel(
                 *t, cashflowInfo, [&cfStatus](std::size_t i) { return cfStatus[i] == CfStatus::done; }, **model_,
-                regressorModel_, regressionVarianceCutoff_);
+                regressorModel_, regressionVarianceCutoff_, regressionMethod_, regressionThreads_);
             regModelUndExInto[counter].train(polynomOrder_, polynomType_, pathValueUndExInto, pathValuesRef,
                                              simulationTimes);
         }
@@ -885,7 +883,7 @@ void McMultiLegBaseEngine::calculate() const {
                                                                   pathValuesRef, simulationTimes);
             regModelContinuationValue[counter] = RegressionModel(
                 *t, cashflowInfo, [&cfStatus](std::size_t i) { return cfStatus[i] == CfStatus::done; }, **model_,
-                regressorModel_, regressionVarianceCutoff_);
+                regressorModel_, regressionVarianceCutoff_, regressionMethod_, regressionThreads_);
             regModelContinuationValue[counter].train(polynomOrder_, polynomType_, pathValueOption, pathValuesRef,
                                                      simulationTimes,
                                                      exerciseValue > RandomVariable(calibrationSamples_, 0.0));
@@ -896,14 +894,14 @@ void McMultiLegBaseEngine::calculate() const {
                                                 pathValueUndExInto, pathValueOption);
             regModelOption[counter] = RegressionModel(
                 *t, cashflowInfo, [&cfStatus](std::size_t i) { return cfStatus[i] == CfStatus::done; }, **model_,
-                regressorModel_, regressionVarianceCutoff_);
+                regressorModel_, regressionVarianceCutoff_, regressionMethod_, regressionThreads_);
             regModelOption[counter].train(polynomOrder_, polynomType_, pathValueOption, pathValuesRef, simulationTimes);
         }
 
         if (isXvaTime) {
             regModelUndDirty[counter] = RegressionModel(
                 *t, cashflowInfo, [&cfStatus](std::size_t i) { return cfStatus[i] != CfStatus::open; }, **model_,
-                regressorModel_, regressionVarianceCutoff_);
+                regressorModel_, regressionVarianceCutoff_, regressionMethod_, regressionThreads_);
             regModelUndDirty[counter].train(polynomOrder_, polynomType_, pathValueUndDirty, pathValuesRef,
                                             simulationTimes);
         }
@@ -911,7 +909,7 @@ void McMultiLegBaseEngine::calculate() const {
         if (exercise_ != nullptr) {
             regModelOption[counter] = RegressionModel(
                 *t, cashflowInfo, [&cfStatus](std::size_t i) { return cfStatus[i] == CfStatus::done; }, **model_,
-                regressorModel_, regressionVarianceCutoff_);
+                regressorModel_, regressionVarianceCutoff_, regressionMethod_, regressionThreads_);
             regModelOption[counter].train(polynomOrder_, polynomType_, pathValueOption, pathValuesRef, simulationTimes);
         }
 
@@ -1106,8 +1104,11 @@ McMultiLegBaseEngine::RegressionModel::RegressionModel(const Real observationTim
                                                        const std::function<bool(std::size_t)>& cashflowRelevant,
                                                        const CrossAssetModel& model,
                                                        const McMultiLegBaseEngine::RegressorModel regressorModel,
-                                                       const Real regressionVarianceCutoff)
-    : observationTime_(observationTime), regressionVarianceCutoff_(regressionVarianceCutoff) {
+                                                       const Real regressionVarianceCutoff,
+                                                       const RandomVariableRegressionMethod regressionMethod,
+                                                       const Size regressionThreads)
+    : observationTime_(observationTime), regressionVarianceCutoff_(regressionVarianceCutoff),
+      regressionMethod_(regressionMethod), regressionThreads_(regressionThreads) {
 
     // we always include the full model state as of the observation time
 
@@ -1186,7 +1187,8 @@ void McMultiLegBaseEngine::RegressionModel::train(const Size polynomOrder,
         // compute the regression coefficients
 
         regressionCoeffs_ =
-            regressionCoefficients(regressand, regressor, basisFns_, filter, RandomVariableRegressionMethod::QR);
+            regressionCoefficients(regressand, regressor, basisFns_, filter, regressionMethod_, std::string(),
+                                   regressionThreads_);
 
     } else {
 
@@ -65,7 +65,8 @@ public:
 protected:
     /*! The npv is computed in the model's base currency, discounting curves are taken from the model. simulationDates
         are additional simulation dates. The cross asset model here must be consistent with the multi path that is the
-        input to AmcCalculator::simulatePath().
+        input to AmcCalculator::simulatePath(). The regressionMethod and regressionThreads are used to compute the
+        coefficients of the regression models, see regressionCoefficients().
 
         Current limitations:
         - the parameter minimalObsDate is ignored, the corresponding optimization is not implemented yet
@@ -81,7 +82,9 @@ protected:
         const std::vector<Date>& simulationDates = std::vector<Date>(),
         const std::vector<Size>& externalModelIndices = std::vector<Size>(), const bool minimalObsDate = true,
         const RegressorModel regressorModel = RegressorModel::Simple,
-        const Real regressionVarianceCutoff = Null<Real>());
+        const Real regressionVarianceCutoff = Null<Real>(),
+        const RandomVariableRegressionMethod regressionMethod = RandomVariableRegressionMethod::QR,
+        const Size regressionThreads = 1);
 
     // run calibration and pricing (called from derived engines)
     void calculate() const;
@@ -111,6 +114,8 @@ protected:
     bool minimalObsDate_;
     RegressorModel regressorModel_;
     Real regressionVarianceCutoff_;
+    RandomVariableRegressionMethod regressionMethod_;
+    Size regressionThreads_;
 
     // the generated amc calculator
     mutable QuantLib::ext::shared_ptr<AmcCalculator> amcCalculator_;
@@ -140,7 +145,9 @@ private:
         RegressionModel() = default;
         RegressionModel(const Real observationTime, const std::vector<CashflowInfo>& cashflowInfo,
                         const std::function<bool(std::size_t)>& cashflowRelevant, const CrossAssetModel& model,
-                        const RegressorModel regressorModel, const Real regressionVarianceCutoff = Null<Real>());
+                        const RegressorModel regressorModel, const Real regressionVarianceCutoff = Null<Real>(),
+                        const RandomVariableRegressionMethod regressionMethod = RandomVariableRegressionMethod::QR,
+                        const Size regressionThreads = 1);
         // pathTimes must contain the observation time and the relevant cashflow simulation times
         void train(const Size polynomOrder, const LsmBasisSystem::PolynomialType polynomType,
                    const RandomVariable& regressand, const std::vector<std::vector<const RandomVariable*>>& paths,
@@ -152,6 +159,8 @@ private:
     private:
         Real observationTime_ = Null<Real>();
         Real regressionVarianceCutoff_ = Null<Real>();
+        RandomVariableRegressionMethod regressionMethod_ = RandomVariableRegressionMethod::QR;
+        Size regressionThreads_ = 1;
         bool isTrained_ = false;
         std::set<std::pair<Real, Size>> regressorTimesModelIndices_;
         Matrix coordinateTransform_;
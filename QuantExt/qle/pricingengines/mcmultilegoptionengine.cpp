@@ -27,11 +27,12 @@ McMultiLegOptionEngine::McMultiLegOptionEngine(
     const LsmBasisSystem::PolynomialType polynomType, const SobolBrownianGenerator::Ordering ordering,
     const SobolRsg::DirectionIntegers directionIntegers, const std::vector<Handle<YieldTermStructure>>& discountCurves,
     const std::vector<Date>& simulationDates, const std::vector<Size>& externalModelIndices, const bool minObsDate,
-    const RegressorModel regressorModel, const Real regressionVarianceCutoff)
+    const RegressorModel regressorModel, const Real regressionVarianceCutoff,
+    const RandomVariableRegressionMethod regressionMethod, const Size regressionThreads)
     : McMultiLegBaseEngine(model, calibrationPathGenerator, pricingPathGenerator, calibrationSamples, pricingSamples,
                            calibrationSeed, pricingSeed, polynomOrder, polynomType, ordering, directionIntegers,
                            discountCurves, simulationDates, externalModelIndices, minObsDate, regressorModel,
-                           regressionVarianceCutoff) {
+                           regressionVarianceCutoff, regressionMethod, regressionThreads) {
     registerWith(model_);
     for (auto& h : discountCurves_) {
         registerWith(h);
@@ -45,14 +46,15 @@ McMultiLegOptionEngine::McMultiLegOptionEngine(
     const LsmBasisSystem::PolynomialType polynomType, const SobolBrownianGenerator::Ordering ordering,
     const SobolRsg::DirectionIntegers directionIntegers, const Handle<YieldTermStructure>& discountCurve,
     const std::vector<Date>& simulationDates, const std::vector<Size>& externalModelIndices, const bool minimalObsDate,
-    const RegressorModel regressorModel, const Real regressionVarianceCutoff)
+    const RegressorModel regressorModel, const Real regressionVarianceCutoff,
+    const RandomVariableRegressionMethod regressionMethod, const Size regressionThreads)
     : McMultiLegOptionEngine(Handle<CrossAssetModel>(QuantLib::ext::make_shared<CrossAssetModel>(
                                  std::vector<QuantLib::ext::shared_ptr<IrModel>>(1, model),
                                  std::vector<QuantLib::ext::shared_ptr<FxBsParametrization>>())),
                              calibrationPathGenerator, pricingPathGenerator, calibrationSamples, pricingSamples,
                              calibrationSeed, pricingSeed, polynomOrder, polynomType, ordering, directionIntegers,
                              {discountCurve}, simulationDates, externalModelIndices, minimalObsDate, regressorModel,
-                             regressionVarianceCutoff) {}
+                             regressionVarianceCutoff, regressionMethod, regressionThreads) {}
 
 void McMultiLegOptionEngine::calculate() const {
 
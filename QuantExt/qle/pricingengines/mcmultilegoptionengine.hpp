@@ -48,7 +48,9 @@ public:
         const std::vector<Date>& simulationDates = std::vector<Date>(),
         const std::vector<Size>& externalModelIndices = std::vector<Size>(), const bool minimalObsDate = true,
         const RegressorModel regressorModel = RegressorModel::Simple,
-        const Real regressionVarianceCutoff = Null<Real>());
+        const Real regressionVarianceCutoff = Null<Real>(),
+        const RandomVariableRegressionMethod regressionMethod = RandomVariableRegressionMethod::QR,
+        const Size regressionThreads = 1);
     McMultiLegOptionEngine(const QuantLib::ext::shared_ptr<LinearGaussMarkovModel>& model,
                            const SequenceType calibrationPathGenerator, const SequenceType pricingPathGenerator,
                            const Size calibrationSamples, const Size pricingSamples, const Size calibrationSeed,
@@ -61,7 +63,9 @@ public:
                            const std::vector<Size>& externalModelIndices = std::vector<Size>(),
                            const bool minimalObsDate = true,
                            const RegressorModel regressorModel = RegressorModel::Simple,
-                           const Real regressionVarianceCutoff = Null<Real>());
+                           const Real regressionVarianceCutoff = Null<Real>(),
+                           const RandomVariableRegressionMethod regressionMethod = RandomVariableRegressionMethod::QR,
+                           const Size regressionThreads = 1);
 
     void calculate() const override;
     const Handle<CrossAssetModel>& model() const { return model_; }
@@ -233,6 +233,7 @@
 #include <qle/math/fillemptymatrix.hpp>
 #include <qle/math/flatextrapolation.hpp>
 #include <qle/math/flatextrapolation2d.hpp>
+#include <qle/math/fusedcpuenvironment.hpp>
 #include <qle/math/kendallrankcorrelation.hpp>
 #include <qle/math/logquadraticinterpolation.hpp>
 #include <qle/math/matrixfunctions.hpp>
@@ -249,6 +250,7 @@
 #include <qle/math/stabilisedglls.hpp>
 #include <qle/math/stoplightbounds.hpp>
 #include <qle/math/trace.hpp>
+#include <qle/math/workerpool.hpp>
 #include <qle/methods/brownianbridgepathinterpolator.hpp>
 #include <qle/methods/fdmblackscholesmesher.hpp>
 #include <qle/methods/fdmblackscholesop.hpp>
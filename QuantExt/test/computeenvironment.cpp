@@ -18,6 +18,7 @@
 
 #include <qle/math/basiccpuenvironment.hpp>
 #include <qle/math/computeenvironment.hpp>
+#include <qle/math/fusedcpuenvironment.hpp>
 #include <qle/math/openclenvironment.hpp>
 #include <qle/math/randomvariable.hpp>
 #include <qle/math/randomvariable_io.hpp>
@@ -44,6 +45,8 @@ struct ComputeEnvironmentFixture {
             "OpenCL", &QuantExt::createComputeFrameworkCreator<QuantExt::OpenClFramework>, true);
         QuantExt::ComputeFrameworkRegistry::instance().add(
             "BasicCpu", &QuantExt::createComputeFrameworkCreator<QuantExt::BasicCpuFramework>, true);
+        QuantExt::ComputeFrameworkRegistry::instance().add(
+            "FusedCpu", &QuantExt::createComputeFrameworkCreator<QuantExt::FusedCpuFramework>, true);
     }
     ~ComputeEnvironmentFixture() { ComputeEnvironment::instance().reset(); }
 };
@@ -406,6 +409,174 @@ BOOST_AUTO_TEST_CASE(testConditionalExpectation) {
     BOOST_CHECK(true);
 }
 
+BOOST_AUTO_TEST_CASE(testFreedVariablesAndSegments) {
+    ComputeEnvironmentFixture fixture;
+    const std::size_t n = 10000;
+    for (auto const& d : ComputeEnvironment::instance().getAvailableDevices()) {
+        BOOST_TEST_MESSAGE("testing calc with freed variables across segments on device '" << d << "'.");
+        ComputeEnvironment::instance().selectContext(d);
+        auto& c = ComputeEnvironment::instance().context();
+        ComputeContext::Settings settings;
+        settings.useDoublePrecision = c.supportsDoublePrecision();
+        BOOST_TEST_MESSAGE("using double precision = " << std::boolalpha << settings.useDoublePrecision);
+
+        c.initiateCalculation(n, 0, 0, settings);
+
+        std::vector<double> rx(n);
+        for (std::size_t i = 0; i < n; ++i)
+            rx[i] = 0.5 + static_cast<double>(i) / static_cast<double>(n);
+        auto x = c.createInputVariable(&rx[0]);
+        auto two = c.createInputVariable(2.0);
+        auto one = c.createInputVariable(1.0);
+        auto z = c.createInputVariates(1, 1)[0][0];
+        auto four = c.applyOperation(RandomVariableOpCode::Mult, {two, two});
+        auto a = c.applyOperation(RandomVariableOpCode::Mult, {x, four});
+        auto b = c.applyOperation(RandomVariableOpCode::Add, {a, z, one});
+        c.freeVariable(a);
+        auto mb = c.applyOperation(RandomVariableOpCode::Negative, {b});
+        auto e = c.applyOperation(RandomVariableOpCode::Exp, {mb});
+        c.freeVariable(mb);
+        auto ce = c.applyOperation(RandomVariableOpCode::ConditionalExpectation, {e, one, x});
+        c.freeVariable(e);
+        auto f = c.applyOperation(RandomVariableOpCode::Max, {ce, b});
+        c.freeVariable(b);
+        c.freeVariable(ce);
+        auto g = c.applyOperation(RandomVariableOpCode::Sqrt, {f});
+        c.declareOutputVariable(z);
+        c.declareOutputVariable(g);
+        c.declareOutputVariable(four);
+
+        std::vector<std::vector<double>> output(3, std::vector<double>(n));
+        c.finalizeCalculation(output);
+
+        RandomVariable xr(rx);
+        RandomVariable zr(output[0]);
+        RandomVariable br = xr * RandomVariable(n, 4.0) + zr + RandomVariable(n, 1.0);
+        RandomVariable cer = conditionalExpectation(
+            exp(-br), {&xr}, multiPathBasisSystem(1, settings.regressionOrder, QuantLib::LsmBasisSystem::Monomial, n));
+        RandomVariable gr = sqrt(max(cer, br));
+
+        double tol = settings.useDoublePrecision ? 1E-10 : 1E-3;
+        Size noErrors = 0, errorThreshold = 10;
+
+        for (Size i = 0; i < n; ++i) {
+            Real err = std::abs(output[1][i] - gr[i]);
+            if (std::abs(gr[i]) > 1E-10)
+                err /= std::abs(gr[i]);
+            if (err > tol && noErrors < errorThreshold) {
+                BOOST_ERROR("device value (" << output[1][i] << ") at i=" << i << " does not match reference value ("
+                                             << gr[i] << "), error " << err << ", tol " << tol);
+                noErrors++;
+            }
+            BOOST_CHECK_CLOSE(output[2][i], 4.0, 1E-8);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(testNumberOfThreadsSetting) {
+    ComputeEnvironmentFixture fixture;
+    const std::size_t n = 20000;
+    for (auto const& d : ComputeEnvironment::instance().getAvailableDevices()) {
+        BOOST_TEST_MESSAGE("testing number of threads setting on device '" << d << "'.");
+        ComputeEnvironment::instance().selectContext(d);
+        auto& c = ComputeEnvironment::instance().context();
+        std::vector<double> rx(n);
+        for (std::size_t i = 0; i < n; ++i)
+            rx[i] = static_cast<double>(i) / static_cast<double>(n);
+        std::vector<std::vector<double>> output[2];
+        for (std::size_t k = 0; k < 2; ++k) {
+            ComputeContext::Settings settings;
+            settings.useDoublePrecision = c.supportsDoublePrecision();
+            settings.numberOfThreads = k == 0 ? 1 : 4;
+            c.initiateCalculation(n, 0, 0, settings);
+            auto x = c.createInputVariable(&rx[0]);
+            auto y = c.createInputVariable(0.5);
+            auto z = c.applyOperation(RandomVariableOpCode::Max, {x, y});
+            auto w = c.applyOperation(RandomVariableOpCode::Mult, {z, x});
+            c.declareOutputVariable(w);
+            output[k] = std::vector<std::vector<double>>(1, std::vector<double>(n));
+            c.finalizeCalculation(output[k]);
+        }
+        for (std::size_t i = 0; i < n; ++i) {
+            BOOST_CHECK_CLOSE(output[0][0][i], output[1][0][i], 1E-10);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(testFusedCpuAgainstBasicCpu) {
+    ComputeEnvironmentFixture fixture;
+    const std::size_t n = 5000;
+    std::vector<double> rx(n), ry(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        rx[i] = -2.0 + 4.0 * static_cast<double>(i) / static_cast<double>(n);
+        ry[i] = 0.5 + static_cast<double>((i * 7) % 13) / 13.0;
+    }
+    // the fused context is run single and multi-threaded and replayed, all results must match the basic cpu context
+    std::vector<std::pair<std::string, std::size_t>> runs = {{"BasicCpu/Default/Default", 1},
+                                                             {"FusedCpu/Default/Default", 1},
+                                                             {"FusedCpu/Default/Default", 4}};
+    std::vector<std::vector<std::vector<double>>> results;
+    for (auto const& [device, threads] : runs) {
+        ComputeEnvironment::instance().selectContext(device);
+        auto& c = ComputeEnvironment::instance().context();
+        ComputeContext::Settings settings;
+        settings.useDoublePrecision = true;
+        settings.numberOfThreads = threads;
+        std::size_t id = 0;
+        for (std::size_t replay = 0; replay < 2; ++replay) {
+            auto [calcId, newCalc] = c.initiateCalculation(n, id, 0, settings);
+            id = calcId;
+            auto x = c.createInputVariable(&rx[0]);
+            auto y = c.createInputVariable(&ry[0]);
+            auto half = c.createInputVariable(0.5);
+            auto one = c.createInputVariable(1.0);
+            if (newCalc) {
+                std::vector<std::size_t> out;
+                out.push_back(c.applyOperation(RandomVariableOpCode::NormalCdf, {x}));
+                out.push_back(c.applyOperation(RandomVariableOpCode::NormalPdf, {x}));
+                out.push_back(c.applyOperation(RandomVariableOpCode::NormalCdf, {half}));
+                auto s = c.applyOperation(RandomVariableOpCode::Add, {x, y, half});
+                out.push_back(s);
+                auto d = c.applyOperation(RandomVariableOpCode::Div, {c.applyOperation(RandomVariableOpCode::Subtract,
+                                                                                       {x, y}),
+                                                                      y});
+                out.push_back(d);
+                out.push_back(c.applyOperation(RandomVariableOpCode::Pow, {y, x}));
+                out.push_back(c.applyOperation(
+                    RandomVariableOpCode::Log, {c.applyOperation(RandomVariableOpCode::Abs, {d})}));
+                out.push_back(c.applyOperation(
+                    RandomVariableOpCode::Sqrt, {c.applyOperation(RandomVariableOpCode::Exp, {x})}));
+                out.push_back(c.applyOperation(RandomVariableOpCode::IndicatorGt, {x, half}));
+                out.push_back(c.applyOperation(RandomVariableOpCode::IndicatorGeq, {half, x}));
+                out.push_back(c.applyOperation(RandomVariableOpCode::IndicatorEq, {y, one}));
+                out.push_back(c.applyOperation(RandomVariableOpCode::Min, {x, y}));
+                out.push_back(c.applyOperation(
+                    RandomVariableOpCode::Max, {c.applyOperation(RandomVariableOpCode::Negative, {x}), half}));
+                auto ce = c.applyOperation(RandomVariableOpCode::ConditionalExpectation, {s, one, x});
+                out.push_back(c.applyOperation(RandomVariableOpCode::Mult, {ce, y}));
+                for (auto o : out)
+                    c.declareOutputVariable(o);
+            }
+            std::vector<std::vector<double>> output(14, std::vector<double>(n));
+            c.finalizeCalculation(output);
+            results.push_back(output);
+        }
+    }
+    for (std::size_t r = 1; r < results.size(); ++r) {
+        for (std::size_t k = 0; k < results[0].size(); ++k) {
+            Size noErrors = 0;
+            for (std::size_t i = 0; i < n && noErrors < 10; ++i) {
+                if (results[r][k][i] != results[0][k][i] &&
+                    !(std::isnan(results[r][k][i]) && std::isnan(results[0][k][i]))) {
+                    BOOST_ERROR("run " << r << ", output " << k << ", i=" << i << ": " << results[r][k][i]
+                                       << " does not match basic cpu result " << results[0][k][i]);
+                    ++noErrors;
+                }
+            }
+        }
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,159 @@
+/*
+ Copyright (C) 2024 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include "toplevelfixture.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <qle/methods/multipathgeneratorbase.hpp>
+
+#include <ql/processes/ornsteinuhlenbeckprocess.hpp>
+#include <ql/processes/stochasticprocessarray.hpp>
+
+using namespace QuantExt;
+using namespace QuantLib;
+
+namespace {
+
+QuantLib::ext::shared_ptr<StochasticProcess> process2D() {
+    std::vector<QuantLib::ext::shared_ptr<StochasticProcess1D>> processes = {
+        QuantLib::ext::make_shared<OrnsteinUhlenbeckProcess>(0.1, 0.01, 0.02, 0.03),
+        QuantLib::ext::make_shared<OrnsteinUhlenbeckProcess>(0.5, 0.20, 1.00, 0.80)};
+    Matrix correlation(2, 2, 1.0);
+    correlation[0][1] = correlation[1][0] = 0.6;
+    return QuantLib::ext::make_shared<StochasticProcessArray>(processes, correlation);
+}
+
+} // namespace
+
+BOOST_FIXTURE_TEST_SUITE(QuantExtTestSuite, qle::test::TopLevelFixture)
+
+BOOST_AUTO_TEST_SUITE(MultiPathGeneratorTest)
+
+BOOST_AUTO_TEST_CASE(testSobolBrownianBridgeVariates) {
+
+    BOOST_TEST_MESSAGE("Testing Sobol Brownian bridge path generator against SobolBrownianGenerator...");
+
+    auto process = process2D();
+    TimeGrid grid(5.0, 17);
+    BigNatural seed = 42;
+
+    for (auto ordering : {SobolBrownianGenerator::Factors, SobolBrownianGenerator::Steps,
+                          SobolBrownianGenerator::Diagonal}) {
+        MultiPathGeneratorSobolBrownianBridge pgen(process, grid, ordering, seed);
+        SobolBrownianGenerator gen(process->factors(), grid.size() - 1, ordering, seed);
+        std::vector<Real> dw(process->factors());
+        Real maxError = 0.0;
+        for (Size p = 0; p < 100; ++p) {
+            const MultiPath& path = pgen.next().value;
+            gen.nextPath();
+            Array x = process->initialValues();
+            for (Size i = 1; i < grid.size(); ++i) {
+                gen.nextStep(dw);
+                x = process->evolve(grid[i - 1], x, grid.dt(i - 1), Array(dw.begin(), dw.end()));
+                for (Size j = 0; j < x.size(); ++j)
+                    maxError = std::max(maxError, std::abs(path[j][i] - x[j]));
+            }
+        }
+        BOOST_TEST_MESSAGE("ordering " << ordering << ": max error " << maxError);
+        BOOST_CHECK_SMALL(maxError, 1E-12);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(testNextBlock) {
+
+    BOOST_TEST_MESSAGE("Testing block path generation against single path generation...");
+
+    auto process = process2D();
+    TimeGrid grid(5.0, 17);
+    Size nSamples = 100;
+
+    for (auto s : {MersenneTwister, MersenneTwisterAntithetic, Sobol, Burley2020Sobol, SobolBrownianBridge,
+                   Burley2020SobolBrownianBridge}) {
+        auto pgen = makeMultiPathGenerator(s, process, grid, 42);
+        auto pgenBlock = makeMultiPathGenerator(s, process, grid, 42);
+
+        // skip the first time step and the second state variable on odd time steps
+        std::vector<std::vector<std::vector<Real>>> values(
+            grid.size() - 1, std::vector<std::vector<Real>>(process->size(), std::vector<Real>(nSamples, 0.0)));
+        std::vector<std::vector<Real*>> paths(grid.size() - 1, std::vector<Real*>(process->size(), nullptr));
+        for (Size i = 1; i < grid.size() - 1; ++i)
+            for (Size j = 0; j < (i % 2 == 0 ? process->size() : 1); ++j)
+                paths[i][j] = values[i][j].data();
+
+        // a partial block followed by the remaining samples
+        pgenBlock->nextBlock(nSamples / 3, paths);
+        for (Size i = 0; i < paths.size(); ++i)
+            for (Size j = 0; j < paths[i].size(); ++j)
+                if (paths[i][j] != nullptr)
+                    paths[i][j] += nSamples / 3;
+        pgenBlock->nextBlock(nSamples - nSamples / 3, paths);
+
+        Real maxError = 0.0;
+        for (Size k = 0; k < nSamples; ++k) {
+            const MultiPath& path = pgen->next().value;
+            for (Size i = 0; i < paths.size(); ++i)
+                for (Size j = 0; j < paths[i].size(); ++j)
+                    if (paths[i][j] != nullptr)
+                        maxError = std::max(maxError, std::abs(values[i][j][k] - path[j][i + 1]));
+            BOOST_CHECK_EQUAL(values[0][0][k], 0.0);
+            BOOST_CHECK_EQUAL(values[1][1][k], 0.0);
+        }
+        BOOST_TEST_MESSAGE("sequence type " << s << ": max error " << maxError);
+        BOOST_CHECK_SMALL(maxError, 1E-12);
+
+        // single path and block generation can be mixed and continue the same sequence
+        pgenBlock->nextBlock(1, paths);
+        BOOST_CHECK_CLOSE(paths[2][1][0], pgen->next().value[1][3], 1E-10);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(testSkip) {
+
+    BOOST_TEST_MESSAGE("Testing skipping paths against generating them...");
+
+    auto process = process2D();
+    TimeGrid grid(5.0, 17);
+
+    for (auto s : {MersenneTwister, MersenneTwisterAntithetic, Sobol, Burley2020Sobol, SobolBrownianBridge,
+                   Burley2020SobolBrownianBridge}) {
+        auto pgen = makeMultiPathGenerator(s, process, grid, 42);
+        auto pgenSkip = makeMultiPathGenerator(s, process, grid, 42);
+
+        // skip from the start, after generated paths and twice in a row
+        Real maxError = 0.0;
+        for (Size skip : {5, 0, 17, 3, 1}) {
+            for (Size k = 0; k < skip; ++k)
+                pgen->next();
+            pgenSkip->skip(skip);
+            for (Size k = 0; k < (skip == 17 ? 0 : 2); ++k) {
+                const MultiPath& path = pgen->next().value;
+                const MultiPath& pathSkip = pgenSkip->next().value;
+                for (Size i = 0; i < grid.size(); ++i)
+                    for (Size j = 0; j < process->size(); ++j)
+                        maxError = std::max(maxError, std::abs(path[j][i] - pathSkip[j][i]));
+            }
+        }
+        BOOST_TEST_MESSAGE("sequence type " << s << ": max error " << maxError);
+        BOOST_CHECK_SMALL(maxError, 1E-12);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -26,6 +26,7 @@
 #include <qle/math/randomvariable.hpp>
 
 #include <ql/time/date.hpp>
+#include <ql/math/randomnumbers/mt19937uniformrng.hpp>
 #include <ql/pricingengines/blackformula.hpp>
 
 #include <boost/math/distributions/normal.hpp>
@@ -97,6 +98,44 @@ BOOST_AUTO_TEST_CASE(testFilter) {
     BOOST_CHECK_THROW(r.at(100), QuantLib::Error);
 }
 
+BOOST_AUTO_TEST_CASE(testFilterWordBoundaries) {
+    BOOST_TEST_MESSAGE("Testing filter operations across word boundaries...");
+
+    for (Size n : {1, 63, 64, 65, 130}) {
+        BOOST_TEST_MESSAGE("n = " << n);
+        Filter f(n, false), g(n, false);
+        RandomVariable x(n), y(n, -1.0);
+        for (Size i = 0; i < n; ++i) {
+            f.set(i, i % 3 == 0);
+            g.set(i, i % 2 == 0);
+            x.set(i, static_cast<Real>(i));
+        }
+        Filter a = f && g, o = f || g, e = equal(f, g), nf = !f;
+        RandomVariable c = conditionalResult(f, x, y), af = applyFilter(x, f), ai = applyInverseFilter(x, f);
+        for (Size i = 0; i < n; ++i) {
+            BOOST_CHECK_EQUAL(a[i], f[i] && g[i]);
+            BOOST_CHECK_EQUAL(o[i], f[i] || g[i]);
+            BOOST_CHECK_EQUAL(e[i], f[i] == g[i]);
+            BOOST_CHECK_EQUAL(nf[i], !f[i]);
+            BOOST_CHECK_EQUAL(c[i], f[i] ? x[i] : -1.0);
+            BOOST_CHECK_EQUAL(af[i], f[i] ? x[i] : 0.0);
+            BOOST_CHECK_EQUAL(ai[i], f[i] ? 0.0 : x[i]);
+        }
+        // the negation of a filter must not set bits beyond its size
+        BOOST_CHECK(!nf == f);
+
+        // a filter with all values set to the same value is recognised as deterministic
+        Filter t = !Filter(n, false);
+        t.expand();
+        t.updateDeterministic();
+        BOOST_CHECK(t.deterministic());
+        BOOST_CHECK(t == Filter(n, true));
+        Filter l = x < RandomVariable(n, -1.0);
+        BOOST_CHECK(l.deterministic());
+        BOOST_CHECK_EQUAL(l[n - 1], false);
+    }
+}
+
 BOOST_AUTO_TEST_CASE(testRandomVariable) {
     BOOST_TEST_MESSAGE("Testing random variable...");
 
@@ -138,6 +177,52 @@ BOOST_AUTO_TEST_CASE(testRandomVariable) {
     BOOST_CHECK_THROW(r.at(100), QuantLib::Error);
 }
 
+BOOST_AUTO_TEST_CASE(testBufferReuse) {
+    BOOST_TEST_MESSAGE("Testing random variable and filter buffer reuse...");
+
+    double tol = 1E-10;
+
+    // buffers released by temporaries are handed out again, values must not leak between variables
+
+    RandomVariable x(100, 1.0);
+    x.set(5, 2.0);
+    for (Size k = 0; k < 10; ++k) {
+        RandomVariable y = x * x + RandomVariable(100, static_cast<double>(k));
+        BOOST_CHECK_CLOSE(y[0], 1.0 + k, tol);
+        BOOST_CHECK_CLOSE(y[5], 4.0 + k, tol);
+    }
+
+    RandomVariable z(100);
+    z.expand();
+    BOOST_CHECK_CLOSE(z[7], 0.0, tol);
+
+    // copy assignment of a stochastic variable to a deterministic one of the same size
+
+    RandomVariable d(100, 3.0);
+    d = x;
+    BOOST_CHECK(!d.deterministic());
+    BOOST_CHECK_CLOSE(d[0], 1.0, tol);
+    BOOST_CHECK_CLOSE(d[5], 2.0, tol);
+
+    Filter f(100, false);
+    f.set(3, true);
+    Filter g(100, true);
+    g = f;
+    BOOST_CHECK(!g.deterministic());
+    BOOST_CHECK_EQUAL(g[0], false);
+    BOOST_CHECK_EQUAL(g[3], true);
+
+    // move assignment releases the previous buffer of the target
+
+    RandomVariable m(50, 1.0);
+    m.expand();
+    m = RandomVariable(100, 2.0);
+    BOOST_CHECK(m.deterministic());
+    BOOST_CHECK_EQUAL(m.size(), 100);
+    m.clear();
+    BOOST_CHECK(!m.initialised());
+}
+
 BOOST_AUTO_TEST_CASE(testFunctions) {
     BOOST_TEST_MESSAGE("Testing functions...");
 
@@ -192,6 +277,50 @@ BOOST_AUTO_TEST_CASE(testBlack) {
     }
 }
 
+BOOST_AUTO_TEST_CASE(testNormalEquationsRegression) {
+    BOOST_TEST_MESSAGE("Testing regression via normal equations...");
+
+    // more samples than fit into one block of the normal equations accumulation
+    const Size n = 5000;
+    MersenneTwisterUniformRng rng(42);
+    RandomVariable x(n), z(n), y(n);
+    Filter filter(n);
+    for (Size i = 0; i < n; ++i) {
+        x.set(i, rng.nextReal());
+        z.set(i, 2.0 * rng.nextReal() - 1.0);
+        y.set(i, 1.0 + 2.0 * x.at(i) - 0.5 * x.at(i) * z.at(i) + 0.3 * z.at(i) * z.at(i) + 0.1 * rng.nextReal());
+        filter.set(i, i % 3 != 0);
+    }
+
+    std::vector<const RandomVariable*> regressor = {&x, &z};
+    auto basisFn = multiPathBasisSystem(2, 2, QuantLib::LsmBasisSystem::Monomial);
+
+    for (auto const& f : {Filter(), filter}) {
+        Array qr = regressionCoefficients(y, regressor, basisFn, f, RandomVariableRegressionMethod::QR);
+        Array ne = regressionCoefficients(y, regressor, basisFn, f, RandomVariableRegressionMethod::NormalEquations);
+        BOOST_REQUIRE_EQUAL(qr.size(), ne.size());
+        for (Size i = 0; i < qr.size(); ++i)
+            BOOST_CHECK_SMALL(ne[i] - qr[i], 1E-9);
+        // the partial sums are added in a fixed order, so the result is the same for any number of threads
+        Array ne4 = regressionCoefficients(y, regressor, basisFn, f, RandomVariableRegressionMethod::NormalEquations,
+                                           std::string(), 4);
+        BOOST_REQUIRE_EQUAL(ne4.size(), ne.size());
+        for (Size i = 0; i < ne.size(); ++i)
+            BOOST_CHECK_EQUAL(ne4[i], ne[i]);
+    }
+
+    // collinear regressors lead to a singular gram matrix, the coefficients are then computed with SVD
+    RandomVariable x2 = x * RandomVariable(n, 2.0);
+    std::vector<const RandomVariable*> collinearRegressor = {&x, &x2};
+    auto collinearBasisFn = multiPathBasisSystem(2, 1, QuantLib::LsmBasisSystem::Monomial);
+    RandomVariable svd =
+        conditionalExpectation(y, collinearRegressor, collinearBasisFn, filter, RandomVariableRegressionMethod::SVD);
+    RandomVariable ne = conditionalExpectation(y, collinearRegressor, collinearBasisFn, filter,
+                                               RandomVariableRegressionMethod::NormalEquations);
+    for (Size i = 0; i < n; ++i)
+        BOOST_CHECK_SMALL(ne.at(i) - svd.at(i), 1E-9);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE_END()